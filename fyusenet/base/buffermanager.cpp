@@ -10,12 +10,15 @@
 //--------------------------------------- System Headers -------------------------------------------
 
 #include <cassert>
+#include <algorithm>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
 #include "../common/logging.h"
 #include "asynclayerinterface.h"
+#include "concatviewinterface.h"
 #include "../gl/glexception.h"
+#include "../gl/glstate.h"
 #include "buffermanager.h"
 
 //-------------------------------------- Global Variables ------------------------------------------
@@ -65,10 +68,12 @@ void BufferManager::cleanup() {
         for (auto ti = texturePool_.begin(); ti != texturePool_.end(); ++ti,pi++) {
             textures[pi]=(*ti).id_;
         }
-        glDeleteTextures(texturePool_.size(),textures);
+        opengl::GLState::deleteTextures(texturePool_.size(),textures);
         texturePool_.clear();
     }
     bufferPool_.clear();
+    concatViews_.clear();
+    copyConcats_.clear();
     estimatedTextureBytes_ = 0;
 }
 
@@ -108,22 +113,48 @@ void BufferManager::createCPUOutput(LayerBase *outputLayer, bool lock) {
  *
  * @param outputLayer Pointer to layer which should be assigned the GPU output
  *
- * @param internalFormat Sized (internal) texture format for the output texture (e.g. \c GL_RGBA32F)
+ * @param internalFormat Sized (internal) texture format for the output texture (e.g. \c GL_RGBA32F),
+ *                       use 0 to select the format that matches the precision of the layer
  *
  * @param pixelFormat Pixel format for the output texture (e.g. \c GL_RGBA )
  *
- * @param dataType GL datatype for the output texture (e.g. \c GL_FLOAT )
+ * @param dataType GL datatype for the output texture (e.g. \c GL_FLOAT ), use 0 to select the
+ *                 type that matches the precision of the layer
  *
  * This function designates the layer as a sink and adds a (set of) output texture(s) to this layer,
  * which is not connected to any other layer in the network and also not shared with any other layer
  * in the network.
+ *
+ * If the \p outputLayer is a concatenation layer whose inputs are rendered directly into its
+ * output texture (see ConcatViewInterface) and that texture has the requested format, the
+ * texture is kept and locked against re-use instead.
+ *
+ * @see gpu::GPULayerBase::isHighPrecision()
  */
 void BufferManager::createGPUOutput(gpu::GPULayerBase *outputLayer, GLint internalFormat,
                                     GLint pixelFormat, GLenum dataType) {
+    if (internalFormat == 0) internalFormat = outputLayer->textureFormat();
+    if (dataType == 0) dataType = outputLayer->textureType();
+    //---------------------------------------------------------
+    // A layer that renders into a view of a concatenation must
+    // not have its output replaced...
+    //---------------------------------------------------------
+    auto view = std::find_if(concatViews_.begin(), concatViews_.end(), [outputLayer](const ConcatView& cv) { return cv.producer_ == outputLayer; });
+    if (view != concatViews_.end()) revertConcatViews(view->concat_);
+    if ((hasConcatViews(outputLayer)) && (outputLayer->hasOutputTexture(0))) {
+        GLuint tid = outputLayer->getOutputTexture(0);
+        auto tex = std::find_if(texturePool_.begin(), texturePool_.end(), [tid](const Texture& tx) { return tx.id_ == tid; });
+        if ((tex != texturePool_.end()) && (tex->internalFormat_ == internalFormat)) {
+            tex->locked_ = true;
+            outputLayer->addOutputConnection(0, nullptr, 0);
+            return;
+        }
+        revertConcatViews(outputLayer);
+    }
     const std::vector<BufferSpec>& outputs = outputLayer->getRequiredOutputBuffers();
     for (auto texit = outputs.begin() ; texit != outputs.end(); ++texit) {
         Texture ot = createTexture((*texit).width_, (*texit).height_,
-                                   internalFormat, pixelFormat, dataType, BufferSpec::LINEAR);
+                                   internalFormat, pixelFormat, dataType, BufferSpec::LINEAR, (*texit).immutable_, (*texit).arrayLayers_);
         gpu::GPULayerBase *gpu = dynamic_cast<gpu::GPULayerBase *>(outputLayer);
         if (!gpu) THROW_EXCEPTION_ARGS(FynException,"Cannot assign output texture to non-GPU layer");
         gpu->addOutputTexture(ot.id_, (*texit).channelIndex_);
@@ -153,6 +184,11 @@ void BufferManager::createGPUOutput(gpu::GPULayerBase *outputLayer, GLint intern
  * for compatibility and only then a connection is established. For input layers that have more than
  * one port, all ports have to be connected individually.
  *
+ * The output textures of GPU layers are allocated with the floating-point precision of the
+ * \p outputLayer (see gpu::GPULayerBase::isHighPrecision()), regardless of the precision of the
+ * \p inputLayer. As the consuming layer samples its input textures, the conversion between
+ * different precisions is done by the GPU and does not require any additional step.
+ *
  * @see checkIOMatch()
  *
  * @note This function is \b not reentrant.
@@ -163,7 +199,15 @@ void BufferManager::connectLayers(LayerBase *outputLayer, LayerBase *inputLayer,
         THROW_EXCEPTION_ARGS(FynException,"Illegal parameters out=%p in=%p",outputLayer, inputLayer);
     }
     const std::vector<BufferSpec> inputs = inputLayer->getRequiredInputBuffers();
-    const std::vector<BufferSpec> outputs = outputLayer->getRequiredOutputBuffers();
+    std::vector<BufferSpec> outputs = outputLayer->getRequiredOutputBuffers();
+    const gpu::GPULayerBase * gpuout = dynamic_cast<const gpu::GPULayerBase *>(outputLayer);
+    if (gpuout) {
+        for (BufferSpec & spec : outputs) {
+            // NOTE upload layers specify the texture format themselves
+            if ((spec.device_ != BufferSpec::COMP_STOR_GPU) || (spec.usage_ == BufferSpec::GPU_DEST) || (spec.usage_ == BufferSpec::OES_DEST)) continue;
+            spec.floatType(gpuout->textureType());
+        }
+    }
     if (inputs.size() == 0) {
         THROW_EXCEPTION_ARGS(FynException,"Input layer %s has no inputs",inputLayer->getName().c_str());
     }
@@ -378,6 +422,20 @@ void BufferManager::connectGPULayers(gpu::GPULayerBase * outLayer, gpu::GPULayer
         lock = true;  // asynchronous layers always have locked output textures
         asy->addAsyncDependency(inLayer, matches.begin()->first.channelIndex_);
     }
+    //---------------------------------------------------------
+    // An output that is rendered into a view of a concatenation
+    // cannot be shared with other layers, so we have to revert
+    // the views of that concatenation...
+    //---------------------------------------------------------
+    auto view = std::find_if(concatViews_.begin(), concatViews_.end(), [outLayer](const ConcatView& cv) { return cv.producer_ == outLayer; });
+    if (view != concatViews_.end()) revertConcatViews(view->concat_);
+    //---------------------------------------------------------
+    // Check if the output can be rendered directly into the
+    // output texture of a concatenation layer...
+    //---------------------------------------------------------
+    if ((matches.size() == 1) && (dynamic_cast<ConcatViewInterface *>(inLayer))) {
+        if (connectConcatView(outLayer, inLayer, matches.front(), port, lock)) return;
+    }
     for (auto it = matches.begin(); it != matches.end(); ++it) {
         //---------------------------------------------------------
         // Check if the associated output already has a texture and
@@ -398,7 +456,7 @@ void BufferManager::connectGPULayers(gpu::GPULayerBase * outLayer, gpu::GPULayer
             //-------------------------------------------------------
             int index = findTexture(inLayer->getNumber(), outLayer->getNumber(),
                                     it->second.width_, it->second.height_,
-                                    it->second.internalFormat_, it->second.interpolation_);
+                                    it->second.internalFormat_, it->second.interpolation_, it->second.immutable_, it->second.arrayLayers_);
             if ((index >= 0) && (!lock) && (!it->second.lock_)) {
                 GLuint tid = texturePool_.at(index).id_;
                 if (it->first.usage_ == BufferSpec::RESIDUAL_SOURCE) inLayer->addResidualTexture(tid, it->first.channelIndex_);
@@ -413,7 +471,7 @@ void BufferManager::connectGPULayers(gpu::GPULayerBase * outLayer, gpu::GPULayer
                 //-------------------------------------------------------
                 // No re-use possible or desired, create a new texture...
                 //-------------------------------------------------------
-                Texture nt = createTexture(it->second.width_, it->second.height_, it->second.internalFormat_, it->second.format_, it->second.type_);
+                Texture nt = createTexture(it->second.width_, it->second.height_, it->second.internalFormat_, it->second.format_, it->second.type_, BufferSpec::ANY, it->second.immutable_, it->second.arrayLayers_);
                 nt.lastInputLayer_ = inLayer->getNumber();
                 nt.locked_ = lock | it->second.lock_;
                 texturePool_.push_back(nt);
@@ -429,7 +487,7 @@ void BufferManager::connectGPULayers(gpu::GPULayerBase * outLayer, gpu::GPULayer
                 //-------------------------------------------------------
                 if (it->second.multiplicity_ > 1) {
                     for (int m=0; m < it->second.multiplicity_ - 1; m++) {
-                        Texture snt = createTexture(it->second.width_, it->second.height_, it->second.internalFormat_, it->second.format_, it->second.type_);
+                        Texture snt = createTexture(it->second.width_, it->second.height_, it->second.internalFormat_, it->second.format_, it->second.type_, BufferSpec::ANY, it->second.immutable_, it->second.arrayLayers_);
                         snt.lastInputLayer_ = inLayer->getNumber();
                         snt.locked_ = true;
                         texturePool_.push_back(snt);
@@ -443,6 +501,126 @@ void BufferManager::connectGPULayers(gpu::GPULayerBase * outLayer, gpu::GPULayer
 
 
 
+/**
+ * @brief Try to let a layer render directly into the output texture of a concatenation layer
+ *
+ * @param outLayer Pointer to layer that produces the data for the concatenation input
+ * @param concatLayer Pointer to concatenation layer, which must implement ConcatViewInterface
+ * @param match Matching pair of input and output buffer specifications for the connection
+ * @param port Input port of the \p concatLayer to connect
+ * @param lock Indicator that the connection should use locked textures
+ *
+ * @retval true if the connection was established using a view into the output texture of the
+ *         \p concatLayer
+ * @retval false if the connection has to be established as usual (in which case the
+ *         concatenation copies \e all of its inputs)
+ *
+ * Rendering into the output of the concatenation requires the \p concatLayer to provide a view
+ * for the \p port and the \p outLayer to support rendering into views. In addition, the output
+ * of \p outLayer must not have been connected to any other layer yet, as it is not available as
+ * separate texture. As the concatenation layer can either copy all of its inputs or none, a
+ * failed attempt reverts the views that have been established for the other ports.
+ *
+ * The output texture of the concatenation is allocated when the first view is established and
+ * is not taken from the pool, as it has to stay valid from the first producer onwards.
+ *
+ * @see ConcatViewInterface, revertConcatViews()
+ */
+bool BufferManager::connectConcatView(gpu::GPULayerBase * outLayer, gpu::GPULayerBase * concatLayer, const std::pair<BufferSpec,BufferSpec> & match, int port, bool lock) {
+    ConcatViewInterface * concat = dynamic_cast<ConcatViewInterface *>(concatLayer);
+    assert(concat);
+    const BufferSpec & in = match.first;
+    const BufferSpec & out = match.second;
+    BufferSpec cspec = concatLayer->getRequiredOutputBuffers().at(0);
+    cspec.floatType(concatLayer->textureType());
+    int origin[2] = {0, 0};
+    bool viewable = (!lock) && (!out.lock_) && (!out.async_) && (out.multiplicity_ <= 1) && (out.arrayLayers_ == 0) &&
+                    (in.usage_ != BufferSpec::RESIDUAL_SOURCE) && (out.internalFormat_ == cspec.internalFormat_) &&
+                    (outLayer->supportsOutputView()) && (!outLayer->hasOutputTexture(out.channelIndex_)) &&
+                    (std::find(copyConcats_.begin(), copyConcats_.end(), concatLayer) == copyConcats_.end()) &&
+                    ((!concatLayer->hasOutputTexture(0)) || (hasConcatViews(concatLayer))) &&
+                    (concat->getInputView(port, origin[0], origin[1]));
+    if (!viewable) {
+        revertConcatViews(concatLayer);
+        return false;
+    }
+    GLuint tid = 0;
+    if (!concatLayer->hasOutputTexture(0)) {
+        Texture nt = createTexture(cspec.width_, cspec.height_, cspec.internalFormat_, cspec.format_, cspec.type_, BufferSpec::ANY, cspec.immutable_, cspec.arrayLayers_);
+        nt.lastInputLayer_ = concatLayer->getNumber();
+        texturePool_.push_back(nt);
+        concatLayer->addOutputTexture(nt.id_, cspec.channelIndex_);
+        tid = nt.id_;
+    } else tid = concatLayer->getOutputTexture(0);
+    int inputindex = in.channelIndex_ + concatLayer->getPortChannelIndex(port);
+    outLayer->addOutputTexture(tid, out.channelIndex_);
+    outLayer->setOutputView(true, origin[0], origin[1], cspec.width_, cspec.height_);
+    // NOTE the concatenation does not read this input, we only add it for consistency
+    concatLayer->addInputTexture(tid, inputindex);
+    concatLayer->addInputConnection(port, outLayer, in.port_);
+    outLayer->addOutputConnection(out.port_, concatLayer, port);
+    concat->useInputView(port, true);
+    concatViews_.push_back(ConcatView(outLayer, concatLayer, port, inputindex, out));
+    updateLayerUseByTextureID(tid, concatLayer->getNumber());
+    return true;
+}
+
+
+/**
+ * @brief Revert all views into the output texture of a concatenation layer
+ *
+ * @param concatLayer Pointer to concatenation layer to revert the views for
+ *
+ * Each producer that renders into a view of the output texture of \p concatLayer is assigned a
+ * texture of its own, which is then used as input texture for the concatenation. The
+ * \p concatLayer is flagged such that no new views will be established for it.
+ *
+ * @see connectConcatView()
+ */
+void BufferManager::revertConcatViews(gpu::GPULayerBase * concatLayer) {
+    if (std::find(copyConcats_.begin(), copyConcats_.end(), concatLayer) == copyConcats_.end()) copyConcats_.push_back(concatLayer);
+    ConcatViewInterface * concat = dynamic_cast<ConcatViewInterface *>(concatLayer);
+    for (auto it = concatViews_.begin(); it != concatViews_.end(); ) {
+        if (it->concat_ != concatLayer) {
+            ++it;
+            continue;
+        }
+        const BufferSpec & spec = it->spec_;
+        gpu::GPULayerBase * producer = it->producer_;
+        GLuint tid = 0;
+        int index = findTexture(concatLayer->getNumber(), producer->getNumber(), spec.width_, spec.height_,
+                                spec.internalFormat_, spec.interpolation_, spec.immutable_, spec.arrayLayers_);
+        if (index >= 0) {
+            tid = texturePool_.at(index).id_;
+            updateLayerUse(index, concatLayer->getNumber());
+        } else {
+            Texture nt = createTexture(spec.width_, spec.height_, spec.internalFormat_, spec.format_, spec.type_, BufferSpec::ANY, spec.immutable_, spec.arrayLayers_);
+            nt.lastInputLayer_ = concatLayer->getNumber();
+            texturePool_.push_back(nt);
+            tid = nt.id_;
+        }
+        producer->setOutputView(false);
+        producer->addOutputTexture(tid, spec.channelIndex_);
+        concatLayer->addInputTexture(tid, it->inputIndex_);
+        if (concat) concat->useInputView(it->port_, false);
+        it = concatViews_.erase(it);
+    }
+}
+
+
+/**
+ * @brief Check if producers render directly into the output texture of a concatenation layer
+ *
+ * @param concatLayer Pointer to concatenation layer to check
+ *
+ * @retval true if at least one producer renders into a view of the output of \p concatLayer
+ * @retval false otherwise
+ */
+bool BufferManager::hasConcatViews(const gpu::GPULayerBase * concatLayer) const {
+    return std::any_of(concatViews_.begin(), concatViews_.end(), [concatLayer](const ConcatView& cv) { return cv.concat_ == concatLayer; });
+}
+
+
 /**
  * @brief Match the outputs of a sending layer to the inputs of a receiving layer
  *
@@ -473,7 +651,9 @@ std::vector<std::pair<BufferSpec,BufferSpec>> BufferManager::checkIOMatch(LayerB
             bool intermatch = (outspec.interpolation_ == inspec.interpolation_)||(((outspec.interpolation_==BufferSpec::ANY)||(inspec.interpolation_==BufferSpec::ANY)));
             bool devmatch = (outspec.device_ == inspec.device_);
             bool idxmatch = (inspec.channelIndex_ == outspec.channelIndex_);
-            if (devmatch && idxmatch && (outspec.width_ == inspec.width_) && (outspec.height_ == inspec.height_) && intermatch) {
+            // 2D texture arrays can only be connected to layers that read 2D texture arrays with the same layer count
+            bool arraymatch = ((outspec.dataOrder_ == BufferSpec::GPU_DEEP_ARRAY) == (inspec.dataOrder_ == BufferSpec::GPU_DEEP_ARRAY)) && (outspec.arrayLayers_ == inspec.arrayLayers_);
+            if (devmatch && idxmatch && arraymatch && (outspec.width_ == inspec.width_) && (outspec.height_ == inspec.height_) && intermatch) {
                 if ((outspec.device_ == BufferSpec::COMP_STOR_CPU) && (outspec.channels_ != inspec.channels_)) continue;
                 if (outspec.usage_ != BufferSpec::GPU_DEST) {
                     // the source layer is not an upload layer, use 4-chan format for
@@ -482,7 +662,9 @@ std::vector<std::pair<BufferSpec,BufferSpec>> BufferManager::checkIOMatch(LayerB
                     inspec.internalFormat_ = gpu::GPULayerBase::TEXTURE_IFORMAT_4;
                     inspec.format_ = gpu::GPULayerBase::TEXTURE_FORMAT_4;
                 }
-                if ((outspec.usage_ == BufferSpec::OES_DEST) || (outspec.internalFormat_ == inspec.internalFormat_)) {
+                // 4-channel floating-point textures of different precision can be connected, the conversion is done on sampling
+                bool precmatch = (BufferSpec::isFloat(outspec.internalFormat_) == 4) && (BufferSpec::isFloat(inspec.internalFormat_) == 4) && (outspec.usage_ != BufferSpec::GPU_DEST);
+                if ((outspec.usage_ == BufferSpec::OES_DEST) || (outspec.internalFormat_ == inspec.internalFormat_) || (precmatch)) {
                     result.push_back(std::make_pair(inspec, outspec));
                 }
             }
@@ -502,18 +684,22 @@ std::vector<std::pair<BufferSpec,BufferSpec>> BufferManager::checkIOMatch(LayerB
  * @param height Requrested texture height
  * @param internalFormat Sized OpenGL texture format (e.g. \c GL_RGBA8)
  * @param interpolation Interpolation mode for the texture (e.g. nearest neighbor or bilinear)
+ * @param immutable Indicator whether the texture must have immutable storage
+ * @param layers Number of layers for 2D texture arrays, 0 for regular 2D textures
  *
  * @return Index into the texture pool that a matching texture was found at or -1 if none was found.
  *
  * This function tries to find a (usable) texture in the pool that meets the supplied specification.
  * Textures that are marked as locked or are still in use (given by the output layer number recorded
- * in the pool), will not be returned.
+ * in the pool), will not be returned. Textures with immutable storage are only returned if
+ * \p immutable is set, as some layers re-specify their output textures.
  */
 int BufferManager::findTexture(int inputLayer, int outputLayer, int width, int height,
-                               GLint internalFormat, BufferSpec::interp interpolation) const {
+                               GLint internalFormat, BufferSpec::interp interpolation, bool immutable, int layers) const {
     assert(inputLayer > outputLayer);
     for (int i=0; i < (int)texturePool_.size(); i++) {
         const Texture & tx = texturePool_.at(i);
+        if ((tx.immutable_ != immutable) || (tx.layers_ != layers)) continue;
         if ((tx.width_ == width) && (tx.height_ == height) && (tx.internalFormat_ == internalFormat) && ((interpolation == BufferSpec::ANY)||(tx.interpolation_ == interpolation))) {
             // we cannot use something as input for layer N which already has been input to layer N-1 or >=N
             if ((!tx.locked_) && (tx.lastInputLayer_ < inputLayer-1) && (outputLayer > tx.lastInputLayer_)) {
@@ -644,36 +830,47 @@ BufferManager::Buffer BufferManager::createBuffer(int width, int height, int cha
  * @param format Unsized texture format (e.g. \c GL_RGBA)
  * @param type GL datatype to use for the texture pixels (e.g. \c GL_FLOAT)
  * @param interpolation Interpolation mode to use
+ * @param immutable If set to \c true, the texture is created with immutable storage
+ * @param layers Number of layers, if larger than 0, a \c GL_TEXTURE_2D_ARRAY with immutable
+ *               storage and the supplied number of layers is created
  *
  * @return BufferManager::Texture object that wraps the newly created texture
  */
 BufferManager::Texture BufferManager::createTexture(int width, int height,
                                                     GLint internalFormat, GLuint format, GLuint type,
-                                                    BufferSpec::interp interpolation) {
+                                                    BufferSpec::interp interpolation, bool immutable, int layers) {
     GLuint texture=0;
+    GLenum target = (layers > 0) ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
     glGenTextures(1, &texture);
     if (texture == 0) THROW_EXCEPTION_ARGS(GLException,"Cannot create texture (err=0x%x)",glGetError());
-    glBindTexture(GL_TEXTURE_2D,texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    opengl::GLState::bindTexture(target,texture);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     switch (interpolation) {
         case BufferSpec::LINEAR:
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
             break;
         case BufferSpec::NEAREST:
             // intentional fallthrough
         default:
             // ANY interpolation defaults to nearest
             interpolation = BufferSpec::NEAREST;
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
             break;
     }
 #ifdef DEBUG
     glGetError();
 #endif
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+#ifndef __APPLE__
+    if (layers > 0) glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, internalFormat, width, height, layers);
+    else if (immutable) glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+    else glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+#else
+    if (layers > 0) glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, width, height, layers, 0, format, type, nullptr);
+    else glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+#endif
 #ifdef DEBUG
     int err = glGetError();
     if (err != GL_NO_ERROR) {
@@ -703,8 +900,8 @@ BufferManager::Texture BufferManager::createTexture(int width, int height,
             elemsize = 4;
             break;
     }
-    estimatedTextureBytes_ += width*height*elemsize;
-    return Texture(texture, width, height, internalFormat, interpolation);
+    estimatedTextureBytes_ += width*height*std::max(1, layers)*elemsize;
+    return Texture(texture, width, height, internalFormat, interpolation, immutable, layers);
 }
 
 } // fyusenet namespace
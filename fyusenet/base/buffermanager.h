@@ -89,10 +89,12 @@ class BufferManager : public GfxContextTracker {
          * @param height Height of buffer/tensor to represent
          * @param intFormat OpenGL-compatible sized format for the texture
          * @param interpolation Interpolation mode to use for the texture
+         * @param immutable Indicator that the texture has immutable storage
+         * @param layers Number of layers for 2D texture arrays, 0 for regular 2D textures
          */
-        Texture(GLuint id, int width, int height, GLuint intFormat, BufferSpec::interp interpolation) :
+        Texture(GLuint id, int width, int height, GLuint intFormat, BufferSpec::interp interpolation, bool immutable=false, int layers=0) :
               id_(id), width_(width), height_(height), internalFormat_(intFormat),
-              lastInputLayer_(-1), locked_(false), interpolation_(interpolation) {
+              lastInputLayer_(-1), locked_(false), interpolation_(interpolation), immutable_(immutable), layers_(layers) {
         }
 
         GLuint id_;                             //!< Raw GL texture handle
@@ -102,6 +104,35 @@ class BufferManager : public GfxContextTracker {
         int lastInputLayer_;                    //!< Layer number of the last (highest) layer that this texture was used as input for
         bool locked_;                           //!< Indicator if texture is to be locked (blocks re-use)
         BufferSpec::interp interpolation_;      //!< Interpolation mode
+        bool immutable_;                        //!< Indicator that the texture has immutable storage (see BufferSpec::immutable())
+        int layers_;                            //!< Number of layers for 2D texture arrays, 0 for regular 2D textures
+    };
+
+
+    /**
+     * @brief Producer layer that renders directly into the output texture of a concatenation layer
+     *
+     * @see ConcatViewInterface
+     */
+    struct ConcatView {
+        /**
+         * @brief Constructor
+         *
+         * @param producer Layer that renders into a view of the output texture of \p concat
+         * @param concat Concatenation layer
+         * @param port Input port of \p concat that is served by \p producer
+         * @param inputIndex Index of the input texture of \p concat that corresponds to \p port
+         * @param spec Output buffer specification of \p producer
+         */
+        ConcatView(gpu::GPULayerBase *producer, gpu::GPULayerBase *concat, int port, int inputIndex, const BufferSpec& spec) :
+            producer_(producer), concat_(concat), port_(port), inputIndex_(inputIndex), spec_(spec) {
+        }
+
+        gpu::GPULayerBase *producer_;           //!< Layer that renders into the output texture of the #concat_ layer
+        gpu::GPULayerBase *concat_;             //!< Concatenation layer that owns the output texture
+        int port_;                              //!< Input port of #concat_ that is served by #producer_
+        int inputIndex_;                        //!< Index of the input texture of #concat_ that corresponds to #port_
+        BufferSpec spec_;                       //!< Output buffer specification of #producer_ (used when reverting the view)
     };
 
     // ------------------------------------------------------------------------
@@ -116,7 +147,7 @@ class BufferManager : public GfxContextTracker {
     void cleanup();
     void connectLayers(LayerBase *outputLayer,LayerBase *inputLayer,int inputIndex,bool lockOutput=false);
     void createCPUOutput(LayerBase *outputLayer, bool lock=false);
-    void createGPUOutput(gpu::GPULayerBase *outputLayer, GLint textureFormat=gpu::GPULayerBase::TEXTURE_IFORMAT_4, GLint pixelFormat=gpu::GPULayerBase::TEXTURE_FORMAT_4, GLenum dataType=gpu::GPULayerBase::TEXTURE_TYPE_DEFAULT);
+    void createGPUOutput(gpu::GPULayerBase *outputLayer, GLint textureFormat=0, GLint pixelFormat=gpu::GPULayerBase::TEXTURE_FORMAT_4, GLenum dataType=0);
 
     /**
      * @brief Get estimate on how much texture memory is used by the network textures
@@ -145,19 +176,24 @@ class BufferManager : public GfxContextTracker {
     static std::vector<std::pair<BufferSpec,BufferSpec>> checkIOMatch(LayerBase *inputLayer, const std::vector<BufferSpec>& inputs, const std::vector<BufferSpec>& outputs, int inputPort);
     void connectCPULayers(LayerBase *outlayer, LayerBase *inlayer, std::vector<std::pair<BufferSpec,BufferSpec>> & matches, int inputPort, bool lock);
     void connectGPULayers(gpu::GPULayerBase * outlayer, gpu::GPULayerBase * inlayer, std::vector<std::pair<BufferSpec,BufferSpec>> & matches, int inputIndex, bool lock);
+    bool connectConcatView(gpu::GPULayerBase * outLayer, gpu::GPULayerBase * concatLayer, const std::pair<BufferSpec,BufferSpec> & match, int port, bool lock);
+    void revertConcatViews(gpu::GPULayerBase * concatLayer);
+    bool hasConcatViews(const gpu::GPULayerBase * concatLayer) const;
     void updateLayerUse(int index, int layerNumber, bool lock=false);
     void updateLayerUseByBuffer(const CPUBuffer *buffer, int layerNumber, bool lock);
     void updateLayerUseByTextureID(GLuint id, int layerNumber, bool lock=false);
     int findBuffer(int inputLayer, int outputLayer, int width, int height, int channels, GLint internalFormat) const;
-    int findTexture(int inputLayer,int outputLayer, int width, int height, GLint internalFormat, BufferSpec::interp interpolation) const;
+    int findTexture(int inputLayer,int outputLayer, int width, int height, GLint internalFormat, BufferSpec::interp interpolation, bool immutable=false, int layers=0) const;
     Buffer createBuffer(int width, int height, int channels, GLint internalFormat, CPUBufferShape::order order = CPUBufferShape::order::CHANNELWISE);
-    Texture createTexture(int width, int height, GLint internalFormat, GLuint format, GLuint type,BufferSpec::interp interpolation=BufferSpec::ANY);
+    Texture createTexture(int width, int height, GLint internalFormat, GLuint format, GLuint type,BufferSpec::interp interpolation=BufferSpec::ANY, bool immutable=false, int layers=0);
 
     // ------------------------------------------------------------------------
     // Member variables
     // ------------------------------------------------------------------------
     std::vector<Texture> texturePool_;          //!< Pool that contains all internally used textures for the network(s)
     std::vector<Buffer> bufferPool_;            //!< Pool that contains all internally used buffers for the network(s)
+    std::vector<ConcatView> concatViews_;       //!< Producers that render directly into the output of a concatenation layer
+    std::vector<const gpu::GPULayerBase *> copyConcats_;  //!< Concatenation layers that have to copy (some of) their inputs
     size_t estimatedTextureBytes_ = 0;          //!< Number of bytes in the pooled textures (estimate)
 };
 
@@ -155,7 +155,8 @@ class BufferSpec {
     enum order {
         GPU_SHALLOW,        //!< Data is in GPU shallow format
         GPU_DEEP,           //!< Data is in GPU deep format
-        CHANNELWISE         //!< Data is in CPU 3D tensor format, stored as 3D array with the channels being the outermost index (w,h,c)
+        CHANNELWISE,        //!< Data is in CPU 3D tensor format, stored as 3D array with the channels being the outermost index (w,h,c)
+        GPU_DEEP_ARRAY      //!< Data is in GPU deep format, stored as 2D texture array with one (unpadded) layer per 4-channel slice
     };
 
     /**
@@ -293,6 +294,86 @@ class BufferSpec {
         return *this;
     }
 
+    /**
+     * @brief Request immutable storage for the texture(s) that realize this buffer
+     *
+     * @param enable If set to \c true, the texture storage will be allocated as immutable storage
+     *
+     * @return Reference to current BufferSpec object
+     *
+     * Textures with immutable storage are allocated using \c glTexStorage2D() and cannot be
+     * re-specified afterwards. This is required for textures that are written by compute
+     * shaders via image store operations on GLES. Immutable textures are only re-used for buffers
+     * that also request immutable storage.
+     */
+    BufferSpec& immutable(bool enable) {
+        immutable_ = enable;
+        return *this;
+    }
+
+    /**
+     * @brief Request storage as 2D texture array
+     *
+     * @param layers Number of array layers, use 0 for regular 2D textures
+     *
+     * @return Reference to current BufferSpec object
+     *
+     * Buffers with the \c GPU_DEEP_ARRAY data order are stored as \c GL_TEXTURE_2D_ARRAY with
+     * immutable storage, where the width and height of the buffer refer to a single layer.
+     */
+    BufferSpec& arrayLayers(int layers) {
+        arrayLayers_ = layers;
+        return *this;
+    }
+
+    /**
+     * @brief Change the precision of a floating-point buffer
+     *
+     * @param type Target floating-point type, either \c FLOAT16 or \c FLOAT
+     *
+     * @return Reference to current BufferSpec object
+     *
+     * Replaces the sized format and data type of buffers that store floating-point data by
+     * the format with the same number of channels and the supplied precision. Buffers that do not
+     * store floating-point data are not changed.
+     */
+    BufferSpec& floatType(dtype type) {
+        assert(type == FLOAT || type == FLOAT16);
+        if ((type_ != FLOAT) && (type_ != FLOAT16)) return *this;
+        int chans = isFloat(internalFormat_);
+        if (chans > 0) {
+            internalFormat_ = formatByChannels(chans, type).first;
+            type_ = type;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Check if a sized format stores floating-point data
+     *
+     * @param format Sized format to check
+     *
+     * @return Number of channels for floating-point formats, 0 for all other formats
+     */
+    static int isFloat(sizedformat format) {
+        switch (format) {
+            case RED32F:
+            case RED16F:
+                return 1;
+            case RG32F:
+            case RG16F:
+                return 2;
+            case RGB32F:
+            case RGB16F:
+                return 3;
+            case RGBA32F:
+            case RGBA16F:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
     /**
      * @brief Get sized format by number of channels and data type
      *
@@ -339,6 +420,8 @@ class BufferSpec {
     csdevice device_ = COMP_STOR_GPU; //!< Device type where the buffer should be allocated on (GPU or CPU)
     bool async_ = false;              //!< Flag that indicates that the buffer is subject to an asynchronous read or write operation (texture uploads and downloads)
     bool lock_ = false;               //!< Flag that indicates that the buffer should be exempt from re-use and only be used for this layer's (output)
+    bool immutable_ = false;          //!< Flag that indicates that the texture storage should be immutable (e.g. for image store operations)
+    int arrayLayers_ = 0;             //!< Number of layers for 2D texture arrays, 0 for regular textures
 
     /**
      * In case multiple sets of the same textures are required, this defines how many sets will
@@ -361,6 +444,7 @@ class BufferSpec {
      *   - \c GPU_SHALLOW
      *   - \c GPU_DEEP
      *   - \c CHANNELWISE
+     *   - \c GPU_DEEP_ARRAY
      *
      * @see CPUBuffer
      */
@@ -0,0 +1,65 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Concatenation View Interface (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+
+/**
+ * @brief Interface for concatenation layers that let producers render directly into their output
+ *
+ * Concatenation layers that implement this interface can expose a rectangular region ("view")
+ * of their output texture for each input port. Instead of rendering into its own texture, which
+ * is then copied by the concatenation layer, a producing layer renders directly into the view
+ * of the port it is connected to. When all input ports are served by views, the concatenation
+ * itself does not have to do anything.
+ *
+ * The views are negotiated by the BufferManager while the layers are connected.
+ *
+ * @see BufferManager::connectLayers, gpu::GPULayerBase::setOutputView
+ */
+class ConcatViewInterface {
+ public:
+    /**
+     * @brief Query the view into the output texture for the specified input port
+     *
+     * @param port Input port to retrieve the view for
+     * @param[out] originX Horizontal offset (pixels) of the view in the output texture
+     * @param[out] originY Vertical offset (pixels) of the view in the output texture
+     *
+     * @retval true if the data for \p port can be rendered directly into the output texture
+     * @retval false if the data for \p port has to be copied by the concatenation layer
+     *
+     * The view has the same dimensions as the (padded) input tensor of \p port.
+     */
+    virtual bool getInputView(int port, int & originX, int & originY) const = 0;
+
+    /**
+     * @brief Enable/disable the usage of an output view for the specified input port
+     *
+     * @param port Input port that is (not) served by its view
+     * @param enable If \c true, the producer of \p port renders into the output texture directly
+     *               and the port is exempt from the copy
+     */
+    virtual void useInputView(int port, bool enable) = 0;
+};
+
+}  // fyusenet namespace
+}  // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -20,6 +20,7 @@
 #include "../common/performance.h"
 #include "../cpu/cpulayerbase.h"
 #include "../cpu/cpubuffer.h"
+#include "../gl/glstate.h"
 #include "../gpu/uploadlayer.h"
 #include "../gpu/downloadlayer.h"
 #include "../gpu/deep/deepdownloadlayer.h"
@@ -137,6 +138,7 @@ void Engine::cleanup(const std::function<void()> & broom) {
     // ..and run cleanup
     // ---------------------------------------------
     if (setup_) {
+        recordings_.clear();
         auto brush = [broom, this]() {
             layers_.cleanup();
             if (broom) broom();
@@ -150,6 +152,7 @@ void Engine::cleanup(const std::function<void()> & broom) {
     }
 #else
     if (setup_) {
+        recordings_.clear();
         layers_.cleanup();
         if (broom) broom();
         setup_ = false;
@@ -220,6 +223,69 @@ void Engine::disableTimings() {
 }
 
 
+/**
+ * @brief Enable execution of GPU layers via recorded command streams
+ *
+ * When enabled, the GL commands that each (recordable) GPU layer issues in its forward() call are
+ * recorded into an opengl::CommandStream on the first run. Subsequent runs replay the recorded
+ * streams instead of calling forward(), which skips the virtual dispatch, the locking and the
+ * various checks inside the layers and thus reduces the CPU cost of issuing the commands.
+ *
+ * A stream is recorded again in case the texture bindings or parameters of its layer changed
+ * (see gpu::GPULayerBase::bindingRevision()). Upload and download layers as well as CPU layers
+ * are always executed normally.
+ *
+ * Recording is only supported for synchronous engines, this function is a no-op for asynchronous
+ * engines. Intermediate output (see enableIntermediateOutput()) executes all layers normally.
+ *
+ * @note Changing layer parameters that are not covered by the binding revision (for example
+ *       custom uniforms of user-defined layers) after the recording requires a call to
+ *       invalidateRecording().
+ *
+ * @warning This function is not thread-safe, do not call it in parallel to forwardLayers()
+ *
+ * @see disableRecording(), invalidateRecording(), gpu::GPULayerBase::isRecordable()
+ */
+void Engine::enableRecording() {
+#ifdef FYUSENET_MULTITHREADING
+    if (async_) {
+        FNLOGW("Recorded command streams are not supported for asynchronous engines");
+        return;
+    }
+#endif
+    recording_ = true;
+}
+
+
+/**
+ * @brief Disable execution of GPU layers via recorded command streams
+ *
+ * Discards all recorded command streams.
+ *
+ * @warning This function is not thread-safe, do not call it in parallel to forwardLayers()
+ *
+ * @see enableRecording()
+ */
+void Engine::disableRecording() {
+    recording_ = false;
+    recordings_.clear();
+}
+
+
+/**
+ * @brief Discard all recorded command streams
+ *
+ * The streams will be recorded again on the next run, in case recording is enabled.
+ *
+ * @warning This function is not thread-safe, do not call it in parallel to forwardLayers()
+ *
+ * @see enableRecording()
+ */
+void Engine::invalidateRecording() {
+    recordings_.clear();
+}
+
+
 /**
  * @brief Reset timing log data
  *
@@ -330,7 +396,7 @@ Engine::execstate Engine::forwardLayers() {
 #endif
     ExecutionState estate(sequenceNo_++, layers_.begin());
     state status = execute(estate, context_);
-    glDisable(GL_BLEND);
+    opengl::GLState::disable(GL_BLEND);
     return (status == state::DONE) ? execstate::EXEC_DONE : execstate::EXEC_ERROR;
 }
 
@@ -387,6 +453,8 @@ Engine::state Engine::execute(ExecutionState& state, const GfxContextLink & cont
     using namespace gpu;
     tstamp start, end;
     std::string fname;
+    // NOTE filter out redundant GL state changes between the layers, see opengl::GLState
+    opengl::GLState::Section glsection((context.interface()) ? context.interface()->glState() : nullptr);
     //-----------------------------------------------------------
     // Traverse through layers in ascending order of layer number
     //-----------------------------------------------------------
@@ -457,7 +525,7 @@ Engine::state Engine::execute(ExecutionState& state, const GfxContextLink & cont
                 //-----------------------------------------------------------
                 if (dynamic_cast<UploadLayer *>(layer)) {
                     UploadLayer * ul = dynamic_cast<UploadLayer *>(layer);
-                    if ((ul)->getInputBuffer() == nullptr) THROW_EXCEPTION_ARGS(FynException,"No input buffer in upload layer %s", ul->getName().c_str());
+                    if (!ul->hasPendingInput()) THROW_EXCEPTION_ARGS(FynException,"No input buffer in upload layer %s", ul->getName().c_str());
                     if (ul->isAsync()) {
 #ifdef FYUSENET_MULTITHREADING
                         //-----------------------------------------------------------
@@ -523,7 +591,7 @@ Engine::state Engine::execute(ExecutionState& state, const GfxContextLink & cont
                         DownloadLayer * dl = dynamic_cast<DownloadLayer *>(layer);
                         if (timings_) start = fy_get_stamp();
                         CPUBuffer * buf = dl->getOutputBuffer(0);
-                        if (!buf) THROW_EXCEPTION_ARGS(FynException,"No output buffer in download layer %s", dl->getName().c_str());
+                        if ((!buf) && (!dl->hasTargetRing())) THROW_EXCEPTION_ARGS(FynException,"No output buffer in download layer %s", dl->getName().c_str());
                         if (dl->isAsync()) {
 #ifdef FYUSENET_MULTITHREADING
                             //-----------------------------------------------------------
@@ -549,7 +617,7 @@ Engine::state Engine::execute(ExecutionState& state, const GfxContextLink & cont
                             if (runs_ == 0) timingData_[idx] = 0;
                             timingData_[idx] += fy_elapsed_micros(start, end);
                         }
-                        if ((writeResults_) && (!dl->isAsync())) {
+                        if ((writeResults_) && (!dl->isAsync()) && (!dl->hasTargetRing())) {
                             // TODO (mw) also handle write-out for asynchronous layers, currently they are ignored
                             buf->write<float>(fname.c_str());
                         }
@@ -558,7 +626,7 @@ Engine::state Engine::execute(ExecutionState& state, const GfxContextLink & cont
                             deep::DeepDownloadLayer * dl = dynamic_cast<deep::DeepDownloadLayer *>(layer);
                             if (timings_) start = fy_get_stamp();
                             CPUBuffer * buf = dl->getOutputBuffer(0);
-                            if (!buf) THROW_EXCEPTION_ARGS(FynException,"No output buffer in download layer %s", dl->getName().c_str());
+                            if ((!buf) && (!dl->hasTargetRing())) THROW_EXCEPTION_ARGS(FynException,"No output buffer in download layer %s", dl->getName().c_str());
                             if (dl->isAsync()) {
 #ifdef FYUSENET_MULTITHREADING
                                 //-----------------------------------------------------------
@@ -584,7 +652,7 @@ Engine::state Engine::execute(ExecutionState& state, const GfxContextLink & cont
                                 if (runs_ == 0) timingData_[idx] = 0;
                                 timingData_[idx] += fy_elapsed_micros(start, end);
                             }
-                            if ((writeResults_) && (!dl->isAsync())) {
+                            if ((writeResults_) && (!dl->isAsync()) && (!dl->hasTargetRing())) {
                                 // TODO (mw) missing handling of asynchronous stuff elsewhere
                                 buf->write<float>(fname.c_str());
                             }
@@ -593,12 +661,17 @@ Engine::state Engine::execute(ExecutionState& state, const GfxContextLink & cont
                             // Handle (standard) GPU layers...
                             //-------------------------------------------------------
                             if (timings_) start = fy_get_stamp();
-                            layer->forward(state.sequenceNo);
+                            if ((recording_) && (!writeResults_) && (opengl::GLState::current())) {
+                                forwardRecorded(static_cast<GPULayerBase *>(layer), idx, state.sequenceNo);
+                            } else layer->forward(state.sequenceNo);
                             if (timings_) {
                                 end = fy_get_stamp();
                                 if (runs_ == 0) timingData_[idx] = 0;
                                 timingData_[idx] += fy_elapsed_micros(start, end);
                             }
+                            if ((opengl::GLState::validation()) && (opengl::GLState::current())) {
+                                opengl::GLState::current()->validate();
+                            }
                             if (writeResults_) {
                                 (dynamic_cast<GPULayerBase *>(layer))->writeResult(fname.c_str());
                             }
@@ -683,6 +756,45 @@ Engine::state Engine::execute(ExecutionState& state, const GfxContextLink & cont
 }
 
 
+/**
+ * @brief Execute GPU layer via a recorded command stream
+ *
+ * @param layer Pointer to GPU layer to execute
+ * @param index Layer number
+ * @param sequenceNo Sequence number of the current run
+ *
+ * @pre Called within a tracked GL state section (see opengl::GLState::Section)
+ *
+ * Replays the recorded command stream of the \p layer, in case there is a stream that was
+ * recorded with the current binding revision of the layer. Otherwise the layer is executed by
+ * calling its forward() function while recording its GL commands. Layers that are not
+ * recordable are simply executed.
+ *
+ * @see enableRecording()
+ */
+void Engine::forwardRecorded(gpu::GPULayerBase *layer, int index, uint64_t sequenceNo) {
+    if (!layer->isRecordable()) {
+        layer->forward(sequenceNo);
+        return;
+    }
+    opengl::GLState * glstate = opengl::GLState::current();
+    RecordedLayer & rec = recordings_[index];
+    if ((rec.stream.isValid()) && (rec.revision == layer->bindingRevision())) {
+        rec.stream.replay(glstate);
+        return;
+    }
+    rec.stream.beginRecording(glstate);
+    try {
+        layer->forward(sequenceNo);
+    } catch (...) {
+        rec.stream.abortRecording();
+        throw;
+    }
+    rec.stream.endRecording();
+    rec.revision = layer->bindingRevision();
+}
+
+
 #ifdef FYUSENET_MULTITHREADING
 /**
  * @brief Callback for asynchronous upload layers
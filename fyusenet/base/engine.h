@@ -30,6 +30,7 @@
 #include "../gpu/gpulayerbase.h"
 #include "../gpu/downloadinterface.h"
 #include "../gpu/gfxcontexttracker.h"
+#include "../gl/commandstream.h"
 #ifdef FYUSENET_MULTITHREADING
 #include "../gl/asyncpool.h"
 #endif
@@ -94,6 +95,9 @@ class Engine : public fyusenet::GfxContextTracker {
     void disableIntermediateOutput();
     void enableTimings();
     void disableTimings();
+    void enableRecording();
+    void disableRecording();
+    void invalidateRecording();
     void setup(NeuralNetwork *net);
     void cleanup(const std::function<void()> & broom);
 
@@ -135,6 +139,7 @@ class Engine : public fyusenet::GfxContextTracker {
      */
     void setLayers(CompiledLayers layers) {
         layers_ = layers;
+        recordings_.clear();
     }
 
 
@@ -271,10 +276,21 @@ class Engine : public fyusenet::GfxContextTracker {
         ExecutionState state;                       //!< Actual state that is pending execution
     };
 
+    /**
+     * @brief Recorded command stream of a single GPU layer
+     *
+     * @see enableRecording(), forwardRecorded()
+     */
+    struct RecordedLayer {
+        opengl::CommandStream stream;               //!< Recorded GL commands of the layer
+        uint32_t revision = 0;                      //!< Binding revision of the layer at the time of recording
+    };
+
     // ------------------------------------------------------------------------
     // Non-public methods
     // ------------------------------------------------------------------------
     state execute(ExecutionState& state, const GfxContextLink & context);
+    void forwardRecorded(gpu::GPULayerBase *layer, int index, uint64_t sequenceNo);
 #ifdef FYUSENET_MULTITHREADING
     void waitForUploadFence(const GfxContextLink& ctx, GLsync sync, gpu::UploadLayer *target, GLuint64 timeout, uint64_t sequenceNo);
     void uploadCallback(gpu::UploadLayer * layer, uint64_t cbSequenceNo);
@@ -293,6 +309,7 @@ class Engine : public fyusenet::GfxContextTracker {
     std::mutex runGuard_;            //!< Simple guard to create partial thread-safety
     bool writeResults_ = false;      //!< Flag that controls if intermediate (layer-by-layer) results should be written to disk for debugging purposes
     bool timings_ = false;           //!< Flag that controls whether or not \b CPU timings should be kept on a layer-by-layer basis
+    bool recording_ = false;         //!< Flag that controls whether GPU layers are executed via recorded command streams
     bool setup_ = false;             //!< Indicator if engine was setup
     CompiledLayers layers_;          //!< Set of runnable layers generated by the network-specific code
 
@@ -302,6 +319,13 @@ class Engine : public fyusenet::GfxContextTracker {
      */
     std::unordered_map<int, uint32_t> timingData_;
 
+    /**
+     * Recorded command streams on a per-layer basis. Index is the layer number.
+     *
+     * @see enableRecording()
+     */
+    std::unordered_map<int, RecordedLayer> recordings_;
+
 #ifdef FYUSENET_MULTITHREADING
 
     std::mutex looperLock_;                     //!< Looper runtime lock, used in conjunction with #looperWait_
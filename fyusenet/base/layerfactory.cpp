@@ -94,6 +94,10 @@ CompiledLayers LayerFactory::compileLayers() {
         if (it->second->device_ == compute_device::DEV_CPU) {
             layers.setLayer(cpuBackend_->createLayer(it->second->type_, it->second, it->second->number_));
         } else {
+            auto prec = precisions_.find(it->first);
+            if ((prec != precisions_.end()) && (it->second->device_ == compute_device::DEV_GPU)) {
+                ((gpu::GPULayerBuilder *)it->second)->precision_ = prec->second;
+            }
             layers.setLayer(backend_->createLayer(it->second->type_, it->second, it->second->number_));
         }
     }
@@ -102,6 +106,24 @@ CompiledLayers LayerFactory::compileLayers() {
 
 
 
+/**
+ * @brief Override the floating-point precision of a GPU layer
+ *
+ * @param layerNumber Number of the layer to change the precision for
+ * @param precision Precision to use for that layer
+ *
+ * This overrides the precision that was set in the builder for the layer with the supplied
+ * \p layerNumber on compilation of the layers. It is used to change the precision of layers
+ * without modifying the code that sets up the builders. Overrides for non-GPU layers or for
+ * layer numbers that do not exist are ignored.
+ *
+ * @see gpu::GPULayerBuilderTempl::precision, NeuralNetwork::setLayerPrecision
+ */
+void LayerFactory::overridePrecision(int layerNumber, PrecisionType precision) {
+    precisions_[layerNumber] = precision;
+}
+
+
 /**
  * @brief Generate an instance of the layer factory with a target-specific backend
  *
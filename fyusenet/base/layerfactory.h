@@ -100,6 +100,7 @@ class LayerFactory : LayerFactoryInterface {
     std::string getName() const;
     virtual void pushBuilder(LayerBuilder *builder) override;
     virtual CompiledLayers compileLayers();
+    void overridePrecision(int layerNumber, PrecisionType precision);
 
     /**
      * @brief Get a usable LayerFactory instance
@@ -134,6 +135,7 @@ class LayerFactory : LayerFactoryInterface {
     LayerFactoryBackend *backend_;                      //!< Pointer to target-specific factory backend
     LayerFactoryBackend *cpuBackend_;                   //!< CPU factory backend (present in every factory)
     std::unordered_map<int,LayerBuilder *> builders_;   //!< Map of builders that contain the information about the layers to be built
+    std::unordered_map<int,PrecisionType> precisions_;  //!< Precision overrides for GPU layers, keyed by layer number
     CompiledLayers layers_;
 };
 
@@ -129,6 +129,17 @@ enum class CastTarget : uint8_t {
     CT_FLOAT32              //!< Cast to 32-bit float
 };
 
+/**
+ * @brief Floating-point precision for the computation and storage of GPU layers
+ *
+ * @see GPULayerBuilderTempl::precision
+ */
+enum class PrecisionType : uint8_t {
+    DEFAULT = 0,            //!< Use the library-wide default, which is controlled by the \c HIGH_PRECISION build flag
+    HALF,                   //!< Use 16-bit half-precision floating-point numbers where supported
+    FULL                    //!< Use 32-bit single-precision floating-point numbers
+};
+
 /**
  * @brief Enumerator for the various layer types implemented by this engine
  */
@@ -164,6 +175,11 @@ enum class LayerType : uint16_t {
     OESCONV,                //!< Conversion layer that converts OES textures to "normal" textures (EGL / Android only)
     BATCHNORM,              //!< Explicit batchnorm layer
     GEMM,                   //!< Generalized matrix/matrix multiplication, implemented as MV -> 1x1 conv here since we cannot batch anyway
+    POINTWISE_CHAIN,        //!< Fused chain of pooling/scaling and elementwise operations
+    SOFTMAX,                //!< Softmax / log-softmax layer
+    MATMUL,                 //!< (Batched) matrix multiplication of two runtime tensors
+    LAYERNORM,              //!< Layer normalization over the channels of each spatial position (or the whole tensor)
+    INSTANCENORM,           //!< Instance normalization over the spatial extent of each channel
     CUSTOM,                 //!< Custom layer
     LAST_SUPPORTED,         //!< Last supported layer type (+1)
     ILLEGAL = 1000          //!< Placeholder for illegal layer types
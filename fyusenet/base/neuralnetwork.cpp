@@ -14,6 +14,7 @@
 //-------------------------------------- Project  Headers ------------------------------------------
 
 #include "neuralnetwork.h"
+#include "../gl/shadercompiler.h"
 
 //-------------------------------------- Global Variables ------------------------------------------
 
@@ -228,6 +229,10 @@ void NeuralNetwork::asynchronous(const AsyncAdapter & adapter) {
  * allocates GPU resources for the intermediate tensors. This is followed by the weight
  * initialization of the network layers and finally LayerBase::setup() is invoked on every layer.
  *
+ * The layer setup is wrapped into a submission phase of the opengl::ShaderCompiler, such that
+ * the shader programs of all layers are compiled in parallel (where supported) and their link
+ * status is only checked once all layers have been set up.
+ *
  * This function may either be called directly from the main thread (if multithreading is not
  * compiled in), or from the engine thread. It is important to perform all inference calls to the
  * created network from the same thread, because the intermediate %FBOs that the layers write to
@@ -242,14 +247,75 @@ CompiledLayers NeuralNetwork::glSetup() {
     if (!bufferMgr_) bufferMgr_ = new BufferManager(context());
     connectLayers(layers, bufferMgr_);
     initializeWeights(layers);
-    for (auto it = layers.begin(); it != layers.end(); ++it) {
-        assert(it.second);
-        it.second->setup();
+    opengl::ShaderCompiler * compiler = opengl::ShaderCompiler::getInstance(context());
+    compiler->beginSubmission();
+    try {
+        for (auto it = layers.begin(); it != layers.end(); ++it) {
+            assert(it.second);
+            it.second->setup();
+        }
+    } catch (...) {
+        compiler->cancel();
+        throw;
     }
+    compiler->finish();
     return layers;
 }
 
 
+/**
+ * @brief Override the floating-point precision of a single GPU layer in the network
+ *
+ * @param layerNumber Number of the layer to change the precision for
+ * @param precision Precision to use for that layer
+ *
+ * @throws FynException in case the network has already been set up
+ *
+ * This function changes the precision of the layer with the supplied \p layerNumber, overriding
+ * the precision that was set in the builder of that layer (see gpu::GPULayerBuilderTempl::precision).
+ * It is useful to evaluate different precision assignments for the same network without changing
+ * the network code, see PrecisionAdvisor.
+ *
+ * @pre Network has not been set up yet
+ *
+ * @note The overrides only apply to layers that are created with a factory obtained by
+ *       getLayerFactory().
+ */
+void NeuralNetwork::setLayerPrecision(int layerNumber, PrecisionType precision) {
+    if (setup_) THROW_EXCEPTION_ARGS(FynException,"Cannot change layer precision after network setup");
+    precisions_[layerNumber] = precision;
+}
+
+
+/**
+ * @brief Remove all precision overrides that were set by setLayerPrecision()
+ *
+ * @throws FynException in case the network has already been set up
+ */
+void NeuralNetwork::clearLayerPrecisions() {
+    if (setup_) THROW_EXCEPTION_ARGS(FynException,"Cannot change layer precision after network setup");
+    precisions_.clear();
+}
+
+
+/**
+ * @brief Retrieve the numbers of all layers in the network that run on a specific device
+ *
+ * @param dev Device type to filter the layers by
+ *
+ * @return List of layer numbers in ascending order, empty list if the network was not set up
+ */
+std::vector<int> NeuralNetwork::getLayerNumbers(compute_device dev) {
+    std::vector<int> result;
+    if ((!setup_) || (!engine_)) return result;
+    CompiledLayers & layers = engine_->getLayers();
+    for (auto it = layers.begin(); it != layers.end(); ++it) {
+        if ((it.second) && (it.second->getDevice() == dev)) result.push_back(it.first);
+    }
+    return result;
+}
+
+
 /**
  * @brief Obtain network layer factory for a specific compute device type
  *
@@ -265,8 +331,11 @@ std::shared_ptr<LayerFactory> NeuralNetwork::getLayerFactory(compute_device dev)
             assert(false);
         case compute_device::DEV_NPU:
             assert(false);
-        default:
-            return LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::SPECIALIZED));
+        default: {
+            std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::SPECIALIZED));
+            for (auto it = precisions_.begin(); it != precisions_.end(); ++it) factory->overridePrecision(it->first, it->second);
+            return factory;
+        }
     };
 }
 
@@ -178,6 +178,9 @@ class NeuralNetwork : public GfxContextTracker {
     virtual void setup();
     virtual execstate forward();
     virtual execstate finish();
+    void setLayerPrecision(int layerNumber, PrecisionType precision);
+    void clearLayerPrecisions();
+    std::vector<int> getLayerNumbers(compute_device dev = compute_device::DEV_GPU);
 #ifdef FYUSENET_MULTITHREADING
     virtual void asynchronous(const AsyncAdapter & adapter = AsyncAdapter());
 #endif
@@ -258,6 +261,7 @@ class NeuralNetwork : public GfxContextTracker {
     Engine * engine_ = nullptr;                       //!< Pointer to execution engine
     BufferManager * bufferMgr_ = nullptr;             //!< Texture/buffer manager TODO (mw) move buffermanager out of the network
     bool setup_ = false;                              //!< Indicator if network was set up
+    std::unordered_map<int, PrecisionType> precisions_;   //!< Per-layer precision overrides, see setLayerPrecision()
 };
 
 
@@ -0,0 +1,136 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Mixed-Precision Advisor
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "precisionadvisor.h"
+#include "../common/fynexception.h"
+#include "../common/logging.h"
+
+namespace fyusion {
+namespace fyusenet {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @brief Constructor
+ *
+ * @param layers Numbers of the layers that are subject to precision selection, layers that are
+ *               not listed here keep their default precision
+ *
+ * @param eval Function that runs the network with the supplied precision assignment and
+ *             returns the network output
+ */
+PrecisionAdvisor::PrecisionAdvisor(const std::vector<int>& layers, evaluator eval) :
+      layers_(layers), eval_(eval) {
+    if (!eval_) THROW_EXCEPTION_ARGS(FynException,"No evaluation function supplied");
+}
+
+
+/**
+ * @brief Determine precision assignment for the candidate layers
+ *
+ * @param maxError Maximum absolute deviation of the network output from the full-precision
+ *                 output that is acceptable
+ *
+ * @return Precision assignment for all candidate layers
+ *
+ * @throws FynException in case the evaluation function returns outputs of different sizes
+ *
+ * @see PrecisionAdvisor for a description of the search
+ */
+PrecisionAdvisor::assignment PrecisionAdvisor::suggest(float maxError) {
+    sensitivities_.clear();
+    std::vector<float> reference = eval_(uniform(PrecisionType::FULL));
+    assignment result = uniform(PrecisionType::FULL);
+    error_ = 0.0f;
+    //------------------------------------------------------
+    // Measure the error of each layer in isolation...
+    //------------------------------------------------------
+    for (int layer : layers_) {
+        assignment single = uniform(PrecisionType::FULL);
+        single[layer] = PrecisionType::HALF;
+        sensitivities_[layer] = maxAbsError(eval_(single), reference);
+        FNLOGD("Layer %d error in half precision: %e", layer, sensitivities_[layer]);
+    }
+    //------------------------------------------------------
+    // ...and greedily switch layers to half precision, the
+    // least sensitive ones first
+    //------------------------------------------------------
+    std::vector<int> order = layers_;
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return sensitivities_.at(a) < sensitivities_.at(b);
+    });
+    for (int layer : order) {
+        if (sensitivities_.at(layer) > maxError) break;
+        result[layer] = PrecisionType::HALF;
+        float err = maxAbsError(eval_(result), reference);
+        if (err > maxError) result[layer] = PrecisionType::FULL;
+        else error_ = err;
+    }
+    return result;
+}
+
+
+/**
+ * @brief Compute maximum absolute difference between two sets of numbers
+ *
+ * @param data Data to compare
+ * @param reference Reference data to compare against
+ *
+ * @return Maximum absolute difference, or infinity if \p data contains non-finite numbers
+ *
+ * @throws FynException in case the sizes of \p data and \p reference do not match
+ */
+float PrecisionAdvisor::maxAbsError(const std::vector<float>& data, const std::vector<float>& reference) {
+    if (data.size() != reference.size()) THROW_EXCEPTION_ARGS(FynException,"Output size mismatch (%d vs %d)", (int)data.size(), (int)reference.size());
+    float err = 0.0f;
+    for (size_t i=0; i < data.size(); i++) {
+        if (!std::isfinite(data[i])) return std::numeric_limits<float>::infinity();
+        err = std::max(err, std::abs(data[i] - reference[i]));
+    }
+    return err;
+}
+
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+
+/**
+ * @brief Create assignment that sets all candidate layers to the same precision
+ *
+ * @param precision Precision to assign
+ *
+ * @return Assignment with all candidate layers set to \p precision
+ */
+PrecisionAdvisor::assignment PrecisionAdvisor::uniform(PrecisionType precision) const {
+    assignment result;
+    for (int layer : layers_) result[layer] = precision;
+    return result;
+}
+
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,118 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Mixed-Precision Advisor (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "layerflags.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+
+namespace fyusion {
+namespace fyusenet {
+
+/**
+ * @brief Suggests per-layer precision assignments based on measured errors
+ *
+ * Running all layers of a network in half precision is usually the fastest option, as it halves
+ * the texture bandwidth. Some layers however, in particular those which accumulate over a large
+ * number of elements (e.g. final fully-connected layers or global pooling), may introduce errors
+ * that are too large for the application. This class determines a precision assignment that runs
+ * as many layers as possible in half precision, while keeping the deviation of the network
+ * output from a full-precision run within a user-supplied error budget.
+ *
+ * The network itself is treated as a black box, which is represented by an evaluation function.
+ * That function receives a precision assignment, runs the network with that assignment (for
+ * example by using NeuralNetwork::setLayerPrecision() on a fresh network instance) and returns
+ * the network output as a flat list of numbers. The search works as follows:
+ *   1. Run the network with all candidate layers in full precision to obtain a reference
+ *   2. For each candidate layer, run the network with only that layer in half precision and
+ *      record the error to the reference (the sensitivity of the layer)
+ *   3. In the order of ascending sensitivity, switch layers to half precision and keep that
+ *      change if the error of the complete assignment stays within the budget
+ *
+ * This requires <tt>2N+1</tt> evaluations for \c N candidate layers. The error is measured as
+ * maximum absolute difference between the outputs.
+ *
+ * @code
+ * PrecisionAdvisor advisor(layerNumbers, [&](const PrecisionAdvisor::assignment& prec) {
+ *     MyNetwork net(ctx);
+ *     for (auto it : prec) net.setLayerPrecision(it.first, it.second);
+ *     net.setup();
+ *     ...
+ *     return output;
+ * });
+ * PrecisionAdvisor::assignment prec = advisor.suggest(0.01f);
+ * @endcode
+ *
+ * @see NeuralNetwork::setLayerPrecision, gpu::GPULayerBuilderTempl::precision
+ */
+class PrecisionAdvisor {
+ public:
+    using assignment = std::unordered_map<int, PrecisionType>;
+    using evaluator = std::function<std::vector<float>(const assignment&)>;
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    PrecisionAdvisor(const std::vector<int>& layers, evaluator eval);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    assignment suggest(float maxError);
+
+    /**
+     * @brief Retrieve the error of the individual layers measured by suggest()
+     *
+     * @return Map of layer numbers to the error that is caused by running only that layer
+     *         in half precision
+     */
+    const std::unordered_map<int, float> & sensitivities() const {
+        return sensitivities_;
+    }
+
+    /**
+     * @brief Retrieve the error of the assignment that was returned by the last call to suggest()
+     *
+     * @return Maximum absolute deviation of the network output from the full-precision output
+     */
+    float error() const {
+        return error_;
+    }
+
+    static float maxAbsError(const std::vector<float>& data, const std::vector<float>& reference);
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    assignment uniform(PrecisionType precision) const;
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    std::vector<int> layers_;                           //!< Layer numbers that are subject to precision selection
+    evaluator eval_;                                    //!< Function that runs the network with a supplied assignment
+    std::unordered_map<int, float> sensitivities_;      //!< Per-layer errors, see sensitivities()
+    float error_ = 0.0f;                                //!< Error of the last suggested assignment
+};
+
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -23,6 +23,7 @@
 #include "../gl/gl_sys.h"
 #include "../gl/pbo.h"
 #include "../gpu/deep/deeptiler.h"
+#include "../gpu/floatconversion.h"
 #include "../base/layerbase.h"
 #include "../common/logging.h"
 
@@ -286,6 +287,11 @@ void CPUBuffer::write(const char *fileName) const {
             free(tmp);
             break;
         }
+        case CPUBufferShape::order::GPU_DEEP_ARRAY:
+#ifndef FYUSENET_USE_WEBGL
+            fclose(out);
+#endif
+            THROW_EXCEPTION_ARGS(FynException,"Texture-array data order is not supported for CPU buffers");
     }
 #ifndef FYUSENET_USE_WEBGL
     fclose(out);
@@ -304,7 +310,8 @@ void CPUBuffer::write(const char *fileName) const {
  *
  * @param pbo Source PBO to read data from
  *
- * @param type Data type of the CPU buffer
+ * @param type Data type of the data in the \p pbo , either \c FLOAT32 or \c FLOAT16 . In the
+ *             latter case, the data is converted to single-precision on the fly
  *
  * @param sequenceNo Sequence number to assign to this buffer (which should be the sequence number
  *                   of the content currently in the %PBO)
@@ -314,11 +321,12 @@ void CPUBuffer::write(const char *fileName) const {
  *
  * This function reads the content of the supplied \p pbo into this buffer instance.
  *
- * @warning This function currently only supports \c FLOAT32 data types
+ * @warning This function currently only supports \c FLOAT32 buffers
  */
 bool CPUBuffer::readFromPBO(opengl::PBO * pbo, CPUBufferShape::type type, uint64_t sequenceNo) {
-    // TODO (mw) incorporate type parameter, by performing type conversions
-    assert(type == CPUBufferShape::type::FLOAT32);
+    // TODO (mw) incorporate other types
+    assert((type == CPUBufferShape::type::FLOAT32) || (type == CPUBufferShape::type::FLOAT16));
+    assert(shape_.dataType() == CPUBufferShape::type::FLOAT32);
     if (!memory_) return false;
 #ifdef DEBUG
     glGetError();
@@ -343,13 +351,16 @@ bool CPUBuffer::readFromPBO(opengl::PBO * pbo, CPUBufferShape::type type, uint64
     }
 #endif
     size_t sz = pbo->capacity();
-    if (sz > cap) {
+    size_t outsz = (type == CPUBufferShape::type::FLOAT16) ? 2 * sz : sz;
+    if (outsz > cap) {
         pbo->unmapReadBuffer();
         pbo->unbind(GL_PIXEL_PACK_BUFFER);
         unmap();
         THROW_EXCEPTION_ARGS(FynException,"Refusing to read from PBO as this would exceed buffer size");
     }
-    memcpy(tgt, src, sz);
+    if (type == CPUBufferShape::type::FLOAT16) {
+        gpu::FloatConversion::getInstance()->toFloat((const uint16_t *)src, (float *)tgt, sz / sizeof(uint16_t));
+    } else memcpy(tgt, src, sz);
     unmap();
     pbo->unmapReadBuffer();
     pbo->unbind();
@@ -392,6 +403,9 @@ GLuint CPUBuffer::typeToGLType(CPUBufferShape::type type) {
         case CPUBufferShape::INT8:
             gltype = GL_BYTE;
             break;
+        case CPUBufferShape::FLOAT16:
+            gltype = GL_HALF_FLOAT;
+            break;
         default:
             THROW_EXCEPTION_ARGS(FynException,"Illegal data type supplied");
     }
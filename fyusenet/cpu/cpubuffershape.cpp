@@ -207,6 +207,8 @@ CPUBufferShape CPUBufferShape::asOrder(order newOrder) const {
             assert(tileHeight_ > 0);
             return CPUBufferShape(tileHeight_, tileWidth_, channels_, padding_, dataType_, newOrder);
             }
+        case order::GPU_DEEP_ARRAY:
+            THROW_EXCEPTION_ARGS(FynException,"Texture-array data order is not supported for CPU buffers");
     }
     THROW_EXCEPTION_ARGS(FynException,"Cannot handle shape conversion");
 }
@@ -239,7 +241,7 @@ CPUBuffer * CPUBufferShape::createBuffer(order order) const {
  * @return Number of bytes per element for the provided data-type
  */
 size_t CPUBufferShape::typeSize(const type dType) {
-    static int sizelut[NUM_TYPES] = {4,4,2,1,4,2,1};
+    static int sizelut[NUM_TYPES] = {4,4,2,1,4,2,1,2};
     if (dType >= NUM_TYPES) THROW_EXCEPTION_ARGS(FynException,"Illegal type %d", (int)dType);
     return sizelut[dType];
 }
@@ -71,6 +71,7 @@ class CPUBufferShape {
         INT32,              //!< Data is stored as 32-bit signed integer
         INT16,              //!< Data is stored as 16-bit signed integer
         INT8,               //!< Data is stored as 8-bit signed integer
+        FLOAT16,            //!< Data is stored as 16-bit half-precision IEEE-754 floating point
         NUM_TYPES
     };
 
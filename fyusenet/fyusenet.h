@@ -26,6 +26,7 @@
 #include "gpu/gfxcontexttracker.h"
 #include "base/compiledlayers.h"
 #include "base/neuralnetwork.h"
+#include "base/precisionadvisor.h"
 #include "base/engine.h"
 #include "base/layerflags.h"
 #include "base/layerbuilder.h"
@@ -58,6 +59,7 @@
 #include "gpu/poollayerbuilder.h"
 #include "gpu/updownlayerbuilder.h"
 #include "gpu/transposelayerbuilder.h"
+#include "gpu/pointwisechainbuilder.h"
 
 
 // vim: set expandtab ts=4 sw=4:
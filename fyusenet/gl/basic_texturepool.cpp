@@ -16,6 +16,7 @@
 
 #include "../common/logging.h"
 #include "basic_texturepool.h"
+#include "glstate.h"
 
 //-------------------------------------- Global Variables ------------------------------------------
 
@@ -108,7 +109,7 @@ std::shared_ptr<GLuint> BasicTexturePool::obtainTexture(int width, int height, i
         key k(width, height, channels, type);
         GLuint handle=0;
         glGenTextures(1, &handle);
-        glBindTexture(GL_TEXTURE_2D, handle);
+        GLState::bindTexture(GL_TEXTURE_2D, handle);
         Texture::texinfo info = Texture::textureInfo(type, channels);
         glTexImage2D(GL_TEXTURE_2D, 0, info.intFormat, width, height, 0, info.format, info.dataType, nullptr);
 #ifdef DEBUG
@@ -276,7 +277,7 @@ std::shared_ptr<GLuint> BasicTexturePool::findTexture(int width, int height, int
 void BasicTexturePool::textureDel(GLuint * handlePtr) {
     // TODO (mw) check for context ?
     if (handlePtr) {
-        glDeleteTextures(1, handlePtr);
+        GLState::deleteTextures(1, handlePtr);
         delete [] handlePtr;
     }
 }
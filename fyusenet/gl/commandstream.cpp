@@ -0,0 +1,323 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Recorded GL Command Stream
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cassert>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "commandstream.h"
+#include "glstate.h"
+#include "shaderprogram.h"
+#include "glexception.h"
+
+//-------------------------------------- Global Variables ------------------------------------------
+namespace fyusion {
+namespace opengl {
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @brief Constructor
+ *
+ * Creates an empty (invalid) stream.
+ */
+CommandStream::CommandStream() {
+}
+
+
+/**
+ * @brief Destructor
+ */
+CommandStream::~CommandStream() {
+    abortRecording();
+    delete endState_;
+}
+
+
+/**
+ * @brief Start recording of GL commands into this stream
+ *
+ * @param state Pointer to state instance that is tracked on the calling thread
+ *
+ * @pre The supplied \p state is tracked on the calling thread (see GLState::Section)
+ *
+ * Discards any previous content of the stream and starts recording all calls that are routed
+ * through the supplied \p state until endRecording() is called. The shadow state is invalidated,
+ * such that all state changes are part of the recording.
+ *
+ * @throws GLException if the \p state is not tracked on the calling thread or already recording
+ */
+void CommandStream::beginRecording(GLState *state) {
+    if ((!state) || (state != GLState::current())) THROW_EXCEPTION_ARGS(GLException, "Recording requires a tracked GL state");
+    if (state->recorder_) THROW_EXCEPTION_ARGS(GLException, "GL state is already recording");
+    clear();
+    state->invalidate();
+    state->recorder_ = this;
+    recordState_ = state;
+}
+
+
+/**
+ * @brief Finish recording of GL commands
+ *
+ * Marks the stream as valid and stores a copy of the shadow state, which is restored by replay().
+ */
+void CommandStream::endRecording() {
+    if (!recordState_) return;
+    recordState_->recorder_ = nullptr;
+    if (!endState_) endState_ = new GLState();
+    *endState_ = *recordState_;
+    recordState_ = nullptr;
+    valid_ = true;
+}
+
+
+/**
+ * @brief Stop a running recording without marking the stream as valid
+ *
+ * This is mainly intended for error handling, for example in case the recorded code raised an
+ * exception.
+ */
+void CommandStream::abortRecording() {
+    if (recordState_) {
+        recordState_->recorder_ = nullptr;
+        recordState_ = nullptr;
+    }
+    valid_ = false;
+}
+
+
+/**
+ * @brief Remove all commands from the stream
+ *
+ * @post Stream is invalid
+ */
+void CommandStream::clear() {
+    commands_.clear();
+    pool_.clear();
+    valid_ = false;
+}
+
+
+/**
+ * @brief Record uniform update on a shader program
+ *
+ * @param program Pointer to program that the uniform is set on (must be in use)
+ * @param op Operation code, one of the \c UNIFORM_ codes
+ * @param location Location of the uniform in the program
+ * @param count Number of elements (for arrays, 1 otherwise)
+ * @param data Pointer to uniform value(s), which are copied to the stream
+ * @param words Number of 32-bit words in \p data
+ * @param transpose For matrix uniforms, indicates whether the matrices should be transposed
+ */
+void CommandStream::recordUniform(ShaderProgram *program, opcode op, GLint location, GLsizei count, const void *data, size_t words, bool transpose) {
+    assert((op >= UNIFORM_1I) && (op <= UNIFORM_MAT4));
+    recordArray(op, (GLuint)location, (GLuint)count, data, words);
+    Command & cmd = commands_.back();
+    cmd.args.u[4] = (transpose) ? 1 : 0;
+    cmd.ext = (uint64_t)(uintptr_t)program;
+}
+
+
+/**
+ * @brief Record update of the applied uniform state on a shader program
+ *
+ * @param program Pointer to program that a UniformState was applied to
+ * @param key Key of the applied UniformState
+ *
+ * @see UniformState::applyState()
+ */
+void CommandStream::recordProgramState(ShaderProgram *program, uint64_t key) {
+    recordExt(PROGRAM_STATE, (GLuint)(key & 0xFFFFFFFF), (GLuint)(key >> 32), 0, 0, (uint64_t)(uintptr_t)program);
+}
+
+
+/**
+ * @brief Issue all recorded commands to GL
+ *
+ * @param state Pointer to state instance that is tracked on the calling thread, may be \c nullptr
+ *
+ * @pre The stream is valid and the GL context it was recorded in is current to the calling thread
+ *
+ * Executes the recorded commands in order. If a \p state is supplied, its shadow state is set
+ * to the state at the end of the recording afterwards.
+ *
+ * @warning All objects that are referenced in the stream must still be alive.
+ */
+void CommandStream::replay(GLState *state) const {
+    assert(valid_);
+    const uint32_t * pool = pool_.data();
+    for (const Command & cmd : commands_) {
+        const GLuint * u = cmd.args.u;
+        switch (cmd.op) {
+            case USE_PROGRAM:
+                glUseProgram(u[0]);
+                break;
+            case BIND_VAO:
+                glBindVertexArray(u[0]);
+                break;
+            case BIND_FBO:
+                glBindFramebuffer(u[0], u[1]);
+                break;
+            case ACTIVE_TEXTURE:
+                glActiveTexture(u[0]);
+                break;
+            case BIND_TEXTURE:
+                glBindTexture(u[0], u[1]);
+                break;
+            case ENABLE:
+                glEnable(u[0]);
+                break;
+            case DISABLE:
+                glDisable(u[0]);
+                break;
+            case BLEND_EQUATION:
+                glBlendEquationSeparate(u[0], u[1]);
+                break;
+            case BLEND_FUNC:
+                glBlendFuncSeparate(u[0], u[1], u[2], u[3]);
+                break;
+            case VIEWPORT:
+                glViewport(cmd.args.i[0], cmd.args.i[1], cmd.args.i[2], cmd.args.i[3]);
+                break;
+            case SCISSOR:
+                glScissor(cmd.args.i[0], cmd.args.i[1], cmd.args.i[2], cmd.args.i[3]);
+                break;
+            case CLEAR_COLOR:
+                glClearColor(cmd.args.f[0], cmd.args.f[1], cmd.args.f[2], cmd.args.f[3]);
+                break;
+            case CLEAR:
+                glClear(u[0]);
+                break;
+            case CLEAR_BUFFERFV:
+                glClearBufferfv(u[0], cmd.args.i[1], (const GLfloat *)(pool + u[2]));
+                break;
+            case DRAW_ELEMENTS:
+                glDrawElements(u[0], (GLsizei)u[1], u[2], (const void *)(uintptr_t)cmd.ext);
+                break;
+            case DRAW_ELEMENTS_INSTANCED:
+                glDrawElementsInstanced(u[0], (GLsizei)u[1], u[2], (const void *)(uintptr_t)cmd.ext, (GLsizei)u[3]);
+                break;
+            case DRAW_ARRAYS:
+                glDrawArrays(u[0], cmd.args.i[1], (GLsizei)u[2]);
+                break;
+            case DRAW_ARRAYS_INSTANCED:
+                glDrawArraysInstanced(u[0], cmd.args.i[1], (GLsizei)u[2], (GLsizei)u[3]);
+                break;
+            case DRAW_BUFFERS:
+                glDrawBuffers((GLsizei)u[0], (const GLenum *)(pool + u[2]));
+                break;
+            case INVALIDATE_FBO:
+#ifndef __APPLE__
+                glInvalidateFramebuffer(u[0], (GLsizei)u[1], (const GLenum *)(pool + u[2]));
+#endif
+                break;
+            case STENCIL_FUNC:
+                glStencilFuncSeparate(u[0], u[1], cmd.args.i[2], u[3]);
+                break;
+            case STENCIL_OP:
+                glStencilOp(u[0], u[1], u[2]);
+                break;
+            case STENCIL_MASK:
+                glStencilMask(u[0]);
+                break;
+            case DEPTH_FUNC:
+                glDepthFunc(u[0]);
+                break;
+            case DEPTH_MASK:
+                glDepthMask((GLboolean)u[0]);
+                break;
+            case TEX_PARAMETER:
+                glTexParameteri(u[0], u[1], cmd.args.i[2]);
+                break;
+            case BIND_BUFFER_BASE:
+                glBindBufferBase(u[0], u[1], u[2]);
+                break;
+            case BIND_BUFFER_RANGE:
+                glBindBufferRange(u[0], u[1], u[2], (GLintptr)cmd.ext, (GLsizeiptr)u[3]);
+                break;
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
+            case BIND_IMAGE_TEXTURE:
+                glBindImageTexture(u[0], u[1], (GLint)((cmd.ext >> 1) & 0xFFFF), (GLboolean)(cmd.ext & 1), (GLint)(cmd.ext >> 32), u[2], u[3]);
+                break;
+            case DISPATCH_COMPUTE:
+                glDispatchCompute(u[0], u[1], u[2]);
+                break;
+            case MEMORY_BARRIER:
+                glMemoryBarrier(u[0]);
+                break;
+#endif
+            case PROGRAM_STATE:
+                ((ShaderProgram *)(uintptr_t)cmd.ext)->appliedState_ = ((uint64_t)u[1] << 32) | (uint64_t)u[0];
+                break;
+            default: {
+                // NOTE remaining opcodes are uniform updates
+                ((ShaderProgram *)(uintptr_t)cmd.ext)->appliedState_ = 0;
+                GLint loc = cmd.args.i[0];
+                GLsizei count = (GLsizei)u[1];
+                const uint32_t * data = pool + u[2];
+                switch (cmd.op) {
+                    case UNIFORM_1I:
+                        glUniform1iv(loc, count, (const GLint *)data);
+                        break;
+                    case UNIFORM_2I:
+                        glUniform2iv(loc, count, (const GLint *)data);
+                        break;
+                    case UNIFORM_3I:
+                        glUniform3iv(loc, count, (const GLint *)data);
+                        break;
+                    case UNIFORM_4I:
+                        glUniform4iv(loc, count, (const GLint *)data);
+                        break;
+                    case UNIFORM_4UI:
+                        glUniform4uiv(loc, count, (const GLuint *)data);
+                        break;
+                    case UNIFORM_1F:
+                        glUniform1fv(loc, count, (const GLfloat *)data);
+                        break;
+                    case UNIFORM_2F:
+                        glUniform2fv(loc, count, (const GLfloat *)data);
+                        break;
+                    case UNIFORM_3F:
+                        glUniform3fv(loc, count, (const GLfloat *)data);
+                        break;
+                    case UNIFORM_4F:
+                        glUniform4fv(loc, count, (const GLfloat *)data);
+                        break;
+                    case UNIFORM_MAT3:
+                        glUniformMatrix3fv(loc, count, (GLboolean)u[4], (const GLfloat *)data);
+                        break;
+                    case UNIFORM_MAT4:
+                        glUniformMatrix4fv(loc, count, (GLboolean)u[4], (const GLfloat *)data);
+                        break;
+                    default:
+                        assert(false);
+                }
+                break;
+            }
+        }
+    }
+    if ((state) && (endState_)) {
+        CommandStream * rec = state->recorder_;
+        *state = *endState_;
+        state->recorder_ = rec;
+    }
+}
+
+} // opengl namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
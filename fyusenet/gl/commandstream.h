@@ -0,0 +1,241 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Recorded GL Command Stream (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gl_sys.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace opengl {
+
+class GLState;
+class ShaderProgram;
+
+/**
+ * @brief Compact list of GL commands that can be recorded once and replayed many times
+ *
+ * For a fixed network, the GL commands that are issued by a (synchronous) GPU layer are the same
+ * on every run: the same framebuffers, textures, programs, uniform values and draw parameters.
+ * Issuing them through the layer code itself involves virtual calls, locking, lookups and the
+ * evaluation of various conditions which all yield the same result each time.
+ *
+ * This class captures the GL commands as plain handles and values while the layer is executed
+ * once. Recording is done by GLState, which routes the relevant GL calls. Subsequent runs can
+ * then replay() the stream with a tight interpreter loop, which is the closest we can get to
+ * a command buffer on GLES.
+ *
+ * A stream captures the shadow state of the GLState at the end of the recording, which is restored
+ * after each replay, such that filtering of redundant state changes continues to work for code
+ * that is executed after a replay. In order to make the stream independent of the GL state before
+ * the recording, the shadow state is invalidated when the recording starts.
+ *
+ * @warning A stream only contains the calls that are routed through GLState and ShaderProgram.
+ *          Code that issues other GL calls (for example buffer or texture uploads) or that issues
+ *          different commands on each run must not be recorded.
+ *
+ * @see GLState, fyusenet::Engine::enableRecording()
+ */
+class CommandStream {
+    friend class GLState;
+ public:
+    /**
+     * @brief Operation codes for recorded commands
+     */
+    enum opcode : uint16_t {
+        USE_PROGRAM = 0,                //!< \c glUseProgram
+        BIND_VAO,                       //!< \c glBindVertexArray
+        BIND_FBO,                       //!< \c glBindFramebuffer
+        ACTIVE_TEXTURE,                 //!< \c glActiveTexture
+        BIND_TEXTURE,                   //!< \c glBindTexture
+        ENABLE,                         //!< \c glEnable
+        DISABLE,                        //!< \c glDisable
+        BLEND_EQUATION,                 //!< \c glBlendEquationSeparate
+        BLEND_FUNC,                     //!< \c glBlendFuncSeparate
+        VIEWPORT,                       //!< \c glViewport
+        SCISSOR,                        //!< \c glScissor
+        CLEAR_COLOR,                    //!< \c glClearColor
+        CLEAR,                          //!< \c glClear
+        CLEAR_BUFFERFV,                 //!< \c glClearBufferfv
+        DRAW_ELEMENTS,                  //!< \c glDrawElements
+        DRAW_ELEMENTS_INSTANCED,        //!< \c glDrawElementsInstanced
+        DRAW_ARRAYS,                    //!< \c glDrawArrays
+        DRAW_ARRAYS_INSTANCED,          //!< \c glDrawArraysInstanced
+        DRAW_BUFFERS,                   //!< \c glDrawBuffers
+        INVALIDATE_FBO,                 //!< \c glInvalidateFramebuffer
+        STENCIL_FUNC,                   //!< \c glStencilFuncSeparate
+        STENCIL_OP,                     //!< \c glStencilOp
+        STENCIL_MASK,                   //!< \c glStencilMask
+        DEPTH_FUNC,                     //!< \c glDepthFunc
+        DEPTH_MASK,                     //!< \c glDepthMask
+        TEX_PARAMETER,                  //!< \c glTexParameteri
+        BIND_BUFFER_BASE,               //!< \c glBindBufferBase
+        BIND_BUFFER_RANGE,              //!< \c glBindBufferRange
+        UNIFORM_1I,                     //!< \c glUniform1iv
+        UNIFORM_2I,                     //!< \c glUniform2iv
+        UNIFORM_3I,                     //!< \c glUniform3iv
+        UNIFORM_4I,                     //!< \c glUniform4iv
+        UNIFORM_4UI,                    //!< \c glUniform4uiv
+        UNIFORM_1F,                     //!< \c glUniform1fv
+        UNIFORM_2F,                     //!< \c glUniform2fv
+        UNIFORM_3F,                     //!< \c glUniform3fv
+        UNIFORM_4F,                     //!< \c glUniform4fv
+        UNIFORM_MAT3,                   //!< \c glUniformMatrix3fv
+        UNIFORM_MAT4,                   //!< \c glUniformMatrix4fv
+        BIND_IMAGE_TEXTURE,             //!< \c glBindImageTexture
+        DISPATCH_COMPUTE,               //!< \c glDispatchCompute
+        MEMORY_BARRIER,                 //!< \c glMemoryBarrier
+        PROGRAM_STATE                  //!< Update of the applied UniformState of a ShaderProgram
+    };
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    CommandStream();
+    CommandStream(const CommandStream&) = delete;
+    ~CommandStream();
+    CommandStream & operator=(const CommandStream&) = delete;
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    void beginRecording(GLState *state);
+    void endRecording();
+    void abortRecording();
+    void replay(GLState *state) const;
+    void clear();
+
+    /**
+     * @brief Check if stream contains a complete recording
+     *
+     * @retval true if the stream was recorded and can be replayed
+     * @retval false otherwise
+     */
+    bool isValid() const {
+        return valid_;
+    }
+
+    /**
+     * @brief Retrieve number of commands in the stream
+     *
+     * @return Number of recorded commands
+     */
+    size_t size() const {
+        return commands_.size();
+    }
+
+    /**
+     * @brief Append command with integer arguments to the stream
+     *
+     * @param op Operation code
+     * @param a0 First argument
+     * @param a1 Second argument
+     * @param a2 Third argument
+     * @param a3 Fourth argument
+     * @param a4 Fifth argument
+     */
+    void record(opcode op, GLuint a0=0, GLuint a1=0, GLuint a2=0, GLuint a3=0, GLuint a4=0) {
+        commands_.emplace_back(op);
+        Command & cmd = commands_.back();
+        cmd.args.u[0] = a0;
+        cmd.args.u[1] = a1;
+        cmd.args.u[2] = a2;
+        cmd.args.u[3] = a3;
+        cmd.args.u[4] = a4;
+    }
+
+    /**
+     * @brief Append command with floating-point arguments to the stream
+     *
+     * @param op Operation code
+     * @param f0 First argument
+     * @param f1 Second argument
+     * @param f2 Third argument
+     * @param f3 Fourth argument
+     */
+    void recordFloat(opcode op, GLfloat f0, GLfloat f1, GLfloat f2, GLfloat f3) {
+        commands_.emplace_back(op);
+        Command & cmd = commands_.back();
+        cmd.args.f[0] = f0;
+        cmd.args.f[1] = f1;
+        cmd.args.f[2] = f2;
+        cmd.args.f[3] = f3;
+    }
+
+    /**
+     * @brief Append command with an offset / pointer argument to the stream
+     *
+     * @param op Operation code
+     * @param a0 First argument
+     * @param a1 Second argument
+     * @param a2 Third argument
+     * @param a3 Fourth argument
+     * @param ext Offset or pointer argument
+     */
+    void recordExt(opcode op, GLuint a0, GLuint a1, GLuint a2, GLuint a3, uint64_t ext) {
+        record(op, a0, a1, a2, a3);
+        commands_.back().ext = ext;
+    }
+
+    /**
+     * @brief Append command with an array argument to the stream
+     *
+     * @param op Operation code
+     * @param a0 First argument
+     * @param a1 Second argument
+     * @param data Pointer to array data, which is copied to the stream
+     * @param words Number of 32-bit words in \p data
+     */
+    void recordArray(opcode op, GLuint a0, GLuint a1, const void *data, size_t words) {
+        record(op, a0, a1, (GLuint)pool_.size(), (GLuint)words);
+        size_t offset = pool_.size();
+        pool_.resize(offset + words);
+        memcpy(pool_.data() + offset, data, words * sizeof(uint32_t));
+    }
+
+    void recordUniform(ShaderProgram *program, opcode op, GLint location, GLsizei count, const void *data, size_t words, bool transpose=false);
+    void recordProgramState(ShaderProgram *program, uint64_t key);
+
+ private:
+    /**
+     * @brief Single recorded command
+     */
+    struct Command {
+        Command(opcode oper) : op(oper) {}
+        opcode op;                          //!< Operation code
+        union {
+            GLuint u[5];                    //!< Integer arguments (also used for enums and handles)
+            GLint i[5];                     //!< Signed integer arguments
+            GLfloat f[5];                   //!< Floating-point arguments
+        } args;
+        uint64_t ext = 0;                   //!< Offset or pointer argument
+    };
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    std::vector<Command> commands_;         //!< Recorded commands
+    std::vector<uint32_t> pool_;            //!< Data pool for array arguments (uniforms, clear values, attachment lists)
+    GLState * endState_ = nullptr;          //!< Copy of the shadow state at the end of the recording
+    GLState * recordState_ = nullptr;       //!< State instance that is used for recording (only during recording)
+    bool valid_ = false;                    //!< Indicator that the stream contains a complete recording
+};
+
+} // opengl namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,110 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Compute Shader Wrapper (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cassert>
+#include <string>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gl_sys.h"
+#include "shader.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+
+namespace fyusion {
+namespace opengl {
+
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
+/**
+ * @brief Class wrapper for compute shaders
+ *
+ * This class specializes the Shader class, please see the documentation there.
+ *
+ * @note Compute shaders require GL 4.3 or GLES 3.1, use GLInfo::supportsComputeShader() to check
+ *       for availability at runtime.
+ *
+ * @see Shader
+ * @see https://www.khronos.org/opengl/wiki/Compute_Shader
+ */
+class ComputeShader : public Shader {
+ public:
+    /**
+     * @brief Constructor
+     *
+     * @param context GL context that the shader should work with
+     *
+     * Idle constructor.
+     *
+     * @note It is recommended to create new shaders by either using #fromString or #fromResource
+     */
+    ComputeShader(const fyusenet::GfxContextLink & context = fyusenet::GfxContextLink()) :
+         Shader(GL_COMPUTE_SHADER,context) {
+    }
+
+
+    /**
+     * @brief Construct object with source code
+     *
+     * @param code Pointer to source code for the shader
+     *
+     * @param context GL context that the shader should work with
+     *
+     * Constructor that initializes the code part with the supplied source code. No compilation is done.
+     *
+     * @note It is recommended to create new shaders by either using #fromString or #fromResource
+     */
+    ComputeShader(const char * code, const fyusenet::GfxContextLink& context = fyusenet::GfxContextLink()) :
+        Shader(GL_COMPUTE_SHADER,context) {
+        setCode(code);
+    }
+
+
+    /**
+     * @brief Create compute shader from source code
+     *
+     * @param code Pointer to source code for the shader
+     * @param context GL context that the shader should work with
+     *
+     * @return Shared pointer to compute shader
+     *
+     * Creates a new compute shader object and initializes it with the supplied code. No compilation
+     * is done.
+     */
+    static shaderptr fromString(const char *code, const fyusenet::GfxContextLink & context = fyusenet::GfxContextLink()) {
+        return shaderptr(new ComputeShader(code,context));
+    }
+
+
+    /**
+     * @brief Create compute shader from shader resource
+     *
+     * @param resName Pointer to resource name to read shader from
+     * @param context GL context that the shader should work with
+     *
+     * @return Shared pointer to compute shader
+     *
+     * Creates a new compute shader object by using the ShaderRepository and the supplied \p resName
+     * to retrieve shader code from the repository. No compilation of the shader is done.
+     */
+    static shaderptr fromResource(const char *resName, const fyusenet::GfxContextLink & context = fyusenet::GfxContextLink()) {
+        const char * code = ShaderRepository::getShader(resName);
+        assert(code);
+        return shaderptr(new ComputeShader(code,context));
+    }
+};
+#endif
+
+} // opengl namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
@@ -15,6 +15,8 @@
 
 #include "fbo.h"
 #include "glexception.h"
+#include "glinfo.h"
+#include "glstate.h"
 #include "../common/logging.h"
 
 //-------------------------------------- Global Variables ------------------------------------------
@@ -152,9 +154,9 @@ FBO::FBO(const fyusenet::GfxContextLink &context, const Texture2D &backingTextur
 FBO::~FBO() {
     if (context_.isCurrent()) {
         if (bound_) unbind();
-        if (handle_) glDeleteFramebuffers(1, &handle_);
+        if (handle_) GLState::deleteFramebuffers(1, &handle_);
         if (internalTexture_ ) {
-            glDeleteTextures(1, &internalTexture_);
+            GLState::deleteTextures(1, &internalTexture_);
 #ifdef DEBUG
             textureMemory_.fetch_sub(width_ * height_ * internalChannels_ * Texture::channelSize(internalType_));
 #endif
@@ -180,7 +182,7 @@ void FBO::invalidate() {
             attachments[i] = ai->first;
         }
 #ifndef __APPLE__
-        glInvalidateFramebuffer(GL_FRAMEBUFFER, attachments_.size(), attachments);
+        GLState::invalidateFramebuffer(GL_FRAMEBUFFER, attachments_.size(), attachments);
 #endif
     }
     dbDirty_ = true;
@@ -197,7 +199,7 @@ void FBO::invalidate() {
  */
 void FBO::resize(int width, int height) {
     if (internalTexture_) {
-        glBindTexture(GL_TEXTURE_2D, internalTexture_);
+        GLState::bindTexture(GL_TEXTURE_2D, internalTexture_);
 #ifdef DEBUG
         int diff = width*height - width_ * height_;
         diff *= internalChannels_ * Texture::channelSize(internalType_);
@@ -366,6 +368,31 @@ size_t FBO::copyToPBO(PBO *target, GLenum dataType, int channels, size_t pboOffs
 }
 
 
+/**
+ * @brief Check if pixel data can be read from this %FBO in the specified format and type
+ *
+ * @param format Generic pixel format to read (e.g. \c GL_RGBA)
+ * @param dataType Data type to read (e.g. \c GL_HALF_FLOAT)
+ *
+ * @retval true if a readout (e.g. via copyToPBO()) in the supplied format/type is supported
+ * @retval false otherwise
+ *
+ * @pre %FBO is bound to the \c GL_READ_FRAMEBUFFER (or \c GL_FRAMEBUFFER) target
+ *
+ * Desktop GL converts the framebuffer contents to any requested format/type. On GLES and WebGL,
+ * only the mandatory combination and one implementation-specific combination can be read, the
+ * latter is queried from the GL implementation here.
+ */
+bool FBO::supportsReadout(GLenum format, GLenum dataType) const {
+    if ((!GLInfo::isGLES()) && (!GLInfo::isWebGL())) return true;
+    if ((format == GL_RGBA) && (dataType == GL_FLOAT)) return true;
+    GLint implformat = 0, impltype = 0;
+    glGetIntegerv(GL_IMPLEMENTATION_COLOR_READ_FORMAT, &implformat);
+    glGetIntegerv(GL_IMPLEMENTATION_COLOR_READ_TYPE, &impltype);
+    return (((GLenum)implformat == format) && ((GLenum)impltype == dataType));
+}
+
+
 
 /**
  * @brief Bind framebuffer object
@@ -387,7 +414,7 @@ void FBO::bind(GLenum target, bool statusCheck) {
     }
 #endif
     if (!handle_) THROW_EXCEPTION_ARGS(GLException, "Cannot bind uninitialized framebuffer");
-    glBindFramebuffer(target, handle_);
+    GLState::bindFramebuffer(target, handle_);
     if (statusCheck) {
         GLenum status = glCheckFramebufferStatus(target);
         if (status != GL_FRAMEBUFFER_COMPLETE) {
@@ -405,7 +432,7 @@ void FBO::bind(GLenum target, bool statusCheck) {
  */
 void FBO::bindWithViewport(GLenum target) {
     bind(target, true);
-    glViewport(0, 0, width_, height_);
+    GLState::viewport(0, 0, width_, height_);
 }
 
 
@@ -417,7 +444,7 @@ void FBO::bindWithViewport(GLenum target) {
  * Technically binds a zero framebuffer to the supplied \p target .
  */
 void FBO::unbind(GLenum target) {
-    glBindFramebuffer(target, 0);
+    GLState::bindFramebuffer(target, 0);
     bound_ = false;
 }
 
@@ -445,8 +472,8 @@ bool FBO::hasAttachment(GLenum attachment) const {
  */
 void FBO::bindAttachment(GLenum attachment, GLenum unit, GLenum target) {
     GLuint t = getAttachment(attachment);
-    glActiveTexture(unit);
-    glBindTexture(target, t);
+    GLState::activeTexture(unit);
+    GLState::bindTexture(target, t);
 }
 
 
@@ -475,13 +502,13 @@ bool FBO::isValid() const {
     if (!handle_) return false;
     bool wasbound = bound_;
     if (!wasbound) {
-        glBindFramebuffer(GL_FRAMEBUFFER, handle_);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, handle_);
         bound_ = true;
     }
     GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     // NOTE (mw) we silently assume that the default FB was bound before calling this function
     if (!wasbound) {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
         bound_ = false;
     }
     if (status == GL_FRAMEBUFFER_COMPLETE) return true;
@@ -524,7 +551,7 @@ void FBO::setWriteMask() const {
 #ifdef DEBUG
     glGetError();
 #endif
-    glDrawBuffers(db, WRITE_BUFFERS);
+    GLState::drawBuffers(db, WRITE_BUFFERS);
 #ifdef DEBUG
     int err = glGetError();
     if (err != GL_NO_ERROR) THROW_EXCEPTION_ARGS(GLException,"Illegal write mask set (err=0x%X, db=%d)",err,db);
@@ -554,7 +581,7 @@ void FBO::updateColorAttachment(GLenum attachment, const Texture2D& texture) {
     }
 #endif
     if (!bound_) {
-        glBindFramebuffer(GL_FRAMEBUFFER, handle_);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, handle_);
         bound_ = true;
     }
     glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture.getHandle(),0);
@@ -586,7 +613,7 @@ void FBO::updateColorAttachment(GLenum attachment, GLuint texture, int width, in
     }
 #endif
     if (!bound_) {
-        glBindFramebuffer(GL_FRAMEBUFFER,handle_);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER,handle_);
         bound_ = true;
     }
     glFramebufferTexture2D(GL_FRAMEBUFFER,attachment,GL_TEXTURE_2D,texture,0);
@@ -615,7 +642,7 @@ void FBO::updateColorAttachment(GLenum attachment, GLuint texture) {
     glGetError();
 #endif
     if (!bound_) {
-        glBindFramebuffer(GL_FRAMEBUFFER, handle_);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, handle_);
         bound_ = true;
     }
     glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
@@ -673,7 +700,7 @@ void FBO::addTexture(GLenum attachment,GLuint texture, GLenum target) {
             FNLOGE("Accessing FBO from wrong context");
         }
 #endif
-        glBindFramebuffer(GL_FRAMEBUFFER, handle_);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, handle_);
         bound_ = true;
     }
     glFramebufferTexture2D(GL_FRAMEBUFFER,attachment,target,texture,0);
@@ -686,6 +713,39 @@ void FBO::addTexture(GLenum attachment,GLuint texture, GLenum target) {
 }
 
 
+/**
+ * @brief Attach a single layer of a 2D texture array to the %FBO
+ *
+ * @param attachment Enumerator for the attachment position (e.g. \c GL_COLOR_ATTACHMENT0)
+ * @param texture OpenGL handle of a \c GL_TEXTURE_2D_ARRAY texture
+ * @param layer Index of the array layer to attach
+ *
+ * @post %FBO will be bound
+ *
+ * @throws GLException on errors and incomplete framebuffers
+ *
+ * @see setWriteMask()
+ */
+void FBO::addTextureLayer(GLenum attachment, GLuint texture, int layer) {
+    if (texture == 0) THROW_EXCEPTION_ARGS(GLException, "Invalid texture supplied to FBO");
+    if (handle_ == 0) {
+        glGenFramebuffers(1,&handle_);
+        if (handle_ == 0) THROW_EXCEPTION_ARGS(GLException,"Cannot generate framebuffer");
+    }
+    if (!bound_) {
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, handle_);
+        bound_ = true;
+    }
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, attachment, texture, 0, layer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        THROW_EXCEPTION_ARGS(GLException, "Framebuffer incomplete");
+    }
+    attachments_[attachment] = texture;
+    dbDirty_ = true;
+}
+
+
 /**
  * @brief Attach renderbuffer to %FBO
  *
@@ -705,7 +765,7 @@ void FBO::addRenderbuffer(GLenum attachment, GLuint handle) {
 #ifdef DEBUG
         assertContext();
 #endif
-        glBindFramebuffer(GL_FRAMEBUFFER, handle_);
+        GLState::bindFramebuffer(GL_FRAMEBUFFER, handle_);
         bound_ = true;
     }
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, handle);
@@ -752,7 +812,7 @@ GLuint FBO::setupInternalTexture(int width,int height,int channels, Texture::pix
     // not matter for the FBO
     // ------------------------------------------------------
     auto ti = Texture::textureInfo(internalType_, internalChannels_);
-    glBindTexture(target,internalTexture_);
+    GLState::bindTexture(target,internalTexture_);
     glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
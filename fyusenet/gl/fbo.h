@@ -56,11 +56,13 @@ class FBO : public fyusenet::GfxContextTracker {
     bool isValid() const;
     void invalidate();
     size_t copyToPBO(PBO *target, GLenum dataType, int channels, size_t pboOffset=0, bool bindPBO=false, bool integral=false);
+    bool supportsReadout(GLenum format, GLenum dataType) const;
     void bind(GLenum target = GL_FRAMEBUFFER, bool statusCheck=true);
     void bindWithViewport(GLenum target = GL_FRAMEBUFFER);
     void unbind(GLenum target = GL_FRAMEBUFFER);
     void addTexture(GLenum attachment, GLuint handle, GLenum target = GL_TEXTURE_2D);
     void addTexture(GLenum attachment, const Texture2D& texture);
+    void addTextureLayer(GLenum attachment, GLuint handle, int layer);
     void addRenderbuffer(GLenum attachment, GLuint handle);
     void updateColorAttachment(GLenum attachment, GLuint texture);
     void updateColorAttachment(GLenum attachment, const Texture2D& texture);
@@ -17,6 +17,7 @@
 #include "glcontext.h"
 #include "pbopool.h"
 #include "shadercache.h"
+#include "shadercompiler.h"
 #include "shadersnippet.h"
 #ifdef FYUSENET_MULTITHREADING
 #include "asyncpool.h"
@@ -284,6 +285,7 @@ std::shared_ptr<GfxContextManager> GfxContextManager::instance(int device) {
  *       the main thread as last action.
  */
 void GfxContextManager::tearDown() {
+    opengl::ShaderCompiler::tearDown();
     opengl::ShaderCache::tearDown();
     opengl::ShaderSnippet::tearDown();
 #ifdef FYUSENET_MULTITHREADING
@@ -358,16 +360,22 @@ void GfxContextManager::cleanup() {
  *
  * @param readPoolSize Number of PBOs in the read pool
  * @param writePoolSize Number of PBOs in the write pool
+ * @param preallocate If set to \c true, upload and download layers will pre-allocate the PBOs
+ *                    they require (with the exact sizes) during their setup
  *
  * This function allocates two PBOPool instances, one for uploading (write) textures and one for
  * downloading (read) textures.
+ *
+ * @see PBOPool::reserve()
  */
-void GfxContextManager::setupPBOPools(int readPoolSize, int writePoolSize) {
+void GfxContextManager::setupPBOPools(int readPoolSize, int writePoolSize, bool preallocate) {
     // TODO (mw) thread-safety
     assert(pboReadPool_ == nullptr);
     assert(pboWritePool_ == nullptr);
     pboReadPool_ = new opengl::PBOPool(readPoolSize);
     pboWritePool_ = new opengl::PBOPool(writePoolSize);
+    pboReadPool_->setPreallocation(preallocate);
+    pboWritePool_->setPreallocation(preallocate);
 }
 
 
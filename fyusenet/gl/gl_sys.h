@@ -41,6 +41,9 @@
 //#include <GLES3/gl3ext.h>
 #ifndef ANDROID
 #include <GLES3/gl32.h>
+#else
+// GLES 3.1 (compute shaders) is available from API level 21 on, actual support is checked at runtime
+#include <GLES3/gl31.h>
 #endif
 #endif
 
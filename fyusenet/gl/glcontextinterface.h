@@ -13,6 +13,10 @@
 #include <cassert>
 #include <atomic>
 
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "glstate.h"
+
 //------------------------------------- Public Declarations ----------------------------------------
 namespace fyusion {
 
@@ -48,13 +52,14 @@ class GLContextInterface {
      * @param idx Context index (see GfxContextManager)
      * @param dev Device ID/index the context runs on
      */
-    GLContextInterface(int idx, int dev) : links_(0), index_(idx), deviceID_(dev) {
+    GLContextInterface(int idx, int dev) : links_(0), index_(idx), deviceID_(dev), state_(new GLState()) {
     }
 
     /**
      * @brief Idle destructor
      */
     virtual ~GLContextInterface() {
+        delete state_;
     }
 
     // ------------------------------------------------------------------------
@@ -215,6 +220,18 @@ class GLContextInterface {
     }
 
 
+    /**
+     * @brief Retrieve shadow state of this context
+     *
+     * @return Pointer to GLState instance that tracks the GL state of this context
+     *
+     * @see GLState::Section
+     */
+    GLState * glState() const {
+        return state_;
+    }
+
+
     /**
      * @brief Get usage/link counter for this context
      *
@@ -252,6 +269,7 @@ class GLContextInterface {
     int index_ = 0;                     //!< Index of this context in a globally managed context list (see GfxContextManager)
     int derivedIdx_ = -1;               //!< For derived (=shared) contexts, the index of the context within a derived list
     int deviceID_ = 0;                  //!< Device ID (e.g. GPU index) that this context runs on
+    GLState * state_ = nullptr;         //!< Shadow state for filtering redundant state changes (owned)
 };
 
 } // opengl namespace
@@ -364,6 +364,22 @@ unsigned int GLInfo::getMaxUBOSize() {
 }
 
 
+/**
+ * @brief Retrieve required alignment for offsets into uniform buffers
+ *
+ * @return Alignment (in bytes) for offsets supplied to \c glBindBufferRange() on UBOs or 0 if
+ *         UBOs are not supported
+ */
+unsigned int GLInfo::getUBOOffsetAlignment() {
+    int ver = GLInfo::getVersion();
+    if ((ver >= GLES_3_0) || ((ver < GLES_2_0) && (ver >= GL_3_1))) {
+        GLint data=0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&data);
+        return (unsigned int)data;
+    } else return 0;
+}
+
+
 /**
  * @brief Retrieve maximum number of drawing buffers for multiple render targets
  *
@@ -197,6 +197,27 @@ class GLInfo {
     }
 
 
+    /**
+     * @brief Check if system supports persistently mapped buffer objects
+     *
+     * @retval true if immutable buffer storage with persistent mapping is available
+     * @retval false otherwise
+     *
+     * Persistent mapping requires OpenGL 4.4 or the \c GL_ARB_buffer_storage extension. It is not
+     * supported on EGL, Apple and WebGL builds (see PBO::prepareForPersistentRead()).
+     *
+     * @see https://www.khronos.org/opengl/wiki/Buffer_Object#Persistent_mapping
+     */
+    static bool supportsPersistentMapping() {
+#if defined(FYUSENET_USE_EGL) || defined(__APPLE__) || defined(FYUSENET_USE_WEBGL)
+        return false;
+#else
+        if ((getVersion() >= GL_4_4) && (getVersion() < GLES_2_0)) return true;
+        return hasExtension("GL_ARB_buffer_storage");
+#endif
+    }
+
+
     /**
      * @brief Check if system support compute shaders
      *
@@ -271,6 +292,7 @@ class GLInfo {
     }
 
     static unsigned int getMaxUBOSize();
+    static unsigned int getUBOOffsetAlignment();
     static int getMaxVertexUBOs();
     static int getMaxFragmentUBOs();
     static int getMaxUniformVectors(shadertype type);
@@ -0,0 +1,295 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// GL State Tracker
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "glstate.h"
+#include "glexception.h"
+
+//-------------------------------------- Global Variables ------------------------------------------
+namespace fyusion {
+namespace opengl {
+
+thread_local GLState * GLState::current_ = nullptr;
+bool GLState::validation_ = false;
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @brief Open tracked section on the calling thread
+ *
+ * @param state Pointer to state of the GL context that is current to the calling thread, may be
+ *              \c nullptr in which case no tracking takes place within the section
+ *
+ * The shadow state is invalidated, unless the same state was already tracked on the calling
+ * thread (nested sections).
+ */
+GLState::Section::Section(GLState *state) : previous_(current_) {
+    if ((state) && (state != previous_)) state->invalidate();
+    current_ = state;
+}
+
+
+/**
+ * @brief Close tracked section on the calling thread
+ */
+GLState::Section::~Section() {
+    current_ = previous_;
+}
+
+
+/**
+ * @brief Constructor
+ *
+ * Creates a state instance with all entries set to unknown. Does not require a GL context.
+ */
+GLState::GLState() {
+    invalidate();
+}
+
+
+/**
+ * @brief Mark the complete shadow state as unknown
+ *
+ * Use this function in case the GL state was modified by code that did not route through this
+ * class while inside a tracked section.
+ */
+void GLState::invalidate() {
+    program_ = UNKNOWN;
+    vertexArray_ = UNKNOWN;
+    drawFBO_ = UNKNOWN;
+    readFBO_ = UNKNOWN;
+    activeUnit_ = UNKNOWN;
+    for (int i=0; i < MAX_TEXTURE_UNITS; i++) textures_[i] = UNKNOWN;
+    for (int i=0; i < NUM_CAPS; i++) caps_[i] = -1;
+    blendEquation_[0] = blendEquation_[1] = UNKNOWN;
+    for (int i=0; i < 4; i++) blendFunc_[i] = UNKNOWN;
+    viewport_[0] = viewport_[1] = viewport_[2] = viewport_[3] = -1;
+    clearValid_ = false;
+}
+
+
+/**
+ * @brief Check all known entries of the shadow state against the actual GL state
+ *
+ * @pre The GL context that owns this state is current to the calling thread
+ *
+ * @throws GLException in case the shadow state does not match the GL state
+ */
+void GLState::validate() const {
+    if (program_ != UNKNOWN) checkInteger(GL_CURRENT_PROGRAM, (GLint)program_);
+    if (vertexArray_ != UNKNOWN) checkInteger(GL_VERTEX_ARRAY_BINDING, (GLint)vertexArray_);
+    if (drawFBO_ != UNKNOWN) checkInteger(GL_DRAW_FRAMEBUFFER_BINDING, (GLint)drawFBO_);
+    if (readFBO_ != UNKNOWN) checkInteger(GL_READ_FRAMEBUFFER_BINDING, (GLint)readFBO_);
+    static const GLenum caps[NUM_CAPS] = {GL_BLEND, GL_DEPTH_TEST, GL_STENCIL_TEST, GL_CULL_FACE, GL_SCISSOR_TEST};
+    for (int i=0; i < NUM_CAPS; i++) {
+        if (caps_[i] >= 0) checkCapability(caps[i], caps_[i] == 1);
+    }
+    checkBlend();
+    checkViewport();
+    checkClearColor();
+    GLint active = 0;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+    if (activeUnit_ != UNKNOWN) checkInteger(GL_ACTIVE_TEXTURE, (GLint)activeUnit_);
+    for (int i=0; i < MAX_TEXTURE_UNITS; i++) {
+        if (textures_[i] == UNKNOWN) continue;
+        glActiveTexture(GL_TEXTURE0 + i);
+        GLint tex = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &tex);
+        glActiveTexture((GLenum)active);
+        if ((GLuint)tex != textures_[i]) {
+            THROW_EXCEPTION_ARGS(GLException, "GL state mismatch on texture unit %d (shadow %u, actual %d)", i, textures_[i], tex);
+        }
+    }
+}
+
+
+/**
+ * @brief Enable or disable validation mode
+ *
+ * @param enable If \c true, calls that are filtered out are checked against the GL state
+ *
+ * @see validate()
+ */
+void GLState::setValidation(bool enable) {
+    validation_ = enable;
+}
+
+
+/**
+ * @brief Tracked replacement for \c glDeleteTextures()
+ *
+ * @param num Number of textures to delete
+ * @param textures Pointer to texture handles
+ *
+ * Deleted textures are unbound by GL, the shadow state is updated accordingly.
+ */
+void GLState::deleteTextures(GLsizei num, const GLuint *textures) {
+    GLState * st = current_;
+    if (st) {
+        for (int i=0; i < num; i++) {
+            for (int u=0; u < MAX_TEXTURE_UNITS; u++) {
+                if (st->textures_[u] == textures[i]) st->textures_[u] = 0;
+            }
+        }
+    }
+    glDeleteTextures(num, textures);
+}
+
+
+/**
+ * @brief Tracked replacement for \c glDeleteFramebuffers()
+ *
+ * @param num Number of framebuffers to delete
+ * @param fbos Pointer to framebuffer handles
+ */
+void GLState::deleteFramebuffers(GLsizei num, const GLuint *fbos) {
+    GLState * st = current_;
+    if (st) {
+        for (int i=0; i < num; i++) {
+            if (st->drawFBO_ == fbos[i]) st->drawFBO_ = 0;
+            if (st->readFBO_ == fbos[i]) st->readFBO_ = 0;
+        }
+    }
+    glDeleteFramebuffers(num, fbos);
+}
+
+
+/**
+ * @brief Tracked replacement for \c glDeleteVertexArrays()
+ *
+ * @param num Number of vertex array objects to delete
+ * @param vaos Pointer to vertex array object handles
+ */
+void GLState::deleteVertexArrays(GLsizei num, const GLuint *vaos) {
+    GLState * st = current_;
+    if (st) {
+        for (int i=0; i < num; i++) {
+            if (st->vertexArray_ == vaos[i]) st->vertexArray_ = 0;
+        }
+    }
+    glDeleteVertexArrays(num, vaos);
+}
+
+
+/**
+ * @brief Tracked replacement for \c glDeleteProgram()
+ *
+ * @param program Handle of program to delete
+ *
+ * A program that is in use is only flagged for deletion by GL, we mark the program binding as
+ * unknown in that case to avoid the recycled handle being filtered out.
+ */
+void GLState::deleteProgram(GLuint program) {
+    GLState * st = current_;
+    if ((st) && (st->program_ == program)) st->program_ = UNKNOWN;
+    glDeleteProgram(program);
+}
+
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @brief Check integer GL state against an expected value
+ *
+ * @param name GL state name to query
+ * @param expected Expected value
+ *
+ * @throws GLException on mismatch
+ */
+void GLState::checkInteger(GLenum name, GLint expected) const {
+    GLint value = 0;
+    glGetIntegerv(name, &value);
+    if (value != expected) {
+        THROW_EXCEPTION_ARGS(GLException, "GL state mismatch for 0x%X (shadow %d, actual %d)", name, expected, value);
+    }
+}
+
+
+/**
+ * @brief Check enable flag against an expected value
+ *
+ * @param cap GL capability to query
+ * @param expected Expected value
+ *
+ * @throws GLException on mismatch
+ */
+void GLState::checkCapability(GLenum cap, bool expected) const {
+    bool value = (glIsEnabled(cap) == GL_TRUE);
+    if (value != expected) {
+        THROW_EXCEPTION_ARGS(GLException, "GL state mismatch for capability 0x%X (shadow %d, actual %d)", cap, (int)expected, (int)value);
+    }
+}
+
+
+/**
+ * @brief Check (known) blend equations and factors against the GL state
+ *
+ * @throws GLException on mismatch
+ */
+void GLState::checkBlend() const {
+    static const GLenum eqnames[2] = {GL_BLEND_EQUATION_RGB, GL_BLEND_EQUATION_ALPHA};
+    static const GLenum fnames[4] = {GL_BLEND_SRC_RGB, GL_BLEND_DST_RGB, GL_BLEND_SRC_ALPHA, GL_BLEND_DST_ALPHA};
+    for (int i=0; i < 2; i++) {
+        if (blendEquation_[i] != UNKNOWN) checkInteger(eqnames[i], (GLint)blendEquation_[i]);
+    }
+    for (int i=0; i < 4; i++) {
+        if (blendFunc_[i] != UNKNOWN) checkInteger(fnames[i], (GLint)blendFunc_[i]);
+    }
+}
+
+
+/**
+ * @brief Check (known) viewport against the GL state
+ *
+ * @throws GLException on mismatch
+ */
+void GLState::checkViewport() const {
+    if (viewport_[2] < 0) return;
+    GLint vp[4] = {0};
+    glGetIntegerv(GL_VIEWPORT, vp);
+    for (int i=0; i < 4; i++) {
+        if (vp[i] != viewport_[i]) {
+            THROW_EXCEPTION_ARGS(GLException, "GL state mismatch for viewport (shadow %d,%d,%d,%d actual %d,%d,%d,%d)",
+                                 viewport_[0], viewport_[1], viewport_[2], viewport_[3], vp[0], vp[1], vp[2], vp[3]);
+        }
+    }
+}
+
+
+/**
+ * @brief Check (known) clear color against the GL state
+ *
+ * @throws GLException on mismatch
+ */
+void GLState::checkClearColor() const {
+    if (!clearValid_) return;
+    GLfloat col[4] = {0};
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, col);
+    for (int i=0; i < 4; i++) {
+        if (col[i] != clearColor_[i]) {
+            THROW_EXCEPTION_ARGS(GLException, "GL state mismatch for clear color (shadow %f,%f,%f,%f actual %f,%f,%f,%f)",
+                                 clearColor_[0], clearColor_[1], clearColor_[2], clearColor_[3], col[0], col[1], col[2], col[3]);
+        }
+    }
+}
+
+} // opengl namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,716 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// GL State Tracker (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstdint>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gl_sys.h"
+#include "commandstream.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace opengl {
+
+/**
+ * @brief Shadow copy of (parts of) the GL state of a context to filter redundant state changes
+ *
+ * Network layers are written in a self-contained fashion, i.e. each layer sets up the complete
+ * GL state it requires for rendering on every forward pass, regardless of what the previous
+ * layer left behind. For the small tensors that we mostly deal with, the driver overhead of
+ * these (largely redundant) calls is a measurable share of the per-layer time.
+ *
+ * This class maintains a shadow copy of the following state:
+ *   - bound program, vertex array object and (draw/read) framebuffers
+ *   - active texture unit and \c GL_TEXTURE_2D bindings for the first #MAX_TEXTURE_UNITS units
+ *   - enable flags for blending, depth test, stencil test, face culling and scissor test
+ *   - blend equations and blend functions
+ *   - viewport and clear color
+ *
+ * The state-changing functions are static and mirror the GL functions they replace, for example
+ * GLState::bindTexture() replaces \c glBindTexture(). Filtering only takes place within a
+ * tracked Section, which is opened by the Engine for the execution of the network layers on the
+ * executing thread. Outside of a tracked section, all calls are passed to GL unconditionally,
+ * such that code that is not routed through this class (setup code, user code) never leads to
+ * a stale shadow state. The shadow is invalidated when a section is opened.
+ *
+ * Each GL context owns one instance of this class (see GLContextInterface::glState()).
+ *
+ * For debugging purposes, a validation mode can be enabled using setValidation(). In that mode,
+ * each call that is filtered out is checked against the actual GL state (via \c glGet) and
+ * validate() is invoked after every layer, which throws a GLException on any mismatch.
+ *
+ * In addition to the state changes, this class also routes the draw calls and a few other calls
+ * that are issued by the layers during execution (clears, stencil/depth setup, texture parameters,
+ * buffer and image bindings, compute dispatches). These are always passed to GL, but are also
+ * appended to a CommandStream in case a recording is active within the tracked section.
+ *
+ * @warning Objects that are deleted within a tracked section must be deleted by the delete
+ *          functions in this class, otherwise their (recycled) names may be filtered out.
+ */
+class GLState {
+    friend class CommandStream;
+ public:
+    constexpr static int MAX_TEXTURE_UNITS = 32;        //!< Number of texture units that are tracked
+
+    /**
+     * @brief RAII helper that marks a tracked section on the calling thread
+     *
+     * @pre The GL context that owns the supplied state is current to the calling thread
+     */
+    class Section {
+     public:
+        Section(GLState *state);
+        ~Section();
+     private:
+        GLState * previous_;            //!< State that was tracked on this thread before the section
+    };
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    GLState();
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    void invalidate();
+    void validate() const;
+
+    // ------------------------------------------------------------------------
+    // Static functions
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Retrieve state instance that is tracked on the calling thread
+     *
+     * @return Pointer to tracked state or \c nullptr if the calling thread is not within a
+     *         tracked section
+     */
+    static GLState * current() {
+        return current_;
+    }
+
+    /**
+     * @brief Check if validation mode is enabled
+     *
+     * @retval true if filtered calls are validated against the GL state
+     * @retval false otherwise
+     */
+    static bool validation() {
+        return validation_;
+    }
+
+    /**
+     * @brief Retrieve command stream that is currently recording on the calling thread
+     *
+     * @return Pointer to recording stream or \c nullptr if no recording is active
+     */
+    static CommandStream * recorder() {
+        return (current_) ? current_->recorder_ : nullptr;
+    }
+
+    static void setValidation(bool enable);
+
+    /**
+     * @brief Tracked replacement for \c glUseProgram()
+     *
+     * @param program Handle of program to use
+     */
+    static void useProgram(GLuint program) {
+        GLState * st = current_;
+        if (st) {
+            if (st->program_ == program) {
+                if (validation_) st->checkInteger(GL_CURRENT_PROGRAM, (GLint)program);
+                return;
+            }
+            st->program_ = program;
+            if (st->recorder_) st->recorder_->record(CommandStream::USE_PROGRAM, program);
+        }
+        glUseProgram(program);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glBindVertexArray()
+     *
+     * @param vao Handle of vertex array object to bind
+     */
+    static void bindVertexArray(GLuint vao) {
+        GLState * st = current_;
+        if (st) {
+            if (st->vertexArray_ == vao) {
+                if (validation_) st->checkInteger(GL_VERTEX_ARRAY_BINDING, (GLint)vao);
+                return;
+            }
+            st->vertexArray_ = vao;
+            if (st->recorder_) st->recorder_->record(CommandStream::BIND_VAO, vao);
+        }
+        glBindVertexArray(vao);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glBindFramebuffer()
+     *
+     * @param target Framebuffer target (\c GL_FRAMEBUFFER, \c GL_DRAW_FRAMEBUFFER or
+     *               \c GL_READ_FRAMEBUFFER)
+     * @param fbo Handle of framebuffer object to bind
+     */
+    static void bindFramebuffer(GLenum target, GLuint fbo) {
+        GLState * st = current_;
+        if (st) {
+            bool draw = (target == GL_FRAMEBUFFER) || (target == GL_DRAW_FRAMEBUFFER);
+            bool read = (target == GL_FRAMEBUFFER) || (target == GL_READ_FRAMEBUFFER);
+            if (((!draw) || (st->drawFBO_ == fbo)) && ((!read) || (st->readFBO_ == fbo))) {
+                if (validation_) {
+                    if (draw) st->checkInteger(GL_DRAW_FRAMEBUFFER_BINDING, (GLint)fbo);
+                    if (read) st->checkInteger(GL_READ_FRAMEBUFFER_BINDING, (GLint)fbo);
+                }
+                return;
+            }
+            if (draw) st->drawFBO_ = fbo;
+            if (read) st->readFBO_ = fbo;
+            if (st->recorder_) st->recorder_->record(CommandStream::BIND_FBO, target, fbo);
+        }
+        glBindFramebuffer(target, fbo);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glActiveTexture()
+     *
+     * @param unit Texture unit to activate (e.g. \c GL_TEXTURE0)
+     */
+    static void activeTexture(GLenum unit) {
+        GLState * st = current_;
+        if (st) {
+            if (st->activeUnit_ == unit) {
+                if (validation_) st->checkInteger(GL_ACTIVE_TEXTURE, (GLint)unit);
+                return;
+            }
+            st->activeUnit_ = unit;
+            if (st->recorder_) st->recorder_->record(CommandStream::ACTIVE_TEXTURE, unit);
+        }
+        glActiveTexture(unit);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glBindTexture()
+     *
+     * @param target Texture target, only \c GL_TEXTURE_2D bindings are tracked
+     * @param texture Handle of texture to bind to the active texture unit
+     */
+    static void bindTexture(GLenum target, GLuint texture) {
+        GLState * st = current_;
+        if (st) {
+            unsigned int unit = st->activeUnit_ - GL_TEXTURE0;
+            if ((target == GL_TEXTURE_2D) && (unit < (unsigned int)MAX_TEXTURE_UNITS)) {
+                if (st->textures_[unit] == texture) {
+                    if (validation_) st->checkInteger(GL_TEXTURE_BINDING_2D, (GLint)texture);
+                    return;
+                }
+                st->textures_[unit] = texture;
+            }
+            if (st->recorder_) st->recorder_->record(CommandStream::BIND_TEXTURE, target, texture);
+        }
+        glBindTexture(target, texture);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glEnable()
+     *
+     * @param cap Capability to enable
+     */
+    static void enable(GLenum cap) {
+        GLState * st = current_;
+        int idx = capIndex(cap);
+        if (st) {
+            if (idx >= 0) {
+                if (st->caps_[idx] == 1) {
+                    if (validation_) st->checkCapability(cap, true);
+                    return;
+                }
+                st->caps_[idx] = 1;
+            }
+            if (st->recorder_) st->recorder_->record(CommandStream::ENABLE, cap);
+        }
+        glEnable(cap);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glDisable()
+     *
+     * @param cap Capability to disable
+     */
+    static void disable(GLenum cap) {
+        GLState * st = current_;
+        int idx = capIndex(cap);
+        if (st) {
+            if (idx >= 0) {
+                if (st->caps_[idx] == 0) {
+                    if (validation_) st->checkCapability(cap, false);
+                    return;
+                }
+                st->caps_[idx] = 0;
+            }
+            if (st->recorder_) st->recorder_->record(CommandStream::DISABLE, cap);
+        }
+        glDisable(cap);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glBlendEquationSeparate()
+     *
+     * @param modeRGB Blend equation for the color channels
+     * @param modeAlpha Blend equation for the alpha channel
+     */
+    static void blendEquationSeparate(GLenum modeRGB, GLenum modeAlpha) {
+        GLState * st = current_;
+        if (st) {
+            if ((st->blendEquation_[0] == modeRGB) && (st->blendEquation_[1] == modeAlpha)) {
+                if (validation_) st->checkBlend();
+                return;
+            }
+            st->blendEquation_[0] = modeRGB;
+            st->blendEquation_[1] = modeAlpha;
+            if (st->recorder_) st->recorder_->record(CommandStream::BLEND_EQUATION, modeRGB, modeAlpha);
+        }
+        glBlendEquationSeparate(modeRGB, modeAlpha);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glBlendEquation()
+     *
+     * @param mode Blend equation for all channels
+     */
+    static void blendEquation(GLenum mode) {
+        blendEquationSeparate(mode, mode);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glBlendFuncSeparate()
+     *
+     * @param srcRGB Source factor for the color channels
+     * @param dstRGB Destination factor for the color channels
+     * @param srcAlpha Source factor for the alpha channel
+     * @param dstAlpha Destination factor for the alpha channel
+     */
+    static void blendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+        GLState * st = current_;
+        if (st) {
+            if ((st->blendFunc_[0] == srcRGB) && (st->blendFunc_[1] == dstRGB) &&
+                (st->blendFunc_[2] == srcAlpha) && (st->blendFunc_[3] == dstAlpha)) {
+                if (validation_) st->checkBlend();
+                return;
+            }
+            st->blendFunc_[0] = srcRGB;
+            st->blendFunc_[1] = dstRGB;
+            st->blendFunc_[2] = srcAlpha;
+            st->blendFunc_[3] = dstAlpha;
+            if (st->recorder_) st->recorder_->record(CommandStream::BLEND_FUNC, srcRGB, dstRGB, srcAlpha, dstAlpha);
+        }
+        glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glBlendFunc()
+     *
+     * @param src Source factor for all channels
+     * @param dst Destination factor for all channels
+     */
+    static void blendFunc(GLenum src, GLenum dst) {
+        blendFuncSeparate(src, dst, src, dst);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glViewport()
+     *
+     * @param x Horizontal offset of the viewport
+     * @param y Vertical offset of the viewport
+     * @param width Width of the viewport
+     * @param height Height of the viewport
+     */
+    static void viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        GLState * st = current_;
+        if (st) {
+            if ((st->viewport_[0] == x) && (st->viewport_[1] == y) && (st->viewport_[2] == width) && (st->viewport_[3] == height)) {
+                if (validation_) st->checkViewport();
+                return;
+            }
+            st->viewport_[0] = x;
+            st->viewport_[1] = y;
+            st->viewport_[2] = width;
+            st->viewport_[3] = height;
+            if (st->recorder_) st->recorder_->record(CommandStream::VIEWPORT, (GLuint)x, (GLuint)y, (GLuint)width, (GLuint)height);
+        }
+        glViewport(x, y, width, height);
+    }
+
+    /**
+     * @brief Replacement for \c glScissor() that is recorded to the command stream
+     *
+     * @param x Horizontal offset of the scissor box
+     * @param y Vertical offset of the scissor box
+     * @param width Width of the scissor box
+     * @param height Height of the scissor box
+     *
+     * The scissor box is not tracked, as it is only used in conjunction with the (tracked)
+     * \c GL_SCISSOR_TEST capability for short stretches of code.
+     */
+    static void scissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+        GLState * st = current_;
+        if ((st) && (st->recorder_)) st->recorder_->record(CommandStream::SCISSOR, (GLuint)x, (GLuint)y, (GLuint)width, (GLuint)height);
+        glScissor(x, y, width, height);
+    }
+
+    /**
+     * @brief Tracked replacement for \c glClearColor()
+     *
+     * @param red Red component of clear color
+     * @param green Green component of clear color
+     * @param blue Blue component of clear color
+     * @param alpha Alpha component of clear color
+     */
+    static void clearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+        GLState * st = current_;
+        if (st) {
+            if ((st->clearValid_) && (st->clearColor_[0] == red) && (st->clearColor_[1] == green) &&
+                (st->clearColor_[2] == blue) && (st->clearColor_[3] == alpha)) {
+                if (validation_) st->checkClearColor();
+                return;
+            }
+            st->clearColor_[0] = red;
+            st->clearColor_[1] = green;
+            st->clearColor_[2] = blue;
+            st->clearColor_[3] = alpha;
+            st->clearValid_ = true;
+            if (st->recorder_) st->recorder_->recordFloat(CommandStream::CLEAR_COLOR, red, green, blue, alpha);
+        }
+        glClearColor(red, green, blue, alpha);
+    }
+
+    /**
+     * @brief Routed replacement for \c glClear()
+     *
+     * @param mask Bitmask of buffers to clear
+     */
+    static void clear(GLbitfield mask) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::CLEAR, mask);
+        glClear(mask);
+    }
+
+    /**
+     * @brief Routed replacement for \c glClearBufferfv()
+     *
+     * @param buffer Buffer to clear (only \c GL_COLOR is supported for recording)
+     * @param drawBuffer Index of draw buffer to clear
+     * @param value Pointer to 4 clear values
+     */
+    static void clearBufferfv(GLenum buffer, GLint drawBuffer, const GLfloat *value) {
+        CommandStream * rec = recorder();
+        if (rec) rec->recordArray(CommandStream::CLEAR_BUFFERFV, buffer, (GLuint)drawBuffer, value, 4);
+        glClearBufferfv(buffer, drawBuffer, value);
+    }
+
+    /**
+     * @brief Routed replacement for \c glDrawElements()
+     *
+     * @param mode Primitive type
+     * @param count Number of indices to render
+     * @param type Data type of the indices
+     * @param indices Offset into the bound index buffer
+     */
+    static void drawElements(GLenum mode, GLsizei count, GLenum type, const void *indices) {
+        CommandStream * rec = recorder();
+        if (rec) rec->recordExt(CommandStream::DRAW_ELEMENTS, mode, (GLuint)count, type, 0, (uint64_t)(uintptr_t)indices);
+        glDrawElements(mode, count, type, indices);
+    }
+
+    /**
+     * @brief Routed replacement for \c glDrawElementsInstanced()
+     *
+     * @param mode Primitive type
+     * @param count Number of indices to render
+     * @param type Data type of the indices
+     * @param indices Offset into the bound index buffer
+     * @param instances Number of instances to render
+     */
+    static void drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instances) {
+        CommandStream * rec = recorder();
+        if (rec) rec->recordExt(CommandStream::DRAW_ELEMENTS_INSTANCED, mode, (GLuint)count, type, (GLuint)instances, (uint64_t)(uintptr_t)indices);
+        glDrawElementsInstanced(mode, count, type, indices, instances);
+    }
+
+    /**
+     * @brief Routed replacement for \c glDrawArrays()
+     *
+     * @param mode Primitive type
+     * @param first Index of first vertex
+     * @param count Number of vertices to render
+     */
+    static void drawArrays(GLenum mode, GLint first, GLsizei count) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::DRAW_ARRAYS, mode, (GLuint)first, (GLuint)count);
+        glDrawArrays(mode, first, count);
+    }
+
+    /**
+     * @brief Routed replacement for \c glDrawArraysInstanced()
+     *
+     * @param mode Primitive type
+     * @param first Index of first vertex
+     * @param count Number of vertices to render
+     * @param instances Number of instances to render
+     */
+    static void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::DRAW_ARRAYS_INSTANCED, mode, (GLuint)first, (GLuint)count, (GLuint)instances);
+        glDrawArraysInstanced(mode, first, count, instances);
+    }
+
+    /**
+     * @brief Routed replacement for \c glDrawBuffers()
+     *
+     * @param num Number of draw buffers
+     * @param buffers Pointer to draw buffer enums
+     */
+    static void drawBuffers(GLsizei num, const GLenum *buffers) {
+        CommandStream * rec = recorder();
+        if (rec) rec->recordArray(CommandStream::DRAW_BUFFERS, (GLuint)num, 0, buffers, num);
+        glDrawBuffers(num, buffers);
+    }
+
+#ifndef __APPLE__
+    /**
+     * @brief Routed replacement for \c glInvalidateFramebuffer()
+     *
+     * @param target Framebuffer target
+     * @param num Number of attachments to invalidate
+     * @param attachments Pointer to attachment enums
+     */
+    static void invalidateFramebuffer(GLenum target, GLsizei num, const GLenum *attachments) {
+        CommandStream * rec = recorder();
+        if (rec) rec->recordArray(CommandStream::INVALIDATE_FBO, target, (GLuint)num, attachments, num);
+        glInvalidateFramebuffer(target, num, attachments);
+    }
+#endif
+
+    /**
+     * @brief Routed replacement for \c glStencilFuncSeparate()
+     *
+     * @param face Face(s) to set the function for
+     * @param func Stencil test function
+     * @param ref Reference value
+     * @param mask Mask that is applied to reference and stencil values
+     */
+    static void stencilFuncSeparate(GLenum face, GLenum func, GLint ref, GLuint mask) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::STENCIL_FUNC, face, func, (GLuint)ref, mask);
+        glStencilFuncSeparate(face, func, ref, mask);
+    }
+
+    /**
+     * @brief Routed replacement for \c glStencilOp()
+     *
+     * @param sfail Action on failed stencil test
+     * @param dpfail Action on passed stencil test and failed depth test
+     * @param dppass Action on passed stencil and depth test
+     */
+    static void stencilOp(GLenum sfail, GLenum dpfail, GLenum dppass) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::STENCIL_OP, sfail, dpfail, dppass);
+        glStencilOp(sfail, dpfail, dppass);
+    }
+
+    /**
+     * @brief Routed replacement for \c glStencilMask()
+     *
+     * @param mask Write mask for the stencil buffer
+     */
+    static void stencilMask(GLuint mask) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::STENCIL_MASK, mask);
+        glStencilMask(mask);
+    }
+
+    /**
+     * @brief Routed replacement for \c glDepthFunc()
+     *
+     * @param func Depth test function
+     */
+    static void depthFunc(GLenum func) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::DEPTH_FUNC, func);
+        glDepthFunc(func);
+    }
+
+    /**
+     * @brief Routed replacement for \c glDepthMask()
+     *
+     * @param flag Write flag for the depth buffer
+     */
+    static void depthMask(GLboolean flag) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::DEPTH_MASK, flag);
+        glDepthMask(flag);
+    }
+
+    /**
+     * @brief Routed replacement for \c glTexParameteri()
+     *
+     * @param target Texture target
+     * @param name Name of the texture parameter
+     * @param param Value of the texture parameter
+     */
+    static void texParameteri(GLenum target, GLenum name, GLint param) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::TEX_PARAMETER, target, name, (GLuint)param);
+        glTexParameteri(target, name, param);
+    }
+
+    /**
+     * @brief Routed replacement for \c glBindBufferBase()
+     *
+     * @param target Indexed buffer target
+     * @param index Binding index
+     * @param buffer Handle of buffer to bind
+     */
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::BIND_BUFFER_BASE, target, index, buffer);
+        glBindBufferBase(target, index, buffer);
+    }
+
+    /**
+     * @brief Routed replacement for \c glBindBufferRange()
+     *
+     * @param target Indexed buffer target
+     * @param index Binding index
+     * @param buffer Handle of buffer to bind
+     * @param offset Offset (in bytes) into the buffer
+     * @param size Size (in bytes) of the range to bind
+     */
+    static void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+        CommandStream * rec = recorder();
+        if (rec) rec->recordExt(CommandStream::BIND_BUFFER_RANGE, target, index, buffer, (GLuint)size, (uint64_t)offset);
+        glBindBufferRange(target, index, buffer, offset, size);
+    }
+
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
+    /**
+     * @brief Routed replacement for \c glBindImageTexture()
+     *
+     * @param unit Image unit to bind the texture to
+     * @param texture Handle of texture to bind
+     * @param level Mipmap level to bind
+     * @param layered Whether or not to bind all layers of an array texture
+     * @param layer Layer to bind if \p layered is \c GL_FALSE
+     * @param access Access mode (e.g. \c GL_WRITE_ONLY)
+     * @param format Format that is used by the shader to access the image
+     */
+    static void bindImageTexture(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format) {
+        CommandStream * rec = recorder();
+        if (rec) rec->recordExt(CommandStream::BIND_IMAGE_TEXTURE, unit, texture, access, format, ((uint64_t)(uint32_t)layer << 32) | ((uint64_t)(uint16_t)level << 1) | (layered ? 1 : 0));
+        glBindImageTexture(unit, texture, level, layered, layer, access, format);
+    }
+
+    /**
+     * @brief Routed replacement for \c glDispatchCompute()
+     *
+     * @param groupsX Number of work groups along x
+     * @param groupsY Number of work groups along y
+     * @param groupsZ Number of work groups along z
+     */
+    static void dispatchCompute(GLuint groupsX, GLuint groupsY, GLuint groupsZ) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::DISPATCH_COMPUTE, groupsX, groupsY, groupsZ);
+        glDispatchCompute(groupsX, groupsY, groupsZ);
+    }
+
+    /**
+     * @brief Routed replacement for \c glMemoryBarrier()
+     *
+     * @param barriers Bitmask of barriers to insert
+     */
+    static void memoryBarrier(GLbitfield barriers) {
+        CommandStream * rec = recorder();
+        if (rec) rec->record(CommandStream::MEMORY_BARRIER, barriers);
+        glMemoryBarrier(barriers);
+    }
+#endif
+
+    static void deleteTextures(GLsizei num, const GLuint *textures);
+    static void deleteFramebuffers(GLsizei num, const GLuint *fbos);
+    static void deleteVertexArrays(GLsizei num, const GLuint *vaos);
+    static void deleteProgram(GLuint program);
+
+ private:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Map capability to index in #caps_
+     *
+     * @param cap GL capability
+     *
+     * @return Index into #caps_ or -1 if the capability is not tracked
+     */
+    static int capIndex(GLenum cap) {
+        switch (cap) {
+            case GL_BLEND:
+                return 0;
+            case GL_DEPTH_TEST:
+                return 1;
+            case GL_STENCIL_TEST:
+                return 2;
+            case GL_CULL_FACE:
+                return 3;
+            case GL_SCISSOR_TEST:
+                return 4;
+            default:
+                return -1;
+        }
+    }
+
+    void checkInteger(GLenum name, GLint expected) const;
+    void checkCapability(GLenum cap, bool expected) const;
+    void checkBlend() const;
+    void checkViewport() const;
+    void checkClearColor() const;
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    constexpr static GLuint UNKNOWN = 0xFFFFFFFF;       //!< Marker for unknown handles / enums
+    constexpr static int NUM_CAPS = 5;                  //!< Number of tracked capabilities
+    GLuint program_ = UNKNOWN;                          //!< Program that is in use
+    GLuint vertexArray_ = UNKNOWN;                      //!< Bound vertex array object
+    GLuint drawFBO_ = UNKNOWN;                          //!< Framebuffer bound to \c GL_DRAW_FRAMEBUFFER
+    GLuint readFBO_ = UNKNOWN;                          //!< Framebuffer bound to \c GL_READ_FRAMEBUFFER
+    GLenum activeUnit_ = UNKNOWN;                       //!< Active texture unit
+    GLuint textures_[MAX_TEXTURE_UNITS];                //!< \c GL_TEXTURE_2D bindings per texture unit
+    int8_t caps_[NUM_CAPS];                             //!< Enable flags (-1 for unknown)
+    GLenum blendEquation_[2];                           //!< Blend equations (RGB, alpha)
+    GLenum blendFunc_[4];                               //!< Blend factors (src RGB, dst RGB, src alpha, dst alpha)
+    GLint viewport_[4];                                 //!< Viewport (x, y, width, height)
+    GLfloat clearColor_[4];                             //!< Clear color
+    bool clearValid_ = false;                           //!< Indicator if #clearColor_ is known
+    CommandStream * recorder_ = nullptr;                //!< Stream that records the routed calls (if any)
+    static thread_local GLState * current_;             //!< State that is tracked on the calling thread
+    static bool validation_;                            //!< Indicator if validation mode is enabled
+};
+
+} // opengl namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
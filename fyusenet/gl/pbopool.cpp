@@ -8,7 +8,7 @@
 
 //--------------------------------------- System Headers -------------------------------------------
 
-#include <thread>
+#include <chrono>
 #include <cinttypes>
 
 //-------------------------------------- Project  Headers ------------------------------------------
@@ -54,6 +54,8 @@ PBOPool::~PBOPool() {
         delete ent.pbo;
     }
     availablePBOs_.clear();
+    entries_.clear();
+    free_.clear();
 }
 
 
@@ -72,44 +74,71 @@ PBOPool::~PBOPool() {
  * transparent management structures to the %PBO to make it easier for this pool to track its
  * resources.
  *
+ * If no %PBO is available and the pool is at capacity, the calling thread blocks until a %PBO is
+ * released. Blocked threads are served in the order of their requests.
+ *
  * @note The number of \p channels may exceed the maximum number of channels per pixel (4), because
  *       the %PBO here is just treated as a buffer.
  */
 ManagedPBO PBOPool::getAvailablePBO(int width, int height, int channels, int bytesPerChannel) {
-    using namespace std::chrono_literals;
-    bool immediate = true;
-    while (true) {
-        lock_.lock();
-        if (immediate) requests_++;
-        int idx=0;
-        for (int pass=0; pass < 2; pass++) {
-            for (auto ii = availablePBOs_.begin() ; ii != availablePBOs_.end(); ++ii,idx++) {
-                if (!(*ii).busy) {
-                    PBO * pbo = (*ii).pbo;
-                    if ( pbo->matches(width, height, channels, bytesPerChannel) || (pass > 0)) {
-                        (*ii).busy = true;
-                        pbo->resize(width, height, channels, bytesPerChannel);
-                        if (immediate) immediateHits_++;
-                        lock_.unlock();
-                        return ManagedPBO(pbo, this, &(*ii).refcount, &(*ii).pending, idx);
-                    }
-                }
-            }
-        }
-        if (currentPBOs_ < maxPBOs_) {
-            PBO * pbo = new PBO(width, height, channels, bytesPerChannel, context());
-            idx = availablePBOs_.size();
-            availablePBOs_.emplace_back(pbo, true);
-            entry & last = availablePBOs_.back();
-            currentPBOs_++;
-            if (immediate) immediateHits_++;
-            lock_.unlock();
-            return ManagedPBO(pbo, this, &(last.refcount), &(last.pending), idx);
-        }
-        immediate = false;
-        waitCycles_++;
-        lock_.unlock();
-        std::this_thread::sleep_for(2ms);
+    std::unique_lock<std::mutex> lck(lock_);
+    requests_++;
+    uint64_t ticket = nextTicket_++;
+    entry * ent = (ticket == serving_) ? acquire(width, height, channels, bytesPerChannel) : nullptr;
+    if (ent) immediateHits_++;
+    else {
+        waits_++;
+        auto start = std::chrono::steady_clock::now();
+        released_.wait(lck, [&]() {
+            if (ticket != serving_) return false;
+            ent = acquire(width, height, channels, bytesPerChannel);
+            return (ent != nullptr);
+        });
+        waitTime_ += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    serving_++;
+    bool waiters = (nextTicket_ != serving_);
+    ManagedPBO result(ent->pbo, this, &(ent->refcount), &(ent->pending), ent->index);
+    lck.unlock();
+    if (waiters) released_.notify_all();
+    return result;
+}
+
+
+/**
+ * @brief Pre-allocate PBOs of a specific size
+ *
+ * @param width Width (pixels) of the PBOs
+ * @param height Height (pixels) of the PBOs
+ * @param channels Number of channels of the PBOs
+ * @param bytesPerChannel Number of bytes per channel
+ * @param count Number of PBOs of the supplied size that should be available in the pool
+ * @param access Intended use of the PBOs, used to allocate the buffer storage accordingly
+ *
+ * @pre The GL context stored with the pool (or one that is shared with it) is current to the
+ *      calling thread
+ *
+ * Makes sure that the pool contains at least \p count PBOs (busy or not) of the supplied size,
+ * including the buffer storage, such that the first requests for PBOs of that size do not
+ * incur any allocation. Pre-allocation stops at the pool capacity.
+ */
+void PBOPool::reserve(int width, int height, int channels, int bytesPerChannel, int count, PBO::accesstype access) {
+    std::lock_guard<std::mutex> lck(lock_);
+    size_t bytes = sizeClass(width, height, channels, bytesPerChannel);
+    int existing = 0;
+    for (const entry & ent : availablePBOs_) {
+        if (ent.bucket == bytes) existing++;
+    }
+    while ((existing < count) && (currentPBOs_ < maxPBOs_)) {
+        PBO * pbo = new PBO(width, height, channels, bytesPerChannel, context());
+        if (access == PBO::WRITE) pbo->prepareForWrite(bytes);
+        else pbo->prepareForRead(bytes);
+        availablePBOs_.emplace_back(pbo, false, currentPBOs_++);
+        entry & last = availablePBOs_.back();
+        last.bucket = bytes;
+        entries_[pbo] = &last;
+        free_[bytes].push_back(&last);
+        existing++;
     }
 }
 
@@ -123,8 +152,9 @@ void PBOPool::logStatistics() {
     FNLOGD("PBO pool %p access statistics:", this);
     FNLOGD("  # requests: %" PRIu64, requests_);
     FNLOGD("  # immhits: %" PRIu64, immediateHits_);
-    FNLOGD("  # wait cycles: %" PRIu64, waitCycles_);
-    FNLOGD("  wait time: %" PRIu64 " ms", waitCycles_*2);
+    FNLOGD("  # repurposed: %" PRIu64, repurposed_);
+    FNLOGD("  # waits: %" PRIu64, waits_);
+    FNLOGD("  wait time: %" PRIu64 " us", waitTime_);
 #endif
 }
 
@@ -133,6 +163,54 @@ void PBOPool::logStatistics() {
 #                               N O N -  P U B L I C  F U N C T I O N S                            #
 ##################################################################################################*/
 
+/**
+ * @brief Try to obtain a %PBO with the supplied dimensions
+ *
+ * @param width Width (pixels) of the %PBO to get
+ * @param height Height (pixels) of the %PBO to get
+ * @param channels Number of channels for the %PBO to get
+ * @param bytesPerChannel Number of bytes per channel
+ *
+ * @return Pointer to pool entry that was marked as busy, or \c nullptr if no %PBO can be obtained
+ *         at this point
+ *
+ * @pre #lock_ is held by the calling thread
+ *
+ * The lookup first checks the free list of the requested size class, then creates a new %PBO if
+ * the pool is below capacity and finally re-purposes a free %PBO from a different size class.
+ */
+PBOPool::entry * PBOPool::acquire(int width, int height, int channels, int bytesPerChannel) {
+    size_t bytes = sizeClass(width, height, channels, bytesPerChannel);
+    entry * ent = nullptr;
+    auto bucket = free_.find(bytes);
+    if ((bucket != free_.end()) && (!bucket->second.empty())) {
+        ent = bucket->second.front();
+        bucket->second.pop_front();
+    } else if (currentPBOs_ < maxPBOs_) {
+        PBO * pbo = new PBO(width, height, channels, bytesPerChannel, context());
+        availablePBOs_.emplace_back(pbo, true, currentPBOs_++);
+        ent = &availablePBOs_.back();
+        ent->bucket = bytes;
+        entries_[pbo] = ent;
+        return ent;
+    } else {
+        for (auto & other : free_) {
+            if (!other.second.empty()) {
+                ent = other.second.front();
+                other.second.pop_front();
+                repurposed_++;
+                break;
+            }
+        }
+        if (!ent) return nullptr;
+    }
+    ent->busy = true;
+    ent->bucket = bytes;
+    ent->pbo->resize(width, height, channels, bytesPerChannel);
+    return ent;
+}
+
+
 /**
  * @brief Release a %PBO back into the pool
  *
@@ -141,20 +219,22 @@ void PBOPool::logStatistics() {
  * @pre The supplied \p pbo must not be marked as pending
  * @post Corresponding pool entry will have the %PBO marked as not-busy.
  *
- * This function releases a %PBO back to the pool by locating its entry in the list of PBOs
- * and marking the %PBO as not-busy (available).
+ * This function releases a %PBO back to the pool by marking its entry as not-busy (available) and
+ * appending it to the free list of its size class. Threads that are waiting for a %PBO are woken
+ * up afterwards.
  */
 void PBOPool::releasePBO(PBO * pbo) {
-    std::lock_guard<std::mutex> lck(lock_);
-    int idx = 0;
-    for (auto ii=availablePBOs_.begin(); ii != availablePBOs_.end(); ++ii,idx++) {
-        if ((*ii).pbo == pbo) {
-            (*ii).busy = false;
-            return;
-        }
+    {
+        std::lock_guard<std::mutex> lck(lock_);
+        auto it = entries_.find(pbo);
+        // this should not happen
+        assert(it != entries_.end());
+        if (it == entries_.end()) return;
+        entry * ent = it->second;
+        ent->busy = false;
+        free_[ent->bucket].push_back(ent);
     }
-    // this should not happen
-    assert(false);
+    released_.notify_all();
 }
 
 
@@ -14,8 +14,11 @@
 
 #include <cassert>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <list>
+#include <deque>
+#include <unordered_map>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -37,8 +40,18 @@ namespace opengl {
  *
  * This class serves as a simple (and thread-safe) PBO pool. It stores a dynamic list of PBOs
  * with a maximum capacity and provides managed PBO instances for multi-threaded scenarios.
- * All instances are tracked by the pool, which retains the ownership, and are made available
- * without prioritization.
+ * All instances are tracked by the pool, which retains the ownership.
+ *
+ * Available PBOs are kept in free lists that are bucketed by their size (in bytes), such that
+ * layers with different tensor sizes do not cause a re-allocation of the buffer storage each time
+ * a %PBO changes hands. A %PBO from a different bucket is only re-purposed when the pool has
+ * reached its capacity and no %PBO of the requested size is available.
+ *
+ * In case the pool is exhausted, requesting threads block on a condition variable until a %PBO is
+ * released. Waiting threads are served in FIFO order.
+ *
+ * Optionally, the pool can be instructed to pre-allocate PBOs with the exact sizes that the
+ * layers of a network require, see setPreallocation() and reserve().
  *
  * @see ManagedPBO, PBO
  */
@@ -52,11 +65,13 @@ class PBOPool : public fyusenet::GfxContextTracker {
      * state and reference counting.
      */
     struct entry {
-        entry(PBO *p, bool b) : pbo(p), busy(b) {}
+        entry(PBO *p, bool b, int idx) : pbo(p), busy(b), index(idx) {}
         entry(entry && src) {
             pbo = src.pbo;
             busy = src.busy;
             pending = src.pending;
+            index = src.index;
+            bucket = src.bucket;
             // NOTE (mw) not atomic
             refcount.store(src.refcount.load());
         }
@@ -67,6 +82,8 @@ class PBOPool : public fyusenet::GfxContextTracker {
         bool busy = false;                      //!< Indicator if the #pbo is currently busy (i.e. a reference outside of the pool itself is held)
         bool pending = false;                   //!< Indicator if the #pbo is currently in a pending state (an operation was triggered and the result is still pending)
         std::atomic<uint32_t> refcount{0};      //!< Number of references held to the #pbo, includes a reference by the pool itself
+        int index = -1;                         //!< Index of the entry in the pool (order of creation)
+        size_t bucket = 0;                      //!< Size class (in bytes) that the #pbo is currently assigned to
     };
  public:
     // ------------------------------------------------------------------------
@@ -79,8 +96,29 @@ class PBOPool : public fyusenet::GfxContextTracker {
     // Public methods
     // ------------------------------------------------------------------------
     ManagedPBO getAvailablePBO(int width, int height, int channels, int bytesPerChannel);
+    void reserve(int width, int height, int channels, int bytesPerChannel, int count, PBO::accesstype access);
     void logStatistics();
 
+    /**
+     * @brief Enable/disable pre-allocation of PBOs during layer setup
+     *
+     * @param enable If \c true, layers that use this pool will reserve() the PBOs they need
+     *               during their setup
+     */
+    void setPreallocation(bool enable) {
+        preallocate_ = enable;
+    }
+
+    /**
+     * @brief Check if PBOs should be pre-allocated during layer setup
+     *
+     * @retval true if layers should reserve() their PBOs during setup
+     * @retval false otherwise
+     */
+    bool preallocation() const {
+        return preallocate_;
+    }
+
     /**
      * @brief Set the maximum allowed number of PBOs for the pool
      *
@@ -88,24 +126,51 @@ class PBOPool : public fyusenet::GfxContextTracker {
      */
     void setMaxPBOs(int mx) {
         assert(mx >= 0);
-        maxPBOs_ = mx;
+        {
+            std::lock_guard<std::mutex> lck(lock_);
+            maxPBOs_ = mx;
+        }
+        released_.notify_all();
     }
  private:
     // ------------------------------------------------------------------------
     // Non-public methods
     // ------------------------------------------------------------------------
     void releasePBO(PBO *pbo);
+    entry * acquire(int width, int height, int channels, int bytesPerChannel);
+
+    /**
+     * @brief Compute size class (bucket key) for a %PBO
+     *
+     * @param width Width (pixels) of the %PBO
+     * @param height Height (pixels) of the %PBO
+     * @param channels Number of channels of the %PBO
+     * @param bytesPerChannel Number of bytes per channel
+     *
+     * @return Number of bytes required for a %PBO with the supplied dimensions
+     */
+    static size_t sizeClass(int width, int height, int channels, int bytesPerChannel) {
+        return (size_t)width * (size_t)height * (size_t)channels * (size_t)bytesPerChannel;
+    }
 
     // ------------------------------------------------------------------------
     // Member variables
     // ------------------------------------------------------------------------
     int maxPBOs_ = 1;                       //!< Maximum number of PBOs in the pool
     int currentPBOs_ = 0;                   //!< Current number of PBOs in the pool
+    bool preallocate_ = false;              //!< Indicator if layers should pre-allocate their PBOs during setup
     std::mutex lock_;                       //!< Serialization to pool resources
-    std::list<entry> availablePBOs_;        //!< List of pool resources
+    std::condition_variable released_;      //!< Signalled whenever a %PBO is released back into the pool (or a waiter is served)
+    std::list<entry> availablePBOs_;        //!< List of pool resources (stable addresses, owns the entries)
+    std::unordered_map<size_t, std::deque<entry *>> free_;    //!< Free lists, bucketed by %PBO size (in bytes)
+    std::unordered_map<const PBO *, entry *> entries_;        //!< Maps PBOs to their pool entries
+    uint64_t nextTicket_ = 0;               //!< Next ticket to hand out to a requesting thread (FIFO admission)
+    uint64_t serving_ = 0;                  //!< Ticket that is currently allowed to obtain a %PBO
     uint64_t requests_ = 0;                 //!< For performance measurement, number of times a %PBO was requested from the pool
     uint64_t immediateHits_ = 0;            //!< For performance measurement, number of times a %PBO was available immediately
-    uint64_t waitCycles_ = 0;               //!< For performance measurement, the number of busy-waiting rounds until a %PBO became available
+    uint64_t repurposed_ = 0;               //!< For performance measurement, number of times a %PBO was taken from a different size bucket
+    uint64_t waits_ = 0;                    //!< For performance measurement, number of times a request had to wait for a %PBO
+    uint64_t waitTime_ = 0;                 //!< For performance measurement, accumulated waiting time (in microseconds)
 };
 
 } // opengl namespace
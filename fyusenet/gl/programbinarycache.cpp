@@ -0,0 +1,238 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Persistent GLSL Program Binary Cache
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstdio>
+#include <cinttypes>
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "programbinarycache.h"
+#include "xxhash64.h"
+#include "../common/logging.h"
+
+//-------------------------------------- Global Variables ------------------------------------------
+namespace fyusion {
+namespace opengl {
+
+ProgramBinaryCache * ProgramBinaryCache::instance_ = nullptr;
+std::string ProgramBinaryCache::requested_;
+bool ProgramBinaryCache::probed_ = false;
+std::mutex ProgramBinaryCache::instanceLock_;
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+static constexpr uint32_t BINARY_MAGIC = 0x42505946;        // "FYPB" in little-endian
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+
+/**
+ * @brief Set directory for the program binary cache (and enable it)
+ *
+ * @param directory Existing and writable directory that holds the cached binaries, supply an
+ *                  empty string to disable the cache
+ *
+ * @note This only affects programs that are linked after this call.
+ */
+void ProgramBinaryCache::setDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lck(instanceLock_);
+    requested_ = directory;
+    if ((instance_) && (!directory.empty())) {
+        std::lock_guard<std::mutex> flck(instance_->fileLock_);
+        instance_->directory_ = normalize(directory);
+    }
+}
+
+
+/**
+ * @brief Retrieve program binary cache instance
+ *
+ * @return Pointer to cache instance or \c nullptr if the cache is disabled or not supported
+ *
+ * @pre A GL context is current to the calling thread
+ *
+ * On first use, this function checks if the GL implementation supports program binaries and
+ * queries the driver identification strings.
+ */
+ProgramBinaryCache * ProgramBinaryCache::getInstance() {
+#ifdef FYUSENET_USE_WEBGL
+    return nullptr;
+#else
+    std::lock_guard<std::mutex> lck(instanceLock_);
+    if (requested_.empty()) return nullptr;
+    if ((instance_) || (probed_)) return instance_;
+    probed_ = true;
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        FNLOGW("GL implementation does not support program binaries, disabling program binary cache");
+        return nullptr;
+    }
+    instance_ = new ProgramBinaryCache(requested_);
+    return instance_;
+#endif
+}
+
+
+/**
+ * @brief Load program binary from cache into a program object
+ *
+ * @param key Key that identifies the program (see ShaderProgram)
+ * @param program GL handle of (unlinked) program object to load the binary into
+ *
+ * @retval true if the binary was found and accepted by the driver, the program is linked then
+ * @retval false if no binary was found or it was rejected, the program remains unlinked
+ *
+ * Binaries that are rejected by the driver are removed from the cache.
+ */
+bool ProgramBinaryCache::load(uint64_t key, GLuint program) {
+#ifdef FYUSENET_USE_WEBGL
+    return false;
+#else
+    std::string name;
+    std::vector<uint8_t> data;
+    header hdr;
+    {
+        std::lock_guard<std::mutex> lck(fileLock_);
+        name = fileName(key);
+        FILE *in = fopen(name.c_str(), "rb");
+        if (!in) return false;
+        bool valid = (fread(&hdr, sizeof(hdr), 1, in) == 1) && (hdr.magic == BINARY_MAGIC) &&
+                     (hdr.key == key) && (hdr.driver == driverHash_) && (hdr.length > 0);
+        if (valid) {
+            data.resize(hdr.length);
+            valid = (fread(data.data(), 1, hdr.length, in) == hdr.length);
+        }
+        fclose(in);
+        if (!valid) {
+            remove(name.c_str());
+            return false;
+        }
+    }
+    glGetError();
+    glProgramBinary(program, (GLenum)hdr.format, data.data(), (GLsizei)hdr.length);
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    GLenum err = glGetError();
+    if ((status == GL_FALSE) || (err != GL_NO_ERROR)) {
+        FNLOGD("Cached program binary %016" PRIx64 " rejected by driver, recompiling", key);
+        std::lock_guard<std::mutex> lck(fileLock_);
+        remove(name.c_str());
+        return false;
+    }
+    return true;
+#endif
+}
+
+
+/**
+ * @brief Store binary of a linked program in the cache
+ *
+ * @param key Key that identifies the program (see ShaderProgram)
+ * @param program GL handle of linked program object
+ *
+ * @retval true if the binary was written to the cache
+ * @retval false otherwise
+ *
+ * The binary is first written to a temporary file which is then renamed, such that concurrent
+ * processes never observe partially written binaries.
+ */
+bool ProgramBinaryCache::store(uint64_t key, GLuint program) {
+#ifdef FYUSENET_USE_WEBGL
+    return false;
+#else
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+    std::vector<uint8_t> data(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetError();
+    glGetProgramBinary(program, length, &written, &format, data.data());
+    if ((glGetError() != GL_NO_ERROR) || (written <= 0)) return false;
+    header hdr{BINARY_MAGIC, (uint32_t)format, key, driverHash_, (uint64_t)written};
+    std::lock_guard<std::mutex> lck(fileLock_);
+    std::string name = fileName(key);
+    std::string tmpname = name + ".tmp";
+    FILE *out = fopen(tmpname.c_str(), "wb");
+    if (!out) {
+        FNLOGW("Cannot write program binary to %s", tmpname.c_str());
+        return false;
+    }
+    bool ok = (fwrite(&hdr, sizeof(hdr), 1, out) == 1) && (fwrite(data.data(), 1, written, out) == (size_t)written);
+    ok &= (fclose(out) == 0);
+    if ((!ok) || (rename(tmpname.c_str(), name.c_str()) != 0)) {
+        remove(tmpname.c_str());
+        return false;
+    }
+    return true;
+#endif
+}
+
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @brief Constructor
+ *
+ * @param directory Directory that holds the cached binaries
+ *
+ * @pre A GL context is current to the calling thread
+ */
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory) : directory_(normalize(directory)) {
+    std::string driver;
+    const GLenum ids[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    for (GLenum id : ids) {
+        const char * str = (const char *)glGetString(id);
+        if (str) driver += str;
+        driver += "\n";
+    }
+    driverHash_ = XXHash64::hash(driver, 0);
+}
+
+
+/**
+ * @brief Make sure that a directory name ends with a path separator
+ *
+ * @param directory Directory name
+ *
+ * @return Directory name with trailing path separator
+ */
+std::string ProgramBinaryCache::normalize(const std::string& directory) {
+    if ((!directory.empty()) && (directory.back() != '/')) return directory + "/";
+    return directory;
+}
+
+
+/**
+ * @brief Compose file name for a cached binary
+ *
+ * @param key Key that identifies the program
+ *
+ * @return Full path to the binary file
+ *
+ * @pre #fileLock_ is held by the calling thread
+ */
+std::string ProgramBinaryCache::fileName(uint64_t key) const {
+    char name[64];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".glbin", key);
+    return directory_ + std::string(name);
+}
+
+} // opengl namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
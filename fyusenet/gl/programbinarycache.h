@@ -0,0 +1,105 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Persistent GLSL Program Binary Cache (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstdint>
+#include <string>
+#include <mutex>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gl_sys.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace opengl {
+
+/**
+ * @brief Persistent (on-disk) cache for linked shader program binaries
+ *
+ * The ShaderCache only avoids redundant compilation within a single process. Each new process
+ * still has to compile and link every shader program, which can take a substantial amount of
+ * time on mobile drivers. This cache stores the driver-specific program binaries obtained by
+ * \c glGetProgramBinary() in a user-supplied directory and re-loads them using
+ * \c glProgramBinary() on subsequent runs, skipping shader compilation and linkage entirely.
+ *
+ * Binaries are addressed by a 64-bit key which is computed by ShaderProgram from the full
+ * shader sources (including the preamble and preprocessor definitions) and the attribute
+ * bindings. The key is seeded with a hash over the \c GL_VENDOR, \c GL_RENDERER and
+ * \c GL_VERSION strings, such that a driver update invalidates all cached binaries. In case the
+ * driver rejects a cached binary nevertheless, the binary is removed from the cache and the
+ * program is compiled and linked from source.
+ *
+ * The cache is disabled by default, it is enabled by supplying an existing and writable
+ * directory via setDirectory(). It is not available on WebGL and on systems that do not report
+ * any program binary formats.
+ *
+ * @see ShaderProgram::link(), ShaderCache
+ */
+class ProgramBinaryCache {
+ public:
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    bool load(uint64_t key, GLuint program);
+    bool store(uint64_t key, GLuint program);
+
+    /**
+     * @brief Get seed value for key computation
+     *
+     * @return Hash over the driver identification strings, to be used as seed for the keys
+     */
+    uint64_t seed() const {
+        return driverHash_;
+    }
+
+    // ------------------------------------------------------------------------
+    // Static functions
+    // ------------------------------------------------------------------------
+    static void setDirectory(const std::string& directory);
+    static ProgramBinaryCache * getInstance();
+
+ private:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    ProgramBinaryCache(const std::string& directory);
+    std::string fileName(uint64_t key) const;
+    static std::string normalize(const std::string& directory);
+
+    /**
+     * @brief File header for cached program binaries
+     */
+    struct header {
+        uint32_t magic;             //!< Magic number to identify cache files
+        uint32_t format;            //!< Binary format as returned by \c glGetProgramBinary()
+        uint64_t key;               //!< Key of the program binary
+        uint64_t driver;            //!< Hash over the driver identification strings
+        uint64_t length;            //!< Length of the binary data (in bytes) following the header
+    };
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    std::string directory_;                     //!< Directory to store the binaries in
+    uint64_t driverHash_ = 0;                   //!< Hash over vendor, renderer and version strings
+    std::mutex fileLock_;                       //!< Serializes file access within this process
+    static ProgramBinaryCache * instance_;      //!< Singleton instance (if cache is enabled and supported)
+    static std::string requested_;              //!< Directory that was supplied to setDirectory()
+    static bool probed_;                        //!< Indicator if system support was already probed
+    static std::mutex instanceLock_;            //!< Serializes singleton creation
+};
+
+} // opengl namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
@@ -325,15 +325,49 @@ void Shader::loadFromFile(const char *fileName) {
  * be used as part of a shader program, which requires linking the shader (see ShaderProgram
  * class).
  *
+ * If the compilation was already submitted by submit(), this function only checks the compile
+ * status, which blocks until the driver has finished the compilation.
+ *
  * @throws ShaderException in case the compilation was unsuccessful
  */
 void Shader::compile() {
+    if (pending_) {
+        verify();
+        return;
+    }
     if (shaderCode_.size() == 0) THROW_EXCEPTION_ARGS(ShaderException,"No shader code supplied");
     std::string comb = preamble_ + preprocDefs_ + shaderCode_;
     compile(comb.c_str());
 }
 
 
+/**
+ * @brief Submit shader source for compilation without waiting for the result
+ *
+ * This function hands the shader source to the GL driver for compilation but does not query the
+ * compile status. Drivers that support \c GL_KHR_parallel_shader_compile perform the compilation
+ * on background threads in that case. The compile status is checked by a subsequent call to
+ * compile() or by ShaderProgram when the program is linked.
+ *
+ * @note This function does not check for the GL context, such that it can also be used from
+ *       threads that have a context current which shares resources with the context of this
+ *       shader (see ShaderCompiler).
+ *
+ * @throws ShaderException in case no shader code was supplied or the shader could not be created
+ */
+void Shader::submit() {
+    if (isCompiled()) return;
+    if (shaderCode_.size() == 0) THROW_EXCEPTION_ARGS(ShaderException,"No shader code supplied");
+    std::string comb = preamble_ + preprocDefs_ + shaderCode_;
+    const char * data = comb.c_str();
+    handle_ = glCreateShader(type_);
+    if (handle_ == 0) THROW_EXCEPTION_ARGS(ShaderException,"Cannot create shader");
+    glShaderSource(handle_, 1, &data, nullptr);
+    glCompileShader(handle_);
+    pending_ = true;
+}
+
+
 /**
  * @brief
  *
@@ -377,6 +411,27 @@ void Shader::compile(const char *data) {
 }
 
 
+/**
+ * @brief Check compile status of a submitted shader
+ *
+ * @throws ShaderException in case the compilation was unsuccessful
+ *
+ * @see submit()
+ */
+void Shader::verify() {
+    GLint status = GL_FALSE;
+    pending_ = false;
+    glGetShaderiv(handle_, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE) {
+        logError();
+        logShader(getCode().c_str());
+        glDeleteShader(handle_);
+        handle_ = 0;
+        THROW_EXCEPTION_ARGS(ShaderException,"Error compiling shader");
+    }
+}
+
+
 /**
  * @brief Log compiler error message
  *
@@ -469,7 +524,7 @@ std::string Shader::includeSnippets(const std::string& code) {
     size_t copystart = 0;
     size_t ipos = code.find("#include");
     if (ipos == std::string::npos) return code;
-    std::string output = code.substr(0,ipos-1);
+    std::string output = code.substr(0,ipos);
     do {
         size_t lineend;
         for (lineend = ipos ;lineend < code.size(); lineend++) {
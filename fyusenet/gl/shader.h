@@ -134,9 +134,20 @@ class Shader : public fyusenet::GfxContextTracker {
     void loadFromFile(const char *fileName);
 #endif
     void compile();
+    void submit();
     bool isCompiled() const;
     void log() const;
 
+    /**
+     * @brief Check if the compilation of this shader was submitted but not verified yet
+     *
+     * @retval true if the shader was submitted using submit() and its compile status was not checked
+     * @retval false otherwise
+     */
+    bool isPending() const {
+        return pending_;
+    }
+
     /**
      * @brief Get underlying OpenGL shader handle
      *
@@ -151,6 +162,7 @@ class Shader : public fyusenet::GfxContextTracker {
     // Non-public methods
     // ------------------------------------------------------------------------
     void compile(const char *data);
+    void verify();
     void logError() const;
     void logShader(const char *data) const;
     std::string includeSnippets(const std::string& code);
@@ -164,6 +176,7 @@ class Shader : public fyusenet::GfxContextTracker {
     std::string resourceName_;                       //!< Optional resource name that this shader was created from
     GLuint handle_ = 0;                              //!< OpenGL handle for the shader (valid after successful compilation)
     GLenum type_ = 0;                                //!< Shader type (e.g. fragment shader, vertex shader, etc.)
+    bool pending_ = false;                           //!< Indicator that compilation was submitted but the status was not checked yet
     GLInfo::glslver version_ = GLInfo::UNSPECIFIED;  //!< Target GLSL version for the shader, if left at UNSPECIFIED, most recent platform version will be used
     mutable uint64_t hash_;                          //!< Hash that is computed over the (full) shader code for caching and computed externally
 };
@@ -72,8 +72,7 @@ programptr ShaderBuilder::shaderProgramFromResource(const char *vertResName, con
             shaderptr vcache = cache->findShader(vshader);
             shaderptr fcache = cache->findShader(fshader);
             if (vcache && fcache) {
-                std::vector<GLuint> handles{vcache->getHandle(),fcache->getHandle()};
-                programptr prog = cache->findProgram(modhash,handles);
+                programptr prog = cache->findProgram(modhash, {vcache, fcache});
                 if (prog) {
                     return prog;
                 }
@@ -76,21 +76,21 @@ void ShaderCache::clear() {
  * @brief Find shader program in cache
  *
  * @param moduleID Identifier for the module/class that is querying
- * @param handles Vector of shader handles that we want to find a cached (linked) program for
+ * @param shaders Vector of (cached) shaders that we want to find a cached program for
  *
  * @return Shared pointer to ShaderProgram object that fulfills query, or empty pointer if not found.
  *
  * Returns a shared ShaderProgram object that meets the query criteria, i.e. the program was
- * created from the supplied shader handles and was created under the same \p moduleID as the
+ * created from the supplied shaders and was created under the same \p moduleID as the
  * one supplied in the query. If not such object is found, an empty (shared) object is returned.
  *
  * @note This function is not thread-safe, however we assume that it is only called from within
  *       the thread which is associated to the pertaining OpenGL context, thus we do not need
  *       to make it thread-safe.
  */
-programptr ShaderCache::findProgram(size_t moduleID, std::vector<GLuint> handles) const {
-    if (handles.empty()) return 0;
-    uint64_t hash = computeProgramHash(handles,moduleID);
+programptr ShaderCache::findProgram(size_t moduleID, const std::vector<shaderptr>& shaders) const {
+    if (shaders.empty()) return 0;
+    uint64_t hash = computeProgramHash(shaders, moduleID);
     auto it = programs_.find(hash);
     if (it == programs_.end()) return programptr();
     else return it->second;
@@ -101,20 +101,20 @@ programptr ShaderCache::findProgram(size_t moduleID, std::vector<GLuint> handles
  * @brief Find shader program GL handle in cache
  *
  * @param moduleID Identifier for the module/class that is querying
- * @param handles Vector of shader handles that we want to find a cached (linked) program for
+ * @param shaders Vector of (cached) shaders that we want to find a cached program for
  *
  * @return GL handle of shader program or 0 if it was not found
  *
  * Returns a GL handle of a shader program that meets the query criteria, i.e. the program was
- * created from the supplied shader handles and was created under the same \p moduleID as the
+ * created from the supplied shaders and was created under the same \p moduleID as the
  * one supplied in the query. If not such object is found, a zero handle is returned.
  *
  * @note This function is not thread-safe, however we assume that it is only called from within
  *       the thread which is associated to the pertaining OpenGL context, thus we do not need
  *       to make it thread-safe.
  */
-GLuint ShaderCache::findProgramID(size_t moduleID, std::vector<GLuint> handles) const {
-    programptr ptr = findProgram(moduleID, handles);
+GLuint ShaderCache::findProgramID(size_t moduleID, const std::vector<shaderptr>& shaders) const {
+    programptr ptr = findProgram(moduleID, shaders);
     if (ptr.get()) {
         return ptr.get()->handle_;
     } else return 0;
@@ -122,9 +122,9 @@ GLuint ShaderCache::findProgramID(size_t moduleID, std::vector<GLuint> handles)
 
 
 /**
- * @brief Put a compiled and linked shader program into the shader cache
+ * @brief Put a shader program into the shader cache
  *
- * @param program Shared pointer to linked GL program
+ * @param program Shared pointer to GL program, the program does not have to be linked yet
  * @param moduleID Identifier for the module/class that the program was created under
  *
  * @note This function is not thread-safe, however we assume that it is only called from within
@@ -132,9 +132,8 @@ GLuint ShaderCache::findProgramID(size_t moduleID, std::vector<GLuint> handles)
  *       to make it thread-safe.
  */
 void ShaderCache::putProgram(programptr program, size_t moduleID) {
-    std::vector<GLuint> handles = program->getShaderHandles();
-    if (handles.empty()) THROW_EXCEPTION_ARGS(GLException,"Cannot add program to cache, no shader handles found");
-    uint64_t hash = computeProgramHash(handles, moduleID);
+    if (program->shaders_.empty()) THROW_EXCEPTION_ARGS(GLException,"Cannot add program to cache, no shaders found");
+    uint64_t hash = computeProgramHash(program->shaders_, moduleID);
     program->hash_ = hash;
     programs_[hash] = program;
 }
@@ -194,15 +193,14 @@ GLuint ShaderCache::findShaderID(shaderptr shader) const {
 
 
 /**
- * @brief Put a compiled vertex/fragment/compute shader into the cache
+ * @brief Put a vertex/fragment/compute shader into the cache
  *
- * @param shader Shared pointer to a compiled vertex/fragment/compute shader which should be cached
+ * @param shader Shared pointer to a vertex/fragment/compute shader which should be cached
  *
- * @pre The supplied \p shader must have been (successfully) compiled before putting it into the
- *      cache
+ * The supplied \p shader does not have to be compiled yet, in that case it will be compiled by
+ * the first ShaderProgram that requires it for linkage (see ProgramBinaryCache).
  */
 void ShaderCache::putShader(shaderptr shader) {
-    if (!shader->isCompiled()) THROW_EXCEPTION_ARGS(GLException, "Shader must be compiled before being put into the cache");
     uint64_t hash = XXHash64::hash(shader->getCode(),seed_);
     shader->hash_ = hash;
     shaders_[hash] = shader;
@@ -285,21 +283,21 @@ ShaderCache * ShaderCache::getInstance(const fyusenet::GfxContextLink & ctx) {
 ##################################################################################################*/
 
 /**
- * @brief Compute 64-bit hash for a set of shader handles and a module ID
+ * @brief Compute 64-bit hash for a set of shaders and a module ID
  *
- * @param handles Vector of shader handles (not program handles) that make up a GL program
+ * @param shaders Vector of shaders that make up a GL program
  * @param moduleID Identifier for the module/class that the program was created under
  *
  * @return 64-bit hash value that can be used as hash-value for a shader program
  *
- * This function computes a hash based on the supplied \p moduleID and the GL handles, which are
- * simply sorted and then fed into a hash computation.
- *
- * @warning The \p handles will be sorted in place and are subject to change their order
+ * This function computes a hash based on the supplied \p moduleID and the content hashes of the
+ * shaders, which are sorted and then fed into a hash computation.
  */
-uint64_t ShaderCache::computeProgramHash(std::vector<GLuint>& handles, size_t moduleID) const {
-    std::sort(handles.begin(),handles.end(),[](GLuint t1,GLuint t2) { return  (t1 < t2); });
-    uint64_t hash = XXHash64::hash((const void *)(&handles[0]),sizeof(GLuint)*handles.size(),seed_ + moduleID);
+uint64_t ShaderCache::computeProgramHash(const std::vector<shaderptr>& shaders, size_t moduleID) const {
+    std::vector<uint64_t> hashes;
+    for (const shaderptr & shader : shaders) hashes.push_back(XXHash64::hash(shader->getCode(), seed_));
+    std::sort(hashes.begin(), hashes.end());
+    uint64_t hash = XXHash64::hash((const void *)hashes.data(), sizeof(uint64_t)*hashes.size(), seed_ + moduleID);
     return hash;
 }
 
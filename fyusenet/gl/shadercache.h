@@ -41,10 +41,12 @@ namespace opengl {
  * For shaders we use a content-based method which simply computes a hash of the actual shader
  * source code and uses that to index the shader in the cache.
  *
- * For compiled and linked programs we use a different mechanism which uses the GL program handles
- * and something called a \e moduleID, which is a number that is used to modify the seed for the
- * hash computation on the handles. We use this as additional distinction based on different
- * use-cases of shader programs where the shader state might be different.
+ * For shader programs we combine the content hashes of the shaders that make up the program with
+ * something called a \e moduleID, which is a number that is used to modify the seed for the
+ * hash computation. We use this as additional distinction based on different use-cases of shader
+ * programs where the shader state might be different. As the program hash does not depend on any
+ * GL handles, shaders and programs may be cached before they are compiled, which allows the
+ * ProgramBinaryCache to skip the compilation entirely.
  *
  * @warning Though not likely at all, this code does not include any measures to prevent collisions
  *          on the used hashes. So, if you run into strange errors where the wrong shaders are used,
@@ -65,8 +67,8 @@ class ShaderCache : public fyusenet::GfxContextTracker {
     GLuint findShaderID(shaderptr shader) const;
     shaderptr findShader(shaderptr shader) const;
     void putShader(shaderptr shader);
-    programptr findProgram(size_t moduleID, std::vector<GLuint> handles) const;
-    GLuint findProgramID(size_t moduleID, std::vector<GLuint> handles) const;
+    programptr findProgram(size_t moduleID, const std::vector<shaderptr>& shaders) const;
+    GLuint findProgramID(size_t moduleID, const std::vector<shaderptr>& shaders) const;
     void putProgram(programptr program, size_t moduleID);
     // ------------------------------------------------------------------------
     // Static functions
@@ -77,7 +79,7 @@ class ShaderCache : public fyusenet::GfxContextTracker {
     // ------------------------------------------------------------------------
     // Non-public methods
     // ------------------------------------------------------------------------
-    uint64_t computeProgramHash(std::vector<GLuint> & handles, size_t moduleID) const;
+    uint64_t computeProgramHash(const std::vector<shaderptr>& shaders, size_t moduleID) const;
 
     // ------------------------------------------------------------------------
     // Member variables
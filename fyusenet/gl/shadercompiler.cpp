@@ -0,0 +1,285 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deferred / Parallel Shader Compilation
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <algorithm>
+#include <unordered_set>
+#include <thread>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "shadercompiler.h"
+#include "shaderprogram.h"
+#include "glinfo.h"
+#include "glexception.h"
+#ifdef FYUSENET_MULTITHREADING
+#include "asyncpool.h"
+#endif
+#include "../common/logging.h"
+
+//-------------------------------------- Global Variables ------------------------------------------
+namespace fyusion {
+namespace opengl {
+
+std::vector<ShaderCompiler *> ShaderCompiler::compilers_;
+std::mutex ShaderCompiler::instanceLock_;
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+#ifdef FYUSENET_USE_EGL
+typedef void (*maxCompilerThreadsProc)(GLuint count);
+#endif
+
+static constexpr int MAX_COMPILER_THREADS = 4;
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @brief Start submission phase
+ *
+ * @pre The GL context of this instance is current to the calling thread
+ *
+ * After calling this function, ShaderProgram::link() only enqueues programs instead of blocking
+ * until compilation and linkage are done (unless the strategy is #SERIAL). Call finish() to end
+ * the submission phase and complete all enqueued programs.
+ */
+void ShaderCompiler::beginSubmission() {
+    assertContext();
+#ifdef FYUSENET_MULTITHREADING
+    if ((strategy_ == THREADS) && (!threadsCreated_)) {
+        // NOTE make sure that the worker threads are available once we need them
+        AsyncPool::createDerivedBatch(context_, numThreads_);
+        threadsCreated_ = true;
+    }
+#endif
+    deferring_ = true;
+}
+
+
+/**
+ * @brief End submission phase and complete all enqueued programs
+ *
+ * @pre The GL context of this instance is current to the calling thread
+ *
+ * This function checks the compile and link status of all programs that were enqueued during
+ * the submission phase. For the #THREADS strategy, the programs are compiled and linked on
+ * worker threads first.
+ *
+ * @throws ShaderException in case a program failed to compile or link. The remaining programs
+ *         stay enqueued and are completed once they are used
+ */
+void ShaderCompiler::finish() {
+    assertContext();
+    deferring_ = false;
+    std::vector<ShaderProgram *> programs = queue_;
+    if (programs.empty()) return;
+    if (strategy_ == THREADS) compileThreaded(programs);
+    for (ShaderProgram * prog : programs) {
+        prog->finishLink();
+    }
+}
+
+
+/**
+ * @brief Leave submission phase without completing the enqueued programs
+ *
+ * Programs that are still enqueued will be completed individually once they are used. This is
+ * mainly intended for error handling when the setup that was using the submission phase failed.
+ */
+void ShaderCompiler::cancel() {
+    deferring_ = false;
+}
+
+
+/**
+ * @brief Select strategy for deferred compilation
+ *
+ * @param strat Strategy to use for programs that are linked in subsequent submission phases
+ *
+ * The default strategy is #DRIVER if \c GL_KHR_parallel_shader_compile is available, #THREADS
+ * on multi-threaded builds otherwise and #SERIAL for all other cases. Selecting a strategy that
+ * is not supported by the system falls back to #SERIAL.
+ *
+ * @pre Not in submission phase
+ */
+void ShaderCompiler::setStrategy(strategy strat) {
+    if (deferring_) THROW_EXCEPTION_ARGS(GLException, "Cannot change strategy during submission phase");
+#ifndef FYUSENET_MULTITHREADING
+    if (strat == THREADS) strat = SERIAL;
+#endif
+    strategy_ = strat;
+}
+
+
+/**
+ * @brief Retrieve compiler instance for a GL context
+ *
+ * @param context Link to GL context to retrieve the compiler instance for
+ *
+ * @return Pointer to compiler instance, creates a new one if none exists for the \p context
+ *
+ * @pre The supplied \p context is current to the calling thread, if no instance existed before
+ *
+ * @warning Do not store the pointer, treat it as transient.
+ */
+ShaderCompiler * ShaderCompiler::getInstance(const fyusenet::GfxContextLink & context) {
+    std::lock_guard<std::mutex> lck(instanceLock_);
+    for (ShaderCompiler * comp : compilers_) {
+        if (comp->context_ == context) return comp;
+    }
+    ShaderCompiler * comp = new ShaderCompiler(context);
+    compilers_.push_back(comp);
+    return comp;
+}
+
+
+/**
+ * @brief Remove all compiler instances
+ *
+ * Programs that are still enqueued are left in their current state and will be completed when
+ * they are used.
+ */
+void ShaderCompiler::tearDown() {
+    std::lock_guard<std::mutex> lck(instanceLock_);
+    for (ShaderCompiler * comp : compilers_) delete comp;
+    compilers_.clear();
+}
+
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @brief Constructor
+ *
+ * @param context Link to GL context that this instance is responsible for
+ *
+ * Selects the default strategy based on the capabilities of the GL implementation.
+ */
+ShaderCompiler::ShaderCompiler(const fyusenet::GfxContextLink & context) {
+    setContext(context);
+    numThreads_ = std::max(1, std::min(MAX_COMPILER_THREADS, (int)std::thread::hardware_concurrency() - 1));
+    if ((GLInfo::hasExtension("GL_KHR_parallel_shader_compile")) || (GLInfo::hasExtension("GL_ARB_parallel_shader_compile"))) {
+        strategy_ = DRIVER;
+#ifdef FYUSENET_USE_EGL
+        auto maxthreads = (maxCompilerThreadsProc)eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+        if (maxthreads) maxthreads(0xFFFFFFFF);
+#endif
+    } else {
+#if defined(FYUSENET_MULTITHREADING) && !defined(FYUSENET_USE_WEBGL)
+        strategy_ = THREADS;
+#else
+        strategy_ = SERIAL;
+#endif
+    }
+}
+
+
+/**
+ * @brief Destructor
+ *
+ * Detaches all programs that are still enqueued.
+ */
+ShaderCompiler::~ShaderCompiler() {
+    for (ShaderProgram * prog : queue_) prog->compiler_ = nullptr;
+    queue_.clear();
+}
+
+
+/**
+ * @brief Add program to the queue of programs waiting for completion
+ *
+ * @param program Pointer to program that was deferred
+ */
+void ShaderCompiler::enqueue(ShaderProgram * program) {
+    queue_.push_back(program);
+}
+
+
+/**
+ * @brief Remove program from the queue of programs waiting for completion
+ *
+ * @param program Pointer to program that was completed or is about to be destroyed
+ */
+void ShaderCompiler::dequeue(ShaderProgram * program) {
+    auto it = std::find(queue_.begin(), queue_.end(), program);
+    if (it != queue_.end()) queue_.erase(it);
+}
+
+
+/**
+ * @brief Compile and link programs on worker threads
+ *
+ * @param programs List of programs that have been enqueued
+ *
+ * The work is split into two stages: first all shaders that have not been compiled yet are
+ * distributed over the worker threads, then all programs are linked on the worker threads. Each
+ * stage ends with a \c glFinish() on every worker, which makes the results visible to the
+ * context of this instance. This function does not check for errors, that is done by the
+ * subsequent completion of the programs on the calling thread, which also compiles shaders that
+ * could not be compiled here.
+ */
+void ShaderCompiler::compileThreaded(const std::vector<ShaderProgram *>& programs) {
+#ifdef FYUSENET_MULTITHREADING
+    std::vector<Shader *> shaders;
+    std::vector<ShaderProgram *> links;
+    std::unordered_set<Shader *> seen;
+    for (ShaderProgram * prog : programs) {
+        if (prog->submitted_) continue;
+        links.push_back(prog);
+        for (const shaderptr & shader : prog->shaders_) {
+            if ((!shader->isCompiled()) && (seen.insert(shader.get()).second)) shaders.push_back(shader.get());
+        }
+    }
+    if (links.empty()) return;
+    std::vector<AsyncPool::GLThread> threads;
+    for (int i=0; i < numThreads_; i++) {
+        AsyncPool::GLThread thread = AsyncPool::getDerivedContextThread(context_, 0);
+        if (!thread.isValid()) break;
+        threads.push_back(thread);
+    }
+    if (threads.empty()) return;
+    int numthreads = (int)threads.size();
+    for (int i=0; i < numthreads; i++) {
+        threads[i]->setTask([&shaders, i, numthreads]() {
+            for (int s=i; s < (int)shaders.size(); s += numthreads) {
+                try {
+                    shaders[s]->submit();
+                } catch (GLException& ex) {
+                    // NOTE the shader will be compiled again on completion and the error reported there
+                }
+            }
+            glFinish();
+        });
+    }
+    for (auto & thread : threads) thread->wait();
+    for (int i=0; i < numthreads; i++) {
+        threads[i]->setTask([&links, i, numthreads]() {
+            for (int p=i; p < (int)links.size(); p += numthreads) {
+                try {
+                    links[p]->submitLink();
+                } catch (GLException& ex) {
+                    // NOTE the link status will be checked on completion and the error reported there
+                }
+            }
+            glFinish();
+        });
+    }
+    for (auto & thread : threads) thread->wait();
+#endif
+}
+
+} // opengl namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,127 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deferred / Parallel Shader Compilation (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+#include <mutex>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gl_sys.h"
+#include "../gpu/gfxcontexttracker.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace opengl {
+
+class ShaderProgram;
+
+/**
+ * @brief Coordinator for deferred and parallel compilation of shader programs
+ *
+ * Setting up a network compiles and links a large number of shader programs, one layer after
+ * another. As each layer checks the results right away, the compilation runs strictly serial,
+ * even if the GL implementation would be able to compile in parallel. This class splits the
+ * compilation into a \e submission phase and a \e completion phase. It maintains one instance per
+ * GL context.
+ *
+ * During the submission phase, which is started by beginSubmission(), ShaderProgram::link() only
+ * enqueues the program and does not check the link status. Uniform lookups in UniformState and
+ * ShaderProgram::mapUniformLocation() are deferred as well. The actual work is done based on the
+ * selected strategy:
+ *   - #DRIVER uses \c GL_KHR_parallel_shader_compile, shaders and programs are handed to the
+ *     driver immediately, which compiles them on its own background threads
+ *   - #THREADS compiles and links the queued programs on worker threads with shared contexts
+ *     that are obtained from the AsyncPool during the completion phase
+ *   - #SERIAL does not defer anything and compiles/links every program on link()
+ *
+ * The completion phase is triggered by finish(), which checks the status of all queued programs.
+ * A queued program that is used before finish() is called (for example by binding it) is
+ * completed on the spot, such that deferring compilation never changes the results.
+ *
+ * @see ShaderProgram::link(), NeuralNetwork::glSetup()
+ */
+class ShaderCompiler : public fyusenet::GfxContextTracker {
+    friend class ShaderProgram;
+ public:
+    /**
+     * @brief Strategies for deferred compilation
+     */
+    enum strategy {
+        SERIAL = 0,         //!< No deferral, programs are compiled and linked on link()
+        DRIVER,             //!< Use \c GL_KHR_parallel_shader_compile to compile on driver threads
+        THREADS             //!< Compile and link on worker threads with shared GL contexts
+    };
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    void beginSubmission();
+    void finish();
+    void cancel();
+    void setStrategy(strategy strat);
+
+    /**
+     * @brief Retrieve compilation strategy used by this instance
+     *
+     * @return Strategy that is used for deferred compilation
+     */
+    strategy getStrategy() const {
+        return strategy_;
+    }
+
+    /**
+     * @brief Check if linkage of programs is currently deferred
+     *
+     * @retval true if in submission phase and a strategy other than #SERIAL is selected
+     * @retval false otherwise
+     */
+    bool isDeferring() const {
+        return deferring_ && (strategy_ != SERIAL);
+    }
+
+    // ------------------------------------------------------------------------
+    // Static functions
+    // ------------------------------------------------------------------------
+    static ShaderCompiler * getInstance(const fyusenet::GfxContextLink & context);
+    static void tearDown();
+
+ private:
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    ShaderCompiler(const fyusenet::GfxContextLink & context);
+    virtual ~ShaderCompiler();
+
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    void enqueue(ShaderProgram * program);
+    void dequeue(ShaderProgram * program);
+    void compileThreaded(const std::vector<ShaderProgram *>& programs);
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    bool deferring_ = false;                            //!< Indicator that we are in the submission phase
+    strategy strategy_ = SERIAL;                        //!< Strategy for deferred compilation
+    int numThreads_ = 1;                                //!< Number of worker threads for the #THREADS strategy
+    bool threadsCreated_ = false;                       //!< Indicator that worker threads were added to the AsyncPool
+    std::vector<ShaderProgram *> queue_;                //!< Programs that are waiting for completion
+    static std::vector<ShaderCompiler *> compilers_;    //!< List of compiler instances (one per context)
+    static std::mutex instanceLock_;                    //!< Serializes access to #compilers_
+};
+
+} // opengl namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
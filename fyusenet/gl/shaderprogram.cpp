@@ -18,6 +18,10 @@
 #include "shaderexception.h"
 #include "uniformstate.h"
 #include "shaderexception.h"
+#include "programbinarycache.h"
+#include "shadercompiler.h"
+#include "glstate.h"
+#include "xxhash64.h"
 #include "../gpu/gfxcontextlink.h"
 #include "../common/logging.h"
 
@@ -35,6 +39,12 @@ namespace opengl {
 #define UNIFORM_BOUND_CHECK
 #endif
 
+// NOTE uniform updates are part of a recorded command stream, see CommandStream
+#define RECORD_UNIFORM(op, type, ...) { CommandStream * rec = GLState::recorder(); \
+    if (rec) { const type vals[] = {__VA_ARGS__}; rec->recordUniform(this, CommandStream::op, location, 1, vals, sizeof(vals) / sizeof(type)); } }
+#define RECORD_UNIFORM_ARRAY(op, count, data, words, transpose) { CommandStream * rec = GLState::recorder(); \
+    if (rec) rec->recordUniform(this, CommandStream::op, location, count, data, words, transpose); }
+
 /*##################################################################################################
 #                                   P U B L I C  F U N C T I O N S                                 #
 ##################################################################################################*/
@@ -47,11 +57,12 @@ namespace opengl {
  * Removes the program object from the GL resources.
  */
 ShaderProgram::~ShaderProgram() {
+    if (compiler_) compiler_->dequeue(this);
     shaders_.clear();
     if (handle_ != 0) {
         assertContext();
-        glUseProgram(0);
-        glDeleteProgram(handle_);
+        GLState::useProgram(0);
+        GLState::deleteProgram(handle_);
         handle_ = 0;
     }
     hasFragment_ = false;
@@ -94,7 +105,7 @@ void ShaderProgram::log() const {
             if (shader->getType() == GL_FRAGMENT_SHADER) shader->log();
         }
     }
-#if !defined(__APPLE__) && !defined(ANDROID) && !defined(FYUSENET_USE_WEBGL)
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
     if (hasCompute_) {
         FNLOGD("Compute Shader:");
         for (shaderptr shader : shaders_) {
@@ -122,7 +133,7 @@ void ShaderProgram::addShader(shaderptr shader) {
             case GL_VERTEX_SHADER:
                 hasVertex_ = true;
                 break;
-#if !defined(__APPLE__) && !defined(ANDROID) && !defined(FYUSENET_USE_WEBGL)
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
             case GL_COMPUTE_SHADER:
                 hasCompute_ = true;
                 break;
@@ -152,6 +163,7 @@ void ShaderProgram::addShader(shaderptr shader) {
  * @see UniformState::applyState()
  */
 void ShaderProgram::bind(UniformState *state) {
+    if (pending_) finishLink();
 #ifdef DEBUG
     assert(handle_ != 0);
     if (bound_) {
@@ -159,7 +171,7 @@ void ShaderProgram::bind(UniformState *state) {
     }
     glGetError();                   // clear error state
 #endif    
-    glUseProgram(handle_);
+    GLState::useProgram(handle_);
 #ifdef DEBUG
     int userr = glGetError();
 #endif
@@ -189,7 +201,7 @@ void ShaderProgram::unbind(bool compress) {
     }
 #endif
     bound_ = false;
-    if (!compress) glUseProgram(0);
+    if (!compress) GLState::useProgram(0);
 }
 
 
@@ -205,7 +217,8 @@ void ShaderProgram::unbind(bool compress) {
  *
  * @return On succes, this function returns the location ID of the uniform variable and it
  *         returns -1 if the location was not found (result is for informational purposes and error
- *         detection)
+ *         detection). It also returns -1 if the program is still pending linkage, in which case
+ *         the mapping is performed once the linkage has been completed
  *
  * This function performs a lookup of the supplied \p name in the program object. Upon positive
  * result, it will associated the provided \p symbol with that location. In cases where the value
@@ -219,11 +232,16 @@ void ShaderProgram::unbind(bool compress) {
  * @throws ShaderException if non-optional variable was not found or shader was not linked
  */
 GLint ShaderProgram::mapUniformLocation(const char *name, int symbol, bool optional) {
+    if (pending_) {
+        deferredMappings_.push_back({std::string(name), symbol, optional});
+        return -1;
+    }
     GLint loc = resolveLocation(name, true);
     if (loc == -1) {
         if (optional) return -1;
         THROW_EXCEPTION_ARGS(ShaderException,"Location %s cannot be mapped",name);
     }
+    if (symbol >= (int)symbolMap_.size()) symbolMap_.resize(symbol+1, -1);
     symbolMap_[symbol]=loc;
     return loc;
 }
@@ -247,12 +265,12 @@ GLint ShaderProgram::mapUniformLocation(const char *name, int symbol, bool optio
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformValue(int symbol, GLint value, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformValue(it->second,value);
+    setUniformValue(loc,value);
 }
 
 
@@ -274,12 +292,12 @@ void ShaderProgram::setMappedUniformValue(int symbol, GLint value, bool optional
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformValue(int symbol, GLfloat value, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformValue(it->second,value);
+    setUniformValue(loc,value);
 }
 
 
@@ -303,12 +321,12 @@ void ShaderProgram::setMappedUniformValue(int symbol, GLfloat value, bool option
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformVec2(int symbol, GLint v0, GLint v1, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformVec2(it->second,v0,v1);
+    setUniformVec2(loc,v0,v1);
 }
 
 
@@ -332,12 +350,12 @@ void ShaderProgram::setMappedUniformVec2(int symbol, GLint v0, GLint v1, bool op
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformVec2(int symbol, GLfloat v0, GLfloat v1, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformVec2(it->second,v0,v1);
+    setUniformVec2(loc,v0,v1);
 }
 
 
@@ -362,12 +380,12 @@ void ShaderProgram::setMappedUniformVec2(int symbol, GLfloat v0, GLfloat v1, boo
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformVec3(int symbol, GLint v0, GLint v1, GLint v2, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformVec3(it->second,v0,v1,v2);
+    setUniformVec3(loc,v0,v1,v2);
 }
 
 
@@ -392,12 +410,12 @@ void ShaderProgram::setMappedUniformVec3(int symbol, GLint v0, GLint v1, GLint v
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformVec3(int symbol, GLfloat v0, GLfloat v1, GLfloat v2, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformVec3(it->second,v0,v1,v2);
+    setUniformVec3(loc,v0,v1,v2);
 }
 
 
@@ -423,12 +441,12 @@ void ShaderProgram::setMappedUniformVec3(int symbol, GLfloat v0, GLfloat v1, GLf
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformVec4(int symbol, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformVec4(it->second,v0,v1,v2,v3);
+    setUniformVec4(loc,v0,v1,v2,v3);
 }
 
 
@@ -454,12 +472,12 @@ void ShaderProgram::setMappedUniformVec4(int symbol, GLfloat v0, GLfloat v1, GLf
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformVec4Array(int symbol, const GLfloat *data, int num4Entries, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformVec4Array(it->second,data,num4Entries);
+    setUniformVec4Array(loc,data,num4Entries);
 }
 
 
@@ -484,12 +502,12 @@ void ShaderProgram::setMappedUniformVec4Array(int symbol, const GLfloat *data, i
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformVec4Array(int symbol, const GLuint *data, int num4Entries, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformVec4Array(it->second,data,num4Entries);
+    setUniformVec4Array(loc,data,num4Entries);
 }
 
 
@@ -516,12 +534,12 @@ void ShaderProgram::setMappedUniformVec4Array(int symbol, const GLuint *data, in
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformMat4(int symbol, const GLfloat *matrix, bool transpose, bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformMat4(it->second,matrix,transpose);
+    setUniformMat4(loc,matrix,transpose);
 }
 
 
@@ -550,12 +568,12 @@ void ShaderProgram::setMappedUniformMat4(int symbol, const GLfloat *matrix, bool
  * @see mapUniformLocation()
  */
 void ShaderProgram::setMappedUniformMat4Array(int symbol, const GLfloat *matrices, int numMatrices, bool transpose,bool optional) {
-    auto it = symbolMap_.find(symbol);
-    if (it == symbolMap_.end()) {
+    GLint loc = mappedLocation(symbol);
+    if (loc == -1) {
         if (optional) return;
         THROW_EXCEPTION_ARGS(ShaderException,"Symbol %d is unknown symbol",symbol);
     }
-    setUniformMat4Array(it->second, matrices ,numMatrices, transpose);
+    setUniformMat4Array(loc, matrices ,numMatrices, transpose);
 }
 
 
@@ -593,9 +611,11 @@ void ShaderProgram::setUniformValue(const char *name, GLint value, bool optional
  * @throws ShaderException in case the shader was not linked
  */
 void ShaderProgram::setUniformValue(GLint location, GLint value) {
+    appliedState_ = 0;
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform1i(location,value);
+        RECORD_UNIFORM(UNIFORM_1I, GLint, value)
     }
 }
 
@@ -633,10 +653,12 @@ void ShaderProgram::setUniformValue(const char *name, GLfloat value, bool option
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformValue(GLint location, GLfloat value) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform1f(location,value);
+        RECORD_UNIFORM(UNIFORM_1F, GLfloat, value)
     }
 }
 
@@ -677,10 +699,12 @@ void ShaderProgram::setUniformVec2(const char *name, GLint v0, GLint v1, bool op
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformVec2(GLint location, GLint v0, GLint v1) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException, "Shader program not linked");
         glUniform2i(location, v0, v1);
+        RECORD_UNIFORM(UNIFORM_2I, GLint, v0, v1)
     }
 }
 
@@ -720,10 +744,12 @@ void ShaderProgram::setUniformVec2(const char *name, GLfloat v0, GLfloat v1, boo
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformVec2(GLint location, GLfloat v0, GLfloat v1) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform2f(location, v0, v1);
+        RECORD_UNIFORM(UNIFORM_2F, GLfloat, v0, v1)
     }
 }
 
@@ -765,10 +791,12 @@ void ShaderProgram::setUniformVec3(const char *name, GLint v0, GLint v1, GLint v
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformVec3(GLint location, GLint v0, GLint v1, GLint v2) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform3i(location, v0, v1, v2);
+        RECORD_UNIFORM(UNIFORM_3I, GLint, v0, v1, v2)
     }
 }
 
@@ -811,10 +839,12 @@ void ShaderProgram::setUniformVec3(const char *name, GLfloat v0, GLfloat v1, GLf
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformVec3(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform3f(location, v0, v1, v2);
+        RECORD_UNIFORM(UNIFORM_3F, GLfloat, v0, v1, v2)
     }
 }
 
@@ -859,10 +889,12 @@ void ShaderProgram::setUniformVec4(const char *name, GLint v0, GLint v1, GLint v
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformVec4(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform4i(location, v0, v1, v2, v3);
+        RECORD_UNIFORM(UNIFORM_4I, GLint, v0, v1, v2, v3)
     }
 }
 
@@ -907,10 +939,12 @@ void ShaderProgram::setUniformVec4(const char *name, GLfloat v0, GLfloat v1, GLf
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformVec4(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform4f(location,v0,v1,v2,v3);
+        RECORD_UNIFORM(UNIFORM_4F, GLfloat, v0, v1, v2, v3)
     }
 }
 
@@ -957,9 +991,13 @@ void ShaderProgram::setUniformMat3(const char *name,const GLfloat *matrix, bool
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformMat3(GLint location, const GLfloat *matrix, bool transpose) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (!matrix) THROW_EXCEPTION_ARGS(ShaderException,"Illegal matrix pointer %p supplied",matrix);
-    if (location != -1) glUniformMatrix3fv(location, 1, transpose, matrix);
+    if (location != -1) {
+        glUniformMatrix3fv(location, 1, transpose, matrix);
+        RECORD_UNIFORM_ARRAY(UNIFORM_MAT3, 1, matrix, 9, transpose)
+    }
 }
 
 
@@ -1005,9 +1043,13 @@ void ShaderProgram::setUniformMat4(const char *name, const GLfloat *matrix, bool
  * @throws ShaderException in case the shader was not linked.
  */
 void ShaderProgram::setUniformMat4(GLint location, const GLfloat *matrix, bool transpose) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (!matrix) THROW_EXCEPTION_ARGS(ShaderException,"Illegal matrix pointer %p supplied", matrix);
-    if (location != -1) glUniformMatrix4fv(location, 1, transpose, matrix);
+    if (location != -1) {
+        glUniformMatrix4fv(location, 1, transpose, matrix);
+        RECORD_UNIFORM_ARRAY(UNIFORM_MAT4, 1, matrix, 16, transpose)
+    }
 }
 
 
@@ -1058,11 +1100,13 @@ void ShaderProgram::setUniformMat4Array(const char * name, const GLfloat *matric
  *         flag was set to \c false, or the shader was not linked.
  */
 void ShaderProgram::setUniformMat4Array(GLint location, const GLfloat *matrices, int numMatrices, bool transpose) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (!matrices) THROW_EXCEPTION_ARGS(ShaderException,"Illegal matrix pointer %p supplied", matrices);
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniformMatrix4fv(location, numMatrices, transpose, matrices);
+        RECORD_UNIFORM_ARRAY(UNIFORM_MAT4, numMatrices, matrices, 16 * numMatrices, transpose)
     }
 }
 
@@ -1106,9 +1150,13 @@ void ShaderProgram::setUniformVec4Array(const char *name, const GLfloat *data, i
  *         flag was set to \c false , or the shader was not linked.
  */
 void ShaderProgram::setUniformVec4Array(GLint location, const GLfloat *data, int num4Entries) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (!data) THROW_EXCEPTION_ARGS(ShaderException,"Illegal data pointer %p supplied",data);
-    if (location != -1) glUniform4fv(location, num4Entries, data);
+    if (location != -1) {
+        glUniform4fv(location, num4Entries, data);
+        RECORD_UNIFORM_ARRAY(UNIFORM_4F, num4Entries, data, 4 * num4Entries, false)
+    }
 }
 
 
@@ -1151,11 +1199,13 @@ void ShaderProgram::setUniformVec4Array(const char *name, const GLuint *data, in
  *         flag was set to \c false , or the shader was not linked.
  */
 void ShaderProgram::setUniformVec4Array(GLint location, const GLuint *data, int num4Entries) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (!data) THROW_EXCEPTION_ARGS(ShaderException,"Illegal data pointer %p supplied",data);
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform4uiv(location, num4Entries, data);
+        RECORD_UNIFORM_ARRAY(UNIFORM_4UI, num4Entries, data, 4 * num4Entries, false)
     }
 }
 
@@ -1199,10 +1249,12 @@ void ShaderProgram::setUniformVec3Array(const char *name, const GLfloat *data, i
  *         flag was set to \c false , or the shader was not linked.
  */
 void ShaderProgram::setUniformVec3Array(GLint location, const GLfloat *data, int num3Entries) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform3fv(location, num3Entries, data);
+        RECORD_UNIFORM_ARRAY(UNIFORM_3F, num3Entries, data, 3 * num3Entries, false)
     }
 }
 
@@ -1246,10 +1298,12 @@ void ShaderProgram::setUniformVec2Array(const char *name, const GLint *data, int
  *         flag was set to \c false , or the shader was not linked.
  */
 void ShaderProgram::setUniformVec2Array(GLint location, const GLint *data, int num2Entries) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform2iv(location, num2Entries, data);
+        RECORD_UNIFORM_ARRAY(UNIFORM_2I, num2Entries, data, 2 * num2Entries, false)
     }
 }
 
@@ -1292,10 +1346,12 @@ void ShaderProgram::setUniformVec2Array(const char *name, const GLfloat *data, i
  *         flag was set to \c false , or the shader was not linked.
  */
 void ShaderProgram::setUniformVec2Array(GLint location, const GLfloat *data, int num2Entries) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform2fv(location, num2Entries, data);
+        RECORD_UNIFORM_ARRAY(UNIFORM_2F, num2Entries, data, 2 * num2Entries, false)
     }
 }
 
@@ -1336,10 +1392,12 @@ void ShaderProgram::setUniformArray(const char *name, const GLfloat *data, int n
  *         flag was set to \c false , or the shader was not linked.
  */
 void ShaderProgram::setUniformArray(GLint location, const GLfloat *data, int numEntries) {
+    appliedState_ = 0;
     UNIFORM_BOUND_CHECK
     if (location != -1) {
         if (!isLinked()) THROW_EXCEPTION_ARGS(ShaderException,"Shader program not linked");
         glUniform1fv(location, numEntries, data);
+        RECORD_UNIFORM_ARRAY(UNIFORM_1F, numEntries, data, numEntries, false)
     }
 }
 
@@ -1358,6 +1416,7 @@ void ShaderProgram::bindAttributeLocation(const char *name, GLuint index) {
     ensureExistence();
     if (!isLinked()) {
         glBindAttribLocation(handle_,index,name);
+        attributes_.emplace_back(name, index);
     }
 }
 
@@ -1377,6 +1436,7 @@ void ShaderProgram::bindAttributeLocation(const char *name, GLuint index) {
  *         (in case of debug builds) a general GL error occured.
  */
 void ShaderProgram::bindIndexToShaderBuffer(const char *name, int bindingIndex) {
+    if (pending_) finishLink();
     GLuint block = glGetUniformBlockIndex(handle_, name);
     if (block == GL_INVALID_INDEX) THROW_EXCEPTION_ARGS(ShaderException,"Cannot obtain block index for \"%s\"",name);
 #ifdef DEBUG
@@ -1391,16 +1451,20 @@ void ShaderProgram::bindIndexToShaderBuffer(const char *name, int bindingIndex)
 
 
 /**
- * @brief ShaderProgram::compile
+ * @brief Compile shaders and create program object
+ *
+ * Compiles all shaders which have not been compiled yet and creates the GL program object.
  *
+ * When the ProgramBinaryCache is enabled or the ShaderCompiler is in its submission phase, the
+ * compilation of the shaders is deferred to link(). In the former case it can be skipped entirely
+ * if a binary for the program is available in the cache, in the latter case it is performed in
+ * parallel to other shaders.
  *
  * @throws ShaderException in case the compilation went wrong or there was no program object
  */
 void ShaderProgram::compile() {
     if (!isLinkable()) THROW_EXCEPTION_ARGS(ShaderException,"Not enough shader types for linking");
-    for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
-        if (!(*ii)->isCompiled()) (*ii)->compile();
-    }
+    if ((!ProgramBinaryCache::getInstance()) && (!ShaderCompiler::getInstance(context_)->isDeferring())) compileShaders();
     ensureExistence();
     if (handle_ == 0) THROW_EXCEPTION_ARGS(ShaderException,"Cannot create shader program");
 }
@@ -1410,35 +1474,62 @@ void ShaderProgram::compile() {
  * @brief Link shader program
  *
  * This function first checks if the program is already linked and does nothing in that case.
- * Otherwise it
+ * Otherwise it tries to load the program from the ProgramBinaryCache (if enabled) and falls back
+ * to compiling and linking the shaders. Freshly linked programs are stored in the binary cache.
+ *
+ * If the ShaderCompiler of the context is in its submission phase, the program is only enqueued
+ * and the link status is checked later, either by ShaderCompiler::finish() or when the program is
+ * used for the first time (see finishLink()). In that case, the program already reports itself as
+ * linked.
  *
  * @throws ShaderException in case compilation/linking goes wrong
  */
 void ShaderProgram::link() {
     if (isLinked()) return;
     assertContext();
-    compile();
-    glGetError();
-    for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
-        glAttachShader(handle_, (*ii)->getHandle());
-        GLint err = glGetError();
-        if (err != GL_NO_ERROR) THROW_EXCEPTION_ARGS(ShaderException,"Unable to attach shader with handle %d, glerr=0x%x",(*ii)->getHandle(),err);
-    }
-    GLint status=GL_FALSE;
-    glLinkProgram(handle_);
-    glGetProgramiv(handle_,GL_LINK_STATUS,&status);
-    if (status == GL_FALSE) {
-#ifdef DEBUG
-        FNLOGE("Shader linker error");
-        logError();
-        FNLOGE("Logging shaders...");
-        for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
-            (*ii)->log();
+    if (!isLinkable()) THROW_EXCEPTION_ARGS(ShaderException,"Not enough shader types for linking");
+    ensureExistence();
+    ProgramBinaryCache * bincache = ProgramBinaryCache::getInstance();
+    if (bincache) {
+        binaryKey_ = binaryKey(bincache->seed());
+        if (bincache->load(binaryKey_, handle_)) {
+            linked_ = true;
+            return;
         }
-#endif
-        THROW_EXCEPTION_ARGS(ShaderException,"Unable to link shaders to program, status is 0x%x (expected 0x%X)",status,GL_TRUE);
     }
-    linked_ = true;
+    ShaderCompiler * compiler = ShaderCompiler::getInstance(context_);
+    if (compiler->isDeferring()) {
+        if (compiler->getStrategy() == ShaderCompiler::DRIVER) submitLink();
+        pending_ = true;
+        linked_ = true;
+        compiler_ = compiler;
+        compiler->enqueue(this);
+        return;
+    }
+    compileShaders();
+    submitLink();
+    verifyLink();
+}
+
+
+/**
+ * @brief Complete a deferred linkage
+ *
+ * Does nothing if the program is not pending. Otherwise it compiles and links the program (if
+ * that was not done already) and checks the link status, which blocks until the driver has
+ * finished linking. This is invoked automatically when a pending program is used.
+ *
+ * @throws ShaderException in case compilation/linking goes wrong
+ *
+ * @see ShaderCompiler
+ */
+void ShaderProgram::finishLink() {
+    if (!pending_) return;
+    if (!submitted_) {
+        compileShaders();
+        submitLink();
+    }
+    verifyLink();
 }
 
 
@@ -1450,12 +1541,23 @@ void ShaderProgram::link() {
  *
  * @return ID (GLSL location) of variable with provided \p varName
  *
+ * Locations are cached once the program is linked, such that repeated lookups of the same name
+ * do not issue any GL calls. For frequently updated uniforms, prefer mapUniformLocation() with
+ * integer symbols, which also avoids the string lookup.
+ *
  * @throws ShaderException in case \p silent was set to \c false and the uniform variable was not
  *         found in the shader program.
  */
-GLint ShaderProgram::resolveLocation(const char *varName, bool silent) const {
+GLint ShaderProgram::resolveLocation(const char *varName, bool silent) {
     assert(handle_);
-    GLint loc = glGetUniformLocation(handle_, varName);
+    if (pending_) finishLink();
+    GLint loc = -1;
+    auto it = locations_.find(varName);
+    if (it != locations_.end()) loc = it->second;
+    else {
+        loc = glGetUniformLocation(handle_, varName);
+        if (linked_) locations_[varName] = loc;
+    }
     if ((loc < 0) && (!silent)) {
         THROW_EXCEPTION_ARGS(ShaderException,"Cannot resolve location \"%s\" in shader %d", varName, handle_);
     }
@@ -1502,6 +1604,119 @@ std::vector<GLuint> ShaderProgram::getShaderHandles() const {
 }
 
 
+/**
+ * @brief Compile all shaders of this program that have not been compiled yet
+ *
+ * @throws ShaderException in case the compilation went wrong
+ */
+void ShaderProgram::compileShaders() {
+    for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
+        if (!(*ii)->isCompiled()) (*ii)->compile();
+    }
+}
+
+
+/**
+ * @brief Attach shaders to the program and issue the linkage
+ *
+ * This function does not check the link status, see verifyLink() for that. Shaders that have not
+ * been compiled yet are submitted for compilation without checking their status either. The
+ * attribute bindings are re-applied, as the linkage may be issued under a different (shared)
+ * context than the bindings.
+ *
+ * @throws ShaderException in case a shader could not be attached
+ */
+void ShaderProgram::submitLink() {
+    for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
+        if (!(*ii)->isCompiled()) (*ii)->submit();
+    }
+    for (auto & attr : attributes_) glBindAttribLocation(handle_, attr.second, attr.first.c_str());
+    glGetError();
+    for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
+        glAttachShader(handle_, (*ii)->getHandle());
+        GLint err = glGetError();
+        if (err != GL_NO_ERROR) THROW_EXCEPTION_ARGS(ShaderException,"Unable to attach shader with handle %d, glerr=0x%x",(*ii)->getHandle(),err);
+    }
+#ifndef FYUSENET_USE_WEBGL
+    if (ProgramBinaryCache::getInstance()) glProgramParameteri(handle_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#endif
+    glLinkProgram(handle_);
+    submitted_ = true;
+}
+
+
+/**
+ * @brief Check link status of a program for which the linkage has been issued
+ *
+ * Besides checking the link status, this function verifies the compile status of all shaders
+ * that were submitted without checking, stores the program in the ProgramBinaryCache (if
+ * enabled) and resolves uniform mappings that were deferred by mapUniformLocation().
+ *
+ * @throws ShaderException in case compilation/linking went wrong
+ */
+void ShaderProgram::verifyLink() {
+    pending_ = false;
+    submitted_ = false;
+    if (compiler_) {
+        compiler_->dequeue(this);
+        compiler_ = nullptr;
+    }
+    GLint status=GL_FALSE;
+    glGetProgramiv(handle_,GL_LINK_STATUS,&status);
+    if (status == GL_FALSE) {
+        linked_ = false;
+        // NOTE compilation errors on submitted shaders are reported (and thrown) here
+        for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
+            if ((*ii)->isPending()) (*ii)->compile();
+        }
+#ifdef DEBUG
+        FNLOGE("Shader linker error");
+        logError();
+        FNLOGE("Logging shaders...");
+        for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
+            (*ii)->log();
+        }
+#endif
+        THROW_EXCEPTION_ARGS(ShaderException,"Unable to link shaders to program, status is 0x%x (expected 0x%X)",status,GL_TRUE);
+    }
+    for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
+        if ((*ii)->isPending()) (*ii)->compile();
+    }
+    linked_ = true;
+    ProgramBinaryCache * bincache = ProgramBinaryCache::getInstance();
+    if (bincache) bincache->store(binaryKey_, handle_);
+    std::vector<mapping> deferred;
+    deferred.swap(deferredMappings_);
+    for (const mapping & map : deferred) mapUniformLocation(map.name.c_str(), map.symbol, map.optional);
+}
+
+
+/**
+ * @brief Compute key for the ProgramBinaryCache
+ *
+ * @param seed Seed value for the hash computation, as supplied by the binary cache
+ *
+ * @return 64-bit key which identifies this program in the binary cache
+ *
+ * The key is computed over the type and the full code (including preamble and preprocessor
+ * definitions) of all shaders as well as the attribute bindings of this program.
+ */
+uint64_t ShaderProgram::binaryKey(uint64_t seed) const {
+    XXHash64 hasher(seed);
+    for (auto ii=shaders_.begin(); ii!=shaders_.end(); ++ii) {
+        GLenum type = (*ii)->getType();
+        std::string code = (*ii)->getCode();
+        hasher.add(&type, sizeof(type));
+        hasher.add(code.c_str(), code.size());
+    }
+    for (auto & attr : attributes_) {
+        hasher.add(attr.first.c_str(), attr.first.size() + 1);
+        hasher.add(&attr.second, sizeof(attr.second));
+    }
+    return hasher.hash();
+}
+
+
 /**
  * @brief Make sure that a program handle exist (create one if not)
  */
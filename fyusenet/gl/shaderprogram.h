@@ -13,6 +13,8 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <string>
+#include <utility>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -27,6 +29,7 @@ namespace opengl {
 
 class UniformState;
 class ShaderProgram;
+class ShaderCompiler;
 
 typedef std::shared_ptr<ShaderProgram> programptr;
 
@@ -67,6 +70,9 @@ typedef std::shared_ptr<ShaderProgram> programptr;
  */
 class ShaderProgram : public fyusenet::GfxContextTracker {
   friend class ShaderCache;
+  friend class ShaderCompiler;
+  friend class UniformState;
+  friend class CommandStream;
  public:
     // ------------------------------------------------------------------------
     // Constructor / Destructor
@@ -130,7 +136,8 @@ class ShaderProgram : public fyusenet::GfxContextTracker {
     void setUniformMat4Array(GLint location, const GLfloat *matrices, int numMatrices, bool transpose=false);
     void bindAttributeLocation(const char *name, GLuint index);
     void bindIndexToShaderBuffer(const char *bufferName, int bindingIndex);
-    GLint resolveLocation(const char *location, bool silent=false) const;
+    GLint resolveLocation(const char *location, bool silent=false);
+    void finishLink();
     static programptr createInstance(const fyusenet::GfxContextLink& link = fyusenet::GfxContextLink());
 
     /**
@@ -174,6 +181,18 @@ class ShaderProgram : public fyusenet::GfxContextTracker {
       return linked_;
     }
 
+    /**
+     * @brief Check if the linkage of this program was deferred and has not been completed yet
+     *
+     * @retval true if the program is enqueued in the ShaderCompiler
+     * @retval false otherwise
+     *
+     * @see ShaderCompiler, finishLink()
+     */
+    bool isLinkPending() const {
+      return pending_;
+    }
+
     /**
      * @brief Retrieve GL handle for this shader program
      *
@@ -190,6 +209,22 @@ class ShaderProgram : public fyusenet::GfxContextTracker {
     ShaderProgram(const fyusenet::GfxContextLink & context);
     void logError() const;
     void ensureExistence();
+    void compileShaders();
+
+    /**
+     * @brief Look up location for a mapped symbol
+     *
+     * @param symbol Symbol to look up
+     *
+     * @return Location that was mapped to the \p symbol or -1 if the symbol was not mapped
+     */
+    GLint mappedLocation(int symbol) const {
+        return ((symbol >= 0) && (symbol < (int)symbolMap_.size())) ? symbolMap_[symbol] : -1;
+    }
+
+    void submitLink();
+    void verifyLink();
+    uint64_t binaryKey(uint64_t seed) const;
     std::vector<GLuint> getShaderHandles() const;
 
     // ------------------------------------------------------------------------
@@ -203,8 +238,25 @@ class ShaderProgram : public fyusenet::GfxContextTracker {
     bool linked_;                                   //!< Indicator if the program has been successfully linked
     unsigned int userFlags_;                        //!< Storage for user-defined flags
     std::vector<shaderptr> shaders_;                //!< Shaders which are backing the shader program
-    std::unordered_map<int, GLint> symbolMap_;      //!< Mapping for symbol lookup
+    std::vector<GLint> symbolMap_;                  //!< Mapping for symbol lookup (indexed by symbol, -1 for unmapped symbols)
+    std::unordered_map<std::string, GLint> locations_;  //!< Cache for uniform locations resolved by name
+    uint64_t appliedState_ = 0;                     //!< Key of the UniformState that was applied last (0 if none or overwritten)
+    std::vector<std::pair<std::string, GLuint>> attributes_;  //!< Attribute bindings that are applied on linkage
     mutable uint64_t hash_;                         //!< Hash code
+    uint64_t binaryKey_ = 0;                        //!< Key for the ProgramBinaryCache (if enabled)
+    bool pending_ = false;                          //!< Indicator that the linkage was deferred and not completed yet
+    bool submitted_ = false;                        //!< Indicator that the linkage was issued to GL but not verified yet
+    ShaderCompiler * compiler_ = nullptr;           //!< Compiler instance that this program is enqueued in (if pending)
+
+    /**
+     * @brief Uniform mapping that was deferred until linkage is complete
+     */
+    struct mapping {
+        std::string name;                           //!< Name of the uniform variable
+        int symbol;                                 //!< Symbol to map the variable to
+        bool optional;                              //!< Indicator if variable is optional
+    };
+    std::vector<mapping> deferredMappings_;         //!< Uniform mappings waiting for linkage to complete
 };
 
 
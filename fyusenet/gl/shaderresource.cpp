@@ -9,6 +9,7 @@
 
 //--------------------------------------- System Headers -------------------------------------------
 
+#include <cstring>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -45,19 +46,54 @@ ShaderResource::ShaderResource(const char *shader, const char *resourceName) {
 }
 
 
+/**
+ * @brief Constructor for compressed shader sources
+ *
+ * @param packed Pointer to compressed shader source-code
+ * @param packedSize Size of the compressed data (bytes)
+ * @param size Size of the uncompressed shader source (bytes, without null-terminator)
+ * @param resourceName Name within the resource system to represent the shader source by
+ *
+ * Registers a compressed shader source with the ShaderRepository singleton. The source is only
+ * decompressed when it is requested for the first time. As with the uncompressed variant, the
+ * object does not take ownership over the supplied data.
+ */
+ShaderResource::ShaderResource(const unsigned char *packed, size_t packedSize, size_t size, const char *resourceName) {
+    ShaderRepository & repo = ShaderRepository::repository();
+    repo.addResource(packed, packedSize, size, resourceName);
+}
+
+
 /**
  * @brief Retrieve shader source by its resource name
  *
  * @param resourceName Name of resource (in virtual filesystem) to retrieve
  *
  * @return Pointer to shaer source, or \c nullptr if no such shader exists
+ *
+ * Compressed shader sources are decompressed on the first call and the decompressed source is
+ * kept for the lifetime of the repository.
  */
 const char * ShaderRepository::getShader(const char *resourceName) {
     if (!resourceName) return nullptr;
     ShaderRepository & repo = repository();
-    auto const & it = repo.shaderMap_.find(std::string(resourceName));
+    auto it = repo.shaderMap_.find(std::string(resourceName));
     if (it == repo.shaderMap_.end()) return nullptr;
-    else return it->second;
+    Entry & entry = it->second;
+    if (entry.code) return entry.code;
+#ifdef FYUSENET_MULTITHREADING
+    std::lock_guard<std::mutex> lck(repo.lock_);
+#endif
+    if (!entry.unpacked) {
+        std::unique_ptr<char[]> code(new char[entry.size + 1]);
+        if (!unpack(entry.packed, entry.packedSize, code.get(), entry.size)) {
+            FNLOGE("Cannot decompress shader %s", resourceName);
+            return nullptr;
+        }
+        code[entry.size] = 0;
+        entry.unpacked = std::move(code);
+    }
+    return entry.unpacked.get();
 }
 
 
@@ -92,7 +128,85 @@ ShaderRepository & ShaderRepository::repository() {
  */
 void ShaderRepository::addResource(const char *shader,const char *resourceName) {
     std::string key(resourceName);
-    shaderMap_[key]=shader;
+    Entry & entry = shaderMap_[key];
+    entry.code = shader;
+    entry.packed = nullptr;
+    entry.unpacked.reset();
+}
+
+
+/**
+ * @brief Add compressed shader source to resource system
+ *
+ * @param packed Compressed shader source
+ * @param packedSize Size of the compressed data (bytes)
+ * @param size Size of the uncompressed shader source (bytes, without null-terminator)
+ * @param resourceName Name of the shader in the resource system
+ */
+void ShaderRepository::addResource(const uint8_t *packed, size_t packedSize, size_t size, const char *resourceName) {
+    std::string key(resourceName);
+    Entry & entry = shaderMap_[key];
+    entry.code = nullptr;
+    entry.packed = packed;
+    entry.packedSize = packedSize;
+    entry.size = size;
+    entry.unpacked.reset();
+}
+
+
+/**
+ * @brief Decompress shader source
+ *
+ * @param packed Compressed data
+ * @param packedSize Size of the compressed data (bytes)
+ * @param[out] target Target buffer that receives the decompressed data
+ * @param size Size of the decompressed data (bytes), \p target must be able to hold that
+ *
+ * @retval true if data was decompressed successfully
+ * @retval false if the compressed data is malformed or does not match the supplied \p size
+ *
+ * The compressed data follows the LZ4 block format: a sequence of tokens, where each token
+ * stores the number of literal bytes in its upper nibble and the match length (minus 4) in
+ * its lower nibble. A nibble value of 15 indicates that the length is continued in subsequent
+ * bytes. Literal bytes follow the token, followed by a 16-bit little-endian offset for the
+ * match. The last sequence only consists of literals.
+ */
+bool ShaderRepository::unpack(const uint8_t *packed, size_t packedSize, char *target, size_t size) {
+    const uint8_t * src = packed;
+    const uint8_t * end = packed + packedSize;
+    size_t out = 0;
+    while (src < end) {
+        uint8_t token = *src++;
+        size_t literals = token >> 4;
+        if (literals == 15) {
+            uint8_t ext = 255;
+            while ((ext == 255) && (src < end)) {
+                ext = *src++;
+                literals += ext;
+            }
+        }
+        if (((size_t)(end - src) < literals) || (out + literals > size)) return false;
+        memcpy(target + out, src, literals);
+        src += literals;
+        out += literals;
+        if (src >= end) break;
+        if (end - src < 2) return false;
+        size_t offset = (size_t)src[0] | ((size_t)src[1] << 8);
+        src += 2;
+        size_t match = token & 15;
+        if (match == 15) {
+            uint8_t ext = 255;
+            while ((ext == 255) && (src < end)) {
+                ext = *src++;
+                match += ext;
+            }
+        }
+        match += 4;
+        if ((offset == 0) || (offset > out) || (out + match > size)) return false;
+        // NOTE matches may overlap with the output, so copy bytewise
+        for (size_t i=0; i < match; i++, out++) target[out] = target[out - offset];
+    }
+    return (out == size);
 }
 
 } // opengl namespace
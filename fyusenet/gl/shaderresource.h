@@ -12,6 +12,11 @@
 
 #include <unordered_map>
 #include <string>
+#include <memory>
+#include <cstdint>
+#ifdef FYUSENET_MULTITHREADING
+#include <mutex>
+#endif
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -29,6 +34,9 @@ namespace opengl {
  * Sbader sources themselves are wrapped by ShaderResource objects internally. The interface
  * to the shaders in the repository always exports them as null-terminated strings however.
  *
+ * Shader sources may be stored in compressed form (see the \c --compress option of \c shaderpp),
+ * in which case they are decompressed on first access and kept in memory afterwards.
+ *
  * @see ShaderResource
  */
 class ShaderRepository {
@@ -46,11 +54,27 @@ class ShaderRepository {
     ShaderRepository();
     static ShaderRepository & repository();
     void addResource(const char *shader,const char *resourceName);
+    void addResource(const uint8_t *packed, size_t packedSize, size_t size, const char *resourceName);
+    static bool unpack(const uint8_t *packed, size_t packedSize, char *target, size_t size);
+
+    /**
+     * @brief Shader source entry in the repository
+     */
+    struct Entry {
+        const char * code = nullptr;            //!< Pointer to (uncompressed) shader source
+        const uint8_t * packed = nullptr;       //!< Pointer to compressed shader source (if compressed)
+        size_t packedSize = 0;                  //!< Size of the compressed shader source (bytes)
+        size_t size = 0;                        //!< Size of the uncompressed shader source (bytes, without terminator)
+        std::unique_ptr<char[]> unpacked;       //!< Decompressed shader source, created on first access
+    };
 
     // ------------------------------------------------------------------------
     // Member variables
     // ------------------------------------------------------------------------
-    std::unordered_map<std::string, const char *> shaderMap_;
+    std::unordered_map<std::string, Entry> shaderMap_;
+#ifdef FYUSENET_MULTITHREADING
+    std::mutex lock_;                           //!< Serializes decompression of shader sources
+#endif
 };
 
 
@@ -67,6 +91,7 @@ class ShaderResource {
     // Constructor / Destructor
     // ------------------------------------------------------------------------
     ShaderResource(const char *shader,const char *resourceName);
+    ShaderResource(const unsigned char *packed, size_t packedSize, size_t size, const char *resourceName);
 };
 
 
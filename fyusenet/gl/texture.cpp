@@ -187,7 +187,7 @@ Texture2D::Texture2D(int width, int height, pixtype type, int channels, bool cle
     assert(channels > 0);
     createHandle();
     assert(*(handle_.get()) != 0);
-    glBindTexture(GL_TEXTURE_2D, *(handle_.get()));
+    GLState::bindTexture(GL_TEXTURE_2D, *(handle_.get()));
     updateParams();
     if (clear) this->clear();
 #ifdef DEBUG
@@ -227,12 +227,12 @@ Texture2D::Texture2D(int width, int height, pixtype type, int channels, BasicTex
         handle_ = pool->obtainTexture(width, height, channels, type, lock);
         fromPool_ = pool;
         assert(*(handle_.get()) != 0);
-        glBindTexture(GL_TEXTURE_2D, *(handle_.get()));
+        GLState::bindTexture(GL_TEXTURE_2D, *(handle_.get()));
         updateParams();
     } else {
         createHandle();
         assert(*(handle_.get()) != 0);
-        glBindTexture(GL_TEXTURE_2D, *(handle_.get()));
+        GLState::bindTexture(GL_TEXTURE_2D, *(handle_.get()));
         updateParams();
         clear();
 #ifdef DEBUG
@@ -348,8 +348,8 @@ void Texture2D::interpolation(intp minIntp, intp magIntp) {
  */
 void Texture2D::unbind(int unit) const {
     assert(unit >= 0);
-    if (unit >= 0) glActiveTexture(GL_TEXTURE0+unit);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    if (unit >= 0) GLState::activeTexture(GL_TEXTURE0+unit);
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
 }
 
 
@@ -362,8 +362,8 @@ void Texture2D::unbind(int unit) const {
  */
 void Texture2D::bind(int unit) const {
     assert(unit >= 0);
-    if (unit >= 0) glActiveTexture(GL_TEXTURE0+unit);
-    glBindTexture(GL_TEXTURE_2D, *(handle_.get()));
+    if (unit >= 0) GLState::activeTexture(GL_TEXTURE0+unit);
+    GLState::bindTexture(GL_TEXTURE_2D, *(handle_.get()));
     if ((paramPending_) || (fromPool_)) {
         updateParams();
         paramPending_ = false;
@@ -471,7 +471,7 @@ void Texture2D::download(T *target) {
 #if !defined(FYUSENET_USE_EGL) && !defined(FYUSENET_USE_WEBGL)
     GLenum tt = (dataType_ == UINT8) ? GL_UNSIGNED_BYTE : GL_FLOAT;
     GLenum fmt = texfmt_[channels_-1];
-    glBindTexture(GL_TEXTURE_2D, *(handle_.get()));
+    GLState::bindTexture(GL_TEXTURE_2D, *(handle_.get()));
     glGetTexImage(GL_TEXTURE_2D, 0, fmt, tt, target);
 #else
     FBO tmp(fyusenet::GfxContextLink(), width_, height_);
@@ -509,7 +509,7 @@ Texture3D::Texture3D(int width, int height, int depth, pixtype type, int channel
     width_(width), height_(height), depth_(depth) {
     createHandle();
     assert(*(handle_.get()) != 0);
-    glBindTexture(GL_TEXTURE_3D, *(handle_.get()));
+    GLState::bindTexture(GL_TEXTURE_3D, *(handle_.get()));
     updateParams();
     if (clear) this->clear();
 }
@@ -613,8 +613,8 @@ uint32_t Texture3D::size() const {
  * @copydoc Texture2D::unbind
  */
 void Texture3D::unbind(int unit) const {
-    if (unit >= 0) glActiveTexture(GL_TEXTURE0+unit);
-    glBindTexture(GL_TEXTURE_3D, 0);
+    if (unit >= 0) GLState::activeTexture(GL_TEXTURE0+unit);
+    GLState::bindTexture(GL_TEXTURE_3D, 0);
 }
 
 
@@ -622,8 +622,8 @@ void Texture3D::unbind(int unit) const {
  * @copydoc Texture2D::bind
  */
 void Texture3D::bind(int unit) const {
-    if (unit >= 0) glActiveTexture(GL_TEXTURE0+unit);
-    glBindTexture(GL_TEXTURE_3D, *(handle_.get()));
+    if (unit >= 0) GLState::activeTexture(GL_TEXTURE0+unit);
+    GLState::bindTexture(GL_TEXTURE_3D, *(handle_.get()));
     if (paramPending_) {
         updateParams();
         paramPending_ = false;
@@ -737,7 +737,7 @@ Texture2DRef::Texture2DRef(GLuint handle, int width, int height, pixtype type,
     dataType_ = type;
     target_ = target;
     handleOwned_ = false;
-    glBindTexture(GL_TEXTURE_2D, *(handle_.get()));
+    GLState::bindTexture(GL_TEXTURE_2D, *(handle_.get()));
     updateParams();
     // NOTE (mw) do not increase alloc count here, since this texture is not ours to track
 }
@@ -20,6 +20,7 @@
 //-------------------------------------- Project  Headers ------------------------------------------
 
 #include "gl_sys.h"
+#include "glstate.h"
 
 //------------------------------------------ Constants ---------------------------------------------
 
@@ -312,7 +313,7 @@ class Texture {
      * memory occupied by the handle.
      */
     static void deleteOwnedHandle(GLuint * handlePtr) {
-        glDeleteTextures(1, handlePtr);
+        GLState::deleteTextures(1, handlePtr);
         delete [] handlePtr;
     }
 
@@ -14,6 +14,7 @@
 #include "gl_sys.h"
 #include "ubo.h"
 #include "glexception.h"
+#include "glstate.h"
 
 //-------------------------------------- Global Variables ------------------------------------------
 
@@ -62,8 +63,8 @@ void UBO::bindTo(int bindingIndex) {
 #ifdef DEBUG
     glGetError();
 #endif
-    bind();
-    glBindBufferBase(target_, bindingIndex, handle_);
+    // NOTE this also binds the buffer to the generic binding point, no need for bind()
+    GLState::bindBufferBase(target_, bindingIndex, handle_);
 #ifdef DEBUG
     int err = glGetError();
     if (err != GL_NO_ERROR) THROW_EXCEPTION_ARGS(GLException,"Error binding buffer (glerr=0x%x)",err);
@@ -83,8 +84,8 @@ void UBO::bindRangeTo(int bindingIndex, int offset, int size) {
 #ifdef DEBUG
     glGetError();
 #endif
-    bind();
-    glBindBufferRange(target_, bindingIndex, handle_, offset, size);
+    // NOTE this also binds the buffer to the generic binding point, no need for bind()
+    GLState::bindBufferRange(target_, bindingIndex, handle_, offset, size);
 #ifdef DEBUG
     int err = glGetError();
     if (err != GL_NO_ERROR) THROW_EXCEPTION_ARGS(GLException,"Error binding buffer (glerr=0x%x)",err);
@@ -17,11 +17,14 @@
 #include "shaderprogram.h"
 #include "uniformstate.h"
 #include "shaderexception.h"
+#include "glstate.h"
 
 //-------------------------------------- Global Variables ------------------------------------------
 namespace fyusion {
 namespace opengl {
 
+std::atomic<uint32_t> UniformState::nextID_{1};
+
 
 //-------------------------------------- Local Definitions -----------------------------------------
 
@@ -39,6 +42,7 @@ namespace opengl {
  * stored as a weak pointer in this object.
  */
 UniformState::UniformState(programptr target) : target_(target) {
+    id_ = nextID_.fetch_add(1);
 }
 
 
@@ -824,6 +828,12 @@ void UniformState::applyState(ShaderProgram *target) {
     auto ptr = target_.lock();
     if (!ptr) return;
     if ((target) && (ptr.get() != target)) THROW_EXCEPTION_ARGS(ShaderException,"Cannot apply state to shader it was not created for");
+    if (!unresolved_.empty()) resolveDeferred(ptr.get());
+    // NOTE entries are only ever appended, so the ID and the number of entries identify the state
+    uint64_t key = ((uint64_t)id_ << 32) | (uint64_t)entries_.size();
+    // NOTE a recorded command stream must contain all uniforms, it cannot rely on the skip
+    CommandStream * rec = GLState::recorder();
+    if ((ptr->appliedState_ == key) && (!rec)) return;
     for (const entry& ent : entries_) {
         switch (ent.type) {
             case SIGNED_INTEGER:
@@ -870,6 +880,8 @@ void UniformState::applyState(ShaderProgram *target) {
                 assert(false);
         }
     }
+    ptr->appliedState_ = key;
+    if (rec) rec->recordProgramState(ptr.get(), key);
 }
 
 /*##################################################################################################
@@ -892,10 +904,30 @@ void UniformState::applyState(ShaderProgram *target) {
 GLint UniformState::getLocation(const char *name, bool optional) {
     auto ptr = target_.lock();
     if (!ptr) THROW_EXCEPTION_ARGS(ShaderException, "No shader supplied or expired");
+    if (ptr->isLinkPending()) {
+        // NOTE the next entry that is added will be the one for this name
+        unresolved_.push_back({entries_.size(), std::string(name), optional});
+        return DEFERRED_LOCATION;
+    }
     return ptr->resolveLocation(name, optional);
 }
 
 
+/**
+ * @brief Resolve locations of entries that were added while the target program was pending
+ *
+ * @param target Target shader program, which must not be pending anymore
+ *
+ * @throws ShaderException in case a non-optional variable was not found
+ */
+void UniformState::resolveDeferred(ShaderProgram *target) {
+    for (const unresolved & res : unresolved_) {
+        if (res.index < entries_.size()) entries_[res.index].location = target->resolveLocation(res.name.c_str(), res.optional);
+    }
+    unresolved_.clear();
+}
+
+
 } // opengl namespace
 } // fyusion namespace
 
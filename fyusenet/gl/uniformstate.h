@@ -12,6 +12,8 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <string>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -129,12 +131,30 @@ class UniformState {
     // Non-public methods
     // ------------------------------------------------------------------------
     GLint getLocation(const char *name, bool optional);
+    void resolveDeferred(ShaderProgram *target);
+
+    /**
+     * @brief Entry whose location could not be resolved yet, as the program was pending linkage
+     */
+    struct unresolved {
+        size_t index;               //!< Index of the entry in #entries_
+        std::string name;           //!< Name of the uniform variable
+        bool optional;              //!< Indicator if variable is optional
+    };
+
+    /**
+     * @brief Placeholder location for entries that are added while the program is pending
+     */
+    constexpr static GLint DEFERRED_LOCATION = 0x7FFFFFFF;
 
     // ------------------------------------------------------------------------
     // Member variables
     // ------------------------------------------------------------------------
     std::weak_ptr<ShaderProgram> target_;       //!< Pointer to ShaderProgram (weak) that this state object refers to
+    uint32_t id_ = 0;                           //!< Unique ID of this state object, used to detect redundant applications
+    static std::atomic<uint32_t> nextID_;       //!< Source for unique state IDs
     std::vector<entry> entries_;                //!< Uniform state variables
+    std::vector<unresolved> unresolved_;        //!< Entries with locations that are resolved on first use
 };
 
 
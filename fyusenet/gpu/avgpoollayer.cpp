@@ -64,15 +64,15 @@ programptr AvgPoolLayer::compileShader(const char *preproc) {
  */
 void AvgPoolLayer::renderChannelBatch(int outPass,int numRenderTargets,int texOffset) {
     for (int tex=0;tex<numRenderTargets;tex++) {
-        glActiveTexture(GL_TEXTURE0+tex);
-        glBindTexture(GL_TEXTURE_2D,inputTextures_.at(tex+texOffset));
+        GLState::activeTexture(GL_TEXTURE0+tex);
+        GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(tex+texOffset));
     }
     if (currentShader_ != shaders_[numRenderTargets-1].get()) {
         if (currentShader_) currentShader_->unbind(true);
         currentShader_ = shaders_[numRenderTargets-1].get();
         currentShader_->bind(shaderStates_[numRenderTargets-1].get());
     }
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT,(const GLvoid *)0);
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT,(const GLvoid *)0);
 }
 
 
@@ -80,8 +80,8 @@ void AvgPoolLayer::renderChannelBatch(int outPass,int numRenderTargets,int texOf
  * @copydoc PoolingLayer::beforeRender
  */
 void AvgPoolLayer::beforeRender() {
-    glBlendEquation(GL_MAX);
-    glBlendFunc(GL_ONE, GL_ONE);
+    GLState::blendEquation(GL_MAX);
+    GLState::blendFunc(GL_ONE, GL_ONE);
 }
 
 
@@ -89,7 +89,7 @@ void AvgPoolLayer::beforeRender() {
  * @copydoc PoolingLayer::afterRender
  */
 void AvgPoolLayer::afterRender() {
-    glBlendEquation(GL_FUNC_ADD);
+    GLState::blendEquation(GL_FUNC_ADD);
 }
 
 
@@ -109,8 +109,8 @@ void BatchNormLayer::afterRender() {
  */
 void BatchNormLayer::renderChannelBatch(int outPass, int numRenderTargets, int texOffset) {
     for (int tex = 0; tex < numRenderTargets; tex++) {
-        glActiveTexture(GL_TEXTURE0 + tex);
-        glBindTexture(GL_TEXTURE_2D, inputTextures_.at(tex + texOffset));
+        GLState::activeTexture(GL_TEXTURE0 + tex);
+        GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(tex + texOffset));
     }
     if (currentShader_ != shaders_[numRenderTargets-1].get()) {
         if (currentShader_)
@@ -120,7 +120,7 @@ void BatchNormLayer::renderChannelBatch(int outPass, int numRenderTargets, int t
     }
     BiasScaleBlock *block = blocks_.at(outPass);
     currentShader_->setMappedUniformVec4Array(UNIFORM_BIASSCALE, block->biasScale_, numRenderTargets * 2);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *) 0);
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *) 0);
 }
 
 
@@ -122,8 +122,8 @@ void BlurLayer::computeAverageWeights() {
  */
 void BlurLayer::renderChannelBatch(int outPass, int numRenderTargets, int texOffset) {
     for (int tex=0; tex < numRenderTargets; tex++) {
-        glActiveTexture(GL_TEXTURE0+tex);
-        glBindTexture(GL_TEXTURE_2D,inputTextures_.at(tex+texOffset));
+        GLState::activeTexture(GL_TEXTURE0+tex);
+        GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(tex+texOffset));
     }
     if (currentShader_ != shaders_[numRenderTargets-1].get()) {
         if (currentShader_) currentShader_->unbind(true);
@@ -131,7 +131,7 @@ void BlurLayer::renderChannelBatch(int outPass, int numRenderTargets, int texOff
         currentShader_->bind(shaderStates_[numRenderTargets-1].get());
         currentShader_->setMappedUniformVec4Array(SHADER_WEIGHTS,kernelWeights_,kernelSize_*kernelSize_);
     }
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
 }
 
 
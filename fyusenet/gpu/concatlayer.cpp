@@ -171,13 +171,13 @@ void ConcatLayer::forward(uint64_t sequence) {
 #endif
         std::lock_guard<std::recursive_mutex> lck(processingLock_);
         if (outputChanged_) updateFBOs();
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_STENCIL_TEST);
-        glDisable(GL_CULL_FACE);
-        glDisable(GL_BLEND);
-        glDepthFunc(GL_GEQUAL);
-        glDepthMask(GL_FALSE);
-        glViewport(0,0,viewport_[0],viewport_[1]);
+        GLState::disable(GL_DEPTH_TEST);
+        GLState::disable(GL_STENCIL_TEST);
+        GLState::disable(GL_CULL_FACE);
+        GLState::disable(GL_BLEND);
+        GLState::depthFunc(GL_GEQUAL);
+        GLState::depthMask(GL_FALSE);
+        GLState::viewport(0,0,viewport_[0],viewport_[1]);
         vertexArray_->bind();
         int blockoffset=0;
         int layeroffset=0;
@@ -186,11 +186,11 @@ void ConcatLayer::forward(uint64_t sequence) {
         int rem = portChannels_.at(blockoffset);
         ShaderProgram * currentshader = defaultShader_.get();
         currentshader->bind(defaultShaderState_.get());
-        glClearColor(0.0f,0.f,0.0f,0.0f);
+        GLState::clearColor(0.0f,0.f,0.0f,0.0f);
         for (int outpass=0; outpass < (int)framebuffers_.size(); outpass++) {
             framebuffers_.at(outpass)->bind();
             framebuffers_.at(outpass)->setWriteMask();
-            glClear(GL_COLOR_BUFFER_BIT);
+            GLState::clear(GL_COLOR_BUFFER_BIT);
             if ((rem < trail) && (outpass < (int)framebuffers_.size()-1)) {
                 trail = rem;
                 blockoffset++;
@@ -204,13 +204,13 @@ void ConcatLayer::forward(uint64_t sequence) {
                     rem = portChannels_.at(blockoffset);
                 }
             }
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D,inputTextures_.at(layeroffset++));
+            GLState::activeTexture(GL_TEXTURE0);
+            GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(layeroffset++));
             if ((shift > 0) || (trail < PIXEL_PACKING)) {
                 int shader = (trail-1)+3*shift;
-                glActiveTexture(GL_TEXTURE1);
-                if (rem > 0) glBindTexture(GL_TEXTURE_2D,inputTextures_.at(layeroffset));
-                else glBindTexture(GL_TEXTURE_2D,inputTextures_.at(layeroffset-1));      // TODO (mw) actually bind a zero-texture here to be clean/r
+                GLState::activeTexture(GL_TEXTURE1);
+                if (rem > 0) GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(layeroffset));
+                else GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(layeroffset-1));      // TODO (mw) actually bind a zero-texture here to be clean/r
                 if (concatShaders_[shader].get() != currentshader) {
                     currentshader->unbind(true);
                     currentshader = concatShaders_[shader].get();
@@ -225,7 +225,7 @@ void ConcatLayer::forward(uint64_t sequence) {
                 }
             }
             shift = PIXEL_PACKING - trail;
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+            GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
             framebuffers_.at(outpass)->unbind();
         }
         vertexArray_->unbind();
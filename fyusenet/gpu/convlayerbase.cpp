@@ -37,7 +37,7 @@ ConvLayerBase::ConvLayerBase(const ConvLayerBuilder & builder,int layerNumber) :
     assert(builder.type_ != LayerType::ILLEGAL);
     assert(builder.downsample_[0] == builder.downsample_[1]);
     assert(builder.kernel_ > 0);
-    assert(builder.dilation_[0] == builder.dilation_[1]);
+    assert((builder.dilation_[0] > 0) && (builder.dilation_[1] > 0));
     kernel_ = builder.kernel_;
     dilation_[0] = builder.dilation_[0];
     dilation_[1] = builder.dilation_[1];
@@ -61,6 +61,9 @@ struct ConvLayerBuilderTempl : GPULayerBuilderTempl<D> {
      * @param vertical Vertical dilation factor
      *
      * @return Reference to builder object
+     *
+     * For (non-depthwise) convolutions on deep tensors, the input padding must cover the dilated
+     * kernel window along both axes, see deep::DeepTiler::requiredInputPadding().
      */
     D & dilation(short horizontal,short vertical) {
       dilation_[0] = horizontal;
@@ -94,10 +97,194 @@ struct ConvLayerBuilderTempl : GPULayerBuilderTempl<D> {
       return *(D *)this;
     }
 
+    /**
+     * @brief Request compute-shader implementation for the convolution
+     *
+     * @param enable If set to \c true, the layer factory will create a compute-shader based
+     *               convolution layer, if the system and the layer parameters support it
+     *
+     * @return Reference to builder object
+     *
+     * This is currently only available for deep-tensor convolutions on systems that support
+     * compute shaders (GL 4.3 / GLES 3.1). If the compute path cannot be used, the factory falls
+     * back to the fragment-shader implementation.
+     *
+     * @see deep::DeepComputeConvLayer
+     */
+    D & compute(bool enable=true) {
+      compute_ = enable;
+      return *(D *)this;
+    }
+
+    /**
+     * @brief Select 2D texture arrays as tensor storage for input and/or output
+     *
+     * @param input If set to \c true, the input tensor is read from a 2D texture array
+     * @param output If set to \c true, the output tensor is written to a 2D texture array
+     *
+     * @return Reference to builder object
+     *
+     * Instead of packing the 4-channel slices of a deep tensor into a padded tile atlas, texture
+     * arrays store each slice in its own (unpadded) layer. This removes the padding overhead and
+     * the texture-size limit on the number of channels. Array storage is only supported by
+     * compute-shader convolutions, layers that read or write array tensors can only be connected
+     * to layers that use the same storage. Requires compute().
+     *
+     * @see deep::DeepComputeConvLayer, BufferSpec::GPU_DEEP_ARRAY
+     */
+    D & textureArray(bool input, bool output) {
+      arrayInput_ = input;
+      arrayOutput_ = output;
+      return *(D *)this;
+    }
+
+    /**
+     * @brief Control the usage of the Winograd algorithm for 3x3 convolutions
+     *
+     * @param enable If set to \c true, the layer factory will use a Winograd-based implementation
+     *               whenever the layer parameters support it, if set to \c false, the direct
+     *               implementation will always be used
+     *
+     * @return Reference to builder object
+     *
+     * If this function is not called, the layer factory runs both implementations on the layer
+     * dimensions once and picks the faster one. The result is cached per GPU and layer shape, see
+     * deep::DeepWinogradConvLayer::isPreferred(). The Winograd implementation is currently only
+     * available for deep-tensor 3x3 convolutions with unit stride and no dilation.
+     *
+     * @see deep::DeepWinogradConvLayer
+     */
+    D & winograd(bool enable=true) {
+      winograd_ = (enable) ? 1 : 0;
+      return *(D *)this;
+    }
+
+    /**
+     * @brief Fuse a pointwise (1x1) convolution into a depthwise convolution
+     *
+     * @param act Activation function to apply to the depthwise result before it is fed to the
+     *            pointwise convolution, only \c NONE, \c RELU and \c CLIP (using the clipping
+     *            values supplied by clip()) are supported
+     *
+     * @return Reference to builder object
+     *
+     * This turns a depthwise convolution (group size equal to the number of input channels) into
+     * a depthwise-separable block, where the number of output channels refers to the output of
+     * the pointwise convolution. The depthwise result is kept in a layer-internal texture. Postfix
+     * batchnorm and residual apply to the output of the pointwise convolution. Weight data is
+     * expected in the following order:
+     *   - depthwise biases (\e m input channels)
+     *   - depthwise weights in the order <tt>[channel][kernely][kernelx]</tt>
+     *   - pointwise biases (\e n output channels)
+     *   - pointwise weights in the order <tt>[outchannel][inchannel]</tt>
+     *   - optional batchnorm scales and offsets (\e n each)
+     *
+     * This is currently only supported for deep-tensor layers.
+     *
+     * @see deep::DeepDepthwiseConvLayerNxN
+     */
+    D & pointwise(ActType act = ActType::NONE) {
+      if ((act != ActType::NONE) && (act != ActType::RELU) && (act != ActType::CLIP)) {
+          THROW_EXCEPTION_ARGS(FynException, "Activation type %d not supported between depthwise and pointwise convolution", (int)act);
+      }
+      pointwise_ = true;
+      pointwiseAct_ = act;
+      return *(D *)this;
+    }
+
+    /**
+     * @brief Fold a spatial resize of the input tensor into the convolution
+     *
+     * @param srcWidth Width of the (unpadded) input tensor before resizing
+     * @param srcHeight Height of the (unpadded) input tensor before resizing
+     * @param type Interpolation type for the resize
+     * @param alignCorners If \c true, the centers of the corner pixels of the input and the
+     *                     resized tensor are aligned, otherwise the half-pixel mapping is used
+     *
+     * @return Reference to builder object
+     *
+     * This replaces a resize layer that is directly followed by this convolution. The input
+     * tensor of the layer has the supplied source size and is resampled on-the-fly to the size
+     * that is set on this builder (via shape() or width() / height()) whenever the convolution
+     * reads from it, such that the resized tensor is never stored. The resampling is the same as
+     * the one of deep::DeepResizeLayer. Input padding refers to both, the source and the resized
+     * tensor.
+     *
+     * This is currently only supported for deep-tensor 1x1 and odd-sized NxN convolutions which
+     * use the fragment-shader path (no compute shaders, no Winograd, no depthwise).
+     */
+    D & resizeInput(int srcWidth, int srcHeight, ScalingType type = ScalingType::LINEAR, bool alignCorners = false) {
+      if ((srcWidth <= 0) || (srcHeight <= 0)) {
+          THROW_EXCEPTION_ARGS(FynException, "Illegal source size %dx%d for input resize", srcWidth, srcHeight);
+      }
+      resizeSource_[0] = (short)srcWidth;
+      resizeSource_[1] = (short)srcHeight;
+      resizeType_ = type;
+      resizeAlignCorners_ = alignCorners;
+      return *(D *)this;
+    }
+
+    /**
+     * @brief Store the convolution weights as 8-bit integers
+     *
+     * @param enable If set to \c true, the weights are quantized to 8-bit integers
+     *
+     * @return Reference to builder object
+     *
+     * The weights are quantized symmetrically with one scale per output channel, which is the
+     * largest absolute weight of that channel. The quantized weights are dequantized on-the-fly
+     * in the shaders, activations and accumulation remain at the regular precision. This reduces
+     * the size of the weight texture to 25% of the 32-bit floating-point weights (50% of the
+     * 16-bit weights) and requires a single texture fetch per 4x4 weight block.
+     *
+     * This is currently only supported for deep-tensor 1x1 and NxN convolutions which use the
+     * fragment-shader path (no compute shaders, no Winograd, no depthwise, no transpose) and
+     * requires integer texture support. It is ignored for all other convolutions as well as for
+     * layers that apply a batchnorm on the residual input. Quantized 3x3 convolutions are never
+     * switched to the Winograd implementation automatically, an explicit call to winograd()
+     * takes precedence and disables the quantization.
+     *
+     * @see deep::DeepConvLayerBase::loadWeightsAndBiases
+     */
+    D & quantizeWeights(bool enable=true) {
+      quantizeWeights_ = enable;
+      return *(D *)this;
+    }
+
+    /**
+     * @brief Supply the convolution coefficients via a uniform buffer object
+     *
+     * @param enable If set to \c true, the coefficients are uploaded once into a uniform buffer
+     *               instead of being set as simple uniforms prior to each shader pass
+     *
+     * @return Reference to builder object
+     *
+     * This is only supported for shallow-tensor convolutions and ignored on systems where the
+     * coefficients for a single shader pass do not fit into a uniform block. It is not enabled by
+     * default, as it turned out to be slower on the mobile GPUs it was benchmarked on.
+     *
+     * @see vanilla::ConvLayerBase
+     */
+    D & uniformBuffer(bool enable=true) {
+      uniformBuffer_ = enable;
+      return *(D *)this;
+    }
+
     short kernel_ = 1;              //!< Isotropic 2D convolution kernel size (we currently do not support anisotropic convolution)
     short dilation_[2] = {1,1};     //!< Dilation factor for dilated convolutions along x- and y-axis
     short groupSize_ = 1;           //!< Group size for grouped/depthwise convolutions (we only support a limited set here)
     float sourceStep_ = 1.f;        //!< Step-size for fractional convolutions
+    bool compute_ = false;          //!< Indicator that a compute-shader implementation is requested
+    bool arrayInput_ = false;       //!< Indicator that the input tensor is stored as 2D texture array
+    bool arrayOutput_ = false;      //!< Indicator that the output tensor is stored as 2D texture array
+    short winograd_ = -1;           //!< Winograd selection (-1 = automatic, 0 = disabled, 1 = requested), see winograd()
+    bool pointwise_ = false;        //!< Indicator that a pointwise convolution is fused into a depthwise convolution, see pointwise()
+    ActType pointwiseAct_ = ActType::NONE;  //!< Activation between depthwise and fused pointwise convolution
+    short resizeSource_[2] = {0,0};         //!< Source size of a resize that is folded into the input sampling (0 if none), see resizeInput()
+    ScalingType resizeType_ = ScalingType::LINEAR;  //!< Interpolation type for a folded input resize
+    bool resizeAlignCorners_ = false;       //!< Indicator that a folded input resize aligns the corner pixels
+    bool quantizeWeights_ = false;          //!< Indicator that the weights are stored as 8-bit integers, see quantizeWeights()
+    bool uniformBuffer_ = false;            //!< Indicator that the coefficients are supplied via a uniform buffer, see uniformBuffer()
 };
 
 
@@ -110,6 +297,7 @@ struct ConvLayerBuilderTempl : GPULayerBuilderTempl<D> {
  *  - dilation factors
  *  - group size
  *  - fractional step values for fractional convolutions
+ *  - an optional resize of the input tensor that is folded into the convolution
  */
 struct ConvLayerBuilder : ConvLayerBuilderTempl<ConvLayerBuilder> {
 
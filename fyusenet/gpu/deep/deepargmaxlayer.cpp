@@ -13,6 +13,7 @@
 #include <cstring>
 #include <cassert>
 #include <cfloat>
+#include <algorithm>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -43,9 +44,7 @@ DeepArgMaxLayer::DeepArgMaxLayer(const ArgMaxLayerBuilder & builder, int layerNu
     DeepLayerBase((const GPULayerBuilder &)builder, layerNumber) {
     assert(outputChannels_ <= 2);  // we allow up to two output channels here (first one is the index, 2nd one is the actual max value)
     if (builder.getFlags() & LayerFlags::RESIDUAL_INPUT) THROW_EXCEPTION_ARGS(FynException, "This layer does not support residual inputs");
-#ifndef HIGH_PRECISION
-    if (inputChannels_ > 2048) THROW_EXCEPTION_ARGS(FynException, "Due to the final output in 16-bit FP textures, this layer does not support more than 2048 input channels");
-#endif
+    if ((!highPrecision_) && (inputChannels_ > 2048)) THROW_EXCEPTION_ARGS(FynException, "Due to the final output in 16-bit FP textures, this layer does not support more than 2048 input channels");
     pass1VBOA_ = nullptr;
     pass1VBOB_ = nullptr;
     pass1IBO_ = nullptr;
@@ -55,6 +54,7 @@ DeepArgMaxLayer::DeepArgMaxLayer(const ArgMaxLayerBuilder & builder, int layerNu
     pass2IBO_ = nullptr;
     pass1FBO_ = nullptr;
     channelBits_ = std::max(1, (int)ceil(log2((double)inputChannels_)));
+    tileGroups_ = (tiler_->numInputTiles() + TILE_GROUP - 1) / TILE_GROUP;
     pass2Mask_ = ((1<<channelBits_)-1) << (EXPONENT_BITS + GUARD_BITS);
     pass1Mask_ = ~pass2Mask_;
 }
@@ -66,7 +66,6 @@ DeepArgMaxLayer::DeepArgMaxLayer(const ArgMaxLayerBuilder & builder, int layerNu
 void DeepArgMaxLayer::cleanup() {  
     if (pass1VBOA_) delete pass1VBOA_;
     if (pass1VBOB_) delete pass1VBOB_;
-    if (pass1VBOC_) delete pass1VBOC_;
     if (pass1IBO_) delete pass1IBO_;
     if (pass1VAO_) delete pass1VAO_;
     if (pass2VAO_) delete pass2VAO_;
@@ -75,7 +74,6 @@ void DeepArgMaxLayer::cleanup() {
     if (pass1FBO_) delete pass1FBO_;
     pass1VBOA_ = nullptr;
     pass1VBOB_ = nullptr;
-    pass1VBOC_ = nullptr;
     pass1IBO_ = nullptr;
     pass1VAO_ = nullptr;
     pass2VAO_ = nullptr;
@@ -118,35 +116,35 @@ void DeepArgMaxLayer::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_MAX);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+    GLState::blendEquation(GL_MAX);
     float clear = (float)-powf(2,EXPONENT_MAX)-0.5f;
-    glClearColor(clear, clear, clear, clear);
-    glViewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::clearColor(clear, clear, clear, clear);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
     pass1FBO_->bind();
     pass1FBO_->setWriteMask();
-    glClear(GL_COLOR_BUFFER_BIT);
+    GLState::clear(GL_COLOR_BUFFER_BIT);
     pass1VAO_->bind();
     pass1Shader_->bind(pass1State_.get());
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
-    glDrawElements(GL_TRIANGLES,tiler_->numInputTiles()*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
+    GLState::drawElements(GL_TRIANGLES,tileGroups_*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
     pass1Shader_->unbind(true);
     pass1VAO_->unbind();
     pass1FBO_->unbind();
-    glDisable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
+    GLState::disable(GL_BLEND);
+    GLState::blendEquation(GL_FUNC_ADD);
     framebuffers_.at(0)->bind();
     framebuffers_.at(0)->setWriteMask();
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    GLState::clearColor(0.0f, 0.0f, 0.0f, 0.0f);
     pass2VAO_->bind();
     pass2Shader_->bind(pass2State_.get());
-    glClear(GL_COLOR_BUFFER_BIT);
-    glBindTexture(GL_TEXTURE_2D,pass1FBO_->getAttachment());
-    glDrawElements(GL_TRIANGLES,tiler_->numOutputTiles()*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
+    GLState::clear(GL_COLOR_BUFFER_BIT);
+    GLState::bindTexture(GL_TEXTURE_2D,pass1FBO_->getAttachment());
+    GLState::drawElements(GL_TRIANGLES,tiler_->numOutputTiles()*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
     pass2VAO_->unbind();
     pass2Shader_->unbind();
 }
@@ -194,10 +192,14 @@ void DeepArgMaxLayer::setupShaders() {
     // NOTE (mw) flt_min is a bit imprecise here, but we do not expect values that low
     snprintf(line,sizeof(line),"#define FLT_MIN %.8e\n#define PLACEMENT_BITS %d\n", fmin, EXPONENT_BITS+GUARD_BITS);
     strncat(preproc, line, mc);
+    mc -= strlen(line);
+    assert(mc > 0);
+    snprintf(line, sizeof(line), "#define IN_CHANNELS %d\n#define IN_TILES_X %d\n#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n#define OUT_PAD %d\n",
+             inputChannels_, tiler_->numInputTiles(DeepTiler::HORIZONTAL), width_, height_, inputPadding_, outputPadding_);
+    strncat(preproc, line, mc);
     pass1Shader_ = compileShaderPair("shaders/deep/deepargmax.vert", "shaders/deep/deepargmax1.frag",preproc,typeid(this));
     pass1Shader_->bindAttributeLocation("attributes0", 0);
     pass1Shader_->bindAttributeLocation("attributes1", 1);
-    pass1Shader_->bindAttributeLocation("attributes2", 2);
     pass1Shader_->link();
     pass1State_ = UniformState::makeShared(pass1Shader_);
     pass1State_->setUniformValue("inputLayer0", 0);
@@ -221,60 +223,47 @@ void DeepArgMaxLayer::setupShaders() {
  */
 void DeepArgMaxLayer::setupNetworkPolygons() {
     int offset0 = 0, offset1 = 0;
-    float * attrs0 = new float[tiler_->numInputTiles()*4*4];
-    unsigned int * attrs1 = new unsigned int[tiler_->numInputTiles()*4*4];
-    unsigned int * attrs2 = new unsigned int[tiler_->numInputTiles()*4*4];
+    float * attrs0 = new float[tileGroups_*4*4];
+    int * attrs1 = new int[tileGroups_*4*2];
     pass1VAO_ = new VAO(context_);
     pass1VAO_->bind();
     //---------------------------------------------
-    // VBO parts
+    // VBO parts, each group of input tiles is
+    // rendered as one polygon covering the output
     //---------------------------------------------
     std::vector<DeepTiler::Tile> otiles = tiler_->createOutputTiles();
     std::vector<DeepTiler::Tile> itiles = tiler_->createInputTiles(0,0);
-    for (int i=0; i < (int)itiles.size(); i++) {
+    for (int i=0; i < tileGroups_; i++) {
         DeepTiler::Tile ot = otiles.at(0);
-        DeepTiler::Tile it = itiles.at(i);
+        DeepTiler::Tile it = itiles.at(i*TILE_GROUP);
         ot.toFloatVec(attrs0,offset0,4);
         it.toFloatVec(attrs0,offset0+2,4);
         offset0 += 4*4;
         for (int j=0; j < 4; j++) {
-            attrs2[offset1] = ((i*4) < inputChannels_) ? 1 : 0;
-            attrs2[offset1+1] = ((i*4+1) < inputChannels_) ? 1 : 0;
-            attrs2[offset1+2] = ((i*4+2) < inputChannels_) ? 1 : 0;
-            attrs2[offset1+3] = ((i*4+3) < inputChannels_) ? 1 : 0;
-            attrs1[offset1++] = i*4;
-            attrs1[offset1++] = i*4+1;
-            attrs1[offset1++] = i*4+2;
-            attrs1[offset1++] = i*4+3;
+            attrs1[offset1++] = i*TILE_GROUP;
+            attrs1[offset1++] = std::min((int)TILE_GROUP, tiler_->numInputTiles() - i*TILE_GROUP);
         }
     }
     pass1VBOA_ = new VBO(context_);
     pass1VAO_->enableArray(0);
-    pass1VBOA_->setBufferData(attrs0,tiler_->numInputTiles()*4*4*sizeof(float),GL_STATIC_DRAW);
+    pass1VBOA_->setBufferData(attrs0,tileGroups_*4*4*sizeof(float),GL_STATIC_DRAW);
     pass1VBOA_->bind();
     pass1VAO_->setVertexAttributeBuffer(0,4,GL_FLOAT,GL_FALSE,0,0);
 
     pass1VBOB_ = new VBO(context_);
     pass1VAO_->enableArray(1);
-    pass1VBOB_->setBufferData(attrs1,tiler_->numInputTiles()*4*4*sizeof(unsigned int),GL_STATIC_DRAW);
+    pass1VBOB_->setBufferData(attrs1,tileGroups_*4*2*sizeof(int),GL_STATIC_DRAW);
     pass1VBOB_->bind();
-    pass1VAO_->setVertexAttributeBuffer(1,4,GL_UNSIGNED_INT,0,0);
-
-    pass1VBOC_ = new VBO(context_);
-    pass1VAO_->enableArray(2);
-    pass1VBOC_->setBufferData(attrs2,tiler_->numInputTiles()*4*4*sizeof(unsigned int),GL_STATIC_DRAW);
-    pass1VBOC_->bind();
-    pass1VAO_->setVertexAttributeBuffer(2,4,GL_UNSIGNED_INT,0,0);
+    pass1VAO_->setVertexAttributeBuffer(1,2,GL_INT,0,0);
 
     delete [] attrs0;
     delete [] attrs1;
-    delete [] attrs2;
     //---------------------------------------------
     // IBO part
     //---------------------------------------------
-    GLshort * indices = new GLshort[tiler_->numInputTiles()*6];
+    GLshort * indices = new GLshort[tileGroups_*6];
     pass1IBO_ = new IBO(context_);
-    for (int i=0; i < tiler_->numInputTiles(); i++) {
+    for (int i=0; i < tileGroups_; i++) {
         int offset = i*4;
         indices[i*6+0] = offset+0;
         indices[i*6+1] = offset+1;
@@ -283,7 +272,7 @@ void DeepArgMaxLayer::setupNetworkPolygons() {
         indices[i*6+4] = offset+2;
         indices[i*6+5] = offset+3;
     }
-    pass1IBO_->setBufferData(indices,6*tiler_->numInputTiles()*sizeof(GLshort),GL_STATIC_DRAW);
+    pass1IBO_->setBufferData(indices,6*tileGroups_*sizeof(GLshort),GL_STATIC_DRAW);
     pass1IBO_->bind();
     delete [] indices;
     pass1VAO_->unbind();
@@ -65,7 +65,10 @@ namespace deep {
  *
  * On the implementation side, we simply use the ROPs max-blending function along with some code
  * in the fragment shaders to comnpute the maximum. As a side-effect, the 2nd channel of the output
- * will be the maximum value that matches the index in the first channel.
+ * will be the maximum value that matches the index in the first channel. In order to reduce the
+ * amount of blending (which serializes on the ROPs), the reduction over the channels is done as a
+ * two-level tree: each fragment computes the maximum over a group of #TILE_GROUP input tiles in
+ * the shader and only the group results are combined by max-blending.
  *
  * As is obvious from that approach, this will lead to multiple forms of imprecisions/errors. First,
  * by removing bits from the mantissa representation, we introduce an additional truncation error
@@ -108,8 +111,7 @@ class DeepArgMaxLayer : public DeepLayerBase {
     // ------------------------------------------------------------------------
     VAO *pass1VAO_ = nullptr;                 //!< Vertex array object for 1st pass render
     VBO *pass1VBOA_ = nullptr;                //!< %VBO for vertex coordinates, 1st pass render
-    VBO *pass1VBOB_ = nullptr;                //!< %VBO for channel offsets, 1st pass render
-    VBO *pass1VBOC_ = nullptr;                //!< %VBO for channel masking, 1st pass render
+    VBO *pass1VBOB_ = nullptr;                //!< %VBO for tile ranges (first tile and number of tiles), 1st pass render
     IBO *pass1IBO_ = nullptr;                 //!< Polygon connectivity for 1st pass render
     VAO *pass2VAO_ = nullptr;                 //!< Vertex array object for 2nd pass (postproc) render
     VBO *pass2VBO_ = nullptr;                 //!< Vertex coordinates for 2nd pass
@@ -122,6 +124,8 @@ class DeepArgMaxLayer : public DeepLayerBase {
     int channelBits_ = 0;                     //!< Number of bits required to store channel information
     unsigned int pass1Mask_ = 0;
     unsigned int pass2Mask_ = 0;
+    int tileGroups_ = 0;                      //!< Number of tile groups (and polygons) in the 1st pass render
+    constexpr static int TILE_GROUP = 8;      //!< Number of input tiles that are reduced by a single fragment in the 1st pass
     constexpr static int MANTISSABITS = 23;   //!< Number of bits for float mantissa (32-bit single FP IEEE-754)
     constexpr static int EXPONENT_MAX = 127;  //!< Maximum exponent value for float (32-bit single FP IEEE-754)
     constexpr static int EXPONENT_MIN = -126; //!< Minimum exponent value for float (32-bit single FP IEEE-754)
@@ -128,10 +128,10 @@ void DeepBatchNormLayer::setupNetworkPolygons(VAO *vao) {
  * @copydoc DeepFunctionLayer::renderChannelBatch
  */
 void DeepBatchNormLayer::renderChannelBatch() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
     int quads = tiler_->numOutputTiles();
-    glDrawElements(GL_TRIANGLES,quads*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
+    GLState::drawElements(GL_TRIANGLES,quads*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
 }
 
 
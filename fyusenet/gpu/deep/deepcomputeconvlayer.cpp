@@ -0,0 +1,343 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Convolutional Layer using Compute Shaders
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/shaderprogram.h"
+#include "../../gl/glinfo.h"
+#include "../../gl/glexception.h"
+#include "../../common/logging.h"
+#include "deepcomputeconvlayer.h"
+
+//-------------------------------------- Global Variables ------------------------------------------
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+
+/**
+ * @copydoc DeepConvLayerBase::DeepConvLayerBase
+ */
+DeepComputeConvLayer::DeepComputeConvLayer(const ConvLayerBuilder & builder, int layerNumber) : DeepConvLayerBase(builder, layerNumber) {
+    assert(builder.groupSize_ == 1);
+    assert(kernel_ & 1);
+    // NOTE quantized weights are not supported by the compute shader (yet)
+    quantizedWeights_ = false;
+    block_ = std::max(1, blockSize(builder));
+    arrayInput_ = builder.arrayInput_;
+    arrayOutput_ = builder.arrayOutput_;
+    // NOTE texture arrays carry no padding, so the dispatch only covers the tensor itself
+    int opad = (arrayOutput_) ? 0 : outputPadding_;
+    int spanx = tiler_->getOutputWidth() + 2 * opad;
+    int spany = tiler_->getOutputHeight() + 2 * opad;
+    int gridtiles = (arrayOutput_) ? tiler_->numOutputTiles() : tiler_->numOutputTiles(DeepTiler::HORIZONTAL) * tiler_->numOutputTiles(DeepTiler::VERTICAL);
+    groups_[0] = (spanx + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+    groups_[1] = (spany + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+    groups_[2] = (gridtiles + block_ - 1) / block_;
+}
+
+
+/**
+ * @copydoc GPULayerBase::cleanup
+ */
+void DeepComputeConvLayer::cleanup() {
+    shaderState_.reset();
+    shader_.reset();
+    DeepConvLayerBase::cleanup();
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredInputBuffers
+ */
+std::vector<BufferSpec> DeepComputeConvLayer::getRequiredInputBuffers() const {
+    std::vector<BufferSpec> result = DeepConvLayerBase::getRequiredInputBuffers();
+    if (arrayInput_) {
+        result[0] = BufferSpec(0, 0, tiler_->getInputWidth(), tiler_->getInputHeight(),
+                               TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                               BufferSpec::CONVOLUTION_SOURCE).dataOrder(BufferSpec::order::GPU_DEEP_ARRAY).arrayLayers(tiler_->numInputTiles());
+    }
+    return result;
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredOutputBuffers
+ */
+std::vector<BufferSpec> DeepComputeConvLayer::getRequiredOutputBuffers() const {
+    std::vector<BufferSpec> result = DeepConvLayerBase::getRequiredOutputBuffers();
+    if (arrayOutput_) {
+        result[0] = BufferSpec(0, 0, tiler_->getOutputWidth(), tiler_->getOutputHeight(),
+                               TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                               BufferSpec::CONVOLUTION_DEST).dataOrder(BufferSpec::order::GPU_DEEP_ARRAY).arrayLayers(tiler_->numOutputTiles());
+    }
+    // NOTE image store requires immutable texture storage on GLES
+    for (BufferSpec & spec : result) spec.immutable(true);
+    return result;
+}
+
+
+/**
+ * @brief Check if a convolution can be computed by this class
+ *
+ * @param builder Builder that contains the convolution parameters
+ *
+ * @retval true if the system supports compute shaders and the convolution parameters are supported
+ *              by this class
+ * @retval false otherwise
+ *
+ * @pre The GL context that is to be used for running the inference is current to the calling thread
+ *
+ * Supported are regular (non-grouped) convolutions with odd isotropic kernel sizes, isotropic
+ * dilation and isotropic downsampling. In addition, the data that is staged in shared memory must
+ * not exceed the capacity of the GPU and texture-array tensors must not exceed the maximum number
+ * of array layers.
+ */
+bool DeepComputeConvLayer::isSupported(const ConvLayerBuilder & builder) {
+    if (!GLInfo::supportsComputeShader()) return false;
+    if ((builder.groupSize_ != 1) || ((builder.kernel_ & 1) == 0)) return false;
+    if ((builder.upsample_[0] != 1) || (builder.upsample_[1] != 1)) return false;
+    if ((builder.downsample_[0] != builder.downsample_[1]) || (builder.dilation_[0] != builder.dilation_[1])) return false;
+    if (builder.sourceStep_ != 1.f) return false;
+    if ((builder.arrayInput_) || (builder.arrayOutput_)) {
+        GLint maxlayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxlayers);
+        int tiles = (std::max(builder.in(), builder.out()) + PIXEL_PACKING - 1) / PIXEL_PACKING;
+        if (tiles > maxlayers) return false;
+    }
+    return (blockSize(builder) > 0);
+}
+
+
+/**
+ * @copydoc LayerBase::forward
+ */
+void DeepComputeConvLayer::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture((arrayInput_) ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D,weightTexture_);
+    GLState::activeTexture(GL_TEXTURE0+BIAS_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D,biasTexture_);
+    if (flags_ & LayerFlags::RESIDUAL_INPUT) {
+        if (residualTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"Residual flag configured, but no such texture found.");
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D,residualTextures_.at(0));
+    }
+    GLState::bindImageTexture(0, outputTextures_.at(0), 0, (arrayOutput_) ? GL_TRUE : GL_FALSE, 0, GL_WRITE_ONLY, (GLenum)textureFormat());
+    shader_->bind(shaderState_.get());
+    GLState::dispatchCompute(groups_[0], groups_[1], groups_[2]);
+    shader_->unbind();
+    // NOTE subsequent layers read the output as texture, downloads go through FBOs and PBOs
+    GLState::memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT |
+                           GL_PIXEL_BUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+}
+
+
+/**
+ * @copydoc DeepConvLayerBase::copyResult
+ *
+ * @note Texture-array outputs do not carry any padding, \p includePadding is ignored for those.
+ */
+void DeepComputeConvLayer::copyResult(float *memory, bool includePadding) {
+    if (!arrayOutput_) {
+        DeepConvLayerBase::copyResult(memory, includePadding);
+        return;
+    }
+#ifdef DEBUG
+    if (memory) {
+        int width = tiler_->getOutputWidth();
+        int height = tiler_->getOutputHeight();
+        float * data = new float[width*height*PIXEL_PACKING];
+        float * layer = memory;
+        for (int fb=0; fb < numFBOs(); fb++) {
+            getFBO(fb)->writeToMemory<float,GL_FLOAT>(data, PIXEL_PACKING, width*height*PIXEL_PACKING*sizeof(float));
+            int rem = std::min((int)PIXEL_PACKING, outputChannels_ - fb*PIXEL_PACKING);
+            for (int l=0; l < rem; l++) {
+                for (int i=0; i < width*height; i++) layer[i] = data[i*PIXEL_PACKING+l];
+                layer += width*height;
+            }
+        }
+        delete [] data;
+    }
+#endif
+}
+
+
+/**
+ * @copydoc DeepConvLayerBase::writeResult
+ */
+void DeepComputeConvLayer::writeResult(const char *fileName, bool includePadding) {
+    if (!arrayOutput_) {
+        DeepConvLayerBase::writeResult(fileName, includePadding);
+        return;
+    }
+#ifdef DEBUG
+    size_t elems = (size_t)(tiler_->getOutputWidth() * tiler_->getOutputHeight() * outputChannels_);
+    float * data = new float[elems];
+    copyResult(data, false);
+    FILE *out = fopen(fileName, "w");
+    if (out) {
+        fwrite(data, 1, elems*sizeof(float), out);
+        fclose(out);
+    }
+    delete [] data;
+#endif
+}
+
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+
+/**
+ * @brief No proxy polygons are required for the compute shader
+ *
+ * @param vao Pointer to vertex array object (unused)
+ */
+void DeepComputeConvLayer::setupNetworkPolygons(VAO *vao) {
+}
+
+
+/**
+ * @copydoc DeepConvLayerBase::compileConvolutionShaders
+ */
+void DeepComputeConvLayer::compileConvolutionShaders(const char *preproc) {
+    char finalpreproc[1024+512] = {0};
+    char extra[512];
+    strncpy(finalpreproc, preproc, sizeof(finalpreproc)-1);
+    if (flags_ & LayerFlags::RESIDUAL_INPUT) strncat(finalpreproc,"#define USE_RESIDUAL\n", sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    if (arrayInput_) strncat(finalpreproc,"#define ARRAY_INPUT\n", sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    if (arrayOutput_) strncat(finalpreproc,"#define ARRAY_OUTPUT\n", sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    snprintf(extra, sizeof(extra),
+             "#define WG_X %d\n#define WG_Y %d\n#define OUT_BLOCK %d\n#define STRIDE %d\n#define CONV_DILATION %d\n"
+             "#define IN_TILES %d\n#define IN_TILES_X %d\n#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n"
+             "#define OUT_TILES %d\n#define OUT_TILES_X %d\n#define OUT_TILES_Y %d\n#define OUT_WIDTH %d\n#define OUT_HEIGHT %d\n"
+             "#define OUT_PAD %d\n#define RES_PAD %d\n#define IMAGE_FORMAT %s\n",
+             WORKGROUP_SIZE, WORKGROUP_SIZE, block_, downsample_[0], dilation_[0],
+             tiler_->numInputTiles(), tiler_->numInputTiles(DeepTiler::HORIZONTAL), tiler_->getInputWidth(), tiler_->getInputHeight(), (arrayInput_) ? 0 : inputPadding_,
+             tiler_->numOutputTiles(), tiler_->numOutputTiles(DeepTiler::HORIZONTAL), tiler_->numOutputTiles(DeepTiler::VERTICAL),
+             tiler_->getOutputWidth(), tiler_->getOutputHeight(), (arrayOutput_) ? 0 : outputPadding_, residualPadding_,
+             (highPrecision_) ? "rgba32f" : "rgba16f");
+    strncat(finalpreproc, extra, sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    shader_ = compileComputeShader("shaders/deep/deepconv_compute.comp", finalpreproc, typeid(this));
+    try {
+        shader_->link();
+    } catch (GLException& ex) {
+        FNLOGE("Cannot link shader for layer %s",getName().c_str());
+        throw;
+    }
+    shaderState_ = UniformState::makeShared(shader_);
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ *
+ * For texture-array outputs, one %FBO per array layer is created. These are only used for
+ * reading back the results, the compute shader writes to the texture directly.
+ */
+void DeepComputeConvLayer::setupFBOs() {
+    if (!arrayOutput_) {
+        DeepConvLayerBase::setupFBOs();
+        return;
+    }
+    if (outputTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"No output texture set in convlayer %s",getName().c_str());
+    for (int layer=0; layer < tiler_->numOutputTiles(); layer++) {
+        FBO * fbo = new FBO(context_, tiler_->getOutputWidth(), tiler_->getOutputHeight());
+        fbo->addTextureLayer(GL_COLOR_ATTACHMENT0, outputTextures_.at(0), layer);
+        fbo->unbind();
+        framebuffers_.push_back(fbo);
+    }
+    outputChanged_ = false;
+}
+
+
+/**
+ * @copydoc GPULayerBase::updateFBOs
+ */
+void DeepComputeConvLayer::updateFBOs() {
+    if (!arrayOutput_) {
+        DeepConvLayerBase::updateFBOs();
+        return;
+    }
+    for (FBO * fbo : framebuffers_) delete fbo;
+    framebuffers_.clear();
+    setupFBOs();
+}
+
+
+/**
+ * @brief Determine number of output tiles to be computed per invocation
+ *
+ * @param builder Builder that contains the convolution parameters
+ *
+ * @return Number of output tiles (blocks of 4 channels) per invocation, or 0 if the shared memory
+ *         on the system is insufficient for this convolution
+ */
+int DeepComputeConvLayer::blockSize(const ConvLayerBuilder & builder) {
+    GLint maxshared = 0;
+    glGetIntegerv(GL_MAX_COMPUTE_SHARED_MEMORY_SIZE, &maxshared);
+    int outtiles = (builder.out() + PIXEL_PACKING - 1) / PIXEL_PACKING;
+    for (int block = std::min((int)MAX_BLOCK, outtiles); block > 0; block--) {
+        if (sharedMemory(builder.kernel_, builder.dilation_[0], builder.downsample_[0], block) <= (size_t)maxshared) return block;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Compute amount of shared memory used by the compute shader
+ *
+ * @param kernel Convolution kernel size
+ * @param dilation Dilation factor
+ * @param stride Downsampling factor
+ * @param block Number of output tiles per invocation
+ *
+ * @return Number of bytes in shared memory used for the input patch and the weights
+ */
+size_t DeepComputeConvLayer::sharedMemory(int kernel, int dilation, int stride, int block) {
+    size_t patch = (size_t)((WORKGROUP_SIZE - 1) * stride + (kernel - 1) * dilation + 1);
+    return (patch * patch + (size_t)(block * kernel * kernel * PIXEL_PACKING)) * PIXEL_PACKING * sizeof(float);
+}
+
+#endif
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
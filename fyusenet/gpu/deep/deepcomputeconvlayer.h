@@ -0,0 +1,115 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Convolutional Layer using Compute Shaders (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../gfxcontextlink.h"
+#include "../../base/bufferspec.h"
+#include "deepconvlayerbase.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
+/**
+ * @brief Deep-tensor convolution layer that is implemented by a compute shader
+ *
+ * This class implements a deep-tensor 2D convolution with odd (isotropic) kernel sizes using a
+ * single compute-shader dispatch instead of the proxy polygons and (additive) blending that are
+ * used by the fragment-shader implementations. It re-uses the weight and bias textures that are
+ * set up by DeepConvLayerBase.
+ *
+ * The dispatch is organized as follows:
+ *   - Each work group covers a rectangular area of \c 8x8 pixels inside an output tile and a
+ *     block of consecutive output tiles (i.e. groups of 4 output channels)
+ *   - For each input tile, the input patch that is required by the work group and the weights
+ *     for the block of output tiles are staged in shared memory
+ *   - Each invocation accumulates the results for all output tiles in the block in registers,
+ *     such that the input data is only read once per block
+ *   - Bias, batchnorm and residual are applied in the same pass and each texel of the output
+ *     texture (including its padding) is written exactly once
+ *
+ * As the output is written with \c imageStore(), the output texture must be immutable, which is
+ * requested in getRequiredOutputBuffers().
+ *
+ * Input and output tensors may alternatively be stored as 2D texture arrays with one (unpadded)
+ * layer per 4-channel slice (see ConvLayerBuilderTempl::textureArray()). In that case the
+ * borders of the input are handled by explicit bounds checks and the number of channels is only
+ * limited by \c GL_MAX_ARRAY_TEXTURE_LAYERS instead of the maximum texture size. Residual
+ * tensors are always read from the tile atlas.
+ *
+ * @note Only available on GL 4.3 and GLES 3.1 (or newer) and not on Apple, Android or WebGL
+ *       builds. Use isSupported() to check if a convolution can be run by this class, the
+ *       layer factory falls back to the fragment-shader path otherwise.
+ *
+ * @see ConvLayerBuilderTempl::compute()
+ */
+class DeepComputeConvLayer : public DeepConvLayerBase {
+ public:
+    constexpr static int WORKGROUP_SIZE = 8;
+    constexpr static int MAX_BLOCK = 2;
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepComputeConvLayer(const ConvLayerBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void forward(uint64_t sequence) override;
+    virtual void cleanup() override;
+    virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
+    virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
+    virtual void copyResult(float *memory, bool includePadding=false) override;
+    virtual void writeResult(const char *fileName, bool includePadding) override;
+
+    static bool isSupported(const ConvLayerBuilder & builder);
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    virtual void setupNetworkPolygons(VAO *vao) override;
+    virtual void compileConvolutionShaders(const char *preproc) override;
+    virtual void setupFBOs() override;
+    virtual void updateFBOs() override;
+    static int blockSize(const ConvLayerBuilder & builder);
+    static size_t sharedMemory(int kernel, int dilation, int stride, int block);
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    programptr shader_;             //!< Convolution compute shader program
+    unistateptr shaderState_;       //!< Uniform-variable state for #shader_
+    int block_ = 1;                 //!< Number of output tiles that are computed per invocation
+    int groups_[3] = {0, 0, 0};     //!< Number of work groups to dispatch
+    bool arrayInput_ = false;       //!< Indicator that the input tensor is stored as 2D texture array
+    bool arrayOutput_ = false;      //!< Indicator that the output tensor is stored as 2D texture array
+};
+#endif
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
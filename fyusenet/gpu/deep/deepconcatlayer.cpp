@@ -11,6 +11,7 @@
 
 #include <cstring>
 #include <cassert>
+#include <algorithm>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -64,6 +65,10 @@ DeepConcatLayer::~DeepConcatLayer() {
  * @copydoc ConcatLayer::setup
  */
 void DeepConcatLayer::setup() {
+    int views = (int)std::count(inputViews_.begin(), inputViews_.end(), true);
+    if ((views > 0) && (views < (int)inputViews_.size())) {
+        THROW_EXCEPTION_ARGS(FynException, "Concatenation layer %s cannot mix output views and copied inputs", getName().c_str());
+    }
     vertexArray_ = new VAO(context_);
     vertexArray_->bind();
     setupNetworkPolygons(vertexArray_);
@@ -106,35 +111,39 @@ void DeepConcatLayer::cleanup() {
  * This function executes the layer and performs the actual concatenation of the input textures to
  * an output texture. In order to save on rendering passes, the implementation uses up to 4 input
  * textures in parallel to perform the concatenation.
+ *
+ * In case all inputs are rendered directly into the output texture by their producers (see
+ * getInputView()), this function does nothing.
  */
 void DeepConcatLayer::forward(uint64_t sequence) {
     if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+    if ((!inputViews_.empty()) && (inputViews_.front())) return;
 #ifdef DEBUG
     int err = glGetError();
     if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_BLEND);
-    glClearColor(0.0f,0.0f,0.0f,0.0f);
-    glViewport(0,0,viewport_[0],viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    GLState::clearColor(0.0f,0.0f,0.0f,0.0f);
+    GLState::viewport(0,0,viewport_[0],viewport_[1]);
     vertexArray_->bind();
     framebuffers_.at(0)->bind();
     framebuffers_.at(0)->setWriteMask();
-    glClear(GL_COLOR_BUFFER_BIT);         // this is to instruct the tile-engine that we don't need the old tile-content
+    GLState::clear(GL_COLOR_BUFFER_BIT);         // this is to instruct the tile-engine that we don't need the old tile-content
     shader_->bind(shaderState_.get());
     for (RenderPassTexEnv env : passEnvironments_) {
         for (int i=0; i < env.numTextures_; i++) {
-            glActiveTexture(GL_TEXTURE0+i);
-            glBindTexture(GL_TEXTURE_2D,inputTextures_.at(env.textureIndices_[i]));
+            GLState::activeTexture(GL_TEXTURE0+i);
+            GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(env.textureIndices_[i]));
             //FNLOGI("Pass %d: texunit%d = %d",pass,i,env.TextureIndices[i]);
         }
         shader_->setMappedUniformValue(UNIFORM_NUMTEX,env.numTextures_);
         //FNLOGI("Setting %d textures to shader and elemoffset is %d",env.NumTextures,env.ElementOffset);
-        glDrawElements(GL_TRIANGLES,6*env.numElements_,GL_UNSIGNED_SHORT,(const GLvoid *)(env.elementOffset_*sizeof(short)));
+        GLState::drawElements(GL_TRIANGLES,6*env.numElements_,GL_UNSIGNED_SHORT,(const GLvoid *)(env.elementOffset_*sizeof(short)));
     }
     shader_->unbind();
     framebuffers_.at(0)->unbind();
@@ -150,6 +159,7 @@ void DeepConcatLayer::forward(uint64_t sequence) {
  */
 void DeepConcatLayer::addInput(int inputChannels, int inputPadding) {
     inputTilers_.push_back(new DeepTiler(LayerType::CONCAT,width_,height_,inputChannels,inputChannels,1.0f,1.0f,inputPadding,inputPadding,1,1,1,1));
+    inputViews_.push_back(false);
 }
 
 
@@ -205,6 +215,55 @@ int DeepConcatLayer::numInputChannels(int port) const {
 }
 
 
+/**
+ * @copydoc ConcatViewInterface::getInputView
+ *
+ * An input can be rendered directly into the output texture if its tiles map to a rectangular
+ * block of tiles in the output texture, which requires:
+ *   - the channel offset of the input to be a multiple of 4
+ *   - the number of channels of the input to be a multiple of 4, unless it is the last input
+ *   - the same padding for the input and the output tensor
+ *   - the input tiles to either occupy full rows of output tiles, starting at the first column,
+ *     or to fit into a single row of output tiles
+ *
+ * Inputs that do not fill their block of output tiles completely must be the last input. In
+ * addition, the concatenation must not apply an activation function to its inputs.
+ */
+bool DeepConcatLayer::getInputView(int port, int & originX, int & originY) const {
+    if ((port < 0) || (port >= numInputPorts())) return false;
+    if (flags_ & (LayerFlags::ACT_MASK | LayerFlags::RESIDUAL_INPUT)) return false;
+    int offset = 0;
+    for (int i=0; i < port; i++) offset += inputTilers_.at(i)->getInputChannels();
+    const DeepTiler * in = inputTilers_.at(port);
+    bool last = (port == numInputPorts()-1);
+    if ((offset % PIXEL_PACKING) != 0) return false;
+    if ((!last) && ((in->getInputChannels() % PIXEL_PACKING) != 0)) return false;
+    if (in->getOutputPadding() != tiler_->getOutputPadding()) return false;
+    int tilesx = tiler_->numOutputTiles(DeepTiler::HORIZONTAL);
+    int intilesx = in->numOutputTiles(DeepTiler::HORIZONTAL);
+    int intilesy = in->numOutputTiles(DeepTiler::VERTICAL);
+    int startx = (offset / PIXEL_PACKING) % tilesx;
+    int starty = (offset / PIXEL_PACKING) / tilesx;
+    bool fullrows = (intilesx == tilesx) && (startx == 0);
+    bool singlerow = (intilesy == 1) && (startx + intilesx <= tilesx);
+    if ((!fullrows) && (!singlerow)) return false;
+    if ((!last) && (in->numOutputTiles() != intilesx * intilesy)) return false;
+    originX = startx * (tiler_->getOutputWidth() + outputPadding_);
+    originY = starty * (tiler_->getOutputHeight() + outputPadding_);
+    return true;
+}
+
+
+/**
+ * @copydoc ConcatViewInterface::useInputView
+ */
+void DeepConcatLayer::useInputView(int port, bool enable) {
+    if ((port < 0) || (port >= numInputPorts())) THROW_EXCEPTION_ARGS(FynException,"Illegal input port %d specified",port);
+    inputViews_[port] = enable;
+    bindingRevision_++;
+}
+
+
 /*##################################################################################################
 #                               N O N -  P U B L I C  F U N C T I O N S                            #
 ##################################################################################################*/
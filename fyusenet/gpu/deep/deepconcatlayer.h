@@ -23,6 +23,7 @@
 #include "../../gl/ibo.h"
 #include "../../gl/vao.h"
 #include "../../gl/shaderprogram.h"
+#include "../../base/concatviewinterface.h"
 #include "../concatlayerbuilder.h"
 #include "deeplayerbase.h"
 
@@ -42,6 +43,11 @@ namespace deep {
  *
  * The interface is exactly the same as for the shallow pendant in vanilla::ConcatLayer.
  *
+ * When the channel offsets of the inputs line up with the tiles of the output tensor, the
+ * producing layers may render directly into the output texture (see ConcatViewInterface). The
+ * BufferManager sets this up while connecting the layers. If this is the case for all inputs,
+ * forward() does not perform any rendering at all.
+ *
  * @todo Derive this class and vanilla::ConcatLayer from a common interface for cleanliness and
  *       also add a version that concatenates shallow layers into deep layers to save on conversion
  *       layers
@@ -51,7 +57,7 @@ namespace deep {
  *       \e none of the inputs have an activation. It is currently not possible to mix
  *       these.
  */
-class DeepConcatLayer : public DeepLayerBase {
+class DeepConcatLayer : public DeepLayerBase, public ConcatViewInterface {
  public:
     enum {
       UNIFORM_NUMTEX=1
@@ -75,6 +81,8 @@ class DeepConcatLayer : public DeepLayerBase {
     virtual int numInputPorts() const override;
     virtual int getPortChannelIndex(int port) const override;
     virtual int numInputChannels(int port=0) const override;
+    virtual bool getInputView(int port, int & originX, int & originY) const override;
+    virtual void useInputView(int port, bool enable) override;
 
  protected:
 
@@ -127,6 +135,7 @@ class DeepConcatLayer : public DeepLayerBase {
     // Member variables
     // ------------------------------------------------------------------------
     std::vector<DeepTiler *> inputTilers_;  //!< Tiler instances for each input
+    std::vector<bool> inputViews_;          //!< Indicators for each input, whether it is rendered directly into the output texture
     programptr shader_;                     //!< Actual concatenation shader
     unistateptr shaderState_;               //!< Uniform state for #shader_
     VAO *vertexArray_ = nullptr;            //!< Pointer to vertex-array object which maintains the VBO / IBO config
@@ -82,10 +82,14 @@ DeepConvLayerNxN::DeepConvLayerNxN(const ConvLayerBuilder& builder,int layerNumb
     assert((builder.kernel_ % 2) == 1);
     assert(builder.kernel_ >= 3);
     assert(builder.groupSize_ == 1);
+    if (inputPadding_ < DeepTiler::requiredInputPadding(kernel_, dilation_[0], dilation_[1])) {
+        THROW_EXCEPTION_ARGS(FynException,"Input padding %d insufficient for %dx%d convolution with dilation (%d,%d), %d required", inputPadding_, kernel_, kernel_, dilation_[0], dilation_[1], DeepTiler::requiredInputPadding(kernel_, dilation_[0], dilation_[1]));
+    }
     maxVectors_ = GLInfo::getMaxVaryingVectors();
-    maxKernelWidth_ = (halfSupport_) ? (maxVectors_ - BASE_VECTORS) / 2 : (maxVectors_ - BASE_VECTORS) / 4;
+    // NOTE each 4x4 weight matrix occupies 1 (quantized), 2 (16-bit) or 4 (32-bit) varying vectors
+    if (quantizedWeights_) maxKernelWidth_ = maxVectors_ - BASE_VECTORS;
+    else maxKernelWidth_ = (halfSupport_) ? (maxVectors_ - BASE_VECTORS) / 2 : (maxVectors_ - BASE_VECTORS) / 4;
     partialConv_ = (maxKernelWidth_ < kernel_);
-    int maxdilstep = std::max(dilation_[0], dilation_[1]);
     if (partialConv_) {
         int partialclip = std::min(7, maxKernelWidth_);
         int kernel = builder.kernel_;
@@ -105,7 +109,7 @@ DeepConvLayerNxN::DeepConvLayerNxN(const ConvLayerBuilder& builder,int layerNumb
         }
         int maxpartial = 0;
         std::for_each(horizSplits_.begin(), horizSplits_.end(), [&](int val) { maxpartial = std::max(maxpartial, val); });
-        largeDilation_ = (maxdilstep * (maxpartial - 1)/2) > 7;
+        largeDilation_ = (dilation_[0] * (maxpartial - 1)/2) > 7;
     }
 }
 
@@ -134,30 +138,30 @@ void DeepConvLayerNxN::forward(uint64_t sequence) {
 #endif    
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
-    glBlendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
-    glViewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+    GLState::blendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
+    GLState::blendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
+    applyOutputViewport();
     vertexArray_->bind();
     framebuffers_.at(0)->bind();
     framebuffers_.at(0)->setWriteMask();
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
-    glActiveTexture(GL_TEXTURE0+DISP_TEXTURE);
-    glBindTexture(GL_TEXTURE_2D, inputCoordTexture_);
-    glActiveTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
-    glBindTexture(GL_TEXTURE_2D, weightTexture_);
-    glActiveTexture(GL_TEXTURE0+BIAS_TEXTURE);
-    glBindTexture(GL_TEXTURE_2D, biasTexture_);
+    GLState::clearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    clearOutput(GL_COLOR_BUFFER_BIT);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE0+DISP_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D, inputCoordTexture_);
+    GLState::activeTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D, weightTexture_);
+    GLState::activeTexture(GL_TEXTURE0+BIAS_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D, biasTexture_);
     if (flags_ & LayerFlags::RESIDUAL_INPUT) {
         if (residualTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"Residual flag configured, but no such texture found.");
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, residualTextures_.at(0));
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, residualTextures_.at(0));
     }
     if (!partialConv_) nonPartialRender();
     else partialRender();
@@ -180,13 +184,13 @@ void DeepConvLayerNxN::partialRender() {
     int tris = tiler_->numOutputTiles();
     for (int part=0; part <= numSplits_; part++) {
         shaders_[part]->bind(shaderStates_.at(part).get());
-        glDrawElements(GL_TRIANGLES, tris*6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        GLState::drawElements(GL_TRIANGLES, tris*6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
         shaders_[part]->unbind(true);
     }
     int instances = tiler_->numInputTiles() * kernel_ * (numSplits_ + 1);
     for (int part=0; part <= numSplits_; part++) {
         noBiasShaders_[part]->bind(noBiasShaderStates_.at(part).get());
-        glDrawElementsInstanced(GL_TRIANGLES, tris*6, GL_UNSIGNED_SHORT, (const GLvoid *)0, instances-1);
+        GLState::drawElementsInstanced(GL_TRIANGLES, tris*6, GL_UNSIGNED_SHORT, (const GLvoid *)0, instances-1);
         noBiasShaders_[part]->unbind((part != numSplits_));
     }
 }
@@ -201,11 +205,11 @@ void DeepConvLayerNxN::nonPartialRender() {
     int instances = tiler_->numInputTiles() * kernel_;
     int tris = tiler_->numOutputTiles();
     shaders_[0]->bind(shaderStates_.at(0).get());
-    glDrawElements(GL_TRIANGLES, tris*6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    GLState::drawElements(GL_TRIANGLES, tris*6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
     shaders_[0]->unbind((instances > 1) ? true : false);
     if (instances > 1)  {
         noBiasShaders_.at(0)->bind(noBiasShaderStates_.at(0).get());
-        glDrawElementsInstanced(GL_TRIANGLES, tris*6, GL_UNSIGNED_SHORT, (const GLvoid *)0, instances-1);
+        GLState::drawElementsInstanced(GL_TRIANGLES, tris*6, GL_UNSIGNED_SHORT, (const GLvoid *)0, instances-1);
         noBiasShaders_[0]->unbind();
     }
 }
@@ -300,11 +304,11 @@ void DeepConvLayerNxN::setupNetworkPolygons(VAO *vao) {
         // horizontal split in case of larger kernel sizes...
         //---------------------------------------------------------------------------
         glGenTextures(1,&inputCoordTexture_);
-        glBindTexture(GL_TEXTURE_2D,inputCoordTexture_);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+        GLState::bindTexture(GL_TEXTURE_2D,inputCoordTexture_);
+        GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+        GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+        GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+        GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
         float * texdata = new float[tiler_->numInputTiles() * 4 * (numSplits_ + 1) * kernel_];
         DeepTiler::Tile defex = tiler_->getDefaultTextureExtents();
         if ((kernel_ & 1) == 0) {
@@ -324,7 +328,7 @@ void DeepConvLayerNxN::setupNetworkPolygons(VAO *vao) {
                         int kxstart = -(horizSplits_.at(split) / 2);
                         ihk = hk - kxstart;
                     }
-                    std::vector<DeepTiler::Tile> tiles = tiler_->createInputTiles(ihk, vk*dilation_[1]);
+                    std::vector<DeepTiler::Tile> tiles = tiler_->createInputTiles(ihk*dilation_[0], vk*dilation_[1]);
                     for (DeepTiler::Tile tile : tiles) {
                         tile.toDisplacement(defex, texdata, offset);
                         tile.lowClamp(texdata, offset+2);
@@ -368,7 +372,7 @@ void DeepConvLayerNxN::compileConvolutionShaders(const char *preproc) {
         int kerneloffset = 0;
         for (int part=0; part <= numSplits_; part++) {
             bool odd = ((horizSplits_.at(part) & 1) == 1);
-            int varyings = horizSplits_.at(part) * ((halfSupport_) ? 2 : 4);
+            int varyings = horizSplits_.at(part) * ((quantizedWeights_) ? 1 : ((halfSupport_) ? 2 : 4));
             snprintf(extra, sizeof(extra), "#define COEFF_VARYINGS %d\n#define NET_KERNEL %d\n", varyings, horizSplits_.at(part));
             appendOffsetDefs(extra, horizSplits_.at(part), sizeof(extra) - strlen(extra) -1);
             strncpy(finalpreproc, preproc, sizeof(finalpreproc)-1);
@@ -50,6 +50,13 @@ class DeepConvLayerNxN : public DeepConvLayerBase {
     virtual void forward(uint64_t sequence) override;
     virtual void cleanup() override;
 
+    /**
+     * @copydoc GPULayerBase::supportsOutputView
+     */
+    virtual bool supportsOutputView() const override {
+        return true;
+    }
+
  protected:
     // ------------------------------------------------------------------------
     // Non-public methods
@@ -11,6 +11,7 @@
 
 #include <cstring>
 #include <cassert>
+#include <cmath>
 #include <algorithm>
 
 //-------------------------------------- Project  Headers ------------------------------------------
@@ -69,13 +70,16 @@ DeepConvLayerBase::DeepConvLayerBase(const ConvLayerBuilder & builder, int layer
         // the actual tiler to be used for generating the polygons
         residualTiler_ = new DeepTiler(LayerType::RESIDUAL,builder.width(),builder.height(),builder.out(),builder.out(),(float)builder.upsample_[0]/(float)builder.downsample_[0],(float)builder.upsample_[1]/(float)builder.downsample_[1],builder.residualPadding_,builder.outputPadding_,builder.downsample_[0],builder.downsample_[1],builder.upsample_[0],builder.upsample_[1]);
     }
-    assert(dilation_[0] == dilation_[1]);
-    largeDilation_ = (std::max(dilation_[0], dilation_[1]) * (kernel_ - 1)/2) > 7;
-#ifdef HIGH_PRECISION
-    halfSupport_ = false;
-#else
-    halfSupport_ = GLInfo::supportsHalf();
-#endif
+    // NOTE vertical dilation is handled by the input displacements, only the horizontal one is subject to textureOffset() limits
+    largeDilation_ = (dilation_[0] * (kernel_ - 1)/2) > 7;
+    // NOTE with a folded resize, the tilers operate on the resized size, only the input texture has the source size
+    resizeSource_[0] = builder.resizeSource_[0];
+    resizeSource_[1] = builder.resizeSource_[1];
+    resizeType_ = builder.resizeType_;
+    resizeAlignCorners_ = builder.resizeAlignCorners_;
+    halfSupport_ = (!highPrecision_) && GLInfo::supportsHalf();
+    // NOTE the dequantization scales share the texture row with the batchnorm scales, which are also applied to a batchnormed residual
+    quantizedWeights_ = builder.quantizeWeights_ && halfSupport_ && ((flags_ & LayerFlags::BATCHNORM_ON_RESIDUAL) == 0);
 }
 
 
@@ -113,11 +117,7 @@ DeepConvLayerBase::DeepConvLayerBase(const GPULayerBuilder & builder, int layerN
         // the actual tiler to be used for generating the polygons
         residualTiler_ = new DeepTiler(LayerType::RESIDUAL,builder.width(),builder.height(),builder.out(),builder.out(),(float)builder.upsample_[0]/(float)builder.downsample_[0],(float)builder.upsample_[1]/(float)builder.downsample_[1],builder.residualPadding_,builder.outputPadding_,builder.downsample_[0],builder.downsample_[1],builder.upsample_[0],builder.upsample_[1]);
     }
-#ifdef HIGH_PRECISION
-    halfSupport_ = false;
-#else
-    halfSupport_ = GLInfo::supportsHalf();
-#endif
+    halfSupport_ = (!highPrecision_) && GLInfo::supportsHalf();
 }
 
 
@@ -181,9 +181,9 @@ void DeepConvLayerBase::cleanup() {
     delete indexBuffer_;
     delete vertexArray_;
     delete textureOffsets_;
-    if (weightTexture_) glDeleteTextures(1, &weightTexture_);
-    if (biasTexture_) glDeleteTextures(1, &biasTexture_);
-    if (inputCoordTexture_) glDeleteTextures(1, &inputCoordTexture_);
+    if (weightTexture_) GLState::deleteTextures(1, &weightTexture_);
+    if (biasTexture_) GLState::deleteTextures(1, &biasTexture_);
+    if (inputCoordTexture_) GLState::deleteTextures(1, &inputCoordTexture_);
     textureOffsets_ = nullptr;
     vertexBuffer_ = nullptr;
     indexBuffer_ = nullptr;
@@ -201,7 +201,13 @@ void DeepConvLayerBase::cleanup() {
  */
 std::vector<BufferSpec> DeepConvLayerBase::getRequiredInputBuffers() const {
     std::vector<BufferSpec> result;
-    result.push_back(BufferSpec(0 ,0, tiler_->getInputTextureWidth(), tiler_->getInputTextureHeight(),
+    int texwidth = tiler_->getInputTextureWidth();
+    int texheight = tiler_->getInputTextureHeight();
+    if (resizeSource_[0] > 0) {
+        texwidth = tiler_->numInputTiles(DeepTiler::HORIZONTAL) * (resizeSource_[0] + inputPadding_) + inputPadding_;
+        texheight = tiler_->numInputTiles(DeepTiler::VERTICAL) * (resizeSource_[1] + inputPadding_) + inputPadding_;
+    }
+    result.push_back(BufferSpec(0 ,0, texwidth, texheight,
                                 TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
                                 BufferSpec::CONVOLUTION_SOURCE).dataOrder(BufferSpec::order::GPU_DEEP));
     if (flags_ & LayerFlags::RESIDUAL_INPUT) {
@@ -289,6 +295,11 @@ bool DeepConvLayerBase::isApplicable() const {
  * single channel and can reduce the texture width by 50% . This has to be decoded by the shader
  * later.
  *
+ * When quantized weights are requested (see ConvLayerBuilder::quantizeWeights), the texture
+ * width is reduced to 25% instead. Each weight is stored as 8-bit signed integer, such that a
+ * single pixel of the integer texture holds a complete 4x4 matrix with one output channel per
+ * color channel. The per-output-channel dequantization scales are stored in the bias texture,
+ * see loadBiasAndBatchnorm().
  */
 void DeepConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t offset) {
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
@@ -297,11 +308,7 @@ void DeepConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t
     texwidth *= kernel_;
     if (texwidth & 1) texwidth++;
     int texheight = ((outputChannels_ + (PIXEL_PACKING-1)) / PIXEL_PACKING) * kernel_;  // 4 pixels per matrix
-#ifdef HIGH_PRECISION
-    int checkwidth = texwidth;
-#else
-    int checkwidth = (halfSupport_) ? texwidth/2 : texwidth;
-#endif
+    int checkwidth = (quantizedWeights_) ? texwidth/4 : ((halfSupport_) ? texwidth/2 : texwidth);
     if ((checkwidth > GLInfo::getMaximumTextureSize()) || (texheight > GLInfo::getMaximumTextureSize())) {
         THROW_EXCEPTION_ARGS(FynException, "Weights do not fit into GL texture");
     }
@@ -330,13 +337,26 @@ void DeepConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t
         }
     }
     if (!weightTexture_) glGenTextures(1,&weightTexture_);
-    glBindTexture(GL_TEXTURE_2D,weightTexture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-#ifndef HIGH_PRECISION
-    if (halfSupport_) {
+    GLState::bindTexture(GL_TEXTURE_2D,weightTexture_);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    std::vector<float> scales;
+    if (quantizedWeights_) {
+        scales.resize(outputChannels_, 0.f);
+        size_t chanweights = kernel_ * kernel_ * inputChannels_;
+        for (int ol=0; ol < outputChannels_; ol++) {
+            for (size_t i=0; i < chanweights; i++) scales[ol] = std::max(scales[ol], fabsf(srcweights[ol*chanweights+i]));
+        }
+        unsigned int * packed = quantizeWeights(weights, texwidth, texheight, scales.data());
+#ifdef GL_RGBA32UI
+        glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA32UI,texwidth/4,texheight,0,GL_RGBA_INTEGER,GL_UNSIGNED_INT,packed);
+#else
+        glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA32UI_EXT,texwidth/4,texheight,0,GL_RGBA_INTEGER_EXT,GL_UNSIGNED_INT,packed);
+#endif
+        delete [] packed;
+    } else if (halfSupport_) {
         unsigned int * fp16 = FloatConversion::getInstance()->toFP16UI(weights,texwidth*texheight*PIXEL_PACKING);
 #ifdef GL_RGBA32UI
         glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA32UI,texwidth/2,texheight,0,GL_RGBA_INTEGER,GL_UNSIGNED_INT,fp16);
@@ -345,19 +365,79 @@ void DeepConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t
 #endif
         delete [] fp16;
     } else {
-        glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA16F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
+        glTexImage2D(GL_TEXTURE_2D,0,(highPrecision_) ? GL_RGBA32F : GL_RGBA16F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
     }
-#else
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA32F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
-#endif
     delete [] weights;
+    loadBiasAndBatchnorm(biasAndWeights, offset, (size_t)(kernel_*kernel_*inputChannels_*outputChannels_), (quantizedWeights_) ? scales.data() : nullptr);
+}
+
+
+/**
+ * @brief Quantize convolution weights to 8-bit integers
+ *
+ * @param weights Pointer to weight data in the texture layout described in loadWeightsAndBiases()
+ * @param texWidth Width of the (floating-point) weight texture, i.e. number of 4-element pixels
+ *                 per row in \p weights
+ * @param texHeight Height of the weight texture
+ * @param scales Pointer to per-output-channel scales, which are the largest absolute weights of
+ *               each output channel
+ *
+ * @return Pointer to texture data for an \c RGBA32UI texture of size (texWidth/4) x texHeight,
+ *         to be deleted by the caller
+ *
+ * The weights are quantized symmetrically to the range [-127,127] and four weights that belong
+ * to the same output channel are packed into a single 32-bit word, such that they can be
+ * decoded by \c unpackSnorm4x8 in the shader. Multiplying the decoded values by the scale of the
+ * output channel yields the (approximate) original weights.
+ */
+unsigned int * DeepConvLayerBase::quantizeWeights(const float *weights, int texWidth, int texHeight, const float *scales) const {
+    int qwidth = texWidth / PIXEL_PACKING;
+    unsigned int * packed = new unsigned int[qwidth * texHeight * PIXEL_PACKING];
+    for (int y=0; y < texHeight; y++) {
+        int outbase = (y / kernel_) * PIXEL_PACKING;
+        const float * src = weights + y * texWidth * PIXEL_PACKING;
+        unsigned int * dst = packed + y * qwidth * PIXEL_PACKING;
+        for (int x=0; x < qwidth * PIXEL_PACKING; x++) {
+            int ol = outbase + (x % PIXEL_PACKING);
+            float scale = ((ol < outputChannels_) && (scales[ol] > 0.f)) ? 127.f / scales[ol] : 0.f;
+            unsigned int word = 0;
+            for (int i=0; i < PIXEL_PACKING; i++) {
+                int q = std::min(127, std::max(-127, (int)lrintf(src[i] * scale)));
+                word |= ((unsigned int)(q & 0xFF)) << (8*i);
+            }
+            *dst++ = word;
+            src += PIXEL_PACKING;
+        }
+    }
+    return packed;
+}
+
+
+/**
+ * @brief Read biases and optional batchnorm parameters from raw data and store them into a texture
+ *
+ * @param biasAndWeights Pointer to array with bias and weight values, see loadWeightsAndBiases()
+ *                       for the format
+ * @param offset Optional offset (in floating-point elements) into \p biasAndWeights where to
+ *               start reading from
+ * @param weightCount Number of weights that are stored between the biases and the (optional)
+ *                    batchnorm parameters
+ *
+ * @param weightScales Optional per-output-channel dequantization scales for quantized weights
+ *
+ * The resulting texture has one row for the biases (which already include the batchnorm offsets)
+ * and an optional second row for the batchnorm scales. The first pixel in each row is zero. For
+ * quantized weights, the dequantization scales are multiplied into the second row, which is
+ * always present in that case.
+ */
+void DeepConvLayerBase::loadBiasAndBatchnorm(const float *biasAndWeights, size_t offset, size_t weightCount, const float *weightScales) {
     //------------------------------------------------------
     // If we have the post-BN flag set, store the batchnorm
     // stuff...
     //------------------------------------------------------
     if (flags_ & fyusenet::LayerFlags::POST_BATCHNORM) {
         int padout = 4*((outputChannels_ + 3)/4);
-        const float * srcbn = biasAndWeights + outputChannels_ + offset + kernel_*kernel_*inputChannels_*outputChannels_;
+        const float * srcbn = biasAndWeights + outputChannels_ + offset + weightCount;
         postBNScales_ = new float[padout];
         postBNBias_ = new float[padout];
         memset(postBNScales_,0,padout*sizeof(float));
@@ -368,8 +448,9 @@ void DeepConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t
     //------------------------------------------------------
     // Now for the bias part (and also batchnorm)...
     //------------------------------------------------------
+    bool scalerow = (flags_ & LayerFlags::POST_BATCHNORM) || (weightScales);
     int bs = PIXEL_PACKING*(1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING);
-    if (flags_ & LayerFlags::POST_BATCHNORM) bs *= 2;
+    if (scalerow) bs *= 2;
     float * bias = new float[bs];
     memset(bias, 0, bs*sizeof(float));
     memcpy(bias + PIXEL_PACKING,biasAndWeights+offset,outputChannels_*sizeof(float));
@@ -379,18 +460,20 @@ void DeepConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t
             bias[PIXEL_PACKING+i] = bias[PIXEL_PACKING+i] * postBNScales_[i] + postBNBias_[i];
             bias[PIXEL_PACKING+(bs/2)+i] = postBNScales_[i];
         }
+    } else if (scalerow) {
+        for (int i=0; i < outputChannels_; i++) bias[PIXEL_PACKING+(bs/2)+i] = 1.f;
+    }
+    // NOTE the dequantization is applied to the (unbiased) accumulated results, just like the batchnorm scale
+    if (weightScales) {
+        for (int i=0; i < outputChannels_; i++) bias[PIXEL_PACKING+(bs/2)+i] *= weightScales[i];
     }
     if (!biasTexture_) glGenTextures(1,&biasTexture_);
-    glBindTexture(GL_TEXTURE_2D,biasTexture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-#ifdef HIGH_PRECISION
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA32F,1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING,(flags_ & LayerFlags::POST_BATCHNORM) ? 2 : 1,0,GL_RGBA,GL_FLOAT,bias);
-#else
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA16F,1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING,(flags_ & LayerFlags::POST_BATCHNORM) ? 2 : 1,0,GL_RGBA,GL_FLOAT,bias);
-#endif
+    GLState::bindTexture(GL_TEXTURE_2D,biasTexture_);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D,0,(highPrecision_) ? GL_RGBA32F : GL_RGBA16F,1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING,(scalerow) ? 2 : 1,0,GL_RGBA,GL_FLOAT,bias);
     delete [] bias;
 }
 
@@ -401,8 +484,8 @@ void DeepConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t
 void DeepConvLayerBase::writeResult(const char *fileName,bool includePadding) {
     // FIXME (mw) this is a copy of the same method in DeepLayerBase, fix the inheritance
 #ifdef DEBUG
-    int owidth = tiler_->getViewportWidth();
-    int oheight = tiler_->getViewportHeight();
+    int owidth = (outputView_) ? outputExtents_[0] : tiler_->getViewportWidth();
+    int oheight = (outputView_) ? outputExtents_[1] : tiler_->getViewportHeight();
     float * data = new float[oheight*owidth*PIXEL_PACKING];
     int lwidth = tiler_->getOutputWidth();
     int lheight = tiler_->getOutputHeight();
@@ -428,7 +511,7 @@ void DeepConvLayerBase::writeResult(const char *fileName,bool includePadding) {
             for (int ty=0; ty < tiler_->numOutputTiles(DeepTiler::VERTICAL); ty++) {
                 for (int tx=0; tx < tiler_->numOutputTiles(DeepTiler::HORIZONTAL); tx++) {
                     int rem = ((outputChannels_ - layernum) > PIXEL_PACKING) ? PIXEL_PACKING : outputChannels_-layernum;
-                    float * in = data + ((outputPadding_ + ty*(lheight+outputPadding_))*owidth + outputPadding_+tx*(lwidth+outputPadding_))*PIXEL_PACKING;
+                    float * in = data + ((outputOrigin_[1] + outputPadding_ + ty*(lheight + outputPadding_))*owidth + outputOrigin_[0] + outputPadding_ + tx*(lwidth+outputPadding_))*PIXEL_PACKING;
                     float * outptr = (includePadding) ? layer + (outputPadding_*lwidth) + outputPadding_ : layer;
                     for (int l=0; l < rem;l++) {
                         for (int y=0; y < lheight;y++) {
@@ -467,8 +550,8 @@ void DeepConvLayerBase::copyResult(float *memory, bool includePadding) {
     // FIXME (mw) this is a copy of the same method in DeepLayerBase, fix the inheritance
 #ifdef DEBUG
     if (memory) {
-        int owidth = tiler_->getViewportWidth();
-        int oheight = tiler_->getViewportHeight();
+        int owidth = (outputView_) ? outputExtents_[0] : tiler_->getViewportWidth();
+        int oheight = (outputView_) ? outputExtents_[1] : tiler_->getViewportHeight();
         float * data = new float[oheight*owidth*PIXEL_PACKING];
         int lwidth = tiler_->getOutputWidth();
         int lheight = tiler_->getOutputHeight();
@@ -486,7 +569,7 @@ void DeepConvLayerBase::copyResult(float *memory, bool includePadding) {
             for (int ty=0; ty < tiler_->numOutputTiles(DeepTiler::VERTICAL); ty++) {
                 for (int tx=0; tx < tiler_->numOutputTiles(DeepTiler::HORIZONTAL); tx++) {
                     int rem = ((outputChannels_ - layernum) > PIXEL_PACKING) ? PIXEL_PACKING : outputChannels_ - layernum;
-                    const float * in = data + ((outputPadding_ + ty*(lheight + outputPadding_))*owidth + outputPadding_ + tx*(lwidth + outputPadding_))*PIXEL_PACKING;
+                    const float * in = data + ((outputOrigin_[1] + outputPadding_ + ty*(lheight + outputPadding_))*owidth + outputOrigin_[0] + outputPadding_ + tx*(lwidth + outputPadding_))*PIXEL_PACKING;
                     float * outptr = (includePadding) ? layer + (outputPadding_ * lwidth) + outputPadding_ : layer;
                     for (int l=0; l < rem; l++) {
                         for (int y=0; y < lheight; y++) {
@@ -552,10 +635,11 @@ size_t DeepConvLayerBase::shaderPreprocessing(char *preproc, size_t maxChars) {
         strncat(preproc, "#define PRE_G71\n", mc);
         mc = maxChars-strlen(preproc);  // ouch
     }
-#ifdef HIGH_PRECISION
-    strncat(preproc, "#define HIGH_PRECISION\n", mc);
-    mc = maxChars-strlen(preproc);
-#endif
+    if (quantizedWeights_) {
+        // NOTE the dequantization re-uses the post-batchnorm scaling path of the shaders
+        strncat(preproc, (flags_ & LayerFlags::POST_BATCHNORM) ? "#define INT8_WEIGHTS\n" : "#define INT8_WEIGHTS\n#define POST_BATCHNORM\n", mc);
+        mc = maxChars-strlen(preproc);  // ouch
+    }
     snprintf(extra, sizeof(extra), "#define KERNEL %d\n",kernel_);
     strncat(preproc, extra, mc);
     mc -= strlen(extra);
@@ -563,12 +647,23 @@ size_t DeepConvLayerBase::shaderPreprocessing(char *preproc, size_t maxChars) {
     if (largeDilation_) {
         snprintf(extra, sizeof(extra),"#define LARGE_DILATION\n");
     } else {
-        // NOTE (mw) for now we can only handle isotropic dilation
-        assert(dilation_[0] == dilation_[1]);
-        snprintf(extra, sizeof(extra),"#define DILATION %d\n", dilation_[0]);
+        snprintf(extra, sizeof(extra),"#define DILATION_X %d\n#define DILATION_Y %d\n", dilation_[0], dilation_[1]);
     }
     strncat(preproc, extra, mc);
-    return mc - strlen(extra);
+    mc -= strlen(extra);
+    assert(mc > 0);
+    if (resizeSource_[0] > 0) {
+        char resize[512];
+        snprintf(resize, sizeof(resize), "#define FUSED_RESIZE\n#define SRC_WIDTH %d\n#define SRC_HEIGHT %d\n#define SRC_PAD %d\n#define SRC_TILES_X %d\n"
+                 "#define DST_WIDTH %d\n#define DST_HEIGHT %d\n#define DST_PAD %d\n#define RESIZED_TEX_WIDTH %d\n#define RESIZED_TEX_HEIGHT %d\n%s%s",
+                 resizeSource_[0], resizeSource_[1], inputPadding_, tiler_->numInputTiles(DeepTiler::HORIZONTAL),
+                 width_, height_, inputPadding_, tiler_->getInputTextureWidth(), tiler_->getInputTextureHeight(),
+                 (resizeType_ == ScalingType::LINEAR) ? "#define LINEAR_RESIZE\n" : "",
+                 (resizeAlignCorners_) ? "#define ALIGN_CORNERS\n" : "");
+        strncat(preproc, resize, mc);
+        mc -= strlen(resize);
+    }
+    return mc;
 }
 
 
@@ -688,11 +783,11 @@ void DeepConvLayerBase::setupNetworkPolygons(VAO *vao) {
     // direction...
     //---------------------------------------------------------------------------
     glGenTextures(1,&inputCoordTexture_);
-    glBindTexture(GL_TEXTURE_2D,inputCoordTexture_);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+    GLState::bindTexture(GL_TEXTURE_2D,inputCoordTexture_);
+    GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
     float * texdata = new float[tiler_->numInputTiles()*4*kernel_];
     DeepTiler::Tile defex = tiler_->getDefaultTextureExtents();
     if ((kernel_ & 1) == 0) {
@@ -718,7 +813,9 @@ void DeepConvLayerBase::setupNetworkPolygons(VAO *vao) {
  */
 void DeepConvLayerBase::setupFBOs() {
     if (outputTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"No output texture set in convlayer %s",getName().c_str());
-    FBO * fbo = new FBO(context_,viewport_[0],viewport_[1],outputTextures_.at(0));
+    // NOTE when rendering into an output view, the FBO covers the whole (shared) texture
+    FBO * fbo = (outputView_) ? new FBO(context_, outputExtents_[0], outputExtents_[1], outputTextures_.at(0))
+                              : new FBO(context_, viewport_[0], viewport_[1], outputTextures_.at(0));
     fbo->bind();
     fbo->setWriteMask();
     fbo->unbind();
@@ -110,6 +110,18 @@ class DeepConvLayerBase : public ConvLayerBase {
         return residualTiler_;
     }
 
+    /**
+     * @brief Check if the weights are stored as 8-bit integers
+     *
+     * @retval true if the weights are quantized to 8-bit integers
+     * @retval false otherwise
+     *
+     * @see ConvLayerBuilder::quantizeWeights
+     */
+    bool hasQuantizedWeights() const {
+        return quantizedWeights_;
+    }
+
     virtual void writeResult(const char *fileName, bool includePadding) override;
     virtual void copyResult(float *memory, bool includePadding=false) override;
 
@@ -123,6 +135,8 @@ class DeepConvLayerBase : public ConvLayerBase {
     virtual void shaderPostprocessing(programptr shader);    
     virtual void setupFBOs() override;
     virtual void updateFBOs() override;
+    void loadBiasAndBatchnorm(const float *biasAndWeights, size_t offset, size_t weightCount, const float *weightScales=nullptr);
+    unsigned int * quantizeWeights(const float *weights, int texWidth, int texHeight, const float *scales) const;
 
     /**
      * @brief Compile convolution-specific shaders
@@ -156,6 +170,10 @@ class DeepConvLayerBase : public ConvLayerBase {
     bool preG71_ = false;                       //!< Indicator flat for (old) ARM Mali GPUs prior to G71
     bool largeDilation_ = false;                //!< Indicator if dilation is outside of the GLSL textureOffset operation
     bool halfSupport_ = false;                  //!< Indicator if 16-bit FP is supported on the platform
+    bool quantizedWeights_ = false;             //!< Indicator that the weights are stored as 8-bit integers with per-output-channel scales
+    int resizeSource_[2] = {0, 0};              //!< Size of the input tensor for a resize that is folded into the input sampling (0 if none)
+    ScalingType resizeType_ = ScalingType::LINEAR;  //!< Interpolation type for a folded input resize
+    bool resizeAlignCorners_ = false;           //!< Indicator that a folded input resize aligns the corner pixels
 
     constexpr const static int DISP_TEXTURE = 4;
     constexpr const static int WEIGHT_TEXTURE = 5;
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -18,6 +19,9 @@
 #include "deeptiler.h"
 #include "../../gl/fbo.h"
 #include "../../gl/pbopool.h"
+#include "../../gl/pbo.h"
+#include "../../common/logging.h"
+#include "../floatconversion.h"
 
 namespace fyusion {
 namespace fyusenet {
@@ -46,6 +50,10 @@ DeepDownloadLayer::DeepDownloadLayer(const UpDownLayerBuilder& builder, int laye
     if (builder.callback_) userCallback_ = builder.callback_;
     async_ = builder.async_;
 #endif
+    if (builder.fp16Transfer_) {
+        transferType_ = GL_HALF_FLOAT;
+        transferBytes_ = 2;
+    }
 }
 
 /**
@@ -126,28 +134,68 @@ CPUBuffer * DeepDownloadLayer::getOutputBuffer(int port) const {
  */
 void DeepDownloadLayer::setup() {
     setupFBOs();
+    if (transferType_ == GL_HALF_FLOAT) {
+        FBO * fbo = getFBO(0);
+        fbo->bind();
+        bool readable = fbo->supportsReadout(GL_RGBA, GL_HALF_FLOAT);
+        fbo->unbind();
+        if (!readable) {
+            FNLOGW("Half-precision readout not supported on this system, using single-precision for layer %s", getName().c_str());
+            transferType_ = GL_FLOAT;
+            transferBytes_ = 4;
+        }
+    }
+    PBOPool * pool = context_.interface()->getReadPBOPool();
+    if ((pool) && (pool->preallocation())) {
+        pool->reserve(viewport_[0], viewport_[1], PIXEL_PACKING, transferBytes_, (async_) ? 2 : 1, PBO::READ);
+    }
     valid_ = true;
 }
 
 
+/**
+ * @copydoc GPULayerBase::cleanup
+ */
+void DeepDownloadLayer::cleanup() {
+    clearTargetRing();
+    DeepLayerBase::cleanup();
+}
+
+
 /**
  * @copydoc LayerBase::forward
  */
 void DeepDownloadLayer::forward(uint64_t sequence) {
-    assert(outputs_.size() == 1);
+    assert((outputs_.size() == 1) || (ring_));
     assert(numFBOs() == 1);
     // TODO (mw) implement optional rendering step here (for ReLU)
-    ManagedPBO pbo = pboBlit();
 #ifndef FYUSENET_MULTITHREADING
     if (true) {
 #else
     if (!async_) {
 #endif
+        if (ring_) {
+            //-------------------------------------------------------------
+            // Direct download into the caller-supplied target ring, for
+            // persistent PBOs we have to wait for the GPU explicitly...
+            //-------------------------------------------------------------
+            ManagedPBO pbo;
+            int slot = ringBlit(sequence, pbo);
+            if (ring_->mapped(slot)) {
+                GLsync sync = context().issueSync();
+                if (!context().waitClientSync(sync, 5000000000)) THROW_EXCEPTION_ARGS(FynException, "Cannot read out texture within 5s for sequence %ld", sequence);
+                context().removeSync(sync);
+            }
+            ringReadout(slot, pbo);
+            ring_->notify(sequence, slot, AsyncLayer::DOWNLOAD_DONE);
+            return;
+        }
         //-------------------------------------------------------------
         // Synchronous part, we still use a PBO here though there is no
         // advantage doing that. It just makes the code easier.
         //-------------------------------------------------------------
-        outputs_[0]->readFromPBO(*pbo, CPUBufferShape::type::FLOAT32, sequence);
+        ManagedPBO pbo = pboBlit();
+        outputs_[0]->readFromPBO(*pbo, (transferType_ == GL_HALF_FLOAT) ? CPUBufferShape::type::FLOAT16 : CPUBufferShape::type::FLOAT32, sequence);
     } else {
 #ifdef FYUSENET_MULTITHREADING
         THROW_EXCEPTION_ARGS(FynException, "Layer is not synchronous");
@@ -165,17 +213,22 @@ void DeepDownloadLayer::asyncForward(uint64_t sequenceNo, const std::function<vo
     if (flags_ & LayerFlags::PRE_ACT_MASK) THROW_EXCEPTION_ARGS(FynException,"Activation on download not implemented yet");
     if (flags_ & LayerFlags::RESIDUAL_INPUT) THROW_EXCEPTION_ARGS(FynException,"Residual add on download not implemented yet");
     if (!async_) THROW_EXCEPTION_ARGS(FynException, "Layer is not asynchronous");
-    ManagedPBO pbo = pboBlit();
+    ManagedPBO pbo;
+    int slot = -1;
+    if (ring_) slot = ringBlit(sequenceNo, pbo);
+    else pbo = pboBlit();
     //-------------------------------------------------------------
     // We issue a fence here and start a thread that waits for the
     // fence before reading out the PBO...
     //-------------------------------------------------------------
     GLsync sync = context().issueSync();
     asyncLock_.lock();
+    CPUBuffer * target = (ring_) ? nullptr : outputs_[0];
     auto thread = AsyncPool::getDerivedContextThread(context());
     threads_[sequenceNo] = thread;
-    thread->setTask(std::bind(&DeepDownloadLayer::readoutPBO, this, thread, pbo, sync, sequenceNo, outputs_[0], callback));
-    if (userCallback_) userCallback_(sequenceNo, outputs_[0], AsyncLayer::DOWNLOAD_COMMENCED);
+    thread->setTask(std::bind(&DeepDownloadLayer::readoutPBO, this, thread, pbo, sync, sequenceNo, target, slot, callback));
+    if (ring_) ring_->notify(sequenceNo, slot, AsyncLayer::DOWNLOAD_COMMENCED);
+    else if (userCallback_) userCallback_(sequenceNo, target, AsyncLayer::DOWNLOAD_COMMENCED);
     asyncLock_.unlock();
 }
 #endif
@@ -223,6 +276,84 @@ void DeepDownloadLayer::updateOutputBuffer(CPUBuffer *buf, int port) {
 }
 
 
+/**
+ * @brief Download into a ring of caller-owned memory regions instead of the output CPUBuffer
+ *
+ * @param buffers List of memory regions that make up the ring, each region must be at least
+ *                \p bytes in size and stay valid until clearTargetRing() is called
+ * @param bytes Size of each memory region, must be at least targetBytes() for the given \p order
+ * @param order Data order to write, either \c CHANNELWISE to store the de-tiled tensor as plain
+ *              (unpadded) 3D array of single-precision floats, or \c GPU_DEEP to store the raw
+ *              (tiled) %PBO content
+ * @param notify Optional callback which is invoked with the ring slot address on
+ *               \c DOWNLOAD_COMMENCED (asynchronous layers only) and \c DOWNLOAD_DONE
+ *
+ * @throws FynException on invalid parameters
+ *
+ * @pre Calling thread has the GL context of this layer current (if a ring was set before)
+ *
+ * Once set, each download writes into the next slot of the ring (round-robin) directly from the
+ * mapped %PBO, bypassing the output CPUBuffer. Where supported, each slot is backed by a
+ * persistently-mapped %PBO. Before a slot is re-used, the layer waits for any pending readout
+ * into that slot.
+ *
+ * @see TargetRing
+ */
+void DeepDownloadLayer::setTargetRing(const std::vector<void *>& buffers, size_t bytes, BufferSpec::order order,
+                                      const TargetRing::callback& notify) {
+    if ((order != BufferSpec::order::CHANNELWISE) && (order != BufferSpec::order::GPU_DEEP)) {
+        THROW_EXCEPTION_ARGS(FynException, "Unsupported data order for target ring");
+    }
+    if (bytes < targetBytes(order)) THROW_EXCEPTION_ARGS(FynException, "Target ring buffers too small (%ld < %ld)", (long)bytes, (long)targetBytes(order));
+    TargetRing * ring = new TargetRing(context_, buffers, bytes, order, notify);
+    clearTargetRing();
+#ifdef FYUSENET_MULTITHREADING
+    std::lock_guard<std::recursive_mutex> lck(asyncLock_);
+#endif
+    ring_ = ring;
+}
+
+
+/**
+ * @brief Remove ring of caller-owned download targets
+ *
+ * @pre Calling thread has the GL context of this layer current (or one that is shared with it)
+ *
+ * Waits for all pending downloads on this layer and releases the ring. Subsequent downloads will
+ * use the output CPUBuffer again.
+ */
+void DeepDownloadLayer::clearTargetRing() {
+#ifdef FYUSENET_MULTITHREADING
+    std::vector<AsyncPool::GLThread> pending;
+    asyncLock_.lock();
+    for (auto it = threads_.begin(); it != threads_.end(); ++it) pending.push_back(it->second);
+    asyncLock_.unlock();
+    for (auto & thread : pending) thread->wait();
+    std::lock_guard<std::recursive_mutex> lck(asyncLock_);
+#endif
+    if (ring_) {
+        ring_->release();
+        delete ring_;
+        ring_ = nullptr;
+    }
+}
+
+
+/**
+ * @brief Get minimum size of caller-owned download targets
+ *
+ * @param order Data order to be written into the target
+ *
+ * @return Number of bytes required for each memory region in a target ring
+ *
+ * @see setTargetRing()
+ */
+size_t DeepDownloadLayer::targetBytes(BufferSpec::order order) const {
+    if (order == BufferSpec::order::CHANNELWISE) return (size_t)width_ * height_ * outputChannels_ * bytesPerChan_;
+    return (size_t)viewport_[0] * viewport_[1] * PIXEL_PACKING * bytesPerChan_;
+}
+
+
 /*##################################################################################################
 #                               N O N -  P U B L I C  F U N C T I O N S                            #
 ##################################################################################################*/
@@ -240,16 +371,120 @@ ManagedPBO DeepDownloadLayer::pboBlit() {
     assert(pool);
     int paddedwidth = viewport_[0];
     int paddedheight = viewport_[1];
-    ManagedPBO pbo = pool->getAvailablePBO(paddedwidth, paddedheight, PIXEL_PACKING, bytesPerChan_);
-    pbo->prepareForRead(paddedwidth * paddedheight * PIXEL_PACKING * bytesPerChan_);
+    ManagedPBO pbo = pool->getAvailablePBO(paddedwidth, paddedheight, PIXEL_PACKING, transferBytes_);
+    pbo->prepareForRead(paddedwidth * paddedheight * PIXEL_PACKING * transferBytes_);
     FBO *fbo = getFBO(0);
     fbo->bind();
-    fbo->copyToPBO(*pbo, GL_FLOAT, PIXEL_PACKING, 0, true);
+    fbo->copyToPBO(*pbo, transferType_, PIXEL_PACKING, 0, true);
     fbo->unbind();
     if (async_) pbo.setPending();
     return pbo;
 }
 
+
+/**
+ * @brief Read texture content into the PBO of the next slot in the target ring
+ *
+ * @param sequence Sequence number of the download
+ * @param[out] pbo Receives a pooled %PBO in case the ring slot is not backed by a persistent %PBO
+ *
+ * @return Ring slot index that the download is assigned to
+ *
+ * In case the slot is still in use by a pending (asynchronous) readout, this function waits for
+ * that readout to finish.
+ */
+int DeepDownloadLayer::ringBlit(uint64_t sequence, opengl::ManagedPBO& pbo) {
+    assert(ring_);
+    uint64_t previous = 0;
+    int slot = ring_->next(sequence, &previous);
+    if (previous != ~(uint64_t)0) wait(previous);
+    PBO * persistent = ring_->persistentPBO(slot, viewport_[0], viewport_[1], PIXEL_PACKING, transferBytes_);
+    if (persistent) {
+        FBO *fbo = getFBO(0);
+        fbo->bind();
+        fbo->copyToPBO(persistent, transferType_, PIXEL_PACKING, 0, true);
+        fbo->unbind();
+        persistent->flushForRead();
+    } else {
+        pbo = pboBlit();
+    }
+    return slot;
+}
+
+
+/**
+ * @brief Copy %PBO content into a target ring slot
+ *
+ * @param slot Ring slot index to copy the data into
+ * @param pbo Pooled %PBO that contains the data, only used if the slot is not backed by a
+ *            persistently mapped %PBO
+ *
+ * @pre The GPU has finished writing into the %PBO
+ *
+ * For \c CHANNELWISE order, the tiles are de-tiled and the padding is stripped in the same pass,
+ * otherwise the raw %PBO content is copied. Half-precision %PBO data is expanded to
+ * single-precision on the way.
+ */
+void DeepDownloadLayer::ringReadout(int slot, opengl::ManagedPBO& pbo) {
+    const void * mem = ring_->mapped(slot);
+    if (!mem) {
+        pbo->bind(GL_PIXEL_PACK_BUFFER);
+        mem = pbo->mapReadBuffer();
+        if (!mem) {
+            pbo->unbind(GL_PIXEL_PACK_BUFFER);
+            THROW_EXCEPTION_ARGS(FynException,"Cannot read data from PBO");
+        }
+    }
+    const float * src = static_cast<const float *>(mem);
+    if (transferType_ == GL_HALF_FLOAT) {
+        const uint16_t * half = static_cast<const uint16_t *>(mem);
+        const FloatConversion * conv = FloatConversion::getInstance();
+        float * tgt = static_cast<float *>(ring_->buffer(slot));
+        if (ring_->order() == BufferSpec::order::CHANNELWISE) {
+            int stride = viewport_[0] * PIXEL_PACKING;
+            std::vector<float> row(width_ * PIXEL_PACKING);
+            std::vector<DeepTiler::Tile> tiles = tiler_->createOutputTiles();
+            int channel = 0;
+            size_t planesize = (size_t)width_ * height_;
+            for (const DeepTiler::Tile & tile : tiles) {
+                const uint16_t * in = half + tile.imageCoords_[1] * stride + tile.imageCoords_[0] * PIXEL_PACKING;
+                int rem = std::min(PIXEL_PACKING, outputChannels_ - channel);
+                for (int y=0; y < height_; y++) {
+                    conv->toFloat(in + y * stride, row.data(), row.size());
+                    for (int l=0; l < rem; l++) {
+                        float * out = tgt + (channel + l) * planesize + (size_t)y * width_;
+                        for (int x=0; x < width_; x++) out[x] = row[x * PIXEL_PACKING + l];
+                    }
+                }
+                channel += rem;
+            }
+        } else {
+            conv->toFloat(half, tgt, targetBytes(BufferSpec::order::GPU_DEEP) / sizeof(float));
+        }
+    } else if (ring_->order() == BufferSpec::order::CHANNELWISE) {
+        float * tgt = static_cast<float *>(ring_->buffer(slot));
+        int stride = viewport_[0] * PIXEL_PACKING;
+        std::vector<DeepTiler::Tile> tiles = tiler_->createOutputTiles();
+        int channel = 0;
+        for (const DeepTiler::Tile & tile : tiles) {
+            const float * in = src + tile.imageCoords_[1] * stride + tile.imageCoords_[0] * PIXEL_PACKING;
+            int rem = std::min(PIXEL_PACKING, outputChannels_ - channel);
+            for (int l=0; l < rem; l++, channel++) {
+                for (int y=0; y < height_; y++) {
+                    const float * inrow = in + y * stride + l;
+                    for (int x=0; x < width_; x++) *tgt++ = inrow[x * PIXEL_PACKING];
+                }
+            }
+        }
+    } else {
+        memcpy(ring_->buffer(slot), src, targetBytes(BufferSpec::order::GPU_DEEP));
+    }
+    if (!ring_->mapped(slot)) {
+        pbo->unmapReadBuffer();
+        pbo->unbind(GL_PIXEL_PACK_BUFFER);
+    }
+}
+
 #ifdef FYUSENET_MULTITHREADING
 /**
  * @brief Perform readout of PBO memory buffer into destination CPUBuffer instance
@@ -258,7 +493,9 @@ ManagedPBO DeepDownloadLayer::pboBlit() {
  * @param pbo Reference to a ManagedPBO instance which wraps the PBO to be read out
  * @param sync Handle of the OpenGL fence sync that indicates when the PBO is ready for readout
  * @param sequence Sequence number that refers to the content in the PBO to be read out
- * @param target Pointer to CPUBuffer where the data should be placed in
+ * @param target Pointer to CPUBuffer where the data should be placed in (\c nullptr when using
+ *               a target ring)
+ * @param slot Index of target ring slot to place the data in, or -1 when using \p target
  * @param callback Callback function in the engine to pass notification about finished download
  *
  * @throw FynException in case the \p sync was not posted on the GL pipeline after less than 5s
@@ -266,7 +503,7 @@ ManagedPBO DeepDownloadLayer::pboBlit() {
  * This function waits for the supplied \p sync to be issued on the GL pipeline in a background
  * thread (to be more precise, it is invoked in the background thread already). Once the sync has
  * been received, the \p pbo will be mapped into memory and the data will be copied to the buffer(s)
- * in #outputs_. After reading the data, two callbacks will be invoked:
+ * in #outputs_ or into the target ring. After reading the data, two callbacks will be invoked:
  *   - \p callback which notifies the engine that the PBO has been read
  *   - #userCallback_ which notifies the API user that the PBO has been read
  *
@@ -274,16 +511,23 @@ ManagedPBO DeepDownloadLayer::pboBlit() {
  *
  * @see UpDownLayerBuilder, Engine::asyncDownloadDone
  */
-void DeepDownloadLayer::readoutPBO(AsyncPool::GLThread& myThread, opengl::ManagedPBO& pbo, GLsync sync, uint64_t sequence, cpu::CPUBuffer * target, const std::function<void(uint64_t)> & callback) {
+void DeepDownloadLayer::readoutPBO(AsyncPool::GLThread& myThread, opengl::ManagedPBO& pbo, GLsync sync, uint64_t sequence, cpu::CPUBuffer * target, int slot, const std::function<void(uint64_t)> & callback) {
     using namespace opengl;
     const GfxContextLink & ctx = myThread.context();
     bool rc = ctx.waitClientSync(sync, 5000000000);        // wait 5s max  (TODO (mw) configurable timeout)
     if (!rc) THROW_EXCEPTION_ARGS(FynException, "Cannot read out texture within 5s for sequence %ld", sequence);
     ctx.removeSync(sync);
-    target->readFromPBO(*pbo, CPUBufferShape::type::FLOAT32, sequence);
-    pbo.clearPending();
-    if (callback) callback(sequence);
-    if (userCallback_) userCallback_(sequence, target, AsyncLayer::DOWNLOAD_DONE);
+    if (slot >= 0) {
+        ringReadout(slot, pbo);
+        if (*pbo) pbo.clearPending();
+        if (callback) callback(sequence);
+        ring_->notify(sequence, slot, AsyncLayer::DOWNLOAD_DONE);
+    } else {
+        target->readFromPBO(*pbo, (transferType_ == GL_HALF_FLOAT) ? CPUBufferShape::type::FLOAT16 : CPUBufferShape::type::FLOAT32, sequence);
+        pbo.clearPending();
+        if (callback) callback(sequence);
+        if (userCallback_) userCallback_(sequence, target, AsyncLayer::DOWNLOAD_DONE);
+    }
     asyncLock_.lock();
     auto it = threads_.find(sequence);
     assert(it != threads_.end());
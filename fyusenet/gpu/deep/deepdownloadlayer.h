@@ -32,6 +32,7 @@
 #include "../../cpu/cpubuffer.h"
 #include "../../cpu/cpulayerinterface.h"
 #include "../updownlayerbuilder.h"
+#include "../targetring.h"
 
 //------------------------------------- Public Declarations ----------------------------------------
 namespace fyusion {
@@ -85,7 +86,14 @@ namespace deep {
  * to be performed on the buffer, those should be relayed to a different thread if performance
  * is of the essence.
  *
- * @see Engine::asyncDownloadDone, UpDownLayerBuilder
+ * As an alternative to the CPUBuffer output, a ring of caller-owned memory regions can be
+ * registered using setTargetRing(). In that case the tiled data is copied from the (mapped) %PBO
+ * directly into the next region of the ring and optionally de-tiled on the fly.
+ *
+ * When UpDownLayerBuilder::fp16Transfer() is set, the texture data is read back as half-precision
+ * data and expanded to single-precision on the CPU while copying it out of the %PBO.
+ *
+ * @see Engine::asyncDownloadDone, UpDownLayerBuilder, TargetRing
  */
 class DeepDownloadLayer : public DeepLayerBase, public cpu::CPULayerInterface, public DownloadLayerInterface, public AsyncLayer {
     friend class fyusion::fyusenet::Engine;
@@ -100,6 +108,7 @@ class DeepDownloadLayer : public DeepLayerBase, public cpu::CPULayerInterface, p
     // Public methods
     // ------------------------------------------------------------------------
     virtual void setup() override;
+    virtual void cleanup() override;
     virtual void forward(uint64_t sequence) override;
 #ifdef FYUSENET_MULTITHREADING
     virtual void asyncForward(uint64_t sequence, const std::function<void(uint64_t)>& callback) override;
@@ -112,6 +121,21 @@ class DeepDownloadLayer : public DeepLayerBase, public cpu::CPULayerInterface, p
     virtual void clearOutputBuffers(int port = -1) override;
     virtual void wait(uint64_t sequenceNo) override;
     void updateOutputBuffer(CPUBuffer *buf, int port=0);
+    void setTargetRing(const std::vector<void *>& buffers, size_t bytes,
+                       BufferSpec::order order = BufferSpec::order::CHANNELWISE,
+                       const TargetRing::callback& notify = TargetRing::callback());
+    void clearTargetRing();
+    size_t targetBytes(BufferSpec::order order = BufferSpec::order::CHANNELWISE) const;
+
+    /**
+     * @brief Check if a ring of caller-owned download targets has been set
+     *
+     * @retval true if downloads are written into a TargetRing
+     * @retval false if downloads are written into the output CPUBuffer
+     */
+    bool hasTargetRing() const {
+        return (ring_ != nullptr);
+    }
 
     /**
      * @brief Check if download layer is asynchronous
@@ -123,6 +147,15 @@ class DeepDownloadLayer : public DeepLayerBase, public cpu::CPULayerInterface, p
         return async_;
     }
 
+    /**
+     * @brief Check if the GL commands issued by forward() may be recorded and replayed
+     *
+     * @retval false always, as this layer transfers data between CPU and GPU
+     */
+    virtual bool isRecordable() const override {
+        return false;
+    }
+
     /**
      * @brief Get input buffer
      *
@@ -170,15 +203,20 @@ class DeepDownloadLayer : public DeepLayerBase, public cpu::CPULayerInterface, p
     virtual void setupFBOs() override;
     virtual void updateFBOs() override;
 #ifdef FYUSENET_MULTITHREADING
-    void readoutPBO(AsyncPool::GLThread& myThread, opengl::ManagedPBO& pbo, GLsync sync, uint64_t sequence, cpu::CPUBuffer *target, const std::function<void(uint64_t)> & callback);
+    void readoutPBO(AsyncPool::GLThread& myThread, opengl::ManagedPBO& pbo, GLsync sync, uint64_t sequence, cpu::CPUBuffer *target, int slot, const std::function<void(uint64_t)> & callback);
 #endif
     ManagedPBO pboBlit();
+    int ringBlit(uint64_t sequence, opengl::ManagedPBO& pbo);
+    void ringReadout(int slot, opengl::ManagedPBO& pbo);
     // ------------------------------------------------------------------------
     // Member variables
     // ------------------------------------------------------------------------
-    uint8_t bytesPerChan_ = 4;                        //!< Number of bytes per channel (defaults to 4 bytes for a single-precision floating point number)
+    uint8_t bytesPerChan_ = 4;                        //!< Number of bytes per channel in the output (defaults to 4 bytes for a single-precision floating point number)
+    uint8_t transferBytes_ = 4;                       //!< Number of bytes per channel in the %PBO (2 for half-precision transfers)
+    GLenum transferType_ = GL_FLOAT;                  //!< Data type that is read from the FBO into the %PBO
     bool async_ = false;                              //!< Indicator if this is an asynchronous download layer
     std::vector<cpu::CPUBuffer *> outputs_;           //!< Output CPU buffer(s)
+    TargetRing * ring_ = nullptr;                     //!< Optional ring of caller-owned target memory which replaces #outputs_
     /**
      * Optional user callback function for asynchronous operation
      */
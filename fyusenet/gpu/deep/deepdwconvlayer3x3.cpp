@@ -45,6 +45,7 @@ namespace deep {
 DeepDepthwiseConvLayer3x3::DeepDepthwiseConvLayer3x3(const ConvLayerBuilder& builder,int layerNumber):DeepDepthwiseConvLayerBase(builder, layerNumber) {
     assert(inputChannels_ == outputChannels_);
     assert(builder.kernel_ == 3);
+    assert((dilation_[0] <= 7) && (dilation_[1] <= 7));
 }
 
 
@@ -72,30 +73,30 @@ void DeepDepthwiseConvLayer3x3::forward(uint64_t sequence) {
 #endif    
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_BLEND);
-    glViewport(0,0,viewport_[0],viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    applyOutputViewport();
     vertexArray_->bind();
     framebuffers_.at(0)->bind();
     framebuffers_.at(0)->setWriteMask();
-    glClearColor(0.0f,0.0f,0.0f,0.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
-    glActiveTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
-    glBindTexture(GL_TEXTURE_2D,weightTexture_);
-    glActiveTexture(GL_TEXTURE0+BIAS_TEXTURE);
-    glBindTexture(GL_TEXTURE_2D,biasTexture_);
+    GLState::clearColor(0.0f,0.0f,0.0f,0.0f);
+    clearOutput(GL_COLOR_BUFFER_BIT);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D,weightTexture_);
+    GLState::activeTexture(GL_TEXTURE0+BIAS_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D,biasTexture_);
     if (flags_ & LayerFlags::RESIDUAL_INPUT) {
         if (residualTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"Residual flag configured, but no such texture found.");
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D,residualTextures_.at(0));
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D,residualTextures_.at(0));
     }
     int tris = tiler_->numOutputTiles();
     shader_->bind(shaderState_.get());
-    glDrawElements(GL_TRIANGLES,tris*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
+    GLState::drawElements(GL_TRIANGLES,tris*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
     shader_->unbind();
     framebuffers_.at(0)->unbind();
     vertexArray_->unbind();
@@ -49,10 +49,9 @@ namespace deep {
  * denoted as "depthwise separable convolution", a technique which has been popularized by
  * "MobileNets"
  *
- * @todo Generalize this to NxN convolutions
+ * @see DeepDepthwiseConvLayerNxN for other kernel sizes, large dilations and fused pointwise convolutions
  */
 class DeepDepthwiseConvLayer3x3 : public DeepDepthwiseConvLayerBase {
-    // TODO (mw) generalize this to NxN convolutions
  public:
     // ------------------------------------------------------------------------
     // Constructor / Destructor
@@ -64,6 +63,13 @@ class DeepDepthwiseConvLayer3x3 : public DeepDepthwiseConvLayerBase {
     // ------------------------------------------------------------------------
     virtual void forward(uint64_t sequence) override;
     virtual void cleanup() override;
+
+    /**
+     * @copydoc GPULayerBase::supportsOutputView
+     */
+    virtual bool supportsOutputView() const override {
+        return true;
+    }
  protected:
     // ------------------------------------------------------------------------
     // Non-public methods
@@ -0,0 +1,419 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Depthwise NxN Convolutional Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/glinfo.h"
+#include "../../gl/glexception.h"
+#include "../../common/logging.h"
+#include "../floatconversion.h"
+#include "deepdwconvlayerNxN.h"
+
+//-------------------------------------- Global Variables ------------------------------------------
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+DeepDepthwiseConvLayerNxN::DeepDepthwiseConvLayerNxN(const ConvLayerBuilder & builder, int layerNumber) : DeepDepthwiseConvLayerBase(builder, layerNumber) {
+    if (!isSupported(builder)) THROW_EXCEPTION_ARGS(FynException,"Unsupported depthwise convolution parameters for layer %s", getName().c_str());
+    pointwise_ = builder.pointwise_;
+    pointwiseAct_ = builder.pointwiseAct_;
+    if (pointwise_) {
+        depthwiseTiles_ = tiler_->numInputTiles();
+        int width = tiler_->getOutputWidth();
+        int height = tiler_->getOutputHeight();
+        intermediateColumns_ = std::max(1, (int)ceilf(sqrtf((float)depthwiseTiles_ * (float)height / (float)width)));
+        intermediateColumns_ = std::min(intermediateColumns_, depthwiseTiles_);
+        intermediateSize_[0] = intermediateColumns_ * width;
+        intermediateSize_[1] = ((depthwiseTiles_ + intermediateColumns_ - 1) / intermediateColumns_) * height;
+        if (std::max(intermediateSize_[0], intermediateSize_[1]) > GLInfo::getMaximumTextureSize()) {
+            THROW_EXCEPTION_ARGS(FynException,"Intermediate depthwise result does not fit into GL texture (layer %s)", getName().c_str());
+        }
+    } else {
+        depthwiseTiles_ = tiler_->numOutputTiles();
+    }
+}
+
+
+/**
+ * @copydoc GPULayerBase::cleanup
+ */
+void DeepDepthwiseConvLayerNxN::cleanup() {
+    delete intermediateFBO_;
+    intermediateFBO_ = nullptr;
+    if (pointwiseWeights_) GLState::deleteTextures(1, &pointwiseWeights_);
+    if (depthwiseBias_) GLState::deleteTextures(1, &depthwiseBias_);
+    pointwiseWeights_ = 0;
+    depthwiseBias_ = 0;
+    shaderState_.reset();
+    pointwiseState_.reset();
+    shader_.reset();
+    pointwiseShader_.reset();
+    DeepDepthwiseConvLayerBase::cleanup();
+}
+
+
+/**
+ * @brief Check if a depthwise convolution can be computed by this class
+ *
+ * @param builder Builder that contains the convolution parameters
+ *
+ * @retval true if the convolution parameters are supported by this class
+ * @retval false otherwise
+ *
+ * Supported are depthwise convolutions with odd kernel sizes up to #MAX_KERNEL, a stride (i.e.
+ * downsampling factor) of 1 or 2 along each axis and arbitrary dilation. Channel multipliers
+ * larger than 1 are supported for plain depthwise convolutions only, upsampling and fractional
+ * steps are not supported.
+ */
+bool DeepDepthwiseConvLayerNxN::isSupported(const ConvLayerBuilder & builder) {
+    if ((builder.groupSize_ == 1) || (builder.groupSize_ != builder.in())) return false;
+    if (((builder.kernel_ & 1) == 0) || (builder.kernel_ < 3) || (builder.kernel_ > MAX_KERNEL)) return false;
+    for (int i=0; i < 2; i++) {
+        if ((builder.downsample_[i] < 1) || (builder.downsample_[i] > 2)) return false;
+        if ((builder.upsample_[i] != 1) || (builder.dilation_[i] < 1)) return false;
+    }
+    if (builder.sourceStep_ != 1.f) return false;
+    if ((builder.arrayInput_) || (builder.arrayOutput_)) return false;
+    if ((!builder.pointwise_) && (builder.out() % builder.in())) return false;
+    return true;
+}
+
+
+/**
+ * @brief Read weights and biases from raw data and store them into textures
+ *
+ * @param biasAndWeights Pointer to array with bias and weight values (see long description)
+ * @param offset Optional offset (in floating-point elements) into \p biasAndWeights where to
+ *               start reading from
+ *
+ * For a plain depthwise convolution, the data layout is the same as for the other depthwise
+ * layers (see DeepDepthwiseConvLayerBase::loadWeightsAndBiases). With a fused pointwise
+ * convolution, the data layout is described in ConvLayerBuilderTempl::pointwise().
+ *
+ * The depthwise weights are stored in a texture that has one row per depthwise output tile and
+ * one RGBA texel per kernel tap, which holds the weights of the 4 channels of that tile. The
+ * pointwise weights are stored with one row per output tile and 4 texels per depthwise tile,
+ * which represent the columns of the 4x4 weight matrix between the two tiles. In case half
+ * precision is used, two texels are packed into one 32-bit integer RGBA texel each.
+ */
+void DeepDepthwiseConvLayerNxN::loadWeightsAndBiases(const float *biasAndWeights, size_t offset) {
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    const int taps = kernel_ * kernel_;
+    const int dwchannels = inputChannels_ * channelMultiplier_;
+    const float * src = biasAndWeights + offset;
+    //------------------------------------------------------
+    // Depthwise weights, one row per depthwise tile...
+    //------------------------------------------------------
+    int width = taps + (taps & 1);
+    float * weights = new float[width * depthwiseTiles_ * PIXEL_PACKING];
+    memset(weights, 0, width * depthwiseTiles_ * PIXEL_PACKING * sizeof(float));
+    for (int tile=0; tile < depthwiseTiles_; tile++) {
+        for (int c=0; c < PIXEL_PACKING; c++) {
+            int chan = tile * PIXEL_PACKING + c;
+            if (chan >= dwchannels) break;
+            int mult = chan / inputChannels_;
+            int inchan = chan % inputChannels_;
+            for (int tap=0; tap < taps; tap++) {
+                weights[(tile * width + tap) * PIXEL_PACKING + c] = src[dwchannels + (inchan * taps + tap) * channelMultiplier_ + mult];
+            }
+        }
+    }
+    if (!weightTexture_) glGenTextures(1, &weightTexture_);
+    uploadPackedWeights(weightTexture_, weights, width, depthwiseTiles_);
+    delete [] weights;
+    if (!pointwise_) {
+        loadBiasAndBatchnorm(biasAndWeights, offset, (size_t)(taps * dwchannels));
+        return;
+    }
+    //------------------------------------------------------
+    // Fused pointwise part, first the depthwise biases...
+    //------------------------------------------------------
+    float * bias = new float[(depthwiseTiles_ + 1) * PIXEL_PACKING];
+    memset(bias, 0, (depthwiseTiles_ + 1) * PIXEL_PACKING * sizeof(float));
+    memcpy(bias + PIXEL_PACKING, src, inputChannels_ * sizeof(float));
+    if (!depthwiseBias_) glGenTextures(1, &depthwiseBias_);
+    GLState::bindTexture(GL_TEXTURE_2D, depthwiseBias_);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, (highPrecision_) ? GL_RGBA32F : GL_RGBA16F, depthwiseTiles_ + 1, 1, 0, GL_RGBA, GL_FLOAT, bias);
+    delete [] bias;
+    //------------------------------------------------------
+    // ...then the pointwise weights and the biases/BN of
+    // the layer output
+    //------------------------------------------------------
+    size_t pwoffset = offset + inputChannels_ + taps * inputChannels_;
+    const float * pwsrc = biasAndWeights + pwoffset + outputChannels_;
+    int outtiles = tiler_->numOutputTiles();
+    width = depthwiseTiles_ * PIXEL_PACKING;
+    weights = new float[width * outtiles * PIXEL_PACKING];
+    memset(weights, 0, width * outtiles * PIXEL_PACKING * sizeof(float));
+    for (int out=0; out < outputChannels_; out++) {
+        int tile = out / PIXEL_PACKING;
+        int c = out % PIXEL_PACKING;
+        for (int in=0; in < inputChannels_; in++) {
+            weights[(tile * width + in) * PIXEL_PACKING + c] = pwsrc[out * inputChannels_ + in];
+        }
+    }
+    if (!pointwiseWeights_) glGenTextures(1, &pointwiseWeights_);
+    uploadPackedWeights(pointwiseWeights_, weights, width, outtiles);
+    delete [] weights;
+    loadBiasAndBatchnorm(biasAndWeights, pwoffset, (size_t)(outputChannels_ * inputChannels_));
+}
+
+
+/**
+ * @copydoc LayerBase::forward
+ */
+void DeepDepthwiseConvLayerNxN::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    vertexArray_->bind();
+    if (flags_ & LayerFlags::RESIDUAL_INPUT) {
+        if (residualTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"Residual flag configured, but no such texture found.");
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, residualTextures_.at(0));
+    }
+    //------------------------------------------------------
+    // Depthwise convolution, either to the output or to the
+    // intermediate texture...
+    //------------------------------------------------------
+    if (pointwise_) {
+        GLState::viewport(0, 0, intermediateSize_[0], intermediateSize_[1]);
+        intermediateFBO_->bind();
+        intermediateFBO_->setWriteMask();
+    } else {
+        GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+        framebuffers_.at(0)->bind();
+        framebuffers_.at(0)->setWriteMask();
+    }
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D, weightTexture_);
+    GLState::activeTexture(GL_TEXTURE0+BIAS_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D, (pointwise_) ? depthwiseBias_ : biasTexture_);
+    shader_->bind(shaderState_.get());
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    shader_->unbind(pointwise_);
+    //------------------------------------------------------
+    // ...and the optional pointwise convolution
+    //------------------------------------------------------
+    if (pointwise_) {
+        intermediateFBO_->unbind();
+        GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+        framebuffers_.at(0)->bind();
+        framebuffers_.at(0)->setWriteMask();
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, intermediateFBO_->getAttachment());
+        GLState::activeTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
+        GLState::bindTexture(GL_TEXTURE_2D, pointwiseWeights_);
+        GLState::activeTexture(GL_TEXTURE0+BIAS_TEXTURE);
+        GLState::bindTexture(GL_TEXTURE_2D, biasTexture_);
+        pointwiseShader_->bind(pointwiseState_.get());
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        pointwiseShader_->unbind();
+    }
+    framebuffers_.at(0)->unbind();
+    vertexArray_->unbind();
+}
+
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+
+/**
+ * @brief Setup proxy polygon for the render passes
+ *
+ * @param vao Pointer to vertex array object that the resulting VBO and IBO are tied to
+ *
+ * @pre The supplied \p vao vertex array object to be used with this VBO is already bound
+ *
+ * Both render passes use a single polygon that covers the full viewport, the shaders compute
+ * the tile and pixel positions from the fragment coordinates.
+ */
+void DeepDepthwiseConvLayerNxN::setupNetworkPolygons(VAO *vao) {
+    float attrs0[4*4] = {-1.f, -1.f, 0.f, 0.f,
+                          1.f, -1.f, 1.f, 0.f,
+                          1.f,  1.f, 1.f, 1.f,
+                         -1.f,  1.f, 0.f, 1.f};
+    GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+    vertexBuffer_ = new VBO(context_);
+    vao->enableArray(0);
+    vertexBuffer_->setBufferData(attrs0, sizeof(attrs0), GL_STATIC_DRAW);
+    vertexBuffer_->bind();
+    vao->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    indexBuffer_ = new IBO(context_);
+    indexBuffer_->setBufferData(indices, sizeof(indices), GL_STATIC_DRAW);
+    indexBuffer_->bind();
+}
+
+
+/**
+ * @brief Compile shaders that implement the actual layer functionality
+ *
+ * This assembles the preprocessor definitions for the tensor geometry and the kernel, which are
+ * shared by both render passes. In contrast to the other convolution layers, dilation is passed
+ * per axis.
+ */
+void DeepDepthwiseConvLayerNxN::setupShaders() {
+    char preproc[1024] = {0};
+    snprintf(preproc, sizeof(preproc),
+             "#define WEIGHT_UNIT %d\n#define BIAS_UNIT %d\n#define KERNEL %d\n"
+             "#define DILATION_X %d\n#define DILATION_Y %d\n#define STRIDE_X %d\n#define STRIDE_Y %d\n"
+             "#define IN_TILES %d\n#define IN_TILES_X %d\n#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n"
+             "#define OUT_WIDTH %d\n#define OUT_HEIGHT %d\n#define RES_PAD %d\n",
+             WEIGHT_TEXTURE, BIAS_TEXTURE, kernel_, dilation_[0], dilation_[1], downsample_[0], downsample_[1],
+             tiler_->numInputTiles(), tiler_->numInputTiles(DeepTiler::HORIZONTAL), tiler_->getInputWidth(),
+             tiler_->getInputHeight(), inputPadding_, tiler_->getOutputWidth(), tiler_->getOutputHeight(), residualPadding_);
+    compileConvolutionShaders(preproc);
+}
+
+
+/**
+ * @copydoc DeepConvLayerBase::compileConvolutionShaders
+ */
+void DeepDepthwiseConvLayerNxN::compileConvolutionShaders(const char *preproc) {
+    char finalpreproc[2048] = {0};
+    char extra[256] = {0};
+    layerflags dwflags = flags_;
+    strncpy(finalpreproc, preproc, sizeof(finalpreproc)-1);
+    if (pointwise_) {
+        // NOTE batchnorm and residual are applied to the output of the pointwise pass
+        dwflags &= ~(LayerFlags::RESIDUAL_INPUT | LayerFlags::POST_BATCHNORM | LayerFlags::RELU_ON_RESIDUAL | LayerFlags::BATCHNORM_ON_RESIDUAL);
+        snprintf(extra, sizeof(extra), "#define OUT_TILES %d\n#define OUT_TILES_X %d\n#define OUT_PAD 0\n", depthwiseTiles_, intermediateColumns_);
+        if (pointwiseAct_ == ActType::RELU) {
+            strncat(extra, "#define INTER_RELU\n", sizeof(extra) - strlen(extra) - 1);
+        } else if (pointwiseAct_ == ActType::CLIP) {
+            snprintf(extra + strlen(extra), sizeof(extra) - strlen(extra), "#define INTER_CLIP\n#define INTER_CLIP_LOW %f\n#define INTER_CLIP_HIGH %f\n", lowClip_, highClip_);
+        }
+    } else {
+        snprintf(extra, sizeof(extra), "#define OUT_TILES %d\n#define OUT_TILES_X %d\n#define OUT_PAD %d\n", depthwiseTiles_, tiler_->numOutputTiles(DeepTiler::HORIZONTAL), outputPadding_);
+    }
+    strncat(finalpreproc, extra, sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    handlePreprocFlags(dwflags, finalpreproc, sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    shader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepconv_dwNxN.frag", finalpreproc, typeid(this));
+    shaderPostprocessing(shader_);
+    shaderState_ = UniformState::makeShared(shader_);
+    if (!GLInfo::hasBinding()) {
+        shaderState_->setUniformValue("inputLayer0", 0);
+        shaderState_->setUniformValue("residualLayer0", 1, true);
+        shaderState_->setUniformValue("inputCoeffs", WEIGHT_TEXTURE);
+        shaderState_->setUniformValue("biasTexture", BIAS_TEXTURE);
+    }
+    if (!pointwise_) return;
+    strncpy(finalpreproc, preproc, sizeof(finalpreproc)-1);
+    snprintf(extra, sizeof(extra), "#define OUT_TILES %d\n#define OUT_TILES_X %d\n#define OUT_PAD %d\n#define DW_TILES %d\n#define DW_TILES_X %d\n",
+             tiler_->numOutputTiles(), tiler_->numOutputTiles(DeepTiler::HORIZONTAL), outputPadding_, depthwiseTiles_, intermediateColumns_);
+    strncat(finalpreproc, extra, sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    handlePreprocFlags((layerflags)(flags_ & ~(LayerFlags::PRE_RELU | LayerFlags::PRE_CLIP)), finalpreproc, sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    pointwiseShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepconv_dw_pointwise.frag", finalpreproc, typeid(this));
+    shaderPostprocessing(pointwiseShader_);
+    pointwiseState_ = UniformState::makeShared(pointwiseShader_);
+    if (!GLInfo::hasBinding()) {
+        pointwiseState_->setUniformValue("inputLayer0", 0);
+        pointwiseState_->setUniformValue("residualLayer0", 1, true);
+        pointwiseState_->setUniformValue("inputCoeffs", WEIGHT_TEXTURE);
+        pointwiseState_->setUniformValue("biasTexture", BIAS_TEXTURE);
+    }
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ *
+ * With a fused pointwise convolution, this also creates the %FBO for the intermediate depthwise
+ * result, which uses an internal texture with the precision of the layer.
+ */
+void DeepDepthwiseConvLayerNxN::setupFBOs() {
+    DeepDepthwiseConvLayerBase::setupFBOs();
+    if ((pointwise_) && (!intermediateFBO_)) {
+        opengl::Texture::pixtype type = (highPrecision_) ? opengl::Texture::FLOAT32 : opengl::Texture::FLOAT16;
+        intermediateFBO_ = new FBO(context_, intermediateSize_[0], intermediateSize_[1], PIXEL_PACKING, type);
+    }
+}
+
+
+/**
+ * @brief Upload weights to a texture, using packed half-precision storage where available
+ *
+ * @param texture GL texture handle to store the weights to
+ * @param weights Pointer to weight data with 4 values per texel
+ * @param width Width of the weight data (in texels), must be even
+ * @param height Height of the weight data (in texels)
+ *
+ * @throws FynException in case the weights do not fit into a texture
+ *
+ * If half-precision weights are used, two texels are packed into one integer texel, which halves
+ * the texture width.
+ */
+void DeepDepthwiseConvLayerNxN::uploadPackedWeights(GLuint texture, float *weights, int width, int height) {
+    assert((width & 1) == 0);
+    int texwidth = (halfSupport_) ? width / 2 : width;
+    if ((texwidth > GLInfo::getMaximumTextureSize()) || (height > GLInfo::getMaximumTextureSize())) {
+        THROW_EXCEPTION_ARGS(FynException,"Weights do not fit into GL texture");
+    }
+    GLState::bindTexture(GL_TEXTURE_2D, texture);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    if (halfSupport_) {
+        unsigned int * fp16 = FloatConversion::getInstance()->toFP16UI(weights, width * height * PIXEL_PACKING);
+#ifdef GL_RGBA32UI
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI, texwidth, height, 0, GL_RGBA_INTEGER, GL_UNSIGNED_INT, fp16);
+#else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI_EXT, texwidth, height, 0, GL_RGBA_INTEGER_EXT, GL_UNSIGNED_INT, fp16);
+#endif
+        delete [] fp16;
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, (highPrecision_) ? GL_RGBA32F : GL_RGBA16F, texwidth, height, 0, GL_RGBA, GL_FLOAT, weights);
+    }
+}
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
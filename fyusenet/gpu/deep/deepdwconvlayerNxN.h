@@ -0,0 +1,107 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Depthwise NxN Convolutional Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/fbo.h"
+#include "../../gl/shaderprogram.h"
+#include "../../gl/uniformstate.h"
+#include "../gfxcontextlink.h"
+#include "../../base/bufferspec.h"
+#include "deepdwconvlayerbase.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+/**
+ * @brief Depthwise convolution layer for odd-sized NxN kernels on deep-format tensors
+ *
+ * This class implements depthwise convolutions with arbitrary odd kernel sizes (up to
+ * #MAX_KERNEL), optional dilation and strides of 1 or 2, which covers the depthwise blocks found
+ * in MobileNet or EfficientNet type networks. The kernel size is supplied as shader define, the
+ * fragment shader loops over the kernel taps and fetches the weights for each tap from a small
+ * texture that stores one row of 4-channel weights per output tile. As a depthwise convolution
+ * only touches each input element once per kernel tap, it is bandwidth-bound and the weight
+ * fetches (which are the same for all fragments of a tile) are served from the texture cache.
+ *
+ * The shader is driven by a single polygon that covers the whole output texture and derives the
+ * tile and pixel position from the fragment coordinates. Kernel taps that fall outside of the
+ * input tile are skipped, which means that the layer does not depend on the input padding for
+ * the zero-padding of the convolution.
+ *
+ * Optionally, a pointwise (1x1) convolution can be fused into the layer (see
+ * ConvLayerBuilderTempl::pointwise()). In that case, the depthwise result is rendered into a
+ * layer-internal texture and a second pass computes the pointwise convolution from it, such that
+ * the intermediate tensor never has to be managed by the network. The pointwise pass loops over
+ * all intermediate tiles in the fragment shader instead of accumulating by blending.
+ *
+ * @see DeepDepthwiseConvLayer3x3, ConvLayerBuilderTempl::pointwise()
+ */
+class DeepDepthwiseConvLayerNxN : public DeepDepthwiseConvLayerBase {
+ public:
+    constexpr static int MAX_KERNEL = 9;
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepDepthwiseConvLayerNxN(const ConvLayerBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void forward(uint64_t sequence) override;
+    virtual void cleanup() override;
+    virtual void loadWeightsAndBiases(const float *biasAndWeights, size_t offset=0) override;
+
+    static bool isSupported(const ConvLayerBuilder & builder);
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    virtual void setupNetworkPolygons(VAO *vao) override;
+    virtual void setupShaders() override;
+    virtual void compileConvolutionShaders(const char *preproc) override;
+    virtual void setupFBOs() override;
+    void uploadPackedWeights(GLuint texture, float *weights, int width, int height);
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    programptr shader_;                     //!< Shader program for the depthwise convolution
+    programptr pointwiseShader_;            //!< Shader program for the fused pointwise convolution
+    unistateptr shaderState_;               //!< Uniform-variable state for #shader_
+    unistateptr pointwiseState_;            //!< Uniform-variable state for #pointwiseShader_
+    bool pointwise_ = false;                //!< Indicator that a pointwise convolution is fused into this layer
+    ActType pointwiseAct_ = ActType::NONE;  //!< Activation applied to the depthwise result prior to the pointwise convolution
+    int depthwiseTiles_ = 0;                //!< Number of tiles in the depthwise result
+    int intermediateColumns_ = 0;           //!< Number of tiles per row in the intermediate texture
+    int intermediateSize_[2] = {0, 0};      //!< Width and height of the intermediate texture
+    FBO * intermediateFBO_ = nullptr;       //!< %FBO (with internal texture) that stores the depthwise result for the pointwise pass
+    GLuint pointwiseWeights_ = 0;           //!< Texture with the pointwise convolution weights
+    GLuint depthwiseBias_ = 0;              //!< Texture with the depthwise biases when a pointwise convolution is fused
+};
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
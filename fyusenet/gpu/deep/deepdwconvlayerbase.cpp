@@ -38,7 +38,10 @@ namespace deep {
  * @copydoc GPULayerBase::GPULayerBase
  */
 DeepDepthwiseConvLayerBase::DeepDepthwiseConvLayerBase(const ConvLayerBuilder & builder, int layerNumber):DeepConvLayerBase(builder, layerNumber) {
-    channelMultiplier_ = outputChannels_/builder.groupSize_;
+    // NOTE depthwise convolutions use their own weight layout, which is not quantized
+    quantizedWeights_ = false;
+    // NOTE with a fused pointwise convolution, the output channels refer to the pointwise part
+    channelMultiplier_ = (builder.pointwise_) ? 1 : outputChannels_/builder.groupSize_;
     if (channelMultiplier_ > 1) {
         if (inputChannels_ & 3) THROW_EXCEPTION_ARGS(FynException,"Channel multipliers > 1 are only supported on input channels being a multiple of 4");
     }
@@ -95,47 +98,10 @@ DeepDepthwiseConvLayerBase::DeepDepthwiseConvLayerBase(const ConvLayerBuilder &
 void DeepDepthwiseConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t offset) {
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (!weightTexture_) glGenTextures(1,&weightTexture_);
-    glBindTexture(GL_TEXTURE_2D,weightTexture_);
+    GLState::bindTexture(GL_TEXTURE_2D,weightTexture_);
     const float * srcweights = biasAndWeights + offset + outputChannels_;
     createWeightTextureMatrix(srcweights, 0, weightTexture_);
-    // TODO (mw) put into own function -> promote
-    //------------------------------------------------------
-    // If we have the post-BN flag set, store the batchnorm
-    // stuff...
-    //------------------------------------------------------
-    if (flags_ & fyusenet::LayerFlags::POST_BATCHNORM) {
-        int padout = 4*((outputChannels_+3)/4);
-        const float * srcbn = biasAndWeights + outputChannels_ + offset + kernel_*kernel_*inputChannels_*channelMultiplier_;
-        postBNScales_ = new float[padout];
-        postBNBias_ = new float[padout];
-        memset(postBNScales_,0,padout*sizeof(float));
-        memset(postBNBias_,0,padout*sizeof(float));
-        memcpy(postBNScales_, srcbn, outputChannels_*sizeof(float));
-        memcpy(postBNBias_, srcbn+outputChannels_, outputChannels_*sizeof(float));
-    }
-    //------------------------------------------------------
-    // Now for the bias part (and also batchnorm)...
-    //------------------------------------------------------
-    int bs = PIXEL_PACKING*(1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING);
-    if (flags_ & LayerFlags::POST_BATCHNORM) bs *= 2;
-    float * bias = new float[bs];
-    memset(bias,0,bs*sizeof(float));
-    memcpy(bias+PIXEL_PACKING,biasAndWeights+offset,outputChannels_*sizeof(float));
-    // load batchnorm scale and bias if necessary
-    if (flags_ & LayerFlags::POST_BATCHNORM) {
-        for (int i=0;i<outputChannels_;i++) {
-            bias[PIXEL_PACKING+i] = bias[PIXEL_PACKING+i] * postBNScales_[i] + postBNBias_[i];
-            bias[PIXEL_PACKING+(bs/2)+i] = postBNScales_[i];
-        }
-    }
-    if (!biasTexture_) glGenTextures(1,&biasTexture_);
-    glBindTexture(GL_TEXTURE_2D,biasTexture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA16F,1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING,(flags_ & LayerFlags::POST_BATCHNORM) ? 2 : 1,0,GL_RGBA,GL_FLOAT,bias);
-    delete [] bias;
+    loadBiasAndBatchnorm(biasAndWeights, offset, (size_t)(kernel_*kernel_*inputChannels_*channelMultiplier_));
 }
 
 
@@ -214,7 +180,6 @@ void DeepDepthwiseConvLayerBase::createWeightTextureMatrix(const float *srcWeigh
     int texwidth = chanblocks * (kernel_ + (winrem & 1));
     if (texwidth & 1) texwidth++;
     int texheight = winmax * channelMultiplier_;
-#ifndef HIGH_PRECISION
     if (halfSupport_) {
         if (((texwidth / 2) > GLInfo::getMaximumTextureSize()) || (texheight > GLInfo::getMaximumTextureSize())) {
             THROW_EXCEPTION_ARGS(FynException,"Weights do not fit into GL texture");
@@ -224,11 +189,6 @@ void DeepDepthwiseConvLayerBase::createWeightTextureMatrix(const float *srcWeigh
             THROW_EXCEPTION_ARGS(FynException,"Weights do not fit into GL texture");
         }
     }
-#else
-    if ((texwidth > GLInfo::getMaximumTextureSize()) || (texheight > GLInfo::getMaximumTextureSize())) {
-        THROW_EXCEPTION_ARGS(FynException,"Weights do not fit into GL texture");
-    }
-#endif
     float * weights = new float[texwidth*texheight*PIXEL_PACKING];
     memset(weights,0,texwidth*texheight*PIXEL_PACKING*sizeof(float));
     for (int chan=0 ; chan < channelMultiplier_; chan++) {
@@ -249,12 +209,11 @@ void DeepDepthwiseConvLayerBase::createWeightTextureMatrix(const float *srcWeigh
             }
         }
     }
-    glBindTexture(GL_TEXTURE_2D,weightTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-#ifndef HIGH_PRECISION
+    GLState::bindTexture(GL_TEXTURE_2D,weightTexture);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     if (halfSupport_) {
         unsigned int * fp16 = FloatConversion::getInstance()->toFP16UI(weights,texwidth*texheight*PIXEL_PACKING);
 #ifdef GL_RGBA32UI
@@ -264,11 +223,8 @@ void DeepDepthwiseConvLayerBase::createWeightTextureMatrix(const float *srcWeigh
 #endif
         delete [] fp16;
     } else {
-        glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA16F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
+        glTexImage2D(GL_TEXTURE_2D,0,(highPrecision_) ? GL_RGBA32F : GL_RGBA16F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
     }
-#else
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA32F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
-#endif
     delete [] weights;
 }
 
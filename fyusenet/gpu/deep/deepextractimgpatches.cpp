@@ -92,19 +92,19 @@ void DeepExtractImagePatches::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_BLEND);
-    glViewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
     vertexArray_->bind();
     framebuffers_.at(0)->bind();
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glClear(GL_COLOR_BUFFER_BIT);         // this is to instruct the tile-engine that we don't need the old tile-content
+    GLState::clearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    GLState::clear(GL_COLOR_BUFFER_BIT);         // this is to instruct the tile-engine that we don't need the old tile-content
     shader_->bind(shaderState_.get());
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
-    glDrawElements(GL_TRIANGLES,6*tiler_->numOutputTiles(),GL_UNSIGNED_SHORT,(const GLvoid *)0);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
+    GLState::drawElements(GL_TRIANGLES,6*tiler_->numOutputTiles(),GL_UNSIGNED_SHORT,(const GLvoid *)0);
     framebuffers_.at(0)->unbind();
     vertexArray_->unbind();
     shader_->unbind();
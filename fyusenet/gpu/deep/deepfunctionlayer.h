@@ -60,6 +60,13 @@ class DeepFunctionLayer : public DeepLayerBase {
     virtual void forward(uint64_t sequence) override;
     virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
     virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
+
+    /**
+     * @copydoc GPULayerBase::supportsOutputView
+     */
+    virtual bool supportsOutputView() const override {
+        return true;
+    }
  protected:
     // ------------------------------------------------------------------------
     // Non-public methods
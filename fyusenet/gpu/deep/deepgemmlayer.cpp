@@ -71,58 +71,54 @@ void DeepGEMMLayer::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    if (tiler_->numInputTiles() <= 1) glDisable(GL_BLEND);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    if (tiler_->numInputTiles() <= 1) GLState::disable(GL_BLEND);
     else {
-        glEnable(GL_BLEND);
-        glBlendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
-        glBlendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
+        GLState::enable(GL_BLEND);
+        GLState::blendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
+        GLState::blendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
     }
-    glViewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
     vertexArray_->bind();
     framebuffers_.at(0)->bind();
     framebuffers_.at(0)->setWriteMask();
-    glClearColor(0.0f,0.0f,0.0f,0.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
-    glActiveTexture(GL_TEXTURE0+DISP_TEXTURE);
-    glBindTexture(GL_TEXTURE_2D,inputCoordTexture_);
-    glActiveTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
-    glBindTexture(GL_TEXTURE_2D,weightTexture_);
-    glActiveTexture(GL_TEXTURE0+BIAS_TEXTURE);
-    glBindTexture(GL_TEXTURE_2D,biasTexture_);
+    GLState::clearColor(0.0f,0.0f,0.0f,0.0f);
+    GLState::clear(GL_COLOR_BUFFER_BIT);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE0+DISP_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D,inputCoordTexture_);
+    GLState::activeTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D,weightTexture_);
+    GLState::activeTexture(GL_TEXTURE0+BIAS_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D,biasTexture_);
     if (flags_ & LayerFlags::RESIDUAL_INPUT) {
         if (residualTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"Residual flag configured, but no such texture found.");
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D,residualTextures_.at(0));
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D,residualTextures_.at(0));
     }
     if (usePoints_) {
         int instances = tiler_->numInputTiles();
         int points = tiler_->numOutputTiles();
         shader_->bind(shaderState_.get());
-        shader_->setUniformValue("numInputTiles",tiler_->numInputTiles());
-        glDrawArrays(GL_POINTS, 0, points);
+        GLState::drawArrays(GL_POINTS, 0, points);
         shader_->unbind((instances > 1) ? true : false);
         if (instances > 1) {
             noBiasShader_->bind(noBiasShaderState_.get());
-            noBiasShader_->setUniformValue("numInputTiles",tiler_->numInputTiles());
-            glDrawArraysInstanced(GL_POINTS, 0, points, instances-1);
+            GLState::drawArraysInstanced(GL_POINTS, 0, points, instances-1);
             noBiasShader_->unbind();
         }
     } else {
         int instances = tiler_->numInputTiles()*kernel_;
         int tris = tiler_->numOutputTiles();
         shader_->bind(shaderState_.get());
-        shader_->setUniformValue("numInputTiles",tiler_->numInputTiles());
-        glDrawElements(GL_TRIANGLES,tris*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
+        GLState::drawElements(GL_TRIANGLES,tris*6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
         shader_->unbind((instances > 1) ? true : false);
         if (instances > 1) {
             noBiasShader_->bind(noBiasShaderState_.get());
-            noBiasShader_->setUniformValue("numInputTiles",tiler_->numInputTiles());
-            glDrawElementsInstanced(GL_TRIANGLES,tris*6,GL_UNSIGNED_SHORT,(const GLvoid *)0,instances-1);
+            GLState::drawElementsInstanced(GL_TRIANGLES,tris*6,GL_UNSIGNED_SHORT,(const GLvoid *)0,instances-1);
             noBiasShader_->unbind();
         }
     }
@@ -211,11 +207,11 @@ void DeepGEMMLayer::setupNetworkPolygons(VAO *vao) {
         // direction...
         //---------------------------------------------------------------------------
         glGenTextures(1,&inputCoordTexture_);
-        glBindTexture(GL_TEXTURE_2D,inputCoordTexture_);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+        GLState::bindTexture(GL_TEXTURE_2D,inputCoordTexture_);
+        GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+        GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+        GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+        GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
         float * texdata = new float[tiler_->numInputTiles()*4];
         DeepTiler::Tile defex = tiler_->getDefaultTextureExtents();
         std::vector<DeepTiler::Tile> intiles = tiler_->createInputTiles(0,0);
@@ -266,6 +262,8 @@ unistateptr DeepGEMMLayer::initShader(programptr shader) {
         state->setUniformValue("inputCoeffs",WEIGHT_TEXTURE);
         state->setUniformValue("biasTexture",BIAS_TEXTURE,true);
     }
+    // NOTE constant for the lifetime of the layer, no need to set it on every forward pass
+    state->setUniformValue("numInputTiles",tiler_->numInputTiles(),true);
     return state;
 }
 
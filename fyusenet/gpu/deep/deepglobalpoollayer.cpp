@@ -11,6 +11,7 @@
 
 #include <cstring>
 #include <cassert>
+#include <algorithm>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -45,7 +46,25 @@ DeepGlobalPoolLayer::DeepGlobalPoolLayer(const PoolLayerBuilder & builder,int la
         case PoolLayerBuilder::POOL_AVG:
             mode_ = AVGPOOL;
             break;
-    }    
+    }
+    //------------------------------------------------------
+    // Plan tree reduction for larger spatial extents, each
+    // pass reduces blocks of pixels until the remaining
+    // tiles are small enough for the final pass...
+    //------------------------------------------------------
+    int width = width_;
+    int height = height_;
+    while (std::max(width, height) > SINGLE_PASS_LIMIT) {
+        int block = (std::max(width, height) >= LARGE_REDUCTION_SIZE) ? 8 : 4;
+        ReductionPass pass;
+        pass.blockX = std::min(block, width);
+        pass.blockY = std::min(block, height);
+        pass.width = (width + pass.blockX - 1) / pass.blockX;
+        pass.height = (height + pass.blockY - 1) / pass.blockY;
+        passes_.push_back(pass);
+        width = pass.width;
+        height = pass.height;
+    }
 }
 
 
@@ -54,6 +73,11 @@ DeepGlobalPoolLayer::DeepGlobalPoolLayer(const PoolLayerBuilder & builder,int la
  */
 void DeepGlobalPoolLayer::cleanup() {
     shader_.reset();
+    shaderState_.reset();
+    passShaders_.clear();
+    passStates_.clear();
+    for (FBO * fbo : passFBOs_) delete fbo;
+    passFBOs_.clear();
     DeepPoolingLayer::cleanup();
 }
 
@@ -66,19 +90,39 @@ void DeepGlobalPoolLayer::cleanup() {
  * @copydoc DeepPoolingLayer::beforeRender
  */
 void DeepGlobalPoolLayer::beforeRender() {
-    shader_->bind(shaderState_.get());
-    glDisable(GL_BLEND);
+    if (passes_.empty()) shader_->bind(shaderState_.get());
+    GLState::disable(GL_BLEND);
 }
 
 
 /**
  * @copydoc DeepPoolingLayer::renderChannelBatch
+ *
+ * On multi-pass reduction, this runs all intermediate passes on their own framebuffers and
+ * re-binds the output framebuffer for the final pass.
  */
 void DeepGlobalPoolLayer::renderChannelBatch() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
-    int points = tiler_->numOutputTiles();
-    glDrawArrays(GL_POINTS, 0, points);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
+    if (passes_.empty()) {
+        int points = tiler_->numOutputTiles();
+        GLState::drawArrays(GL_POINTS, 0, points);
+        return;
+    }
+    for (int i=0; i < (int)passes_.size(); i++) {
+        passFBOs_[i]->bindWithViewport();
+        passFBOs_[i]->setWriteMask();
+        passShaders_[i]->bind(passStates_[i].get());
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        passShaders_[i]->unbind(true);
+        passFBOs_[i]->unbind();
+        GLState::bindTexture(GL_TEXTURE_2D, passFBOs_[i]->getAttachment());
+    }
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    framebuffers_.at(0)->bind();
+    framebuffers_.at(0)->setWriteMask();
+    shader_->bind(shaderState_.get());
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
 }
 
 
@@ -87,7 +131,7 @@ void DeepGlobalPoolLayer::renderChannelBatch() {
  */
 void DeepGlobalPoolLayer::afterRender() {
     shader_->unbind();
-    glDisable(GL_BLEND);
+    GLState::disable(GL_BLEND);
 }
 
 
@@ -97,6 +141,37 @@ void DeepGlobalPoolLayer::afterRender() {
 void DeepGlobalPoolLayer::setupShaders() {
     char preproc[1024] = {0};
     handlePreprocFlags(flags_, preproc, sizeof(preproc)-1);
+    if (!passes_.empty()) {
+        //------------------------------------------------------
+        // Multi-pass reduction, only the first pass applies
+        // the activation to the input data...
+        //------------------------------------------------------
+        char passpreproc[1024] = {0};
+        handlePreprocFlags((layerflags)(flags_ & ~(LayerFlags::PRE_RELU | LayerFlags::PRE_CLIP)), passpreproc, sizeof(passpreproc)-1);
+        int columns = tiler_->numInputTiles(DeepTiler::HORIZONTAL);
+        int width = width_, height = height_, pad = inputPadding_;
+        double scale = 1.0;
+        for (int i=0; i < (int)passes_.size(); i++) {
+            const ReductionPass & pass = passes_.at(i);
+            double passscale = 1.0 / (double)(pass.blockX * pass.blockY);
+            programptr shader = compileReductionShader((i == 0) ? preproc : passpreproc, width, height, pad, pass.blockX, pass.blockY,
+                                                       pass.width, pass.height, 0, columns, passscale);
+            passShaders_.push_back(shader);
+            unistateptr state = UniformState::makeShared(shader);
+            state->setUniformValue("inputLayer0", 0);
+            passStates_.push_back(state);
+            scale *= passscale;
+            width = pass.width;
+            height = pass.height;
+            pad = 0;
+        }
+        // NOTE compensate for the normalization in the intermediate passes on average pooling
+        shader_ = compileReductionShader(passpreproc, width, height, 0, width, height, 1, 1, outputPadding_,
+                                         tiler_->numOutputTiles(DeepTiler::HORIZONTAL), 1.0 / (scale * (double)(width_ * height_)));
+        shaderState_ = UniformState::makeShared(shader_);
+        shaderState_->setUniformValue("inputLayer0", 0);
+        return;
+    }
     if (mode_ == AVGPOOL) {
         shader_ = compileShaderPair("shaders/deep/deepdefault.vert","shaders/deep/deepglobavgpool.frag",preproc,typeid(this));
     } else {
@@ -116,7 +191,86 @@ void DeepGlobalPoolLayer::setupShaders() {
 }
 
 
+/**
+ * @brief Compile a shader for a reduction pass
+ *
+ * @param preproc Preprocessor definitions to prepend
+ * @param inWidth Width of the input tiles
+ * @param inHeight Height of the input tiles
+ * @param inPad Padding of the input tiles
+ * @param blockX Horizontal size of the blocks to reduce
+ * @param blockY Vertical size of the blocks to reduce
+ * @param outWidth Width of the output tiles
+ * @param outHeight Height of the output tiles
+ * @param outPad Padding of the output tiles
+ * @param outColumns Number of tile columns in the output texture
+ * @param scale Scaling factor that is applied to the sum (average pooling only)
+ *
+ * @return Shared pointer to linked shader program
+ */
+programptr DeepGlobalPoolLayer::compileReductionShader(const char *preproc, int inWidth, int inHeight, int inPad, int blockX, int blockY,
+                                                       int outWidth, int outHeight, int outPad, int outColumns, double scale) {
+    char finalpreproc[2048] = {0};
+    snprintf(finalpreproc, sizeof(finalpreproc),
+             "%s#define %s\n#define TILES %d\n#define IN_TILES_X %d\n#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n"
+             "#define BLOCK_X %d\n#define BLOCK_Y %d\n#define OUT_WIDTH %d\n#define OUT_HEIGHT %d\n#define OUT_PAD %d\n"
+             "#define OUT_TILES_X %d\n#define SCALE %.10e\n",
+             preproc, (mode_ == AVGPOOL) ? "AVGPOOL" : "MAXPOOL", tiler_->numInputTiles(), tiler_->numInputTiles(DeepTiler::HORIZONTAL),
+             inWidth, inHeight, inPad, blockX, blockY, outWidth, outHeight, outPad, outColumns, scale);
+    programptr shader = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepglobreduce.frag", finalpreproc, typeid(this));
+    try {
+        shader->bindAttributeLocation("attributes0",0);
+        shader->link();
+    } catch (GLException& ex) {
+        FNLOGE("Cannot link shader for layer %s",getName().c_str());
+        throw;
+    }
+    return shader;
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ *
+ * On multi-pass reduction, this also creates the framebuffers for the intermediate results, which
+ * store the tiles of each reduction pass without padding in the same tile arrangement as the
+ * input tensor.
+ */
+void DeepGlobalPoolLayer::setupFBOs() {
+    DeepPoolingLayer::setupFBOs();
+    if (passFBOs_.empty()) {
+        opengl::Texture::pixtype type = (highPrecision_) ? opengl::Texture::FLOAT32 : opengl::Texture::FLOAT16;
+        for (const ReductionPass & pass : passes_) {
+            passFBOs_.push_back(new FBO(context_, pass.width * tiler_->numInputTiles(DeepTiler::HORIZONTAL),
+                                        pass.height * tiler_->numInputTiles(DeepTiler::VERTICAL), PIXEL_PACKING, type));
+        }
+    }
+}
+
+
+/**
+ * @copydoc DeepPoolingLayer::setupNetworkPolygons
+ *
+ * For single-pass pooling, one point per output tile is used. For multi-pass reduction, a single
+ * quad that covers the whole viewport is used for all passes.
+ */
 void DeepGlobalPoolLayer::setupNetworkPolygons(VAO *vao) {
+    if (!passes_.empty()) {
+        float quad[4*4] = {-1.f, -1.f, 0.f, 0.f,
+                            1.f, -1.f, 1.f, 0.f,
+                            1.f,  1.f, 1.f, 1.f,
+                           -1.f,  1.f, 0.f, 1.f};
+        GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+        vertexBuffer_ = new VBO(context_);
+        vao->enableArray(0);
+        vertexBuffer_->setBufferData(quad, sizeof(quad), GL_STATIC_DRAW);
+        vertexBuffer_->bind();
+        vao->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+        indexBuffer_ = new IBO(context_);
+        indexBuffer_->setBufferData(indices, sizeof(indices), GL_STATIC_DRAW);
+        indexBuffer_->bind();
+        return;
+    }
     float * attrs0 = new float[tiler_->numOutputTiles()*4];
     std::vector<DeepTiler::Tile> otiles = tiler_->createOutputTiles();
     std::vector<DeepTiler::Tile> itiles = tiler_->createInputTiles(0,0);
@@ -39,6 +39,14 @@ namespace deep {
  *   - average-pooling
  *
  * The output of this layer is a 1x1xC (C being the channel count of the input tensor) tensor.
+ *
+ * For small spatial extents, a single pass is used where each fragment loops over the full
+ * spatial plane of one tile, which only yields \e C/4 fragments in total. For larger spatial
+ * extents (see #SINGLE_PASS_LIMIT), the pooling is done as tree reduction. Each reduction pass
+ * reduces blocks of 8x8 (or 4x4 for smaller inputs) pixels of all tiles into an intermediate
+ * texture, until the remaining tiles are small enough to be pooled into the output by a final
+ * pass. For average pooling, the intermediate results are normalized by the block size in each
+ * pass to keep them in a numerically safe range for half-precision textures.
  */
 class DeepGlobalPoolLayer : public DeepPoolingLayer {
  public:
@@ -46,6 +54,8 @@ class DeepGlobalPoolLayer : public DeepPoolingLayer {
         MAXPOOL = 0,
         AVGPOOL
     };
+    constexpr static int SINGLE_PASS_LIMIT = 8;       //!< Maximum spatial extent (per axis) that is pooled by a single pass
+    constexpr static int LARGE_REDUCTION_SIZE = 64;   //!< Minimum spatial extent (per axis) for using 8x8 instead of 4x4 reduction blocks
     // ------------------------------------------------------------------------
     // Constructor / Destructor
     // ------------------------------------------------------------------------
@@ -55,6 +65,15 @@ class DeepGlobalPoolLayer : public DeepPoolingLayer {
     // Public methods
     // ------------------------------------------------------------------------
     virtual void cleanup() override;
+
+    /**
+     * @brief Check if this layer is able to render its output into a view of a larger texture
+     *
+     * @retval false always, as the reduction passes use their own viewports
+     */
+    virtual bool supportsOutputView() const override {
+        return false;
+    }
  protected:
     // ------------------------------------------------------------------------
     // Non-public methods
@@ -64,13 +83,30 @@ class DeepGlobalPoolLayer : public DeepPoolingLayer {
     virtual void setupShaders() override;
     virtual void afterRender() override;
     virtual void setupNetworkPolygons(VAO *vao) override;
+    virtual void setupFBOs() override;
+    programptr compileReductionShader(const char *preproc, int inWidth, int inHeight, int inPad, int blockX, int blockY,
+                                      int outWidth, int outHeight, int outPad, int outColumns, double scale);
+
+    /**
+     * @brief Dimensions of a single reduction pass
+     */
+    struct ReductionPass {
+        int width;          //!< Width of each tile after the reduction
+        int height;         //!< Height of each tile after the reduction
+        int blockX;         //!< Horizontal size of the reduced blocks
+        int blockY;         //!< Vertical size of the reduced blocks
+    };
 
     // ------------------------------------------------------------------------
     // Member variables
     // ------------------------------------------------------------------------
-    programptr shader_;           //!< Shader program for the pooling
-    unistateptr shaderState_;     //!< UniformState object for the #shader_
-    opmode mode_ = MAXPOOL;       //!< Operation mode for this pooling layer (s
+    programptr shader_;                         //!< Shader program for the pooling (final pass on multi-pass reduction)
+    unistateptr shaderState_;                   //!< UniformState object for the #shader_
+    opmode mode_ = MAXPOOL;                     //!< Operation mode for this pooling layer (max or average)
+    std::vector<ReductionPass> passes_;         //!< Intermediate reduction passes, empty for single-pass pooling
+    std::vector<programptr> passShaders_;       //!< Shader programs for the intermediate reduction passes
+    std::vector<unistateptr> passStates_;       //!< UniformState objects for the #passShaders_
+    std::vector<FBO *> passFBOs_;               //!< Framebuffers (with internal textures) for the intermediate reduction results
 };
 
 } // deep namespace
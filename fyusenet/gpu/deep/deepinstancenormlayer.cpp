@@ -0,0 +1,310 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Instance-Normalization Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "deepinstancenormlayer.h"
+#include "../../gl/glexception.h"
+#include "../../common/logging.h"
+#include "deeptiler.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+DeepInstanceNormLayer::DeepInstanceNormLayer(const LayerNormLayerBuilder & builder, int layerNumber) :
+    DeepLayerNormLayer(builder, layerNumber) {
+    spatial_ = (builder.type_ == LayerType::LAYERNORM);
+    if ((spatial_) && (!builder.spatial_)) THROW_EXCEPTION_ARGS(FynException, "Layer normalization over channels only is done by DeepLayerNormLayer");
+    //------------------------------------------------------
+    // Plan tree reduction for larger spatial extents, each
+    // pass reduces blocks of pixels until the remaining
+    // tiles are small enough for the final pass...
+    //------------------------------------------------------
+    int width = width_;
+    int height = height_;
+    while (std::max(width, height) > SINGLE_PASS_LIMIT) {
+        int block = (std::max(width, height) >= LARGE_REDUCTION_SIZE) ? 8 : 4;
+        ReductionPass pass;
+        pass.blockX = std::min(block, width);
+        pass.blockY = std::min(block, height);
+        pass.width = (width + pass.blockX - 1) / pass.blockX;
+        pass.height = (height + pass.blockY - 1) / pass.blockY;
+        passes_.push_back(pass);
+        width = pass.width;
+        height = pass.height;
+    }
+}
+
+
+/**
+ * @copydoc LayerBase::cleanup
+ */
+void DeepInstanceNormLayer::cleanup() {
+    passShaders_.clear();
+    passStates_.clear();
+    finalShader_.reset();
+    finalState_.reset();
+    combineShader_.reset();
+    combineState_.reset();
+    for (FBO * fbo : passFBOs_) delete fbo;
+    for (Texture2D * tex : passM2_) delete tex;
+    passFBOs_.clear();
+    passM2_.clear();
+    delete momentsFBO_;
+    delete momentsM2_;
+    delete statsFBO_;
+    delete statsRstd_;
+    momentsFBO_ = nullptr;
+    momentsM2_ = nullptr;
+    statsFBO_ = nullptr;
+    statsRstd_ = nullptr;
+    DeepLayerNormLayer::cleanup();
+}
+
+
+/**
+ * @brief Execute layer
+ *
+ * @param sequence Sequence number (\b must be stricly increasing)
+ *
+ * This function performs the actual computation that maps the input data to the output data
+ * for this layer. The supplied \p sequence number \b must be strictly increasing per network run
+ * and may also be used for debugging purposes, in case errors only manifests themselves after a
+ * certain number of computation cycles. It can also be used to keep track of the total number of
+ * inference runs. Internally, it is used to make sure that asynchronously transmitted data is
+ * up-to-date (on PBO reads for example).
+ */
+void DeepInstanceNormLayer::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    vertexArray_->bind();
+    //---------------------------------------------
+    // Reduction passes
+    //---------------------------------------------
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    for (int i=0; i < (int)passes_.size(); i++) {
+        passFBOs_[i]->bindWithViewport();
+        passFBOs_[i]->setWriteMask();
+        passShaders_[i]->bind(passStates_[i].get());
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        passShaders_[i]->unbind(true);
+        passFBOs_[i]->unbind();
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, passFBOs_[i]->getAttachment());
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, passM2_[i]->getHandle());
+    }
+    FBO * target = (spatial_) ? momentsFBO_ : statsFBO_;
+    target->bindWithViewport();
+    target->setWriteMask();
+    finalShader_->bind(finalState_.get());
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    finalShader_->unbind(true);
+    target->unbind();
+    if (spatial_) {
+        statsFBO_->bindWithViewport();
+        statsFBO_->setWriteMask();
+        combineShader_->bind(combineState_.get());
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, momentsFBO_->getAttachment());
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, momentsM2_->getHandle());
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        combineShader_->unbind(true);
+        statsFBO_->unbind();
+    }
+    //---------------------------------------------
+    // Output
+    //---------------------------------------------
+    framebuffers_.at(0)->bind();
+    framebuffers_.at(0)->setWriteMask();
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    outputShader_->bind(outputState_.get());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE1);
+    GLState::bindTexture(GL_TEXTURE_2D, statsFBO_->getAttachment());
+    GLState::activeTexture(GL_TEXTURE2);
+    GLState::bindTexture(GL_TEXTURE_2D, statsRstd_->getHandle());
+    GLState::activeTexture(GL_TEXTURE3);
+    GLState::bindTexture(GL_TEXTURE_2D, paramTexture_);
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    outputShader_->unbind();
+    framebuffers_.at(0)->unbind();
+    vertexArray_->unbind();
+    GLState::activeTexture(GL_TEXTURE0);
+}
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @copydoc DeepLayerNormLayer::setupShaders
+ */
+void DeepInstanceNormLayer::setupShaders() {
+    char preproc[1024] = {0};
+    shaderPreprocessing(preproc, sizeof(preproc)-1);
+    int width = width_, height = height_, pad = inputPadding_;
+    int cellx = 1, celly = 1;
+    for (int i=0; i < (int)passes_.size(); i++) {
+        const ReductionPass & pass = passes_.at(i);
+        programptr shader = compileReductionShader(preproc, (i == 0), false, width, height, pad, pass.blockX, pass.blockY,
+                                                   cellx, celly, pass.width, pass.height);
+        passShaders_.push_back(shader);
+        unistateptr state = UniformState::makeShared(shader);
+        state->setUniformValue("inputLayer0", 0);
+        state->setUniformValue("inputLayer1", 1, true);
+        passStates_.push_back(state);
+        cellx *= pass.blockX;
+        celly *= pass.blockY;
+        width = pass.width;
+        height = pass.height;
+        pad = 0;
+    }
+    finalShader_ = compileReductionShader(preproc, passes_.empty(), !spatial_, width, height, pad, width, height, cellx, celly, 1, 1);
+    finalState_ = UniformState::makeShared(finalShader_);
+    finalState_->setUniformValue("inputLayer0", 0);
+    finalState_->setUniformValue("inputLayer1", 1, true);
+    if (spatial_) {
+        char line[256];
+        snprintf(line, sizeof(line), "#define TILES %d\n#define TILES_X %d\n#define CHANNELS %d\n#define COUNT %d\n#define EPSILON %.8e\n",
+                 tiler_->numInputTiles(), tiler_->numInputTiles(DeepTiler::HORIZONTAL), inputChannels_, width_ * height_, epsilon_);
+        combineShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/normcombine.frag", line, typeid(this));
+        combineShader_->bindAttributeLocation("attributes0", 0);
+        combineShader_->link();
+        combineState_ = UniformState::makeShared(combineShader_);
+        combineState_->setUniformValue("inputLayer0", 0);
+        combineState_->setUniformValue("inputLayer1", 1);
+    }
+    char line[512];
+    snprintf(line, sizeof(line), "#define IN_TILES_X %d\n#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n"
+             "#define OUT_PAD %d\n#define OUT_TILES_X %d\n#define OUT_TILES %d\n",
+             tiler_->numInputTiles(DeepTiler::HORIZONTAL), width_, height_, inputPadding_, outputPadding_,
+             tiler_->numOutputTiles(DeepTiler::HORIZONTAL), tiler_->numOutputTiles());
+    strncat(preproc, line, sizeof(preproc) - strlen(preproc) - 1);
+    outputShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepinstancenorm.frag", preproc, typeid(this));
+    outputShader_->bindAttributeLocation("attributes0", 0);
+    outputShader_->link();
+    outputState_ = UniformState::makeShared(outputShader_);
+    outputState_->setUniformValue("inputLayer0", 0);
+    outputState_->setUniformValue("meanLayer", 1);
+    outputState_->setUniformValue("rstdLayer", 2);
+    outputState_->setUniformValue("paramLayer", 3);
+}
+
+
+/**
+ * @brief Compile a shader for a reduction pass
+ *
+ * @param preproc Preprocessor definitions to prepend
+ * @param first Indicator that this pass reads the input tensor (instead of intermediate results)
+ * @param final Indicator that this pass computes the inverse standard deviation instead of the
+ *              sum of squared deviations
+ * @param inWidth Width of the input tiles
+ * @param inHeight Height of the input tiles
+ * @param inPad Padding of the input tiles
+ * @param blockX Horizontal size of the blocks to reduce
+ * @param blockY Vertical size of the blocks to reduce
+ * @param cellX Horizontal number of original pixels that are covered by each input texel
+ * @param cellY Vertical number of original pixels that are covered by each input texel
+ * @param outWidth Width of the output tiles
+ * @param outHeight Height of the output tiles
+ *
+ * @return Shared pointer to linked shader program
+ */
+programptr DeepInstanceNormLayer::compileReductionShader(const char *preproc, bool first, bool final, int inWidth, int inHeight, int inPad,
+                                                         int blockX, int blockY, int cellX, int cellY, int outWidth, int outHeight) {
+    char finalpreproc[2048] = {0};
+    snprintf(finalpreproc, sizeof(finalpreproc),
+             "%s%s%s#define TILES %d\n#define IN_TILES_X %d\n#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n"
+             "#define BLOCK_X %d\n#define BLOCK_Y %d\n#define CELL_X %d\n#define CELL_Y %d\n#define ORIG_WIDTH %d\n#define ORIG_HEIGHT %d\n"
+             "#define OUT_WIDTH %d\n#define OUT_HEIGHT %d\n#define OUT_TILES_X %d\n#define EPSILON %.8e\n",
+             preproc, (first) ? "#define FIRST_PASS\n" : "", (final) ? "#define FINAL_STATS\n" : "",
+             tiler_->numInputTiles(), tiler_->numInputTiles(DeepTiler::HORIZONTAL), inWidth, inHeight, inPad,
+             blockX, blockY, cellX, cellY, width_, height_, outWidth, outHeight, tiler_->numInputTiles(DeepTiler::HORIZONTAL), epsilon_);
+    programptr shader = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/normreduce.frag", finalpreproc, typeid(this));
+    try {
+        shader->bindAttributeLocation("attributes0", 0);
+        shader->link();
+    } catch (GLException& ex) {
+        FNLOGE("Cannot link shader for layer %s", getName().c_str());
+        throw;
+    }
+    return shader;
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ *
+ * Besides the output framebuffer, this creates the framebuffers for the intermediate reduction
+ * results and the statistics, which store the tiles without padding in the same tile arrangement
+ * as the input tensor. All of them use two single-precision render targets.
+ */
+void DeepInstanceNormLayer::setupFBOs() {
+    DeepLayerBase::setupFBOs();
+    int tilesx = tiler_->numInputTiles(DeepTiler::HORIZONTAL);
+    int tilesy = tiler_->numInputTiles(DeepTiler::VERTICAL);
+    for (const ReductionPass & pass : passes_) {
+        FBO * fbo = new FBO(context_, pass.width * tilesx, pass.height * tilesy, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        Texture2D * m2 = new Texture2D(pass.width * tilesx, pass.height * tilesy, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+        fbo->addTexture(GL_COLOR_ATTACHMENT1, *m2);
+        fbo->unbind();
+        passFBOs_.push_back(fbo);
+        passM2_.push_back(m2);
+    }
+    if (spatial_) {
+        momentsFBO_ = new FBO(context_, tilesx, tilesy, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        momentsM2_ = new Texture2D(tilesx, tilesy, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+        momentsFBO_->addTexture(GL_COLOR_ATTACHMENT1, *momentsM2_);
+        momentsFBO_->unbind();
+    }
+    statsFBO_ = new FBO(context_, tilesx, tilesy, PIXEL_PACKING, opengl::Texture::FLOAT32);
+    statsRstd_ = new Texture2D(tilesx, tilesy, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+    statsFBO_->addTexture(GL_COLOR_ATTACHMENT1, *statsRstd_);
+    statsFBO_->unbind();
+}
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
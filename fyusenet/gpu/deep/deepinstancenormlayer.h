@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Instance-Normalization Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/texture.h"
+#include "deeplayernormlayer.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+/**
+ * @brief Instance normalization (and layer normalization over the whole tensor) for deep tensors
+ *
+ * This layer normalizes each channel of the input tensor to zero mean and unit variance over its
+ * spatial extent and applies a per-channel scale and bias afterwards, as used in style-transfer
+ * networks. In contrast to a batchnorm, the statistics are computed at runtime. When built as
+ * spatial layer normalization (see LayerNormLayerBuilder::spatial), the per-channel statistics
+ * are combined into a single mean and variance for the whole tensor.
+ *
+ * The per-channel statistics are computed by a tree reduction. Each reduction pass reduces
+ * blocks of 8x8 (or 4x4 for smaller inputs) pixels of all tiles into two single-precision
+ * intermediate textures that store the block means and the sums of squared deviations from the
+ * block means. Blocks are merged using the pairwise update by Chan et al., which avoids the
+ * cancellation issues of computing the variance from the second moment. The last reduction pass
+ * computes the mean and inverse standard deviation of each channel, which are then applied by a
+ * final pass that also applies the per-channel scale and bias.
+ *
+ * @see LayerNormLayerBuilder, InstanceNormLayer
+ */
+class DeepInstanceNormLayer : public DeepLayerNormLayer {
+ public:
+    constexpr static int SINGLE_PASS_LIMIT = 8;       //!< Maximum spatial extent (per axis) that is reduced by the final pass alone
+    constexpr static int LARGE_REDUCTION_SIZE = 64;   //!< Minimum spatial extent (per axis) for using 8x8 instead of 4x4 reduction blocks
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepInstanceNormLayer(const LayerNormLayerBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void cleanup() override;
+    virtual void forward(uint64_t sequence) override;
+
+ protected:
+    /**
+     * @brief Dimensions of a single reduction pass
+     */
+    struct ReductionPass {
+        int width;          //!< Width of each tile after the reduction
+        int height;         //!< Height of each tile after the reduction
+        int blockX;         //!< Horizontal size of the reduced blocks
+        int blockY;         //!< Vertical size of the reduced blocks
+    };
+
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    virtual void setupShaders() override;
+    virtual void setupFBOs() override;
+    programptr compileReductionShader(const char *preproc, bool first, bool final, int inWidth, int inHeight, int inPad,
+                                      int blockX, int blockY, int cellX, int cellY, int outWidth, int outHeight);
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    bool spatial_ = false;                      //!< Indicator that the statistics are combined over all channels (layer normalization)
+    std::vector<ReductionPass> passes_;         //!< Intermediate reduction passes, empty if the final pass can reduce the input directly
+    std::vector<programptr> passShaders_;       //!< Shader programs for the intermediate reduction passes
+    std::vector<unistateptr> passStates_;       //!< UniformState objects for the #passShaders_
+    std::vector<FBO *> passFBOs_;               //!< Framebuffers for the intermediate block means
+    std::vector<Texture2D *> passM2_;           //!< Second render targets of the #passFBOs_ (sums of squared deviations)
+    programptr finalShader_;                    //!< Shader for the final reduction pass
+    unistateptr finalState_;                    //!< Uniform-variable state for #finalShader_
+    programptr combineShader_;                  //!< Shader that combines the per-channel statistics (spatial layer normalization only)
+    unistateptr combineState_;                  //!< Uniform-variable state for #combineShader_
+    FBO *momentsFBO_ = nullptr;                 //!< Per-channel means (spatial layer normalization only)
+    Texture2D *momentsM2_ = nullptr;            //!< Second render target of #momentsFBO_
+    Texture2D *statsRstd_ = nullptr;            //!< Second render target of the statistics %FBO (inverse standard deviations)
+};
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -72,8 +72,8 @@ DeepLayerBase::~DeepLayerBase() {
  */
 void DeepLayerBase::writeResult(const char *fileName,bool includePadding) {
 #ifdef DEBUG
-    int owidth = tiler_->getViewportWidth();
-    int oheight = tiler_->getViewportHeight();
+    int owidth = (outputView_) ? outputExtents_[0] : tiler_->getViewportWidth();
+    int oheight = (outputView_) ? outputExtents_[1] : tiler_->getViewportHeight();
     float * data = new float[oheight*owidth*PIXEL_PACKING];
     int lwidth = tiler_->getOutputWidth();
     int lheight = tiler_->getOutputHeight();
@@ -99,7 +99,7 @@ void DeepLayerBase::writeResult(const char *fileName,bool includePadding) {
             for (int ty=0; ty< tiler_->numOutputTiles(DeepTiler::VERTICAL); ty++) {
                 for (int tx=0; tx < tiler_->numOutputTiles(DeepTiler::HORIZONTAL); tx++) {
                     int rem = ((outputChannels_-layernum)>PIXEL_PACKING) ? PIXEL_PACKING : outputChannels_-layernum;
-                    float * in = data + ((outputPadding_+ty*(lheight+outputPadding_))*owidth + outputPadding_+tx*(lwidth+outputPadding_))*PIXEL_PACKING;
+                    float * in = data + ((outputOrigin_[1] + outputPadding_ + ty*(lheight + outputPadding_))*owidth + outputOrigin_[0] + outputPadding_ + tx*(lwidth+outputPadding_))*PIXEL_PACKING;
                     float * outptr = (includePadding) ? layer + (outputPadding_*lwidth)+outputPadding_ : layer;
                     for (int l=0; l < rem;l++) {
                         for (int y=0; y < lheight;y++) {
@@ -137,8 +137,8 @@ void DeepLayerBase::writeResult(const char *fileName,bool includePadding) {
 void DeepLayerBase::copyResult(float *memory, bool includePadding) {
 #ifdef DEBUG
     if (memory) {
-        int owidth = tiler_->getViewportWidth();
-        int oheight = tiler_->getViewportHeight();
+        int owidth = (outputView_) ? outputExtents_[0] : tiler_->getViewportWidth();
+        int oheight = (outputView_) ? outputExtents_[1] : tiler_->getViewportHeight();
         float * data = new float[oheight*owidth*PIXEL_PACKING];
         int lwidth = tiler_->getOutputWidth();
         int lheight = tiler_->getOutputHeight();
@@ -156,7 +156,7 @@ void DeepLayerBase::copyResult(float *memory, bool includePadding) {
             for (int ty=0; ty < tiler_->numOutputTiles(DeepTiler::VERTICAL); ty++) {
                 for (int tx=0; tx < tiler_->numOutputTiles(DeepTiler::HORIZONTAL); tx++) {
                     int rem = ((outputChannels_ - layernum) > PIXEL_PACKING) ? PIXEL_PACKING : outputChannels_ - layernum;
-                    const float * in = data + ((outputPadding_ + ty*(lheight + outputPadding_))*owidth + outputPadding_ + tx*(lwidth + outputPadding_))*PIXEL_PACKING;
+                    const float * in = data + ((outputOrigin_[1] + outputPadding_ + ty*(lheight + outputPadding_))*owidth + outputOrigin_[0] + outputPadding_ + tx*(lwidth + outputPadding_))*PIXEL_PACKING;
                     float * outptr = (includePadding) ? layer + (outputPadding_ * lwidth) + outputPadding_ : layer;
                     for (int l=0; l < rem; l++) {
                         for (int y=0; y < lheight; y++) {
@@ -217,7 +217,9 @@ size_t DeepLayerBase::shaderPreprocessing(char *preproc, size_t maxChars) {
  */
 void DeepLayerBase::setupFBOs() {
     if (outputTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"No output texture set in layer %s",getName().c_str());
-    FBO * fbo = new FBO(context_,viewport_[0],viewport_[1],outputTextures_.at(0));
+    // NOTE when rendering into an output view, the FBO covers the whole (shared) texture
+    FBO * fbo = (outputView_) ? new FBO(context_, outputExtents_[0], outputExtents_[1], outputTextures_.at(0))
+                              : new FBO(context_, viewport_[0], viewport_[1], outputTextures_.at(0));
     fbo->unbind();
     framebuffers_.push_back(fbo);
     outputChanged_=false;
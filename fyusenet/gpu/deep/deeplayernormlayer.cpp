@@ -0,0 +1,293 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Layer-Normalization Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstring>
+#include <cassert>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "deeplayernormlayer.h"
+#include "../../gl/glexception.h"
+#include "../../common/logging.h"
+#include "deeptiler.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+DeepLayerNormLayer::DeepLayerNormLayer(const LayerNormLayerBuilder & builder, int layerNumber) :
+    DeepLayerBase((const GPULayerBuilder &)builder, layerNumber) {
+    if (flags_ & (LayerFlags::RESIDUAL_INPUT | LayerFlags::POST_BATCHNORM)) THROW_EXCEPTION_ARGS(FynException, "This layer does not support residual inputs or batchnorm");
+    if (outputChannels_ != inputChannels_) THROW_EXCEPTION_ARGS(FynException, "Number of output channels must match number of input channels");
+    if (builder.epsilon_ <= 0.f) THROW_EXCEPTION_ARGS(FynException, "Epsilon must be positive");
+    epsilon_ = builder.epsilon_;
+    int padout = PIXEL_PACKING * ((outputChannels_ + PIXEL_PACKING-1) / PIXEL_PACKING);
+    scales_ = new float[padout];
+    bias_ = new float[padout];
+    memset(scales_, 0, padout * sizeof(float));
+    memset(bias_, 0, padout * sizeof(float));
+    for (int i=0; i < outputChannels_; i++) scales_[i] = 1.0f;
+}
+
+
+/**
+ * @brief Destructor
+ */
+DeepLayerNormLayer::~DeepLayerNormLayer() {
+    delete [] scales_;
+    delete [] bias_;
+    scales_ = nullptr;
+    bias_ = nullptr;
+}
+
+
+/**
+ * @copydoc LayerBase::cleanup
+ */
+void DeepLayerNormLayer::cleanup() {
+    delete vertexArray_;
+    delete vertexBuffer_;
+    delete indexBuffer_;
+    delete statsFBO_;
+    if (paramTexture_) GLState::deleteTextures(1, &paramTexture_);
+    vertexArray_ = nullptr;
+    vertexBuffer_ = nullptr;
+    indexBuffer_ = nullptr;
+    statsFBO_ = nullptr;
+    paramTexture_ = 0;
+    // reset shaders here because the GL context is bound here (in case no cache is used)
+    statsShader_.reset();
+    outputShader_.reset();
+    statsState_.reset();
+    outputState_.reset();
+    DeepLayerBase::cleanup();
+}
+
+
+/**
+ * @copydoc LayerBase::setup
+ */
+void DeepLayerNormLayer::setup() {
+    setupNetworkPolygons();
+    setupShaders();
+    setupFBOs();
+    setupParameterTexture();
+    valid_ = true;
+}
+
+
+/**
+ * @brief Execute layer
+ *
+ * @param sequence Sequence number (\b must be stricly increasing)
+ *
+ * This function performs the actual computation that maps the input data to the output data
+ * for this layer. The supplied \p sequence number \b must be strictly increasing per network run
+ * and may also be used for debugging purposes, in case errors only manifests themselves after a
+ * certain number of computation cycles. It can also be used to keep track of the total number of
+ * inference runs. Internally, it is used to make sure that asynchronously transmitted data is
+ * up-to-date (on PBO reads for example).
+ */
+void DeepLayerNormLayer::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    vertexArray_->bind();
+    //---------------------------------------------
+    // Statistics (mean / inverse std-deviation)
+    //---------------------------------------------
+    statsFBO_->bindWithViewport();
+    statsFBO_->setWriteMask();
+    statsShader_->bind(statsState_.get());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    statsShader_->unbind(true);
+    statsFBO_->unbind();
+    //---------------------------------------------
+    // Output
+    //---------------------------------------------
+    framebuffers_.at(0)->bind();
+    framebuffers_.at(0)->setWriteMask();
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    outputShader_->bind(outputState_.get());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE1);
+    GLState::bindTexture(GL_TEXTURE_2D, statsFBO_->getAttachment());
+    GLState::activeTexture(GL_TEXTURE2);
+    GLState::bindTexture(GL_TEXTURE_2D, paramTexture_);
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    outputShader_->unbind();
+    framebuffers_.at(0)->unbind();
+    vertexArray_->unbind();
+    GLState::activeTexture(GL_TEXTURE0);
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredInputBuffers
+ */
+std::vector<BufferSpec> DeepLayerNormLayer::getRequiredInputBuffers() const {
+    std::vector<BufferSpec> result;
+    result.push_back(BufferSpec(0, 0, tiler_->getInputTextureWidth(), tiler_->getInputTextureHeight(),
+                                TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                BufferSpec::FUNCTION_SOURCE).dataOrder(BufferSpec::order::GPU_DEEP));
+    return result;
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredOutputBuffers
+ */
+std::vector<BufferSpec> DeepLayerNormLayer::getRequiredOutputBuffers() const {
+    std::vector<BufferSpec> result;
+    result.push_back(BufferSpec(0, 0, viewport_[0], viewport_[1],
+                                TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                BufferSpec::FUNCTION_DEST).dataOrder(BufferSpec::order::GPU_DEEP));
+    return result;
+}
+
+
+/**
+ * @copydoc BatchNormInterface::loadScaleAndBias
+ *
+ * For this layer, the scale values correspond to the \e gamma and the bias values to the
+ * \e beta parameters of the layer normalization.
+ */
+void DeepLayerNormLayer::loadScaleAndBias(const float *scaleAndBias, size_t sbOffset) {
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    const float * src = scaleAndBias + sbOffset;
+    memcpy(scales_, src, outputChannels_ * sizeof(float));
+    memcpy(bias_, src + outputChannels_, outputChannels_ * sizeof(float));
+    if (valid_) setupParameterTexture();
+}
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @brief Compile shaders that implement the actual layer functionality
+ *
+ * This function obtains required shaders from the resource system, compiles/caches these shaders
+ * and performs base initializations on them.
+ */
+void DeepLayerNormLayer::setupShaders() {
+    char preproc[1024] = {0}, line[512];
+    ssize_t mc = (ssize_t)shaderPreprocessing(preproc, sizeof(preproc)-1);
+    assert(mc > 0);
+    snprintf(line, sizeof(line), "#define EPSILON %.8e\n#define IN_CHANNELS %d\n#define IN_SLICES %d\n#define IN_TILES_X %d\n"
+             "#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n#define OUT_PAD %d\n#define OUT_TILES_X %d\n#define OUT_TILES %d\n",
+             epsilon_, inputChannels_, tiler_->numInputTiles(), tiler_->numInputTiles(DeepTiler::HORIZONTAL), width_, height_,
+             inputPadding_, outputPadding_, tiler_->numOutputTiles(DeepTiler::HORIZONTAL), tiler_->numOutputTiles());
+    strncat(preproc, line, mc);
+    mc -= strlen(line);
+    assert(mc > 0);
+    statsShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deeplayernormstats.frag", preproc, typeid(this));
+    statsShader_->bindAttributeLocation("attributes0", 0);
+    statsShader_->link();
+    statsState_ = UniformState::makeShared(statsShader_);
+    statsState_->setUniformValue("inputLayer0", 0);
+    outputShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deeplayernorm.frag", preproc, typeid(this));
+    outputShader_->bindAttributeLocation("attributes0", 0);
+    outputShader_->link();
+    outputState_ = UniformState::makeShared(outputShader_);
+    outputState_->setUniformValue("inputLayer0", 0);
+    outputState_->setUniformValue("statsLayer", 1);
+    outputState_->setUniformValue("paramLayer", 2);
+}
+
+
+/**
+ * @brief Setup a proxy polygon that is used to drive the fragment shaders
+ *
+ * Both passes of this layer derive the position to compute from the fragment coordinates, a
+ * single quad that covers the whole viewport is therefore used for both of them.
+ */
+void DeepLayerNormLayer::setupNetworkPolygons() {
+    float quad[4*4] = {-1.f, -1.f, 0.f, 0.f,
+                        1.f, -1.f, 1.f, 0.f,
+                        1.f,  1.f, 1.f, 1.f,
+                       -1.f,  1.f, 0.f, 1.f};
+    GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+    vertexArray_ = new VAO(context_);
+    vertexArray_->bind();
+    vertexBuffer_ = new VBO(context_);
+    vertexArray_->enableArray(0);
+    vertexBuffer_->setBufferData(quad, sizeof(quad), GL_STATIC_DRAW);
+    vertexBuffer_->bind();
+    vertexArray_->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    indexBuffer_ = new IBO(context_);
+    indexBuffer_->setBufferData(indices, sizeof(indices), GL_STATIC_DRAW);
+    indexBuffer_->bind();
+    vertexArray_->unbind();
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ */
+void DeepLayerNormLayer::setupFBOs() {
+    DeepLayerBase::setupFBOs();
+    statsFBO_ = new FBO(context_, width_, height_, PIXEL_PACKING, opengl::Texture::FLOAT32);
+    statsFBO_->unbind();
+}
+
+
+/**
+ * @brief Upload the per-channel scale and bias values to a texture
+ *
+ * The texture has one column per tile, the first row contains the scales and the second row
+ * the biases. It is always stored in single precision.
+ */
+void DeepLayerNormLayer::setupParameterTexture() {
+    int tiles = (outputChannels_ + PIXEL_PACKING-1) / PIXEL_PACKING;
+    float * data = new float[tiles * 2 * PIXEL_PACKING];
+    memcpy(data, scales_, tiles * PIXEL_PACKING * sizeof(float));
+    memcpy(data + tiles * PIXEL_PACKING, bias_, tiles * PIXEL_PACKING * sizeof(float));
+    if (!paramTexture_) glGenTextures(1, &paramTexture_);
+    GLState::bindTexture(GL_TEXTURE_2D, paramTexture_);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, tiles, 2, 0, GL_RGBA, GL_FLOAT, data);
+    delete [] data;
+}
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,101 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Layer-Normalization Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/fbo.h"
+#include "../../gl/vbo.h"
+#include "../../gl/ibo.h"
+#include "../../gl/vao.h"
+#include "../../gl/uniformstate.h"
+#include "../../base/bufferspec.h"
+#include "../../base/batchnorminterface.h"
+#include "deeplayerbase.h"
+#include "../layernormlayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+/**
+ * @brief Layer normalization over the channels of each spatial position of a deep tensor
+ *
+ * This layer normalizes all channels of each spatial position to zero mean and unit variance
+ * and applies a per-channel scale and bias afterwards, as done in transformer blocks. The
+ * scale and bias values are supplied via loadScaleAndBias() and default to an identity
+ * transform.
+ *
+ * The first pass computes the mean and the inverse standard deviation of each spatial position
+ * and stores them in a layer-internal 32-bit floating-point texture. The variance is computed
+ * from the deviations to the mean (instead of the difference of the second moment and the
+ * squared mean) to avoid cancellation. The second pass applies the normalization and the
+ * per-channel transform to the input.
+ *
+ * @see LayerNormLayerBuilder
+ */
+class DeepLayerNormLayer : public DeepLayerBase, public BatchNormInterface {
+ public:
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepLayerNormLayer(const LayerNormLayerBuilder & builder, int layerNumber);
+    virtual ~DeepLayerNormLayer();
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void setup() override;
+    virtual void cleanup() override;
+    virtual void forward(uint64_t sequence) override;
+    virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
+    virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
+    virtual void loadScaleAndBias(const float *scaleAndBias, size_t sbOffset=0) override;
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    void setupNetworkPolygons();
+    virtual void setupFBOs() override;
+    virtual void setupShaders();
+    void setupParameterTexture();
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    float epsilon_ = 1e-5f;                    //!< Constant that is added to the variance
+    float *scales_ = nullptr;                  //!< Per-channel scale values (gamma), padded to a multiple of 4
+    float *bias_ = nullptr;                    //!< Per-channel bias values (beta), padded to a multiple of 4
+    GLuint paramTexture_ = 0;                  //!< Texture with the scales in the first row and the biases in the second row
+    VAO *vertexArray_ = nullptr;               //!< Vertex array object for the viewport-filling quad that is used for all passes
+    VBO *vertexBuffer_ = nullptr;              //!< Vertex coordinates of the quad
+    IBO *indexBuffer_ = nullptr;               //!< Polygon connectivity of the quad
+    FBO *statsFBO_ = nullptr;                  //!< %FBO for the per-position mean and inverse standard deviation
+    programptr statsShader_;                   //!< Shader for the statistics pass
+    programptr outputShader_;                  //!< Shader for the output pass
+    unistateptr statsState_;                   //!< Uniform-variable state for #statsShader_
+    unistateptr outputState_;                  //!< Uniform-variable state for #outputShader_
+};
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,281 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Matrix-Multiplication Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstring>
+#include <cassert>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "deepmatmullayer.h"
+#include "../../gl/glexception.h"
+#include "../../common/logging.h"
+#include "deeptiler.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+DeepMatMulLayer::DeepMatMulLayer(const MatMulLayerBuilder & builder, int layerNumber) :
+    DeepLayerBase((const GPULayerBuilder &)builder, layerNumber) {
+    if (flags_ & (LayerFlags::RESIDUAL_INPUT | LayerFlags::POST_BATCHNORM)) THROW_EXCEPTION_ARGS(FynException, "This layer does not support residual inputs or batchnorm");
+    for (int i=0; i < 3; i++) secondShape_[i] = builder.secondShape_[i];
+    batches_ = builder.batches_;
+    transposeA_ = builder.transposeA_;
+    transposeB_ = builder.transposeB_;
+    alpha_ = builder.alpha_;
+    fp32Accumulation_ = builder.fp32Accumulation_;
+    if ((secondShape_[0] <= 0) || (secondShape_[1] <= 0) || (secondShape_[2] <= 0)) THROW_EXCEPTION_ARGS(FynException, "Shape of second input not set");
+    if (batches_ <= 0) THROW_EXCEPTION_ARGS(FynException, "Illegal number of batches %d", batches_);
+    if ((inputChannels_ % (batches_ * PIXEL_PACKING)) || (secondShape_[2] % (batches_ * PIXEL_PACKING)) || (outputChannels_ % (batches_ * PIXEL_PACKING))) {
+        THROW_EXCEPTION_ARGS(FynException, "Number of channels per batch must be a multiple of %d for all tensors", PIXEL_PACKING);
+    }
+    int chansa = inputChannels_ / batches_;
+    int chansb = secondShape_[2] / batches_;
+    rows_ = (transposeA_) ? chansa : width_ * height_;
+    inner_ = (transposeA_) ? width_ * height_ : chansa;
+    columns_ = (transposeB_) ? secondShape_[0] * secondShape_[1] : chansb;
+    int innerb = (transposeB_) ? chansb : secondShape_[0] * secondShape_[1];
+    if (inner_ != innerb) THROW_EXCEPTION_ARGS(FynException, "Inner dimensions do not match (%d vs %d)", inner_, innerb);
+    if (columns_ % PIXEL_PACKING) THROW_EXCEPTION_ARGS(FynException, "Number of columns of the product must be a multiple of %d", PIXEL_PACKING);
+    if (outputChannels_ != batches_ * columns_) THROW_EXCEPTION_ARGS(FynException, "Product requires %d output channels, got %d", batches_ * columns_, outputChannels_);
+    // NOTE the output of a transposed first matrix has one position per input channel, which are laid out in a single row
+    int outwidth = (transposeA_) ? rows_ : width_;
+    int outheight = (transposeA_) ? 1 : height_;
+    delete tiler_;
+    tiler_ = new DeepTiler(builder.type_, width_, height_, outwidth, outheight, inputChannels_, outputChannels_, inputPadding_, outputPadding_);
+    secondTiler_ = new DeepTiler(builder.type_, secondShape_[0], secondShape_[1], secondShape_[0], secondShape_[1], secondShape_[2], secondShape_[2], inputPadding_, inputPadding_);
+    viewport_[0] = tiler_->getViewportWidth();
+    viewport_[1] = tiler_->getViewportHeight();
+}
+
+
+/**
+ * @brief Destructor
+ */
+DeepMatMulLayer::~DeepMatMulLayer() {
+    delete secondTiler_;
+    secondTiler_ = nullptr;
+}
+
+
+/**
+ * @copydoc LayerBase::cleanup
+ */
+void DeepMatMulLayer::cleanup() {
+    delete vertexArray_;
+    delete vertexBuffer_;
+    delete indexBuffer_;
+    vertexArray_ = nullptr;
+    vertexBuffer_ = nullptr;
+    indexBuffer_ = nullptr;
+    // reset shaders here because the GL context is bound here (in case no cache is used)
+    shader_.reset();
+    shaderState_.reset();
+    DeepLayerBase::cleanup();
+}
+
+
+/**
+ * @copydoc LayerBase::setup
+ */
+void DeepMatMulLayer::setup() {
+    setupNetworkPolygons();
+    setupShaders();
+    setupFBOs();
+    valid_ = true;
+}
+
+
+/**
+ * @brief Execute layer
+ *
+ * @param sequence Sequence number (\b must be stricly increasing)
+ *
+ * This function performs the actual computation that maps the input data to the output data
+ * for this layer. The supplied \p sequence number \b must be strictly increasing per network run
+ * and may also be used for debugging purposes, in case errors only manifests themselves after a
+ * certain number of computation cycles. It can also be used to keep track of the total number of
+ * inference runs. Internally, it is used to make sure that asynchronously transmitted data is
+ * up-to-date (on PBO reads for example).
+ */
+void DeepMatMulLayer::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    vertexArray_->bind();
+    framebuffers_.at(0)->bind();
+    framebuffers_.at(0)->setWriteMask();
+    shader_->bind(shaderState_.get());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE1);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(1));
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    shader_->unbind();
+    framebuffers_.at(0)->unbind();
+    vertexArray_->unbind();
+    GLState::activeTexture(GL_TEXTURE0);
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredInputBuffers
+ */
+std::vector<BufferSpec> DeepMatMulLayer::getRequiredInputBuffers() const {
+    std::vector<BufferSpec> result;
+    result.push_back(BufferSpec(0, 0, tiler_->getInputTextureWidth(), tiler_->getInputTextureHeight(),
+                                TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                BufferSpec::FUNCTION_SOURCE).dataOrder(BufferSpec::order::GPU_DEEP));
+    result.push_back(BufferSpec(1, 1, secondTiler_->getInputTextureWidth(), secondTiler_->getInputTextureHeight(),
+                                TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                BufferSpec::FUNCTION_SOURCE).dataOrder(BufferSpec::order::GPU_DEEP));
+    return result;
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredOutputBuffers
+ */
+std::vector<BufferSpec> DeepMatMulLayer::getRequiredOutputBuffers() const {
+    std::vector<BufferSpec> result;
+    if (fp32Accumulation_) {
+        result.push_back(BufferSpec(0, 0, viewport_[0], viewport_[1],
+                                    BufferSpec::sizedformat::RGBA32F, TEXTURE_FORMAT_4, BufferSpec::dtype::FLOAT32,
+                                    BufferSpec::FUNCTION_DEST).dataOrder(BufferSpec::order::GPU_DEEP));
+    } else {
+        result.push_back(BufferSpec(0, 0, viewport_[0], viewport_[1],
+                                    TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                    BufferSpec::FUNCTION_DEST).dataOrder(BufferSpec::order::GPU_DEEP));
+    }
+    return result;
+}
+
+
+/**
+ * @copydoc LayerBase::numInputPorts
+ */
+int DeepMatMulLayer::numInputPorts() const {
+    return 2;
+}
+
+
+/**
+ * @copydoc LayerBase::getPortChannelIndex
+ */
+int DeepMatMulLayer::getPortChannelIndex(int port) const {
+    if (port >= numInputPorts()) THROW_EXCEPTION_ARGS(FynException,"Illegal input port %d specified",port);
+    return port;
+}
+
+
+/**
+ * @copydoc LayerBase::numInputChannels
+ */
+int DeepMatMulLayer::numInputChannels(int port) const {
+    if (port >= numInputPorts()) THROW_EXCEPTION_ARGS(FynException,"Illegal input port %d specified",port);
+    return (port == 0) ? inputChannels_ : secondShape_[2];
+}
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @brief Compile shaders that implement the actual layer functionality
+ *
+ * This function obtains required shaders from the resource system, compiles/caches these shaders
+ * and performs base initializations on them.
+ */
+void DeepMatMulLayer::setupShaders() {
+    char preproc[1024] = {0}, line[640];
+    ssize_t mc = (ssize_t)shaderPreprocessing(preproc, sizeof(preproc)-1);
+    assert(mc > 0);
+    snprintf(line, sizeof(line), "#define A_WIDTH %d\n#define A_HEIGHT %d\n#define A_TILES_X %d\n"
+             "#define B_WIDTH %d\n#define B_HEIGHT %d\n#define B_TILES_X %d\n#define IN_PAD %d\n"
+             "#define OUT_WIDTH %d\n#define OUT_HEIGHT %d\n#define OUT_PAD %d\n#define OUT_TILES_X %d\n#define OUT_TILES %d\n"
+             "#define MAT_M %d\n#define MAT_K %d\n#define MAT_N %d\n#define ALPHA %.8e\n%s%s%s",
+             width_, height_, tiler_->numInputTiles(DeepTiler::HORIZONTAL),
+             secondShape_[0], secondShape_[1], secondTiler_->numInputTiles(DeepTiler::HORIZONTAL), inputPadding_,
+             tiler_->getOutputWidth(), tiler_->getOutputHeight(), outputPadding_, tiler_->numOutputTiles(DeepTiler::HORIZONTAL), tiler_->numOutputTiles(),
+             rows_, inner_, columns_, alpha_,
+             (transposeA_) ? "#define TRANSPOSE_A\n" : "",
+             (transposeB_) ? "#define TRANSPOSE_B\n" : "",
+             (fp32Accumulation_ || highPrecision_) ? "#define HIGHP_ACCUM\n" : "");
+    strncat(preproc, line, mc);
+    mc -= strlen(line);
+    assert(mc > 0);
+    shader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepmatmul.frag", preproc, typeid(this));
+    try {
+        shader_->bindAttributeLocation("attributes0", 0);
+        shader_->link();
+    } catch (GLException& ex) {
+        FNLOGE("Cannot link shader for layer %s",getName().c_str());
+        throw;
+    }
+    shaderState_ = UniformState::makeShared(shader_);
+    shaderState_->setUniformValue("inputLayer0", 0);
+    shaderState_->setUniformValue("inputLayer1", 1);
+}
+
+
+/**
+ * @brief Setup a proxy polygon that is used to drive the fragment shader
+ *
+ * The shader derives the position to compute from the fragment coordinates, a single quad that
+ * covers the whole viewport is therefore used.
+ */
+void DeepMatMulLayer::setupNetworkPolygons() {
+    float quad[4*4] = {-1.f, -1.f, 0.f, 0.f,
+                        1.f, -1.f, 1.f, 0.f,
+                        1.f,  1.f, 1.f, 1.f,
+                       -1.f,  1.f, 0.f, 1.f};
+    GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+    vertexArray_ = new VAO(context_);
+    vertexArray_->bind();
+    vertexBuffer_ = new VBO(context_);
+    vertexArray_->enableArray(0);
+    vertexBuffer_->setBufferData(quad, sizeof(quad), GL_STATIC_DRAW);
+    vertexBuffer_->bind();
+    vertexArray_->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    indexBuffer_ = new IBO(context_);
+    indexBuffer_->setBufferData(indices, sizeof(indices), GL_STATIC_DRAW);
+    indexBuffer_->bind();
+    vertexArray_->unbind();
+}
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
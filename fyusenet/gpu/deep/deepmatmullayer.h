@@ -0,0 +1,112 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Matrix-Multiplication Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/fbo.h"
+#include "../../gl/vbo.h"
+#include "../../gl/ibo.h"
+#include "../../gl/vao.h"
+#include "../../gl/uniformstate.h"
+#include "../../base/bufferspec.h"
+#include "deeplayerbase.h"
+#include "../matmullayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+/**
+ * @brief Batched matrix multiplication of two deep tensors
+ *
+ * This layer multiplies two tensors that are both computed at runtime, for example the queries
+ * and keys or the attention weights and values in a transformer block. Please see
+ * MatMulLayerBuilder for the interpretation of the tensors as matrices.
+ *
+ * Each batch occupies a consecutive set of tiles in all tensors, which requires the number of
+ * channels per batch to be a multiple of 4 for all tensors. The layer renders all output tiles
+ * in a single pass, each fragment computes 4 adjacent columns of one row of the product by
+ * iterating over the inner dimension in steps of 4, which amounts to one \c mat4 by \c vec4
+ * product per step. Dot-products are accumulated in medium precision by default, which may be
+ * changed to single precision (including the output texture) via the builder.
+ *
+ * @see MatMulLayerBuilder
+ */
+class DeepMatMulLayer : public DeepLayerBase {
+ public:
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepMatMulLayer(const MatMulLayerBuilder & builder, int layerNumber);
+    virtual ~DeepMatMulLayer();
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void setup() override;
+    virtual void cleanup() override;
+    virtual void forward(uint64_t sequence) override;
+    virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
+    virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
+    virtual int numInputPorts() const override;
+    virtual int getPortChannelIndex(int port) const override;
+    virtual int numInputChannels(int port=0) const override;
+
+    /**
+     * @brief Obtain pointer to data tiler that is used for the second input tensor
+     *
+     * @return Pointer to DeepTiler object that describes the layout of the second input
+     */
+    DeepTiler * getSecondTiler() const {
+        return secondTiler_;
+    }
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    void setupNetworkPolygons();
+    void setupShaders();
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    DeepTiler *secondTiler_ = nullptr;         //!< Tiler that describes the second input tensor
+    int secondShape_[3] = {0, 0, 0};           //!< Width, height and channels of the second input tensor
+    int rows_ = 0;                             //!< Number of rows of each (transposed) first matrix and of the product
+    int inner_ = 0;                            //!< Length of the dot-products (inner dimension)
+    int columns_ = 0;                          //!< Number of columns of each (transposed) second matrix and of the product
+    int batches_ = 1;                          //!< Number of independent matrix products
+    bool transposeA_ = false;                  //!< Indicator that the first matrix is transposed
+    bool transposeB_ = false;                  //!< Indicator that the second matrix is transposed
+    bool fp32Accumulation_ = false;            //!< Indicator that accumulation and output use single precision
+    float alpha_ = 1.0f;                       //!< Scale factor for the product
+    VAO *vertexArray_ = nullptr;               //!< Vertex array object for the viewport-filling quad
+    VBO *vertexBuffer_ = nullptr;              //!< Vertex coordinates of the quad
+    IBO *indexBuffer_ = nullptr;               //!< Polygon connectivity of the quad
+    programptr shader_;                        //!< Shader program that computes the product
+    unistateptr shaderState_;                  //!< Uniform-variable state for #shader_
+};
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,235 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Pointwise-Chain Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "deeppointwisechainlayer.h"
+#include "../../gl/glexception.h"
+#include "../../common/logging.h"
+#include "deeptiler.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+DeepPointwiseChainLayer::DeepPointwiseChainLayer(const PointwiseChainBuilder & builder, int layerNumber) :
+      DeepFunctionLayer((const GPULayerBuilder &)builder, layerNumber), pooling_(builder.pooling_), stages_(builder.stages_) {
+    if (builder.getFlags() & LayerFlags::POST_BATCHNORM) THROW_EXCEPTION_ARGS(FynException,"Batchnorm not supported for this layer");
+    if ((stages_.empty()) && (pooling_ == PointwiseChainBuilder::POOL_NONE)) THROW_EXCEPTION_ARGS(FynException,"Empty pointwise chain in layer %s", builder.name_.c_str());
+    if ((int)stages_.size() > MAX_STAGES) THROW_EXCEPTION_ARGS(FynException,"Too many stages (%d) in pointwise chain %s, max is %d", (int)stages_.size(), builder.name_.c_str(), MAX_STAGES);
+    if (pooling_ != PointwiseChainBuilder::POOL_NONE) {
+        if ((builder.upsample_[0] != 1) || (builder.upsample_[1] != 1)) THROW_EXCEPTION_ARGS(FynException,"Upsampling cannot be combined with pooling in layer %s", builder.name_.c_str());
+        if ((builder.poolsize_[0] < 1) || (builder.poolsize_[1] < 1)) THROW_EXCEPTION_ARGS(FynException,"Illegal pool size in layer %s", builder.name_.c_str());
+        poolSize_[0] = builder.poolsize_[0];
+        poolSize_[1] = builder.poolsize_[1];
+    }
+    operands_.resize(2 * std::max((size_t)1, stages_.size()), 0.0f);
+    for (int i=0; i < (int)stages_.size(); i++) {
+        operands_[i*2] = stages_[i].operands[0];
+        operands_[i*2+1] = stages_[i].operands[1];
+    }
+}
+
+
+/**
+ * @copydoc GPULayerBase::cleanup
+ */
+void DeepPointwiseChainLayer::cleanup() {
+    // reset shaders here because the GL context is bound here (in case no cache is used)
+    shader_.reset();
+    DeepFunctionLayer::cleanup();
+}
+
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+
+/**
+ * @copydoc DeepFunctionLayer::renderChannelBatch
+ */
+void DeepPointwiseChainLayer::renderChannelBatch() {
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    int quads = tiler_->numOutputTiles();
+    GLState::drawElements(GL_TRIANGLES, quads * 6, GL_UNSIGNED_SHORT, (const GLvoid *) 0);
+}
+
+
+/**
+ * @copydoc DeepFunctionLayer::beforeRender
+ */
+void DeepPointwiseChainLayer::beforeRender() {
+    shader_->bind(shaderState_.get());
+}
+
+
+/**
+ * @copydoc DeepFunctionLayer::afterRender
+ */
+void DeepPointwiseChainLayer::afterRender() {
+    shader_->unbind();
+}
+
+
+/**
+ * @copydoc DeepFunctionLayer::setupShaders
+ */
+void DeepPointwiseChainLayer::setupShaders() {
+    char preproc[4096] = {0}, add[128];
+    ssize_t mc = (ssize_t)shaderPreprocessing(preproc, sizeof(preproc)-1);
+    assert(mc > 0);
+    switch (pooling_) {
+        case PointwiseChainBuilder::POOL_MAX:
+            snprintf(add, sizeof(add), "#define CHAIN_MAXPOOL\n#define POOLSIZE_X %d\n#define POOLSIZE_Y %d\n", poolSize_[0], poolSize_[1]);
+            break;
+        case PointwiseChainBuilder::POOL_AVG:
+            snprintf(add, sizeof(add), "#define CHAIN_AVGPOOL\n#define POOLSIZE_X %d\n#define POOLSIZE_Y %d\n", poolSize_[0], poolSize_[1]);
+            break;
+        default:
+            add[0] = 0;
+    }
+    strncat(preproc, add, mc);
+    mc -= strlen(add);
+    snprintf(add, sizeof(add), "#define NUM_OPERANDS %d\n", (int)operands_.size());
+    strncat(preproc, add, mc);
+    mc -= strlen(add);
+    std::string chain = chainMacro();
+    if ((ssize_t)chain.size() >= mc) THROW_EXCEPTION_ARGS(FynException,"Pointwise chain too long in layer %s", getName().c_str());
+    strncat(preproc, chain.c_str(), mc);
+    shader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deeppointwisechain.frag", preproc, typeid(this));
+    try {
+        shader_->bindAttributeLocation("attributes0", 0);
+        shader_->link();
+    } catch (GLException& ex) {
+        FNLOGE("Cannot link shader for layer %s",getName().c_str());
+        throw;
+    }
+    shaderState_ = UniformState::makeShared(shader_);
+    shaderState_->setUniformValue("inputLayer0", 0);
+    shaderState_->setUniformArray("operands", operands_.data(), (int)operands_.size(), true);
+    if (pooling_ != PointwiseChainBuilder::POOL_NONE) {
+        shaderState_->setUniformVec2("texStep", tiler_->getTextureStepX(), tiler_->getTextureStepY());
+    }
+}
+
+
+/**
+ * @brief Generate the preprocessor macro that executes the elementwise stages
+ *
+ * @return String with a definition of the \c CHAIN_OPS macro (including trailing newline)
+ *
+ * The macro takes the name of a \c vec4 variable and applies all stages of the chain in-place
+ * to that variable. Stage \c i reads its operands from the uniform array \c operands at the
+ * indices \c 2i and \c 2i+1.
+ */
+std::string DeepPointwiseChainLayer::chainMacro() const {
+    std::string macro("#define CHAIN_OPS(d)");
+    char op[160];
+    for (int i=0; i < (int)stages_.size(); i++) {
+        const PointwiseChainBuilder::Stage & st = stages_.at(i);
+        op[0] = 0;
+        switch (st.op) {
+            case PointwiseChainBuilder::STAGE_RELU:
+                if (st.operands[0] == 0.0f) snprintf(op, sizeof(op), " d=max(vec4(0.0),d);");
+                else snprintf(op, sizeof(op), " d=mix(operands[%d]*d,d,step(vec4(0.0),d));", i*2);
+                break;
+            case PointwiseChainBuilder::STAGE_CLIP:
+                snprintf(op, sizeof(op), " d=clamp(d,vec4(operands[%d]),vec4(operands[%d]));", i*2, i*2+1);
+                break;
+            case PointwiseChainBuilder::STAGE_SIGMOID:
+                snprintf(op, sizeof(op), " d=1.0/(1.0+exp(-d));");
+                break;
+            case PointwiseChainBuilder::STAGE_TANH:
+                snprintf(op, sizeof(op), " d=tanh(d);");
+                break;
+            case PointwiseChainBuilder::STAGE_ARITH: {
+                const char * opchar = "+";
+                switch (st.arith) {
+                    case ArithType::ADD:
+                        opchar = "+";
+                        break;
+                    case ArithType::SUB:
+                        opchar = "-";
+                        break;
+                    case ArithType::MUL:
+                        opchar = "*";
+                        break;
+                    case ArithType::DIV:
+                        opchar = "/";
+                        break;
+                }
+                snprintf(op, sizeof(op), " d%s=vec4(operands[%d]);", opchar, i*2);
+                break;
+            }
+            case PointwiseChainBuilder::STAGE_CAST: {
+                // NOTE same emulation as in DeepCastLayer, we stay in floating-point
+                double range[2] = {0.0, 0.0};
+                switch (st.cast) {
+                    case CastTarget::CT_INT32:
+                        range[0] = -2147483648.0;
+                        range[1] = 2147483647.0;
+                        break;
+                    case CastTarget::CT_INT16:
+                        range[0] = -32768.0;
+                        range[1] = 32767.0;
+                        break;
+                    case CastTarget::CT_INT8:
+                        range[0] = -128.0;
+                        range[1] = 127.0;
+                        break;
+                    case CastTarget::CT_UINT32:
+                        range[1] = 4294967295.0;
+                        break;
+                    case CastTarget::CT_UINT16:
+                        range[1] = 65535.0;
+                        break;
+                    case CastTarget::CT_UINT8:
+                        range[1] = 255.0;
+                        break;
+                    default:
+                        break;
+                }
+                if (range[1] > range[0]) snprintf(op, sizeof(op), " d=clamp(round(d),vec4(%.1f),vec4(%.1f));", range[0], range[1]);
+                break;
+            }
+        }
+        macro += op;
+    }
+    macro += "\n";
+    return macro;
+}
+
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
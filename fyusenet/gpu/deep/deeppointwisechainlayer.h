@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Pointwise-Chain Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+#include <string>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/uniformstate.h"
+#include "../../base/bufferspec.h"
+#include "deepfunctionlayer.h"
+#include "../pointwisechainbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+/**
+ * @brief Fused sequence of pooling/scaling and elementwise operations on deep tensors
+ *
+ * This layer replaces a sequence of simple layers like DeepMaxPoolLayer, DeepAvgPoolLayer,
+ * DeepScaleLayer, DeepSigmoidLayer, DeepTanhLayer, DeepSingletonArithmeticLayer and DeepCastLayer
+ * by a single render pass. Instead of writing each intermediate result to a texture and reading
+ * it back in the next layer, the fragment shader for the whole sequence is generated during
+ * setup() from the stages in the PointwiseChainBuilder and the data is kept in registers.
+ *
+ * The (optional) pooling operation is done first, as it is the only operation that requires
+ * access to neighboring pixels. All other operations are applied to the pooled (or sampled) value
+ * in the order they were added to the builder. Operands for the stages are supplied as uniform
+ * array, such that chains that only differ in their operand values share the same shader.
+ *
+ * @see PointwiseChainBuilder
+ */
+class DeepPointwiseChainLayer : public DeepFunctionLayer {
+ public:
+    constexpr static int MAX_STAGES = 16;
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepPointwiseChainLayer(const PointwiseChainBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void cleanup() override;
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    virtual void setupShaders() override;
+    virtual void renderChannelBatch() override;
+    virtual void beforeRender() override;
+    virtual void afterRender() override;
+    std::string chainMacro() const;
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    programptr shader_;                             //!< Shader program for the complete chain
+    unistateptr shaderState_;                       //!< UniformState object for the #shader_
+    PointwiseChainBuilder::poolop pooling_;         //!< Pooling operation at the start of the chain
+    int poolSize_[2] = {1, 1};                      //!< Pooling window size
+    std::vector<PointwiseChainBuilder::Stage> stages_;  //!< Elementwise operations in order of execution
+    std::vector<float> operands_;                   //!< Operand values for the stages (2 per stage), referenced by #shaderState_
+};
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
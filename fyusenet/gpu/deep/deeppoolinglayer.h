@@ -57,6 +57,13 @@ class DeepPoolingLayer : public DeepLayerBase {
     virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
     virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
     virtual void forward(uint64_t sequence) override;
+
+    /**
+     * @copydoc GPULayerBase::supportsOutputView
+     */
+    virtual bool supportsOutputView() const override {
+        return true;
+    }
  protected:
     // ------------------------------------------------------------------------
     // Non-public methods
@@ -0,0 +1,212 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Resize Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstring>
+#include <cassert>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "deepresizelayer.h"
+#include "../../gl/glexception.h"
+#include "../../common/logging.h"
+#include "deeptiler.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+DeepResizeLayer::DeepResizeLayer(const ScaleLayerBuilder & builder, int layerNumber) :
+    DeepLayerBase((const GPULayerBuilder &)builder, layerNumber) {
+    if (flags_ & (LayerFlags::RESIDUAL_INPUT | LayerFlags::POST_BATCHNORM)) THROW_EXCEPTION_ARGS(FynException, "This layer does not support residual inputs or batchnorm");
+    if (builder.rotation_ != 0) THROW_EXCEPTION_ARGS(FynException, "Rotation is not supported when resizing");
+    if (inputChannels_ != outputChannels_) THROW_EXCEPTION_ARGS(FynException, "Number of output channels must match number of input channels");
+    type_ = builder.scaleType_;
+    alignCorners_ = builder.alignCorners_;
+    outputSize_[0] = builder.resizedWidth();
+    outputSize_[1] = builder.resizedHeight();
+    if ((outputSize_[0] <= 0) || (outputSize_[1] <= 0)) THROW_EXCEPTION_ARGS(FynException, "Illegal output size %dx%d", outputSize_[0], outputSize_[1]);
+    // NOTE the tiler created by the base class only supports integer scale factors
+    delete tiler_;
+    tiler_ = new DeepTiler(builder.type_, width_, height_, outputSize_[0], outputSize_[1], inputChannels_, outputChannels_, inputPadding_, outputPadding_);
+    viewport_[0] = tiler_->getViewportWidth();
+    viewport_[1] = tiler_->getViewportHeight();
+}
+
+
+/**
+ * @copydoc LayerBase::cleanup
+ */
+void DeepResizeLayer::cleanup() {
+    delete vertexArray_;
+    delete vertexBuffer_;
+    delete indexBuffer_;
+    vertexArray_ = nullptr;
+    vertexBuffer_ = nullptr;
+    indexBuffer_ = nullptr;
+    // reset shaders here because the GL context is bound here (in case no cache is used)
+    shader_.reset();
+    shaderState_.reset();
+    DeepLayerBase::cleanup();
+}
+
+
+/**
+ * @copydoc LayerBase::setup
+ */
+void DeepResizeLayer::setup() {
+    setupNetworkPolygons();
+    setupShaders();
+    setupFBOs();
+    valid_ = true;
+}
+
+
+/**
+ * @brief Execute layer
+ *
+ * @param sequence Sequence number (\b must be stricly increasing)
+ *
+ * This function performs the actual computation that maps the input data to the output data
+ * for this layer. The supplied \p sequence number \b must be strictly increasing per network run
+ * and may also be used for debugging purposes, in case errors only manifests themselves after a
+ * certain number of computation cycles. It can also be used to keep track of the total number of
+ * inference runs. Internally, it is used to make sure that asynchronously transmitted data is
+ * up-to-date (on PBO reads for example).
+ */
+void DeepResizeLayer::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    vertexArray_->bind();
+    framebuffers_.at(0)->bind();
+    framebuffers_.at(0)->setWriteMask();
+    shader_->bind(shaderState_.get());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    shader_->unbind();
+    framebuffers_.at(0)->unbind();
+    vertexArray_->unbind();
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredInputBuffers
+ */
+std::vector<BufferSpec> DeepResizeLayer::getRequiredInputBuffers() const {
+    std::vector<BufferSpec> result;
+    result.push_back(BufferSpec(0, 0, tiler_->getInputTextureWidth(), tiler_->getInputTextureHeight(),
+                                TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                BufferSpec::FUNCTION_SOURCE).dataOrder(BufferSpec::order::GPU_DEEP));
+    return result;
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredOutputBuffers
+ */
+std::vector<BufferSpec> DeepResizeLayer::getRequiredOutputBuffers() const {
+    std::vector<BufferSpec> result;
+    result.push_back(BufferSpec(0, 0, viewport_[0], viewport_[1],
+                                TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                BufferSpec::FUNCTION_DEST).dataOrder(BufferSpec::order::GPU_DEEP));
+    return result;
+}
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @brief Compile shaders that implement the actual layer functionality
+ *
+ * This function obtains required shaders from the resource system, compiles/caches these shaders
+ * and performs base initializations on them.
+ */
+void DeepResizeLayer::setupShaders() {
+    char preproc[1024] = {0}, line[512];
+    ssize_t mc = (ssize_t)shaderPreprocessing(preproc, sizeof(preproc)-1);
+    assert(mc > 0);
+    snprintf(line, sizeof(line), "#define SRC_WIDTH %d\n#define SRC_HEIGHT %d\n#define SRC_PAD %d\n#define SRC_TILES_X %d\n"
+             "#define DST_WIDTH %d\n#define DST_HEIGHT %d\n#define DST_PAD %d\n#define DST_TILES_X %d\n#define DST_TILES %d\n%s%s",
+             width_, height_, inputPadding_, tiler_->numInputTiles(DeepTiler::HORIZONTAL),
+             outputSize_[0], outputSize_[1], outputPadding_, tiler_->numOutputTiles(DeepTiler::HORIZONTAL), tiler_->numOutputTiles(),
+             (type_ == ScalingType::LINEAR) ? "#define LINEAR_RESIZE\n" : "",
+             (alignCorners_) ? "#define ALIGN_CORNERS\n" : "");
+    strncat(preproc, line, mc);
+    mc -= strlen(line);
+    assert(mc > 0);
+    shader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepresize.frag", preproc, typeid(this));
+    try {
+        shader_->bindAttributeLocation("attributes0", 0);
+        shader_->link();
+    } catch (GLException& ex) {
+        FNLOGE("Cannot link shader for layer %s",getName().c_str());
+        throw;
+    }
+    shaderState_ = UniformState::makeShared(shader_);
+    shaderState_->setUniformValue("inputLayer0", 0);
+}
+
+
+/**
+ * @brief Setup a proxy polygon that is used to drive the fragment shader
+ *
+ * The shader derives the position to compute from the fragment coordinates, a single quad that
+ * covers the whole viewport is therefore used.
+ */
+void DeepResizeLayer::setupNetworkPolygons() {
+    float quad[4*4] = {-1.f, -1.f, 0.f, 0.f,
+                        1.f, -1.f, 1.f, 0.f,
+                        1.f,  1.f, 1.f, 1.f,
+                       -1.f,  1.f, 0.f, 1.f};
+    GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+    vertexArray_ = new VAO(context_);
+    vertexArray_->bind();
+    vertexBuffer_ = new VBO(context_);
+    vertexArray_->enableArray(0);
+    vertexBuffer_->setBufferData(quad, sizeof(quad), GL_STATIC_DRAW);
+    vertexBuffer_->bind();
+    vertexArray_->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    indexBuffer_ = new IBO(context_);
+    indexBuffer_->setBufferData(indices, sizeof(indices), GL_STATIC_DRAW);
+    indexBuffer_->bind();
+    vertexArray_->unbind();
+}
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
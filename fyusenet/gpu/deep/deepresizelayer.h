@@ -0,0 +1,92 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Resize Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/fbo.h"
+#include "../../gl/vbo.h"
+#include "../../gl/ibo.h"
+#include "../../gl/vao.h"
+#include "../../gl/uniformstate.h"
+#include "../../base/bufferspec.h"
+#include "deeplayerbase.h"
+#include "../scalelayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+/**
+ * @brief Spatial resize layer with arbitrary scale factors for deep tensor data
+ *
+ * This layer resizes deep-channel tensor data to an arbitrary output size, using either
+ * nearest-neighbor or bilinear interpolation. The mapping between output and input pixels
+ * either uses the half-pixel convention (default) or aligns the centers of the corner pixels,
+ * which corresponds to the \c align_corners option found in PyTorch and TensorFlow. As opposed
+ * to DeepScaleLayer, the interpolation is done in the shader and never reads across tile borders,
+ * such that the border pixels are not affected by the (zero) padding of the input tensor.
+ *
+ * A resize that is directly followed by a convolution does not need to be executed as a separate
+ * layer, as it can be folded into the input sampling of a DeepConvLayer1x1 or DeepConvLayerNxN
+ * (see ConvLayerBuilderTempl::resizeInput()), which uses the same sampling code.
+ *
+ * @see ScaleLayerBuilder, DeepScaleLayer
+ */
+class DeepResizeLayer : public DeepLayerBase {
+ public:
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepResizeLayer(const ScaleLayerBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void setup() override;
+    virtual void cleanup() override;
+    virtual void forward(uint64_t sequence) override;
+    virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
+    virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    void setupNetworkPolygons();
+    void setupShaders();
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    ScalingType type_ = ScalingType::LINEAR;   //!< Interpolation type
+    bool alignCorners_ = false;                //!< Indicator that the corner pixels of input and output are aligned
+    int outputSize_[2] = {0, 0};               //!< Unpadded output width and height
+    VAO *vertexArray_ = nullptr;               //!< Vertex array object for the viewport-filling quad
+    VBO *vertexBuffer_ = nullptr;              //!< Vertex coordinates of the quad
+    IBO *indexBuffer_ = nullptr;               //!< Polygon connectivity of the quad
+    programptr shader_;                        //!< Shader program for the resizing
+    unistateptr shaderState_;                  //!< Uniform-variable state for #shader_
+};
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,303 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep SoftMax Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstring>
+#include <cassert>
+#include <cfloat>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "deepsoftmaxlayer.h"
+#include "../../gl/glexception.h"
+#include "../../common/logging.h"
+#include "deeptiler.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+DeepSoftMaxLayer::DeepSoftMaxLayer(const SoftMaxLayerBuilder & builder, int layerNumber) :
+    DeepLayerBase((const GPULayerBuilder &)builder, layerNumber) {
+    if (flags_ & (LayerFlags::RESIDUAL_INPUT | LayerFlags::POST_BATCHNORM)) THROW_EXCEPTION_ARGS(FynException, "This layer does not support residual inputs or batchnorm");
+    axis_ = builder.axis_;
+    log_ = builder.log_;
+    topK_ = builder.topK_;
+    if (topK_ > 0) {
+        if (axis_ != SoftMaxAxis::CHANNEL) THROW_EXCEPTION_ARGS(FynException, "Top-k output is only supported for channel-wise softmax");
+        if (topK_ > MAX_TOPK) THROW_EXCEPTION_ARGS(FynException, "Top-k output supports at most %d entries", MAX_TOPK);
+        if (outputChannels_ != 2*topK_) THROW_EXCEPTION_ARGS(FynException, "Top-k output requires %d output channels, got %d", 2*topK_, outputChannels_);
+    } else {
+        if (outputChannels_ != inputChannels_) THROW_EXCEPTION_ARGS(FynException, "Number of output channels must match number of input channels");
+    }
+}
+
+
+/**
+ * @copydoc LayerBase::cleanup
+ */
+void DeepSoftMaxLayer::cleanup() {
+    delete vertexArray_;
+    delete vertexBuffer_;
+    delete indexBuffer_;
+    delete statsFBO_;
+    delete mergeFBO_;
+    delete rowSums_;
+    delete tileSums_;
+    vertexArray_ = nullptr;
+    vertexBuffer_ = nullptr;
+    indexBuffer_ = nullptr;
+    statsFBO_ = nullptr;
+    mergeFBO_ = nullptr;
+    rowSums_ = nullptr;
+    tileSums_ = nullptr;
+    statsShader_.reset();
+    mergeShader_.reset();
+    outputShader_.reset();
+    statsState_.reset();
+    mergeState_.reset();
+    outputState_.reset();
+    DeepLayerBase::cleanup();
+}
+
+
+/**
+ * @copydoc LayerBase::setup
+ */
+void DeepSoftMaxLayer::setup() {
+    setupNetworkPolygons();
+    setupShaders();
+    setupFBOs();
+    valid_ = true;
+}
+
+
+/**
+ * @brief Execute layer
+ *
+ * @param sequence Sequence number (\b must be stricly increasing)
+ *
+ * This function performs the actual computation that maps the input data to the output data
+ * for this layer. The supplied \p sequence number \b must be strictly increasing per network run
+ * and may also be used for debugging purposes, in case errors only manifests themselves after a
+ * certain number of computation cycles. It can also be used to keep track of the total number of
+ * inference runs. Internally, it is used to make sure that asynchronously transmitted data is
+ * up-to-date (on PBO reads for example).
+ */
+void DeepSoftMaxLayer::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    vertexArray_->bind();
+    //---------------------------------------------
+    // Statistics (max / sum of exponentials)
+    //---------------------------------------------
+    statsFBO_->bindWithViewport();
+    statsFBO_->setWriteMask();
+    statsShader_->bind(statsState_.get());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    statsShader_->unbind(true);
+    statsFBO_->unbind();
+    GLuint stats[2] = {statsFBO_->getAttachment(), (rowSums_) ? rowSums_->getHandle() : 0};
+    if (mergeFBO_) {
+        mergeFBO_->bindWithViewport();
+        mergeFBO_->setWriteMask();
+        mergeShader_->bind(mergeState_.get());
+        GLState::bindTexture(GL_TEXTURE_2D, stats[0]);
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, stats[1]);
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        mergeShader_->unbind(true);
+        mergeFBO_->unbind();
+        stats[0] = mergeFBO_->getAttachment();
+        stats[1] = tileSums_->getHandle();
+    }
+    //---------------------------------------------
+    // Output
+    //---------------------------------------------
+    framebuffers_.at(0)->bind();
+    framebuffers_.at(0)->setWriteMask();
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    outputShader_->bind(outputState_.get());
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE1);
+    GLState::bindTexture(GL_TEXTURE_2D, stats[0]);
+    GLState::activeTexture(GL_TEXTURE2);
+    GLState::bindTexture(GL_TEXTURE_2D, stats[1]);
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    outputShader_->unbind();
+    framebuffers_.at(0)->unbind();
+    vertexArray_->unbind();
+    GLState::activeTexture(GL_TEXTURE0);
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredInputBuffers
+ */
+std::vector<BufferSpec> DeepSoftMaxLayer::getRequiredInputBuffers() const {
+    std::vector<BufferSpec> result;
+    result.push_back(BufferSpec(0, 0, tiler_->getInputTextureWidth(), tiler_->getInputTextureHeight(),
+                                TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                BufferSpec::FUNCTION_SOURCE).dataOrder(BufferSpec::order::GPU_DEEP));
+    return result;
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredOutputBuffers
+ */
+std::vector<BufferSpec> DeepSoftMaxLayer::getRequiredOutputBuffers() const {
+    std::vector<BufferSpec> result;
+    BufferSpec::dtype type = TEXTURE_TYPE_DEFAULT;
+    // NOTE in top-k mode, the output contains channel indices which are not exactly
+    // representable in half-precision for large channel counts, so we use single-precision
+    if (topK_ > 0) type = BufferSpec::dtype::FLOAT32;
+    result.push_back(BufferSpec(0, 0, viewport_[0], viewport_[1],
+                                TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, type,
+                                BufferSpec::FUNCTION_DEST).dataOrder(BufferSpec::order::GPU_DEEP));
+    return result;
+}
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @brief Compile shaders that implement the actual layer functionality
+ *
+ * This function obtains required shaders from the resource system, compiles/caches these shaders
+ * and performs base initializations on them.
+ */
+void DeepSoftMaxLayer::setupShaders() {
+    char preproc[1024] = {0}, line[512];
+    ssize_t mc = (ssize_t)shaderPreprocessing(preproc, sizeof(preproc)-1);
+    assert(mc > 0);
+    snprintf(line, sizeof(line), "#define FLT_MAX %.8e\n#define IN_CHANNELS %d\n#define IN_SLICES %d\n#define IN_TILES_X %d\n"
+             "#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n#define OUT_PAD %d\n#define OUT_TILES_X %d\n#define OUT_TILES %d\n",
+             FLT_MAX, inputChannels_, tiler_->numInputTiles(), tiler_->numInputTiles(DeepTiler::HORIZONTAL), width_, height_,
+             inputPadding_, outputPadding_, tiler_->numOutputTiles(DeepTiler::HORIZONTAL), tiler_->numOutputTiles());
+    strncat(preproc, line, mc);
+    mc -= strlen(line);
+    assert(mc > 0);
+    if (axis_ == SoftMaxAxis::SPATIAL) {
+        strncat(preproc, "#define SPATIAL\n", mc);
+        mc = sizeof(preproc) - 1 - strlen(preproc);
+    }
+    if (log_) {
+        strncat(preproc, "#define LOG_SOFTMAX\n", mc);
+        mc = sizeof(preproc) - 1 - strlen(preproc);
+    }
+    if (topK_ > 0) {
+        snprintf(line, sizeof(line), "#define TOP_K %d\n", topK_);
+        strncat(preproc, line, mc);
+        mc -= strlen(line);
+    }
+    assert(mc > 0);
+    statsShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepsoftmaxstats.frag", preproc, typeid(this));
+    statsShader_->bindAttributeLocation("attributes0", 0);
+    statsShader_->link();
+    statsState_ = UniformState::makeShared(statsShader_);
+    statsState_->setUniformValue("inputLayer0", 0);
+    if (axis_ == SoftMaxAxis::SPATIAL) {
+        mergeShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/softmaxmerge.frag", preproc, typeid(this));
+        mergeShader_->bindAttributeLocation("attributes0", 0);
+        mergeShader_->link();
+        mergeState_ = UniformState::makeShared(mergeShader_);
+        mergeState_->setUniformValue("rowMax", 0);
+        mergeState_->setUniformValue("rowSum", 1);
+    }
+    outputShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepsoftmax.frag", preproc, typeid(this));
+    outputShader_->bindAttributeLocation("attributes0", 0);
+    outputShader_->link();
+    outputState_ = UniformState::makeShared(outputShader_);
+    outputState_->setUniformValue("inputLayer0", 0);
+    outputState_->setUniformValue("statsLayer0", 1);
+    outputState_->setUniformValue("statsLayer1", 2, true);
+}
+
+
+/**
+ * @brief Setup a proxy polygon that is used to drive the fragment shaders
+ *
+ * All passes of this layer derive the position to compute from the fragment coordinates, a
+ * single quad that covers the whole viewport is therefore used for all of them.
+ */
+void DeepSoftMaxLayer::setupNetworkPolygons() {
+    float quad[4*4] = {-1.f, -1.f, 0.f, 0.f,
+                        1.f, -1.f, 1.f, 0.f,
+                        1.f,  1.f, 1.f, 1.f,
+                       -1.f,  1.f, 0.f, 1.f};
+    GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+    vertexArray_ = new VAO(context_);
+    vertexArray_->bind();
+    vertexBuffer_ = new VBO(context_);
+    vertexArray_->enableArray(0);
+    vertexBuffer_->setBufferData(quad, sizeof(quad), GL_STATIC_DRAW);
+    vertexBuffer_->bind();
+    vertexArray_->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    indexBuffer_ = new IBO(context_);
+    indexBuffer_->setBufferData(indices, sizeof(indices), GL_STATIC_DRAW);
+    indexBuffer_->bind();
+    vertexArray_->unbind();
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ */
+void DeepSoftMaxLayer::setupFBOs() {
+    DeepLayerBase::setupFBOs();
+    if (axis_ == SoftMaxAxis::SPATIAL) {
+        int tiles = tiler_->numInputTiles();
+        statsFBO_ = new FBO(context_, tiles, height_, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        rowSums_ = new Texture2D(tiles, height_, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+        statsFBO_->addTexture(GL_COLOR_ATTACHMENT1, *rowSums_);
+        statsFBO_->unbind();
+        mergeFBO_ = new FBO(context_, tiles, 1, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        tileSums_ = new Texture2D(tiles, 1, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+        mergeFBO_->addTexture(GL_COLOR_ATTACHMENT1, *tileSums_);
+        mergeFBO_->unbind();
+    } else {
+        statsFBO_ = new FBO(context_, width_, height_, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        statsFBO_->unbind();
+    }
+}
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
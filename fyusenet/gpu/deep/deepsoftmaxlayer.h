@@ -0,0 +1,114 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep SoftMax Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/fbo.h"
+#include "../../gl/vbo.h"
+#include "../../gl/ibo.h"
+#include "../../gl/vao.h"
+#include "../../gl/texture.h"
+#include "../../gl/uniformstate.h"
+#include "../../base/bufferspec.h"
+#include "deeplayerbase.h"
+#include "../softmaxlayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+/**
+ * @brief Numerically stable softmax / log-softmax layer for deep tensors
+ *
+ * This layer computes the softmax (or its logarithm) either over all channels of each spatial
+ * position or over all spatial positions of each channel. To avoid overflows in the exponentials,
+ * the maximum is subtracted from the input before exponentiation, which requires a reduction for
+ * the maximum followed by a reduction for the sum of the exponentials. The statistics are always
+ * accumulated and stored in 32-bit floating-point textures, regardless of the precision of the
+ * layer.
+ *
+ * For a channel-wise softmax, the first pass renders the maximum and the sum of exponentials for
+ * each spatial position into a layer-internal texture and the second pass computes the output
+ * from the input and those statistics. For a spatial softmax, the first pass computes the
+ * statistics for each row of each tile, a second pass merges the rows into the statistics for
+ * each tile (rescaling the partial sums to the common maximum) and a third pass computes the
+ * output.
+ *
+ * In top-k mode, the output pass selects the \e k largest channels for each spatial position and
+ * writes their channel index and (log-)probability as pairs into the output tensor, which then
+ * has \f$ 2k \f$ channels. This is meant for classifiers, where only the best-ranked classes are
+ * of interest and the full probability tensor does not have to be downloaded from the GPU. The
+ * selection uses a repeated scan over all channels per output tile and is only intended for
+ * small values of \e k.
+ *
+ * @see SoftMaxLayerBuilder
+ */
+class DeepSoftMaxLayer : public DeepLayerBase {
+ public:
+    constexpr static int MAX_TOPK = 32;   //!< Maximum number of (index, probability) pairs in top-k mode
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepSoftMaxLayer(const SoftMaxLayerBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void setup() override;
+    virtual void cleanup() override;
+    virtual void forward(uint64_t sequence) override;
+    virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
+    virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    void setupNetworkPolygons();
+    virtual void setupFBOs() override;
+    void setupShaders();
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    SoftMaxAxis axis_ = SoftMaxAxis::CHANNEL;  //!< Axis along which the softmax is normalized
+    bool log_ = false;                         //!< Indicator that the log-softmax is computed
+    int topK_ = 0;                             //!< Number of (index, probability) pairs to output, 0 for full output
+    VAO *vertexArray_ = nullptr;               //!< Vertex array object for the viewport-filling quad that is used for all passes
+    VBO *vertexBuffer_ = nullptr;              //!< Vertex coordinates of the quad
+    IBO *indexBuffer_ = nullptr;               //!< Polygon connectivity of the quad
+    FBO *statsFBO_ = nullptr;                  //!< %FBO for the first pass (per-position or per-row statistics)
+    FBO *mergeFBO_ = nullptr;                  //!< %FBO for the merged per-tile statistics (spatial softmax only)
+    Texture2D *rowSums_ = nullptr;             //!< Second render target of #statsFBO_ (spatial softmax only)
+    Texture2D *tileSums_ = nullptr;            //!< Second render target of #mergeFBO_ (spatial softmax only)
+    programptr statsShader_;                   //!< Shader for the first pass
+    programptr mergeShader_;                   //!< Shader that merges the per-row statistics (spatial softmax only)
+    programptr outputShader_;                  //!< Shader for the output pass
+    unistateptr statsState_;                   //!< Uniform-variable state for #statsShader_
+    unistateptr mergeState_;                   //!< Uniform-variable state for #mergeShader_
+    unistateptr outputState_;                  //!< Uniform-variable state for #outputShader_
+};
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
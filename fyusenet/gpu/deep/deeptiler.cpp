@@ -96,6 +96,34 @@ DeepTiler::DeepTiler(LayerType ltype, int width, int height, int inputChannels,
 
 
 
+/**
+ * @brief Constructor for layers with arbitrary output size
+ *
+ * @param ltype Layer type that this tiler is going to be used for
+ * @param width Tensor width on the input side
+ * @param height Tensor height on the input side
+ * @param outputWidth Tensor width on the output side
+ * @param outputHeight Tensor height on the output side
+ * @param inputChannels Number of input channels
+ * @param outputChannels Number of output channels
+ * @param inputPadding Spatial padding on the input tensor (always symmetric)
+ * @param outputPadding Spatial padding on the output tensor (always symmetric)
+ *
+ * Initializes a tiler object for layers where the output size is not an integer multiple or
+ * fraction of the input size (e.g. arbitrary resizing). As those layers do not use the
+ * tile-based input texture coordinates, no scaling factors are maintained.
+ */
+DeepTiler::DeepTiler(LayerType ltype, int width, int height, int outputWidth, int outputHeight,
+                     int inputChannels, int outputChannels, int inputPadding, int outputPadding) :
+    DeepTiler(ltype, width, height, inputChannels, outputChannels, 1.0f, 1.0f, inputPadding, outputPadding, 1, 1, 1, 1) {
+    outputWidth_ = outputWidth;
+    outputHeight_ = outputHeight;
+    viewport_[0] = outputTiling_[0] * (outputWidth_ + outputPadding_) + outputPadding_;
+    viewport_[1] = outputTiling_[1] * (outputHeight_ + outputPadding_) + outputPadding_;
+}
+
+
+
 /**
  * @brief Compute a set of tiles for the output tensor configuration
  *
@@ -289,6 +317,26 @@ int DeepTiler::getOutputHeight() const {
 }
 
 
+/**
+ * @brief Get spatial padding of each input tile
+ *
+ * @return Padding (pixels) on each side of an input tile
+ */
+int DeepTiler::getInputPadding() const {
+    return inputPadding_;
+}
+
+
+/**
+ * @brief Get spatial padding of each output tile
+ *
+ * @return Padding (pixels) on each side of an output tile
+ */
+int DeepTiler::getOutputPadding() const {
+    return outputPadding_;
+}
+
+
 /**
  * @brief Retrieve number of input channels
  *
@@ -441,6 +489,24 @@ std::pair<float,float> DeepTiler::Tile::midPoint() const {
 }
 
 
+/**
+ * @brief Compute the input padding that is required by a (dilated) convolution
+ *
+ * @param kernel Isotropic convolution kernel size
+ * @param dilationX Horizontal dilation factor
+ * @param dilationY Vertical dilation factor
+ *
+ * @return Minimum padding (in pixels) on the input tiles such that all taps of the convolution
+ *         window stay within the tile or its (zero) padding
+ *
+ * As the padding on deep tensors is symmetric and isotropic, the larger of the two per-axis
+ * requirements is returned for anisotropic dilation.
+ */
+int DeepTiler::requiredInputPadding(int kernel, int dilationX, int dilationY) {
+    return std::max(dilationX, dilationY) * ((kernel - 1) / 2);
+}
+
+
 /**
  * @brief Create an (input) tile with a unit-texture quadrilateral
  *
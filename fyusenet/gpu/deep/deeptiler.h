@@ -85,6 +85,8 @@ class DeepTiler {
     DeepTiler(LayerType ltype, int width, int height, int inputChannels, int outputChannels,
               float hscale, float vscale, int inputPadding, int outputPadding,
               int horizDown, int vertDown, int horizUp, int vertUp, int kernel=1);
+    DeepTiler(LayerType ltype, int width, int height, int outputWidth, int outputHeight,
+              int inputChannels, int outputChannels, int inputPadding, int outputPadding);
 
     // ------------------------------------------------------------------------
     // Public methods
@@ -93,6 +95,7 @@ class DeepTiler {
     std::vector<Tile> createInputTiles(int xPixelOffset,int yPixelOffset,int texID=0) const;
     Tile getDefaultTextureExtents() const;
     static Tile getUnitTextureExtents();
+    static int requiredInputPadding(int kernel, int dilationX, int dilationY);
     int getViewportWidth() const;
     int getViewportHeight() const;
     int getInputTextureWidth() const;
@@ -105,6 +108,8 @@ class DeepTiler {
     int numOutputTiles(tx mode = ALL) const;
     int getOutputWidth() const;
     int getOutputHeight() const;
+    int getInputPadding() const;
+    int getOutputPadding() const;
     float getTextureStepX() const;
     float getTextureStepY() const;
 
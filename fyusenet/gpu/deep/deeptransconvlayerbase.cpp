@@ -47,6 +47,8 @@ namespace deep {
 DeepTransConvLayerBase::DeepTransConvLayerBase(const ConvLayerBuilder& builder, int layerNumber):DeepConvLayerBase(builder, layerNumber) {
     assert(builder.upsample_[0] == builder.upsample_[1]);
     assert(builder.upsample_[0] == 2 && builder.upsample_[1] == 2);
+    // NOTE transpose convolutions use their own weight layout, which is not quantized
+    quantizedWeights_ = false;
     upsample_[0] = builder.upsample_[0];
     upsample_[1] = builder.upsample_[1];
     stencilBuffer_ = 0;
@@ -88,32 +90,32 @@ void DeepTransConvLayerBase::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_STENCIL_TEST);
-    glDepthFunc(GL_ALWAYS);
-    glDepthMask(GL_FALSE);
-    glStencilOp(GL_KEEP,GL_KEEP,GL_KEEP);
-    glBlendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
-    glBlendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
-    glStencilMask(0xFF);
-    glClearColor(0,0,0,0);
-    glViewport(0,0,viewport_[0],viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_STENCIL_TEST);
+    GLState::depthFunc(GL_ALWAYS);
+    GLState::depthMask(GL_FALSE);
+    GLState::stencilOp(GL_KEEP,GL_KEEP,GL_KEEP);
+    GLState::blendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
+    GLState::blendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
+    GLState::stencilMask(0xFF);
+    GLState::clearColor(0,0,0,0);
+    GLState::viewport(0,0,viewport_[0],viewport_[1]);
     vertexArray_->bind();
     framebuffers_.at(0)->bind();
     framebuffers_.at(0)->setWriteMask();
-    glClear(GL_COLOR_BUFFER_BIT);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
-    glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D,inputCoordTexture_);
-    glActiveTexture(GL_TEXTURE5);
-    glBindTexture(GL_TEXTURE_2D,weightTexture_);
-    glActiveTexture(GL_TEXTURE6);
-    glBindTexture(GL_TEXTURE_2D,biasTexture_);
+    GLState::clear(GL_COLOR_BUFFER_BIT);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE4);
+    GLState::bindTexture(GL_TEXTURE_2D,inputCoordTexture_);
+    GLState::activeTexture(GL_TEXTURE5);
+    GLState::bindTexture(GL_TEXTURE_2D,weightTexture_);
+    GLState::activeTexture(GL_TEXTURE6);
+    GLState::bindTexture(GL_TEXTURE_2D,biasTexture_);
 
     if (flags_ & LayerFlags::RESIDUAL_INPUT) {
         // TODO (mw) residual code here
@@ -125,8 +127,8 @@ void DeepTransConvLayerBase::forward(uint64_t sequence) {
 
     framebuffers_.at(0)->unbind();
     vertexArray_->unbind();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
 }
 
 
@@ -169,12 +171,11 @@ void DeepTransConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, s
         }
     }
     if (!weightTexture_) glGenTextures(1,&weightTexture_);
-    glBindTexture(GL_TEXTURE_2D,weightTexture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-#ifndef HIGH_PRECISION
+    GLState::bindTexture(GL_TEXTURE_2D,weightTexture_);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     if (halfSupport_) {
         unsigned int * fp16 = FloatConversion::getInstance()->toFP16UI(weights,texwidth*texheight*PIXEL_PACKING);
 #ifdef GL_RGBA32UI
@@ -184,11 +185,8 @@ void DeepTransConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, s
 #endif
         delete [] fp16;
     } else {
-        glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA16F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
+        glTexImage2D(GL_TEXTURE_2D,0,(highPrecision_) ? GL_RGBA32F : GL_RGBA16F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
     }
-#else
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA32F,texwidth,texheight,0,GL_RGBA,GL_FLOAT,weights);
-#endif
     delete [] weights;
     //------------------------------------------------------
     // If we have the post-BN flag set, store the batchnorm
@@ -219,16 +217,12 @@ void DeepTransConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, s
         }
     }
     if (!biasTexture_) glGenTextures(1,&biasTexture_);
-    glBindTexture(GL_TEXTURE_2D,biasTexture_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-#ifdef HIGH_PRECISION
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA32F,1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING,1,0,GL_RGBA,GL_FLOAT,bias);
-#else
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA16F,1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING,1,0,GL_RGBA,GL_FLOAT,bias);
-#endif
+    GLState::bindTexture(GL_TEXTURE_2D,biasTexture_);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D,0,(highPrecision_) ? GL_RGBA32F : GL_RGBA16F,1+(outputChannels_+PIXEL_PACKING-1)/PIXEL_PACKING,1,0,GL_RGBA,GL_FLOAT,bias);
     delete [] bias;
 }
 
@@ -315,11 +309,11 @@ void DeepTransConvLayerBase::setupNetworkPolygons(VAO *vao) {
     // in vertex shader...
     //---------------------------------------------
     glGenTextures(1,&inputCoordTexture_);
-    glBindTexture(GL_TEXTURE_2D,inputCoordTexture_);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+    GLState::bindTexture(GL_TEXTURE_2D,inputCoordTexture_);
+    GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_NEAREST);
     float * texdata = new float[tiler_->numInputTiles()*4];
     DeepTiler::Tile defex = tiler_->getDefaultTextureExtents();
     std::vector<DeepTiler::Tile> tiles = tiler_->createInputTiles(0,0);
@@ -378,13 +372,13 @@ void DeepTransConvLayerBase::setupStencilBuffer() {
     // setup...
     //-----------------------------------------------
     GLuint helptex=0;
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     glGenTextures(1,&helptex);
-    glBindTexture(GL_TEXTURE_2D,helptex);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GLState::bindTexture(GL_TEXTURE_2D,helptex);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     bool odd = ((viewport_[0] & 1) == 1);
     if (odd) glPixelStorei(GL_UNPACK_ALIGNMENT,1);
     unsigned char * helper = new unsigned char[viewport_[0]*viewport_[1]];
@@ -493,20 +487,20 @@ void DeepTransConvLayerBase::setupStencilBuffer() {
     //-----------------------------------------------
     //-----------------------------------------------
     fbo->bind();
-    glViewport(0, 0, viewport_[0], viewport_[1]);
-    glStencilFuncSeparate(GL_FRONT_AND_BACK,GL_ALWAYS,0,0xFF);
-    glStencilMask(0xFF);
-    glClearColor(0, 0, 0, 0);
-    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_STENCIL_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_STENCIL_TEST);
-    glDepthFunc(GL_ALWAYS);
-    glStencilOp(GL_KEEP,GL_KEEP,GL_INCR);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::stencilFuncSeparate(GL_FRONT_AND_BACK,GL_ALWAYS,0,0xFF);
+    GLState::stencilMask(0xFF);
+    GLState::clearColor(0, 0, 0, 0);
+    GLState::clear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_STENCIL_BUFFER_BIT);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_STENCIL_TEST);
+    GLState::depthFunc(GL_ALWAYS);
+    GLState::stencilOp(GL_KEEP,GL_KEEP,GL_INCR);
     for (int pass=0; pass < 4; pass++) {
         shader->setUniformValue("pass",pass);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        GLState::drawArrays(GL_TRIANGLE_FAN, 0, 4);
     }
-    glDisable(GL_DEPTH_TEST);
+    GLState::disable(GL_DEPTH_TEST);
     //-----------------------------------------------
     // ...and cleanup
     //-----------------------------------------------
@@ -514,7 +508,7 @@ void DeepTransConvLayerBase::setupStencilBuffer() {
     fbo->unbind();
     vao->unbind();
     vbo->unbind();
-    glDeleteTextures(1, &helptex);
+    GLState::deleteTextures(1, &helptex);
     delete vbo;
     delete vao;
     delete fbo;
@@ -83,21 +83,21 @@ void DeepTransposeLayer::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_BLEND);
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glViewport(0,0,viewport_[0],viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    GLState::clearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    GLState::viewport(0,0,viewport_[0],viewport_[1]);
     framebuffers_.at(0)->bind();
     framebuffers_.at(0)->setWriteMask();
-    glClear(GL_COLOR_BUFFER_BIT);
+    GLState::clear(GL_COLOR_BUFFER_BIT);
     vertexArray_->bind();
     shader_->bind(shaderState_.get());
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
     int quads = outTiler_->numOutputTiles();
-    glDrawElements(GL_TRIANGLES, quads*6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    GLState::drawElements(GL_TRIANGLES, quads*6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
     shader_->unbind();
     framebuffers_.at(0)->unbind();
     vertexArray_->unbind();
@@ -0,0 +1,547 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Winograd 3x3 Convolutional Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/shaderprogram.h"
+#include "../../gl/glinfo.h"
+#include "../../gl/glexception.h"
+#include "../../gl/glstate.h"
+#include "../../common/logging.h"
+#include "../floatconversion.h"
+#include "deepconvlayerNxN.h"
+#include "deepwinogradconvlayer.h"
+
+//-------------------------------------- Global Variables ------------------------------------------
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+/**
+ * Filter transformation matrix \f$ G \f$ for F(2x2,3x3)
+ */
+static const float WINOGRAD_G[4][3] = {{1.0f,  0.0f, 0.0f},
+                                       {0.5f,  0.5f, 0.5f},
+                                       {0.5f, -0.5f, 0.5f},
+                                       {0.0f,  0.0f, 1.0f}};
+
+/**
+ * Benchmark results of isPreferred(), keyed by renderer string and layer shape
+ */
+static std::unordered_map<std::string, bool> benchmarkCache;
+
+/**
+ * Lock that protects #benchmarkCache
+ */
+static std::mutex benchmarkLock;
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+
+/**
+ * @copydoc DeepConvLayerBase::DeepConvLayerBase
+ */
+DeepWinogradConvLayer::DeepWinogradConvLayer(const ConvLayerBuilder & builder, int layerNumber) : DeepConvLayerBase(builder, layerNumber) {
+    assert(kernel_ == 3);
+    assert((downsample_[0] == 1) && (downsample_[1] == 1));
+    // NOTE the transformed weights are not quantized
+    quantizedWeights_ = false;
+    if (inputPadding_ < 1) THROW_EXCEPTION_ARGS(FynException,"Winograd convolution requires an input padding of at least 1 (layer %s)", getName().c_str());
+    blocks_[0] = (tiler_->getOutputWidth() + 1) / 2;
+    blocks_[1] = (tiler_->getOutputHeight() + 1) / 2;
+    paddedInputTiles_ = TILES_PER_INSTANCE * ((tiler_->numInputTiles() + TILES_PER_INSTANCE - 1) / TILES_PER_INSTANCE);
+    gridSize(paddedInputTiles_, 4 * blocks_[0], 4 * blocks_[1], inputColumns_, transInputSize_[0], transInputSize_[1]);
+    gridSize(tiler_->numOutputTiles(), 4 * blocks_[0], 4 * blocks_[1], outputColumns_, productSize_[0], productSize_[1]);
+}
+
+
+/**
+ * @copydoc GPULayerBase::cleanup
+ */
+void DeepWinogradConvLayer::cleanup() {
+    delete transInputFBO_;
+    delete productFBO_;
+    transInputFBO_ = nullptr;
+    productFBO_ = nullptr;
+    inputState_.reset();
+    gemmState_.reset();
+    outputState_.reset();
+    inputShader_.reset();
+    gemmShader_.reset();
+    outputShader_.reset();
+    DeepConvLayerBase::cleanup();
+}
+
+
+/**
+ * @brief Check if a convolution can be computed by this class
+ *
+ * @param builder Builder that contains the convolution parameters
+ *
+ * @retval true if the convolution parameters are supported by this class
+ * @retval false otherwise
+ *
+ * @pre The GL context that is to be used for running the inference is current to the calling thread
+ *
+ * Supported are regular (non-grouped) 3x3 convolutions without dilation, upsampling or
+ * downsampling on input tensors with a padding of at least one pixel. In addition, the
+ * intermediate textures must not exceed the maximum texture size.
+ */
+bool DeepWinogradConvLayer::isSupported(const ConvLayerBuilder & builder) {
+    if ((builder.kernel_ != 3) || (builder.groupSize_ != 1) || (builder.inputPadding_ < 1)) return false;
+    if ((builder.downsample_[0] != 1) || (builder.downsample_[1] != 1)) return false;
+    if ((builder.upsample_[0] != 1) || (builder.upsample_[1] != 1)) return false;
+    if ((builder.dilation_[0] != 1) || (builder.dilation_[1] != 1)) return false;
+    if (builder.sourceStep_ != 1.f) return false;
+    if ((builder.arrayInput_) || (builder.arrayOutput_)) return false;
+    int intiles = (builder.in() + PIXEL_PACKING - 1) / PIXEL_PACKING;
+    int outtiles = (builder.out() + PIXEL_PACKING - 1) / PIXEL_PACKING;
+    int padtiles = TILES_PER_INSTANCE * ((intiles + TILES_PER_INSTANCE - 1) / TILES_PER_INSTANCE);
+    int tilewidth = 4 * ((builder.width() + 1) / 2);
+    int tileheight = 4 * ((builder.height() + 1) / 2);
+    int cols = 0, width[2] = {0, 0}, height[2] = {0, 0};
+    gridSize(padtiles, tilewidth, tileheight, cols, width[0], height[0]);
+    gridSize(outtiles, tilewidth, tileheight, cols, width[1], height[1]);
+    int maxsize = GLInfo::getMaximumTextureSize();
+    if ((std::max(width[0], width[1]) > maxsize) || (std::max(height[0], height[1]) > maxsize)) return false;
+    if ((padtiles * PIXEL_PACKING > maxsize) || (outtiles * 16 > maxsize)) return false;
+    // NOTE the proxy polygons are indexed with 16-bit indices
+    return ((outtiles * 16 + 1) * 4 <= 65535);
+}
+
+
+/**
+ * @brief Check if this class should be used for a convolution when no explicit choice was made
+ *
+ * @param builder Builder that contains the convolution parameters
+ *
+ * @retval true if the convolution is supported by this class and ran faster than the direct
+ *              implementation on the current GPU
+ * @retval false otherwise
+ *
+ * @pre The GL context that is to be used for running the inference is current to the calling thread
+ *
+ * Whether the saved multiplications outweigh the two additional render passes and the larger
+ * intermediate textures depends on the GPU and the layer shape. For that reason, this function
+ * instantiates both this class and DeepConvLayerNxN with the parameters in the \p builder, loads
+ * (zero) weights into them and measures their forward() times, see benchmark(). The Winograd
+ * implementation is only preferred if it is faster by at least a factor of #MIN_SPEEDUP, as it
+ * is slightly less accurate. The outcome is cached per renderer and shape, such that each
+ * combination is only measured once per process.
+ *
+ * Layers with quantized weights are never switched to this class, as it does not support
+ * quantization.
+ */
+bool DeepWinogradConvLayer::isPreferred(const ConvLayerBuilder & builder) {
+    if ((builder.quantizeWeights_) || (!isSupported(builder))) return false;
+    char shape[128];
+    snprintf(shape, sizeof(shape), "|%dx%dx%d:%d|%d:%d|%d|0x%x", builder.width(), builder.height(), builder.in(), builder.out(),
+             builder.inputPadding_, builder.outputPadding_, (int)builder.precision_, (unsigned int)builder.getFlags());
+    std::string key = GLInfo::getRendererString() + shape;
+    {
+        std::lock_guard<std::mutex> lck(benchmarkLock);
+        auto it = benchmarkCache.find(key);
+        if (it != benchmarkCache.end()) return it->second;
+    }
+    DeepConvLayerNxN direct(builder, builder.number_);
+    DeepWinogradConvLayer winograd(builder, builder.number_);
+    double directtime = benchmark(direct, builder);
+    double winogradtime = benchmark(winograd, builder);
+    bool preferred = (winogradtime * MIN_SPEEDUP < directtime);
+    FNLOGD("Layer %s: direct %.1fus, Winograd %.1fus, using %s convolution", builder.name_.c_str(), directtime, winogradtime, (preferred) ? "Winograd" : "direct");
+    std::lock_guard<std::mutex> lck(benchmarkLock);
+    benchmarkCache[key] = preferred;
+    return preferred;
+}
+
+
+/**
+ * @brief Read weights and biases from raw data and store them into a texture
+ *
+ * @param biasAndWeights Pointer to array with bias and weight values (see
+ *                       DeepConvLayerBase::loadWeightsAndBiases for the format)
+ * @param offset Optional offset (in floating-point elements) into \p biasAndWeights where to
+ *               start reading from
+ *
+ * This function applies the Winograd filter transform \f$ U = G g G^T \f$ to each 3x3 kernel
+ * \f$ g \f$ and stores the result in the #weightTexture_. The layout of that texture is:
+ *   - Texture \e width corresponds to the number of input channels, padded to a multiple of
+ *     \c 4*TILES_PER_INSTANCE
+ *   - Texture \e height corresponds to the number of output tiles multiplied by 16 (one row per
+ *     transformed position)
+ *   - Four (4) consecutive pixels in a row represent a 4x4 matrix with the input channels as their
+ *     column space and the output channels as their row space
+ *
+ * As with the direct convolution, two 16-bit floating-point numbers are packed into each 32-bit
+ * integer if the system supports half-precision data.
+ */
+void DeepWinogradConvLayer::loadWeightsAndBiases(const float *biasAndWeights, size_t offset) {
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    int texwidth = paddedInputTiles_ * PIXEL_PACKING;
+    int texheight = tiler_->numOutputTiles() * 16;
+    int checkwidth = (halfSupport_) ? texwidth/2 : texwidth;
+    if ((checkwidth > GLInfo::getMaximumTextureSize()) || (texheight > GLInfo::getMaximumTextureSize())) {
+        THROW_EXCEPTION_ARGS(FynException, "Weights do not fit into GL texture");
+    }
+    float * weights = new float[texwidth * texheight * PIXEL_PACKING];
+    memset(weights, 0, texwidth * texheight * PIXEL_PACKING * sizeof(float));
+    const float * srcweights = biasAndWeights + outputChannels_ + offset;
+    for (int ol=0; ol < outputChannels_; ol++) {
+        for (int il=0; il < inputChannels_; il++) {
+            const float * kernel = srcweights + ol * (9 * inputChannels_) + il;
+            float tmp[4][3];
+            for (int i=0; i < 4; i++) {
+                for (int fx=0; fx < 3; fx++) {
+                    tmp[i][fx] = 0.0f;
+                    for (int fy=0; fy < 3; fy++) tmp[i][fx] += WINOGRAD_G[i][fy] * kernel[(fy*3 + fx) * inputChannels_];
+                }
+            }
+            for (int i=0; i < 4; i++) {
+                for (int j=0; j < 4; j++) {
+                    float u = 0.0f;
+                    for (int fx=0; fx < 3; fx++) u += tmp[i][fx] * WINOGRAD_G[j][fx];
+                    int row = (ol / PIXEL_PACKING) * 16 + i*4 + j;
+                    int col = (il / PIXEL_PACKING) * PIXEL_PACKING + (ol % PIXEL_PACKING);
+                    weights[(row * texwidth + col) * PIXEL_PACKING + (il % PIXEL_PACKING)] = u;
+                }
+            }
+        }
+    }
+    if (!weightTexture_) glGenTextures(1, &weightTexture_);
+    GLState::bindTexture(GL_TEXTURE_2D, weightTexture_);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    if (halfSupport_) {
+        unsigned int * fp16 = FloatConversion::getInstance()->toFP16UI(weights, texwidth * texheight * PIXEL_PACKING);
+#ifdef GL_RGBA32UI
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI, texwidth/2, texheight, 0, GL_RGBA_INTEGER, GL_UNSIGNED_INT, fp16);
+#else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI_EXT, texwidth/2, texheight, 0, GL_RGBA_INTEGER_EXT, GL_UNSIGNED_INT, fp16);
+#endif
+        delete [] fp16;
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, (highPrecision_) ? GL_RGBA32F : GL_RGBA16F, texwidth, texheight, 0, GL_RGBA, GL_FLOAT, weights);
+    }
+    delete [] weights;
+    loadBiasAndBatchnorm(biasAndWeights, offset, (size_t)(kernel_*kernel_*inputChannels_*outputChannels_));
+}
+
+
+/**
+ * @copydoc LayerBase::forward
+ */
+void DeepWinogradConvLayer::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    vertexArray_->bind();
+    //------------------------------------------------------
+    // Input transform...
+    //------------------------------------------------------
+    GLState::viewport(0, 0, transInputSize_[0], transInputSize_[1]);
+    transInputFBO_->bind();
+    transInputFBO_->setWriteMask();
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(0));
+    inputShader_->bind(inputState_.get());
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    inputShader_->unbind(true);
+    transInputFBO_->unbind();
+    //------------------------------------------------------
+    // ...products in the transformed domain, accumulated
+    // over the input tiles by blending...
+    //------------------------------------------------------
+    GLState::enable(GL_BLEND);
+    GLState::blendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+    GLState::blendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
+    GLState::viewport(0, 0, productSize_[0], productSize_[1]);
+    productFBO_->bind();
+    productFBO_->setWriteMask();
+    GLState::clearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    GLState::clear(GL_COLOR_BUFFER_BIT);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, transInputFBO_->getAttachment());
+    GLState::activeTexture(GL_TEXTURE0+WEIGHT_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D, weightTexture_);
+    gemmShader_->bind(gemmState_.get());
+    GLState::drawElementsInstanced(GL_TRIANGLES, tiler_->numOutputTiles() * 16 * 6, GL_UNSIGNED_SHORT,
+                                   (const GLvoid *)(6 * sizeof(GLshort)), paddedInputTiles_ / TILES_PER_INSTANCE);
+    gemmShader_->unbind(true);
+    productFBO_->unbind();
+    //------------------------------------------------------
+    // ...and output transform, which also takes care of
+    // bias, batchnorm and residual
+    //------------------------------------------------------
+    GLState::disable(GL_BLEND);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    framebuffers_.at(0)->bind();
+    framebuffers_.at(0)->setWriteMask();
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, productFBO_->getAttachment());
+    GLState::activeTexture(GL_TEXTURE0+BIAS_TEXTURE);
+    GLState::bindTexture(GL_TEXTURE_2D, biasTexture_);
+    if (flags_ & LayerFlags::RESIDUAL_INPUT) {
+        if (residualTextures_.empty()) THROW_EXCEPTION_ARGS(FynException,"Residual flag configured, but no such texture found.");
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, residualTextures_.at(0));
+    }
+    outputShader_->bind(outputState_.get());
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    outputShader_->unbind();
+    framebuffers_.at(0)->unbind();
+    vertexArray_->unbind();
+}
+
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+
+/**
+ * @brief Setup proxy polygons for the three render passes
+ *
+ * @param vao Pointer to vertex array object that the resulting VBO and IBO are tied to
+ *
+ * @pre The supplied \p vao vertex array object to be used with this VBO is already bound
+ *
+ * The first polygon covers the full viewport and is used for the input and output transforms,
+ * which compute their texel positions from the fragment coordinates. It is followed by one
+ * polygon per output tile and transformed position, which covers the corresponding plane in the
+ * product texture. The texture coordinates of those polygons refer to the plane inside a single
+ * tile of the transformed input, the offset to the actual input tile is added per instance.
+ */
+void DeepWinogradConvLayer::setupNetworkPolygons(VAO *vao) {
+    int quads = 1 + tiler_->numOutputTiles() * 16;
+    float * attrs0 = new float[quads * 4 * 4];
+    int * attrs1 = new int[quads * 4 * 2];
+    memset(attrs1, 0, quads * 4 * 2 * sizeof(int));
+    static const float corners[4][2] = {{0.f, 0.f}, {1.f, 0.f}, {1.f, 1.f}, {0.f, 1.f}};
+    for (int v=0; v < 4; v++) {
+        attrs0[v*4 + 0] = 2.0f * corners[v][0] - 1.0f;
+        attrs0[v*4 + 1] = 2.0f * corners[v][1] - 1.0f;
+        attrs0[v*4 + 2] = corners[v][0];
+        attrs0[v*4 + 3] = corners[v][1];
+    }
+    float * aptr = attrs0 + 16;
+    int * iptr = attrs1 + 8;
+    for (int tile=0; tile < tiler_->numOutputTiles(); tile++) {
+        int tx = (tile % outputColumns_) * 4 * blocks_[0];
+        int ty = (tile / outputColumns_) * 4 * blocks_[1];
+        for (int pos=0; pos < 16; pos++) {
+            int px = (pos % 4) * blocks_[0];
+            int py = (pos / 4) * blocks_[1];
+            for (int v=0; v < 4; v++) {
+                float x = (float)px + corners[v][0] * (float)blocks_[0];
+                float y = (float)py + corners[v][1] * (float)blocks_[1];
+                aptr[0] = 2.0f * ((float)tx + x) / (float)productSize_[0] - 1.0f;
+                aptr[1] = 2.0f * ((float)ty + y) / (float)productSize_[1] - 1.0f;
+                aptr[2] = x;
+                aptr[3] = y;
+                iptr[0] = tile * 16 + pos;
+                aptr += 4;
+                iptr += 2;
+            }
+        }
+    }
+    vertexBuffer_ = new VBO(context_);
+    vao->enableArray(0);
+    vertexBuffer_->setBufferData(attrs0, quads * 4 * 4 * sizeof(float), GL_STATIC_DRAW);
+    vertexBuffer_->bind();
+    vao->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    textureOffsets_ = new VBO(context_);
+    vao->enableArray(1);
+    textureOffsets_->setBufferData(attrs1, quads * 4 * 2 * sizeof(int), GL_STATIC_DRAW);
+    textureOffsets_->bind();
+    vao->setVertexAttributeBuffer(1, 2, GL_INT, 0, 0);
+    delete [] attrs0;
+    delete [] attrs1;
+    GLshort * indices = new GLshort[quads * 6];
+    for (int i=0; i < quads; i++) {
+        int offset = i*4;
+        indices[i*6+0] = (GLshort)(offset + 0);
+        indices[i*6+1] = (GLshort)(offset + 1);
+        indices[i*6+2] = (GLshort)(offset + 2);
+        indices[i*6+3] = (GLshort)(offset + 0);
+        indices[i*6+4] = (GLshort)(offset + 2);
+        indices[i*6+5] = (GLshort)(offset + 3);
+    }
+    indexBuffer_ = new IBO(context_);
+    indexBuffer_->setBufferData(indices, quads * 6 * sizeof(GLshort), GL_STATIC_DRAW);
+    indexBuffer_->bind();
+    delete [] indices;
+}
+
+
+/**
+ * @copydoc DeepConvLayerBase::compileConvolutionShaders
+ */
+void DeepWinogradConvLayer::compileConvolutionShaders(const char *preproc) {
+    char finalpreproc[1024+512] = {0};
+    char extra[512];
+    snprintf(extra, sizeof(extra),
+             "#define BLOCKS_X %d\n#define BLOCKS_Y %d\n#define TILES_PER_INSTANCE %d\n"
+             "#define IN_TILES %d\n#define IN_TILES_X %d\n#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n"
+             "#define OUT_TILES %d\n#define OUT_TILES_X %d\n#define OUT_WIDTH %d\n#define OUT_HEIGHT %d\n#define OUT_PAD %d\n"
+             "#define RES_PAD %d\n#define TRANS_COLUMNS %d\n#define PROD_COLUMNS %d\n",
+             blocks_[0], blocks_[1], TILES_PER_INSTANCE,
+             tiler_->numInputTiles(), tiler_->numInputTiles(DeepTiler::HORIZONTAL), tiler_->getInputWidth(), tiler_->getInputHeight(), inputPadding_,
+             tiler_->numOutputTiles(), tiler_->numOutputTiles(DeepTiler::HORIZONTAL), tiler_->getOutputWidth(), tiler_->getOutputHeight(), outputPadding_,
+             residualPadding_, inputColumns_, outputColumns_);
+    strncpy(finalpreproc, preproc, sizeof(finalpreproc)-1);
+    strncat(finalpreproc, extra, sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    inputShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepwinograd_input.frag", finalpreproc, typeid(this));
+    shaderPostprocessing(inputShader_);
+    inputState_ = UniformState::makeShared(inputShader_);
+    gemmShader_ = compileShaderPair("shaders/deep/deepwinograd_gemm.vert", "shaders/deep/deepwinograd_gemm.frag", finalpreproc, typeid(this));
+    shaderPostprocessing(gemmShader_);
+    gemmState_ = UniformState::makeShared(gemmShader_);
+    if (flags_ & LayerFlags::RESIDUAL_INPUT) strncat(finalpreproc, "#define USE_RESIDUAL\n", sizeof(finalpreproc) - strlen(finalpreproc) - 1);
+    outputShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/deep/deepwinograd_output.frag", finalpreproc, typeid(this));
+    shaderPostprocessing(outputShader_);
+    outputState_ = UniformState::makeShared(outputShader_);
+    if (!GLInfo::hasBinding()) {
+        inputState_->setUniformValue("inputLayer0", 0);
+        gemmState_->setUniformValue("inputLayer0", 0);
+        gemmState_->setUniformValue("inputCoeffs", WEIGHT_TEXTURE);
+        outputState_->setUniformValue("inputLayer0", 0);
+        outputState_->setUniformValue("residualLayer0", 1, true);
+        outputState_->setUniformValue("biasTexture", BIAS_TEXTURE);
+    }
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ *
+ * In addition to the output %FBO, this creates the %FBOs for the transformed input and the
+ * products in the transformed domain, which use internal textures with the precision of the
+ * layer.
+ */
+void DeepWinogradConvLayer::setupFBOs() {
+    DeepConvLayerBase::setupFBOs();
+    opengl::Texture::pixtype type = (highPrecision_) ? opengl::Texture::FLOAT32 : opengl::Texture::FLOAT16;
+    if (!transInputFBO_) transInputFBO_ = new FBO(context_, transInputSize_[0], transInputSize_[1], PIXEL_PACKING, type);
+    if (!productFBO_) productFBO_ = new FBO(context_, productSize_[0], productSize_[1], PIXEL_PACKING, type);
+}
+
+
+/**
+ * @brief Compute layout of a texture that stores a set of equally-sized tiles
+ *
+ * @param tiles Number of tiles to store
+ * @param tileWidth Width of a single tile (pixels)
+ * @param tileHeight Height of a single tile (pixels)
+ * @param[out] columns Number of tiles per row
+ * @param[out] width Width of the texture (pixels)
+ * @param[out] height Height of the texture (pixels)
+ *
+ * The tiles are arranged in an (almost) square grid, without any padding between them.
+ */
+void DeepWinogradConvLayer::gridSize(int tiles, int tileWidth, int tileHeight, int & columns, int & width, int & height) {
+    columns = std::max(1, (int)ceilf(sqrtf((float)tiles * (float)tileHeight / (float)tileWidth)));
+    columns = std::min(columns, tiles);
+    int rows = (tiles + columns - 1) / columns;
+    width = columns * tileWidth;
+    height = rows * tileHeight;
+}
+
+
+/**
+ * @brief Measure the execution time of a 3x3 convolution layer
+ *
+ * @param layer Layer to benchmark, must not have been set up yet
+ * @param builder Builder that was used to create the \p layer
+ *
+ * @return Shortest run time of the layer's forward() over #BENCHMARK_RUNS runs (in microseconds)
+ *
+ * @pre The GL context that is to be used for running the inference is current to the calling thread
+ *
+ * @post The \p layer is cleaned up
+ *
+ * This loads zero-valued weights into the \p layer and connects it to temporary textures. The
+ * execution time does not depend on the weight or input values. A first (untimed) run absorbs
+ * any lazy initialization by the GL driver, each timed run is completed by a \c glFinish().
+ */
+double DeepWinogradConvLayer::benchmark(DeepConvLayerBase & layer, const ConvLayerBuilder & builder) {
+    std::vector<float> wandb(builder.out() * (builder.kernel_ * builder.kernel_ * builder.in() + 3), 0.f);
+    layer.loadWeightsAndBiases(wandb.data(), 0);
+    std::vector<BufferSpec> inbufs = layer.getRequiredInputBuffers();
+    std::vector<BufferSpec> outbufs = layer.getRequiredOutputBuffers();
+    std::vector<GLuint> textures(inbufs.size() + outbufs.size(), 0);
+    glGenTextures((GLsizei)textures.size(), textures.data());
+    for (int i=0; i < (int)textures.size(); i++) {
+        const BufferSpec & spec = (i < (int)inbufs.size()) ? inbufs.at(i) : outbufs.at(i - inbufs.size());
+        GLState::bindTexture(GL_TEXTURE_2D, textures.at(i));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, spec.internalFormat_, spec.width_, spec.height_, 0, spec.format_, spec.type_, nullptr);
+        if (i >= (int)inbufs.size()) layer.addOutputTexture(textures.at(i), spec.channelIndex_);
+        else if (spec.usage_ == BufferSpec::RESIDUAL_SOURCE) layer.addResidualTexture(textures.at(i), spec.channelIndex_);
+        else layer.addInputTexture(textures.at(i), spec.port_);
+    }
+    double best = 0.0;
+    try {
+        layer.setup();
+        layer.forward(0);
+        glFinish();
+        for (int run=0; run < BENCHMARK_RUNS; run++) {
+            auto start = std::chrono::steady_clock::now();
+            layer.forward(run + 1);
+            glFinish();
+            double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            if ((run == 0) || (elapsed < best)) best = elapsed;
+        }
+    } catch (...) {
+        layer.cleanup();
+        GLState::deleteTextures((GLsizei)textures.size(), textures.data());
+        throw;
+    }
+    layer.cleanup();
+    GLState::deleteTextures((GLsizei)textures.size(), textures.data());
+    return best;
+}
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
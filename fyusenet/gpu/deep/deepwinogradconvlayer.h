@@ -0,0 +1,118 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Deep Winograd 3x3 Convolutional Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../../gl/gl_sys.h"
+#include "../../gl/fbo.h"
+#include "../gfxcontextlink.h"
+#include "../../base/bufferspec.h"
+#include "deepconvlayerbase.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+namespace deep {
+
+/**
+ * @brief 3x3 convolution layer for deep tensor format using the Winograd F(2x2,3x3) algorithm
+ *
+ * This class implements a deep-tensor 3x3 convolution with unit stride by means of the Winograd
+ * minimal filtering algorithm. Each output tile is partitioned into blocks of 2x2 pixels, which
+ * are computed from 4x4 input patches. In the transformed domain, the convolution of such a patch
+ * reduces to 16 elementwise products (per input/output channel pair), instead of the 36 products
+ * required for the direct convolution, which cuts the number of multiply/add operations by a
+ * factor of 2.25.
+ *
+ * The computation is split into three render passes:
+ *   1. The input transform \f$ V = B^T d B \f$ is computed for every 4x4 input patch \f$ d \f$
+ *      and stored in an intermediate texture. That texture holds one region per input tile, which
+ *      in turn consists of 16 planes (one per transformed position) with one pixel per block
+ *   2. For each of the 16 planes, a batched matrix product over the channels is computed, which
+ *      is done in the same way as the direct convolution: proxy polygons that are instanced over
+ *      the input tiles fetch the (pre-transformed) weights in the vertex shader and accumulate
+ *      the products using additive blending into a second intermediate texture
+ *   3. The output transform \f$ Y = A^T M A \f$ computes the 2x2 output pixels for each block,
+ *      adds the bias and applies the optional batchnorm and residual
+ *
+ * The filter transform \f$ U = G g G^T \f$ is performed on the CPU when loading the weights,
+ * the resulting 4x4 matrices are stored in the #weightTexture_ in the same way as for the direct
+ * convolution, with the 16 transformed positions replacing the kernel positions.
+ *
+ * @note As the transformed input is stored in floating-point textures, the numerical error is
+ *       slightly larger than for the direct convolution, in particular for half-precision layers.
+ *       Use ConvLayerBuilderTempl::winograd() to disable this implementation.
+ *
+ * @see ConvLayerBuilderTempl::winograd(), isSupported(), isPreferred()
+ */
+class DeepWinogradConvLayer : public DeepConvLayerBase {
+ public:
+    constexpr static int TILES_PER_INSTANCE = 3;
+    constexpr static int BENCHMARK_RUNS = 5;
+    constexpr static double MIN_SPEEDUP = 1.05;
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    DeepWinogradConvLayer(const ConvLayerBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void forward(uint64_t sequence) override;
+    virtual void cleanup() override;
+    virtual void loadWeightsAndBiases(const float *biasAndWeights, size_t offset) override;
+
+    static bool isSupported(const ConvLayerBuilder & builder);
+    static bool isPreferred(const ConvLayerBuilder & builder);
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    virtual void setupNetworkPolygons(VAO *vao) override;
+    virtual void compileConvolutionShaders(const char *preproc) override;
+    virtual void setupFBOs() override;
+    static void gridSize(int tiles, int tileWidth, int tileHeight, int & columns, int & width, int & height);
+    static double benchmark(DeepConvLayerBase & layer, const ConvLayerBuilder & builder);
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    programptr inputShader_;            //!< Shader program for the input transform
+    programptr gemmShader_;             //!< Shader program for the elementwise products in the transformed domain
+    programptr outputShader_;           //!< Shader program for the output transform and bias/batchnorm/residual
+    unistateptr inputState_;            //!< Uniform-variable state for #inputShader_
+    unistateptr gemmState_;             //!< Uniform-variable state for #gemmShader_
+    unistateptr outputState_;           //!< Uniform-variable state for #outputShader_
+    FBO * transInputFBO_ = nullptr;     //!< %FBO (with internal texture) that stores the transformed input
+    FBO * productFBO_ = nullptr;        //!< %FBO (with internal texture) that stores the products in the transformed domain
+    int blocks_[2] = {0, 0};            //!< Number of 2x2 output blocks per tile along x and y
+    int paddedInputTiles_ = 0;          //!< Number of input tiles, padded to a multiple of #TILES_PER_INSTANCE
+    int inputColumns_ = 0;              //!< Number of tiles per row in the transformed input texture
+    int outputColumns_ = 0;             //!< Number of tiles per row in the product texture
+    int transInputSize_[2] = {0, 0};    //!< Width and height of the transformed input texture
+    int productSize_[2] = {0, 0};       //!< Width and height of the product texture
+};
+
+} // deep namespace
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
@@ -104,22 +104,22 @@ void Deep2ShallowLayer::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_BLEND);
-    glClearColor(0.0f,0.0f,0.0f,0.0f);
-    glViewport(0,0,viewport_[0],viewport_[1]);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    GLState::clearColor(0.0f,0.0f,0.0f,0.0f);
+    GLState::viewport(0,0,viewport_[0],viewport_[1]);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(0));
     shader_->bind();
     vertexArray_->bind();
     for (int pass=0; pass < (int)MRT_.size(); pass++) {
         framebuffers_.at(pass)->bind();
         framebuffers_.at(pass)->setWriteMask();
-        glClear(GL_COLOR_BUFFER_BIT);
+        GLState::clear(GL_COLOR_BUFFER_BIT);
         shader_->setMappedUniformValue(UNIFORM_MRT,MRT_.at(pass));
-        glDrawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)(pass*6*sizeof(short)));
+        GLState::drawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)(pass*6*sizeof(short)));
         framebuffers_.at(pass)->unbind();
     }
     shader_->unbind();
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -21,6 +22,8 @@
 #include "../base/bufferspec.h"
 #include "../gl/pbo.h"
 #include "../gl/pbopool.h"
+#include "../common/logging.h"
+#include "floatconversion.h"
 
 namespace fyusion {
 namespace fyusenet {
@@ -47,6 +50,10 @@ DownloadLayer::DownloadLayer(const UpDownLayerBuilder& builder, int layerNumber)
     if (builder.callback_) userCallback_ = builder.callback_;
     async_ = builder.async_;
 #endif
+    if (builder.fp16Transfer_) {
+        transferType_ = GL_HALF_FLOAT;
+        transferBytes_ = 2;
+    }
 }
 
 
@@ -102,29 +109,70 @@ void DownloadLayer::clearOutputBuffers(int port) {
  */
 void DownloadLayer::setup() {
     setupFBOs();
+    if ((transferType_ == GL_HALF_FLOAT) && (!framebuffers_.empty())) {
+        FBO * fbo = getFBO(0);
+        fbo->bind();
+        bool readable = fbo->supportsReadout(GL_RGBA, GL_HALF_FLOAT);
+        fbo->unbind();
+        if (!readable) {
+            FNLOGW("Half-precision readout not supported on this system, using single-precision for layer %s", getName().c_str());
+            transferType_ = GL_FLOAT;
+            transferBytes_ = 4;
+        }
+    }
+    PBOPool * pool = context_.interface()->getReadPBOPool();
+    if ((pool) && (pool->preallocation())) {
+        int paddedchannels = LayerBase::PIXEL_PACKING * ((outputChannels_ + LayerBase::PIXEL_PACKING - 1) / LayerBase::PIXEL_PACKING);
+        pool->reserve(width_ + 2*inputPadding_, height_ + 2*inputPadding_, paddedchannels, transferBytes_, (async_) ? 2 : 1, PBO::READ);
+    }
     valid_ = true;
 }
 
 
+/**
+ * @copydoc GPULayerBase::cleanup
+ */
+void DownloadLayer::cleanup() {
+    clearTargetRing();
+    GPULayerBase::cleanup();
+}
+
+
 /**
  * @copydoc LayerBase::forward
  */
 void DownloadLayer::forward(uint64_t sequence) {
-    assert(outputs_.size() == 1);
+    assert((outputs_.size() == 1) || (ring_));
     // TODO (mw) implement optional rendering step here (for ReLU)
     if (flags_ & LayerFlags::PRE_ACT_MASK) THROW_EXCEPTION_ARGS(FynException,"Activation on download not implemented yet");
     if (flags_ & LayerFlags::RESIDUAL_INPUT) THROW_EXCEPTION_ARGS(FynException,"Residual add on download not implemented yet");
-    ManagedPBO pbo = pboBlit();
 #ifndef FYUSENET_MULTITHREADING
     if (true) {
 #else
     if (!async_) {
 #endif
+        if (ring_) {
+            //-------------------------------------------------------------
+            // Direct download into the caller-supplied target ring, for
+            // persistent PBOs we have to wait for the GPU explicitly...
+            //-------------------------------------------------------------
+            ManagedPBO pbo;
+            int slot = ringBlit(sequence, pbo);
+            if (ring_->mapped(slot)) {
+                GLsync sync = context().issueSync();
+                if (!context().waitClientSync(sync, 5000000000)) THROW_EXCEPTION_ARGS(FynException, "Cannot read out texture within 5s for sequence %ld", sequence);
+                context().removeSync(sync);
+            }
+            ringReadout(slot, pbo);
+            ring_->notify(sequence, slot, AsyncLayer::DOWNLOAD_DONE);
+            return;
+        }
         //-------------------------------------------------------------
         // Synchronous part, we still use a PBO here though there is no
         // advantage doing that. It just makes the code easier.
         //-------------------------------------------------------------
-        outputs_[0]->readFromPBO(*pbo, CPUBufferShape::type::FLOAT32, sequence);        
+        ManagedPBO pbo = pboBlit();
+        outputs_[0]->readFromPBO(*pbo, (transferType_ == GL_HALF_FLOAT) ? CPUBufferShape::type::FLOAT16 : CPUBufferShape::type::FLOAT32, sequence);
     } else {
 #ifdef FYUSENET_MULTITHREADING
         THROW_EXCEPTION_ARGS(FynException, "Layer is not synchronous");
@@ -141,17 +189,22 @@ void DownloadLayer::asyncForward(uint64_t sequenceNo, const std::function<void (
     if (flags_ & LayerFlags::PRE_ACT_MASK) THROW_EXCEPTION_ARGS(FynException,"Activation on download not implemented yet");
     if (flags_ & LayerFlags::RESIDUAL_INPUT) THROW_EXCEPTION_ARGS(FynException,"Residual add on download not implemented yet");
     if (!async_) THROW_EXCEPTION_ARGS(FynException, "Layer is not asynchronous");
-    ManagedPBO pbo = pboBlit();
+    ManagedPBO pbo;
+    int slot = -1;
+    if (ring_) slot = ringBlit(sequenceNo, pbo);
+    else pbo = pboBlit();
     //-------------------------------------------------------------
     // We issue a fence here and start a thread that waits for the
     // fence before reading out the PBO...
     //-------------------------------------------------------------
     GLsync sync = context().issueSync();
     asyncLock_.lock();
+    CPUBuffer * target = (ring_) ? nullptr : outputs_[0];
     auto thread = AsyncPool::getDerivedContextThread(context());
     threads_[sequenceNo] = thread;
-    thread->setTask(std::bind(&DownloadLayer::readoutPBO, this, thread, pbo, sync, sequenceNo, outputs_[0], callback));
-    if (userCallback_) userCallback_(sequenceNo, outputs_[0], AsyncLayer::DOWNLOAD_COMMENCED);
+    thread->setTask(std::bind(&DownloadLayer::readoutPBO, this, thread, pbo, sync, sequenceNo, target, slot, callback));
+    if (ring_) ring_->notify(sequenceNo, slot, AsyncLayer::DOWNLOAD_COMMENCED);
+    else if (userCallback_) userCallback_(sequenceNo, target, AsyncLayer::DOWNLOAD_COMMENCED);
     asyncLock_.unlock();
 }
 #endif
@@ -241,6 +294,85 @@ CPUBuffer * DownloadLayer::getOutputBuffer(int port) const {
 }
 
 
+/**
+ * @brief Download into a ring of caller-owned memory regions instead of the output CPUBuffer
+ *
+ * @param buffers List of memory regions that make up the ring, each region must be at least
+ *                \p bytes in size and stay valid until clearTargetRing() is called
+ * @param bytes Size of each memory region, must be at least targetBytes() for the given \p order
+ * @param order Data order to write, either \c CHANNELWISE to store the tensor as plain
+ *              (unpadded) 3D array of single-precision floats, or \c GPU_SHALLOW to store the
+ *              raw %PBO content
+ * @param notify Optional callback which is invoked with the ring slot address on
+ *               \c DOWNLOAD_COMMENCED (asynchronous layers only) and \c DOWNLOAD_DONE
+ *
+ * @throws FynException on invalid parameters
+ *
+ * @pre Calling thread has the GL context of this layer current (if a ring was set before)
+ *
+ * Once set, each download writes into the next slot of the ring (round-robin) directly from the
+ * mapped %PBO, bypassing the output CPUBuffer. Where supported, each slot is backed by a
+ * persistently-mapped %PBO. Before a slot is re-used, the layer waits for any pending readout
+ * into that slot.
+ *
+ * @see TargetRing
+ */
+void DownloadLayer::setTargetRing(const std::vector<void *>& buffers, size_t bytes, BufferSpec::order order,
+                                  const TargetRing::callback& notify) {
+    if ((order != BufferSpec::order::CHANNELWISE) && (order != BufferSpec::order::GPU_SHALLOW)) {
+        THROW_EXCEPTION_ARGS(FynException, "Unsupported data order for target ring");
+    }
+    if (bytes < targetBytes(order)) THROW_EXCEPTION_ARGS(FynException, "Target ring buffers too small (%ld < %ld)", (long)bytes, (long)targetBytes(order));
+    TargetRing * ring = new TargetRing(context_, buffers, bytes, order, notify);
+    clearTargetRing();
+#ifdef FYUSENET_MULTITHREADING
+    std::lock_guard<std::recursive_mutex> lck(asyncLock_);
+#endif
+    ring_ = ring;
+}
+
+
+/**
+ * @brief Remove ring of caller-owned download targets
+ *
+ * @pre Calling thread has the GL context of this layer current (or one that is shared with it)
+ *
+ * Waits for all pending downloads on this layer and releases the ring. Subsequent downloads will
+ * use the output CPUBuffer again.
+ */
+void DownloadLayer::clearTargetRing() {
+#ifdef FYUSENET_MULTITHREADING
+    std::vector<AsyncPool::GLThread> pending;
+    asyncLock_.lock();
+    for (auto it = threads_.begin(); it != threads_.end(); ++it) pending.push_back(it->second);
+    asyncLock_.unlock();
+    for (auto & thread : pending) thread->wait();
+    std::lock_guard<std::recursive_mutex> lck(asyncLock_);
+#endif
+    if (ring_) {
+        ring_->release();
+        delete ring_;
+        ring_ = nullptr;
+    }
+}
+
+
+/**
+ * @brief Get minimum size of caller-owned download targets
+ *
+ * @param order Data order to be written into the target
+ *
+ * @return Number of bytes required for each memory region in a target ring
+ *
+ * @see setTargetRing()
+ */
+size_t DownloadLayer::targetBytes(BufferSpec::order order) const {
+    if (order == BufferSpec::order::CHANNELWISE) return (size_t)width_ * height_ * outputChannels_ * bytesPerChan_;
+    int paddedchannels = LayerBase::PIXEL_PACKING * ((outputChannels_ + LayerBase::PIXEL_PACKING - 1) / LayerBase::PIXEL_PACKING);
+    return (size_t)(width_ + 2*inputPadding_) * (height_ + 2*inputPadding_) * paddedchannels * bytesPerChan_;
+}
+
+
 
 /*##################################################################################################
 #                               N O N -  P U B L I C  F U N C T I O N S                            #
@@ -255,29 +387,153 @@ CPUBuffer * DownloadLayer::getOutputBuffer(int port) const {
  * content.
  */
 ManagedPBO DownloadLayer::pboBlit() {
-    // a lot of PBO binds/unbinds here, maybe consolidate when there is time
     PBOPool *pool = context_.interface()->getReadPBOPool();
     assert(pool);
     int paddedwidth = width_ + 2*inputPadding_;
     int paddedheight = height_ + 2*inputPadding_;
     int paddedchannels = LayerBase::PIXEL_PACKING * ((outputChannels_ + LayerBase::PIXEL_PACKING - 1) / LayerBase::PIXEL_PACKING);
-    ManagedPBO pbo = pool->getAvailablePBO(paddedwidth, paddedheight, paddedchannels, bytesPerChan_);
-    pbo->prepareForRead(paddedwidth * paddedheight * paddedchannels * bytesPerChan_);
+    ManagedPBO pbo = pool->getAvailablePBO(paddedwidth, paddedheight, paddedchannels, transferBytes_);
+    pbo->prepareForRead(paddedwidth * paddedheight * paddedchannels * transferBytes_);
+    copyToPBO(*pbo);
+    if (async_) pbo.setPending();
+    return pbo;
+}
+
+
+/**
+ * @brief Read texture content of all FBOs into the supplied %PBO
+ *
+ * @param pbo Pointer to %PBO that has been prepared for reading with sufficient capacity
+ *
+ * The textures are stored back-to-back in the %PBO, each texture in RGBA order.
+ */
+void DownloadLayer::copyToPBO(opengl::PBO *pbo) {
+    // a lot of PBO binds/unbinds here, maybe consolidate when there is time
+    int paddedwidth = width_ + 2*inputPadding_;
+    int paddedheight = height_ + 2*inputPadding_;
     int readchans = 0;
     pbo->bind(GL_PIXEL_PACK_BUFFER);
     for (int fb = 0 ; fb < numFBOs(); fb++ ) {
         // NOTE (mw) we assume that the FBOs are putting out all 4 channels
-        size_t offset = readchans * paddedwidth * paddedheight * bytesPerChan_;
+        size_t offset = readchans * paddedwidth * paddedheight * transferBytes_;
         FBO *fbo = getFBO(fb);
         fbo->bind();
         int chans = LayerBase::PIXEL_PACKING * fbo->numAttachments();
-        fbo->copyToPBO(*pbo, GL_FLOAT, LayerBase::PIXEL_PACKING, offset);
+        fbo->copyToPBO(pbo, transferType_, LayerBase::PIXEL_PACKING, offset);
         fbo->unbind();
         readchans += chans;
     }
     pbo->unbind(GL_PIXEL_PACK_BUFFER);
-    if (async_) pbo.setPending();
-    return pbo;
+}
+
+
+/**
+ * @brief Read texture content into the PBO of the next slot in the target ring
+ *
+ * @param sequence Sequence number of the download
+ * @param[out] pbo Receives a pooled %PBO in case the ring slot is not backed by a persistent %PBO
+ *
+ * @return Ring slot index that the download is assigned to
+ *
+ * In case the slot is still in use by a pending (asynchronous) readout, this function waits for
+ * that readout to finish.
+ */
+int DownloadLayer::ringBlit(uint64_t sequence, opengl::ManagedPBO& pbo) {
+    assert(ring_);
+    uint64_t previous = 0;
+    int slot = ring_->next(sequence, &previous);
+    if (previous != ~(uint64_t)0) wait(previous);
+    int paddedchannels = LayerBase::PIXEL_PACKING * ((outputChannels_ + LayerBase::PIXEL_PACKING - 1) / LayerBase::PIXEL_PACKING);
+    PBO * persistent = ring_->persistentPBO(slot, width_ + 2*inputPadding_, height_ + 2*inputPadding_, paddedchannels, transferBytes_);
+    if (persistent) {
+        copyToPBO(persistent);
+        persistent->flushForRead();
+    } else {
+        pbo = pboBlit();
+    }
+    return slot;
+}
+
+
+/**
+ * @brief Copy %PBO content into a target ring slot
+ *
+ * @param slot Ring slot index to copy the data into
+ * @param pbo Pooled %PBO that contains the data, only used if the slot is not backed by a
+ *            persistently mapped %PBO
+ *
+ * @pre The GPU has finished writing into the %PBO
+ *
+ * For \c CHANNELWISE order, the data is de-interleaved and the padding is stripped in the same
+ * pass, otherwise the raw %PBO content is copied. Half-precision %PBO data is expanded to
+ * single-precision on the way.
+ */
+void DownloadLayer::ringReadout(int slot, opengl::ManagedPBO& pbo) {
+    const void * mem = ring_->mapped(slot);
+    size_t size = targetBytes(BufferSpec::order::GPU_SHALLOW);
+    if (!mem) {
+        pbo->bind(GL_PIXEL_PACK_BUFFER);
+        mem = pbo->mapReadBuffer();
+        if (!mem) {
+            pbo->unbind(GL_PIXEL_PACK_BUFFER);
+            THROW_EXCEPTION_ARGS(FynException,"Cannot read data from PBO");
+        }
+    }
+    const float * src = static_cast<const float *>(mem);
+    if (transferType_ == GL_HALF_FLOAT) {
+        ringReadoutHalf(static_cast<const uint16_t *>(mem), slot);
+    } else if (ring_->order() == BufferSpec::order::CHANNELWISE) {
+        float * tgt = static_cast<float *>(ring_->buffer(slot));
+        int paddedwidth = width_ + 2*inputPadding_;
+        int paddedheight = height_ + 2*inputPadding_;
+        for (int c=0; c < outputChannels_; c++) {
+            const float * in = src + (c / PIXEL_PACKING) * paddedwidth * paddedheight * PIXEL_PACKING + (c % PIXEL_PACKING);
+            for (int y=0; y < height_; y++) {
+                const float * inrow = in + ((y + inputPadding_) * paddedwidth + inputPadding_) * PIXEL_PACKING;
+                for (int x=0; x < width_; x++) *tgt++ = inrow[x * PIXEL_PACKING];
+            }
+        }
+    } else {
+        memcpy(ring_->buffer(slot), src, size);
+    }
+    if (!ring_->mapped(slot)) {
+        pbo->unmapReadBuffer();
+        pbo->unbind(GL_PIXEL_PACK_BUFFER);
+    }
+}
+
+
+/**
+ * @brief Copy half-precision %PBO content into a target ring slot
+ *
+ * @param src Pointer to mapped %PBO memory that contains half-precision data
+ * @param slot Ring slot index to copy the data into
+ *
+ * Expands the data to single-precision, de-interleaving it row by row for \c CHANNELWISE order.
+ */
+void DownloadLayer::ringReadoutHalf(const uint16_t *src, int slot) {
+    const FloatConversion * conv = FloatConversion::getInstance();
+    float * tgt = static_cast<float *>(ring_->buffer(slot));
+    int paddedwidth = width_ + 2*inputPadding_;
+    int paddedheight = height_ + 2*inputPadding_;
+    if (ring_->order() != BufferSpec::order::CHANNELWISE) {
+        conv->toFloat(src, tgt, targetBytes(BufferSpec::order::GPU_SHALLOW) / sizeof(float));
+        return;
+    }
+    std::vector<float> row(width_ * PIXEL_PACKING);
+    int slabs = (outputChannels_ + PIXEL_PACKING - 1) / PIXEL_PACKING;
+    size_t planesize = (size_t)width_ * height_;
+    for (int s=0; s < slabs; s++) {
+        int chans = std::min((int)PIXEL_PACKING, outputChannels_ - s * PIXEL_PACKING);
+        const uint16_t * in = src + (size_t)s * paddedwidth * paddedheight * PIXEL_PACKING;
+        for (int y=0; y < height_; y++) {
+            conv->toFloat(in + ((y + inputPadding_) * paddedwidth + inputPadding_) * PIXEL_PACKING, row.data(), row.size());
+            for (int c=0; c < chans; c++) {
+                float * out = tgt + (s * PIXEL_PACKING + c) * planesize + (size_t)y * width_;
+                for (int x=0; x < width_; x++) out[x] = row[x * PIXEL_PACKING + c];
+            }
+        }
+    }
 }
 
 #ifdef FYUSENET_MULTITHREADING
@@ -288,7 +544,9 @@ ManagedPBO DownloadLayer::pboBlit() {
  * @param pbo Reference to a ManagedPBO instance which wraps the PBO to be read out
  * @param sync Handle of the OpenGL fence sync that indicates when the PBO is ready for readout
  * @param sequence Sequence number that refers to the content in the PBO to be read out
- * @param target Pointer to CPUBuffer where the data should be placed in
+ * @param target Pointer to CPUBuffer where the data should be placed in (\c nullptr when using
+ *               a target ring)
+ * @param slot Index of target ring slot to place the data in, or -1 when using \p target
  * @param callback Callback function in the engine to pass notification about finished download
  *
  * @throw FynException in case the \p sync was not posted on the GL pipeline after less than 5s
@@ -296,7 +554,7 @@ ManagedPBO DownloadLayer::pboBlit() {
  * This function waits for the supplied \p sync to be issued on the GL pipeline in a background
  * thread (to be more precise, it is invoked in the background thread already). Once the sync has
  * been received, the \p pbo will be mapped into memory and the data will be copied to the buffer(s)
- * in #outputs_. After reading the data, two callbacks will be invoked:
+ * in #outputs_ or into the target ring. After reading the data, two callbacks will be invoked:
  *   - \p callback which notifies the engine that the PBO has been read
  *   - #userCallback_ which notifies the API user that the PBO has been read
  *
@@ -304,16 +562,23 @@ ManagedPBO DownloadLayer::pboBlit() {
  *
  * @see UpDownLayerBuilder, Engine::asyncDownloadDone
  */
-void DownloadLayer::readoutPBO(AsyncPool::GLThread& myThread, opengl::ManagedPBO& pbo, GLsync sync, uint64_t sequence, cpu::CPUBuffer * target, const std::function<void(uint64_t)> & callback) {
+void DownloadLayer::readoutPBO(AsyncPool::GLThread& myThread, opengl::ManagedPBO& pbo, GLsync sync, uint64_t sequence, cpu::CPUBuffer * target, int slot, const std::function<void(uint64_t)> & callback) {
     using namespace opengl;
     const GfxContextLink & ctx = myThread.context();
     bool rc = ctx.waitClientSync(sync, 5000000000);        // wait 5s max  (TODO (mw) configurable timeout)
     if (!rc) THROW_EXCEPTION_ARGS(FynException, "Cannot read out texture within 5s for sequence %ld", sequence);
     ctx.removeSync(sync);
-    target->readFromPBO(*pbo, CPUBufferShape::type::FLOAT32, sequence);
-    pbo.clearPending();
-    if (callback) callback(sequence);
-    if (userCallback_) userCallback_(sequence, target, AsyncLayer::DOWNLOAD_DONE);
+    if (slot >= 0) {
+        ringReadout(slot, pbo);
+        if (*pbo) pbo.clearPending();
+        if (callback) callback(sequence);
+        ring_->notify(sequence, slot, AsyncLayer::DOWNLOAD_DONE);
+    } else {
+        target->readFromPBO(*pbo, (transferType_ == GL_HALF_FLOAT) ? CPUBufferShape::type::FLOAT16 : CPUBufferShape::type::FLOAT32, sequence);
+        pbo.clearPending();
+        if (callback) callback(sequence);
+        if (userCallback_) userCallback_(sequence, target, AsyncLayer::DOWNLOAD_DONE);
+    }
     asyncLock_.lock();
     auto it = threads_.find(sequence);
     assert(it != threads_.end());
@@ -31,6 +31,7 @@
 #endif
 #include "../common/fynexception.h"
 #include "../cpu/cpubuffer.h"
+#include "targetring.h"
 
 //------------------------------------- Public Declarations ----------------------------------------
 
@@ -87,7 +88,16 @@ namespace gpu {
  * to be performed on the buffer, those should be relayed to a different thread if performance
  * is of the essence.
  *
- * @see Engine::asyncDownloadDone, UpDownLayerBuilder
+ * As an alternative to the CPUBuffer output, a ring of caller-owned memory regions can be
+ * registered using setTargetRing(). In that case the data is copied from the (mapped) %PBO
+ * directly into the next region of the ring, optionally reformatted into a plain channel-wise
+ * layout, and the CPUBuffer assigned to this layer is not touched at all.
+ *
+ * When UpDownLayerBuilder::fp16Transfer() is set, the texture data is read back as half-precision
+ * floating-point data, halving the bus traffic, and expanded to single-precision on the CPU while
+ * copying the data out of the %PBO. The CPU-side data remains single-precision in any case.
+ *
+ * @see Engine::asyncDownloadDone, UpDownLayerBuilder, TargetRing
  */
 class DownloadLayer : public GPULayerBase, public cpu::CPULayerInterface, public DownloadLayerInterface, public AsyncLayer {
     friend class fyusion::fyusenet::Engine;
@@ -102,6 +112,7 @@ class DownloadLayer : public GPULayerBase, public cpu::CPULayerInterface, public
     // Public methods
     // ------------------------------------------------------------------------
     virtual void setup() override;
+    virtual void cleanup() override;
     virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
     virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
     virtual void forward(uint64_t sequence) override;
@@ -115,6 +126,21 @@ class DownloadLayer : public GPULayerBase, public cpu::CPULayerInterface, public
     virtual void clearOutputBuffers(int port = -1) override;
     virtual void wait(uint64_t sequenceNo) override;
     void updateOutputBuffer(CPUBuffer *buf, int port=0);
+    void setTargetRing(const std::vector<void *>& buffers, size_t bytes,
+                       BufferSpec::order order = BufferSpec::order::CHANNELWISE,
+                       const TargetRing::callback& notify = TargetRing::callback());
+    void clearTargetRing();
+    size_t targetBytes(BufferSpec::order order = BufferSpec::order::CHANNELWISE) const;
+
+    /**
+     * @brief Check if a ring of caller-owned download targets has been set
+     *
+     * @retval true if downloads are written into a TargetRing
+     * @retval false if downloads are written into the output CPUBuffer
+     */
+    bool hasTargetRing() const {
+        return (ring_ != nullptr);
+    }
 
     /**
      * @brief Check if download layer is asynchronous
@@ -126,6 +152,15 @@ class DownloadLayer : public GPULayerBase, public cpu::CPULayerInterface, public
         return async_;
     }
 
+    /**
+     * @brief Check if the GL commands issued by forward() may be recorded and replayed
+     *
+     * @retval false always, as this layer transfers data between CPU and GPU
+     */
+    virtual bool isRecordable() const override {
+        return false;
+    }
+
     /**
      * @brief Clear/reset input buffers for this layer (unsupported)
      *
@@ -173,16 +208,23 @@ class DownloadLayer : public GPULayerBase, public cpu::CPULayerInterface, public
     // ------------------------------------------------------------------------
     virtual void setupFBOs() override;
     ManagedPBO pboBlit();
+    void copyToPBO(opengl::PBO *pbo);
+    int ringBlit(uint64_t sequence, opengl::ManagedPBO& pbo);
+    void ringReadout(int slot, opengl::ManagedPBO& pbo);
+    void ringReadoutHalf(const uint16_t *src, int slot);
 #ifdef FYUSENET_MULTITHREADING
-    void readoutPBO(opengl::AsyncPool::GLThread& myThread, opengl::ManagedPBO& pbo, GLsync sync, uint64_t sequence, cpu::CPUBuffer * target, const std::function<void(uint64_t)> & callback);
+    void readoutPBO(opengl::AsyncPool::GLThread& myThread, opengl::ManagedPBO& pbo, GLsync sync, uint64_t sequence, cpu::CPUBuffer * target, int slot, const std::function<void(uint64_t)> & callback);
 #endif
     // ------------------------------------------------------------------------
     // Member variables
     // ------------------------------------------------------------------------
-    uint8_t bytesPerChan_ = 4;                          //!< Number of bytes per channel (defaults to 4 bytes for a single-precision floating point number)
+    uint8_t bytesPerChan_ = 4;                          //!< Number of bytes per channel in the output (defaults to 4 bytes for a single-precision floating point number)
+    uint8_t transferBytes_ = 4;                         //!< Number of bytes per channel in the %PBO (2 for half-precision transfers)
+    GLenum transferType_ = GL_FLOAT;                    //!< Data type that is read from the FBOs into the %PBO
     bool async_ = false;                                //!< Indicator if this is an asynchronous download layer
     int maxRenderTargets_ = 1;                          //! Maximum number of render targets for a single run
     std::vector<CPUBuffer *> outputs_;                  //!< Output CPU buffer(s)
+    TargetRing * ring_ = nullptr;                       //!< Optional ring of caller-owned target memory which replaces #outputs_
     /**
      * Optional user callback function for asynchronous operation
      */
@@ -10,6 +10,13 @@
 //--------------------------------------- System Headers -------------------------------------------
 
 #include <netinet/in.h>
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define FP16_F16C
+#elif defined(__aarch64__) || (defined(__ARM_NEON) && defined(__ARM_FP) && (__ARM_FP & 2))
+#include <arm_neon.h>
+#define FP16_NEON
+#endif
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -27,6 +34,89 @@ unsigned char FloatConversion::seed_[12] = {0xB2, 0x9E, 0x8D, 0x8B, 0x96, 0x91,
 
 //-------------------------------------- Local Definitions -----------------------------------------
 
+#ifdef FP16_F16C
+/**
+ * @brief Convert single-precision to half-precision using F16C instructions
+ *
+ * @param input Pointer to single-precision input data
+ * @param output Pointer to half-precision output data
+ * @param entries Number of elements to convert
+ *
+ * @return Number of elements that were converted (multiple of 8), the remainder has to be
+ *         converted by the caller
+ */
+__attribute__((target("avx,f16c")))
+static size_t toFP16F16C(const float *input, uint16_t *output, size_t entries) {
+    size_t i = 0;
+    for (; i + 8 <= entries; i += 8) {
+        __m256 v = _mm256_loadu_ps(input + i);
+        __m128i h = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128((__m128i *)(output + i), h);
+    }
+    return i;
+}
+
+/**
+ * @brief Convert half-precision to single-precision using F16C instructions
+ *
+ * @param input Pointer to half-precision input data
+ * @param output Pointer to single-precision output data
+ * @param entries Number of elements to convert
+ *
+ * @return Number of elements that were converted (multiple of 8), the remainder has to be
+ *         converted by the caller
+ */
+__attribute__((target("avx,f16c")))
+static size_t toFloatF16C(const uint16_t *input, float *output, size_t entries) {
+    size_t i = 0;
+    for (; i + 8 <= entries; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i *)(input + i));
+        _mm256_storeu_ps(output + i, _mm256_cvtph_ps(h));
+    }
+    return i;
+}
+#endif
+
+#ifdef FP16_NEON
+/**
+ * @brief Convert single-precision to half-precision using NEON instructions
+ *
+ * @param input Pointer to single-precision input data
+ * @param output Pointer to half-precision output data
+ * @param entries Number of elements to convert
+ *
+ * @return Number of elements that were converted (multiple of 4), the remainder has to be
+ *         converted by the caller
+ */
+static size_t toFP16NEON(const float *input, uint16_t *output, size_t entries) {
+    size_t i = 0;
+    for (; i + 4 <= entries; i += 4) {
+        float16x4_t h = vcvt_f16_f32(vld1q_f32(input + i));
+        vst1_u16(output + i, vreinterpret_u16_f16(h));
+    }
+    return i;
+}
+
+/**
+ * @brief Convert half-precision to single-precision using NEON instructions
+ *
+ * @param input Pointer to half-precision input data
+ * @param output Pointer to single-precision output data
+ * @param entries Number of elements to convert
+ *
+ * @return Number of elements that were converted (multiple of 4), the remainder has to be
+ *         converted by the caller
+ */
+static size_t toFloatNEON(const uint16_t *input, float *output, size_t entries) {
+    size_t i = 0;
+    for (; i + 4 <= entries; i += 4) {
+        float16x4_t h = vreinterpret_f16_u16(vld1_u16(input + i));
+        vst1q_f32(output + i, vcvt_f32_f16(h));
+    }
+    return i;
+}
+#endif
+
 
 /*##################################################################################################
 #                                   P U B L I C  F U N C T I O N S                                 #
@@ -43,6 +133,7 @@ unsigned char FloatConversion::seed_[12] = {0xB2, 0x9E, 0x8D, 0x8B, 0x96, 0x91,
 unsigned int * FloatConversion::toFP16UI(float *input,int entries) const {
     if (entries & 1) THROW_EXCEPTION_ARGS(FynException,"Requies even number of entries");
     unsigned int *result = new unsigned int[entries/2];
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
     int out=0;
     for (int i=0; i < entries; i+=2) {
         unsigned int f1,f2;
@@ -52,6 +143,10 @@ unsigned int * FloatConversion::toFP16UI(float *input,int entries) const {
         unsigned short fp16_2 = baseTable_[(f2>>23) & 0x1ff]+((f2 & 0x007fffff) >> shiftTable_[(f2>>23) & 0x1ff]);
         result[out++] = ((unsigned int)fp16_2<<16) | (unsigned int)fp16_1;
     }
+#else
+    // on little-endian systems, the packed layout equals a plain array of 16-bit values
+    toFP16(input, (uint16_t *)result, entries);
+#endif
     return result;
 }
 
@@ -66,17 +161,57 @@ unsigned int * FloatConversion::toFP16UI(float *input,int entries) const {
  */
 unsigned short * FloatConversion::toFP16US(float *input, int entries) const {
     unsigned short *result = new unsigned short[entries];
-    int out=0;
-    for (int i=0; i < entries; i++) {
-        unsigned int f;
-        *((float *)&f) = input[i];
-        unsigned short fp16 = baseTable_[(f>>23) & 0x1ff] + ((f & 0x007fffff) >> shiftTable_[(f>>23) & 0x1ff]);
-        result[out++] = fp16;
-    }
+    toFP16(input, result, entries);
     return result;
 }
 
 
+/**
+ * @brief Convert array of single-precision values to half-precision
+ *
+ * @param input Pointer to single-precision input data
+ * @param[out] output Pointer to memory that receives the half-precision data, must be able to
+ *                    hold \p entries elements
+ * @param entries Number of elements to convert
+ *
+ * Uses vectorized conversion when available (see hasSIMD()) and the table-based conversion
+ * for the remainder.
+ */
+void FloatConversion::toFP16(const float *input, uint16_t *output, size_t entries) const {
+    size_t i = 0;
+#ifdef FP16_F16C
+    if (simd_) i = toFP16F16C(input, output, entries);
+#endif
+#ifdef FP16_NEON
+    i = toFP16NEON(input, output, entries);
+#endif
+    for (; i < entries; i++) output[i] = toFP16(input[i]);
+}
+
+
+/**
+ * @brief Convert array of half-precision values to single-precision
+ *
+ * @param input Pointer to half-precision input data
+ * @param[out] output Pointer to memory that receives the single-precision data, must be able to
+ *                    hold \p entries elements
+ * @param entries Number of elements to convert
+ *
+ * Uses vectorized conversion when available (see hasSIMD()) and the scalar conversion for the
+ * remainder.
+ */
+void FloatConversion::toFloat(const uint16_t *input, float *output, size_t entries) const {
+    size_t i = 0;
+#ifdef FP16_F16C
+    if (simd_) i = toFloatF16C(input, output, entries);
+#endif
+#ifdef FP16_NEON
+    i = toFloatNEON(input, output, entries);
+#endif
+    for (; i < entries; i++) output[i] = toFloat(input[i]);
+}
+
+
 /*##################################################################################################
 #                               N O N -  P U B L I C  F U N C T I O N S                            #
 ##################################################################################################*/
@@ -117,6 +252,11 @@ FloatConversion::FloatConversion() {
             shiftTable_[i|0x100] = 13;
         }
     }
+#if defined(FP16_F16C)
+    simd_ = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#elif defined(FP16_NEON)
+    simd_ = true;
+#endif
 }
 
 
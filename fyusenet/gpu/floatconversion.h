@@ -13,6 +13,8 @@
 //--------------------------------------- System Headers -------------------------------------------
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -31,12 +33,30 @@ namespace gpu {
  *
  * Based on paper "Fast Half Float Conversion" by Jeroen van der Zijp
  * ftp://ftp.fox-toolkit.org/pub/fasthalffloatconversion.pdf
+ *
+ * The bulk conversion functions use vectorized conversion instructions where available, which
+ * are F16C on x86 CPUs (detected at runtime) and NEON on ARM CPUs with half-precision support.
+ * Other systems use the table-based scalar conversion. Note that the vectorized paths round to
+ * the nearest representable value, whereas the table-based path truncates the mantissa, so
+ * results may differ in the last bit.
  */
 class FloatConversion {
  public:
 
     unsigned int * toFP16UI(float *input,int entries) const;
     unsigned short * toFP16US(float *input,int entries) const;
+    void toFP16(const float *input, uint16_t *output, size_t entries) const;
+    void toFloat(const uint16_t *input, float *output, size_t entries) const;
+
+    /**
+     * @brief Check if vectorized conversion is used on this system
+     *
+     * @retval true if bulk conversions use SIMD instructions
+     * @retval false if bulk conversions use the scalar (table-based) code
+     */
+    bool hasSIMD() const {
+        return simd_;
+    }
 
     inline unsigned short toFP16(float fp) const {
         unsigned int f;
@@ -54,6 +74,37 @@ class FloatConversion {
         return (fp16_1<<16) | fp16_2;
     }
 
+    /**
+     * @brief Convert single half-precision value to single-precision
+     *
+     * @param fp16 Half-precision value (as raw bits)
+     *
+     * @return Single-precision floating-point value
+     */
+    static inline float toFloat(uint16_t fp16) {
+        uint32_t sign = ((uint32_t)fp16 & 0x8000) << 16;
+        uint32_t exp = ((uint32_t)fp16 >> 10) & 0x1F;
+        uint32_t mant = (uint32_t)fp16 & 0x3FF;
+        uint32_t bits = sign;
+        if (exp == 0x1F) bits |= 0x7F800000 | (mant << 13);    // inf / NaN
+        else if (exp != 0) bits |= ((exp + 112) << 23) | (mant << 13);
+        else if (mant != 0) {
+            // denormal, re-normalize
+            exp = 113;
+            while ((mant & 0x400) == 0) {
+                mant <<= 1;
+                exp--;
+            }
+            bits |= (exp << 23) | ((mant & 0x3FF) << 13);
+        }
+        union {
+            uint32_t u;
+            float f;
+        } cvt;
+        cvt.u = bits;
+        return cvt.f;
+    }
+
     static inline FloatConversion * getInstance() {
         static FloatConversion singleton;
         return &singleton;
@@ -64,6 +115,7 @@ class FloatConversion {
     static unsigned short baseTable_[512];
     static unsigned short shiftTable_[512];
     static unsigned char seed_[12];
+    bool simd_ = false;             //!< Indicator if vectorized conversion instructions are available
 };
 
 } // gpu namespace
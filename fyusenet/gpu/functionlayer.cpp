@@ -158,12 +158,12 @@ void FunctionLayer::forward(uint64_t sequence) {
         framebuffers_.at(opass)->bind();
         framebuffers_.at(opass)->setWriteMask();
         if (totaltex >= maxRenderTargets_) {
-            glClear(GL_COLOR_BUFFER_BIT); // this is to instruct the tile-engine that we don't need the old tile-content
+            GLState::clear(GL_COLOR_BUFFER_BIT); // this is to instruct the tile-engine that we don't need the old tile-content
             renderChannelBatch(opass, maxRenderTargets_, texoffset);
             texoffset += maxRenderTargets_;
             totaltex -= maxRenderTargets_;
         } else if (totaltex > 0) {
-            glClear(GL_COLOR_BUFFER_BIT); // this is to instruct the tile-engine that we don't need the old tile-content
+            GLState::clear(GL_COLOR_BUFFER_BIT); // this is to instruct the tile-engine that we don't need the old tile-content
             renderChannelBatch(opass, totaltex, texoffset);
             texoffset += totaltex;
             totaltex = 0;
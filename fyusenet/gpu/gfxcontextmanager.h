@@ -79,7 +79,7 @@ class GfxContextManager {
 #endif
     fyusenet::GfxContextLink createDerived(const fyusenet::GfxContextLink& ctx);
     fyusenet::GfxContextLink getDerived(const fyusenet::GfxContextLink& ctx, int derivedIndex) const;
-    void setupPBOPools(int readPoolSize, int writePoolSize);
+    void setupPBOPools(int readPoolSize, int writePoolSize, bool preallocate = false);
     static std::shared_ptr<GfxContextManager> instance(int device=0);
     static void tearDown();
     void cleanup();
@@ -22,6 +22,7 @@
 #include "../gl/shaderresource.h"
 #include "../gl/glexception.h"
 #include "../gl/shadercache.h"
+#include "../gl/computeshader.h"
 #include "../gl/glinfo.h"
 
 namespace fyusion {
@@ -55,6 +56,11 @@ GPULayerBase::GPULayerBase(const GPULayerBuilder & builder,int layerNumber) :
       fyusenet::LayerBase((const LayerBuilder &)builder, layerNumber) {
     device_ = compute_device::DEV_GPU;
     setContext(builder.context_);
+#ifdef HIGH_PRECISION
+    highPrecision_ = (builder.precision_ != PrecisionType::HALF);
+#else
+    highPrecision_ = (builder.precision_ == PrecisionType::FULL);
+#endif
     // default viewport assumption
     viewport_[0] = width_ + 2*outputPadding_;
     viewport_[1] = height_ + 2*outputPadding_;
@@ -108,6 +114,7 @@ void GPULayerBase::cleanup() {
         delete fbo;
     }
     framebuffers_.clear();
+    bindingRevision_++;
 }
 
 
@@ -197,6 +204,7 @@ void GPULayerBase::addResidualTexture(GLuint textureID, int channelIndex) {
     while ((int)residualTextures_.size() < channelIndex) residualTextures_.push_back(0);      // we expect incrementing channel indices in the default case
     if (channelIndex == (int)residualTextures_.size()) residualTextures_.push_back(textureID);
     else residualTextures_[channelIndex] = textureID;
+    bindingRevision_++;
 }
 
 
@@ -208,6 +216,7 @@ void GPULayerBase::addResidualTexture(GLuint textureID, int channelIndex) {
  */
 void GPULayerBase::clearInputTextures() {
     inputTextures_.clear();
+    bindingRevision_++;
 }
 
 
@@ -220,6 +229,7 @@ void GPULayerBase::clearInputTextures() {
 void GPULayerBase::clearOutputTextures() {
     outputTextures_.clear();
     outputChanged_ = true;
+    bindingRevision_++;
 }
 
 
@@ -261,6 +271,7 @@ void GPULayerBase::addInputTexture(GLuint textureID, int channelIndex) {
     while ((int)inputTextures_.size() < channelIndex) inputTextures_.push_back(0);      // we expect incrementing channel indices in the default case
     if (channelIndex == (int)inputTextures_.size()) inputTextures_.push_back(textureID);
     else inputTextures_[channelIndex] = textureID;
+    bindingRevision_++;
 }
 
 
@@ -283,6 +294,7 @@ void GPULayerBase::addInputTexture(GLuint textureID, int channelIndex) {
 void GPULayerBase::updateInputTexture(GLuint textureID, int channelIndex) {
     if ((int)inputTextures_.size() <= channelIndex) THROW_EXCEPTION_ARGS(FynException,"Invalid channel index %d supplied", channelIndex);
     inputTextures_[channelIndex] = textureID;
+    bindingRevision_++;
 }
 
 
@@ -326,6 +338,7 @@ void GPULayerBase::addOutputTexture(GLuint textureID, int channelIndex, int shad
     if (channelIndex == (int)outputTextures_.size()) outputTextures_.push_back(textureID);
     else outputTextures_[channelIndex] = textureID;
     outputChanged_ = true;
+    bindingRevision_++;
 }
 
 
@@ -437,6 +450,48 @@ bool GPULayerBase::canRun() const {
 
 
 
+/**
+ * @brief Render the output of this layer into a view of a (larger) output texture
+ *
+ * @param enable If \c true, the output is rendered into the view described by the remaining
+ *               parameters, if \c false the output texture is exclusive to this layer
+ * @param originX Horizontal offset (pixels) of the view in the output texture
+ * @param originY Vertical offset (pixels) of the view in the output texture
+ * @param textureWidth Width of the output texture
+ * @param textureHeight Height of the output texture
+ *
+ * @throws FynException if the layer does not support output views, the view does not fit into
+ *         the output texture or the layer has already been set up
+ *
+ * This is used by the BufferManager to let layers render directly into the output texture of a
+ * concatenation layer (see ConcatViewInterface). The size of the view is equivalent to the
+ * output viewport of this layer, regions of the output texture outside the view are left
+ * untouched by forward().
+ *
+ * @post #outputChanged_ is set to \c true to indicate that the FBOs have to be updated
+ */
+void GPULayerBase::setOutputView(bool enable, int originX, int originY, int textureWidth, int textureHeight) {
+    if (valid_) THROW_EXCEPTION_ARGS(FynException, "Cannot change output view of layer %s after setup", name_.c_str());
+    if (enable) {
+        if (!supportsOutputView()) THROW_EXCEPTION_ARGS(FynException, "Layer %s does not support output views", name_.c_str());
+        if ((originX < 0) || (originY < 0) || (originX + viewport_[0] > textureWidth) || (originY + viewport_[1] > textureHeight)) {
+            THROW_EXCEPTION_ARGS(FynException, "Output view %dx%d at (%d,%d) exceeds texture of size %dx%d", viewport_[0], viewport_[1], originX, originY, textureWidth, textureHeight);
+        }
+        outputOrigin_[0] = originX;
+        outputOrigin_[1] = originY;
+        outputExtents_[0] = textureWidth;
+        outputExtents_[1] = textureHeight;
+    } else {
+        outputOrigin_[0] = outputOrigin_[1] = 0;
+        outputExtents_[0] = outputExtents_[1] = 0;
+    }
+    outputView_ = enable;
+    outputChanged_ = true;
+    bindingRevision_++;
+}
+
+
+
 /**
  * @copydoc LayerBase::writeResult
  */
@@ -638,8 +693,7 @@ programptr GPULayerBase::compileShaderPair(const char *vertexName, const char *f
             shaderptr vcache = cache->findShader(vshader);
             shaderptr fcache = cache->findShader(fshader);
             if (vcache && fcache) {
-                std::vector<GLuint> handles{vcache->getHandle(), fcache->getHandle()};
-                programptr prog = cache->findProgram(modhash, handles);
+                programptr prog = cache->findProgram(modhash, {vcache, fcache});
                 if (prog) {
                     return prog;
                 }
@@ -666,6 +720,56 @@ programptr GPULayerBase::compileShaderPair(const char *vertexName, const char *f
 }
 
 
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
+/**
+ * @brief Compile compute shader and create a shader program from it
+ *
+ * @param shaderName Resource name of the compute shader
+ * @param preprocDefs Preprocessor definitions to prepend to the shader code
+ * @param typeInfo Type information of the layer that the shader belongs to (see compileShaderPair())
+ *
+ * @return Shared pointer to shader program
+ *
+ * @pre The GL context supports compute shaders (see GLInfo::supportsComputeShader())
+ *
+ * Compute shader equivalent of compileShaderPair(), including the use of the shader cache. The
+ * same restrictions apply, in particular the returned program is not necessarily linked.
+ *
+ * @throws ShaderException in case the shader could not be loaded or compiled
+ *
+ * @see compileShaderPair
+ */
+programptr GPULayerBase::compileComputeShader(const char *shaderName, const char *preprocDefs, const std::type_info& typeInfo) {
+    using namespace fyusion::opengl;
+    const char *code = ShaderRepository::getShader(shaderName);
+    if (!code) THROW_EXCEPTION_ARGS(ShaderException, "Cannot load compute shader %s (not found)", shaderName);
+    shaderptr cshader(new ComputeShader(context_));
+    cshader->setResourceName(shaderName);
+    cshader->setCode(code);
+    cshader->setPreprocDefs(preprocDefs);
+    ShaderCache *cache = ShaderCache::getInstance(context_);
+    try {
+        shaderptr ccache = (cache) ? cache->findShader(cshader) : shaderptr();
+        if (ccache) {
+            programptr prog = cache->findProgram(typeInfo.hash_code(), {ccache});
+            if (prog) return prog;
+        }
+        programptr prog = ShaderProgram::createInstance(context_);
+        prog->addShader((ccache) ? ccache : cshader);
+        prog->compile();
+        if (cache) {
+            if (!ccache) cache->putShader(cshader);
+            cache->putProgram(prog, typeInfo.hash_code());
+        }
+        return prog;
+    } catch (GLException& ex) {
+        FNLOGE("Cannot compile compute shader in layer %s", getName().c_str());
+        throw;
+    }
+}
+#endif
+
+
 /**
  * @brief Mix user-supplied preprocessor definitions with flag-induced definitions
  *
@@ -697,7 +801,8 @@ programptr GPULayerBase::compileShaderPair(const char *vertexName, const char *f
  *   - \c NO_HALF if set, indicates that 16-bit floating point data is not available as texture
  *        format
  *   - \c HIGH_PRECISION if set, indicates that high precision (full 32-bit FP) are desired and the
- *        precision qualifiers should be set to "high"
+ *        precision qualifiers should be set to "high", this is set for layers that were built
+ *        with full precision (see isHighPrecision())
  *
  * The result of the preprocesser handling is appended to the supplied \p preproc data.
  */
@@ -728,23 +833,18 @@ size_t GPULayerBase::handlePreprocFlags(layerflags flags, char *preproc, size_t
     strncat(preproc, extra, mc);
     mc -= strlen(extra);
     assert(mc > 0);
-#ifdef HIGH_PRECISION
-    strncat(preproc, "#define NO_HALF\n", mc);
-    mc -= 16;
-#else
-    if (!GLInfo::supportsHalf()) {
+    if ((highPrecision_) || (!GLInfo::supportsHalf())) {
         strncat(preproc, "#define NO_HALF\n", mc);
         mc -= 16;
     }
-#endif
     snprintf(extra, sizeof(extra), "#define PADDING %d\n",inputPadding_);
     strncat(preproc, extra, mc);
     mc -= strlen(extra);
     assert(mc >= 0);
-#ifdef HIGH_PRECISION
-    strncat(preproc, "#define HIGH_PRECISION\n", mc);
-    mc = maxChars-strlen(preproc);  // ouch
-#endif
+    if (highPrecision_) {
+        strncat(preproc, "#define HIGH_PRECISION\n", mc);
+        mc = maxChars-strlen(preproc);  // ouch
+    }
     return (size_t)std::max((ssize_t)0,mc);
 }
 
@@ -811,19 +911,54 @@ size_t GPULayerBase::handleActivationPreproc(layerflags flags, char *preproc, si
  */
 void GPULayerBase::prepareRender(bool blend, bool depth) {
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    if (blend) glEnable(GL_BLEND);
-    else glDisable(GL_BLEND);
-    if (depth) glEnable(GL_DEPTH_TEST);
-    else glDisable(GL_DEPTH_TEST);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    if (blend) GLState::enable(GL_BLEND);
+    else GLState::disable(GL_BLEND);
+    if (depth) GLState::enable(GL_DEPTH_TEST);
+    else GLState::disable(GL_DEPTH_TEST);
     if (blend) {
-        glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-        glBlendFuncSeparate(GL_ONE,GL_ONE, GL_ONE,GL_ONE);
+        GLState::blendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+        GLState::blendFuncSeparate(GL_ONE,GL_ONE, GL_ONE,GL_ONE);
     }
-    glClearColor(0, 0, 0, 0);
-    glViewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::clearColor(0, 0, 0, 0);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+}
+
+
+/**
+ * @brief Set the viewport for rendering the output of this layer
+ *
+ * Sets the viewport to the output viewport of the layer, which is offset to the output view in
+ * case the layer renders into a view of a larger texture.
+ *
+ * @see setOutputView()
+ */
+void GPULayerBase::applyOutputViewport() const {
+    GLState::viewport(outputOrigin_[0], outputOrigin_[1], viewport_[0], viewport_[1]);
+}
+
+
+/**
+ * @brief Clear the output of this layer
+ *
+ * @param mask Buffer mask to pass to \c glClear(), defaults to \c GL_COLOR_BUFFER_BIT
+ *
+ * @pre The output %FBO is bound
+ *
+ * In case the layer renders into an output view, the clear operation is restricted to that view
+ * using the scissor test, as the rest of the output texture belongs to other layers.
+ *
+ * @see setOutputView()
+ */
+void GPULayerBase::clearOutput(GLbitfield mask) const {
+    if (outputView_) {
+        GLState::enable(GL_SCISSOR_TEST);
+        GLState::scissor(outputOrigin_[0], outputOrigin_[1], viewport_[0], viewport_[1]);
+        GLState::clear(mask);
+        GLState::disable(GL_SCISSOR_TEST);
+    } else GLState::clear(mask);
 }
 
 } // gpu namespace
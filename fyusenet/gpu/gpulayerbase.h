@@ -19,6 +19,7 @@
 //-------------------------------------- Project  Headers ------------------------------------------
 
 #include "../gl/gl_sys.h"
+#include "../gl/glstate.h"
 #include "../gl/texture.h"
 #include "../gpu/gfxcontextlink.h"
 #include "../gpu/gfxcontexttracker.h"
@@ -141,6 +142,36 @@ class GPULayerBase : public LayerBase, public GfxContextTracker {
     virtual void writeResult(const char *fileName, bool includePadding=false) override;
     virtual void copyResult(float * memory, bool includePadding=false);
 
+    /**
+     * @brief Check if the GL commands issued by forward() may be recorded and replayed
+     *
+     * @retval true if the layer issues the same GL commands on every run, as long as the
+     *         #bindingRevision() does not change
+     * @retval false if the layer must be executed by calling forward() on every run
+     *
+     * Layers are recordable by default. Layers that issue GL commands which are not routed through
+     * opengl::GLState or ShaderProgram (for example data transfers), or that issue different
+     * commands from run to run, have to override this function and return \c false.
+     *
+     * @see fyusenet::Engine::enableRecording(), opengl::CommandStream
+     */
+    virtual bool isRecordable() const {
+        return true;
+    }
+
+    /**
+     * @brief Retrieve revision of the texture bindings and parameters of this layer
+     *
+     * @return Revision number, which is changed whenever the input, output or residual textures
+     *         or other parameters that affect the issued GL commands change
+     *
+     * A recorded command stream of this layer is only valid for the revision that it was recorded
+     * with.
+     */
+    uint32_t bindingRevision() const {
+        return bindingRevision_;
+    }
+
     /**
      * @brief Get pointer to viewport size data
      *
@@ -152,6 +183,66 @@ class GPULayerBase : public LayerBase, public GfxContextTracker {
         return viewport_;
     }
 
+    /**
+     * @brief Check if this layer computes and stores its results in full (32-bit) precision
+     *
+     * @retval true if the layer uses 32-bit floating-point textures and computation
+     * @retval false if the layer uses 16-bit floating-point textures (where supported)
+     *
+     * @see GPULayerBuilderTempl::precision
+     */
+    bool isHighPrecision() const {
+        return highPrecision_;
+    }
+
+    /**
+     * @brief Get sized format of the (4-channel) output textures of this layer
+     *
+     * @return Either \c RGBA32F or \c RGBA16F, depending on the precision of this layer
+     *
+     * @see isHighPrecision(), #TEXTURE_IFORMAT_4
+     */
+    BufferSpec::sizedformat textureFormat() const {
+        return (highPrecision_) ? BufferSpec::sizedformat::RGBA32F : BufferSpec::sizedformat::RGBA16F;
+    }
+
+    /**
+     * @brief Get data type of the output textures of this layer
+     *
+     * @return Either \c FLOAT or \c FLOAT16, depending on the precision of this layer
+     *
+     * @see isHighPrecision(), #TEXTURE_TYPE_DEFAULT
+     */
+    BufferSpec::dtype textureType() const {
+        return (highPrecision_) ? BufferSpec::dtype::FLOAT : BufferSpec::dtype::FLOAT16;
+    }
+
+    /**
+     * @brief Check if this layer is able to render its output into a view of a larger texture
+     *
+     * @retval true if the layer supports rendering into an output view, see setOutputView()
+     * @retval false otherwise
+     *
+     * Layers that support output views must set the viewport using applyOutputViewport() and
+     * restrict clear operations on the output to their view using clearOutput(). In addition,
+     * their shaders must not depend on absolute fragment coordinates.
+     */
+    virtual bool supportsOutputView() const {
+        return false;
+    }
+
+    void setOutputView(bool enable, int originX=0, int originY=0, int textureWidth=0, int textureHeight=0);
+
+    /**
+     * @brief Check if this layer renders its output into a view of a larger texture
+     *
+     * @retval true if the output is rendered into a view, see setOutputView()
+     * @retval false if the output is rendered into textures that are exclusive to this layer
+     */
+    bool hasOutputView() const {
+        return outputView_;
+    }
+
  protected:
     // ------------------------------------------------------------------------
     // Non-public methods
@@ -182,8 +273,13 @@ class GPULayerBase : public LayerBase, public GfxContextTracker {
     size_t handleActivationPreproc(layerflags flags,char *preproc,size_t maxChars);
     size_t handlePreprocFlags(layerflags flags,char *preproc,size_t maxChars);
     void prepareRender(bool blend = true, bool depth = false);
+    void applyOutputViewport() const;
+    void clearOutput(GLbitfield mask = GL_COLOR_BUFFER_BIT) const;
     programptr compileShaderPair(const char *vertexName, const char *fragmentName,
                                  const char *preprocDefs, const std::type_info& typeInfo);
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
+    programptr compileComputeShader(const char *shaderName, const char *preprocDefs, const std::type_info& typeInfo);
+#endif
 
     // ------------------------------------------------------------------------
     // Member variables
@@ -196,6 +292,11 @@ class GPULayerBase : public LayerBase, public GfxContextTracker {
     int viewport_[2] = {0, 0};                   //!< Output (render) viewport size
     int residualViewport_[2]= {0,0};             //!< Output viewport size for optional residual input
     bool outputChanged_ = false;                 //!< Indicator that an output texture has been changed (invalidates the FBOs)
+    uint32_t bindingRevision_ = 0;               //!< Revision of texture bindings / parameters, see bindingRevision()
+    bool highPrecision_ = false;                 //!< Indicator that this layer uses full (32-bit) floating-point precision, see isHighPrecision()
+    bool outputView_ = false;                    //!< Indicator that the output is rendered into a view of a larger texture, see setOutputView()
+    int outputOrigin_[2] = {0, 0};               //!< Offset (pixels) of the output view in the output texture
+    int outputExtents_[2] = {0, 0};              //!< Size of the output texture that contains the output view
 };
 
 } // gpu namespace
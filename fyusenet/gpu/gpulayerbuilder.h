@@ -49,6 +49,7 @@ struct GPULayerBuilderTempl : LayerBuilderTempl<D> {
      */
     GPULayerBuilderTempl(const D& src) : LayerBuilderTempl<D>(src) {
       context_ = src.context_;
+      precision_ = src.precision_;
     }
 
     /**
@@ -63,7 +64,30 @@ struct GPULayerBuilderTempl : LayerBuilderTempl<D> {
       return *(D *)this;
     }
 
+    /**
+     * @brief Set floating-point precision for the layer
+     *
+     * @param prec Precision to use for the output textures, weight textures and the shader
+     *             computation of the newly built layer
+     *
+     * @return Reference to builder object
+     *
+     * By default, all layers use the precision that was selected at compile time via the
+     * \c HIGH_PRECISION flag. This function overrides that setting for a single layer, for example
+     * to run accumulation-sensitive layers in full precision while keeping the (cheaper) half
+     * precision for the rest of the network. Tensors that cross a precision boundary are
+     * converted when the consuming layer samples them, no explicit conversion layer is required.
+     *
+     * @note Layers that do not store weights or use precision-dependent shader code are only
+     *       affected by the precision of their output textures.
+     */
+    D & precision(PrecisionType prec) {
+      precision_ = prec;
+      return *(D *)this;
+    }
+
     GfxContextLink context_;                     //!< GL context to use for the newly-built layer
+    PrecisionType precision_ = PrecisionType::DEFAULT;  //!< Floating-point precision for the newly-built layer
 };
 
 /**
@@ -10,6 +10,7 @@
 //--------------------------------------- System Headers -------------------------------------------
 
 #include <cstring>
+#include <algorithm>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -21,6 +22,7 @@
 #include "deep/deepavgpoollayer.h"
 #include "deep/deepconcatlayer.h"
 #include "deep/deepscalelayer.h"
+#include "deep/deepresizelayer.h"
 #include "deep/deeptransconvlayer2x2.h"
 #include "deep/deeptransconvlayer3x3.h"
 #include "deep/deepdownloadlayer.h"
@@ -29,12 +31,20 @@
 #include "deep/deepgemmlayer.h"
 #include "deep/deepconvlayerNxN.h"
 #include "deep/deepdwconvlayer3x3.h"
+#include "deep/deepcomputeconvlayer.h"
+#include "deep/deepwinogradconvlayer.h"
+#include "deep/deepdwconvlayerNxN.h"
 #include "deep/deepsigmoidlayer.h"
 #include "deep/deeptanhlayer.h"
 #include "deep/deep_singleton_arithlayer.h"
 #include "deep/deepcastlayer.h"
 #include "deep/deeptransposelayer.h"
 #include "deep/deepbatchnormlayer.h"
+#include "deep/deeppointwisechainlayer.h"
+#include "deep/deepsoftmaxlayer.h"
+#include "deep/deepmatmullayer.h"
+#include "deep/deeplayernormlayer.h"
+#include "deep/deepinstancenormlayer.h"
 #ifdef FYUSENET_USE_EGL
 #include "oesconverter.h"
 #endif
@@ -48,6 +58,7 @@
 #include "maxpoollayer.h"
 #include "rgb2bgrlayer.h"
 #include "batchnormlayer.h"
+#include "instancenormlayer.h"
 #include "sigmoidlayer.h"
 #include "tanhlayer.h"
 #include "castlayer.h"
@@ -56,6 +67,7 @@
 #include "shallow2deep.h"
 #include "concatlayer.h"
 #include "addsublayer.h"
+#include "softmaxlayer.h"
 #include "vanilla/convlayer1x1_vanilla.h"
 #include "vanilla/convlayerNxN_vanilla.h"
 #include "vanilla/convlayer_dw_3x3_vanilla.h"
@@ -178,6 +190,16 @@ fyusenet::LayerBase * GPULayerFactoryBackend::createLayer(LayerType type,LayerBu
             return (fyusenet::LayerBase *)createBatchNormLayer((GPULayerBuilder *)builder, layerNumber);
         case LayerType::GEMM:
             return (fyusenet::LayerBase *)createGEMMLayer((GPULayerBuilder *)builder, layerNumber);
+        case LayerType::POINTWISE_CHAIN:
+            return (fyusenet::LayerBase *)createPointwiseChainLayer((PointwiseChainBuilder *)builder, layerNumber);
+        case LayerType::SOFTMAX:
+            return (fyusenet::LayerBase *)createSoftMaxLayer((SoftMaxLayerBuilder *)builder, layerNumber);
+        case LayerType::MATMUL:
+            return (fyusenet::LayerBase *)createMatMulLayer((MatMulLayerBuilder *)builder, layerNumber);
+        case LayerType::LAYERNORM:
+            return (fyusenet::LayerBase *)createLayerNormLayer((LayerNormLayerBuilder *)builder, layerNumber);
+        case LayerType::INSTANCENORM:
+            return (fyusenet::LayerBase *)createInstanceNormLayer((LayerNormLayerBuilder *)builder, layerNumber);
         default:
             THROW_EXCEPTION_ARGS(FynException,"Unsupported layer type");
     }
@@ -353,11 +375,33 @@ GPULayerBase * GPULayerFactoryBackend::createAddSubLayer(GPULayerBuilder *builde
  * @see vanilla::ConvLayer1x1,vanilla::ConvLayer3x3,vanilla::ConvLayer5x5,vanilla::ConvLayer7x7
  * @see vanilla::ConvLayer9x9, vanilla::DepthwiseConvLayer3x3
  * @see deep::DeepConvLayer1x1,deep::DeepConvLayer3x3,deep::DeepConvLayer5x5,deep::DeepConvLayer7x7
- * @see deep::DeepConvLayer9x9, deep::DeepDepthwiseConvLayer3x3
+ * @see deep::DeepConvLayer9x9, deep::DeepDepthwiseConvLayer3x3, deep::DeepComputeConvLayer
+ * @see deep::DeepWinogradConvLayer, deep::DeepDepthwiseConvLayerNxN
  */
 GPULayerBase * GPULayerFactoryBackend::createConvLayer(ConvLayerBuilder *builder,int layerNumber) {
     // NOTE (mw) oh boy, this is super-messy, clean it up in the future
+    if ((builder->pointwise_) && ((!builder->isDeep()) || (builder->groupSize_ != builder->in()))) {
+        THROW_EXCEPTION_ARGS(FynException, "Fused pointwise convolution is only supported for deep depthwise convolutions (layer %s)", builder->name_.c_str());
+    }
+    if (builder->resizeSource_[0] > 0) {
+        if ((!builder->isDeep()) || (builder->compute_) || (builder->groupSize_ != 1) || ((builder->kernel_ & 1) == 0)) {
+            THROW_EXCEPTION_ARGS(FynException, "Folded input resize is only supported for deep, non-grouped convolutions with odd kernel size (layer %s)", builder->name_.c_str());
+        }
+        if (builder->kernel_ == 1) return new deep::DeepConvLayer1x1(*builder, layerNumber);
+        return new deep::DeepConvLayerNxN(*builder, layerNumber);
+    }
     if (builder->isDeep()) {
+        if (builder->compute_) {
+#if defined(GL_VERSION_4_3) || defined(GL_ES_VERSION_3_1) || defined(GL_ES_VERSION_3_2)
+            if (deep::DeepComputeConvLayer::isSupported(*builder)) return new deep::DeepComputeConvLayer(*builder, layerNumber);
+#endif
+            if ((builder->arrayInput_) || (builder->arrayOutput_)) {
+                THROW_EXCEPTION_ARGS(FynException, "Texture-array storage requires compute shader support (layer %s)", builder->name_.c_str());
+            }
+            FNLOGW("Compute shader not supported for layer %s, using fragment shader instead", builder->name_.c_str());
+        } else if ((builder->arrayInput_) || (builder->arrayOutput_)) {
+            THROW_EXCEPTION_ARGS(FynException, "Texture-array storage is only supported for compute convolutions (layer %s)", builder->name_.c_str());
+        }
         switch (builder->kernel_) {
             case 1:
                 if ((builder->groupSize_ != 1) && (builder->groupSize_ == builder->in())) {
@@ -366,11 +410,22 @@ GPULayerBase * GPULayerFactoryBackend::createConvLayer(ConvLayerBuilder *builder
                 return new deep::DeepConvLayer1x1(*builder,layerNumber);
             case 3:
                 if ((builder->groupSize_ != 1) && (builder->groupSize_ == builder->in())) {
+                    // NOTE the 3x3 depthwise shader uses textureOffset() which limits the dilation
+                    if ((builder->pointwise_) || (std::max(builder->dilation_[0], builder->dilation_[1]) > 7)) {
+                        return new deep::DeepDepthwiseConvLayerNxN(*builder, layerNumber);
+                    }
                     return new deep::DeepDepthwiseConvLayer3x3(*builder,layerNumber);
                 }
+                if (builder->winograd_ > 0) {
+                    if (deep::DeepWinogradConvLayer::isSupported(*builder)) return new deep::DeepWinogradConvLayer(*builder, layerNumber);
+                    FNLOGW("Winograd convolution not supported for layer %s, using direct convolution instead", builder->name_.c_str());
+                } else if ((builder->winograd_ < 0) && (deep::DeepWinogradConvLayer::isPreferred(*builder))) {
+                    return new deep::DeepWinogradConvLayer(*builder, layerNumber);
+                }
                 return new deep::DeepConvLayerNxN(*builder,layerNumber);
             default:
                 if ((builder->groupSize_ != 1) && (builder->groupSize_ == builder->in())) {
+                    if (deep::DeepDepthwiseConvLayerNxN::isSupported(*builder)) return new deep::DeepDepthwiseConvLayerNxN(*builder, layerNumber);
                     THROW_EXCEPTION_ARGS(FynException,"No %dx%d depthwise layer supported", builder->kernel_, builder->kernel_);
                 }
                 return new deep::DeepConvLayerNxN(*builder,layerNumber);
@@ -466,12 +521,16 @@ GPULayerBase * GPULayerFactoryBackend::createFracConvLayer(ConvLayerBuilder *bui
  *
  * @return Raw pointer to created layer
  *
- * @see ScaleLayer, DeepScaleLayer
+ * @see ScaleLayer, DeepScaleLayer, DeepResizeLayer
  */
 GPULayerBase * GPULayerFactoryBackend::createScaleLayer(ScaleLayerBuilder *builder,int layerNumber) {
     if (builder->isDeep()) {
+        if (builder->isResize()) return new deep::DeepResizeLayer(*builder, layerNumber);
         return new deep::DeepScaleLayer(*builder, layerNumber);
     }
+    if (builder->isResize()) {
+        THROW_EXCEPTION_ARGS(FynException, "Arbitrary resizing is only supported for deep tensors (layer %s)", builder->name_.c_str());
+    }
     return new ScaleLayer(*builder, layerNumber);
 }
 
@@ -815,6 +874,111 @@ GPULayerBase * GPULayerFactoryBackend::createGEMMLayer(GPULayerBuilder * builder
 }
 
 
+/**
+ * @brief Create a fused pointwise-chain layer
+ *
+ * @param builder Instance of PointwiseChainBuilder that contains the parameters for the layer
+ *
+ * @param layerNumber Layer number to assigned to the created layer, must be unique
+ *
+ * @return Raw pointer to created layer
+ *
+ * @see deep::DeepPointwiseChainLayer
+ *
+ * @warning Currently not implemented for shallow tensors
+ */
+GPULayerBase * GPULayerFactoryBackend::createPointwiseChainLayer(PointwiseChainBuilder * builder, int layerNumber) {
+    if (builder->isDeep()) {
+        return new deep::DeepPointwiseChainLayer(*builder, layerNumber);
+    }
+    THROW_EXCEPTION_ARGS(FynException,"No shallow pointwise-chain layer support (yet)");
+}
+
+
+/**
+ * @brief Create a softmax layer
+ *
+ * @param builder Instance of SoftMaxLayerBuilder that contains the parameters for the layer
+ *
+ * @param layerNumber Layer number to assigned to the created layer, must be unique
+ *
+ * @return Raw pointer to created layer
+ *
+ * @see deep::DeepSoftMaxLayer, SoftMaxLayer
+ */
+GPULayerBase * GPULayerFactoryBackend::createSoftMaxLayer(SoftMaxLayerBuilder * builder, int layerNumber) {
+    if (builder->isDeep()) {
+        return new deep::DeepSoftMaxLayer(*builder, layerNumber);
+    } else {
+        return new SoftMaxLayer(*builder, layerNumber);
+    }
+}
+
+
+/**
+ * @brief Create a (batched) matrix-multiplication layer for two runtime tensors
+ *
+ * @param builder Instance of MatMulLayerBuilder that contains the parameters for the layer
+ *
+ * @param layerNumber Layer number to assigned to the created layer, must be unique
+ *
+ * @return Raw pointer to created layer
+ *
+ * @see deep::DeepMatMulLayer
+ *
+ * @warning Currently not implemented for shallow tensors
+ */
+GPULayerBase * GPULayerFactoryBackend::createMatMulLayer(MatMulLayerBuilder * builder, int layerNumber) {
+    if (builder->isDeep()) {
+        return new deep::DeepMatMulLayer(*builder, layerNumber);
+    }
+    THROW_EXCEPTION_ARGS(FynException,"No shallow matrix-multiplication layer support (yet)");
+}
+
+
+/**
+ * @brief Create a layer-normalization layer
+ *
+ * @param builder Instance of LayerNormLayerBuilder that contains the parameters for the layer
+ *
+ * @param layerNumber Layer number to assigned to the created layer, must be unique
+ *
+ * @return Raw pointer to created layer
+ *
+ * @see deep::DeepLayerNormLayer, deep::DeepInstanceNormLayer, InstanceNormLayer
+ *
+ * @warning Layer normalization over the channels of each spatial position is currently not
+ *          implemented for shallow tensors
+ */
+GPULayerBase * GPULayerFactoryBackend::createLayerNormLayer(LayerNormLayerBuilder * builder, int layerNumber) {
+    if (builder->isDeep()) {
+        if (builder->spatial_) return new deep::DeepInstanceNormLayer(*builder, layerNumber);
+        return new deep::DeepLayerNormLayer(*builder, layerNumber);
+    }
+    if (builder->spatial_) return new InstanceNormLayer(*builder, layerNumber);
+    THROW_EXCEPTION_ARGS(FynException,"No shallow layer-normalization layer support over channels only (yet)");
+}
+
+
+/**
+ * @brief Create an instance-normalization layer
+ *
+ * @param builder Instance of LayerNormLayerBuilder that contains the parameters for the layer
+ *
+ * @param layerNumber Layer number to assigned to the created layer, must be unique
+ *
+ * @return Raw pointer to created layer
+ *
+ * @see deep::DeepInstanceNormLayer, InstanceNormLayer
+ */
+GPULayerBase * GPULayerFactoryBackend::createInstanceNormLayer(LayerNormLayerBuilder * builder, int layerNumber) {
+    if (builder->isDeep()) {
+        return new deep::DeepInstanceNormLayer(*builder, layerNumber);
+    }
+    return new InstanceNormLayer(*builder, layerNumber);
+}
+
+
 } // gpu namespace
 } // fyusenet namespace
 } // fyusion namespace
@@ -31,6 +31,10 @@
 #include "customlayerbuilder.h"
 #include "transposelayerbuilder.h"
 #include "updownlayerbuilder.h"
+#include "pointwisechainbuilder.h"
+#include "softmaxlayerbuilder.h"
+#include "matmullayerbuilder.h"
+#include "layernormlayerbuilder.h"
 
 namespace fyusion {
 namespace fyusenet {
@@ -89,6 +93,11 @@ class GPULayerFactoryBackend : public LayerFactoryBackend {
     GPULayerBase * createTransposeLayer(TransposeLayerBuilder * builder, int layerNumber);
     GPULayerBase * createBatchNormLayer(GPULayerBuilder * builder, int layerNumber);
     GPULayerBase * createGEMMLayer(GPULayerBuilder * builder, int layerNumber);
+    GPULayerBase * createPointwiseChainLayer(PointwiseChainBuilder * builder, int layerNumber);
+    GPULayerBase * createSoftMaxLayer(SoftMaxLayerBuilder * builder, int layerNumber);
+    GPULayerBase * createMatMulLayer(MatMulLayerBuilder * builder, int layerNumber);
+    GPULayerBase * createLayerNormLayer(LayerNormLayerBuilder * builder, int layerNumber);
+    GPULayerBase * createInstanceNormLayer(LayerNormLayerBuilder * builder, int layerNumber);
  private:
     static void checkRequirements();
     // ------------------------------------------------------------------------
@@ -0,0 +1,388 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Instance-Normalization Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstring>
+#include <algorithm>
+#include <memory>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "instancenormlayer.h"
+#include "../gl/glexception.h"
+#include "../common/logging.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+InstanceNormLayer::InstanceNormLayer(const LayerNormLayerBuilder & builder, int layerNumber) :
+    BatchNormLayer((const GPULayerBuilder &)builder, layerNumber) {
+    if (flags_ & (LayerFlags::RESIDUAL_INPUT | LayerFlags::POST_BATCHNORM)) THROW_EXCEPTION_ARGS(FynException, "This layer does not support residual inputs or batchnorm");
+    if (outputChannels_ != inputChannels_) THROW_EXCEPTION_ARGS(FynException, "Number of output channels must match number of input channels");
+    if (builder.epsilon_ <= 0.f) THROW_EXCEPTION_ARGS(FynException, "Epsilon must be positive");
+    spatial_ = (builder.type_ == LayerType::LAYERNORM);
+    if ((spatial_) && (!builder.spatial_)) THROW_EXCEPTION_ARGS(FynException, "Layer normalization over channels only is not supported on shallow tensors");
+    epsilon_ = builder.epsilon_;
+    numTextures_ = (inputChannels_ + PIXEL_PACKING - 1) / PIXEL_PACKING;
+    //------------------------------------------------------
+    // Default to identity scale and bias...
+    //------------------------------------------------------
+    std::unique_ptr<float[]> identity(new float[2 * outputChannels_]);
+    for (int i=0; i < outputChannels_; i++) {
+        identity[i] = 1.0f;
+        identity[outputChannels_ + i] = 0.0f;
+    }
+    BatchNormLayer::loadScaleAndBias(identity.get(), 0);
+    //------------------------------------------------------
+    // Plan tree reduction for larger spatial extents, each
+    // pass reduces blocks of pixels until the remaining
+    // textures are small enough for the final pass...
+    //------------------------------------------------------
+    int width = width_;
+    int height = height_;
+    while (std::max(width, height) > SINGLE_PASS_LIMIT) {
+        int block = (std::max(width, height) >= LARGE_REDUCTION_SIZE) ? 8 : 4;
+        ReductionPass pass;
+        pass.blockX = std::min(block, width);
+        pass.blockY = std::min(block, height);
+        pass.width = (width + pass.blockX - 1) / pass.blockX;
+        pass.height = (height + pass.blockY - 1) / pass.blockY;
+        passes_.push_back(pass);
+        width = pass.width;
+        height = pass.height;
+    }
+}
+
+
+/**
+ * @copydoc LayerBase::setup
+ */
+void InstanceNormLayer::setup() {
+    setupStatisticsPolygons();
+    BatchNormLayer::setup();
+}
+
+
+/**
+ * @copydoc GPULayerBase::cleanup
+ */
+void InstanceNormLayer::cleanup() {
+    passShaders_.clear();
+    passStates_.clear();
+    finalShader_.reset();
+    finalState_.reset();
+    combineShader_.reset();
+    combineState_.reset();
+    for (FBO * fbo : passFBOs_) delete fbo;
+    for (Texture2D * tex : passM2_) delete tex;
+    passFBOs_.clear();
+    passM2_.clear();
+    delete momentsFBO_;
+    delete momentsM2_;
+    delete statsFBO_;
+    delete statsRstd_;
+    delete statsArray_;
+    delete statsVertices_;
+    delete statsIndices_;
+    momentsFBO_ = nullptr;
+    momentsM2_ = nullptr;
+    statsFBO_ = nullptr;
+    statsRstd_ = nullptr;
+    statsArray_ = nullptr;
+    statsVertices_ = nullptr;
+    statsIndices_ = nullptr;
+    BatchNormLayer::cleanup();
+}
+
+
+/**
+ * @copydoc BatchNormInterface::loadScaleAndBias()
+ *
+ * For this layer, the scale values correspond to the \e gamma and the bias values to the
+ * \e beta parameters of the normalization. Previously loaded values are replaced.
+ */
+void InstanceNormLayer::loadScaleAndBias(const float *scaleBias, size_t sbOffset) {
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    for (BiasScaleBlock * block : blocks_) delete block;
+    blocks_.clear();
+    BatchNormLayer::loadScaleAndBias(scaleBias, sbOffset);
+}
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @copydoc FunctionLayer::beforeRender
+ *
+ * This runs the reduction passes that compute the statistics for all input textures before
+ * the output passes and binds the statistics textures for them.
+ */
+void InstanceNormLayer::beforeRender() {
+    computeStatistics();
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::activeTexture(GL_TEXTURE0 + STATS_UNIT);
+    GLState::bindTexture(GL_TEXTURE_2D, statsFBO_->getAttachment());
+    GLState::activeTexture(GL_TEXTURE0 + STATS_UNIT + 1);
+    GLState::bindTexture(GL_TEXTURE_2D, statsRstd_->getHandle());
+    BatchNormLayer::beforeRender();
+}
+
+
+/**
+ * @copydoc FunctionLayer::renderChannelBatch
+ */
+void InstanceNormLayer::renderChannelBatch(int outPass, int numRenderTargets, int texOffset) {
+    for (int tex = 0; tex < numRenderTargets; tex++) {
+        GLState::activeTexture(GL_TEXTURE0 + tex);
+        GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(tex + texOffset));
+    }
+    if (currentShader_ != shaders_[numRenderTargets-1].get()) {
+        if (currentShader_) currentShader_->unbind(true);
+        currentShader_ = shaders_[numRenderTargets-1].get();
+        currentShader_->bind(shaderStates_[numRenderTargets-1].get());
+    }
+    BiasScaleBlock *block = blocks_.at(outPass);
+    currentShader_->setMappedUniformVec4Array(UNIFORM_BIASSCALE, block->biasScale_, numRenderTargets * 2);
+    currentShader_->setMappedUniformValue(UNIFORM_TEXOFFSET, texOffset);
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *) 0);
+}
+
+
+/**
+ * @brief Compute mean and inverse standard deviation for all input textures
+ *
+ * Runs the reduction passes for each input texture in turn, re-using the intermediate
+ * framebuffers. The final reduction pass of each texture writes a single texel of the
+ * statistics textures. For spatial layer normalization, these are combined afterwards.
+ */
+void InstanceNormLayer::computeStatistics() {
+    statsArray_->bind();
+    for (int t=0; t < numTextures_; t++) {
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(t));
+        for (int i=0; i < (int)passes_.size(); i++) {
+            passFBOs_[i]->bindWithViewport();
+            passFBOs_[i]->setWriteMask();
+            passShaders_[i]->bind(passStates_[i].get());
+            GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+            passShaders_[i]->unbind(true);
+            passFBOs_[i]->unbind();
+            GLState::activeTexture(GL_TEXTURE0);
+            GLState::bindTexture(GL_TEXTURE_2D, passFBOs_[i]->getAttachment());
+            GLState::activeTexture(GL_TEXTURE1);
+            GLState::bindTexture(GL_TEXTURE_2D, passM2_[i]->getHandle());
+        }
+        FBO * target = (spatial_) ? momentsFBO_ : statsFBO_;
+        target->bind();
+        target->setWriteMask();
+        GLState::viewport(t, 0, 1, 1);
+        finalShader_->bind(finalState_.get());
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        finalShader_->unbind(true);
+        target->unbind();
+    }
+    if (spatial_) {
+        statsFBO_->bindWithViewport();
+        statsFBO_->setWriteMask();
+        combineShader_->bind(combineState_.get());
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, momentsFBO_->getAttachment());
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, momentsM2_->getHandle());
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        combineShader_->unbind(true);
+        statsFBO_->unbind();
+    }
+    statsArray_->unbind();
+}
+
+
+/**
+ * @copydoc FunctionLayer::setupShaders
+ */
+void InstanceNormLayer::setupShaders() {
+    char preproc[1024] = {0}, extra[256];
+    handlePreprocFlags(flags_, preproc, sizeof(preproc)-1);
+    //------------------------------------------------------
+    // Reduction passes...
+    //------------------------------------------------------
+    int width = width_, height = height_, pad = inputPadding_;
+    int cellx = 1, celly = 1;
+    for (int i=0; i < (int)passes_.size(); i++) {
+        const ReductionPass & pass = passes_.at(i);
+        programptr shader = compileReductionShader(preproc, (i == 0), false, width, height, pad, pass.blockX, pass.blockY, cellx, celly, 1);
+        passShaders_.push_back(shader);
+        unistateptr state = UniformState::makeShared(shader);
+        state->setUniformValue("inputLayer0", 0);
+        state->setUniformValue("inputLayer1", 1, true);
+        passStates_.push_back(state);
+        cellx *= pass.blockX;
+        celly *= pass.blockY;
+        width = pass.width;
+        height = pass.height;
+        pad = 0;
+    }
+    finalShader_ = compileReductionShader(preproc, passes_.empty(), !spatial_, width, height, pad, width, height, cellx, celly, numTextures_);
+    finalState_ = UniformState::makeShared(finalShader_);
+    finalState_->setUniformValue("inputLayer0", 0);
+    finalState_->setUniformValue("inputLayer1", 1, true);
+    if (spatial_) {
+        snprintf(extra, sizeof(extra), "#define TILES %d\n#define TILES_X %d\n#define CHANNELS %d\n#define COUNT %d\n#define EPSILON %.8e\n",
+                 numTextures_, numTextures_, inputChannels_, width_ * height_, epsilon_);
+        combineShader_ = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/normcombine.frag", extra, typeid(this));
+        combineShader_->bindAttributeLocation("attributes0", 0);
+        combineShader_->link();
+        combineState_ = UniformState::makeShared(combineShader_);
+        combineState_->setUniformValue("inputLayer0", 0);
+        combineState_->setUniformValue("inputLayer1", 1);
+    }
+    //------------------------------------------------------
+    // Output passes (one shader per number of lanes)...
+    //------------------------------------------------------
+    for (int i = 1; i <= maxRenderTargets_; i++) {
+        char lanepreproc[1024+64] = {0};
+        snprintf(lanepreproc, sizeof(lanepreproc), "%s#define NUM_LANES %d\n", preproc, i);
+        shaders_[i-1] = compileShaderPair("shaders/default.vert", "shaders/instancenorm.frag", lanepreproc, typeid(this));
+        try {
+            shaders_[i-1]->bindAttributeLocation("attributes0", 0);
+            shaders_[i-1]->link();
+        } catch (GLException &ex) {
+            FNLOGE("Cannot link shader for layer %s", getName().c_str());
+            throw;
+        }
+        shaderStates_[i-1] = UniformState::makeShared(shaders_[i - 1]);
+        for (int j=0; j < i; j++) {
+            snprintf(extra, sizeof(extra), "inputLayer%d", j);
+            shaderStates_[i-1]->setUniformValue(extra, j);
+        }
+        shaderStates_[i-1]->setUniformValue("meanLayer", STATS_UNIT);
+        shaderStates_[i-1]->setUniformValue("rstdLayer", STATS_UNIT + 1);
+        shaders_[i-1]->mapUniformLocation("biasscale", UNIFORM_BIASSCALE);
+        shaders_[i-1]->mapUniformLocation("texOffset", UNIFORM_TEXOFFSET);
+    }
+}
+
+
+/**
+ * @brief Compile a shader for a reduction pass
+ *
+ * @param preproc Preprocessor definitions to prepend
+ * @param first Indicator that this pass reads the input texture (instead of intermediate results)
+ * @param final Indicator that this pass computes the inverse standard deviation instead of the
+ *              sum of squared deviations
+ * @param inWidth Width of the input texture (without padding)
+ * @param inHeight Height of the input texture (without padding)
+ * @param inPad Padding of the input texture
+ * @param blockX Horizontal size of the blocks to reduce
+ * @param blockY Vertical size of the blocks to reduce
+ * @param cellX Horizontal number of original pixels that are covered by each input texel
+ * @param cellY Vertical number of original pixels that are covered by each input texel
+ * @param outTiles Number of texels in the output row, where the current viewport selects the
+ *                 texel to write
+ *
+ * @return Shared pointer to linked shader program
+ */
+programptr InstanceNormLayer::compileReductionShader(const char *preproc, bool first, bool final, int inWidth, int inHeight, int inPad,
+                                                     int blockX, int blockY, int cellX, int cellY, int outTiles) {
+    char finalpreproc[2048] = {0};
+    snprintf(finalpreproc, sizeof(finalpreproc),
+             "%s%s%s#define SINGLE_TILE\n#define TILES %d\n#define IN_TILES_X 1\n#define IN_WIDTH %d\n#define IN_HEIGHT %d\n#define IN_PAD %d\n"
+             "#define BLOCK_X %d\n#define BLOCK_Y %d\n#define CELL_X %d\n#define CELL_Y %d\n#define ORIG_WIDTH %d\n#define ORIG_HEIGHT %d\n"
+             "#define OUT_WIDTH %d\n#define OUT_HEIGHT %d\n#define OUT_TILES_X %d\n#define EPSILON %.8e\n",
+             preproc, (first) ? "#define FIRST_PASS\n" : "", (final) ? "#define FINAL_STATS\n" : "",
+             outTiles, inWidth, inHeight, inPad, blockX, blockY, cellX, cellY, width_, height_,
+             (inWidth + blockX - 1) / blockX, (inHeight + blockY - 1) / blockY, outTiles, epsilon_);
+    programptr shader = compileShaderPair("shaders/deep/deepdefault.vert", "shaders/normreduce.frag", finalpreproc, typeid(this));
+    try {
+        shader->bindAttributeLocation("attributes0", 0);
+        shader->link();
+    } catch (GLException& ex) {
+        FNLOGE("Cannot link shader for layer %s", getName().c_str());
+        throw;
+    }
+    return shader;
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ *
+ * Besides the output framebuffers, this creates the framebuffers for the intermediate reduction
+ * results of a single texture and for the statistics of all textures, each of them with two
+ * single-precision render targets.
+ */
+void InstanceNormLayer::setupFBOs() {
+    BatchNormLayer::setupFBOs();
+    if (statsFBO_) return;
+    for (const ReductionPass & pass : passes_) {
+        FBO * fbo = new FBO(context_, pass.width, pass.height, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        Texture2D * m2 = new Texture2D(pass.width, pass.height, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+        fbo->addTexture(GL_COLOR_ATTACHMENT1, *m2);
+        fbo->unbind();
+        passFBOs_.push_back(fbo);
+        passM2_.push_back(m2);
+    }
+    if (spatial_) {
+        momentsFBO_ = new FBO(context_, numTextures_, 1, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        momentsM2_ = new Texture2D(numTextures_, 1, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+        momentsFBO_->addTexture(GL_COLOR_ATTACHMENT1, *momentsM2_);
+        momentsFBO_->unbind();
+    }
+    statsFBO_ = new FBO(context_, numTextures_, 1, PIXEL_PACKING, opengl::Texture::FLOAT32);
+    statsRstd_ = new Texture2D(numTextures_, 1, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+    statsFBO_->addTexture(GL_COLOR_ATTACHMENT1, *statsRstd_);
+    statsFBO_->unbind();
+}
+
+
+/**
+ * @brief Setup a proxy polygon that drives the reduction passes
+ *
+ * In contrast to the output passes, the reduction shaders derive the position to compute from
+ * the fragment coordinates and require a quad that covers the whole viewport.
+ */
+void InstanceNormLayer::setupStatisticsPolygons() {
+    float quad[4*4] = {-1.f, -1.f, 0.f, 0.f,
+                        1.f, -1.f, 1.f, 0.f,
+                        1.f,  1.f, 1.f, 1.f,
+                       -1.f,  1.f, 0.f, 1.f};
+    GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+    statsArray_ = new VAO(context_);
+    statsArray_->bind();
+    statsVertices_ = new VBO(context_);
+    statsArray_->enableArray(0);
+    statsVertices_->setBufferData(quad, sizeof(quad), GL_STATIC_DRAW);
+    statsVertices_->bind();
+    statsArray_->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    statsIndices_ = new IBO(context_);
+    statsIndices_->setBufferData(indices, sizeof(indices), GL_STATIC_DRAW);
+    statsIndices_->bind();
+    statsArray_->unbind();
+}
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,122 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Instance-Normalization Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../gl/gl_sys.h"
+#include "../gl/texture.h"
+#include "../gl/vao.h"
+#include "../gl/vbo.h"
+#include "../gl/ibo.h"
+#include "batchnormlayer.h"
+#include "layernormlayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+
+/**
+ * @brief Instance normalization (and layer normalization over the whole tensor) for shallow tensors
+ *
+ * This layer normalizes each channel of the input tensor to zero mean and unit variance over its
+ * spatial extent and applies a per-channel scale and bias afterwards. When built as spatial layer
+ * normalization (see LayerNormLayerBuilder::spatial), the per-channel statistics are combined
+ * into a single mean and variance for the whole tensor.
+ *
+ * The statistics are computed by the same tree reduction as for deep tensors (see
+ * deep::DeepInstanceNormLayer), which is run on each input texture in turn and stores the mean
+ * and inverse standard deviation of each texture as single texel in two statistics textures.
+ * The output pass re-uses the multiple-render-target setup of the BatchNormLayer, with the
+ * normalization prepended to the per-channel scale and bias.
+ *
+ * @note Layer normalization over the channels of each spatial position is not supported for
+ *       shallow tensors, use deep tensors for that.
+ *
+ * @see LayerNormLayerBuilder, deep::DeepInstanceNormLayer
+ */
+class InstanceNormLayer : public BatchNormLayer {
+ public:
+    constexpr static int SINGLE_PASS_LIMIT = 8;       //!< Maximum spatial extent (per axis) that is reduced by the final pass alone
+    constexpr static int LARGE_REDUCTION_SIZE = 64;   //!< Minimum spatial extent (per axis) for using 8x8 instead of 4x4 reduction blocks
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    InstanceNormLayer(const LayerNormLayerBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void setup() override;
+    virtual void cleanup() override;
+    virtual void loadScaleAndBias(const float *scaleBias, size_t sbOffset=0) override;
+
+ protected:
+    /**
+     * @brief Dimensions of a single reduction pass
+     */
+    struct ReductionPass {
+        int width;          //!< Width of the texture after the reduction
+        int height;         //!< Height of the texture after the reduction
+        int blockX;         //!< Horizontal size of the reduced blocks
+        int blockY;         //!< Vertical size of the reduced blocks
+    };
+
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    virtual void renderChannelBatch(int outPass, int numRenderTargets, int texOffset) override;
+    virtual void setupShaders() override;
+    virtual void setupFBOs() override;
+    virtual void beforeRender() override;
+    void computeStatistics();
+    void setupStatisticsPolygons();
+    programptr compileReductionShader(const char *preproc, bool first, bool final, int inWidth, int inHeight, int inPad,
+                                      int blockX, int blockY, int cellX, int cellY, int outTiles);
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    float epsilon_ = 1e-5f;                     //!< Constant that is added to the variance
+    bool spatial_ = false;                      //!< Indicator that the statistics are combined over all channels (layer normalization)
+    int numTextures_ = 0;                       //!< Number of input (and output) textures
+    std::vector<ReductionPass> passes_;         //!< Intermediate reduction passes, empty if the final pass can reduce the input directly
+    std::vector<programptr> passShaders_;       //!< Shader programs for the intermediate reduction passes
+    std::vector<unistateptr> passStates_;       //!< UniformState objects for the #passShaders_
+    std::vector<FBO *> passFBOs_;               //!< Framebuffers for the intermediate block means
+    std::vector<Texture2D *> passM2_;           //!< Second render targets of the #passFBOs_ (sums of squared deviations)
+    programptr finalShader_;                    //!< Shader for the final reduction pass
+    unistateptr finalState_;                    //!< Uniform-variable state for #finalShader_
+    programptr combineShader_;                  //!< Shader that combines the per-channel statistics (spatial layer normalization only)
+    unistateptr combineState_;                  //!< Uniform-variable state for #combineShader_
+    FBO *momentsFBO_ = nullptr;                 //!< Per-channel means of each texture (spatial layer normalization only)
+    Texture2D *momentsM2_ = nullptr;            //!< Second render target of #momentsFBO_
+    FBO *statsFBO_ = nullptr;                   //!< Per-channel means of each texture, one texel per texture
+    Texture2D *statsRstd_ = nullptr;            //!< Second render target of #statsFBO_ (inverse standard deviations)
+    VAO *statsArray_ = nullptr;                 //!< Vertex array object for the viewport-filling quad of the reduction passes
+    VBO *statsVertices_ = nullptr;              //!< Vertex coordinates of the quad
+    IBO *statsIndices_ = nullptr;               //!< Polygon connectivity of the quad
+
+    constexpr static int UNIFORM_TEXOFFSET = 2;         //!< Index of the texture offset in the shader uniforms
+    constexpr static int STATS_UNIT = 8;                //!< First texture unit for the statistics textures in the output pass
+};
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,119 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Layer/Instance-Normalization GPU Layer Builder (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <string>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gfxcontextlink.h"
+#include "gpulayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+
+namespace fyusion {
+using namespace opengl;
+namespace fyusenet {
+namespace gpu {
+
+/**
+ * @brief Templatized anchor for GPU-based layer- and instance-normalization layers
+ *
+ * @see LayerNormLayerBuilder
+ */
+template<typename D = GPULayerBuilderTempl<>>
+struct LayerNormLayerBuilderTempl : GPULayerBuilderTempl<D> {
+
+    /**
+     * @brief Constructor
+     *
+     * @param name Name to be assigned to the built layer
+     */
+    LayerNormLayerBuilderTempl(const std::string& name) : GPULayerBuilderTempl<D>(name) {
+        LayerBuilderTempl<D>::type_ = LayerType::LAYERNORM;
+    }
+
+    /**
+     * @brief Set the constant that is added to the variance before taking the square root
+     *
+     * @param eps Epsilon value, defaults to 1e-5
+     *
+     * @return Reference to builder object
+     */
+    D & epsilon(float eps) {
+        epsilon_ = eps;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Normalize each channel over its spatial extent (instance normalization)
+     *
+     * @return Reference to builder object
+     *
+     * This sets the layer type to LayerType::INSTANCENORM, which computes one mean and variance
+     * for each channel over the whole spatial plane, as used in style-transfer networks.
+     */
+    D & instance() {
+        LayerBuilderTempl<D>::type_ = LayerType::INSTANCENORM;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Normalize over the channels \e and the spatial extent of the tensor
+     *
+     * @param on Set to \c true to compute a single mean and variance over the whole (C x H x W)
+     *           tensor instead of one per spatial position
+     *
+     * @return Reference to builder object
+     *
+     * This corresponds to the layer normalization used in convolutional networks (or a group
+     * normalization with a single group). It has no effect on instance normalization.
+     */
+    D & spatial(bool on=true) {
+        spatial_ = on;
+        return *(D *)this;
+    }
+
+    float epsilon_ = 1e-5f;         //!< Constant that is added to the variance for numerical stability
+    bool spatial_ = false;          //!< Indicator that layer normalization also covers the spatial extent
+};
+
+
+/**
+ * @brief Builder object for GPU-based layer- and instance-normalization layers
+ *
+ * By default, this builder parameterizes a layer normalization as used in transformer blocks,
+ * which normalizes all channels of each spatial position to zero mean and unit variance. Using
+ * spatial(), the statistics are computed over the whole tensor instead and using instance(),
+ * they are computed per channel over the spatial extent. In all cases, a learned per-channel
+ * scale (gamma) and bias (beta) is applied afterwards, which are loaded via the
+ * BatchNormInterface.
+ *
+ * @see deep::DeepLayerNormLayer, deep::DeepInstanceNormLayer, InstanceNormLayer
+ */
+struct LayerNormLayerBuilder : LayerNormLayerBuilderTempl<LayerNormLayerBuilder> {
+
+    /**
+     * @brief Constructor
+     *
+     * @param name Name to be assigned to the built layer
+     */
+    LayerNormLayerBuilder(const std::string& name) : LayerNormLayerBuilderTempl<LayerNormLayerBuilder>(name) {
+    }
+};
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,171 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Matrix-Multiplication GPU Layer Builder (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <string>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gfxcontextlink.h"
+#include "gpulayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+
+namespace fyusion {
+using namespace opengl;
+namespace fyusenet {
+namespace gpu {
+
+/**
+ * @brief Templatized anchor for GPU-based (batched) matrix-multiplication layers
+ *
+ * @see MatMulLayerBuilder
+ */
+template<typename D = GPULayerBuilderTempl<>>
+struct MatMulLayerBuilderTempl : GPULayerBuilderTempl<D> {
+
+    /**
+     * @brief Constructor
+     *
+     * @param name Name to be assigned to the built layer
+     */
+    MatMulLayerBuilderTempl(const std::string& name) : GPULayerBuilderTempl<D>(name) {
+        LayerBuilderTempl<D>::type_ = LayerType::MATMUL;
+    }
+
+    /**
+     * @brief Set the shape of the second input tensor (the right-hand side of the product)
+     *
+     * @param width Width of the second input tensor
+     * @param height Height of the second input tensor
+     * @param channels Number of channels of the second input tensor
+     *
+     * @return Reference to builder object
+     *
+     * The shape of the first input tensor is set via the usual shape() call, which also sets the
+     * number of output channels.
+     */
+    D & secondInput(int width, int height, int channels) {
+        secondShape_[0] = (short)width;
+        secondShape_[1] = (short)height;
+        secondShape_[2] = (short)channels;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Transpose the first input matrix before multiplication
+     *
+     * @param enable If set to \c true, the first input matrix is transposed
+     *
+     * @return Reference to builder object
+     */
+    D & transposeA(bool enable=true) {
+        transposeA_ = enable;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Transpose the second input matrix before multiplication
+     *
+     * @param enable If set to \c true, the second input matrix is transposed
+     *
+     * @return Reference to builder object
+     */
+    D & transposeB(bool enable=true) {
+        transposeB_ = enable;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Set number of independent matrix products (for example attention heads)
+     *
+     * @param num Number of batches, the channels of all tensors are split evenly over the batches
+     *
+     * @return Reference to builder object
+     */
+    D & batches(int num) {
+        batches_ = num;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Set a constant factor that is applied to the product
+     *
+     * @param scale Scale factor, for example \f$ 1/\sqrt{d} \f$ for attention logits
+     *
+     * @return Reference to builder object
+     */
+    D & alpha(float scale) {
+        alpha_ = scale;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Accumulate the dot-products and store the result in 32-bit floating-point precision
+     *
+     * @param enable If set to \c true, accumulation and output use single precision, regardless
+     *               of the precision of the layer
+     *
+     * @return Reference to builder object
+     *
+     * Long dot-products (for example over a long sequence) may exceed the range or precision of
+     * 16-bit floating-point data, this option forces single precision for those.
+     */
+    D & fp32Accumulation(bool enable=true) {
+        fp32Accumulation_ = enable;
+        return *(D *)this;
+    }
+
+    short secondShape_[3] = {0, 0, 0};      //!< Width, height and channels of the second input tensor
+    bool transposeA_ = false;               //!< Indicator that the first matrix is transposed
+    bool transposeB_ = false;               //!< Indicator that the second matrix is transposed
+    int batches_ = 1;                       //!< Number of independent matrix products
+    float alpha_ = 1.0f;                    //!< Scale factor for the product
+    bool fp32Accumulation_ = false;         //!< Indicator that accumulation and output use single precision
+};
+
+
+/**
+ * @brief Builder object for GPU-based (batched) matrix-multiplication layers
+ *
+ * This builder parameterizes a matrix multiplication of two tensors that are both computed at
+ * runtime, as opposed to the GEMM layer which multiplies with constant weights. Each tensor is
+ * interpreted as a matrix with one row per spatial position (in row-major order) and one column
+ * per channel. For multiple batches, the channels are split into as many consecutive groups of
+ * equal size and each group forms one matrix. For example, a query tensor of size \f$ L \times 1 \f$
+ * with \f$ h \cdot d \f$ channels represents \e h matrices with \e L rows and \e d columns.
+ *
+ * The layer computes \f$ \alpha \cdot op(A) \cdot op(B) \f$ for each batch, where \e op is
+ * either the identity or the transposition. The result is stored with one spatial position per
+ * row of the result and the columns of all batches as channels. Its spatial size is the one of
+ * the first input, unless the first input is transposed, in which case the result is a single
+ * row.
+ *
+ * @see deep::DeepMatMulLayer
+ */
+struct MatMulLayerBuilder : MatMulLayerBuilderTempl<MatMulLayerBuilder> {
+
+    /**
+     * @brief Constructor
+     *
+     * @param name Name to be assigned to the built layer
+     */
+    MatMulLayerBuilder(const std::string& name) : MatMulLayerBuilderTempl<MatMulLayerBuilder>(name) {
+    }
+};
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -64,15 +64,15 @@ programptr MaxPoolLayer::compileShader(const char *preproc) {
  */
 void MaxPoolLayer::renderChannelBatch(int outPass,int numRenderTargets,int texOffset) {
     for (int tex=0;tex<numRenderTargets;tex++) {
-        glActiveTexture(GL_TEXTURE0+tex);
-        glBindTexture(GL_TEXTURE_2D,inputTextures_.at(tex+texOffset));
+        GLState::activeTexture(GL_TEXTURE0+tex);
+        GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(tex+texOffset));
     }
     if (currentShader_ != shaders_[numRenderTargets-1].get()) {
         if (currentShader_) currentShader_->unbind(true);
         currentShader_ = shaders_[numRenderTargets-1].get();
         currentShader_->bind(shaderStates_[numRenderTargets-1].get());
     }
-    glDrawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
+    GLState::drawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
 }
 
 
@@ -80,13 +80,13 @@ void MaxPoolLayer::renderChannelBatch(int outPass,int numRenderTargets,int texOf
  * @copydoc PoolingLayer::beforeRender
  */
 void MaxPoolLayer::beforeRender() {
-    glBlendEquation(GL_MAX);
-    glBlendFunc(GL_ONE,GL_ONE);
-#ifndef HIGH_PRECISION
-    glClearColor(-65504.f, -65504.f, -65504.f, -65504.f);
-#else
-    glClearColor(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
-#endif
+    GLState::blendEquation(GL_MAX);
+    GLState::blendFunc(GL_ONE,GL_ONE);
+    if (!highPrecision_) {
+        GLState::clearColor(-65504.f, -65504.f, -65504.f, -65504.f);
+    } else {
+        GLState::clearColor(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
+    }
 }
 
 
@@ -94,7 +94,7 @@ void MaxPoolLayer::beforeRender() {
  * @copydoc PoolingLayer::afterRender
  */
 void MaxPoolLayer::afterRender() {
-    glBlendEquation(GL_FUNC_ADD);
+    GLState::blendEquation(GL_FUNC_ADD);
 }
 
 
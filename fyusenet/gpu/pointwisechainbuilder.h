@@ -0,0 +1,255 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Pointwise-Chain Layer Builder (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <string>
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gpulayerbuilder.h"
+#include "../common/fynexception.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+
+/**
+ * @brief Templatized anchor for GPU-based pointwise-chain layer builders
+ *
+ * @see PointwiseChainBuilder
+ */
+template<typename D = GPULayerBuilderTempl<>>
+struct PointwiseChainBuilderTempl : GPULayerBuilderTempl<D> {
+
+    /**
+     * @brief Enumerator for the (optional) pooling operation at the start of the chain
+     */
+    enum poolop : uint8_t {
+        POOL_NONE = 0,          //!< No pooling, the input is sampled (and possibly scaled) directly
+        POOL_AVG,               //!< Average pooling (box filtering)
+        POOL_MAX                //!< Max-pooling
+    };
+
+    /**
+     * @brief Enumerator for the elementwise operations that can be chained
+     */
+    enum stageop : uint8_t {
+        STAGE_RELU = 0,         //!< (Leaky) ReLU
+        STAGE_CLIP,             //!< Clipping to an interval
+        STAGE_SIGMOID,          //!< Sigmoid function
+        STAGE_TANH,             //!< Hyperbolic tangent
+        STAGE_ARITH,            //!< Singleton arithmetic (see ArithType)
+        STAGE_CAST              //!< Type-cast emulation (see CastTarget)
+    };
+
+    /**
+     * @brief Single elementwise operation in the chain
+     */
+    struct Stage {
+        stageop op;                             //!< Operation to perform
+        ArithType arith = ArithType::ADD;       //!< Arithmetic operation for #STAGE_ARITH
+        CastTarget cast = CastTarget::CT_FLOAT32; //!< Target type for #STAGE_CAST
+        float operands[2] = {0.0f, 0.0f};       //!< Operands (leak, clip bounds or arithmetic operand)
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param name Name to be assigned to the built layer
+     */
+    PointwiseChainBuilderTempl(const std::string& name) : GPULayerBuilderTempl<D>(name) {
+        LayerBuilderTempl<D>::type_ = LayerType::POINTWISE_CHAIN;
+    }
+
+    /**
+     * @brief Copy constructor
+     *
+     * @param src Object to copy from
+     */
+    PointwiseChainBuilderTempl(const PointwiseChainBuilderTempl<D>& src) : GPULayerBuilderTempl<D>(src),
+        pooling_(src.pooling_), stages_(src.stages_) {
+        poolsize_[0] = src.poolsize_[0];
+        poolsize_[1] = src.poolsize_[1];
+    }
+
+    /**
+     * @brief Start the chain with a max-pooling operation
+     *
+     * @param winx Pool size along x-dimension
+     * @param winy Pool size along y-dimension
+     *
+     * @return Reference to builder object
+     *
+     * @note As with the PoolLayerBuilder, the pool size does not control the downsampling factor,
+     *       see downsample() for that.
+     */
+    D & maxPool(short winx, short winy) {
+        pooling_ = POOL_MAX;
+        poolsize_[0] = winx;
+        poolsize_[1] = winy;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Start the chain with an average-pooling operation
+     *
+     * @param winx Pool size along x-dimension
+     * @param winy Pool size along y-dimension
+     *
+     * @return Reference to builder object
+     *
+     * @note As with the PoolLayerBuilder, the pool size does not control the downsampling factor,
+     *       see downsample() for that. The pooling window is placed exactly as for the standalone
+     *       deep::DeepAvgPoolLayer.
+     */
+    D & avgPool(short winx, short winy) {
+        pooling_ = POOL_AVG;
+        poolsize_[0] = winx;
+        poolsize_[1] = winy;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Append a (leaky) ReLU operation to the chain
+     *
+     * @param leak Leak factor for negative values, use 0 for a standard ReLU
+     *
+     * @return Reference to builder object
+     */
+    D & addReLU(float leak = 0.0f) {
+        Stage st;
+        st.op = STAGE_RELU;
+        st.operands[0] = leak;
+        stages_.push_back(st);
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Append a clipping operation to the chain
+     *
+     * @param low Lower bound of the clipping interval
+     * @param high Upper bound of the clipping interval
+     *
+     * @return Reference to builder object
+     */
+    D & addClip(float low, float high) {
+        Stage st;
+        st.op = STAGE_CLIP;
+        st.operands[0] = low;
+        st.operands[1] = high;
+        stages_.push_back(st);
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Append a sigmoid operation to the chain
+     *
+     * @return Reference to builder object
+     */
+    D & addSigmoid() {
+        Stage st;
+        st.op = STAGE_SIGMOID;
+        stages_.push_back(st);
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Append a hyperbolic tangent operation to the chain
+     *
+     * @return Reference to builder object
+     */
+    D & addTanh() {
+        Stage st;
+        st.op = STAGE_TANH;
+        stages_.push_back(st);
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Append a singleton arithmetic operation to the chain
+     *
+     * @param type Arithmetic operation to perform
+     * @param operand Operand for the operation
+     *
+     * @return Reference to builder object
+     *
+     * @see SingletonArithLayerBuilder
+     */
+    D & addArith(ArithType type, float operand) {
+        Stage st;
+        st.op = STAGE_ARITH;
+        st.arith = type;
+        st.operands[0] = operand;
+        stages_.push_back(st);
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Append a type-cast emulation to the chain
+     *
+     * @param target Target datatype to cast the tensor data to
+     *
+     * @return Reference to builder object
+     *
+     * @see CastLayerBuilder
+     */
+    D & addCast(CastTarget target) {
+        Stage st;
+        st.op = STAGE_CAST;
+        st.cast = target;
+        stages_.push_back(st);
+        return *(D *)this;
+    }
+
+    poolop pooling_ = POOL_NONE;        //!< Pooling operation at the start of the chain
+    short poolsize_[2] = {1,1};         //!< Pooling size along x- and y-dimension
+    std::vector<Stage> stages_;         //!< Elementwise operations, in order of execution
+};
+
+
+/**
+ * @brief Builder class for GPU-based pointwise-chain layers
+ *
+ * This builder describes a sequence of simple layers that would otherwise each be executed as a
+ * separate render pass with its own intermediate texture. The sequence consists of an optional
+ * spatial operation followed by an arbitrary number of elementwise operations, for example:
+ *
+ * @code
+ * PointwiseChainBuilder bld("chain");
+ * bld.shape(64, 128, 128, 64).deep().context(ctx);
+ * bld.maxPool(2, 2).downsample(2).addSigmoid().addArith(ArithType::MUL, 2.0f);
+ * @endcode
+ *
+ * The spatial operation is either a max-/average-pooling (see maxPool() and avgPool()) or a
+ * nearest-neighbor scaling, which is controlled by upsample() and downsample() in case no pooling
+ * was selected. A prefix activation (see prefixAct()) is applied to the input data before the
+ * spatial operation, like on all other layers.
+ *
+ * The built layer generates a single fragment shader for the whole sequence at setup time and
+ * computes the result in one draw call.
+ *
+ * @see deep::DeepPointwiseChainLayer
+ */
+struct PointwiseChainBuilder : PointwiseChainBuilderTempl<PointwiseChainBuilder> {
+    PointwiseChainBuilder(const std::string& name) : PointwiseChainBuilderTempl<PointwiseChainBuilder>(name) {}
+    using PointwiseChainBuilderTempl<PointwiseChainBuilder>::PointwiseChainBuilderTempl;
+};
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -140,12 +140,12 @@ void PoolingLayer::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_BLEND);
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glViewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    GLState::clearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
     int totaltex = (inputChannels_ / PIXEL_PACKING) + (((inputChannels_ % PIXEL_PACKING) > 0) ? 1 : 0);
     int outputpasses = (totaltex / maxRenderTargets_) + (((totaltex % maxRenderTargets_) > 0) ? 1 : 0);
     int texoffset = 0;
@@ -162,12 +162,12 @@ void PoolingLayer::forward(uint64_t sequence) {
         framebuffers_.at(opass)->bind();
         framebuffers_.at(opass)->setWriteMask();
         if (totaltex >= maxRenderTargets_) {
-            glClear(GL_COLOR_BUFFER_BIT);
+            GLState::clear(GL_COLOR_BUFFER_BIT);
             renderChannelBatch(opass, maxRenderTargets_, texoffset);
             texoffset += maxRenderTargets_;
             totaltex -= maxRenderTargets_;
         } else if (totaltex > 0) {
-            glClear(GL_COLOR_BUFFER_BIT);
+            GLState::clear(GL_COLOR_BUFFER_BIT);
             renderChannelBatch(opass, totaltex, texoffset);
             texoffset += totaltex;
             totaltex = 0;
@@ -51,6 +51,12 @@ struct ScaleLayerBuilderTempl : GPULayerBuilderTempl<D> {
      * @param src Source builder to copy data from
      */
     ScaleLayerBuilderTempl(const ScaleLayerBuilderTempl<D>& src) : GPULayerBuilderTempl<D>(src),scaleType_(ScalingType::NEAREST) {
+        scale_[0] = src.scale_[0];
+        scale_[1] = src.scale_[1];
+        size_[0] = src.size_[0];
+        size_[1] = src.size_[1];
+        alignCorners_ = src.alignCorners_;
+        fractional_ = src.fractional_;
     }
 
     /**
@@ -101,37 +107,99 @@ struct ScaleLayerBuilderTempl : GPULayerBuilderTempl<D> {
      * @param scaleY Scaling factor along y-dimension
      *
      * @return Reference to builder object
+     *
+     * Integer up- and downscaling factors are supported by all scaling layers. Non-integer
+     * factors are only supported for deep tensors, in which case the size of the output is
+     * the (rounded-down) product of the input size and the scale factor.
+     *
+     * @see size(), alignCorners()
      */
     D & scale(float scaleX, float scaleY) {
-        if (scaleX > 1.0f) {
-            LayerBuilderTempl<D>::upsample_[0] = (int)scaleX;
-            if (fabs(LayerBuilderTempl<D>::upsample_[0] - scaleX) > 1e-4) {
-                THROW_EXCEPTION_ARGS(FynException,"Only supporting integer upscales for now");
-            }
-        }
-        if (scaleY > 1.0f) {
-            LayerBuilderTempl<D>::upsample_[1]=(int)scaleY;
-            if (fabs(LayerBuilderTempl<D>::upsample_[1] - scaleY) > 1e-4) {
-                THROW_EXCEPTION_ARGS(FynException,"Only supporting integer upscales for now");
-            }
+        if ((scaleX <= 0.0f) || (scaleY <= 0.0f)) {
+            THROW_EXCEPTION_ARGS(FynException,"Illegal scale factors %f,%f", scaleX, scaleY);
         }
-        if (scaleX < 1.0f) {
-            float dn = 1.0f/scaleX;
-            LayerBuilderTempl<D>::downsample_[0]=(int)dn;
-            if (fabs(LayerBuilderTempl<D>::downsample_[0] - dn) > 1e-4) {
-                THROW_EXCEPTION_ARGS(FynException,"Only supporting integer downscales for now");
-            }
-        }
-        if (scaleY < 1.0f) {
-            float dn = 1.0f/scaleY;
-            LayerBuilderTempl<D>::downsample_[0]=(int)dn;
-            if (fabs(LayerBuilderTempl<D>::downsample_[1] - dn) > 1e-4) {
-                THROW_EXCEPTION_ARGS(FynException,"Only supporting integer upscales for now");
-            }
+        scale_[0] = scaleX;
+        scale_[1] = scaleY;
+        if (scaleX > 1.0f) LayerBuilderTempl<D>::upsample_[0] = (short)scaleX;
+        if (scaleY > 1.0f) LayerBuilderTempl<D>::upsample_[1] = (short)scaleY;
+        if (scaleX < 1.0f) LayerBuilderTempl<D>::downsample_[0] = (short)(1.0f/scaleX + 1e-4f);
+        if (scaleY < 1.0f) LayerBuilderTempl<D>::downsample_[1] = (short)(1.0f/scaleY + 1e-4f);
+        fractional_ = false;
+        for (int i=0; i < 2; i++) {
+            float factor = (float)LayerBuilderTempl<D>::upsample_[i] / (float)LayerBuilderTempl<D>::downsample_[i];
+            if (fabs(factor - scale_[i]) > 1e-4f) fractional_ = true;
         }
         return *(D *)this;
     }
 
+    /**
+     * @brief Set explicit output size for arbitrary resizing
+     *
+     * @param width Width of the output tensor (without padding)
+     *
+     * @param height Height of the output tensor (without padding)
+     *
+     * @return Reference to builder object
+     *
+     * Instead of a scale factor, this sets the spatial size of the output tensor directly, the
+     * scale factors are then implied by the ratio of output and input sizes. This is only
+     * supported for deep tensors.
+     */
+    D & size(int width, int height) {
+        if ((width <= 0) || (height <= 0)) THROW_EXCEPTION_ARGS(FynException,"Illegal output size %dx%d", width, height);
+        size_[0] = (short)width;
+        size_[1] = (short)height;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Align the corner pixels of input and output when resizing
+     *
+     * @param align If \c true, the centers of the corner pixels of input and output are aligned,
+     *              otherwise the (default) half-pixel mapping is used
+     *
+     * @return Reference to builder object
+     *
+     * This corresponds to the \c align_corners option of the interpolation functions in
+     * PyTorch and TensorFlow. Only supported for deep tensors.
+     */
+    D & alignCorners(bool align=true) {
+        alignCorners_ = align;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Check if the configured scaling requires arbitrary resampling
+     *
+     * @retval true Scaling uses non-integer factors, an explicit output size or aligned corners
+     * @retval false Scaling is by integer factors only
+     */
+    bool isResize() const {
+        return (size_[0] > 0) || (alignCorners_) || (fractional_);
+    }
+
+    /**
+     * @brief Get output width after resizing
+     *
+     * @return Width of the output tensor (without padding)
+     */
+    int resizedWidth() const {
+        if (size_[0] > 0) return size_[0];
+        if (fractional_) return (int)((float)LayerBuilderTempl<D>::width() * scale_[0] + 1e-4f);
+        return (LayerBuilderTempl<D>::width() * LayerBuilderTempl<D>::upsample_[0]) / LayerBuilderTempl<D>::downsample_[0];
+    }
+
+    /**
+     * @brief Get output height after resizing
+     *
+     * @return Height of the output tensor (without padding)
+     */
+    int resizedHeight() const {
+        if (size_[1] > 0) return size_[1];
+        if (fractional_) return (int)((float)LayerBuilderTempl<D>::height() * scale_[1] + 1e-4f);
+        return (LayerBuilderTempl<D>::height() * LayerBuilderTempl<D>::upsample_[1]) / LayerBuilderTempl<D>::downsample_[1];
+    }
+
     /**
      * @brief Check if scaling is isotropic
      *
@@ -144,6 +212,10 @@ struct ScaleLayerBuilderTempl : GPULayerBuilderTempl<D> {
 
     int rotation_ = 0;                              //!< Rotation angle (in degrees)
     ScalingType scaleType_ = ScalingType::NEAREST;  //!< Scaling interpolation mode (default is \c NEAREST)
+    float scale_[2] = {1.0f, 1.0f};                 //!< Scale factors along x- and y-axis as supplied to scale()
+    short size_[2] = {0, 0};                        //!< Explicit output size (if non-zero), see size()
+    bool alignCorners_ = false;                     //!< Indicator that corner pixels are aligned when resizing, see alignCorners()
+    bool fractional_ = false;                       //!< Indicator that non-integer scale factors were supplied to scale()
 };
 
 
@@ -158,6 +230,11 @@ struct ScaleLayerBuilderTempl : GPULayerBuilderTempl<D> {
  *
  * Scaling layers can also be used to pad/unpad data or to apply an activation function explicitly,
  * just set the appropriate activation/padding and leave the scale at 1.
+ *
+ * For deep tensors, arbitrary (non-integer) scale factors, explicit output sizes and aligned
+ * corners are supported as well, see deep::DeepResizeLayer. As an alternative to a separate
+ * layer, a resize that is directly followed by a deep convolution can also be folded into
+ * the convolution, see ConvLayerBuilderTempl::resizeInput().
  */
 struct ScaleLayerBuilder : ScaleLayerBuilderTempl<ScaleLayerBuilder> {
 
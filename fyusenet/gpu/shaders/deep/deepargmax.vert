@@ -5,16 +5,13 @@
  * ------------------------------------------------------------------------- */
 
 in highp vec4 attributes0;
-in highp ivec4 attributes1;
-in lowp ivec4 attributes2;
+in highp ivec2 attributes1;
 
 out highp vec2 texCoord;
-flat out highp ivec4 channelOffset;
-flat out lowp ivec4 mask; // mask to enable/disable channels in a 4-channel pixel
+flat out highp ivec2 tileRange;   // first tile and number of tiles to process
 
 void main(void) {
   gl_Position = vec4(attributes0.x, attributes0.y, 0.0, 1.0);
-  channelOffset = attributes1;
+  tileRange = attributes1;
   texCoord = vec2(attributes0.z,attributes0.w);
-  mask = attributes2;
 }
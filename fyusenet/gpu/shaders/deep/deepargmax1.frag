@@ -14,8 +14,7 @@ uniform highp float alpha1;
 uniform highp float alpha2;
 uniform highp float alpha3;
 
-flat in highp ivec4 channelOffset;
-flat in lowp ivec4 mask;      // mask to enable/disable channels in a 4-channel pixel
+flat in highp ivec2 tileRange;   // first tile and number of tiles to process
 
 #include "shaders/activation.inc"
 
@@ -25,14 +24,19 @@ uniform highp ivec4 bitmask;
 
 
 void main(void) {
-  highp vec4 pix = activate(texture(inputLayer0,texCoord));
-  fragmentColor0.z = pix.x;
-  pix = mix(maskout, pix, equal(mask, ivec4(1)));
-  highp ivec4 ipix = floatBitsToInt(pix);
-  highp ivec4 masked = ipix & bitmask;
-  highp vec4 completed = intBitsToFloat(masked | (channelOffset << PLACEMENT_BITS));
-  highp vec2 mb = max(completed.xy, completed.zw);
-  highp vec2 ma = max(pix.xy, pix.zw);
-  fragmentColor0.xy = vec2(max(ma.x, ma.y), max(mb.x, mb.y));
-  fragmentColor0.w = pix.x;
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp vec2 result = vec2(FLT_MIN);
+  for (int tile=tileRange.x; tile < tileRange.x + tileRange.y; tile++) {
+    highp ivec2 inorg = ivec2(IN_PAD) + ivec2(tile % IN_TILES_X, tile / IN_TILES_X) * ivec2(IN_WIDTH+IN_PAD, IN_HEIGHT+IN_PAD);
+    highp ivec4 channel = ivec4(tile*4) + ivec4(0, 1, 2, 3);
+    highp vec4 pix = activate(texelFetch(inputLayer0, inorg + pos, 0));
+    pix = mix(maskout, pix, lessThan(channel, ivec4(IN_CHANNELS)));
+    highp ivec4 ipix = floatBitsToInt(pix);
+    highp ivec4 masked = ipix & bitmask;
+    highp vec4 completed = intBitsToFloat(masked | (channel << PLACEMENT_BITS));
+    highp vec2 mb = max(completed.xy, completed.zw);
+    highp vec2 ma = max(pix.xy, pix.zw);
+    result = max(result, vec2(max(ma.x, ma.y), max(mb.x, mb.y)));
+  }
+  fragmentColor0 = vec4(result, 0.0, 0.0);
 }
@@ -43,34 +43,36 @@ vec4 fetch(in sampler2D inTex,in vec2 tc) {
 }
 
 void main(void) {
+  vec4 result = vec4(0.0);
   if (numTextures == 1) {
-    if (texShift.x == 0) fragmentColor = fetch(inputLayer0,texCoord0.xy);
+    if (texShift.x == 0) result = fetch(inputLayer0,texCoord0.xy);
     else {
       vec4 pixel = fetch(inputLayer0, texCoord0.xy);
-      for (int i=0; i < texComponents.x;i++) fragmentColor[i] = pixel[i+texShift.x];
+      for (int i=0; i < texComponents.x;i++) result[i] = pixel[i+texShift.x];
     }
   } else if (numTextures == 2) {
     int fi = 0;
     vec4 pixel = fetch(inputLayer0, texCoord0.xy);
-    for (int i=0; i < texComponents.x;i++) fragmentColor[fi++] = pixel[i+texShift.x];
+    for (int i=0; i < texComponents.x;i++) result[fi++] = pixel[i+texShift.x];
     pixel = fetch(inputLayer1, texCoord0.zw);
-    for (int i=0; i < texComponents.y;i++) fragmentColor[fi++] = pixel[i+texShift.y];
+    for (int i=0; i < texComponents.y;i++) result[fi++] = pixel[i+texShift.y];
   } else if (numTextures == 3) {
     int fi = 0;
     vec4 pixel = fetch(inputLayer0,texCoord0.xy);
-    for (int i=0; i < texComponents.x;i++) fragmentColor[fi++] = pixel[i+texShift.x];
+    for (int i=0; i < texComponents.x;i++) result[fi++] = pixel[i+texShift.x];
     pixel = fetch(inputLayer1, texCoord0.zw);
-    for (int i=0; i < texComponents.y;i++) fragmentColor[fi++] = pixel[i+texShift.y];
+    for (int i=0; i < texComponents.y;i++) result[fi++] = pixel[i+texShift.y];
     pixel = fetch(inputLayer2, texCoord1.xy);
-    for (int i=0; i < texComponents.z;i++) fragmentColor[fi++] = pixel[i+texShift.z];
+    for (int i=0; i < texComponents.z;i++) result[fi++] = pixel[i+texShift.z];
   } else if (numTextures == 4) {
     vec4 pixel = fetch(inputLayer0,texCoord0.xy);
-    fragmentColor.r = pixel[texShift.x];
+    result.r = pixel[texShift.x];
     pixel = fetch(inputLayer1, texCoord0.zw);
-    fragmentColor.g = pixel.r;
+    result.g = pixel.r;
     pixel = fetch(inputLayer2, texCoord1.xy);
-    fragmentColor.b = pixel.r;
+    result.b = pixel.r;
     pixel = fetch(inputLayer3, texCoord1.zw);
-    fragmentColor.a = pixel.r;
+    result.a = pixel.r;
   }
+  fragmentColor = result;
 }
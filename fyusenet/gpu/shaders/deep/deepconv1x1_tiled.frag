@@ -5,10 +5,14 @@
  * ------------------------------------------------------------------------- */
 
 #include "shaders/deep/convheader.inc"
+#include "shaders/deep/resample.inc"
 
 #ifdef NO_HALF
 // requires 6 varyings in total (w/ residual)
 flat in vec4 layer0coeffs[4];
+#elif defined(INT8_WEIGHTS)
+// requires 3 varyings in total (w/ residual)
+flat in highp uvec4 layer0coeffs[1];
 #else
 // requires 4 varyings in total (w/ residual)
 flat in highp uvec4 layer0coeffs[2];
@@ -21,7 +25,7 @@ flat in highp uvec4 layer0coeffs[2];
 
 void main(void) {
   vec2 tc = texCoord.xy;
-  fragmentColor0 =  compute(texture(inputLayer0,tc),0);  
+  fragmentColor0 =  compute(fetchInput(tc),0);  
 #if !defined(NO_BIAS) || defined(POST_BATCHNORM)
 #ifdef POST_BATCHNORM
   fragmentColor0 = applyBN(fragmentColor0, biasTexture, ivec4(texCoord.zw,0,1));
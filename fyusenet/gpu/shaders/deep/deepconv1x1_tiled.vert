@@ -32,6 +32,9 @@ out highp vec4 texCoord;
 #ifdef NO_HALF
 // requires 6 varyings in total (w/ residual)
 flat out vec4 layer0coeffs[4];
+#elif defined(INT8_WEIGHTS)
+// requires 3 varyings in total (w/ residual)
+flat out highp uvec4 layer0coeffs[1];
 #else
 // requires 4 varyings in total (w/ residual)
 flat out highp uvec4 layer0coeffs[2];
@@ -55,13 +58,15 @@ void main(void) {
   texCoord.xy += texelFetch(inputDisplacements,ivec2(intile,0),0).rg;
 #ifdef NO_HALF
   intile *= 4;
-#else
+#elif !defined(INT8_WEIGHTS)
   intile *= 2;
 #endif
   int ybase = attributes1.x;
   // fetch weights
   layer0coeffs[0] = texelFetch(inputCoeffs,ivec2(intile,ybase),0);
+#ifndef INT8_WEIGHTS
   layer0coeffs[1] = texelFetch(inputCoeffs,ivec2(intile+1,ybase),0);
+#endif
 #ifdef NO_HALF
   layer0coeffs[2] = texelFetch(inputCoeffs,ivec2(intile+2,ybase),0);
   layer0coeffs[3] = texelFetch(inputCoeffs,ivec2(intile+3,ybase),0);
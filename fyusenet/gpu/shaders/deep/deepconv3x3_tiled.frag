@@ -5,10 +5,14 @@
  * ------------------------------------------------------------------------- */
 
 #include "shaders/deep/convheader.inc"
+#include "shaders/deep/resample.inc"
 
 #ifdef NO_HALF
 // requires 14 varyings in total (w/ residual)
 flat in vec4 layer0coeffs[12];
+#elif defined(INT8_WEIGHTS)
+// requires 5 varyings in total (w/ residual)
+flat in highp uvec4 layer0coeffs[3];
 #else
 // requires 8 varyings in total (w/ residual)
 flat in highp uvec4 layer0coeffs[6];
@@ -25,13 +29,13 @@ uniform highp float dilationStep;
 
 void main(void) {
 #ifdef LARGE_DILATION
-    fragmentColor0 =  compute(texture(inputLayer0,texCoord.xy - vec2(dilationStep,0)),0);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy),2);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy + vec2(dilationStep,0)),4);
+    fragmentColor0 =  compute(fetchInput(texCoord.xy - vec2(dilationStep,0)),0);
+    fragmentColor0 += compute(fetchInput(texCoord.xy),2);
+    fragmentColor0 += compute(fetchInput(texCoord.xy + vec2(dilationStep,0)),4);
 #else
-    fragmentColor0 =  compute(textureOffset(inputLayer0,texCoord.xy, ivec2(-DILATION,0)),0);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy, ivec2( 0,0)),2);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy, ivec2( DILATION,0)),4);
+    fragmentColor0 =  compute(fetchInputOffset(texCoord.xy, ivec2(-DILATION_X,0)),0);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy, ivec2( 0,0)),2);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy, ivec2( DILATION_X,0)),4);
 #endif
 #if !defined(NO_BIAS) || defined(POST_BATCHNORM)
 #ifdef POST_BATCHNORM
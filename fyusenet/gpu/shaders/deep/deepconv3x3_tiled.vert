@@ -32,6 +32,9 @@ out highp vec4 texCoord;
 #ifdef NO_HALF
 // requires 14 varyings in total (w/ residual)
 flat out mediump vec4 layer0coeffs[12];
+#elif defined(INT8_WEIGHTS)
+// requires 5 varyings in total (w/ residual)
+flat out highp uvec4 layer0coeffs[3];
 #else
 // requires 8 varyings in total (w/ residual)
 flat out highp uvec4 layer0coeffs[6];
@@ -56,6 +59,8 @@ void main(void) {
   texCoord.xy += texelFetch(inputDisplacements,ivec2(intile,windowindex),0).rg;
 #ifdef NO_HALF
   intile *= 4*KERNEL;
+#elif defined(INT8_WEIGHTS)
+  intile *= KERNEL;
 #else
   intile *= 2*KERNEL;
 #endif
@@ -65,6 +70,10 @@ void main(void) {
   for (int i=0; i < 12;i++) {
     layer0coeffs[i] = texelFetch(inputCoeffs,ivec2(intile+i,ybase),0);
   }
+#elif defined(INT8_WEIGHTS)
+  for (int i=0; i < 3; i++) {
+    layer0coeffs[i] = texelFetch(inputCoeffs,ivec2(intile+i,ybase),0);
+  }
 #else
   layer0coeffs[0] = texelFetch(inputCoeffs,ivec2(intile,ybase),0);
   layer0coeffs[1] = texelFetch(inputCoeffs,ivec2(intile+1,ybase),0);
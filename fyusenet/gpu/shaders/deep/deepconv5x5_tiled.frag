@@ -5,10 +5,14 @@
  * ------------------------------------------------------------------------- */
 
 #include "shaders/deep/convheader.inc"
+#include "shaders/deep/resample.inc"
 
 #ifdef NO_HALF
 // requires 22 varyings in total (w/ residual)
 flat in vec4 layer0coeffs[20];
+#elif defined(INT8_WEIGHTS)
+// requires 7 varyings in total (w/ residual)
+flat in highp uvec4 layer0coeffs[5];
 #else
 // requires 12 varyings in total (w/ residual)
 flat in highp uvec4 layer0coeffs[10];
@@ -25,17 +29,17 @@ uniform highp float dilationStep;
 
 void main(void) {
 #ifdef LARGE_DILATION
-    fragmentColor0 =  compute(texture(inputLayer0,texCoord.xy-vec2(2*dilationStep,0)),0);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy-vec2(dilationStep,0)),2);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy),4);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(dilationStep,0)),6);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(2*dilationStep,0)),8);
+    fragmentColor0 =  compute(fetchInput(texCoord.xy-vec2(2*dilationStep,0)),0);
+    fragmentColor0 += compute(fetchInput(texCoord.xy-vec2(dilationStep,0)),2);
+    fragmentColor0 += compute(fetchInput(texCoord.xy),4);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(dilationStep,0)),6);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(2*dilationStep,0)),8);
 #else
-    fragmentColor0 =  compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-2*DILATION,0)),0);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION,0)),2);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2( 0,0)),4);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION,0)),6);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(2*DILATION,0)),8);
+    fragmentColor0 =  compute(fetchInputOffset(texCoord.xy,ivec2(-2*DILATION_X,0)),0);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(-DILATION_X,0)),2);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2( 0,0)),4);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2( DILATION_X,0)),6);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(2*DILATION_X,0)),8);
 #endif
 #if !defined(NO_BIAS) || defined(POST_BATCHNORM)
 #ifdef POST_BATCHNORM
@@ -31,6 +31,9 @@ in highp vec2 attributes2;
 out highp vec4 texCoord;
 #ifdef NO_HALF
 flat out mediump vec4 layer0coeffs[20];
+#elif defined(INT8_WEIGHTS)
+// requires 7 varyings in total (w/ residual)
+flat out highp uvec4 layer0coeffs[5];
 #else
 // requires 8 varyings in total (w/ residual)
 flat out highp uvec4 layer0coeffs[10];
@@ -55,6 +58,8 @@ void main(void) {
   texCoord.xy += texelFetch(inputDisplacements,ivec2(intile,windowindex),0).rg;
 #ifdef NO_HALF
   intile *= 4 * KERNEL;
+#elif defined(INT8_WEIGHTS)
+  intile *= KERNEL;
 #else
   intile *= 2 * KERNEL;
 #endif
@@ -64,6 +69,10 @@ void main(void) {
   for (int i=0; i < 20;i++) {
     layer0coeffs[i] = texelFetch(inputCoeffs,ivec2(intile+i,ybase),0);
   }
+#elif defined(INT8_WEIGHTS)
+  for (int i=0; i < 5; i++) {
+    layer0coeffs[i] = texelFetch(inputCoeffs,ivec2(intile+i,ybase),0);
+  }
 #else
   for (int i=0; i < 10;i++) {
     layer0coeffs[i] = texelFetch(inputCoeffs,ivec2(intile+i,ybase),0);
@@ -5,10 +5,14 @@
  * ------------------------------------------------------------------------- */
 
 #include "shaders/deep/convheader.inc"
+#include "shaders/deep/resample.inc"
 
 #ifdef NO_HALF
 // requires 38 varyings in total (w/ residual)
 flat in vec4 layer0coeffs[36];
+#elif defined(INT8_WEIGHTS)
+// requires 11 varyings in total (w/ residual)
+flat in highp uvec4 layer0coeffs[9];
 #else
 // requires 20 varyings in total (w/ residual)
 flat in highp uvec4 layer0coeffs[18];
@@ -25,25 +29,25 @@ uniform highp float dilationStep;
 
 void main(void) {
 #ifdef LARGE_DILATION
-    fragmentColor0 =  compute(texture(inputLayer0,texCoord.xy-vec2(4*dilationStep,0)),0);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy-vec2(3*dilationStep,0)),2);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy-vec2(2*dilationStep,0)),4);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy-vec2(dilationStep,0)),6);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy),8);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(dilationStep,0)),10);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(2*dilationStep,0)),12);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(3*dilationStep,0)),14);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(4*dilationStep,0)),16);
+    fragmentColor0 =  compute(fetchInput(texCoord.xy-vec2(4*dilationStep,0)),0);
+    fragmentColor0 += compute(fetchInput(texCoord.xy-vec2(3*dilationStep,0)),2);
+    fragmentColor0 += compute(fetchInput(texCoord.xy-vec2(2*dilationStep,0)),4);
+    fragmentColor0 += compute(fetchInput(texCoord.xy-vec2(dilationStep,0)),6);
+    fragmentColor0 += compute(fetchInput(texCoord.xy),8);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(dilationStep,0)),10);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(2*dilationStep,0)),12);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(3*dilationStep,0)),14);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(4*dilationStep,0)),16);
 #else
-    fragmentColor0 =  compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-4*DILATION,0)),0);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-3*DILATION,0)),2);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-2*DILATION,0)),4);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION,0)),6);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2( 0,0)),8);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION,0)),10);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(2*DILATION,0)),12);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(3*DILATION,0)),14);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(4*DILATION,0)),16);
+    fragmentColor0 =  compute(fetchInputOffset(texCoord.xy,ivec2(-4*DILATION_X,0)),0);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(-3*DILATION_X,0)),2);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(-2*DILATION_X,0)),4);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(-DILATION_X,0)),6);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2( 0,0)),8);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2( DILATION_X,0)),10);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(2*DILATION_X,0)),12);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(3*DILATION_X,0)),14);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(4*DILATION_X,0)),16);
 #endif
 #if !defined(NO_BIAS) || defined(POST_BATCHNORM)
 #ifdef POST_BATCHNORM
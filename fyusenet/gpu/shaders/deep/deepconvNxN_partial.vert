@@ -58,6 +58,8 @@ void main(void) {
   texCoord.xy += texelFetch(inputDisplacements, ivec2(intile, numParts * vkernelidx + horizOffset),0).rg;
 #ifdef NO_HALF
   int inchan = 4 * intile * KERNEL + kernelOffset * 4;
+#elif defined(INT8_WEIGHTS)
+  int inchan = intile * KERNEL + kernelOffset;
 #else
   int inchan = 2 * intile * KERNEL + kernelOffset * 2;
 #endif
@@ -39,15 +39,15 @@ void main(void) {
 #else
     fragmentColor0 = compute(textureOffset(inputLayer0,texCoord.xy, ivec2(0,0)), OFFSET0);
 #if NET_KERNEL >= 6
-    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-3*DILATION,0)),OFFSET6a);
-    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2( 2*DILATION,0)),OFFSET4b);
+    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-3*DILATION_X,0)),OFFSET6a);
+    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2( 2*DILATION_X,0)),OFFSET4b);
 #endif
 #if NET_KERNEL >= 4
-    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-2*DILATION,0)),OFFSET4a);
-    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION,0)),OFFSET2b);
+    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-2*DILATION_X,0)),OFFSET4a);
+    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION_X,0)),OFFSET2b);
 #endif
 #if NET_KERNEL >= 2
-    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION,0)), OFFSET2a);
+    fragmentColor0 +=  compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION_X,0)), OFFSET2a);
 #endif
 #endif
 #if !defined(NO_BIAS) || defined(POST_BATCHNORM)
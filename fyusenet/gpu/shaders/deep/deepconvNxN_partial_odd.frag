@@ -6,6 +6,7 @@
  * ------------------------------------------------------------------------- */
 
 #include "shaders/deep/convheader.inc"
+#include "shaders/deep/resample.inc"
 
 #ifdef NO_HALF
 flat in vec4 layer0coeffs[COEFF_VARYINGS];
@@ -24,32 +25,32 @@ uniform highp float dilationStep;
 
 void main(void) {
 #ifdef LARGE_DILATION
-    fragmentColor0 =  compute(texture(inputLayer0,texCoord.xy),OFFSET0);
+    fragmentColor0 =  compute(fetchInput(texCoord.xy),OFFSET0);
 #if NET_KERNEL >= 7
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(-3*dilationStep,0)),OFFSET7a);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2( 3*dilationStep,0)),OFFSET7b);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(-3*dilationStep,0)),OFFSET7a);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2( 3*dilationStep,0)),OFFSET7b);
 #endif
 #if NET_KERNEL >= 5
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(-2*dilationStep,0)),OFFSET5a);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2( 2*dilationStep,0)),OFFSET5b);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(-2*dilationStep,0)),OFFSET5a);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2( 2*dilationStep,0)),OFFSET5b);
 #endif
 #if NET_KERNEL >= 3
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2(-dilationStep,0)), OFFSET3a);
-    fragmentColor0 += compute(texture(inputLayer0,texCoord.xy+vec2( dilationStep,0)), OFFSET3b);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2(-dilationStep,0)), OFFSET3a);
+    fragmentColor0 += compute(fetchInput(texCoord.xy+vec2( dilationStep,0)), OFFSET3b);
 #endif
 #else
-    fragmentColor0 = compute(textureOffset(inputLayer0,texCoord.xy, ivec2(0,0)), OFFSET0);
+    fragmentColor0 = compute(fetchInputOffset(texCoord.xy, ivec2(0,0)), OFFSET0);
 #if NET_KERNEL >= 7
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-3*DILATION,0)),OFFSET7a);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2( 3*DILATION,0)),OFFSET7b);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(-3*DILATION_X,0)),OFFSET7a);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2( 3*DILATION_X,0)),OFFSET7b);
 #endif
 #if NET_KERNEL >= 5
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-2*DILATION,0)),OFFSET5a);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2( 2*DILATION,0)),OFFSET5b);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(-2*DILATION_X,0)),OFFSET5a);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2( 2*DILATION_X,0)),OFFSET5b);
 #endif
 #if NET_KERNEL >= 3
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION,0)), OFFSET3a);
-    fragmentColor0 += compute(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION,0)), OFFSET3b);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2(-DILATION_X,0)), OFFSET3a);
+    fragmentColor0 += compute(fetchInputOffset(texCoord.xy,ivec2( DILATION_X,0)), OFFSET3b);
 #endif
 #endif
 #if !defined(NO_BIAS) || defined(POST_BATCHNORM)
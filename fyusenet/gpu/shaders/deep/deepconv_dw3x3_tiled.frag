@@ -34,17 +34,17 @@ vec4 compute(in vec4 tex00,in vec4 tex01,in vec4 tex02,in int offset) {
 #endif
 
 void main(void) {
-  vec4 t0 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION,-DILATION)));
-  vec4 t1 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(        0,-DILATION)));
-  vec4 t2 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION,-DILATION)));
+  vec4 t0 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION_X,-DILATION_Y)));
+  vec4 t1 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(        0,-DILATION_Y)));
+  vec4 t2 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION_X,-DILATION_Y)));
   fragmentColor0 = compute(t0,t1,t2,0);
-  t0 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION,0)));
+  t0 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION_X,0)));
   t1 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(        0,0)));
-  t2 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION,0)));
+  t2 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION_X,0)));
   fragmentColor0 += compute(t0,t1,t2,2);
-  t0 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION, DILATION)));
-  t1 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(        0, DILATION)));
-  t2 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION, DILATION)));
+  t0 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(-DILATION_X, DILATION_Y)));
+  t1 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2(        0, DILATION_Y)));
+  t2 = activate(textureOffset(inputLayer0,texCoord.xy,ivec2( DILATION_X, DILATION_Y)));
   fragmentColor0 += compute(t0,t1,t2,4);
 #if !defined(NO_BIAS) || defined(POST_BATCHNORM)
 #ifdef POST_BATCHNORM
@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * Depthwise NxN Conv Shader (Deep)        Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Computes one output pixel of a depthwise convolution for each fragment, the
+// kernel size is given by KERNEL. Taps that fall outside of the input tile are
+// skipped. Every texel of the output texture (including the padding) is written
+// by this shader.
+
+#include "shaders/deep/fragpreamble.inc"
+
+#ifdef BINDING_SUPPORT
+layout(binding=1) uniform sampler2D residualLayer0;
+layout(binding=BIAS_UNIT) uniform sampler2D biasTexture;
+#ifdef NO_HALF
+layout(binding=WEIGHT_UNIT) uniform highp sampler2D inputCoeffs;
+#else
+layout(binding=WEIGHT_UNIT) uniform highp usampler2D inputCoeffs;
+#endif
+#else
+uniform sampler2D residualLayer0;
+uniform sampler2D biasTexture;
+#ifdef NO_HALF
+uniform highp sampler2D inputCoeffs;
+#else
+uniform highp usampler2D inputCoeffs;
+#endif
+#endif
+
+#include "shaders/activation.inc"
+
+vec4 weight(in highp int tap, in highp int row) {
+#ifdef NO_HALF
+  return texelFetch(inputCoeffs, ivec2(tap, row), 0);
+#else
+  highp uvec4 w = texelFetch(inputCoeffs, ivec2(tap >> 1, row), 0);
+  highp uvec2 h = ((tap & 1) == 0) ? w.xy : w.zw;
+  return vec4(unpackHalf2x16(h.x), unpackHalf2x16(h.y));
+#endif
+}
+
+void main(void) {
+  highp ivec2 span = ivec2(OUT_WIDTH+OUT_PAD, OUT_HEIGHT+OUT_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= OUT_WIDTH) || (local.y >= OUT_HEIGHT)) return;
+  if ((grid.x >= OUT_TILES_X) || (tile >= OUT_TILES)) return;
+  highp int intile = tile % IN_TILES;
+  highp ivec2 inorg = ivec2(IN_PAD) + ivec2(intile % IN_TILES_X, intile / IN_TILES_X) * ivec2(IN_WIDTH+IN_PAD, IN_HEIGHT+IN_PAD);
+  highp ivec2 center = local * ivec2(STRIDE_X, STRIDE_Y) - ivec2(DILATION_X, DILATION_Y) * (KERNEL/2);
+  vec4 result = vec4(0);
+  for (int ky=0; ky < KERNEL; ky++) {
+    highp int y = center.y + ky * DILATION_Y;
+    if ((y < 0) || (y >= IN_HEIGHT)) continue;
+    for (int kx=0; kx < KERNEL; kx++) {
+      highp int x = center.x + kx * DILATION_X;
+      if ((x >= 0) && (x < IN_WIDTH)) {
+        result += activate(texelFetch(inputLayer0, inorg + ivec2(x, y), 0)) * weight(ky * KERNEL + kx, tile);
+      }
+    }
+  }
+#ifdef POST_BATCHNORM
+  result = result * texelFetch(biasTexture, ivec2(tile+1, 1), 0) + texelFetch(biasTexture, ivec2(tile+1, 0), 0);
+#else
+  result += texelFetch(biasTexture, ivec2(tile+1, 0), 0);
+#endif
+#ifdef INTER_RELU
+  result = max(vec4(0.0), result);
+#endif
+#ifdef INTER_CLIP
+  result = clamp(result, vec4(INTER_CLIP_LOW), vec4(INTER_CLIP_HIGH));
+#endif
+#ifdef USE_RESIDUAL
+  vec4 res = texelFetch(residualLayer0, ivec2(RES_PAD) + grid * ivec2(OUT_WIDTH+RES_PAD, OUT_HEIGHT+RES_PAD) + local, 0);
+#ifdef RELU_ON_RESIDUAL
+  res = max(vec4(0.0), res);
+#endif
+#ifdef BATCHNORM_ON_RESIDUAL
+  res *= texelFetch(biasTexture, ivec2(tile+1, 1), 0);
+#endif
+  result += res;
+#endif
+  fragmentColor0 = result;
+}
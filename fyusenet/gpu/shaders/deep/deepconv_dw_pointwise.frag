@@ -0,0 +1,74 @@
+/* ----------------------------------------------------------------------------
+ * Fused Pointwise Conv Shader (Deep)      Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Computes the pointwise (1x1) convolution that follows a depthwise convolution
+// for one output pixel per fragment by looping over all tiles of the (unpadded)
+// intermediate depthwise result. Every texel of the output texture (including
+// the padding) is written by this shader.
+
+#include "shaders/deep/fragpreamble.inc"
+
+#ifdef BINDING_SUPPORT
+layout(binding=1) uniform sampler2D residualLayer0;
+layout(binding=BIAS_UNIT) uniform sampler2D biasTexture;
+#ifdef NO_HALF
+layout(binding=WEIGHT_UNIT) uniform highp sampler2D inputCoeffs;
+#else
+layout(binding=WEIGHT_UNIT) uniform highp usampler2D inputCoeffs;
+#endif
+#else
+uniform sampler2D residualLayer0;
+uniform sampler2D biasTexture;
+#ifdef NO_HALF
+uniform highp sampler2D inputCoeffs;
+#else
+uniform highp usampler2D inputCoeffs;
+#endif
+#endif
+
+void main(void) {
+  highp ivec2 span = ivec2(OUT_WIDTH+OUT_PAD, OUT_HEIGHT+OUT_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= OUT_WIDTH) || (local.y >= OUT_HEIGHT)) return;
+  if ((grid.x >= OUT_TILES_X) || (tile >= OUT_TILES)) return;
+  vec4 result = vec4(0);
+  for (int t=0; t < DW_TILES; t++) {
+    vec4 v = texelFetch(inputLayer0, ivec2(t % DW_TILES_X, t / DW_TILES_X) * ivec2(OUT_WIDTH, OUT_HEIGHT) + local, 0);
+#ifdef NO_HALF
+    result += texelFetch(inputCoeffs, ivec2(t*4, tile), 0) * v.x;
+    result += texelFetch(inputCoeffs, ivec2(t*4+1, tile), 0) * v.y;
+    result += texelFetch(inputCoeffs, ivec2(t*4+2, tile), 0) * v.z;
+    result += texelFetch(inputCoeffs, ivec2(t*4+3, tile), 0) * v.w;
+#else
+    highp uvec4 w0 = texelFetch(inputCoeffs, ivec2(t*2, tile), 0);
+    highp uvec4 w1 = texelFetch(inputCoeffs, ivec2(t*2+1, tile), 0);
+    result += vec4(unpackHalf2x16(w0.x), unpackHalf2x16(w0.y)) * v.x;
+    result += vec4(unpackHalf2x16(w0.z), unpackHalf2x16(w0.w)) * v.y;
+    result += vec4(unpackHalf2x16(w1.x), unpackHalf2x16(w1.y)) * v.z;
+    result += vec4(unpackHalf2x16(w1.z), unpackHalf2x16(w1.w)) * v.w;
+#endif
+  }
+#ifdef POST_BATCHNORM
+  result = result * texelFetch(biasTexture, ivec2(tile+1, 1), 0) + texelFetch(biasTexture, ivec2(tile+1, 0), 0);
+#else
+  result += texelFetch(biasTexture, ivec2(tile+1, 0), 0);
+#endif
+#ifdef USE_RESIDUAL
+  vec4 res = texelFetch(residualLayer0, ivec2(RES_PAD) + grid * ivec2(OUT_WIDTH+RES_PAD, OUT_HEIGHT+RES_PAD) + local, 0);
+#ifdef RELU_ON_RESIDUAL
+  res = max(vec4(0.0), res);
+#endif
+#ifdef BATCHNORM_ON_RESIDUAL
+  res *= texelFetch(biasTexture, ivec2(tile+1, 1), 0);
+#endif
+  result += res;
+#endif
+  fragmentColor0 = result;
+}
@@ -0,0 +1,46 @@
+/* ----------------------------------------------------------------------------
+ * Global Pool Reduction (Deep)            Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Performs one pass of a tree reduction for global pooling. Each fragment reduces
+// a block of BLOCK_X x BLOCK_Y pixels of one input tile into one output pixel,
+// blocks on the border of a tile are clipped. On average pooling, the sum is
+// multiplied by SCALE. Every texel of the output texture (including the padding)
+// is written by this shader.
+
+#include "shaders/deep/fragpreamble.inc"
+#include "shaders/activation.inc"
+
+void main(void) {
+  highp ivec2 span = ivec2(OUT_WIDTH+OUT_PAD, OUT_HEIGHT+OUT_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= OUT_WIDTH) || (local.y >= OUT_HEIGHT)) return;
+  if ((grid.x >= OUT_TILES_X) || (tile >= TILES)) return;
+  highp ivec2 inorg = ivec2(IN_PAD) + ivec2(tile % IN_TILES_X, tile / IN_TILES_X) * ivec2(IN_WIDTH+IN_PAD, IN_HEIGHT+IN_PAD);
+  highp ivec2 start = local * ivec2(BLOCK_X, BLOCK_Y);
+  highp ivec2 end = min(start + ivec2(BLOCK_X, BLOCK_Y), ivec2(IN_WIDTH, IN_HEIGHT));
+#ifdef MAXPOOL
+  highp vec4 accu = activate(texelFetch(inputLayer0, inorg + start, 0));
+#else
+  highp vec4 accu = vec4(0);
+#endif
+  for (int y=start.y; y < end.y; y++) {
+    for (int x=start.x; x < end.x; x++) {
+#ifdef MAXPOOL
+      accu = max(accu, activate(texelFetch(inputLayer0, inorg + ivec2(x, y), 0)));
+#else
+      accu += activate(texelFetch(inputLayer0, inorg + ivec2(x, y), 0));
+#endif
+    }
+  }
+#ifdef AVGPOOL
+  accu *= SCALE;
+#endif
+  fragmentColor0 = accu;
+}
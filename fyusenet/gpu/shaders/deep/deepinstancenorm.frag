@@ -0,0 +1,46 @@
+/* ----------------------------------------------------------------------------
+ * Instance-Norm Output (Deep)             Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Final pass of the instance normalization (and the layer normalization over the
+// whole tensor) on deep tensors. Each fragment normalizes one pixel of the input
+// using the per-tile statistics of the reduction passes and applies the per-channel
+// scale and bias. Every texel of the output texture (including the padding) is
+// written by this shader.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+layout(binding=1) uniform sampler2D meanLayer;
+layout(binding=2) uniform sampler2D rstdLayer;
+layout(binding=3) uniform sampler2D paramLayer;
+#else
+uniform sampler2D inputLayer0;
+uniform sampler2D meanLayer;
+uniform sampler2D rstdLayer;
+uniform sampler2D paramLayer;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+
+#include "shaders/activation.inc"
+#include "shaders/deep/deepsoftmaxfetch.inc"
+
+void main(void) {
+  highp ivec2 span = ivec2(IN_WIDTH+OUT_PAD, IN_HEIGHT+OUT_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= IN_WIDTH) || (local.y >= IN_HEIGHT)) return;
+  if ((grid.x >= OUT_TILES_X) || (tile >= OUT_TILES)) return;
+  highp ivec2 stats = ivec2(tile % IN_TILES_X, tile / IN_TILES_X);
+  highp vec4 norm = (fetchSlice(tile, local) - texelFetch(meanLayer, stats, 0)) * texelFetch(rstdLayer, stats, 0);
+  fragmentColor0 = norm * texelFetch(paramLayer, ivec2(tile, 0), 0) + texelFetch(paramLayer, ivec2(tile, 1), 0);
+}
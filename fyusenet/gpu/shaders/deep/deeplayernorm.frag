@@ -0,0 +1,43 @@
+/* ----------------------------------------------------------------------------
+ * Layer-Norm Output (Deep)                Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Final pass of the layer normalization on deep tensors. Each fragment normalizes
+// one pixel of the input using the statistics of the previous pass and applies
+// the per-channel scale and bias. Every texel of the output texture (including
+// the padding) is written by this shader.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+layout(binding=1) uniform sampler2D statsLayer;
+layout(binding=2) uniform sampler2D paramLayer;
+#else
+uniform sampler2D inputLayer0;
+uniform sampler2D statsLayer;
+uniform sampler2D paramLayer;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+
+#include "shaders/activation.inc"
+#include "shaders/deep/deepsoftmaxfetch.inc"
+
+void main(void) {
+  highp ivec2 span = ivec2(IN_WIDTH+OUT_PAD, IN_HEIGHT+OUT_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= IN_WIDTH) || (local.y >= IN_HEIGHT)) return;
+  if ((grid.x >= OUT_TILES_X) || (tile >= OUT_TILES)) return;
+  highp vec2 stats = texelFetch(statsLayer, local, 0).rg;
+  highp vec4 norm = (fetchSlice(tile, local) - vec4(stats.x)) * stats.y;
+  fragmentColor0 = norm * texelFetch(paramLayer, ivec2(tile, 0), 0) + texelFetch(paramLayer, ivec2(tile, 1), 0);
+}
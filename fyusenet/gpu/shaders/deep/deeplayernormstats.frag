@@ -0,0 +1,41 @@
+/* ----------------------------------------------------------------------------
+ * Layer-Norm Statistics (Deep)            Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// First pass of the layer normalization on deep tensors. Each fragment computes
+// the mean and the inverse standard deviation over all channels of one spatial
+// position, the variance is accumulated from the deviations to the mean.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+#else
+uniform sampler2D inputLayer0;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+
+#include "shaders/activation.inc"
+#include "shaders/deep/deepsoftmaxfetch.inc"
+
+void main(void) {
+  highp ivec2 pos = ivec2(gl_FragCoord.xy);
+  highp vec4 sum = vec4(0);
+  for (int s=0; s < IN_SLICES; s++) {
+    sum += fetchSlice(s, pos);
+  }
+  highp float mean = dot(sum, vec4(1)) / float(IN_CHANNELS);
+  highp vec4 var = vec4(0);
+  for (int s=0; s < IN_SLICES; s++) {
+    // channels beyond IN_CHANNELS (in the last slice) do not contribute
+    highp vec4 valid = vec4(lessThan(ivec4(s*4) + ivec4(0, 1, 2, 3), ivec4(IN_CHANNELS)));
+    highp vec4 dev = (fetchSlice(s, pos) - vec4(mean)) * valid;
+    var += dev * dev;
+  }
+  fragmentColor0 = vec4(mean, inversesqrt(dot(var, vec4(1)) / float(IN_CHANNELS) + EPSILON), 0.0, 0.0);
+}
@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * Batched Matrix Multiplication (Deep)    Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Computes ALPHA * op(A) * op(B) for each batch, where A is stored in inputLayer0
+// and B in inputLayer1. Matrix rows are the (row-major) spatial positions of a
+// tensor and matrix columns are its channels, each batch covers MAT_K/4 (or MAT_M/4
+// or MAT_N/4) consecutive tiles. Each fragment computes 4 adjacent columns of one
+// row of the product, every texel of the output texture (including the padding)
+// is written by this shader.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+layout(binding=1) uniform sampler2D inputLayer1;
+#else
+uniform sampler2D inputLayer0;
+uniform sampler2D inputLayer1;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+
+#ifdef HIGHP_ACCUM
+#define ACCUM highp
+#else
+#define ACCUM mediump
+#endif
+
+#include "shaders/activation.inc"
+
+// Fetches 4 channels (one tile) of A at the supplied spatial position
+highp vec4 fetchA(in highp int tile, in highp int p) {
+  highp ivec2 org = ivec2(IN_PAD) + ivec2(tile % A_TILES_X, tile / A_TILES_X) * ivec2(A_WIDTH+IN_PAD, A_HEIGHT+IN_PAD);
+  return activate(texelFetch(inputLayer0, org + ivec2(p % A_WIDTH, p / A_WIDTH), 0));
+}
+
+// Fetches 4 channels (one tile) of B at the supplied spatial position
+highp vec4 fetchB(in highp int tile, in highp int p) {
+  highp ivec2 org = ivec2(IN_PAD) + ivec2(tile % B_TILES_X, tile / B_TILES_X) * ivec2(B_WIDTH+IN_PAD, B_HEIGHT+IN_PAD);
+  return activate(texelFetch(inputLayer1, org + ivec2(p % B_WIDTH, p / B_WIDTH), 0));
+}
+
+void main(void) {
+  highp ivec2 span = ivec2(OUT_WIDTH+OUT_PAD, OUT_HEIGHT+OUT_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= OUT_WIDTH) || (local.y >= OUT_HEIGHT)) return;
+  if ((grid.x >= OUT_TILES_X) || (tile >= OUT_TILES)) return;
+  highp int batch = tile / (MAT_N/4);
+  highp int col = (tile - batch * (MAT_N/4)) * 4;
+  highp int row = local.y * OUT_WIDTH + local.x;
+#ifdef TRANSPOSE_A
+  highp int atile = (batch * MAT_M + row) / 4;
+  highp int acomp = row & 3;
+#endif
+  ACCUM vec4 acc = vec4(0);
+  for (highp int k=0; k < MAT_K; k += 4) {
+    // 4 consecutive elements of one row of op(A)
+#ifdef TRANSPOSE_A
+    ACCUM vec4 a = vec4(fetchA(atile, k)[acomp],
+                        (k+1 < MAT_K) ? fetchA(atile, k+1)[acomp] : 0.0,
+                        (k+2 < MAT_K) ? fetchA(atile, k+2)[acomp] : 0.0,
+                        (k+3 < MAT_K) ? fetchA(atile, k+3)[acomp] : 0.0);
+#else
+    ACCUM vec4 a = fetchA(batch * (MAT_K/4) + k/4, row);
+#endif
+    // 4x4 block of op(B) with rows k..k+3 and columns col..col+3
+#ifdef TRANSPOSE_B
+    highp int btile = batch * (MAT_K/4) + k/4;
+    acc += a * mat4(fetchB(btile, col), fetchB(btile, col+1), fetchB(btile, col+2), fetchB(btile, col+3));
+#else
+    highp int btile = batch * (MAT_N/4) + col/4;
+    acc += mat4(fetchB(btile, k),
+                (k+1 < MAT_K) ? fetchB(btile, k+1) : vec4(0),
+                (k+2 < MAT_K) ? fetchB(btile, k+2) : vec4(0),
+                (k+3 < MAT_K) ? fetchB(btile, k+3) : vec4(0)) * a;
+#endif
+  }
+  fragmentColor0 = acc * ALPHA;
+}
@@ -0,0 +1,44 @@
+/* ----------------------------------------------------------------------------
+ * Fused Pointwise Chain (Deep)            Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+#include "shaders/deep/fragpreamble.inc"
+
+#include "shaders/activation.inc"
+
+// NOTE the CHAIN_OPS macro is generated by DeepPointwiseChainLayer and supplied
+// as preprocessor definition
+uniform highp float operands[NUM_OPERANDS];
+
+uniform vec2 texStep;
+
+void main(void) {
+#if defined(CHAIN_MAXPOOL)
+  vec4 data = activate(texture(inputLayer0, texCoord));
+  for (int y=-PADDING; y < POOLSIZE_Y-PADDING; y++) {
+    for (int x=-PADDING; x < POOLSIZE_X-PADDING; x++) {
+      data = max(data, activate(texture(inputLayer0, texCoord+vec2(x,y)*texStep)));
+    }
+  }
+#elif defined(CHAIN_AVGPOOL)
+  // same taps as deepavgpool.frag, which only centers the window for 3x3 pooling
+#if (POOLSIZE_X == 3) && (POOLSIZE_Y == 3)
+  const int start = -1;
+#else
+  const int start = 0;
+#endif
+  vec4 data = vec4(0.0);
+  for (int y=start; y < POOLSIZE_Y+start; y++) {
+    for (int x=start; x < POOLSIZE_X+start; x++) {
+      data += activate(texture(inputLayer0, texCoord+vec2(x,y)*texStep));
+    }
+  }
+  data /= float(POOLSIZE_X*POOLSIZE_Y);
+#else
+  vec4 data = activate(texture(inputLayer0, texCoord));
+#endif
+  CHAIN_OPS(data)
+  fragmentColor0 = data;
+}
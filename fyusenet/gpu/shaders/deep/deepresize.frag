@@ -0,0 +1,38 @@
+/* ----------------------------------------------------------------------------
+ * Resize (Deep)                           Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Resizes each tile of a deep tensor to DST_WIDTH x DST_HEIGHT pixels using the
+// functions in resample.inc. Every texel of the output texture (including the
+// padding) is written by this shader.
+
+#define RESIZE_PASS
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+#else
+uniform sampler2D inputLayer0;
+#endif
+
+layout(location=0) out vec4 fragmentColor0;
+
+#include "shaders/activation.inc"
+#include "shaders/deep/resample.inc"
+
+void main(void) {
+  highp ivec2 span = ivec2(DST_WIDTH+DST_PAD, DST_HEIGHT+DST_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(DST_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * DST_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= DST_WIDTH) || (local.y >= DST_HEIGHT)) return;
+  if ((grid.x >= DST_TILES_X) || (tile >= DST_TILES)) return;
+  fragmentColor0 = activate(resampleTile(tile, local));
+}
@@ -0,0 +1,44 @@
+/* ----------------------------------------------------------------------------
+ * SoftMax Output (Deep)                   Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Final pass of the softmax on deep tensors. Each fragment computes one output
+// pixel from the input and the statistics of the previous pass(es). In top-k mode
+// (TOP_K defined), each output tile stores two (index, probability) pairs. Every
+// texel of the output texture (including the padding) is written by this shader.
+
+#define OUTPUT_PASS
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+layout(binding=1) uniform sampler2D statsLayer0;
+layout(binding=2) uniform sampler2D statsLayer1;
+#else
+uniform sampler2D inputLayer0;
+uniform sampler2D statsLayer0;
+uniform sampler2D statsLayer1;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+
+#include "shaders/activation.inc"
+#include "shaders/deep/deepsoftmaxfetch.inc"
+#include "shaders/softmax.inc"
+
+void main(void) {
+  highp ivec2 span = ivec2(IN_WIDTH+OUT_PAD, IN_HEIGHT+OUT_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= IN_WIDTH) || (local.y >= IN_HEIGHT)) return;
+  if ((grid.x >= OUT_TILES_X) || (tile >= OUT_TILES)) return;
+  fragmentColor0 = outputSlice(tile, local);
+}
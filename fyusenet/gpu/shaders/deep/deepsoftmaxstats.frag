@@ -0,0 +1,42 @@
+/* ----------------------------------------------------------------------------
+ * SoftMax Statistics (Deep)               Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// First pass of the softmax on deep tensors. For a channel-wise softmax, each
+// fragment computes the max and the sum of exponentials over all channels of one
+// spatial position. For a spatial softmax (SPATIAL defined), each fragment
+// computes those statistics over one row of one tile and writes the max and the
+// sum into two separate render targets.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+#else
+uniform sampler2D inputLayer0;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+#ifdef SPATIAL
+layout(location=1) out highp vec4 fragmentColor1;
+#endif
+
+#include "shaders/activation.inc"
+#include "shaders/deep/deepsoftmaxfetch.inc"
+#include "shaders/softmax.inc"
+
+void main(void) {
+  highp ivec2 pos = ivec2(gl_FragCoord.xy);
+#ifdef SPATIAL
+  highp vec4 mx, sum;
+  rowStats(pos.x, pos.y, mx, sum);
+  fragmentColor0 = mx;
+  fragmentColor1 = sum;
+#else
+  fragmentColor0 = vec4(channelStats(pos), 0.0, 0.0);
+#endif
+}
@@ -0,0 +1,49 @@
+/* ----------------------------------------------------------------------------
+ * Winograd F(2x2,3x3) Products            Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Computes the products of the transformed input with the transformed weights
+// for TILES_PER_INSTANCE input tiles. The results are accumulated over all input
+// tiles by additive blending.
+
+#include "shaders/deep/fragpreamble.inc"
+
+flat in highp int firstTile;
+#ifdef NO_HALF
+flat in mediump vec4 layer0coeffs[4*TILES_PER_INSTANCE];
+#else
+flat in highp uvec4 layer0coeffs[2*TILES_PER_INSTANCE];
+#endif
+
+#define TILE_WIDTH (4*BLOCKS_X)
+#define TILE_HEIGHT (4*BLOCKS_Y)
+
+vec4 product(in vec4 tex, in int offset) {
+  mediump mat4 weights;
+#ifdef NO_HALF
+  weights[0] = layer0coeffs[2*offset];
+  weights[1] = layer0coeffs[2*offset+1];
+  weights[2] = layer0coeffs[2*offset+2];
+  weights[3] = layer0coeffs[2*offset+3];
+#else
+  highp uvec4 w = layer0coeffs[offset];
+  weights[0] = vec4(unpackHalf2x16(w.x),unpackHalf2x16(w.y));
+  weights[1] = vec4(unpackHalf2x16(w.z),unpackHalf2x16(w.w));
+  w = layer0coeffs[offset+1];
+  weights[2] = vec4(unpackHalf2x16(w.x),unpackHalf2x16(w.y));
+  weights[3] = vec4(unpackHalf2x16(w.z),unpackHalf2x16(w.w));
+#endif
+  return tex*weights;
+}
+
+void main(void) {
+  highp ivec2 pos = ivec2(texCoord);
+  fragmentColor0 = vec4(0);
+  for (int i=0; i < TILES_PER_INSTANCE; i++) {
+    highp int tile = firstTile + i;
+    highp ivec2 org = ivec2(tile % TRANS_COLUMNS, tile / TRANS_COLUMNS) * ivec2(TILE_WIDTH, TILE_HEIGHT);
+    fragmentColor0 += product(texelFetch(inputLayer0, org + pos, 0), 2*i);
+  }
+}
@@ -0,0 +1,50 @@
+/* ----------------------------------------------------------------------------
+ * Winograd F(2x2,3x3) Products (Vertex)   Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+#ifdef NO_HALF
+layout(binding=WEIGHT_UNIT) uniform sampler2D inputCoeffs;
+#else
+layout(binding=WEIGHT_UNIT) uniform highp usampler2D inputCoeffs;
+#endif
+#else
+#ifdef NO_HALF
+uniform sampler2D inputCoeffs;
+#else
+uniform highp usampler2D inputCoeffs;
+#endif
+#endif
+
+in highp vec4 attributes0;
+in highp ivec2 attributes1;
+
+out highp vec2 texCoord;
+flat out highp int firstTile;
+#ifdef NO_HALF
+flat out mediump vec4 layer0coeffs[4*TILES_PER_INSTANCE];
+#else
+flat out highp uvec4 layer0coeffs[2*TILES_PER_INSTANCE];
+#endif
+
+void main(void) {
+  gl_Position = vec4(attributes0.x,attributes0.y,0.0,1.0);
+  texCoord = attributes0.zw;
+  firstTile = gl_InstanceID * TILES_PER_INSTANCE;
+  // attributes1.x holds the row in the weight texture (output tile and transformed position)
+#ifdef NO_HALF
+  for (int i=0; i < 4*TILES_PER_INSTANCE; i++) {
+    layer0coeffs[i] = texelFetch(inputCoeffs, ivec2(firstTile*4 + i, attributes1.x), 0);
+  }
+#else
+  for (int i=0; i < 2*TILES_PER_INSTANCE; i++) {
+    layer0coeffs[i] = texelFetch(inputCoeffs, ivec2(firstTile*2 + i, attributes1.x), 0);
+  }
+#endif
+}
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------------
+ * Winograd F(2x2,3x3) Input Transform     Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Computes one element of V = B^T d B for a 4x4 input patch d per fragment. The
+// target texture holds one region of 4*BLOCKS_X x 4*BLOCKS_Y pixels per input
+// tile, which is subdivided into 16 planes (one per transformed position) that
+// contain one pixel per 2x2 output block. Each element of V is a combination of
+// only 4 elements of d, as each row of B^T has only 2 non-zero entries.
+
+#include "shaders/deep/fragpreamble.inc"
+#include "shaders/activation.inc"
+
+#define TILE_WIDTH (4*BLOCKS_X)
+#define TILE_HEIGHT (4*BLOCKS_Y)
+
+highp ivec2 tbase;
+
+vec4 fetch(in highp ivec2 pos) {
+  // NOTE the last block in a tile may extend beyond the padding of the input
+  if ((pos.x < 0) || (pos.y < 0) || (pos.x >= IN_WIDTH) || (pos.y >= IN_HEIGHT)) return vec4(0);
+  return activate(texelFetch(inputLayer0, tbase + pos, 0));
+}
+
+void main(void) {
+  highp ivec2 pos = ivec2(gl_FragCoord.xy);
+  highp ivec2 grid = pos / ivec2(TILE_WIDTH, TILE_HEIGHT);
+  highp ivec2 local = pos - grid * ivec2(TILE_WIDTH, TILE_HEIGHT);
+  highp ivec2 xi = local / ivec2(BLOCKS_X, BLOCKS_Y);
+  highp ivec2 block = local - xi * ivec2(BLOCKS_X, BLOCKS_Y);
+  highp int tile = grid.y * TRANS_COLUMNS + grid.x;
+  if (tile >= IN_TILES) {
+    fragmentColor0 = vec4(0);
+    return;
+  }
+  tbase = ivec2(IN_PAD) + ivec2(tile % IN_TILES_X, tile / IN_TILES_X) * ivec2(IN_WIDTH+IN_PAD, IN_HEIGHT+IN_PAD);
+  // rows of B^T: (1,0,-1,0), (0,1,1,0), (0,-1,1,0), (0,1,0,-1)
+  highp ivec2 ia = min(xi, ivec2(1));
+  highp ivec2 ib = ivec2(2) + xi / ivec2(3);
+  vec2 ca = vec2(equal(xi, ivec2(2))) * -2.0 + 1.0;
+  vec2 cb = vec2(notEqual(xi % ivec2(3), ivec2(0))) * 2.0 - 1.0;
+  highp ivec2 org = block * 2 - ivec2(1);
+  fragmentColor0 = ca.y * (ca.x * fetch(org + ivec2(ia.x, ia.y)) + cb.x * fetch(org + ivec2(ib.x, ia.y))) +
+                   cb.y * (ca.x * fetch(org + ivec2(ia.x, ib.y)) + cb.x * fetch(org + ivec2(ib.x, ib.y)));
+}
@@ -0,0 +1,63 @@
+/* ----------------------------------------------------------------------------
+ * Winograd F(2x2,3x3) Output Transform    Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Computes one output pixel of Y = A^T M A for each fragment and applies bias,
+// batchnorm and the optional residual. As each row of A^T has only 3 non-zero
+// entries, each output pixel is a combination of 9 elements of M. Every texel
+// of the output texture (including the padding) is written by this shader.
+
+#include "shaders/deep/fragpreamble.inc"
+
+#ifdef BINDING_SUPPORT
+layout(binding=1) uniform sampler2D residualLayer0;
+layout(binding=BIAS_UNIT) uniform sampler2D biasTexture;
+#else
+uniform sampler2D residualLayer0;
+uniform sampler2D biasTexture;
+#endif
+
+#define TILE_WIDTH (4*BLOCKS_X)
+#define TILE_HEIGHT (4*BLOCKS_Y)
+
+void main(void) {
+  highp ivec2 span = ivec2(OUT_WIDTH+OUT_PAD, OUT_HEIGHT+OUT_PAD);
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  highp ivec2 grid = pos / span;
+  highp ivec2 local = pos - grid * span;
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  if ((pos.x < 0) || (pos.y < 0) || (local.x >= OUT_WIDTH) || (local.y >= OUT_HEIGHT)) return;
+  if ((grid.x >= OUT_TILES_X) || (tile >= OUT_TILES)) return;
+  highp ivec2 sub = local & ivec2(1);
+  highp ivec2 org = ivec2(tile % PROD_COLUMNS, tile / PROD_COLUMNS) * ivec2(TILE_WIDTH, TILE_HEIGHT) + (local >> 1);
+  // rows of A^T: (1,1,1,0), (0,1,-1,-1)
+  vec3 cx = (sub.x == 0) ? vec3(1.0) : vec3(1.0, -1.0, -1.0);
+  vec3 cy = (sub.y == 0) ? vec3(1.0) : vec3(1.0, -1.0, -1.0);
+  vec4 result = vec4(0);
+  for (int i=0; i < 3; i++) {
+    highp int y = org.y + (sub.y + i) * BLOCKS_Y;
+    vec4 row = cx.x * texelFetch(inputLayer0, ivec2(org.x + sub.x * BLOCKS_X, y), 0);
+    row += cx.y * texelFetch(inputLayer0, ivec2(org.x + (sub.x + 1) * BLOCKS_X, y), 0);
+    row += cx.z * texelFetch(inputLayer0, ivec2(org.x + (sub.x + 2) * BLOCKS_X, y), 0);
+    result += cy[i] * row;
+  }
+#ifdef POST_BATCHNORM
+  result = result * texelFetch(biasTexture, ivec2(tile+1, 1), 0) + texelFetch(biasTexture, ivec2(tile+1, 0), 0);
+#else
+  result += texelFetch(biasTexture, ivec2(tile+1, 0), 0);
+#endif
+#ifdef USE_RESIDUAL
+  vec4 res = texelFetch(residualLayer0, ivec2(RES_PAD) + grid * ivec2(OUT_WIDTH+RES_PAD, OUT_HEIGHT+RES_PAD) + local, 0);
+#ifdef RELU_ON_RESIDUAL
+  res = max(vec4(0.0), res);
+#endif
+#ifdef BATCHNORM_ON_RESIDUAL
+  res *= texelFetch(biasTexture, ivec2(tile+1, 1), 0);
+#endif
+  result += res;
+#endif
+  fragmentColor0 = result;
+}
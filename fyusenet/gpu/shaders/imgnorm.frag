@@ -0,0 +1,31 @@
+/* ----------------------------------------------------------------------------
+ * Image Normalization on Upload           Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+precision highp float;
+precision lowp int;
+precision mediump sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+#else
+uniform sampler2D inputLayer0;
+#endif
+
+// scale and bias are applied to normalized texture values (0..1)
+uniform vec4 scale;
+uniform vec4 bias;
+
+layout(location=0) out vec4 fragmentColor0;
+
+in highp vec2 texCoord;
+
+void main(void) {
+  vec4 val = texture(inputLayer0, texCoord);
+#ifdef SWAP_RB
+  val = val.bgra;
+#endif
+  fragmentColor0 = val * scale + bias;
+}
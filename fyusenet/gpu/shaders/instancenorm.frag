@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * Instance-Norm Output Shader             Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Final pass of the instance normalization (and the layer normalization over the
+// whole tensor) on shallow tensors. Normalizes NUM_LANES input textures using the
+// statistics of the reduction passes, which are stored as one texel per texture
+// starting at texOffset, and applies the per-channel scale and bias.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+layout(binding=1) uniform sampler2D inputLayer1;
+layout(binding=2) uniform sampler2D inputLayer2;
+layout(binding=3) uniform sampler2D inputLayer3;
+layout(binding=4) uniform sampler2D inputLayer4;
+layout(binding=5) uniform sampler2D inputLayer5;
+layout(binding=6) uniform sampler2D inputLayer6;
+layout(binding=7) uniform sampler2D inputLayer7;
+layout(binding=8) uniform sampler2D meanLayer;
+layout(binding=9) uniform sampler2D rstdLayer;
+#else
+uniform sampler2D inputLayer0;
+uniform sampler2D inputLayer1;
+uniform sampler2D inputLayer2;
+uniform sampler2D inputLayer3;
+uniform sampler2D inputLayer4;
+uniform sampler2D inputLayer5;
+uniform sampler2D inputLayer6;
+uniform sampler2D inputLayer7;
+uniform sampler2D meanLayer;
+uniform sampler2D rstdLayer;
+#endif
+
+in highp vec2 texCoord;
+
+layout(location=0) out vec4 fragmentColor0;
+#if NUM_LANES > 1
+layout(location=1) out vec4 fragmentColor1;
+#endif
+#if NUM_LANES > 2
+layout(location=2) out vec4 fragmentColor2;
+#endif
+#if NUM_LANES > 3
+layout(location=3) out vec4 fragmentColor3;
+#endif
+#if NUM_LANES > 4
+layout(location=4) out vec4 fragmentColor4;
+#endif
+#if NUM_LANES > 5
+layout(location=5) out vec4 fragmentColor5;
+#endif
+#if NUM_LANES > 6
+layout(location=6) out vec4 fragmentColor6;
+#endif
+#if NUM_LANES > 7
+layout(location=7) out vec4 fragmentColor7;
+#endif
+
+uniform vec4 biasscale[NUM_LANES*2];
+uniform int texOffset;
+
+#include "shaders/activation.inc"
+
+vec4 applyNorm(in sampler2D sampler, in int lane) {
+  highp ivec2 stats = ivec2(texOffset + lane, 0);
+  highp vec4 norm = (activate(texture(sampler, texCoord)) - texelFetch(meanLayer, stats, 0)) * texelFetch(rstdLayer, stats, 0);
+  return biasscale[2*lane] + norm * biasscale[2*lane+1];
+}
+
+
+void main(void) {
+  fragmentColor0 = applyNorm(inputLayer0, 0);
+#if NUM_LANES > 1
+  fragmentColor1 = applyNorm(inputLayer1, 1);
+#endif
+#if NUM_LANES > 2
+  fragmentColor2 = applyNorm(inputLayer2, 2);
+#endif
+#if NUM_LANES > 3
+  fragmentColor3 = applyNorm(inputLayer3, 3);
+#endif
+#if NUM_LANES > 4
+  fragmentColor4 = applyNorm(inputLayer4, 4);
+#endif
+#if NUM_LANES > 5
+  fragmentColor5 = applyNorm(inputLayer5, 5);
+#endif
+#if NUM_LANES > 6
+  fragmentColor6 = applyNorm(inputLayer6, 6);
+#endif
+#if NUM_LANES > 7
+  fragmentColor7 = applyNorm(inputLayer7, 7);
+#endif
+}
@@ -0,0 +1,45 @@
+/* ----------------------------------------------------------------------------
+ * Normalization Statistics Combination    Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Combines the per-channel means and sums of squared deviations (M2) of all tiles
+// into the mean and inverse standard deviation of the whole tensor. As all channels
+// cover the same number of pixels (COUNT), the pairwise update simplifies to the
+// mean of the means and the M2 of the means. All fragments compute the same values
+// and write them into every channel of every texel of the output textures.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+layout(binding=1) uniform sampler2D inputLayer1;
+#else
+uniform sampler2D inputLayer0;
+uniform sampler2D inputLayer1;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+layout(location=1) out highp vec4 fragmentColor1;
+
+void main(void) {
+  highp float sum = 0.0;
+  for (int t=0; t < TILES; t++) {
+    // channels beyond CHANNELS (in the last tile) do not contribute
+    highp vec4 valid = vec4(lessThan(ivec4(t*4) + ivec4(0, 1, 2, 3), ivec4(CHANNELS)));
+    sum += dot(texelFetch(inputLayer0, ivec2(t % TILES_X, t / TILES_X), 0), valid);
+  }
+  highp float mean = sum / float(CHANNELS);
+  highp float m2 = 0.0;
+  for (int t=0; t < TILES; t++) {
+    highp ivec2 pos = ivec2(t % TILES_X, t / TILES_X);
+    highp vec4 valid = vec4(lessThan(ivec4(t*4) + ivec4(0, 1, 2, 3), ivec4(CHANNELS)));
+    highp vec4 dev = texelFetch(inputLayer0, pos, 0) - vec4(mean);
+    m2 += dot(texelFetch(inputLayer1, pos, 0) + float(COUNT) * dev * dev, valid);
+  }
+  fragmentColor0 = vec4(mean);
+  fragmentColor1 = vec4(inversesqrt(m2 / (float(COUNT) * float(CHANNELS)) + EPSILON));
+}
@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+ * Normalization Statistics Reduction      Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Performs one pass of a tree reduction that computes the per-channel mean and
+// the sum of squared deviations from the mean (M2) over the spatial extent of each
+// tile. Each fragment reduces a block of BLOCK_X x BLOCK_Y texels of one input tile
+// into one output texel, blocks on the border of a tile are clipped.
+//
+// On the first pass, the texels are the (activated) input data. On subsequent passes
+// the texels are the partial results of the previous pass, each of which covers up
+// to CELL_X x CELL_Y pixels of the original tile. Partial results are merged using
+// the pairwise update by Chan et al., which does not suffer from the cancellation
+// of the sum-of-squares formulation. When FINAL_STATS is defined, the second output
+// contains the inverse standard deviation instead of M2.
+//
+// For shallow tensors (SINGLE_TILE), each input texture contains exactly one tile
+// and the tile index is only used for the output location.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+layout(binding=1) uniform sampler2D inputLayer1;
+#else
+uniform sampler2D inputLayer0;
+uniform sampler2D inputLayer1;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+layout(location=1) out highp vec4 fragmentColor1;
+
+#include "shaders/activation.inc"
+
+#ifndef FIRST_PASS
+// Number of original pixels that are covered by the supplied texel of the input tile
+highp float cellCount(in highp ivec2 texel) {
+  highp ivec2 org = texel * ivec2(CELL_X, CELL_Y);
+  highp ivec2 ext = min(org + ivec2(CELL_X, CELL_Y), ivec2(ORIG_WIDTH, ORIG_HEIGHT)) - org;
+  return float(ext.x * ext.y);
+}
+#endif
+
+void main(void) {
+  highp ivec2 pos = ivec2(gl_FragCoord.xy);
+  highp ivec2 grid = pos / ivec2(OUT_WIDTH, OUT_HEIGHT);
+  highp ivec2 local = pos - grid * ivec2(OUT_WIDTH, OUT_HEIGHT);
+  highp int tile = grid.y * OUT_TILES_X + grid.x;
+  fragmentColor0 = vec4(0);
+  fragmentColor1 = vec4(0);
+  if ((grid.x >= OUT_TILES_X) || (tile >= TILES)) return;
+#ifdef SINGLE_TILE
+  highp ivec2 inorg = ivec2(IN_PAD);
+#else
+  highp ivec2 inorg = ivec2(IN_PAD) + ivec2(tile % IN_TILES_X, tile / IN_TILES_X) * ivec2(IN_WIDTH+IN_PAD, IN_HEIGHT+IN_PAD);
+#endif
+  highp ivec2 start = local * ivec2(BLOCK_X, BLOCK_Y);
+  highp ivec2 end = min(start + ivec2(BLOCK_X, BLOCK_Y), ivec2(IN_WIDTH, IN_HEIGHT));
+  highp float count = 0.0;
+  highp vec4 sum = vec4(0);
+  for (int y=start.y; y < end.y; y++) {
+    for (int x=start.x; x < end.x; x++) {
+#ifdef FIRST_PASS
+      sum += activate(texelFetch(inputLayer0, inorg + ivec2(x, y), 0));
+      count += 1.0;
+#else
+      highp float cells = cellCount(ivec2(x, y));
+      sum += cells * texelFetch(inputLayer0, inorg + ivec2(x, y), 0);
+      count += cells;
+#endif
+    }
+  }
+  highp vec4 mean = sum / count;
+  highp vec4 m2 = vec4(0);
+  for (int y=start.y; y < end.y; y++) {
+    for (int x=start.x; x < end.x; x++) {
+#ifdef FIRST_PASS
+      highp vec4 dev = activate(texelFetch(inputLayer0, inorg + ivec2(x, y), 0)) - mean;
+      m2 += dev * dev;
+#else
+      highp vec4 dev = texelFetch(inputLayer0, inorg + ivec2(x, y), 0) - mean;
+      m2 += texelFetch(inputLayer1, inorg + ivec2(x, y), 0) + cellCount(ivec2(x, y)) * dev * dev;
+#endif
+    }
+  }
+  fragmentColor0 = mean;
+#ifdef FINAL_STATS
+  fragmentColor1 = inversesqrt(m2 / count + vec4(EPSILON));
+#else
+  fragmentColor1 = m2;
+#endif
+}
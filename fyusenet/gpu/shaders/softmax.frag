@@ -0,0 +1,58 @@
+/* ----------------------------------------------------------------------------
+ * SoftMax Output (Shallow)                Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Final pass of the softmax on shallow tensors. Each fragment computes one output
+// pixel for NUM_LANES output textures, starting at slice LANE_OFFSET, from the
+// input and the statistics of the previous pass(es). In top-k mode (TOP_K
+// defined), each output slice stores two (index, probability) pairs. Every texel
+// of the output textures (including the padding) is written by this shader.
+
+#define OUTPUT_PASS
+
+#include "shaders/funcpreamble.inc"
+
+#ifdef BINDING_SUPPORT
+layout(binding=STATS_UNIT0) uniform highp sampler2D statsLayer0;
+layout(binding=STATS_UNIT1) uniform highp sampler2D statsLayer1;
+#else
+uniform highp sampler2D statsLayer0;
+uniform highp sampler2D statsLayer1;
+#endif
+
+#include "shaders/activation.inc"
+#include "shaders/softmaxfetch.inc"
+#include "shaders/softmax.inc"
+
+highp vec4 process(in highp int slice, in highp ivec2 pos, in bool inside) {
+  return (inside) ? outputSlice(slice, pos) : vec4(0.0);
+}
+
+void main(void) {
+  highp ivec2 pos = ivec2(gl_FragCoord.xy) - ivec2(OUT_PAD);
+  bool inside = all(greaterThanEqual(pos, ivec2(0))) && all(lessThan(pos, ivec2(IN_WIDTH, IN_HEIGHT)));
+  fragmentColor0 = process(LANE_OFFSET, pos, inside);
+#if NUM_LANES > 1
+  fragmentColor1 = process(LANE_OFFSET+1, pos, inside);
+#endif
+#if NUM_LANES > 2
+  fragmentColor2 = process(LANE_OFFSET+2, pos, inside);
+#endif
+#if NUM_LANES > 3
+  fragmentColor3 = process(LANE_OFFSET+3, pos, inside);
+#endif
+#if NUM_LANES > 4
+  fragmentColor4 = process(LANE_OFFSET+4, pos, inside);
+#endif
+#if NUM_LANES > 5
+  fragmentColor5 = process(LANE_OFFSET+5, pos, inside);
+#endif
+#if NUM_LANES > 6
+  fragmentColor6 = process(LANE_OFFSET+6, pos, inside);
+#endif
+#if NUM_LANES > 7
+  fragmentColor7 = process(LANE_OFFSET+7, pos, inside);
+#endif
+}
@@ -0,0 +1,39 @@
+/* ----------------------------------------------------------------------------
+ * SoftMax Row Merge                       Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// Second pass of a spatial softmax (deep and shallow). Each fragment merges the
+// per-row maxima and sums of exponentials of one slice into the statistics of the
+// whole slice. The sums are rescaled to the global maximum before they are added,
+// which keeps the computation numerically stable.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D rowMax;
+layout(binding=1) uniform sampler2D rowSum;
+#else
+uniform sampler2D rowMax;
+uniform sampler2D rowSum;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+layout(location=1) out highp vec4 fragmentColor1;
+
+void main(void) {
+  highp int slice = int(gl_FragCoord.x);
+  highp vec4 mx = vec4(-FLT_MAX);
+  for (int y=0; y < IN_HEIGHT; y++) {
+    mx = max(mx, texelFetch(rowMax, ivec2(slice, y), 0));
+  }
+  highp vec4 sum = vec4(0.0);
+  for (int y=0; y < IN_HEIGHT; y++) {
+    sum += texelFetch(rowSum, ivec2(slice, y), 0) * exp(texelFetch(rowMax, ivec2(slice, y), 0) - mx);
+  }
+  fragmentColor0 = mx;
+  fragmentColor1 = sum;
+}
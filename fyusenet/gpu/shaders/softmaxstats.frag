@@ -0,0 +1,57 @@
+/* ----------------------------------------------------------------------------
+ * SoftMax Statistics (Shallow)            Copyright (c) 2016-2022 Fyusion Inc.
+ * Creator: agent
+ * SPDX-License-Identifier: MIT
+ * ------------------------------------------------------------------------- */
+
+// First pass of the softmax on shallow tensors, where each slice of 4 channels is
+// stored in its own texture. For a channel-wise softmax, each fragment computes
+// the max and the sum of exponentials over all channels of one spatial position.
+// For a spatial softmax (SPATIAL defined), each fragment computes those statistics
+// over one row of one slice and writes the max and the sum into two separate
+// render targets.
+
+precision highp float;
+precision highp int;
+precision highp sampler2D;
+
+#ifdef BINDING_SUPPORT
+layout(binding=0) uniform sampler2D inputLayer0;
+layout(binding=1) uniform sampler2D inputLayer1;
+layout(binding=2) uniform sampler2D inputLayer2;
+layout(binding=3) uniform sampler2D inputLayer3;
+layout(binding=4) uniform sampler2D inputLayer4;
+layout(binding=5) uniform sampler2D inputLayer5;
+layout(binding=6) uniform sampler2D inputLayer6;
+layout(binding=7) uniform sampler2D inputLayer7;
+#else
+uniform sampler2D inputLayer0;
+uniform sampler2D inputLayer1;
+uniform sampler2D inputLayer2;
+uniform sampler2D inputLayer3;
+uniform sampler2D inputLayer4;
+uniform sampler2D inputLayer5;
+uniform sampler2D inputLayer6;
+uniform sampler2D inputLayer7;
+#endif
+
+layout(location=0) out highp vec4 fragmentColor0;
+#ifdef SPATIAL
+layout(location=1) out highp vec4 fragmentColor1;
+#endif
+
+#include "shaders/activation.inc"
+#include "shaders/softmaxfetch.inc"
+#include "shaders/softmax.inc"
+
+void main(void) {
+  highp ivec2 pos = ivec2(gl_FragCoord.xy);
+#ifdef SPATIAL
+  highp vec4 mx, sum;
+  rowStats(pos.x, pos.y, mx, sum);
+  fragmentColor0 = mx;
+  fragmentColor1 = sum;
+#else
+  fragmentColor0 = vec4(channelStats(pos), 0.0, 0.0);
+#endif
+}
@@ -12,9 +12,9 @@
 // FIXME (mw) large dilation steps !
 
 void main(void) {
-  procAndSet(textureOffset(inputLayer,texCoord,ivec2(-DILATION,0)),0);
+  procAndSet(textureOffset(inputLayer,texCoord,ivec2(-DILATION_X,0)),0);
   procAndAdd(texture(inputLayer,texCoord),1);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( DILATION,0)),2);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( DILATION_X,0)),2);
 #ifdef USE_RESIDUAL
   if (addResidual>0) handleResidual();
 #endif  // USE_RESIDUAL
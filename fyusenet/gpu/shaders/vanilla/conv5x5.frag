@@ -12,11 +12,11 @@
 // FIXME (mw) large dilation steps !
 
 void main(void) {
-  procAndSet(textureOffset(inputLayer,texCoord,ivec2(-2*DILATION,0)),0);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-DILATION,0)),1);
+  procAndSet(textureOffset(inputLayer,texCoord,ivec2(-2*DILATION_X,0)),0);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-DILATION_X,0)),1);
   procAndAdd(texture(inputLayer,texCoord),2);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( DILATION,0)),3);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 2*DILATION,0)),4);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( DILATION_X,0)),3);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 2*DILATION_X,0)),4);
 #ifdef USE_RESIDUAL
   if (addResidual>0) handleResidual();
 #endif  // USE_RESIDUAL
@@ -37,15 +37,15 @@ void main(void) {
 #endif
 #endif
   // FIXME (mw) large dilation steps !
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-4*DILATION,0)),0);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-3*DILATION,0)),1);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-2*DILATION,0)),2);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-DILATION,0)),3);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-4*DILATION_X,0)),0);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-3*DILATION_X,0)),1);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-2*DILATION_X,0)),2);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2(-DILATION_X,0)),3);
   procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 0,0)),4);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( DILATION,0)),5);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 2*DILATION,0)),6);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 3*DILATION,0)),7);
-  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 4*DILATION,0)),8);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( DILATION_X,0)),5);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 2*DILATION_X,0)),6);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 3*DILATION_X,0)),7);
+  procAndAdd(textureOffset(inputLayer,texCoord,ivec2( 4*DILATION_X,0)),8);
 #ifdef USE_RESIDUAL
   if (addResidual>0) handleResidual();
 #endif  // USE_RESIDUAL
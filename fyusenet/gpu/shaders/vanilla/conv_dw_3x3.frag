@@ -104,23 +104,23 @@ uniform vec4 batchnorm[NUM_LANES];
 
 vec4 conv3x3(in sampler2D tex,in vec2 tc,in int co) {
   vec4 pix,accu=vec4(0);
-  pix = activate(textureOffset(tex,tc,ivec2(-1,-1)));
+  pix = activate(textureOffset(tex,tc,ivec2(-DILATION_X,-DILATION_Y)));
   accu += pix*coeffs[co++];
-  pix = activate(textureOffset(tex,tc,ivec2( 0,-1)));
+  pix = activate(textureOffset(tex,tc,ivec2( 0,-DILATION_Y)));
   accu += pix*coeffs[co++];
-  pix = activate(textureOffset(tex,tc,ivec2( 1,-1)));
+  pix = activate(textureOffset(tex,tc,ivec2( DILATION_X,-DILATION_Y)));
   accu += pix*coeffs[co++];
-  pix = activate(textureOffset(tex,tc,ivec2(-1,0)));
+  pix = activate(textureOffset(tex,tc,ivec2(-DILATION_X,0)));
   accu += pix*coeffs[co++];
   pix = activate(texture(tex,tc));
   accu += pix*coeffs[co++];
-  pix = activate(textureOffset(tex,tc,ivec2( 1, 0)));
+  pix = activate(textureOffset(tex,tc,ivec2( DILATION_X,0)));
   accu += pix*coeffs[co++];
-  pix = activate(textureOffset(tex,tc,ivec2(-1,1)));
+  pix = activate(textureOffset(tex,tc,ivec2(-DILATION_X, DILATION_Y)));
   accu += pix*coeffs[co++];
-  pix = activate(textureOffset(tex,tc,ivec2( 0,1)));
+  pix = activate(textureOffset(tex,tc,ivec2( 0, DILATION_Y)));
   accu += pix*coeffs[co++];
-  pix = activate(textureOffset(tex,tc,ivec2( 1,1)));
+  pix = activate(textureOffset(tex,tc,ivec2( DILATION_X, DILATION_Y)));
   accu += pix*coeffs[co++];
   return accu;
 }
@@ -69,13 +69,13 @@ void Shallow2DeepLayer::setup() {
 void Shallow2DeepLayer::forward(uint64_t sequence) {
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_BLEND);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glClearColor(0.0f, 0.0f ,0.0f, 0.0f);
-    glViewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::disable(GL_BLEND);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::clearColor(0.0f, 0.0f ,0.0f, 0.0f);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
     framebuffers_.at(0)->bind();
-    glClear(GL_COLOR_BUFFER_BIT);
+    GLState::clear(GL_COLOR_BUFFER_BIT);
     vertexArray_->bind();
     shader_->bind();
     int intexoffset = 0;
@@ -84,11 +84,11 @@ void Shallow2DeepLayer::forward(uint64_t sequence) {
         int quads=0;
         for (int it = 0; it < maxInputTextures_; it++) {
             if (intexoffset >= (int)inputTextures_.size()) break;
-            glActiveTexture(GL_TEXTURE0 + it);
-            glBindTexture(GL_TEXTURE_2D, inputTextures_.at(intexoffset++));
+            GLState::activeTexture(GL_TEXTURE0 + it);
+            GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(intexoffset++));
             quads++;
         }
-        glDrawElements(GL_TRIANGLES,quads*6,GL_UNSIGNED_SHORT,(const GLvoid *)(quadoffset*6*sizeof(short)));
+        GLState::drawElements(GL_TRIANGLES,quads*6,GL_UNSIGNED_SHORT,(const GLvoid *)(quadoffset*6*sizeof(short)));
         quadoffset += quads;
     }
     shader_->unbind();
@@ -0,0 +1,375 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// SoftMax Layer
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstring>
+#include <cassert>
+#include <cfloat>
+#include <algorithm>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "softmaxlayer.h"
+#include "../gl/glexception.h"
+#include "../gl/glinfo.h"
+#include "../common/logging.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @copydoc GPULayerBase::GPULayerBase
+ */
+SoftMaxLayer::SoftMaxLayer(const SoftMaxLayerBuilder & builder, int layerNumber) :
+    GPULayerBase((const GPULayerBuilder &)builder, layerNumber) {
+    if (flags_ & (LayerFlags::RESIDUAL_INPUT | LayerFlags::POST_BATCHNORM)) THROW_EXCEPTION_ARGS(FynException, "This layer does not support residual inputs or batchnorm");
+    axis_ = builder.axis_;
+    log_ = builder.log_;
+    topK_ = builder.topK_;
+    if (topK_ > 0) {
+        if (axis_ != SoftMaxAxis::CHANNEL) THROW_EXCEPTION_ARGS(FynException, "Top-k output is only supported for channel-wise softmax");
+        if (topK_ > MAX_TOPK) THROW_EXCEPTION_ARGS(FynException, "Top-k output supports at most %d entries", MAX_TOPK);
+        if (outputChannels_ != 2*topK_) THROW_EXCEPTION_ARGS(FynException, "Top-k output requires %d output channels, got %d", 2*topK_, outputChannels_);
+    } else {
+        if (outputChannels_ != inputChannels_) THROW_EXCEPTION_ARGS(FynException, "Number of output channels must match number of input channels");
+    }
+    inputSlices_ = (inputChannels_ + PIXEL_PACKING - 1) / PIXEL_PACKING;
+    outputSlices_ = (outputChannels_ + PIXEL_PACKING - 1) / PIXEL_PACKING;
+    if (inputSlices_ > MAX_SLICES) THROW_EXCEPTION_ARGS(FynException, "This layer supports at most %d input channels, use a deep tensor instead", MAX_SLICES*PIXEL_PACKING);
+    maxRenderTargets_ = std::min(GLInfo::getMaximumRecommendedDrawBuffers(), (int)FBO::MAX_DRAWBUFFERS);
+}
+
+
+/**
+ * @copydoc LayerBase::cleanup
+ */
+void SoftMaxLayer::cleanup() {
+    delete vertexArray_;
+    delete vertexBuffer_;
+    delete indexBuffer_;
+    delete statsFBO_;
+    delete mergeFBO_;
+    delete rowSums_;
+    delete sliceSums_;
+    vertexArray_ = nullptr;
+    vertexBuffer_ = nullptr;
+    indexBuffer_ = nullptr;
+    statsFBO_ = nullptr;
+    mergeFBO_ = nullptr;
+    rowSums_ = nullptr;
+    sliceSums_ = nullptr;
+    statsShader_.reset();
+    mergeShader_.reset();
+    statsState_.reset();
+    mergeState_.reset();
+    outputShaders_.clear();
+    outputStates_.clear();
+    GPULayerBase::cleanup();
+}
+
+
+/**
+ * @copydoc LayerBase::setup
+ */
+void SoftMaxLayer::setup() {
+    setupNetworkPolygons();
+    setupShaders();
+    setupFBOs();
+    valid_ = true;
+}
+
+
+/**
+ * @brief Execute layer
+ *
+ * @param sequence Sequence number (\b must be stricly increasing)
+ *
+ * This function performs the actual computation that maps the input data to the output data
+ * for this layer. The supplied \p sequence number \b must be strictly increasing per network run
+ * and may also be used for debugging purposes, in case errors only manifests themselves after a
+ * certain number of computation cycles. It can also be used to keep track of the total number of
+ * inference runs. Internally, it is used to make sure that asynchronously transmitted data is
+ * up-to-date (on PBO reads for example).
+ */
+void SoftMaxLayer::forward(uint64_t sequence) {
+    if (!valid_) THROW_EXCEPTION_ARGS(FynException,"Trying to invoke forward() on invalid layer");
+#ifdef DEBUG
+    int err = glGetError();
+    if (err != GL_NO_ERROR) FNLOGD("HINT: glerror on render entry: 0x%x (%s:%d)[%s]",err,__FILE__,__LINE__,getName().c_str());
+#endif
+    std::lock_guard<std::recursive_mutex> lck(processingLock_);
+    if (outputChanged_) updateFBOs();
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::disable(GL_BLEND);
+    vertexArray_->bind();
+    //---------------------------------------------
+    // Statistics (max / sum of exponentials)
+    //---------------------------------------------
+    statsFBO_->bindWithViewport();
+    statsFBO_->setWriteMask();
+    statsShader_->bind(statsState_.get());
+    bindInputTextures();
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    statsShader_->unbind(true);
+    statsFBO_->unbind();
+    GLuint stats[2] = {statsFBO_->getAttachment(), (rowSums_) ? rowSums_->getHandle() : 0};
+    if (mergeFBO_) {
+        mergeFBO_->bindWithViewport();
+        mergeFBO_->setWriteMask();
+        mergeShader_->bind(mergeState_.get());
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::bindTexture(GL_TEXTURE_2D, stats[0]);
+        GLState::activeTexture(GL_TEXTURE1);
+        GLState::bindTexture(GL_TEXTURE_2D, stats[1]);
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        mergeShader_->unbind(true);
+        mergeFBO_->unbind();
+        stats[0] = mergeFBO_->getAttachment();
+        stats[1] = sliceSums_->getHandle();
+    }
+    //---------------------------------------------
+    // Output, up to maxRenderTargets_ textures at
+    // a time
+    //---------------------------------------------
+    bindInputTextures();
+    GLState::activeTexture(GL_TEXTURE0 + STATS_UNIT);
+    GLState::bindTexture(GL_TEXTURE_2D, stats[0]);
+    GLState::activeTexture(GL_TEXTURE0 + STATS_UNIT + 1);
+    GLState::bindTexture(GL_TEXTURE_2D, stats[1]);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    for (int pass=0; pass < (int)framebuffers_.size(); pass++) {
+        framebuffers_.at(pass)->bind();
+        framebuffers_.at(pass)->setWriteMask();
+        outputShaders_.at(pass)->bind(outputStates_.at(pass).get());
+        GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+        outputShaders_.at(pass)->unbind((pass+1) < (int)framebuffers_.size());
+        framebuffers_.at(pass)->unbind();
+    }
+    vertexArray_->unbind();
+    GLState::activeTexture(GL_TEXTURE0);
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredInputBuffers
+ */
+std::vector<BufferSpec> SoftMaxLayer::getRequiredInputBuffers() const {
+    std::vector<BufferSpec> result;
+    int channel = 0;
+    int rem = inputChannels_;
+    if (rem < PIXEL_PACKING) {
+        // for input textures, we support textures with less than 4 channels (might be from upload)
+        auto format = BufferSpec::formatByChannels(inputChannels_, TEXTURE_TYPE_DEFAULT);
+        result.push_back(BufferSpec(channel++, 0, width_ + 2*inputPadding_, height_ + 2*inputPadding_,
+                                    format.first, format.second, TEXTURE_TYPE_DEFAULT,
+                                    BufferSpec::FUNCTION_SOURCE));
+    } else {
+        while (rem > 0) {
+            result.push_back(BufferSpec(channel++, 0, width_ + 2*inputPadding_, height_ + 2*inputPadding_,
+                                        TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                        BufferSpec::FUNCTION_SOURCE));
+            rem -= PIXEL_PACKING;
+        }
+    }
+    return result;
+}
+
+
+/**
+ * @copydoc LayerBase::getRequiredOutputBuffers
+ */
+std::vector<BufferSpec> SoftMaxLayer::getRequiredOutputBuffers() const {
+    std::vector<BufferSpec> result;
+    BufferSpec::dtype type = TEXTURE_TYPE_DEFAULT;
+    if (topK_ > 0) type = BufferSpec::dtype::FLOAT32;
+    for (int channel=0; channel < outputSlices_; channel++) {
+        result.push_back(BufferSpec(channel, 0, viewport_[0], viewport_[1],
+                                    TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, type,
+                                    BufferSpec::FUNCTION_DEST));
+    }
+    return result;
+}
+
+/*##################################################################################################
+#                               N O N -  P U B L I C  F U N C T I O N S                            #
+##################################################################################################*/
+
+/**
+ * @brief Bind all input textures to consecutive texture units, starting at unit 0
+ */
+void SoftMaxLayer::bindInputTextures() const {
+    for (int i=0; i < inputSlices_; i++) {
+        GLState::activeTexture(GL_TEXTURE0 + i);
+        GLState::bindTexture(GL_TEXTURE_2D, inputTextures_.at(i));
+    }
+}
+
+
+/**
+ * @brief Compile shaders that implement the actual layer functionality
+ *
+ * This function obtains required shaders from the resource system, compiles/caches these shaders
+ * and performs base initializations on them. One output shader is compiled for each output %FBO,
+ * covering the output textures that are attached to it.
+ */
+void SoftMaxLayer::setupShaders() {
+    char preproc[1024] = {0}, line[512];
+    ssize_t mc = (ssize_t)handlePreprocFlags(flags_, preproc, sizeof(preproc)-1);
+    assert(mc > 0);
+    snprintf(line, sizeof(line), "#define FLT_MAX %.8e\n#define IN_CHANNELS %d\n#define IN_SLICES %d\n#define IN_WIDTH %d\n"
+             "#define IN_HEIGHT %d\n#define IN_PAD %d\n#define OUT_PAD %d\n#define STATS_UNIT0 %d\n#define STATS_UNIT1 %d\n",
+             FLT_MAX, inputChannels_, inputSlices_, width_, height_, inputPadding_, outputPadding_, STATS_UNIT, STATS_UNIT+1);
+    strncat(preproc, line, mc);
+    mc -= strlen(line);
+    assert(mc > 0);
+    if (axis_ == SoftMaxAxis::SPATIAL) {
+        strncat(preproc, "#define SPATIAL\n", mc);
+        mc = sizeof(preproc) - 1 - strlen(preproc);
+    }
+    if (log_) {
+        strncat(preproc, "#define LOG_SOFTMAX\n", mc);
+        mc = sizeof(preproc) - 1 - strlen(preproc);
+    }
+    if (topK_ > 0) {
+        snprintf(line, sizeof(line), "#define TOP_K %d\n", topK_);
+        strncat(preproc, line, mc);
+        mc -= strlen(line);
+    }
+    assert(mc > 0);
+    statsShader_ = compileShaderPair("shaders/default.vert", "shaders/softmaxstats.frag", preproc, typeid(this));
+    statsShader_->bindAttributeLocation("attributes0", 0);
+    statsShader_->link();
+    statsState_ = UniformState::makeShared(statsShader_);
+    for (int i=0; i < inputSlices_; i++) {
+        snprintf(line, sizeof(line), "inputLayer%d", i);
+        statsState_->setUniformValue(line, i);
+    }
+    if (axis_ == SoftMaxAxis::SPATIAL) {
+        mergeShader_ = compileShaderPair("shaders/default.vert", "shaders/softmaxmerge.frag", preproc, typeid(this));
+        mergeShader_->bindAttributeLocation("attributes0", 0);
+        mergeShader_->link();
+        mergeState_ = UniformState::makeShared(mergeShader_);
+        mergeState_->setUniformValue("rowMax", 0);
+        mergeState_->setUniformValue("rowSum", 1);
+    }
+    for (int offset=0; offset < outputSlices_; offset += maxRenderTargets_) {
+        char outpreproc[2048];
+        int lanes = std::min(maxRenderTargets_, outputSlices_ - offset);
+        snprintf(outpreproc, sizeof(outpreproc), "%s#define NUM_LANES %d\n#define LANE_OFFSET %d\n", preproc, lanes, offset);
+        programptr shader = compileShaderPair("shaders/default.vert", "shaders/softmax.frag", outpreproc, typeid(this));
+        shader->bindAttributeLocation("attributes0", 0);
+        shader->link();
+        unistateptr state = UniformState::makeShared(shader);
+        for (int i=0; i < inputSlices_; i++) {
+            snprintf(line, sizeof(line), "inputLayer%d", i);
+            state->setUniformValue(line, i);
+        }
+        state->setUniformValue("statsLayer0", STATS_UNIT);
+        state->setUniformValue("statsLayer1", STATS_UNIT+1, true);
+        outputShaders_.push_back(shader);
+        outputStates_.push_back(state);
+    }
+}
+
+
+/**
+ * @brief Setup a proxy polygon that is used to drive the fragment shaders
+ *
+ * All passes of this layer derive the position to compute from the fragment coordinates, a
+ * single quad that covers the whole viewport is therefore used for all of them.
+ */
+void SoftMaxLayer::setupNetworkPolygons() {
+    float quad[4*4] = {-1.f, -1.f, 0.f, 0.f,
+                        1.f, -1.f, 1.f, 0.f,
+                        1.f,  1.f, 1.f, 1.f,
+                       -1.f,  1.f, 0.f, 1.f};
+    GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+    vertexArray_ = new VAO(context_);
+    vertexArray_->bind();
+    vertexBuffer_ = new VBO(context_);
+    vertexArray_->enableArray(0);
+    vertexBuffer_->setBufferData(quad, sizeof(quad), GL_STATIC_DRAW);
+    vertexBuffer_->bind();
+    vertexArray_->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    indexBuffer_ = new IBO(context_);
+    indexBuffer_->setBufferData(indices, sizeof(indices), GL_STATIC_DRAW);
+    indexBuffer_->bind();
+    vertexArray_->unbind();
+}
+
+
+/**
+ * @copydoc GPULayerBase::setupFBOs
+ */
+void SoftMaxLayer::setupFBOs() {
+    if ((int)outputTextures_.size() < outputSlices_) {
+        THROW_EXCEPTION_ARGS(FynException, "Mismatch in output textures (%d) and textures required by render passes (%d)", outputTextures_.size(), outputSlices_);
+    }
+    for (int offset=0; offset < outputSlices_; offset += maxRenderTargets_) {
+        FBO *fbo = new FBO(context_, viewport_[0], viewport_[1], outputTextures_.at(offset));
+        for (int lane=1; (lane < maxRenderTargets_) && (offset + lane < outputSlices_); lane++) {
+            fbo->addTexture(GL_COLOR_ATTACHMENT0 + lane, outputTextures_.at(offset + lane), GL_TEXTURE_2D);
+        }
+        fbo->unbind();
+        framebuffers_.push_back(fbo);
+    }
+    if (axis_ == SoftMaxAxis::SPATIAL) {
+        statsFBO_ = new FBO(context_, inputSlices_, height_, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        rowSums_ = new Texture2D(inputSlices_, height_, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+        statsFBO_->addTexture(GL_COLOR_ATTACHMENT1, *rowSums_);
+        statsFBO_->unbind();
+        mergeFBO_ = new FBO(context_, inputSlices_, 1, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        sliceSums_ = new Texture2D(inputSlices_, 1, opengl::Texture::FLOAT32, PIXEL_PACKING, true);
+        mergeFBO_->addTexture(GL_COLOR_ATTACHMENT1, *sliceSums_);
+        mergeFBO_->unbind();
+    } else {
+        statsFBO_ = new FBO(context_, width_, height_, PIXEL_PACKING, opengl::Texture::FLOAT32);
+        statsFBO_->unbind();
+    }
+    outputChanged_ = false;
+}
+
+
+/**
+ * @copydoc GPULayerBase::updateFBOs
+ */
+void SoftMaxLayer::updateFBOs() {
+    if ((int)outputTextures_.size() < outputSlices_) {
+        THROW_EXCEPTION_ARGS(FynException, "Mismatch in output textures (%d) and textures required by render passes (%d)", outputTextures_.size(), outputSlices_);
+    }
+    for (int pass=0; pass < (int)framebuffers_.size(); pass++) {
+        FBO *fbo = framebuffers_.at(pass);
+        int offset = pass * maxRenderTargets_;
+        fbo->bind();
+        for (int lane=0; (lane < maxRenderTargets_) && (offset + lane < outputSlices_); lane++) {
+            fbo->updateColorAttachment(GL_COLOR_ATTACHMENT0 + lane, outputTextures_.at(offset + lane));
+        }
+        fbo->unbind();
+    }
+    outputChanged_ = false;
+}
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
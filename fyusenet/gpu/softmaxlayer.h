@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// SoftMax Layer (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <vector>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "../gl/gl_sys.h"
+#include "../gl/fbo.h"
+#include "../gl/vbo.h"
+#include "../gl/ibo.h"
+#include "../gl/vao.h"
+#include "../gl/texture.h"
+#include "../gl/uniformstate.h"
+#include "../gl/shaderprogram.h"
+#include "../base/bufferspec.h"
+#include "gpulayerbase.h"
+#include "softmaxlayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+
+/**
+ * @brief Numerically stable softmax / log-softmax layer for shallow tensors
+ *
+ * This is the shallow-tensor counterpart of deep::DeepSoftMaxLayer and uses the same passes and
+ * shader functions, please see the documentation of that class for details. As each slice of 4
+ * channels of a shallow tensor is stored in its own texture and all slices have to be read by
+ * the statistics pass, this layer is limited to #MAX_SLICES input textures.
+ *
+ * @see deep::DeepSoftMaxLayer, SoftMaxLayerBuilder
+ */
+class SoftMaxLayer : public GPULayerBase {
+ public:
+    constexpr static int MAX_SLICES = 8;    //!< Maximum number of input textures (4 channels each)
+    constexpr static int MAX_TOPK = 32;     //!< Maximum number of (index, probability) pairs in top-k mode
+    constexpr static int STATS_UNIT = 8;    //!< First texture unit for the statistics in the output pass
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    SoftMaxLayer(const SoftMaxLayerBuilder & builder, int layerNumber);
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    virtual void setup() override;
+    virtual void cleanup() override;
+    virtual void forward(uint64_t sequence) override;
+    virtual std::vector<BufferSpec> getRequiredInputBuffers() const override;
+    virtual std::vector<BufferSpec> getRequiredOutputBuffers() const override;
+
+ protected:
+    // ------------------------------------------------------------------------
+    // Non-public methods
+    // ------------------------------------------------------------------------
+    void setupNetworkPolygons();
+    virtual void setupFBOs() override;
+    virtual void updateFBOs() override;
+    void setupShaders();
+    void bindInputTextures() const;
+
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    SoftMaxAxis axis_ = SoftMaxAxis::CHANNEL;  //!< Axis along which the softmax is normalized
+    bool log_ = false;                         //!< Indicator that the log-softmax is computed
+    int topK_ = 0;                             //!< Number of (index, probability) pairs to output, 0 for full output
+    int inputSlices_ = 0;                      //!< Number of input textures
+    int outputSlices_ = 0;                     //!< Number of output textures
+    int maxRenderTargets_ = 1;                 //!< Maximum number of output textures that are written in a single pass
+    VAO *vertexArray_ = nullptr;               //!< Vertex array object for the viewport-filling quad that is used for all passes
+    VBO *vertexBuffer_ = nullptr;              //!< Vertex coordinates of the quad
+    IBO *indexBuffer_ = nullptr;               //!< Polygon connectivity of the quad
+    FBO *statsFBO_ = nullptr;                  //!< %FBO for the first pass (per-position or per-row statistics)
+    FBO *mergeFBO_ = nullptr;                  //!< %FBO for the merged per-slice statistics (spatial softmax only)
+    Texture2D *rowSums_ = nullptr;             //!< Second render target of #statsFBO_ (spatial softmax only)
+    Texture2D *sliceSums_ = nullptr;           //!< Second render target of #mergeFBO_ (spatial softmax only)
+    programptr statsShader_;                   //!< Shader for the first pass
+    programptr mergeShader_;                   //!< Shader that merges the per-row statistics (spatial softmax only)
+    std::vector<programptr> outputShaders_;    //!< Shaders for the output passes (one per output %FBO)
+    unistateptr statsState_;                   //!< Uniform-variable state for #statsShader_
+    unistateptr mergeState_;                   //!< Uniform-variable state for #mergeShader_
+    std::vector<unistateptr> outputStates_;    //!< Uniform-variable states for #outputShaders_
+};
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
@@ -0,0 +1,128 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// SoftMax GPU Layer Builder (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <string>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gfxcontextlink.h"
+#include "gpulayerbuilder.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+
+namespace fyusion {
+using namespace opengl;
+namespace fyusenet {
+namespace gpu {
+
+/**
+ * @brief Axis along which a softmax is normalized
+ */
+enum class SoftMaxAxis : uint8_t {
+    CHANNEL = 0,        //!< Normalize over all channels of each spatial position
+    SPATIAL             //!< Normalize over all spatial positions of each channel
+};
+
+
+/**
+ * @brief Templatized anchor for GPU-based softmax layers
+ *
+ * @see SoftMaxLayerBuilder
+ */
+template<typename D = GPULayerBuilderTempl<>>
+struct SoftMaxLayerBuilderTempl : GPULayerBuilderTempl<D> {
+
+    /**
+     * @brief Constructor
+     *
+     * @param name Name to be assigned to the built layer
+     */
+    SoftMaxLayerBuilderTempl(const std::string& name) : GPULayerBuilderTempl<D>(name) {
+        LayerBuilderTempl<D>::type_ = LayerType::SOFTMAX;
+    }
+
+    /**
+     * @brief Select the axis along which the softmax is normalized
+     *
+     * @param ax Axis to normalize over, defaults to SoftMaxAxis::CHANNEL if not set
+     *
+     * @return Reference to builder object
+     */
+    D & axis(SoftMaxAxis ax) {
+        axis_ = ax;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Compute the logarithm of the softmax instead of the softmax itself
+     *
+     * @param enable If set to \c true, the layer computes \f$ x_i - \max_j x_j - \log \sum_j e^{x_j - \max_j x_j} \f$
+     *
+     * @return Reference to builder object
+     */
+    D & logSoftMax(bool enable=true) {
+        log_ = enable;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Only output the \p k most probable channels for each spatial position
+     *
+     * @param k Number of (index, probability) pairs to output per spatial position
+     *
+     * @return Reference to builder object
+     *
+     * Instead of writing the full probability tensor, the layer writes \p k pairs of channel index
+     * and (log-)probability per spatial position, sorted by descending probability. The output
+     * tensor therefore has \f$ 2k \f$ channels in the order <tt>index0, prob0, index1, prob1,...</tt>
+     * and the number of output channels in the layer shape must be set accordingly. This is only
+     * supported for SoftMaxAxis::CHANNEL.
+     */
+    D & topK(int k) {
+        topK_ = k;
+        return *(D *)this;
+    }
+
+    SoftMaxAxis axis_ = SoftMaxAxis::CHANNEL;    //!< Axis to normalize over
+    bool log_ = false;                           //!< Indicator that the log-softmax should be computed
+    int topK_ = 0;                               //!< Number of top-ranked (index, probability) pairs to output, 0 for full output
+};
+
+
+/**
+ * @brief Builder object for GPU-based softmax layers
+ *
+ * This builder parameterizes softmax and log-softmax layers, either normalizing over the channels
+ * of each spatial position (the classifier case) or over the spatial positions of each channel
+ * (for example for heatmaps). Optionally, only the top-k entries of a channel-wise softmax are
+ * written out, which reduces the amount of data that has to be downloaded from the GPU.
+ *
+ * @see deep::DeepSoftMaxLayer, SoftMaxLayer
+ */
+struct SoftMaxLayerBuilder : SoftMaxLayerBuilderTempl<SoftMaxLayerBuilder> {
+
+    /**
+     * @brief Constructor
+     *
+     * @param name Name to be assigned to the built layer
+     */
+    SoftMaxLayerBuilder(const std::string& name) : SoftMaxLayerBuilderTempl<SoftMaxLayerBuilder>(name) {
+    }
+};
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
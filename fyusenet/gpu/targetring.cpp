@@ -0,0 +1,160 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Ring of User-Supplied Download Targets
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cassert>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "targetring.h"
+#include "../gl/pbo.h"
+#include "../gl/glinfo.h"
+#include "../common/fynexception.h"
+
+namespace fyusion {
+namespace fyusenet {
+namespace gpu {
+//-------------------------------------- Global Variables ------------------------------------------
+
+
+//-------------------------------------- Local Definitions -----------------------------------------
+
+
+/*##################################################################################################
+#                                   P U B L I C  F U N C T I O N S                                 #
+##################################################################################################*/
+
+/**
+ * @brief Constructor
+ *
+ * @param context Link to GL context that the download layer operates on
+ * @param buffers List of caller-owned memory regions that make up the ring, must not be empty
+ * @param bytes Size (in bytes) of each memory region in \p buffers
+ * @param order Data order to write into the ring slots, either \c CHANNELWISE for de-tiled output
+ *              or the native GPU order of the download layer for a plain copy
+ * @param notify Optional callback that is invoked when a download into a slot commences/finishes
+ *
+ * @throws FynException on invalid parameters
+ *
+ * @note This does not allocate any GL resources, persistent PBOs are created lazily by
+ *       persistentPBO() from within the GL thread of the download layer.
+ */
+TargetRing::TargetRing(const GfxContextLink& context, const std::vector<void *>& buffers, size_t bytes,
+                       BufferSpec::order order, const callback& notify) :
+      buffers_(buffers), bytes_(bytes), order_(order), notify_(notify) {
+    if (buffers.empty()) THROW_EXCEPTION_ARGS(FynException, "Empty target ring supplied");
+    for (void * buf : buffers) {
+        if (!buf) THROW_EXCEPTION_ARGS(FynException, "Null pointer in target ring");
+    }
+    setContext(context);
+    pbos_.resize(buffers.size(), nullptr);
+    mapped_.resize(buffers.size(), nullptr);
+    sequences_.resize(buffers.size(), 0);
+    used_.resize(buffers.size(), false);
+    persistent_ = opengl::GLInfo::supportsPersistentMapping();
+}
+
+
+/**
+ * @brief Destructor
+ *
+ * @pre release() has been called from a thread with the GL context of this ring
+ */
+TargetRing::~TargetRing() {
+#ifdef DEBUG
+    for (const opengl::PBO * pbo : pbos_) assert(pbo == nullptr);
+#endif
+}
+
+
+/**
+ * @brief Advance ring to the next slot
+ *
+ * @param sequenceNo Sequence number of the download that will use the slot
+ * @param[out] previous Optional pointer that receives the sequence number of the last download
+ *                      that used the returned slot, set to ~0 if the slot has not been used yet
+ *
+ * @return Ring slot index to be used for the download
+ *
+ * Download layers use the \p previous sequence number to wait for a (potentially) pending readout
+ * on the same slot before re-using it.
+ */
+int TargetRing::next(uint64_t sequenceNo, uint64_t *previous) {
+    int slot = next_;
+    next_ = (next_ + 1) % (int)buffers_.size();
+    if (previous) *previous = (used_[slot]) ? sequences_[slot] : ~(uint64_t)0;
+    sequences_[slot] = sequenceNo;
+    used_[slot] = true;
+    return slot;
+}
+
+
+/**
+ * @brief Obtain persistently-mapped %PBO for a ring slot
+ *
+ * @param slot Ring slot index
+ * @param width Width of the %PBO (in pixels), must match the FBO that is read from
+ * @param height Height of the %PBO (in pixels), must match the FBO that is read from
+ * @param channels Total number of channels in the %PBO
+ * @param bytesPerChan Number of bytes per channel
+ *
+ * @return Pointer to %PBO that is persistently mapped or \c nullptr if persistent mapping is not
+ *         supported on this system
+ *
+ * @pre Calling thread has the GL context of this ring current (or one that is shared with it)
+ *
+ * The %PBO is created and mapped on first use of the slot and stays mapped until release() is
+ * called.
+ */
+opengl::PBO * TargetRing::persistentPBO(int slot, int width, int height, int channels, int bytesPerChan) {
+    using namespace opengl;
+    if (!persistent_) return nullptr;
+    if (!pbos_.at(slot)) {
+        PBO * pbo = new PBO(width, height, channels, bytesPerChan, context_);
+        size_t size = (size_t)width * height * channels * bytesPerChan;
+        pbo->prepareForPersistentRead(size);
+        pbo->bind(GL_PIXEL_PACK_BUFFER);
+        mapped_[slot] = pbo->mapPersistentReadBuffer();
+        pbo->unbind(GL_PIXEL_PACK_BUFFER);
+        if (!mapped_[slot]) {
+            delete pbo;
+            THROW_EXCEPTION_ARGS(FynException, "Cannot persistently map PBO for target ring slot %d", slot);
+        }
+        pbos_[slot] = pbo;
+    }
+    return pbos_[slot];
+}
+
+
+/**
+ * @brief Release GL resources held by the ring
+ *
+ * @pre Calling thread has the GL context of this ring current (or one that is shared with it)
+ *
+ * Unmaps and deletes all persistent PBOs of the ring. Subsequent downloads will lazily re-create
+ * them.
+ */
+void TargetRing::release() {
+    for (int i=0; i < (int)pbos_.size(); i++) {
+        if (pbos_[i]) {
+            pbos_[i]->bind(GL_PIXEL_PACK_BUFFER);
+            pbos_[i]->unmapReadBuffer();
+            pbos_[i]->unbind(GL_PIXEL_PACK_BUFFER);
+            delete pbos_[i];
+            pbos_[i] = nullptr;
+            mapped_[i] = nullptr;
+        }
+    }
+}
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
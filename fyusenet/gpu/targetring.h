@@ -0,0 +1,148 @@
+//--------------------------------------------------------------------------------------------------
+// FyuseNet                                                               (c) Fyusion Inc. 2016-2022
+//--------------------------------------------------------------------------------------------------
+// Ring of User-Supplied Download Targets (Header)
+// Creator: agent
+// SPDX-License-Identifier: MIT
+//--------------------------------------------------------------------------------------------------
+
+#pragma once
+
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------- System Headers -------------------------------------------
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+//-------------------------------------- Project  Headers ------------------------------------------
+
+#include "gfxcontexttracker.h"
+#include "../base/asynclayerinterface.h"
+#include "../base/bufferspec.h"
+
+//------------------------------------- Public Declarations ----------------------------------------
+
+namespace fyusion {
+
+namespace opengl {
+  class PBO;
+}
+
+namespace fyusenet {
+namespace gpu {
+
+/**
+ * @brief Ring of caller-owned memory regions that serve as download destinations
+ *
+ * Download layers usually copy the data from a %PBO into a layer-owned CPUBuffer, which in turn
+ * is copied by the API user into its own memory. A TargetRing replaces the CPUBuffer by a set of
+ * memory regions that are owned by the caller. Each download is assigned to the next region in
+ * the ring (round-robin) and the download layer copies (and de-tiles) the data from the mapped
+ * %PBO directly into that region.
+ *
+ * On systems that support persistent buffer mapping (see GLInfo::supportsPersistentMapping()),
+ * the ring also maintains one persistently-mapped %PBO per ring slot, such that no map/unmap
+ * cycle is required on each download. On other systems, the download layers fall back to pooled
+ * PBOs which are mapped for each readout.
+ *
+ * It is the responsibility of the caller to not modify a ring slot while a download into that
+ * slot is in progress and to consume the data in a slot before the ring wraps around to it again.
+ * The optional callback reports the slot address along with the sequence number.
+ *
+ * @see DownloadLayer::setTargetRing(), deep::DeepDownloadLayer::setTargetRing()
+ */
+class TargetRing : public GfxContextTracker {
+ public:
+    /**
+     * Callback type for notification about download progress into a ring slot
+     */
+    using callback = std::function<void(uint64_t, void *, AsyncLayer::state)>;
+
+    // ------------------------------------------------------------------------
+    // Constructor / Destructor
+    // ------------------------------------------------------------------------
+    TargetRing(const GfxContextLink& context, const std::vector<void *>& buffers, size_t bytes,
+               BufferSpec::order order, const callback& notify = callback());
+    virtual ~TargetRing();
+
+    // ------------------------------------------------------------------------
+    // Public methods
+    // ------------------------------------------------------------------------
+    int next(uint64_t sequenceNo, uint64_t *previous = nullptr);
+    opengl::PBO * persistentPBO(int slot, int width, int height, int channels, int bytesPerChan);
+    void release();
+
+    /**
+     * @brief Retrieve (caller-owned) memory for a ring slot
+     *
+     * @param slot Ring slot index
+     *
+     * @return Pointer to caller-supplied memory region for the slot
+     */
+    void * buffer(int slot) const {
+        return buffers_.at(slot);
+    }
+
+    /**
+     * @brief Retrieve mapped memory of the persistent %PBO of a ring slot
+     *
+     * @param slot Ring slot index
+     *
+     * @return Pointer to mapped %PBO memory or \c nullptr if the slot has no persistent %PBO
+     */
+    const void * mapped(int slot) const {
+        return mapped_.at(slot);
+    }
+
+    /**
+     * @brief Get size of each ring slot
+     *
+     * @return Number of bytes available in each ring slot
+     */
+    size_t bytes() const {
+        return bytes_;
+    }
+
+    /**
+     * @brief Get data order that is to be written into the ring slots
+     *
+     * @return Data order for the ring slots
+     */
+    BufferSpec::order order() const {
+        return order_;
+    }
+
+    /**
+     * @brief Invoke user-supplied callback for a ring slot
+     *
+     * @param sequenceNo Sequence number of the download
+     * @param slot Ring slot index
+     * @param state Download state to report
+     */
+    void notify(uint64_t sequenceNo, int slot, AsyncLayer::state state) const {
+        if (notify_) notify_(sequenceNo, buffers_.at(slot), state);
+    }
+
+ private:
+    // ------------------------------------------------------------------------
+    // Member variables
+    // ------------------------------------------------------------------------
+    std::vector<void *> buffers_;                   //!< Caller-owned memory regions, one per ring slot
+    std::vector<opengl::PBO *> pbos_;               //!< Persistently mapped PBOs, one per ring slot (or \c nullptr)
+    std::vector<void *> mapped_;                    //!< Mapped memory of #pbos_
+    std::vector<uint64_t> sequences_;               //!< Sequence number of the last download into each slot
+    std::vector<bool> used_;                        //!< Indicator if a slot has been used before
+    size_t bytes_ = 0;                              //!< Size of each ring slot (in bytes)
+    int next_ = 0;                                  //!< Next ring slot to be used
+    bool persistent_ = false;                       //!< Indicator if persistent mapping is to be used
+    BufferSpec::order order_ = BufferSpec::order::CHANNELWISE;  //!< Data order to write into the slots
+    callback notify_;                               //!< Optional user callback
+};
+
+} // gpu namespace
+} // fyusenet namespace
+} // fyusion namespace
+
+// vim: set expandtab ts=4 sw=4:
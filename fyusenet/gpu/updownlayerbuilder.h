@@ -113,6 +113,82 @@ struct UpDownLayerBuilderTempl : GPULayerBuilderTempl<D> {
     }
 #endif
 
+    /**
+     * @brief Transfer data as 16-bit floating-point between CPU and GPU
+     *
+     * @return Reference to builder after assignment
+     *
+     * The data on the CPU remains 32-bit floating-point, but it is converted to/from half-precision
+     * on the CPU (in the background threads for asynchronous layers) and transferred to/from the GPU
+     * as \c GL_HALF_FLOAT. This halves the bus bandwidth required for the transfer. As the textures
+     * on the GPU are usually stored in half-precision anyway, there is no loss in precision
+     * for regular (non high-precision) builds.
+     *
+     * @note On upload layers, staging buffers (see UploadLayer::acquireStagingBuffer()) must be
+     *       filled with half-precision data when using this option.
+     *
+     * @note On GLES systems that cannot read half-precision data from the framebuffer, download
+     *       layers fall back to 32-bit transfers.
+     */
+    D & fp16Transfer() {
+        fp16Transfer_ = true;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Normalize uploaded 8-bit image data on the GPU
+     *
+     * @param mean Per-channel mean values to subtract, in byte units (e.g. 123.675 for red)
+     * @param stddev Per-channel standard deviation to divide by, in byte units (e.g. 58.395 for red)
+     *
+     * @return Reference to builder after assignment
+     *
+     * Applies \f$ y = (x - \mu) / \sigma \f$ for each channel as part of the upload, where
+     * \f$ x \f$ is the original byte value. Either one value for all channels or one value per
+     * channel must be supplied. The channel order refers to the order \e after an optional
+     * red/blue swap, see swapRB().
+     *
+     * @note Only supported on (synchronous) upload layers with \c UBYTE data type and 3 or 4 channels
+     */
+    D & normalize(const std::vector<float>& mean, const std::vector<float>& stddev) {
+        mean_ = mean;
+        stddev_ = stddev;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Swap red and blue channels of uploaded 8-bit image data on the GPU
+     *
+     * @return Reference to builder after assignment
+     *
+     * Replaces a separate RGB2BGRLayer after the upload by a swizzle inside the upload pass.
+     *
+     * @note Only supported on (synchronous) upload layers with \c UBYTE data type and 3 or 4 channels
+     */
+    D & swapRB() {
+        swapRB_ = true;
+        return *(D *)this;
+    }
+
+    /**
+     * @brief Set size of the uploaded 8-bit image when it differs from the layer size
+     *
+     * @param width Width of the image data supplied to the upload layer
+     * @param height Height of the image data supplied to the upload layer
+     *
+     * @return Reference to builder after assignment
+     *
+     * The uploaded image is resized to the layer size (as set by shape()) using bilinear
+     * interpolation as part of the upload pass.
+     *
+     * @note Only supported on (synchronous) upload layers with \c UBYTE data type and 3 or 4 channels
+     */
+    D & sourceSize(int width, int height) {
+        sourceWidth_ = width;
+        sourceHeight_ = height;
+        return *(D *)this;
+    }
+
     dir direction_;                 //!< Data direction (either upload to GPU or download from GPU)
 #ifdef FYUSENET_MULTITHREADING
     bool async_ = false;            //!< Whether or not the layer should be working asynchronously (default is synchronous)
@@ -135,6 +211,13 @@ struct UpDownLayerBuilderTempl : GPULayerBuilderTempl<D> {
      * Datatype <i>on the CPU</i> to be used for the upload/download operation (defaults to 32-bit float)
      */
     BufferSpec::dtype dataType_ = BufferSpec::FLOAT;
+
+    bool fp16Transfer_ = false;     //!< Whether or not to transfer data as half-precision floating-point, see fp16Transfer()
+    std::vector<float> mean_;       //!< Per-channel mean for normalization on upload (in byte units), see normalize()
+    std::vector<float> stddev_;     //!< Per-channel standard deviation for normalization on upload (in byte units), see normalize()
+    bool swapRB_ = false;           //!< Whether or not to swap red and blue channels on upload, see swapRB()
+    int sourceWidth_ = 0;           //!< Width of uploaded image data (0 for layer width), see sourceSize()
+    int sourceHeight_ = 0;          //!< Height of uploaded image data (0 for layer height), see sourceSize()
 };
 
 
@@ -15,6 +15,8 @@
 //-------------------------------------- Project  Headers ------------------------------------------
 
 #include "uploadlayer.h"
+#include "../gl/fbo.h"
+#include "floatconversion.h"
 #ifdef FYUSENET_MULTITHREADING
 #include "../gl/asyncpool.h"
 #endif
@@ -60,6 +62,46 @@ UploadLayer::UploadLayer(const UpDownLayerBuilder& builder, int layerNumber) :
             bytesPerChan_ = 1;
             break;
     }
+    transferType_ = dataType_;
+    if (builder.fp16Transfer_) {
+        if (dataType_ != BufferSpec::FLOAT) THROW_EXCEPTION_ARGS(FynException, "Half-precision transfer requires 32-bit float data (layer %s)", getName().c_str());
+        transferType_ = BufferSpec::FLOAT16;
+        bytesPerChan_ = 2;
+    }
+    sourceWidth_ = width_ + 2 * inputPadding_;
+    sourceHeight_ = height_ + 2 * inputPadding_;
+    //------------------------------------------------------------
+    // Check for fused preprocessing of 8-bit image data...
+    //------------------------------------------------------------
+    preprocess_ = (!builder.mean_.empty()) || (!builder.stddev_.empty()) || (builder.swapRB_) ||
+                  (builder.sourceWidth_ > 0) || (builder.sourceHeight_ > 0);
+    if (preprocess_) {
+        if (dataType_ != BufferSpec::UBYTE) THROW_EXCEPTION_ARGS(FynException, "Preprocessing on upload requires 8-bit data (layer %s)", getName().c_str());
+        if ((inputChannels_ < 3) || (inputChannels_ > PIXEL_PACKING)) THROW_EXCEPTION_ARGS(FynException, "Preprocessing on upload requires 3 or 4 channels, got %d (layer %s)", inputChannels_, getName().c_str());
+        if (builder.mean_.size() != builder.stddev_.size()) THROW_EXCEPTION_ARGS(FynException, "Mean and stddev must have the same size (layer %s)", getName().c_str());
+        if ((builder.mean_.size() > 1) && ((int)builder.mean_.size() != inputChannels_)) {
+            THROW_EXCEPTION_ARGS(FynException, "Normalization requires 1 or %d values, got %d (layer %s)", inputChannels_, (int)builder.mean_.size(), getName().c_str());
+        }
+#ifdef FYUSENET_MULTITHREADING
+        if (async_) THROW_EXCEPTION_ARGS(FynException, "Preprocessing on upload is not supported for asynchronous layers (yet)");
+#endif
+        swapRB_ = builder.swapRB_;
+        sourceWidth_ = (builder.sourceWidth_ > 0) ? builder.sourceWidth_ : width_;
+        sourceHeight_ = (builder.sourceHeight_ > 0) ? builder.sourceHeight_ : height_;
+        // texture values are normalized to 0..1, fold the byte scaling into the normalization
+        for (int i=0; i < inputChannels_; i++) {
+            if (builder.mean_.empty()) {
+                scale_[i] = 1.0f;
+                bias_[i] = 0.0f;
+            } else {
+                float mean = builder.mean_.at((builder.mean_.size() > 1) ? i : 0);
+                float std = builder.stddev_.at((builder.stddev_.size() > 1) ? i : 0);
+                if (std == 0.0f) THROW_EXCEPTION_ARGS(FynException, "Zero stddev supplied for channel %d (layer %s)", i, getName().c_str());
+                scale_[i] = 255.0f / std;
+                bias_[i] = -mean / std;
+            }
+        }
+    }
 }
 
 
@@ -74,7 +116,16 @@ UploadLayer::~UploadLayer() {
  * @copydoc LayerBase::setup
  */
 void UploadLayer::setup() {
-    // empty on purpose
+    if (preprocess_) {
+        setupPreprocessing();
+        setupFBOs();
+    }
+#ifdef FYUSENET_MULTITHREADING
+    PBOPool * pool = context_.interface()->getWritePBOPool();
+    if ((async_) && (pool) && (pool->preallocation())) {
+        pool->reserve(sourceWidth_, sourceHeight_, inputChannels_, bytesPerChan_, 2, PBO::WRITE);
+    }
+#endif
 }
 
 
@@ -82,7 +133,17 @@ void UploadLayer::setup() {
  * @copydoc LayerBase::cleanup
  */
 void UploadLayer::cleanup() {
-    // empty on purpose
+    if (vertexBuffer_) delete vertexBuffer_;
+    if (indexBuffer_) delete indexBuffer_;
+    if (vertexArray_) delete vertexArray_;
+    vertexBuffer_ = nullptr;
+    indexBuffer_ = nullptr;
+    vertexArray_ = nullptr;
+    if (!sourceTextures_.empty()) GLState::deleteTextures((GLsizei)sourceTextures_.size(), sourceTextures_.data());
+    sourceTextures_.clear();
+    imageShader_.reset();
+    imageState_.reset();
+    GPULayerBase::cleanup();
 }
 
 
@@ -90,7 +151,7 @@ void UploadLayer::cleanup() {
  * @copydoc LayerBase::forward
  */
 void UploadLayer::forward(uint64_t sequence) {
-    if (!input_) THROW_EXCEPTION_ARGS(FynException,"No input buffer set for upload");
+    if (!hasPendingInput()) THROW_EXCEPTION_ARGS(FynException,"No input buffer set for upload");
     if ((dataType_ != BufferSpec::FLOAT) && (dataType_ != BufferSpec::UBYTE)) {
         THROW_EXCEPTION_ARGS(FynException, "Currently only 32-bit float and 8-bit uint are supported");
     }
@@ -99,7 +160,21 @@ void UploadLayer::forward(uint64_t sequence) {
 #else
     if (!async_) {
 #endif
-        syncUpload();
+        const std::vector<GLuint> & targets = (preprocess_) ? sourceTextures_ : outputTextures_;
+        ManagedPBO pbo;
+        {
+#ifdef FYUSENET_MULTITHREADING
+            // NOTE staging buffers may be committed from a different thread
+            std::lock_guard<std::mutex> lck(asyncLock_);
+#endif
+            if (!staged_.empty()) {
+                pbo = staged_.front();
+                staged_.pop_front();
+            }
+        }
+        if (pbo.isValid()) pboToTextures(pbo, targets);
+        else syncUpload(targets);
+        if (preprocess_) preprocess();
     } else {        
 #ifdef FYUSENET_MULTITHREADING
         THROW_EXCEPTION_ARGS(FynException, "Please use asyncForward() for asynchronous upload layers (%s)", getName().c_str());
@@ -126,7 +201,7 @@ void UploadLayer::forward(uint64_t sequence) {
  * @see asyncUpload()
  */
 bool UploadLayer::asyncForward(uint64_t sequence, const std::function<void (uint64_t)> &engineCallback) {
-    if (!input_) THROW_EXCEPTION_ARGS(FynException,"No input buffer set for upload");
+    if (!hasPendingInput()) THROW_EXCEPTION_ARGS(FynException,"No input buffer set for upload");
     if ((dataType_ != BufferSpec::FLOAT) && (dataType_ != BufferSpec::UBYTE)) {
         THROW_EXCEPTION_ARGS(FynException, "Currently only 32-bit float and 8-bit uint are supported");
     }
@@ -141,6 +216,12 @@ bool UploadLayer::asyncForward(uint64_t sequence, const std::function<void (uint
  * @copydoc GPULayerBase::updateFBOs
  */
 void UploadLayer::updateFBOs() {
+    if ((preprocess_) && (!framebuffers_.empty())) {
+        FBO * fbo = framebuffers_.at(0);
+        fbo->bind();
+        fbo->updateColorAttachment(GL_COLOR_ATTACHMENT0, outputTextures_.at(0));
+        fbo->unbind();
+    }
     outputChanged_ = false;
 }
 
@@ -242,6 +323,116 @@ void UploadLayer::clearInputBuffers(int port) {
 }
 
 
+/**
+ * @brief Obtain writable pointer to %PBO memory that serves as input for the next upload
+ *
+ * @param[out] bytes Optional pointer to variable that receives the size of the writable area (in bytes)
+ *
+ * @return Pointer to mapped %PBO memory that can be written to by the caller
+ *
+ * @pre A GL context that shares its objects with the context of this layer must be current to
+ *      the calling thread
+ *
+ * @throws FynException in case a staging buffer has already been acquired and was not committed
+ *         yet, or if the %PBO could not be mapped
+ *
+ * This function fetches a %PBO from the write-pool of the context, maps it into memory and returns
+ * a pointer to the mapped memory. The caller is supposed to write the input data directly into
+ * that memory, using the same format that would be used for an input CPUBuffer (see
+ * getRequiredInputBuffers()), and then call commitStagingBuffer(). This avoids copying the
+ * data twice, once into the CPUBuffer and once more from the CPUBuffer into the %PBO. For layers
+ * that use half-precision transfers, the data must be written as 16-bit floating-point values.
+ *
+ * @note If the pool has no free %PBO, this function will block until one becomes available.
+ *
+ * @see commitStagingBuffer(), stagingBytes()
+ */
+void * UploadLayer::acquireStagingBuffer(size_t * bytes) {
+    if ((dataType_ != BufferSpec::FLOAT) && (dataType_ != BufferSpec::UBYTE)) {
+        THROW_EXCEPTION_ARGS(FynException, "Currently only 32-bit float and 8-bit uint are supported");
+    }
+    {
+#ifdef FYUSENET_MULTITHREADING
+        std::lock_guard<std::mutex> lck(asyncLock_);
+#endif
+        if (acquired_.isValid()) THROW_EXCEPTION_ARGS(FynException, "Staging buffer for layer %s was already acquired", getName().c_str());
+    }
+    size_t totalsize = stagingBytes();
+    PBOPool *pool = context_.interface()->getWritePBOPool();
+    assert(pool);
+    // NOTE we do not hold the lock while waiting on the pool, as the pool may be waiting for our upload threads
+    ManagedPBO pbo = pool->getAvailablePBO(sourceWidth_, sourceHeight_, inputChannels_, bytesPerChan_);
+    pbo->prepareForWrite(totalsize, true);
+    void * ptr = pbo->mapWriteBuffer(totalsize);
+    if (!ptr) {
+        pbo->unbind(GL_PIXEL_UNPACK_BUFFER);
+        THROW_EXCEPTION_ARGS(FynException, "Cannot map staging PBO for layer %s", getName().c_str());
+    }
+#ifdef FYUSENET_MULTITHREADING
+    std::lock_guard<std::mutex> lck(asyncLock_);
+#endif
+    acquired_ = pbo;
+    if (bytes) *bytes = totalsize;
+    return ptr;
+}
+
+
+/**
+ * @brief Commit a previously acquired staging buffer for upload
+ *
+ * @pre acquireStagingBuffer() has been called before and the same GL context (or a context sharing
+ *      its objects) is current to the calling thread
+ *
+ * @throws FynException if no staging buffer was acquired
+ *
+ * This function unmaps the %PBO that was obtained by acquireStagingBuffer() and enqueues it
+ * as input for the next run of this layer. Committed staging buffers are consumed in the order
+ * they were committed and take precedence over an input CPUBuffer that may have been assigned
+ * to this layer.
+ *
+ * @see acquireStagingBuffer()
+ */
+void UploadLayer::commitStagingBuffer() {
+#ifdef FYUSENET_MULTITHREADING
+    std::lock_guard<std::mutex> lck(asyncLock_);
+#endif
+    if (!acquired_.isValid()) THROW_EXCEPTION_ARGS(FynException, "No staging buffer acquired for layer %s", getName().c_str());
+    acquired_->unmapWriteBuffer();
+    acquired_->unbind(GL_PIXEL_UNPACK_BUFFER);
+#ifdef FYUSENET_MULTITHREADING
+    // make sure the PBO content is visible to the (shared) upload contexts
+    if (async_) glFlush();
+#endif
+    staged_.push_back(acquired_);
+    acquired_ = ManagedPBO();
+}
+
+
+/**
+ * @brief Check if there is input data available for the next run of this layer
+ *
+ * @retval true if either an input CPUBuffer was set or a staging buffer was committed
+ * @retval false otherwise
+ */
+bool UploadLayer::hasPendingInput() const {
+#ifdef FYUSENET_MULTITHREADING
+    std::lock_guard<std::mutex> lck(asyncLock_);
+#endif
+    return (input_ != nullptr) || (!staged_.empty());
+}
+
+
+/**
+ * @brief Retrieve number of bytes required to hold the input data for a single upload
+ *
+ * @return Number of bytes for a single input (including padding), using the data type of the
+ *         transfer to the GPU
+ */
+size_t UploadLayer::stagingBytes() const {
+    return (size_t)sourceWidth_ * (size_t)sourceHeight_ * inputChannels_ * bytesPerChan_;
+}
+
+
 
 /**
  * @brief Obtain buffer specifiers that are required as input for this layer
@@ -254,12 +445,14 @@ void UploadLayer::clearInputBuffers(int port) {
  * buffer shapes. In particular that means that if you want to upload a buffer that has more than
  * 4 channels, the data will have to be arranged in \e shallow GPU order, which in cases of
  * channels >=4 aggregates 4 channels in a single element (think of it as RGBA, which it is).
+ * When preprocessing 8-bit image data, the buffer has the size of the source image and does not
+ * include any padding.
  *
  * @see BufferSpec
  */
 std::vector<BufferSpec> UploadLayer::getRequiredInputBuffers() const {
     std::vector<BufferSpec> result;
-    result.push_back(BufferSpec(0, 0, width_ + 2*outputPadding_, height_ + 2*outputPadding_,
+    result.push_back(BufferSpec(0, 0, sourceWidth_, sourceHeight_,
                                 BufferSpec::SINGLE32F, BufferSpec::SINGLE, dataType_, BufferSpec::CPU_SOURCE,
                                 inputChannels_).device(BufferSpec::COMP_STOR_CPU).dataOrder(BufferSpec::order::GPU_SHALLOW));
     return result;
@@ -274,7 +467,12 @@ std::vector<BufferSpec> UploadLayer::getRequiredOutputBuffers() const {
     int rem = inputChannels_;
     int channelidx = 0;
     // FIXME (mw) this function will create problems when uploading channel data that is >4 and not a multiple of 4
-    if (rem < PIXEL_PACKING) {
+    if (preprocess_) {
+        // preprocessed data is rendered, GLES cannot render to RGB textures
+        result.push_back(BufferSpec(channelidx++, 0, viewport_[0], viewport_[1],
+                                    TEXTURE_IFORMAT_4, TEXTURE_FORMAT_4, TEXTURE_TYPE_DEFAULT,
+                                    BufferSpec::FUNCTION_DEST));
+    } else if (rem < PIXEL_PACKING) {
         auto format = BufferSpec::formatByChannels(inputChannels_, TEXTURE_TYPE_DEFAULT);
         result.push_back(BufferSpec(channelidx++, 0, width_+2*inputPadding_, height_+2*inputPadding_,
                                     format.first, format.second, TEXTURE_TYPE_DEFAULT,
@@ -343,39 +541,176 @@ void UploadLayer::unlock(uint64_t sequenceNo) {
 ##################################################################################################*/
 
 /**
- * @brief Setup %FBO instances to operate this layer (empty)
+ * @brief Setup %FBO instances to operate this layer
  *
- * As this layer does not require any %FBO to operate, this function is idle.
+ * This layer only requires an %FBO when preprocessing 8-bit image data, in which case a single
+ * %FBO that renders into the output texture is created. Otherwise this function is idle.
  */
 void UploadLayer::setupFBOs() {
+    if (preprocess_) {
+        FBO * fbo = new FBO(context_, viewport_[0], viewport_[1], outputTextures_.at(0));
+        fbo->unbind();
+        framebuffers_.push_back(fbo);
+    }
+    outputChanged_ = false;
+}
+
+
+/**
+ * @brief Setup GL resources for the preprocessing pass on 8-bit image data
+ *
+ * @pre OpenGL context that is to be used for rendering must be current to the calling thread
+ *
+ * Creates the intermediate 8-bit source texture, the proxy polygon that covers the unpadded part
+ * of the output texture and the shader that performs normalization and channel swapping.
+ * Resizing is done implicitly by the (bilinear) texture sampler.
+ */
+void UploadLayer::setupPreprocessing() {
+    //------------------------------------------------------------
+    // Intermediate texture for the raw image data...
+    //------------------------------------------------------------
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    GLState::bindTexture(GL_TEXTURE_2D, tex);
+    GLint interp = ((sourceWidth_ == width_) && (sourceHeight_ == height_)) ? GL_NEAREST : GL_LINEAR;
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, interp);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, interp);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    sourceTextures_.push_back(tex);
+    //------------------------------------------------------------
+    // Proxy polygon, covers the output without the padding and
+    // the full source texture...
+    //------------------------------------------------------------
+    float posleft = -1.0f + ((float) (2 * outputPadding_) / (float) viewport_[0]);
+    float posright = 1.0f - ((float) (2 * outputPadding_) / (float) viewport_[0]);
+    float postop = -1.0f + ((float) (2 * outputPadding_) / (float) viewport_[1]);
+    float posbottom = 1.0f - ((float) (2 * outputPadding_) / (float) viewport_[1]);
+    float vertices[4*4] = {posleft, postop, 0.0f, 0.0f,
+                           posleft, posbottom, 0.0f, 1.0f,
+                           posright, posbottom, 1.0f, 1.0f,
+                           posright, postop, 1.0f, 0.0f};
+    GLshort indices[6] = {0, 1, 2, 0, 2, 3};
+    vertexArray_ = new VAO(context_);
+    vertexArray_->bind();
+    vertexBuffer_ = new VBO(context_);
+    vertexArray_->enableArray(0);
+    vertexBuffer_->setBufferData(vertices, sizeof(vertices), GL_STATIC_DRAW);
+    vertexBuffer_->bind();
+    vertexArray_->setVertexAttributeBuffer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    indexBuffer_ = new IBO(context_);
+    indexBuffer_->setBufferData(indices, 6 * sizeof(GLshort), GL_STATIC_DRAW);
+    indexBuffer_->bind();
+    vertexArray_->unbind();
+    //------------------------------------------------------------
+    // Shader...
+    //------------------------------------------------------------
+    imageShader_ = compileShaderPair("shaders/default.vert", "shaders/imgnorm.frag", (swapRB_) ? "#define SWAP_RB\n" : "", typeid(this));
+    try {
+        imageShader_->bindAttributeLocation("attributes0", 0);
+        imageShader_->link();
+    } catch (GLException& ex) {
+        FNLOGE("Cannot link shader for layer %s", getName().c_str());
+        throw;
+    }
+    imageState_ = UniformState::makeShared(imageShader_);
+    imageState_->setUniformValue("inputLayer0", 0);
+    imageState_->setUniformVec4("scale", scale_[0], scale_[1], scale_[2], scale_[3]);
+    imageState_->setUniformVec4("bias", bias_[0], bias_[1], bias_[2], bias_[3]);
+}
+
+
+/**
+ * @brief Run preprocessing pass on uploaded 8-bit image data
+ *
+ * Renders the content of the intermediate source texture into the output texture, applying
+ * normalization, channel swap and resizing in a single pass. The padding area of the output
+ * texture is cleared to zero.
+ */
+void UploadLayer::preprocess() {
+    prepareRender(false, false);
+    vertexArray_->bind();
+    FBO * fbo = framebuffers_.at(0);
+    fbo->bind();
+    fbo->setWriteMask();
+    GLState::clear(GL_COLOR_BUFFER_BIT);
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, sourceTextures_.at(0));
+    imageShader_->bind(imageState_.get());
+    GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+    imageShader_->unbind();
+    fbo->unbind();
+    vertexArray_->unbind();
 }
 
 
 /**
  * @brief Upload input CPU buffer to texture(s)
  *
+ * @param textures Target textures to upload the data to
+ *
  * This functionn use <a href="https://registry.khronos.org/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml">glTexImage2D</a>
  * directly on the CPU buffers to (synchronously) update texture data to the GPU.
  */
-void UploadLayer::syncUpload() {
+void UploadLayer::syncUpload(const std::vector<GLuint>& textures) {
     int rem = inputChannels_;
     int texoffs = 0;
-    int width = width_ + 2 * inputPadding_;
-    int height = height_ + 2 * inputPadding_;
+    int width = sourceWidth_;
+    int height = sourceHeight_;
     const uint8_t * srcptr = (const uint8_t *)input_->map<uint8_t>();
     if (!srcptr) {
         THROW_EXCEPTION_ARGS(FynException,"Cannot map source CPU buffer for (sync) texture upload");
     }
+    if (transferType_ != dataType_) {
+        // half-precision transfer, convert first
+        size_t entries = (size_t)width * height * inputChannels_;
+        halfBuffer_.resize(entries);
+        FloatConversion::getInstance()->toFP16((const float *)srcptr, halfBuffer_.data(), entries);
+        input_->unmap();
+        srcptr = (const uint8_t *)halfBuffer_.data();
+    }
     while (rem > 0) {
-        GLuint tex = outputTextures_.at(texoffs++);
+        GLuint tex = textures.at(texoffs++);
         int chans = std::min(rem, LayerBase::PIXEL_PACKING);
-        auto format = BufferSpec::formatByChannels(chans, dataType_);
-        glBindTexture(GL_TEXTURE_2D, tex);
-        glTexImage2D(GL_TEXTURE_2D, 0, format.first, width, height, 0, format.second, dataType_, srcptr);
+        auto format = BufferSpec::formatByChannels(chans, transferType_);
+        bool unaligned = ((width * chans * bytesPerChan_) % 4) != 0;
+        if (unaligned) glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GLState::bindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, format.first, width, height, 0, format.second, transferType_, srcptr);
+        if (unaligned) glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
         srcptr += chans * width * height * bytesPerChan_;
         rem -= LayerBase::PIXEL_PACKING;    // we don't care about underflows
     }
-    input_->unmap();
+    if (transferType_ == dataType_) input_->unmap();
+}
+
+
+/**
+ * @brief Upload content of a (filled and unmapped) %PBO to the supplied textures
+ *
+ * @param pbo %PBO that contains the data to be uploaded in the same format as the input buffer
+ * @param textures Target textures to upload the data to
+ */
+void UploadLayer::pboToTextures(opengl::ManagedPBO& pbo, const std::vector<GLuint>& textures) {
+    int rem = inputChannels_;
+    int texoffset = 0;
+    int width = sourceWidth_;
+    int height = sourceHeight_;
+    size_t offset = 0;
+    pbo->bind(GL_PIXEL_UNPACK_BUFFER);
+    while (rem > 0) {
+        int chans = std::min(rem, LayerBase::PIXEL_PACKING);
+        auto format = BufferSpec::formatByChannels(chans, transferType_);
+        GLuint tex = textures.at(texoffset++);
+        bool unaligned = ((width * chans * bytesPerChan_) % 4) != 0;
+        if (unaligned) glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GLState::bindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, format.first, width, height, 0, format.second, transferType_, (const GLvoid *)(uintptr_t)offset);
+        if (unaligned) glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        rem -= LayerBase::PIXEL_PACKING;        // we don't care about underflows
+        offset += width * height * bytesPerChan_ * chans;
+    }
+    pbo->unbind(GL_PIXEL_UNPACK_BUFFER);
 }
 
 
@@ -390,10 +725,12 @@ void UploadLayer::syncUpload() {
  * @retval false otherwise
  *
  * This function waits for an upload slot to become available, then fetches a ManagedPBO instance
- * to spawn the actual upload on (which runs in a different thread).
+ * to spawn the actual upload on (which runs in a different thread). In case a staging buffer
+ * has been committed, the %PBO of that staging buffer is used directly instead.
  */
 bool UploadLayer::asyncUpload(uint64_t sequenceNo, const std::function<void(uint64_t)> & callback) {
     using namespace std::chrono_literals;
+    bool staged = false;
     //------------------------------------------------------------
     // Look for available upload slot, return failure if none
     // is available...
@@ -420,18 +757,30 @@ bool UploadLayer::asyncUpload(uint64_t sequenceNo, const std::function<void(uint
         // Get PBO to buffer the CPU-side data for the upload and
         // schedule thread to handle the async upload...
         //------------------------------------------------------------
-        const GLvoid * srcptr = input_->map<GLvoid>();
-        if (!srcptr) {
-            THROW_EXCEPTION_ARGS(FynException,"Cannot map source CPU buffer for (async) texture upload");
+        if (!staged_.empty()) {
+            //------------------------------------------------------------
+            // Data was written directly into a PBO by the caller, no need
+            // for an intermediate copy...
+            //------------------------------------------------------------
+            ManagedPBO pbo = staged_.front();
+            staged_.pop_front();
+            AsyncPool::GLThread thread = AsyncPool::getDerivedContextThread(context_);
+            thread->setTask(std::bind(&UploadLayer::asyncUploadTask, this, pbo, nullptr, sequenceNo, nullptr, bufferidx, callback));
+            staged = true;
+        } else {
+            const GLvoid * srcptr = input_->map<GLvoid>();
+            if (!srcptr) {
+                THROW_EXCEPTION_ARGS(FynException,"Cannot map source CPU buffer for (async) texture upload");
+            }
+            AsyncPool::GLThread thread = AsyncPool::getDerivedContextThread(context_);
+            PBOPool *pool = context_.interface()->getWritePBOPool();
+            assert(pool);
+            ManagedPBO pbo = pool->getAvailablePBO(sourceWidth_, sourceHeight_, inputChannels_, bytesPerChan_);
+            assert(!pbo.isPending());
+            thread->setTask(std::bind(&UploadLayer::asyncUploadTask, this, pbo, srcptr, sequenceNo, input_, bufferidx, callback));
         }
-        AsyncPool::GLThread thread = AsyncPool::getDerivedContextThread(context_);
-        PBOPool *pool = context_.interface()->getWritePBOPool();
-        assert(pool);
-        ManagedPBO pbo = pool->getAvailablePBO(width_, height_, inputChannels_, bytesPerChan_);
-        assert(!pbo.isPending());
-        thread->setTask(std::bind(&UploadLayer::asyncUploadTask, this, pbo, srcptr, sequenceNo, input_, bufferidx, callback));
     }
-    if (userCallback_) userCallback_(sequenceNo, input_, AsyncLayer::UPLOAD_COMMENCED);
+    if (userCallback_) userCallback_(sequenceNo, (staged) ? nullptr : input_, AsyncLayer::UPLOAD_COMMENCED);
     return true;
 }
 #endif
@@ -458,12 +807,13 @@ void UploadLayer::swapOutputTextures(uint64_t sequence) {
  * @param pbo Reference to ManagedPBO that should be used to buffer the upload
  *
  * @param srcData Pointer to start of CPU buffer that contains the (correctly formatted) data to
- *                be uploaded
+ *                be uploaded, or \c nullptr if the \p pbo is a committed staging buffer that
+ *                already contains the data
  *
  * @param sequence Sequence number which uniquely identifies/orders the operations/runs
  *
  * @param buffer Pointer to input CPUBuffer instance which will be unmapped by this thread once
- *               the upload was passed to the GL command queue
+ *               the upload was passed to the GL command queue (\c nullptr for staging buffers)
  *
  * @param texIdx Index of texture set to use as target
  *
@@ -487,44 +837,38 @@ void UploadLayer::swapOutputTextures(uint64_t sequence) {
  *          fences.
  */
 void UploadLayer::asyncUploadTask(opengl::ManagedPBO& pbo, const void *srcData, uint64_t sequence, CPUBuffer * buffer, int texIdx, const std::function<void(uint64_t)> & callback) {
-    assert(srcData);
-    assert(buffer);
+    assert((srcData != nullptr) == (buffer != nullptr));
     if (callback) {
-        int width = width_ + 2 * inputPadding_;
-        int height = height_ + 2 * inputPadding_;
-        size_t totalsize = width * height * inputChannels_ * bytesPerChan_;
-        // ------------------------------------------------
-        // Copy data to PBO buffer...
-        // ------------------------------------------------
-        pbo->prepareForWrite(totalsize, true);
-        void * pbobuffer = pbo->mapWriteBuffer(totalsize);
-        assert(pbobuffer);
-        memcpy(pbobuffer, srcData, totalsize);
-        buffer->unmap();
-        // ------------------------------------------------
-        // The input buffer can be re-used now, if we have
-        // a user callback function, notify it..
-        // notify the engine...
-        // ------------------------------------------------
-        if (userCallback_) userCallback_(sequence, buffer, AsyncLayer::UPLOAD_DONE);
+        if (srcData) {
+            // ------------------------------------------------
+            // Copy (and convert) data to PBO buffer...
+            // ------------------------------------------------
+            size_t totalsize = stagingBytes();
+            pbo->prepareForWrite(totalsize, true);
+            void * pbobuffer = pbo->mapWriteBuffer(totalsize);
+            assert(pbobuffer);
+            if (transferType_ != dataType_) {
+                FloatConversion::getInstance()->toFP16((const float *)srcData, (uint16_t *)pbobuffer, totalsize / bytesPerChan_);
+            } else memcpy(pbobuffer, srcData, totalsize);
+            buffer->unmap();
+            // ------------------------------------------------
+            // The input buffer can be re-used now, if we have
+            // a user callback function, notify it..
+            // ------------------------------------------------
+            if (userCallback_) userCallback_(sequence, buffer, AsyncLayer::UPLOAD_DONE);
+            pbo->unmapWriteBuffer();
+            pbo->unbind(GL_PIXEL_UNPACK_BUFFER);
+        } else {
+            // ------------------------------------------------
+            // Staging buffer, data is already in the PBO...
+            // ------------------------------------------------
+            if (userCallback_) userCallback_(sequence, nullptr, AsyncLayer::UPLOAD_DONE);
+        }
         // ------------------------------------------------
         // Upload PBO to textures...
         // ------------------------------------------------
-        pbo->unmapWriteBuffer();
-        int rem = inputChannels_;
-        int texoffset = 0;
-        uint32_t offset = 0;
         const std::vector<GLuint>& textures =  (texIdx == 0) ? outputTextures_ : shadowTextures_[texIdx-1];
-        while (rem > 0) {
-            int chans = std::min(rem, LayerBase::PIXEL_PACKING);
-            auto format = BufferSpec::formatByChannels(chans, dataType_);
-            GLuint tex = textures.at(texoffset);
-            glBindTexture(GL_TEXTURE_2D, tex);
-            glTexImage2D(GL_TEXTURE_2D, 0, format.first, width, height, 0, format.second, dataType_, (const GLvoid *)(uintptr_t)offset);
-            rem -= LayerBase::PIXEL_PACKING;        // we don't care about underflows
-            offset += width * height * bytesPerChan_ * LayerBase::PIXEL_PACKING;
-        }
-        pbo->unbind(GL_PIXEL_UNPACK_BUFFER);
+        pboToTextures(pbo, textures);
         // ------------------------------------------------
         // The texture generation is complete, notify the
         // engine that we may use it now...
@@ -532,7 +876,7 @@ void UploadLayer::asyncUploadTask(opengl::ManagedPBO& pbo, const void *srcData,
         callback(sequence);
     } else {
         // TODO (mw) throw exception, as this should not really happen
-        buffer->unmap();
+        if (buffer) buffer->unmap();
     }
 }
 #endif
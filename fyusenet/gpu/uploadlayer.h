@@ -16,6 +16,7 @@
 #include <atomic>
 #include <functional>
 #include <condition_variable>
+#include <list>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -28,6 +29,10 @@
 #include "../cpu/cpubuffer.h"
 #include "../gl/pbopool.h"
 #include "../gl/managedpbo.h"
+#include "../gl/uniformstate.h"
+#include "../gl/vao.h"
+#include "../gl/vbo.h"
+#include "../gl/ibo.h"
 
 //------------------------------------- Public Declarations ----------------------------------------
 namespace fyusion {
@@ -54,6 +59,20 @@ namespace gpu {
  * Data with less than 4 channels must be aggregated as either 1,2 or 3-channel elements, following
  * a simple convention as: red-channel data, red-green data and RGB data.
  *
+ * For 8-bit image data (\c UBYTE with 3 or 4 channels), the layer can optionally perform a
+ * per-channel mean/std normalization, a red/blue swap and a bilinear resize as part of the upload
+ * (see UpDownLayerBuilder::normalize(), UpDownLayerBuilder::swapRB() and
+ * UpDownLayerBuilder::sourceSize()). In that case the raw bytes are uploaded into an intermediate
+ * RGB8/RGBA8 texture and a single render pass writes the normalized data into the (padded) output
+ * texture. This reduces the upload bandwidth to a quarter compared to floating-point data and
+ * removes the need for a CPU-side conversion as well as separate normalization / channel-swap
+ * layers. The input buffer for these layers has the size of the source image and no padding.
+ *
+ * For 32-bit floating-point data, the layer can optionally convert the data to half-precision on
+ * the CPU and transfer it as \c GL_HALF_FLOAT (see UpDownLayerBuilder::fp16Transfer()), which
+ * halves the amount of data that has to be moved to the GPU. On asynchronous layers, the
+ * conversion is done in the upload thread.
+ *
  * On asynchronous uploads it is important to keep track of when the input buffer may be changed.
  * The UpDownLayerBuilder offers to add a callback function, which will be invoked by the uploading
  * thread \e after the buffer contents of the original input buffer have been copied and it is safe
@@ -97,6 +116,10 @@ class UploadLayer : public GPULayerBase, public cpu::CPULayerInterface, public A
     virtual void updateFBOs() override;
     virtual void clearInputBuffers(int port = -1) override;
     virtual void addOutputTexture(GLuint textureID, int channelIndex, int shadowIndex=0) override;
+    void * acquireStagingBuffer(size_t * bytes = nullptr);
+    void commitStagingBuffer();
+    bool hasPendingInput() const;
+    size_t stagingBytes() const;
 
     /**
      * @brief Get input buffer
@@ -127,6 +150,15 @@ class UploadLayer : public GPULayerBase, public cpu::CPULayerInterface, public A
 #endif
     }
 
+    /**
+     * @brief Check if the GL commands issued by forward() may be recorded and replayed
+     *
+     * @retval false always, as this layer transfers data between CPU and GPU
+     */
+    virtual bool isRecordable() const override {
+        return false;
+    }
+
     /**
      * @brief Clear/reset output buffers for this layer (unsupported)
      *
@@ -192,7 +224,10 @@ class UploadLayer : public GPULayerBase, public cpu::CPULayerInterface, public A
     // ------------------------------------------------------------------------
     // Non-public methods
     // ------------------------------------------------------------------------
-    void syncUpload();
+    void syncUpload(const std::vector<GLuint>& textures);
+    void pboToTextures(opengl::ManagedPBO& pbo, const std::vector<GLuint>& textures);
+    void setupPreprocessing();
+    void preprocess();
 #ifdef FYUSENET_MULTITHREADING
     bool asyncUpload(uint64_t sequence, const std::function<void(uint64_t)> & callback);
     void asyncUploadTask(opengl::ManagedPBO& pbo, const void *srcData, uint64_t sequence, CPUBuffer * buffer, int texIdx,  const std::function<void(uint64_t)> & callback);
@@ -204,9 +239,25 @@ class UploadLayer : public GPULayerBase, public cpu::CPULayerInterface, public A
     // Member variables
     // ------------------------------------------------------------------------
     BufferSpec::dtype dataType_;                    //!< Data type for this layer (currently only bytes and 32-bit floats are supported)
+    BufferSpec::dtype transferType_;                //!< Data type used for the transfer to the GPU (differs from #dataType_ on half-precision transfers)
+    std::vector<uint16_t> halfBuffer_;              //!< Temporary buffer for half-precision conversion on synchronous uploads
     CPUBuffer * input_ = nullptr;                   //!< Pointer to assigned input CPU buffer
     bool async_ = false;                            //!< Synchronous/Asynchronous upload mode toggle
-    uint8_t bytesPerChan_ = 0;                      //!< Bytes per channel
+    uint8_t bytesPerChan_ = 0;                      //!< Bytes per channel (for the transfer to the GPU)
+    opengl::ManagedPBO acquired_;                   //!< %PBO that is currently mapped for writing by the caller, see acquireStagingBuffer()
+    std::list<opengl::ManagedPBO> staged_;          //!< Committed (filled) staging PBOs that wait to be uploaded, see commitStagingBuffer()
+    int sourceWidth_ = 0;                           //!< Width of the uploaded data (including padding if not preprocessing)
+    int sourceHeight_ = 0;                          //!< Height of the uploaded data (including padding if not preprocessing)
+    bool preprocess_ = false;                       //!< Indicator if 8-bit image data is normalized/swapped/resized on upload
+    bool swapRB_ = false;                           //!< Indicator if red and blue channels are swapped on upload
+    float scale_[PIXEL_PACKING] = {0};              //!< Per-channel scale applied to normalized texture values when preprocessing
+    float bias_[PIXEL_PACKING] = {0};               //!< Per-channel bias applied after #scale_ when preprocessing
+    std::vector<GLuint> sourceTextures_;            //!< Intermediate 8-bit texture that receives the raw image data when preprocessing
+    programptr imageShader_;                        //!< Shader that performs the preprocessing pass
+    unistateptr imageState_;                        //!< Uniform state for #imageShader_
+    opengl::VAO * vertexArray_ = nullptr;           //!< Vertex array object for the preprocessing pass
+    opengl::VBO * vertexBuffer_ = nullptr;          //!< Vertex buffer object with the proxy polygon for the preprocessing pass
+    opengl::IBO * indexBuffer_ = nullptr;           //!< Index buffer object for the preprocessing pass
 #ifdef FYUSENET_MULTITHREADING
     mutable std::mutex asyncLock_;                  //!< Locks access to members used for asynchronous uploads
     uint64_t inFlight_[ASYNC_BUFFERS];              //!< Stores sequence numbers of in-flight uploads, the index in the array relates to the texture set
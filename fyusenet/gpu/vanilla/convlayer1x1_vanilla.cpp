@@ -86,15 +86,16 @@ void ConvLayer1x1::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
-    glBlendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
-    glViewport(0,0,viewport_[0],viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+    GLState::blendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
+    GLState::blendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
+    GLState::viewport(0,0,viewport_[0],viewport_[1]);
     ShaderProgram *shader = nullptr;
     vertexArray_->bind();
+    if ((coeffBuffer_) && (coeffsDirty_)) updateCoefficientBuffer();
     for (int outfield = 0 ; outfield < weights_->numOutputRenderPasses(); outfield++) {
         int sindex = weights_->numRenderTargets(outfield)-1;
         if (convolutionShaders_[sindex].get() != shader) {
@@ -105,34 +106,37 @@ void ConvLayer1x1::forward(uint64_t sequence) {
         if (flags_ & LayerFlags::RESIDUAL_INPUT) {
             for (int i=0;i<weights_->numRenderTargets(outfield);i++) {
                 int texindex = i+weights_->outputTextureOffset(outfield);
-                glActiveTexture(GL_TEXTURE1+i);
-                glBindTexture(GL_TEXTURE_2D,residualTextures_.at(texindex));
+                GLState::activeTexture(GL_TEXTURE1+i);
+                GLState::bindTexture(GL_TEXTURE_2D,residualTextures_.at(texindex));
             }
         }
         int nummatrices = weights_->numRenderTargets(outfield);
         framebuffers_.at(outfield)->bind();
         framebuffers_.at(outfield)->setWriteMask();
         setBias(outfield,weights_);
-        glActiveTexture(GL_TEXTURE0);
+        if (flags_ & LayerFlags::POST_BATCHNORM) {
+            shader->setMappedUniformVec4Array(BATCHNORM_DATA, weights_->getPackageBNScale(outfield), weights_->numRenderTargets(outfield));
+        }
+        GLState::activeTexture(GL_TEXTURE0);
         for (int infield = 0; infield < weights_->numInputRenderPasses(); infield++) {
-            glBindTexture(GL_TEXTURE_2D,inputTextures_.at(infield));
-            if (flags_ & LayerFlags::POST_BATCHNORM) {
-                shader->setMappedUniformVec4Array(BATCHNORM_DATA, weights_->getPackageBNScale(outfield), weights_->numRenderTargets(outfield));
+            GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(infield));
+            if (coeffBuffer_) bindCoefficients(infield, outfield, 0);
+            else {
+                const float *matrices = weights_->getPackageWeights(infield, outfield, 0, 0);
+                shader->setMappedUniformMat4Array(COEFFICIENTS,matrices,nummatrices);
             }
-            const float *matrices = weights_->getPackageWeights(infield, outfield, 0, 0);
-            shader->setMappedUniformMat4Array(COEFFICIENTS,matrices,nummatrices);
             if (((flags_ & LayerFlags::RESIDUAL_INPUT) || (outputPadding_>0)) && (infield==0)) {
                 if (flags_ & LayerFlags::RESIDUAL_INPUT) shader->setMappedUniformValue(RESIDUAL_SWITCH,(GLint)1);
                 if (outputPadding_ > 0) {
                     shader->setMappedUniformVec4Array(BIAS,weights_->getPackageBias(outfield),weights_->numRenderTargets(outfield));
                 }
-                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+                GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
                 if (outputPadding_ > 0) {
                     shader->setMappedUniformVec4Array(BIAS,zeroBias_,weights_->numRenderTargets(outfield));
                 }
                 if (flags_ & LayerFlags::RESIDUAL_INPUT) shader->setMappedUniformValue(RESIDUAL_SWITCH,(GLint)0);
             } else {
-                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
+                GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const GLvoid *)0);
             }
         }
         framebuffers_.at(outfield)->unbind();
@@ -168,9 +172,10 @@ void ConvLayer1x1::setupShaders() {
 void ConvLayer1x1::compileConvolutionShaders(const char *preproc) {
     char finalpreproc[1024+128] = {0};
     char extra[128];
+    bool ubo = initCoefficientBuffer();
     for (int i=1; i <= maxRenderTargets_; i++) {
         strncpy(finalpreproc, preproc, sizeof(finalpreproc)-1);
-        snprintf(extra, sizeof(extra), "#define NUM_LANES %d\n",i);
+        snprintf(extra, sizeof(extra), "#define NUM_LANES %d\n%s", i, (ubo) ? "#define COEFFS_UBO\n" : "");
         ssize_t mc = sizeof(finalpreproc)-strlen(finalpreproc)-1;
         assert(mc > 0);
         strncat(finalpreproc, extra, mc);
@@ -202,7 +207,8 @@ void ConvLayer1x1::compileConvolutionShaders(const char *preproc) {
             convolutionShaders_[i-1]->setMappedUniformValue(RESIDUAL_SWITCH,(GLint)0);
         }
         convolutionShaderStates_[i-1]->setUniformValue("inputLayer",0);
-        convolutionShaders_[i-1]->mapUniformLocation("coeffs",COEFFICIENTS);
+        if (ubo) convolutionShaders_[i-1]->bindIndexToShaderBuffer("ConvCoeffs", COEFF_BLOCK_BINDING);
+        else convolutionShaders_[i-1]->mapUniformLocation("coeffs",COEFFICIENTS);
         if (flags_ & LayerFlags::POST_BATCHNORM) {
             convolutionShaders_[i-1]->mapUniformLocation("batchnorm", BATCHNORM_DATA);
         }
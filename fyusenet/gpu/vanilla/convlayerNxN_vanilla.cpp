@@ -77,18 +77,19 @@ void ConvLayerNxN::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
-    glBlendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
-    glViewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+    GLState::blendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
+    GLState::blendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
     ShaderProgram *shader = nullptr;
     if (!vertexArray_->bind()) {
         FNLOGE("Cannot render layer %s",getName().c_str());
         return;
     }
+    if ((coeffBuffer_) && (coeffsDirty_)) updateCoefficientBuffer();
     for (int outfield = 0 ; outfield < weights_->numOutputRenderPasses(); outfield++) {
         int sindex = weights_->numRenderTargets(outfield)-1;
         if (convolutionShaders_.at(sindex).get() != shader) {
@@ -99,34 +100,37 @@ void ConvLayerNxN::forward(uint64_t sequence) {
         if (flags_ & LayerFlags::RESIDUAL_INPUT) {
             for (int i=0;i<weights_->numRenderTargets(outfield);i++) {
                 int texindex = i+weights_->outputTextureOffset(outfield);
-                glActiveTexture(RESIDUAL_START_UNIT+i);
-                glBindTexture(GL_TEXTURE_2D,residualTextures_.at(texindex));
+                GLState::activeTexture(RESIDUAL_START_UNIT+i);
+                GLState::bindTexture(GL_TEXTURE_2D,residualTextures_.at(texindex));
             }
         }
         int nummatrices = kernel_*weights_->numRenderTargets(outfield);
         framebuffers_.at(outfield)->bind();
         setBias(outfield,weights_);
-        glActiveTexture(GL_TEXTURE0);
+        if (flags_ & LayerFlags::POST_BATCHNORM) {
+            shader->setMappedUniformVec4Array(BATCHNORM_DATA,weights_->getPackageBNScale(outfield),weights_->numRenderTargets(outfield));
+        }
+        GLState::activeTexture(GL_TEXTURE0);
         for (int infield = 0; infield < weights_->numInputRenderPasses(); infield++) {
-            glBindTexture(GL_TEXTURE_2D,inputTextures_.at(infield));
-            if (flags_ & LayerFlags::POST_BATCHNORM) {
-                shader->setMappedUniformVec4Array(BATCHNORM_DATA,weights_->getPackageBNScale(outfield),weights_->numRenderTargets(outfield));
-            }
+            GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(infield));
             for (int conv=0; conv < kernel_; conv++) {
-                const float *matrices = weights_->getPackageWeights(infield, outfield, 0, conv);
-                shader->setMappedUniformMat4Array(COEFFICIENTS,matrices,nummatrices);
+                if (coeffBuffer_) bindCoefficients(infield, outfield, conv);
+                else {
+                    const float *matrices = weights_->getPackageWeights(infield, outfield, 0, conv);
+                    shader->setMappedUniformMat4Array(COEFFICIENTS,matrices,nummatrices);
+                }
                 if (((flags_ & LayerFlags::RESIDUAL_INPUT) || (outputPadding_>0)) && (conv == kernel_ - 1) && (infield == 0)) {
                     if (flags_ & LayerFlags::RESIDUAL_INPUT) shader->setMappedUniformValue(RESIDUAL_SWITCH,(GLint)1);
                     if (outputPadding_ > 0) {
                         shader->setMappedUniformVec4Array(BIAS, weights_->getPackageBias(outfield), weights_->numRenderTargets(outfield));
                     }
-                    glDrawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)(conv*6*sizeof(short)));
+                    GLState::drawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)(conv*6*sizeof(short)));
                     if (outputPadding_ > 0) {
                         shader->setMappedUniformVec4Array(BIAS,zeroBias_,weights_->numRenderTargets(outfield));
                     }
                     if (flags_ & LayerFlags::RESIDUAL_INPUT) shader->setMappedUniformValue(RESIDUAL_SWITCH,(GLint)0);
                 } else {
-                    glDrawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)(conv*6*sizeof(short)));
+                    GLState::drawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)(conv*6*sizeof(short)));
                 }
             }
         }
@@ -168,11 +172,12 @@ void ConvLayerNxN::setupShaders() {
 void ConvLayerNxN::compileConvolutionShaders(const char *preproc) {
     char finalpreproc[1024+128] = {0};
     char extra[128];
+    bool ubo = initCoefficientBuffer();
     char shadername[64];
     snprintf(shadername, sizeof(shadername), "shaders/vanilla/conv%dx%d.frag", kernel_, kernel_);
     for (int i=1; i <= maxRenderTargets_; i++) {
         strncpy(finalpreproc, preproc, sizeof(finalpreproc)-1);
-        snprintf(extra, sizeof(extra), "#define NUM_LANES %d\n",i);
+        snprintf(extra, sizeof(extra), "#define NUM_LANES %d\n%s", i, (ubo) ? "#define COEFFS_UBO\n" : "");
         ssize_t mc = sizeof(finalpreproc)-strlen(finalpreproc)-1;
         assert(mc > 0);
         strncat(finalpreproc, extra, mc);
@@ -204,7 +209,8 @@ void ConvLayerNxN::compileConvolutionShaders(const char *preproc) {
             convolutionShaders_[i-1]->setMappedUniformValue(RESIDUAL_SWITCH,(GLint)0);   // requires bound shader
         }
         convolutionShaderStates_[i-1]->setUniformValue("inputLayer",0);
-        convolutionShaders_[i-1]->mapUniformLocation("coeffs",COEFFICIENTS);
+        if (ubo) convolutionShaders_[i-1]->bindIndexToShaderBuffer("ConvCoeffs", COEFF_BLOCK_BINDING);
+        else convolutionShaders_[i-1]->mapUniformLocation("coeffs",COEFFICIENTS);
         if (flags_ & LayerFlags::POST_BATCHNORM) {
             convolutionShaders_[i-1]->mapUniformLocation("batchnorm",BATCHNORM_DATA);
         }
@@ -87,6 +87,7 @@ void DepthwiseConvLayer3x3::loadWeightsAndBiases(const float *biasAndWeights, si
     weights_->extractBiasData(biasAndWeights,offset);
     weights_->extractWeightData(biasAndWeights,offset + outputChannels_);
     if (flags_ & LayerFlags::POST_BATCHNORM) weights_->extractBatchnormData(biasAndWeights,offset);
+    bindingRevision_++;
 }
 
 
@@ -101,13 +102,13 @@ void DepthwiseConvLayer3x3::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glBlendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
-    glBlendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
-    glViewport(0,0,viewport_[0],viewport_[1]);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
+    GLState::disable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+    GLState::blendEquationSeparate(GL_FUNC_ADD,GL_FUNC_ADD);
+    GLState::blendFuncSeparate(GL_ONE,GL_ONE,GL_ONE,GL_ONE);
+    GLState::viewport(0,0,viewport_[0],viewport_[1]);
     ShaderProgram *shader = nullptr;
     vertexArray_->bind();
     int textureoffset = 0;
@@ -121,8 +122,8 @@ void DepthwiseConvLayer3x3::forward(uint64_t sequence) {
         if (flags_ & LayerFlags::RESIDUAL_INPUT) {
             for (int i=0;i<weights_->numRenderTargets(outfield);i++) {
                 int texindex = i+weights_->outputTextureOffset(outfield);
-                glActiveTexture(GL_TEXTURE8+i);
-                glBindTexture(GL_TEXTURE_2D,residualTextures_.at(texindex));
+                GLState::activeTexture(GL_TEXTURE8+i);
+                GLState::bindTexture(GL_TEXTURE_2D,residualTextures_.at(texindex));
             }
         }
         int numcvecs = kernel_ * kernel_ * weights_->numRenderTargets(outfield);
@@ -134,8 +135,8 @@ void DepthwiseConvLayer3x3::forward(uint64_t sequence) {
         }
         for (int infield = 0; infield < weights_->numInputRenderPasses(); infield++) {
             for (int t=0; t < weights_->numRenderTargets(outfield) ; t++) {
-                glActiveTexture(GL_TEXTURE0+t);
-                glBindTexture(GL_TEXTURE_2D,inputTextures_.at(t+textureoffset));
+                GLState::activeTexture(GL_TEXTURE0+t);
+                GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(t+textureoffset));
             }
 
             const float *cvecs = weights_->getPackageWeights(infield,outfield,0,0);
@@ -144,7 +145,7 @@ void DepthwiseConvLayer3x3::forward(uint64_t sequence) {
             if (outputPadding_ > 0) {
                 shader->setMappedUniformVec4Array(BIAS,weights_->getPackageBias(outfield),weights_->numRenderTargets(outfield));
             }
-            glDrawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
+            GLState::drawElements(GL_TRIANGLES,6,GL_UNSIGNED_SHORT,(const GLvoid *)0);
             if (outputPadding_ > 0) {
                 shader->setMappedUniformVec4Array(BIAS,zeroBias_,weights_->numRenderTargets(outfield));
             }
@@ -174,12 +175,12 @@ void DepthwiseConvLayer3x3::forward(uint64_t sequence) {
  */
 void DepthwiseConvLayer3x3::setBias(int outPass,const UniformWeightArray *bias) {
     if (outputPadding_ > 0) {
-        glClearColor(0.0f,0.0f,0.0f,0.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        GLState::clearColor(0.0f,0.0f,0.0f,0.0f);
+        GLState::clear(GL_COLOR_BUFFER_BIT);
     } else {
         const float *data = bias->getPackageBias(outPass);
         for (int i=0; i < bias->numRenderTargets(outPass);i++) {
-            glClearBufferfv(GL_COLOR,i,data + i*PIXEL_PACKING);
+            GLState::clearBufferfv(GL_COLOR,i,data + i*PIXEL_PACKING);
         }
     }
 }
@@ -51,6 +51,7 @@ namespace vanilla {
  */
 ConvLayerBase::ConvLayerBase(const ConvLayerBuilder & builder,int layerNumber) : gpu::ConvLayerBase(builder, layerNumber) {
     assert(builder.type_ != LayerType::ILLEGAL);
+    coeffsUBO_ = builder.uniformBuffer_;
     // -------------------------------------------------------------------
     // Determine maximum number of render targets based on GPU capability
     // on the drawing side and capacity on the number of uniforms for a
@@ -153,10 +154,12 @@ void ConvLayerBase::cleanup() {
     delete indexBuffer_;
     delete vertexArray_;
     delete residualBuffer_;
+    delete coeffBuffer_;
     vertexBuffer_ = nullptr;
     indexBuffer_ = nullptr;
     vertexArray_ = nullptr;
     residualBuffer_ = nullptr;
+    coeffBuffer_ = nullptr;
     gpu::ConvLayerBase::cleanup();
 }
 
@@ -259,6 +262,9 @@ void ConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t off
         int bnoffset = offset + outputChannels_ + (kernel_*kernel_) * inputChannels_ * outputChannels_;
         weights_->extractBatchnormData(biasAndWeights, bnoffset);
     }
+    coeffsDirty_ = true;
+    // NOTE coefficients are set in forward(), recorded command streams are outdated
+    bindingRevision_++;
 }
 
 
@@ -280,18 +286,81 @@ void ConvLayerBase::loadWeightsAndBiases(const float *biasAndWeights, size_t off
 void ConvLayerBase::setBias(int outPass, const UniformWeightArray *bias) {
     if (outputPadding_ > 0) {
         // if we have padding, the shader takes care, just clear the target FB here
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        GLState::clearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        GLState::clear(GL_COLOR_BUFFER_BIT);
     } else {
         // clear the target FB to the bias value
         const float * data = bias->getPackageBias(outPass);
         for (int i=0; i < bias->numRenderTargets(outPass); i++) {
-            glClearBufferfv(GL_COLOR, i, data + i * PIXEL_PACKING);
+            GLState::clearBufferfv(GL_COLOR, i, data + i * PIXEL_PACKING);
         }
     }
 }
 
 
+/**
+ * @brief Create uniform buffer for the convolution coefficients (if applicable)
+ *
+ * @retval true if the coefficients are supplied via a uniform buffer, in which case the shaders
+ *         must be compiled with \c COEFFS_UBO defined
+ * @retval false if the coefficients are supplied via simple uniforms
+ *
+ * @pre The GL context that is to be used for running the inference must be current to the calling
+ *      thread
+ *
+ * Uniform buffers are only used when requested by the builder (see class description) and if the
+ * coefficients for a single shader pass fit into a uniform block.
+ */
+bool ConvLayerBase::initCoefficientBuffer() {
+    unsigned int blocksize = kernel_ * maxRenderTargets_ * 16 * sizeof(float);
+    if ((!coeffsUBO_) || (GLInfo::getMaxFragmentUBOs() <= 0) || (GLInfo::getMaxUBOSize() < blocksize)) return false;
+    if (!coeffBuffer_) coeffBuffer_ = new UBO(context_);
+    coeffsDirty_ = true;
+    if (weights_) updateCoefficientBuffer();
+    return true;
+}
+
+
+/**
+ * @brief Upload all convolution coefficients to the uniform buffer
+ *
+ * @pre The GL context that is to be used for running the inference must be current to the calling
+ *      thread
+ *
+ * The coefficients for each combination of input pass, output pass and kernel row are stored
+ * back-to-back (std140 layout for \c mat4 arrays) in the buffer, observing the offset alignment
+ * required by \c glBindBufferRange().
+ */
+void ConvLayerBase::updateCoefficientBuffer() {
+    assert(coeffBuffer_);
+    assert(weights_);
+    int align = std::max(1, (int)GLInfo::getUBOOffsetAlignment());
+    int numblocks = weights_->numInputRenderPasses() * weights_->numOutputRenderPasses() * kernel_;
+    coeffOffsets_.resize(numblocks);
+    coeffSizes_.resize(numblocks);
+    int offset = 0;
+    for (int infield=0, index=0; infield < weights_->numInputRenderPasses(); infield++) {
+        for (int outfield=0; outfield < weights_->numOutputRenderPasses(); outfield++) {
+            for (int row=0; row < kernel_; row++, index++) {
+                coeffOffsets_[index] = offset;
+                coeffSizes_[index] = kernel_ * weights_->numRenderTargets(outfield) * 16 * sizeof(float);
+                offset += ((coeffSizes_[index] + align - 1) / align) * align;
+            }
+        }
+    }
+    std::vector<uint8_t> data(offset, 0);
+    for (int infield=0, index=0; infield < weights_->numInputRenderPasses(); infield++) {
+        for (int outfield=0; outfield < weights_->numOutputRenderPasses(); outfield++) {
+            for (int row=0; row < kernel_; row++, index++) {
+                memcpy(data.data() + coeffOffsets_[index], weights_->getPackageWeights(infield, outfield, 0, row), coeffSizes_[index]);
+            }
+        }
+    }
+    coeffBuffer_->setBufferData(data.data(), offset, GL_STATIC_DRAW);
+    coeffsDirty_ = false;
+}
+
+
 /**
  * @brief Convolution-specific shader preprocessing on source level
  *
@@ -323,7 +392,7 @@ size_t ConvLayerBase::shaderPreprocessing(char *preproc, size_t maxChars) {
     strncat(preproc, extra, mc);
     mc -= strlen(extra);
     assert(mc > 0);
-    snprintf(extra, sizeof(extra), "#define DILATION %d\n",dilation_[0]);       // TODO (mw) support anisotropic dilation
+    snprintf(extra, sizeof(extra), "#define DILATION_X %d\n#define DILATION_Y %d\n",dilation_[0],dilation_[1]);
     strncat(preproc, extra, mc);
     mc -= strlen(extra);
     return (size_t)std::max((ssize_t)0, mc);
@@ -362,7 +431,7 @@ void ConvLayerBase::setupNetworkPolygons(VAO *vao, int kernel) {
         float thspan = (float)(width_) / (float)(width_ + 2*inputPadding_);
         float tvspan = (float)(height_) / (float)(height_ + 2*inputPadding_);
         tleft = (float)inputPadding_ / (float)(width_ + 2*inputPadding_);
-        ttop = ((float)inputPadding_ + sourceStep_*(float)(conv-((kernel-1)/2)))/(float)(height_ + 2*inputPadding_);
+        ttop = ((float)inputPadding_ + sourceStep_*(float)(dilation_[1]*(conv-((kernel-1)/2))))/(float)(height_ + 2*inputPadding_);
         if (downsample_[0] > 1) {
             tleft -= sourceStep_ * 0.5f*(float)(downsample_[0]-1) / (float)(width_ + 2*inputPadding_);
         }
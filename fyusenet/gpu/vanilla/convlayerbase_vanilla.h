@@ -13,6 +13,7 @@
 //--------------------------------------- System Headers -------------------------------------------
 
 #include <string>
+#include <vector>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -20,6 +21,7 @@
 #include "../../gl/vao.h"
 #include "../../gl/vbo.h"
 #include "../../gl/ibo.h"
+#include "../../gl/ubo.h"
 #include "../gfxcontextlink.h"
 #include "../../base/bufferspec.h"
 #include "../convlayerbase.h"
@@ -53,6 +55,12 @@ namespace vanilla {
  * putting them into device memory, whereas the (classical) uniforms are set as constant memory or
  * put into the register file, which decreases access time substantially.
  *
+ * As an option (see ConvLayerBuilderTempl::uniformBuffer()), the coefficients can be uploaded once
+ * into a single uniform buffer object instead, with each shader pass only selecting its portion of
+ * the buffer via \c glBindBufferRange(). This keeps the weight upload off the hot path, but it has
+ * not been benchmarked on any architecture other than the mobile ones mentioned above (where it was
+ * slower), which is why it is not used by default. Biases are always routed via simple uniforms.
+ *
  * Last but not least, the ROP engines are used in alpha-blending mode for free accumulation of
  * the inner product that the convolution computes. In order to use the blending trick, non-linear
  * activation functions at the end of the computation are impossible and I opted to simply
@@ -64,6 +72,7 @@ namespace vanilla {
 class ConvLayerBase : public gpu::ConvLayerBase {
  public:
     constexpr static int VEC_OVERHEAD = 3;
+    constexpr static int COEFF_BLOCK_BINDING = 0;   //!< Binding point for the uniform block that stores the coefficients
     // ------------------------------------------------------------------------
     // Constructor / Destructor
     // ------------------------------------------------------------------------
@@ -89,6 +98,22 @@ class ConvLayerBase : public gpu::ConvLayerBase {
     virtual void setupFBOs() override;
     virtual void updateFBOs() override;
     virtual void setBias(int outPass, const UniformWeightArray *bias);
+    bool initCoefficientBuffer();
+    void updateCoefficientBuffer();
+
+    /**
+     * @brief Bind portion of coefficient buffer for a shader pass
+     *
+     * @param inPass Input rendering pass
+     * @param outPass Output rendering pass
+     * @param row Kernel row (vertical shift) to bind the coefficients for
+     *
+     * @pre Coefficient buffer is set up and up-to-date, see updateCoefficientBuffer()
+     */
+    void bindCoefficients(int inPass, int outPass, int row) {
+        int index = (inPass * weights_->numOutputRenderPasses() + outPass) * kernel_ + row;
+        coeffBuffer_->bindRangeTo(COEFF_BLOCK_BINDING, coeffOffsets_[index], coeffSizes_[index]);
+    }
 
     // ------------------------------------------------------------------------
     // Member variables
@@ -103,6 +128,11 @@ class ConvLayerBase : public gpu::ConvLayerBase {
     float sourceStep_ = 1.0f;                       //!< Defines the step-width of the convolution (source-side) for fractional convolutions
     bool mali_ = false;                             //!< Flag that is set when an ARM Mali GPU was detected
     bool preG71_ = false;                           //!< Flag that is set when an ARM Mali GPU prior to the G-71 model (e.g. T-880) was detected
+    UBO * coeffBuffer_ = nullptr;                   //!< Uniform buffer that stores the coefficients for all shader passes (if used)
+    std::vector<int> coeffOffsets_;                 //!< Byte offsets into #coeffBuffer_ for each input pass, output pass and kernel row
+    std::vector<int> coeffSizes_;                   //!< Byte sizes of the portions in #coeffBuffer_, same indexing as #coeffOffsets_
+    bool coeffsDirty_ = false;                      //!< Indicator that #coeffBuffer_ has to be (re-)uploaded
+    bool coeffsUBO_ = false;                        //!< Indicator that the coefficients should be supplied via #coeffBuffer_ (if supported)
 };
 
 } // vanilla namespace
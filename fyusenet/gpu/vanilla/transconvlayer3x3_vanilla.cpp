@@ -57,6 +57,7 @@ void TransConvLayer3x3::loadWeightsAndBiases(const float *biasAndWeights, size_t
     weights_->extractBiasData(biasAndWeights,offset);
     weights_->extractWeightData(biasAndWeights,offset);
     if (flags_ & LayerFlags::POST_BATCHNORM) weights_->extractBatchnormData(biasAndWeights,offset);
+    bindingRevision_++;
 }
 
 
@@ -85,7 +85,7 @@ void TransConvLayerBase::cleanup() {
     indexBuffer_ = nullptr;
     vertexArray_ = nullptr;
     if ((context_.isCurrent()) && (stencilBuffer_ != 0)) {
-        glDeleteTextures(1,&stencilBuffer_);
+        GLState::deleteTextures(1,&stencilBuffer_);
     }
     stencilBuffer_ = 0;
     for (int i=0; i < NUM_STRATA; i++) {
@@ -141,18 +141,18 @@ void TransConvLayerBase::forward(uint64_t sequence) {
 #endif
     std::lock_guard<std::recursive_mutex> lck(processingLock_);
     if (outputChanged_) updateFBOs();
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_STENCIL_TEST);
-    glDepthFunc(GL_ALWAYS);
-    glDepthMask(GL_FALSE);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
-    glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
-    glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
-    glViewport(0, 0, viewport_[0], viewport_[1]);
-    glStencilMask(0xFF);
-    glClearColor(0,0,0,0);
+    GLState::disable(GL_CULL_FACE);
+    GLState::enable(GL_BLEND);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_STENCIL_TEST);
+    GLState::depthFunc(GL_ALWAYS);
+    GLState::depthMask(GL_FALSE);
+    GLState::stencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    GLState::blendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+    GLState::blendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
+    GLState::viewport(0, 0, viewport_[0], viewport_[1]);
+    GLState::stencilMask(0xFF);
+    GLState::clearColor(0,0,0,0);
     if (vertexArray_->bind()) {
         for (int outpass=0; outpass < weights_->numOutputRenderPasses(); outpass++) {
             framebuffers_.at(outpass)->bind();
@@ -165,8 +165,8 @@ void TransConvLayerBase::forward(uint64_t sequence) {
     } else {
         FNLOGE("Cannot render layer %s",getName().c_str());
     }
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
+    GLState::disable(GL_DEPTH_TEST);
+    GLState::disable(GL_STENCIL_TEST);
 }
 
 
@@ -230,18 +230,18 @@ void TransConvLayerBase::performInputPasses(UniformWeightArray *weights, int out
 #endif
     int ibooffset=0;
     for (int stratum=0; stratum < NUM_STRATA; stratum++) {
-        glStencilFuncSeparate(GL_FRONT_AND_BACK, GL_EQUAL, stratum+1, 0xFF);
+        GLState::stencilFuncSeparate(GL_FRONT_AND_BACK, GL_EQUAL, stratum+1, 0xFF);
         int xindex = stratum & 1;
         int yindex= (stratum & 2)>>1;
         ibooffset = stratum * 6 * sizeof(GLshort);
         shader = shaders_[stratum].at(weights->numRenderTargets(outputPass)).get();
         shader->bind(shaderStates_[stratum].at(weights->numRenderTargets(outputPass)).get());
-        glActiveTexture(GL_TEXTURE0);
+        GLState::activeTexture(GL_TEXTURE0);
         for (int inpass=0; inpass < weights->numInputRenderPasses(); inpass++) {
-            glBindTexture(GL_TEXTURE_2D,inputTextures_.at(inpass));
+            GLState::bindTexture(GL_TEXTURE_2D,inputTextures_.at(inpass));
             const float *coeffs = weights->getPackageWeights(inpass,outputPass,xindex,yindex);
             shader->setMappedUniformMat4Array(COEFFICIENTS, coeffs, weights->numRenderTargets(outputPass));
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const char *)0+ibooffset);
+            GLState::drawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, (const char *)0+ibooffset);
         }
     }
     if (shader) shader->unbind();
@@ -259,12 +259,12 @@ void TransConvLayerBase::performInputPasses(UniformWeightArray *weights, int out
  */
 void TransConvLayerBase::setBias(int outPass, const UniformWeightArray *bias) {
     if (outputPadding_ > 0) {
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        GLState::clearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        GLState::clear(GL_COLOR_BUFFER_BIT);
     } else {
         const float *data = bias->getPackageBias(outPass);
         for (int i = 0; i < bias->numRenderTargets(outPass); i++) {
-            glClearBufferfv(GL_COLOR, i, data + i * PIXEL_PACKING);
+            GLState::clearBufferfv(GL_COLOR, i, data + i * PIXEL_PACKING);
         }
     }
 }
@@ -489,13 +489,13 @@ void TransConvLayerBase::setupStencilBuffer() {
     // setup...
     //-----------------------------------------------
     GLuint helptex=0;
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     glGenTextures(1,&helptex);
-    glBindTexture(GL_TEXTURE_2D,helptex);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    GLState::bindTexture(GL_TEXTURE_2D,helptex);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    GLState::texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     bool odd = ((viewport_[0]&1)==1);
     if (odd) glPixelStorei(GL_UNPACK_ALIGNMENT,1);
     unsigned char * helper = new unsigned char[viewport_[0]*viewport_[1]];
@@ -597,20 +597,20 @@ void TransConvLayerBase::setupStencilBuffer() {
     //-----------------------------------------------
     //-----------------------------------------------
     fbo->bind();
-    glViewport(0,0,viewport_[0],viewport_[1]);
-    glStencilFuncSeparate(GL_FRONT_AND_BACK,GL_ALWAYS,0,0xFF);
-    glStencilMask(0xFF);
-    glClearColor(0,0,0,0);
-    glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_STENCIL_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_STENCIL_TEST);
-    glDepthFunc(GL_ALWAYS);
-    glStencilOp(GL_KEEP,GL_KEEP,GL_INCR);
+    GLState::viewport(0,0,viewport_[0],viewport_[1]);
+    GLState::stencilFuncSeparate(GL_FRONT_AND_BACK,GL_ALWAYS,0,0xFF);
+    GLState::stencilMask(0xFF);
+    GLState::clearColor(0,0,0,0);
+    GLState::clear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT|GL_STENCIL_BUFFER_BIT);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_STENCIL_TEST);
+    GLState::depthFunc(GL_ALWAYS);
+    GLState::stencilOp(GL_KEEP,GL_KEEP,GL_INCR);
     for (int pass=0;pass<4;pass++) {
         shader->setUniformValue("pass",pass);
-        glDrawArrays(GL_TRIANGLE_FAN,0,4);
+        GLState::drawArrays(GL_TRIANGLE_FAN,0,4);
     }
-    glDisable(GL_DEPTH_TEST);
+    GLState::disable(GL_DEPTH_TEST);
     //-----------------------------------------------
     // ...and cleanup
     //-----------------------------------------------
@@ -618,7 +618,7 @@ void TransConvLayerBase::setupStencilBuffer() {
     fbo->unbind();
     vao->unbind();
     vbo->unbind();
-    glDeleteTextures(1,&helptex);
+    GLState::deleteTextures(1,&helptex);
     delete vbo;
     delete vao;
     delete fbo;
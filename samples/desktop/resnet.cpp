@@ -26,6 +26,7 @@
 #endif
 
 #include <fyusenet/common/performance.h>
+#include <fyusenet/base/precisionadvisor.h>
 
 
 //-------------------------------------- Global Variables ------------------------------------------
@@ -77,6 +78,7 @@ int main(int argc, char **argv) {
                          ("k,kernel", "Kernel size for the convolution layers, either 3 for 3x3 or 9 for 9x9", cxxopts::value<int>()->default_value("3"))
                          ("c,classes", "File name to textfile with the class label names, one label per line (optional)", cxxopts::value<std::string>())
                          ("w,weights", "Use supplied filename as weight file (mandatory)", cxxopts::value<std::string>())
+                         ("p,precision", "Suggest per-layer precision assignment that keeps the maximum deviation from a full-precision run below the supplied value", cxxopts::value<float>())
 #ifdef DEBUG
                          ("l,log", "Log layer outputs to supplied directory", cxxopts::value<std::string>())
 #endif
@@ -202,6 +204,40 @@ int main(int argc, char **argv) {
     }
     std::cout<<"Inference took "<<fy_elapsed_millis(start, stop)<<"ms (including texture upload and download)\n";
     // -------------------------------------------------------
+    // Optionally suggest a mixed-precision assignment by
+    // comparing against full-precision runs
+    // -------------------------------------------------------
+    if (opts.count("precision") > 0) {
+        using fyusion::fyusenet::PrecisionAdvisor;
+        using fyusion::fyusenet::PrecisionType;
+        auto evaluate = [&](const PrecisionAdvisor::assignment& prec) {
+            std::vector<float> result;
+            ResNet50 * pnet = new ResNet50();
+            for (auto it = prec.begin(); it != prec.end(); ++it) pnet->setLayerPrecision(it->first, it->second);
+            pnet->loadWeightsAndBiases(weights, weightfloats);
+            pnet->setup();
+            pnet->setInputBuffer(rgb);
+            pnet->forward();
+            auto * pbuf = pnet->getOutputBuffer();
+            CPUBuffer * cbuf = (pbuf) ? pbuf->toChannelWise() : nullptr;
+            if (cbuf) {
+                const float * ptr = cbuf->map<float>(true);
+                result.assign(ptr, ptr + IMAGENET_CLASS_COUNT);
+                cbuf->unmap();
+                delete cbuf;
+            }
+            pnet->cleanup();
+            delete pnet;
+            return result;
+        };
+        PrecisionAdvisor advisor(net->getLayerNumbers(), evaluate);
+        PrecisionAdvisor::assignment prec = advisor.suggest(opts["precision"].as<float>());
+        std::cout<<"\nSuggested precision (max. error "<<advisor.error()<<"):\n";
+        for (int layer : net->getLayerNumbers()) {
+            std::cout<<"  layer "<<layer<<": "<<((prec.at(layer) == PrecisionType::FULL) ? "full" : "half")<<" (isolated error "<<advisor.sensitivities().at(layer)<<")\n";
+        }
+    }
+    // -------------------------------------------------------
     // If we use GLFW, wait for another MB click before
     // terminating
     // -------------------------------------------------------
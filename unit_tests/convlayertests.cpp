@@ -14,6 +14,7 @@
 #include <atomic>
 #include <memory>
 #include <thread>
+#include <tuple>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -24,6 +25,12 @@
 #include <fyusenet/gpu/vanilla/convlayerNxN_vanilla.h>
 #include <fyusenet/gpu/deep/deepconvlayer1x1.h>
 #include <fyusenet/gpu/deep/deepconvlayerNxN.h>
+#include <fyusenet/gpu/deep/deepcomputeconvlayer.h>
+#include <fyusenet/gpu/deep/deepwinogradconvlayer.h>
+#include <fyusenet/gpu/deep/deepdwconvlayerNxN.h>
+#include <fyusenet/gpu/deep/deepresizelayer.h>
+#include <fyusenet/gpu/deep/deepconcatlayer.h>
+#include <fyusenet/gl/glinfo.h>
 #include <fyusenet/base/layerfactory.h>
 #include "layertestbase.h"
 
@@ -117,6 +124,387 @@ class ConvLayerTest: public ::testing::Test, public TestContextManager, public L
         return result;
     }
 
+    /**
+     * @brief Reference implementation of a depthwise convolution with optional downsampling on padded input
+     *
+     * @param input Pointer to input data, padded by (kernel-1)/2 on each side
+     * @param weightsAndBiases Pointer to bias data, followed by weight data in [channel][ky][kx] order
+     * @param chans Number of channels
+     * @param kernel Kernel size
+     * @param width Unpadded width of input
+     * @param height Unpadded height of input
+     * @param down Downsampling factor (stride)
+     * @param dilX Horizontal dilation factor
+     * @param dilY Vertical dilation factor
+     *
+     * @return Unpadded output data
+     *
+     * @note With dilation, the input is expected to be padded by max(dilX,dilY)*(kernel-1)/2
+     */
+    float * paddedDepthwiseConvolution(const float *input, const float *weightsAndBiases, int chans, int kernel, int width, int height, int down=1, int dilX=1, int dilY=1) const {
+        int pad = std::max(dilX, dilY) * ((kernel-1)/2);
+        int xoff = pad - dilX * ((kernel-1)/2);
+        int yoff = pad - dilY * ((kernel-1)/2);
+        int instride = width + 2*pad;
+        int incstride = instride * (height + 2*pad);
+        int outwidth = width / down;
+        int outheight = height / down;
+        float * result = new float[outwidth * outheight * chans];
+        const float * weights = weightsAndBiases + chans;
+        for (int c=0; c < chans; c++) {
+            for (int yo=0; yo < outheight; yo++) {
+                for (int xo=0; xo < outwidth; xo++) {
+                    float accu = weightsAndBiases[c];
+                    for (int ky=0; ky < kernel; ky++) {
+                        for (int kx=0; kx < kernel; kx++) {
+                            accu += input[c*incstride + (yo*down+yoff+ky*dilY)*instride + xo*down+xoff+kx*dilX] * weights[(c*kernel + ky)*kernel + kx];
+                        }
+                    }
+                    result[(c*outheight + yo)*outwidth + xo] = accu;
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Run depthwise convolution with fused pointwise convolution, clipping and batchnorm
+     *
+     * @param kernel Kernel size of depthwise part
+     * @param down Downsampling factor (stride) of depthwise part
+     * @param useResidual If set to \c true, a residual is added to the output
+     */
+    void depthwisePointwise(int kernel, int down, bool useResidual) {
+        const int width = 38;
+        const int height = 26;
+        const int inchans = 12;
+        const int outchans = 20;
+        const int pad = (kernel-1)/2;
+        const int owidth = width / down;
+        const int oheight = height / down;
+        std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+        gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(kernel,"conv");
+        bld->context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+        bld->groupSize(inchans).downsample(down).clip(0.f, 6.f).pointwise(ActType::CLIP);
+        bld->postfixNorm(NormType::BATCHNORM);
+        if (useResidual) bld->residual().residualPadding(1);
+        bld->push(factory);
+        CompiledLayers layers = factory->compileLayers();
+        gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+        ASSERT_NE(dynamic_cast<gpu::deep::DeepDepthwiseConvLayerNxN *>(layer), nullptr);
+        std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, width, height, -2.f, 3.f, pad));
+        std::unique_ptr<float[]> residual(generateRandomIntegerData(outchans, owidth, oheight, -2.f, 2.f));
+        std::vector<const float *> inputs{input.get()};
+        generateTextures(layer, inputs, (useResidual) ? residual.get() : nullptr, true);
+        int taps = kernel * kernel;
+        int pwoffset = inchans * (taps + 1);
+        int bnoffset = pwoffset + outchans * (inchans + 1);
+        std::unique_ptr<float[]> params(new float[bnoffset + 2 * outchans]);
+        for (int c=0; c < inchans; c++) {
+            params[c] = 0.5f * (float)(c % 3);
+            for (int i=0; i < taps; i++) params[inchans + c*taps + i] = (float)((c + 2*i) % 5 - 2) * 0.5f;
+        }
+        for (int o=0; o < outchans; o++) {
+            params[pwoffset + o] = 0.25f * (float)(o % 4);
+            for (int i=0; i < inchans; i++) params[pwoffset + outchans + o*inchans + i] = (float)((o + 3*i) % 7 - 3) * 0.25f;
+            params[bnoffset + o] = 0.5f * (float)(o % 3 + 1);
+            params[bnoffset + outchans + o] = (float)(o % 5) - 2.f;
+        }
+        std::unique_ptr<float[]> dw(paddedDepthwiseConvolution(input.get(), params.get(), inchans, kernel, width, height, down));
+        for (int i=0; i < inchans * owidth * oheight; i++) dw[i] = std::min(6.f, std::max(0.f, dw[i]));
+        std::unique_ptr<float[]> pw(paddedConvolution(dw.get(), params.get() + pwoffset, outchans, 1, 1, inchans, owidth, oheight));
+        std::unique_ptr<float[]> ref(batchnorm(pw.get(), params.get() + bnoffset, params.get() + bnoffset + outchans, owidth, oheight, outchans));
+        layer->loadWeightsAndBiases(params.get(), 0);
+        layer->setup();
+        layer->forward(1);
+        std::unique_ptr<float[]> result(new float[outchans * owidth * oheight]);
+        layer->copyResult(result.get());
+        layer->cleanup();
+        for (int i=0; i < outchans * owidth * oheight; i++) {
+            ASSERT_NEAR(result[i], ref[i] + ((useResidual) ? residual[i] : 0.f), 1e-3f * std::max(1.f, std::abs(ref[i])));
+        }
+    }
+
+    /**
+     * @brief Reference implementation of a dilated convolution on padded input
+     *
+     * @param input Pointer to input data, padded by \p pad on each side
+     * @param weightsAndBiases Pointer to bias data, followed by weight data in the same order as
+     *                         paddedConvolution()
+     * @param outchans Number of output channels
+     * @param kernel Kernel size
+     * @param inchans Number of input channels
+     * @param width Unpadded width of input
+     * @param height Unpadded height of input
+     * @param pad Padding of the input
+     * @param dilX Horizontal dilation factor
+     * @param dilY Vertical dilation factor
+     *
+     * @return Unpadded output data
+     */
+    float * dilatedConvolution(const float *input, const float *weightsAndBiases, int outchans, int kernel, int inchans, int width, int height, int pad, int dilX, int dilY) const {
+        int instride = width + 2*pad;
+        int incstride = instride * (height + 2*pad);
+        int mid = (kernel-1)/2;
+        float * result = new float[width * height * outchans];
+        const float * weights = weightsAndBiases + outchans;
+        for (int oc=0; oc < outchans; oc++) {
+            for (int y=0; y < height; y++) {
+                for (int x=0; x < width; x++) {
+                    float accu = weightsAndBiases[oc];
+                    for (int ky=0; ky < kernel; ky++) {
+                        for (int kx=0; kx < kernel; kx++) {
+                            const float * in = input + (pad + y + (ky-mid)*dilY)*instride + pad + x + (kx-mid)*dilX;
+                            for (int ic=0; ic < inchans; ic++) {
+                                accu += in[ic*incstride] * weights[oc*inchans*kernel*kernel + ky*kernel*inchans + kx*inchans + ic];
+                            }
+                        }
+                    }
+                    result[(oc*height + y)*width + x] = accu;
+                }
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Run a (depthwise) convolution with anisotropic dilation on a deep tensor
+     *
+     * @param kernel Kernel size
+     * @param dilX Horizontal dilation factor
+     * @param dilY Vertical dilation factor
+     * @param depthwise If set to \c true, a depthwise convolution is performed
+     */
+    void dilated(int kernel, int dilX, int dilY, bool depthwise) {
+        const int width = 35;
+        const int height = 27;
+        const int inchans = 12;
+        const int outchans = (depthwise) ? inchans : 8;
+        const int pad = gpu::deep::DeepTiler::requiredInputPadding(kernel, dilX, dilY);
+        std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+        gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(kernel,"conv");
+        bld->context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+        bld->dilation(dilX, dilY);
+        if (depthwise) bld->groupSize(inchans);
+        bld->push(factory);
+        CompiledLayers layers = factory->compileLayers();
+        gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+        ASSERT_NE(layer, nullptr);
+        if (!depthwise) {
+            ASSERT_NE(dynamic_cast<gpu::deep::DeepConvLayerNxN *>(layer), nullptr);
+        }
+        std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, width, height, -2.f, 3.f, pad));
+        std::vector<const float *> inputs{input.get()};
+        generateTextures(layer, inputs, nullptr, true);
+        int taps = kernel * kernel;
+        int weights = (depthwise) ? inchans * taps : inchans * outchans * taps;
+        std::unique_ptr<float[]> wandb(new float[outchans + weights]);
+        for (int o=0; o < outchans; o++) wandb[o] = 0.25f * (float)(o % 5);
+        for (int i=0; i < weights; i++) wandb[outchans + i] = (float)((3*i + i/7) % 5 - 2) * 0.5f;
+        std::unique_ptr<float[]> ref((depthwise) ? paddedDepthwiseConvolution(input.get(), wandb.get(), inchans, kernel, width, height, 1, dilX, dilY)
+                                                 : dilatedConvolution(input.get(), wandb.get(), outchans, kernel, inchans, width, height, pad, dilX, dilY));
+        layer->loadWeightsAndBiases(wandb.get(), 0);
+        layer->setup();
+        layer->forward(1);
+        std::unique_ptr<float[]> result(new float[outchans * width * height]);
+        layer->copyResult(result.get());
+        layer->cleanup();
+        for (int i=0; i < outchans * width * height; i++) {
+            ASSERT_NEAR(result[i], ref[i], 1e-3f * std::max(1.f, std::abs(ref[i])));
+        }
+    }
+
+    /**
+     * @brief Run a convolution on a deep tensor with a folded resize of its input
+     *
+     * @param kernel Kernel size
+     * @param srcWidth Width of the input tensor (before resizing)
+     * @param srcHeight Height of the input tensor (before resizing)
+     * @param width Width of the resized tensor (and the output)
+     * @param height Height of the resized tensor (and the output)
+     * @param type Interpolation type for the resize
+     * @param alignCorners If set to \c true, the corner pixels are aligned when resizing
+     */
+    void resizedInput(int kernel, int srcWidth, int srcHeight, int width, int height, ScalingType type, bool alignCorners) {
+        const int inchans = 12;
+        const int outchans = 8;
+        const int pad = (kernel-1)/2;
+        std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+        gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(kernel,"conv");
+        bld->context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+        bld->resizeInput(srcWidth, srcHeight, type, alignCorners);
+        bld->push(factory);
+        CompiledLayers layers = factory->compileLayers();
+        gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+        ASSERT_NE(layer, nullptr);
+        std::vector<BufferSpec> inbufs = layer->getRequiredInputBuffers();
+        // the input texture has the source size, we use a layer with that input size to generate it
+        gpu::ScaleLayerBuilder srcbld("source");
+        srcbld.context(context()).shape(inchans, srcHeight, srcWidth, inchans).type(LayerType::SCALE2D).deep().inputPadding(pad).size(width, height);
+        gpu::deep::DeepResizeLayer source(srcbld, 2);
+        std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, srcWidth, srcHeight, -2.f, 3.f));
+        std::vector<const float *> inputs{input.get()};
+        size_t texbase = testTextures_.size();
+        generateTextures(&source, inputs, nullptr);
+        ASSERT_EQ(source.getRequiredInputBuffers().at(0).width_, inbufs.at(0).width_);
+        ASSERT_EQ(source.getRequiredInputBuffers().at(0).height_, inbufs.at(0).height_);
+        GLuint intex = testTextures_.at(texbase);
+        generateTextures(layer, std::vector<const float *>(), nullptr);
+        layer->addInputTexture(intex, 0);
+        int taps = kernel * kernel;
+        std::unique_ptr<float[]> wandb(new float[outchans + inchans * outchans * taps]);
+        for (int o=0; o < outchans; o++) wandb[o] = 0.25f * (float)(o % 5);
+        for (int i=0; i < inchans * outchans * taps; i++) wandb[outchans + i] = (float)((3*i + i/7) % 5 - 2) * 0.5f;
+        std::unique_ptr<float[]> resized(referenceResize(input.get(), inchans, srcWidth, srcHeight, width, height, (type == ScalingType::LINEAR), alignCorners, pad));
+        std::unique_ptr<float[]> ref(dilatedConvolution(resized.get(), wandb.get(), outchans, kernel, inchans, width, height, pad, 1, 1));
+        layer->loadWeightsAndBiases(wandb.get(), 0);
+        layer->setup();
+        layer->forward(1);
+        std::unique_ptr<float[]> result(new float[outchans * width * height]);
+        layer->copyResult(result.get());
+        layer->cleanup();
+        for (int i=0; i < outchans * width * height; i++) {
+            // NOTE the interpolated input is fed to the convolution at reduced precision, hence the absolute tolerance
+            ASSERT_NEAR(result[i], ref[i], std::max(0.15f, 1e-2f * std::abs(ref[i])));
+        }
+    }
+
+    /**
+     * @brief Run a convolution on a deep tensor with weights that are quantized to 8-bit integers
+     *
+     * @param kernel Kernel size
+     * @param postBN If set to \c true, a batchnorm is applied after the convolution
+     *
+     * The weights are chosen to be exactly representable after the quantization (and in 16-bit
+     * floating-point), such that the result can be compared to the unquantized reference.
+     */
+    void quantized(int kernel, bool postBN) {
+        const int width = 23;
+        const int height = 17;
+        const int inchans = 10;
+        const int outchans = 6;
+        const int pad = (kernel-1)/2;
+        std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+        gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(kernel,"conv");
+        bld->context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+        bld->quantizeWeights();
+        if (postBN) bld->postfixNorm(NormType::BATCHNORM);
+        bld->push(factory);
+        CompiledLayers layers = factory->compileLayers();
+        gpu::deep::DeepConvLayerBase * layer = dynamic_cast<gpu::deep::DeepConvLayerBase *>(layers["conv"]);
+        ASSERT_NE(layer, nullptr);
+        ASSERT_TRUE(layer->hasQuantizedWeights());
+        std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, width, height, -2.f, 3.f, pad));
+        std::vector<const float *> inputs{input.get()};
+        generateTextures(layer, inputs, nullptr, true);
+        int chanweights = inchans * kernel * kernel;
+        int wbsize = outchans + outchans * chanweights;
+        std::unique_ptr<float[]> params(new float[wbsize + 2 * outchans]);
+        for (int o=0; o < outchans; o++) {
+            float scale = 0.5f * (float)(1 + o % 3);
+            params[o] = 0.25f * (float)(o % 5);
+            for (int i=0; i < chanweights; i++) {
+                int q = 127 * ((7*i + i/5 + 3*o) % 3 - 1);
+                params[outchans + o*chanweights + i] = scale * (float)q / 127.f;
+            }
+            params[wbsize + o] = 0.5f + 0.25f * (float)(o % 4);
+            params[wbsize + outchans + o] = (float)(o % 3) - 1.f;
+        }
+        std::unique_ptr<float[]> ref(dilatedConvolution(input.get(), params.get(), outchans, kernel, inchans, width, height, pad, 1, 1));
+        if (postBN) ref.reset(batchnorm(ref.get(), params.get() + wbsize, params.get() + wbsize + outchans, width, height, outchans));
+        layer->loadWeightsAndBiases(params.get(), 0);
+        layer->setup();
+        layer->forward(1);
+        std::unique_ptr<float[]> result(new float[outchans * width * height]);
+        layer->copyResult(result.get());
+        layer->cleanup();
+        for (int i=0; i < outchans * width * height; i++) {
+            ASSERT_NEAR(result[i], ref[i], 1e-3f * std::max(1.f, std::abs(ref[i])));
+        }
+    }
+
+    /**
+     * @brief Concatenate the outputs of two deep convolutions, connected by a BufferManager
+     *
+     * @param chansA Number of output channels of the first (3x3) convolution
+     * @param chansB Number of output channels of the second (1x1) convolution
+     * @param views Expected usage of output views, i.e. if the convolutions are expected to render
+     *              directly into the output of the concatenation
+     */
+    void concatenated(int chansA, int chansB, bool views) {
+        const int width = 19;
+        const int height = 13;
+        const int inchans = 4;
+        const int outchans = chansA + chansB;
+        std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+        gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(3, "conva");
+        bld->context(context()).shape(chansA, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(1).outputPadding(1);
+        bld->push(factory);
+        bld = new gpu::ConvLayerBuilder(1, "convb");
+        bld->context(context()).shape(chansB, height, width, inchans).type(LayerType::CONVOLUTION2D).number(2).deep().inputPadding(1).outputPadding(1);
+        bld->push(factory);
+        gpu::ConcatLayerBuilder * cbld = new gpu::ConcatLayerBuilder("concat");
+        cbld->context(context()).shape(outchans, height, width, outchans).type(LayerType::CONCAT).number(3).deep().inputPadding(1).outputPadding(1);
+        cbld->input(chansA, 1).input(chansB, 1);
+        cbld->push(factory);
+        CompiledLayers layers = factory->compileLayers();
+        gpu::deep::DeepConvLayerBase * conva = dynamic_cast<gpu::deep::DeepConvLayerBase *>(layers["conva"]);
+        gpu::deep::DeepConvLayerBase * convb = dynamic_cast<gpu::deep::DeepConvLayerBase *>(layers["convb"]);
+        gpu::deep::DeepConcatLayer * concat = dynamic_cast<gpu::deep::DeepConcatLayer *>(layers["concat"]);
+        ASSERT_NE(conva, nullptr);
+        ASSERT_NE(convb, nullptr);
+        ASSERT_NE(concat, nullptr);
+        std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, width, height, -2.f, 3.f, 1));
+        std::vector<const float *> inputs{input.get()};
+        // NOTE the output textures are supplied by the buffer manager
+        generateTextures(conva, inputs, nullptr, true);
+        generateTextures(convb, inputs, nullptr, true);
+        conva->clearOutputTextures();
+        convb->clearOutputTextures();
+        BufferManager buffers(context());
+        buffers.connectLayers(conva, concat, 0);
+        buffers.connectLayers(convb, concat, 1);
+        buffers.createGPUOutput(concat);
+        ASSERT_EQ(conva->hasOutputView(), views);
+        ASSERT_EQ(convb->hasOutputView(), views);
+        std::unique_ptr<float[]> ref(new float[outchans * width * height]);
+        gpu::deep::DeepConvLayerBase * convs[2] = {conva, convb};
+        int offset = 0;
+        for (int l=0; l < 2; l++) {
+            int kernel = (l == 0) ? 3 : 1;
+            int chans = (l == 0) ? chansA : chansB;
+            int chanweights = inchans * kernel * kernel;
+            std::unique_ptr<float[]> params(new float[chans + chans * chanweights]);
+            for (int o=0; o < chans; o++) {
+                params[o] = (float)(o % 3) - (float)l;
+                for (int i=0; i < chanweights; i++) params[chans + o*chanweights + i] = (float)((5*i + 3*o + l) % 3 - 1);
+            }
+            std::unique_ptr<float[]> lref(dilatedConvolution(input.get(), params.get(), chans, kernel, inchans, width, height, 1, 1, 1));
+            memcpy(ref.get() + offset * width * height, lref.get(), chans * width * height * sizeof(float));
+            offset += chans;
+            convs[l]->loadWeightsAndBiases(params.get(), 0);
+            convs[l]->setup();
+        }
+        concat->setup();
+        conva->forward(1);
+        convb->forward(1);
+        concat->forward(1);
+        std::unique_ptr<float[]> result(new float[outchans * width * height]);
+        concat->copyResult(result.get());
+        for (int i=0; i < outchans * width * height; i++) {
+            ASSERT_EQ(result[i], ref[i]);
+        }
+        // the producers must still deliver their own part of the tensor
+        convb->copyResult(result.get());
+        for (int i=0; i < chansB * width * height; i++) {
+            ASSERT_EQ(result[i], ref[chansA * width * height + i]);
+        }
+        conva->cleanup();
+        convb->cleanup();
+        concat->cleanup();
+        buffers.cleanup();
+    }
+
     float * batchnorm(const float *input, const float * scales, const float * bias, int width, int height, int chans) const {
         float * output = new float[width*height*chans];
         int cstride = width*height;
@@ -152,6 +540,22 @@ class ParamConvLayerTestNxN: public ConvLayerTest, public ::testing::WithParamIn
 };
 
 
+class ParamComputeConvLayerTest: public ConvLayerTest, public ::testing::WithParamInterface<ConvParam> {
+};
+
+
+class ParamComputeArrayConvLayerTest: public ConvLayerTest, public ::testing::WithParamInterface<std::tuple<bool,bool>> {
+};
+
+
+class ParamWinogradConvLayerTest: public ConvLayerTest, public ::testing::WithParamInterface<ConvParam> {
+};
+
+
+class ParamDepthwiseConvLayerTest: public ConvLayerTest, public ::testing::WithParamInterface<ConvParam> {
+};
+
+
 //-----------------------------------------------------------------------------
 // Test Fixtures
 //-----------------------------------------------------------------------------
@@ -305,6 +709,297 @@ TEST_P(ParamConvLayerTestNxN, DeepConvNxN) {
 }
 
 
+TEST_P(ParamComputeConvLayerTest, DeepComputeConv) {
+    auto param = GetParam();
+    if (!fyusion::opengl::GLInfo::supportsComputeShader()) {
+        std::cerr << "Compute shaders not supported, skipping test\n";
+        return;
+    }
+    std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+    gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(param.kernel,"conv");
+    int pad = (param.kernel-1)/2;
+    bld->context(context()).shape(param.outchans, param.height, param.width, param.inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+    bld->downsample(param.downsample).compute();
+    bld->push(factory);
+    CompiledLayers layers = factory->compileLayers();
+    gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+    ASSERT_NE(layer, nullptr);
+    ASSERT_NE(dynamic_cast<gpu::deep::DeepComputeConvLayer *>(layer), nullptr);
+    std::unique_ptr<float[]> input(generateRandomIntegerData(param.inchans, param.width, param.height, 0.f, 3.f, pad));
+    ASSERT_NE(input, nullptr);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(layer, inputs, nullptr, true);
+    std::unique_ptr<float[]> ckernel(new float[param.kernel * param.kernel]);
+    int mid = (param.kernel * param.kernel - 1) / 2;
+    for (int i=0; i < param.kernel*param.kernel; i++) {
+        if (i < mid) ckernel[i] = -1.f;
+        else if (i == mid) ckernel[i] = 1.f;
+        else ckernel[i] = (i & 1) ? 1.f : 0.f;
+    }
+    std::unique_ptr<float[]> wandb(stackConvolution(0.5f, ckernel.get(), param.kernel, param.kernel, param.inchans, param.outchans));
+    int pwidth = param.width + pad * 2;
+    int pheight = param.height + pad * 2;
+    std::unique_ptr<float[]> ref(paddedConvolution(input.get(), wandb.get(), param.outchans, param.kernel, param.kernel, param.inchans, pwidth, pheight, param.downsample, param.downsample));
+    layer->loadWeightsAndBiases(wandb.get(), 0);
+    layer->setup();
+    layer->forward(1);
+    std::unique_ptr<float[]> result(new float[param.outchans * param.width * param.height]);
+    layer->copyResult(result.get());
+    layer->cleanup();
+    const float * resptr = result.get();
+    const float * refptr = ref.get();
+    int outwidth = param.width / param.downsample;
+    int outheight = param.height / param.downsample;
+    for (int i=0; i < outwidth * outheight * param.outchans; i++) {
+        ASSERT_NEAR(resptr[i], refptr[i], 1e-3f);
+    }
+}
+
+
+TEST_P(ParamComputeArrayConvLayerTest, DeepComputeConvArray) {
+    bool arrayin = std::get<0>(GetParam());
+    bool arrayout = std::get<1>(GetParam());
+    if (!fyusion::opengl::GLInfo::supportsComputeShader()) {
+        std::cerr << "Compute shaders not supported, skipping test\n";
+        return;
+    }
+    const int kernel = 3;
+    const int width = 48;
+    const int height = 40;
+    const int inchans = 16;
+    const int outchans = 12;
+    const int pad = (kernel-1)/2;
+    std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+    gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(kernel,"conv");
+    bld->context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+    bld->compute().textureArray(arrayin, arrayout);
+    bld->push(factory);
+    CompiledLayers layers = factory->compileLayers();
+    gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+    ASSERT_NE(dynamic_cast<gpu::deep::DeepComputeConvLayer *>(layer), nullptr);
+    ASSERT_EQ(layer->getRequiredInputBuffers().at(0).dataOrder_ == BufferSpec::order::GPU_DEEP_ARRAY, arrayin);
+    ASSERT_EQ(layer->getRequiredOutputBuffers().at(0).dataOrder_ == BufferSpec::order::GPU_DEEP_ARRAY, arrayout);
+    std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, width, height, 0.f, 3.f, pad));
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(layer, inputs, nullptr, true);
+    float ckernel[kernel*kernel] = {-1.f, -1.f, -1.f, -1.f, 1.f, 1.f, 0.f, 1.f, 0.f};
+    std::unique_ptr<float[]> wandb(stackConvolution(0.5f, ckernel, kernel, kernel, inchans, outchans));
+    std::unique_ptr<float[]> ref(paddedConvolution(input.get(), wandb.get(), outchans, kernel, kernel, inchans, width + 2*pad, height + 2*pad, 1, 1));
+    layer->loadWeightsAndBiases(wandb.get(), 0);
+    layer->setup();
+    layer->forward(1);
+    std::unique_ptr<float[]> result(new float[outchans * width * height]);
+    layer->copyResult(result.get());
+    layer->cleanup();
+    for (int i=0; i < outchans * width * height; i++) {
+        ASSERT_NEAR(result[i], ref[i], 1e-3f);
+    }
+}
+
+
+TEST_P(ParamWinogradConvLayerTest, DeepWinogradConv3x3) {
+    auto param = GetParam();
+    const int pad = 1;
+    std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+    gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(3,"conv");
+    bld->context(context()).shape(param.outchans, param.height, param.width, param.inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+    bld->winograd();
+    bld->push(factory);
+    CompiledLayers layers = factory->compileLayers();
+    gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+    ASSERT_NE(dynamic_cast<gpu::deep::DeepWinogradConvLayer *>(layer), nullptr);
+    std::unique_ptr<float[]> input(generateRandomIntegerData(param.inchans, param.width, param.height, 0.f, 3.f, pad));
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(layer, inputs, nullptr, true);
+    float ckernel[9] = {-1.f, -1.f, -1.f, -1.f, 1.f, 1.f, 0.f, 1.f, 0.f};
+    std::unique_ptr<float[]> wandb(stackConvolution(0.5f, ckernel, 3, 3, param.inchans, param.outchans));
+    std::unique_ptr<float[]> ref(paddedConvolution(input.get(), wandb.get(), param.outchans, 3, 3, param.inchans, param.width + 2*pad, param.height + 2*pad));
+    layer->loadWeightsAndBiases(wandb.get(), 0);
+    layer->setup();
+    layer->forward(1);
+    std::unique_ptr<float[]> result(new float[param.outchans * param.width * param.height]);
+    layer->copyResult(result.get());
+    layer->cleanup();
+    for (int i=0; i < param.outchans * param.width * param.height; i++) {
+        ASSERT_NEAR(result[i], ref[i], 1e-3f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_F(ConvLayerTest, DeepWinogradConv3x3Epilogue) {
+    const int width = 30;
+    const int height = 22;
+    const int inchans = 8;
+    const int outchans = 8;
+    const int pad = 1;
+    std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+    gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(3,"conv");
+    bld->context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+    bld->prefixAct(ActType::RELU).postfixNorm(NormType::BATCHNORM).residual().residualPadding(1).winograd();
+    bld->push(factory);
+    CompiledLayers layers = factory->compileLayers();
+    gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+    ASSERT_NE(dynamic_cast<gpu::deep::DeepWinogradConvLayer *>(layer), nullptr);
+    std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, width, height, -2.f, 3.f, pad));
+    std::unique_ptr<float[]> residual(generateRandomIntegerData(outchans, width, height, -2.f, 2.f));
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(layer, inputs, residual.get(), true);
+    float ckernel[9] = {0.f, 1.f, 0.f, -1.f, 2.f, 1.f, 0.f, -1.f, 0.f};
+    std::unique_ptr<float[]> wandb(stackConvolution(0.5f, ckernel, 3, 3, inchans, outchans));
+    int wbsize = outchans + 9 * inchans * outchans;
+    std::unique_ptr<float[]> params(new float[wbsize + 2 * outchans]);
+    memcpy(params.get(), wandb.get(), wbsize * sizeof(float));
+    for (int i=0; i < outchans; i++) {
+        params[wbsize + i] = 0.5f * (float)(i + 1);
+        params[wbsize + outchans + i] = (float)i - 2.f;
+    }
+    std::unique_ptr<float[]> conv(paddedConvolution(input.get(), wandb.get(), outchans, 3, 3, inchans, width + 2*pad, height + 2*pad, 1, 1, true));
+    std::unique_ptr<float[]> ref(batchnorm(conv.get(), params.get() + wbsize, params.get() + wbsize + outchans, width, height, outchans));
+    layer->loadWeightsAndBiases(params.get(), 0);
+    layer->setup();
+    layer->forward(1);
+    std::unique_ptr<float[]> result(new float[outchans * width * height]);
+    layer->copyResult(result.get());
+    layer->cleanup();
+    for (int i=0; i < outchans * width * height; i++) {
+        ASSERT_NEAR(result[i], ref[i] + residual[i], 1e-3f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_F(ConvLayerTest, DeepWinogradConv3x3Automatic) {
+    const int width = 64;
+    const int height = 64;
+    const int inchans = 32;
+    const int outchans = 32;
+    const int pad = 1;
+    gpu::ConvLayerBuilder quantized(3,"conv");
+    quantized.context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+    quantized.quantizeWeights();
+    ASSERT_FALSE(gpu::deep::DeepWinogradConvLayer::isPreferred(quantized));
+    std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+    gpu::ConvLayerBuilder * disabled = new gpu::ConvLayerBuilder(3,"direct");
+    disabled->context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+    disabled->winograd(false);
+    disabled->push(factory);
+    gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(3,"conv");
+    bld->context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).number(2).deep().inputPadding(pad).outputPadding(1);
+    bool preferred = gpu::deep::DeepWinogradConvLayer::isPreferred(*bld);
+    bld->push(factory);
+    CompiledLayers layers = factory->compileLayers();
+    ASSERT_NE(dynamic_cast<gpu::deep::DeepConvLayerNxN *>(layers["direct"]), nullptr);
+    gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+    ASSERT_NE(layer, nullptr);
+    // the factory must reuse the (cached) benchmark result
+    ASSERT_EQ(dynamic_cast<gpu::deep::DeepWinogradConvLayer *>(layer) != nullptr, preferred);
+    std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, width, height, 0.f, 3.f, pad));
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(layer, inputs, nullptr, true);
+    float ckernel[9] = {-1.f, -1.f, -1.f, -1.f, 1.f, 1.f, 0.f, 1.f, 0.f};
+    std::unique_ptr<float[]> wandb(stackConvolution(0.5f, ckernel, 3, 3, inchans, outchans));
+    std::unique_ptr<float[]> ref(paddedConvolution(input.get(), wandb.get(), outchans, 3, 3, inchans, width + 2*pad, height + 2*pad));
+    layer->loadWeightsAndBiases(wandb.get(), 0);
+    layer->setup();
+    layer->forward(1);
+    std::unique_ptr<float[]> result(new float[outchans * width * height]);
+    layer->copyResult(result.get());
+    layer->cleanup();
+    for (int i=0; i < outchans * width * height; i++) {
+        ASSERT_NEAR(result[i], ref[i], 1e-3f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_P(ParamDepthwiseConvLayerTest, DeepDepthwiseConvNxN) {
+    auto param = GetParam();
+    const int pad = (param.kernel-1)/2;
+    std::shared_ptr<LayerFactory> factory = LayerFactory::instance(LayerFactory::GPUFactoryType(LayerFactory::GPUFactoryType::VANILLA));
+    gpu::ConvLayerBuilder * bld = new gpu::ConvLayerBuilder(param.kernel,"conv");
+    bld->context(context()).shape(param.inchans, param.height, param.width, param.inchans).type(LayerType::CONVOLUTION2D).number(1).deep().inputPadding(pad).outputPadding(1);
+    bld->groupSize(param.inchans).downsample(param.downsample);
+    bld->push(factory);
+    CompiledLayers layers = factory->compileLayers();
+    gpu::ConvLayerBase * layer = (gpu::ConvLayerBase *)layers["conv"];
+    ASSERT_NE(layer, nullptr);
+    if (param.kernel > 3) {
+        ASSERT_NE(dynamic_cast<gpu::deep::DeepDepthwiseConvLayerNxN *>(layer), nullptr);
+    }
+    std::unique_ptr<float[]> input(generateRandomIntegerData(param.inchans, param.width, param.height, -2.f, 3.f, pad));
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(layer, inputs, nullptr, true);
+    int taps = param.kernel * param.kernel;
+    std::unique_ptr<float[]> wandb(new float[param.inchans * (taps + 1)]);
+    for (int c=0; c < param.inchans; c++) {
+        wandb[c] = 0.25f * (float)(c % 5);
+        for (int i=0; i < taps; i++) wandb[param.inchans + c*taps + i] = (float)((c + i) % 5 - 2) * 0.5f;
+    }
+    std::unique_ptr<float[]> ref(paddedDepthwiseConvolution(input.get(), wandb.get(), param.inchans, param.kernel, param.width, param.height, param.downsample));
+    layer->loadWeightsAndBiases(wandb.get(), 0);
+    layer->setup();
+    layer->forward(1);
+    int outwidth = param.width / param.downsample;
+    int outheight = param.height / param.downsample;
+    std::unique_ptr<float[]> result(new float[param.inchans * outwidth * outheight]);
+    layer->copyResult(result.get());
+    layer->cleanup();
+    for (int i=0; i < param.inchans * outwidth * outheight; i++) {
+        ASSERT_NEAR(result[i], ref[i], 1e-3f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_F(ConvLayerTest, DeepDepthwiseConvPointwise) {
+    depthwisePointwise(5, 2, false);
+}
+
+
+TEST_F(ConvLayerTest, DeepDepthwiseConvPointwiseResidual) {
+    depthwisePointwise(3, 1, true);
+}
+
+
+TEST_F(ConvLayerTest, DeepConvDilated) {
+    dilated(3, 2, 3, false);
+    dilated(5, 3, 1, false);
+}
+
+
+TEST_F(ConvLayerTest, DeepConvLargeDilation) {
+    dilated(3, 9, 2, false);
+}
+
+
+TEST_F(ConvLayerTest, DeepDepthwiseConvDilated) {
+    dilated(3, 2, 3, true);
+    dilated(3, 1, 9, true);
+    dilated(5, 3, 2, true);
+}
+
+
+TEST_F(ConvLayerTest, DeepConvResizedInput) {
+    resizedInput(1, 13, 9, 26, 18, ScalingType::LINEAR, false);
+    resizedInput(3, 13, 9, 26, 18, ScalingType::NEAREST, false);
+    resizedInput(3, 10, 7, 23, 16, ScalingType::LINEAR, true);
+    resizedInput(5, 20, 14, 15, 11, ScalingType::LINEAR, false);
+}
+
+
+TEST_F(ConvLayerTest, DeepConvQuantizedWeights) {
+    quantized(1, false);
+    quantized(1, true);
+    quantized(3, false);
+    quantized(5, true);
+    quantized(7, false);
+}
+
+
+TEST_F(ConvLayerTest, DeepConvConcatViews) {
+    concatenated(8, 4, true);
+    concatenated(8, 6, true);
+    concatenated(6, 4, false);
+}
+
+
 TEST_F(ConvLayerTest, ShallowConv1x1) {
     const int kernel = 1;
     const int width = 32;
@@ -338,6 +1033,43 @@ TEST_F(ConvLayerTest, ShallowConv1x1) {
 
 
 
+TEST_F(ConvLayerTest, ShallowConv3x3UniformBuffer) {
+    const int kernel = 3;
+    const int width = 24;
+    const int height = 20;
+    const int inchans = 8;
+    const int outchans = 12;
+    const int pad = 1;
+    std::unique_ptr<float[]> input(generateRandomIntegerData(inchans, width, height, -2.f, 3.f, pad));
+    ASSERT_NE(input, nullptr);
+    const float ckernel[kernel*kernel] = {-1.f, 1.f, 0.f, 1.f, 2.f, -1.f, 0.f, -1.f, 1.f};
+    std::unique_ptr<float[]> wandb(stackConvolution(0.f, ckernel, kernel, kernel, inchans, outchans));
+    // the coefficients are routed via simple uniforms in the first and via a UBO in the second run
+    std::unique_ptr<float[]> result[2];
+    for (int run=0; run < 2; run++) {
+        bool ubo = (run == 1);
+        gpu::ConvLayerBuilder bld(kernel, "conv");
+        bld.context(context()).shape(outchans, height, width, inchans).type(LayerType::CONVOLUTION2D).inputPadding(pad);
+        bld.uniformBuffer(ubo);
+        gpu::vanilla::ConvLayerNxN layer(bld, 1);
+        std::vector<const float *> inputs{input.get()};
+        generateTextures(&layer, inputs, nullptr);
+        layer.loadWeightsAndBiases(wandb.get(), 0);
+        layer.setup();
+        layer.forward(1);
+        result[run].reset(new float[outchans * width * height]);
+        layer.copyResult(result[run].get());
+        layer.cleanup();
+    }
+    int nonzero = 0;
+    for (int i=0; i < outchans * width * height; i++) {
+        ASSERT_EQ(result[1][i], result[0][i]) << "at index " << i;
+        if (result[0][i] != 0.f) nonzero++;
+    }
+    ASSERT_GT(nonzero, 0);
+}
+
+
 TEST_F(ConvLayerTest, DeepConv5x5) {
     const int kernel = 5;
     const int width = 64;
@@ -483,4 +1215,32 @@ INSTANTIATE_TEST_CASE_P(Conv7x7DS, ParamConvLayerTestNxN, testing::Values(
                                                             ConvParam(7,128,80,16,8,2),
                                                             ConvParam(7,256,128,12,8,2)));
 
+INSTANTIATE_TEST_CASE_P(ConvCompute, ParamComputeConvLayerTest, testing::Values(
+                                                            ConvParam(1,64,64,4,4),
+                                                            ConvParam(1,128,80,16,8,2),
+                                                            ConvParam(3,64,80,4,4),
+                                                            ConvParam(3,128,80,16,12),
+                                                            ConvParam(3,256,128,12,8,2),
+                                                            ConvParam(5,64,80,8,4),
+                                                            ConvParam(7,128,80,16,8,2)));
+
+INSTANTIATE_TEST_CASE_P(ConvWinograd, ParamWinogradConvLayerTest, testing::Values(
+                                                            ConvParam(3,64,64,4,4),
+                                                            ConvParam(3,63,41,12,8),
+                                                            ConvParam(3,128,80,16,12),
+                                                            ConvParam(3,28,28,64,64)));
+
+INSTANTIATE_TEST_CASE_P(ConvDepthwise, ParamDepthwiseConvLayerTest, testing::Values(
+                                                            ConvParam(3,64,64,8,8,2),
+                                                            ConvParam(5,64,64,8,8),
+                                                            ConvParam(5,63,41,12,12,2),
+                                                            ConvParam(7,32,24,16,16),
+                                                            ConvParam(7,40,40,6,6,2),
+                                                            ConvParam(9,20,20,4,4)));
+
+INSTANTIATE_TEST_CASE_P(ConvComputeArray, ParamComputeArrayConvLayerTest, testing::Values(
+                                                            std::make_tuple(true, true),
+                                                            std::make_tuple(true, false),
+                                                            std::make_tuple(false, true)));
+
 // vim: set expandtab ts=4 sw=4:
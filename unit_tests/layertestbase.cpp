@@ -9,6 +9,8 @@
 
 //--------------------------------------- System Headers -------------------------------------------
 
+#include <memory>
+#include <cstring>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -192,6 +194,105 @@ float * LayerTestBase::generateRandomIntegerData(int channels, int width, int he
 }
 
 
+/**
+ * @brief Reference implementation of a spatial resize with nearest-neighbor or bilinear interpolation
+ *
+ * @param input Pointer to unpadded input tensor data
+ * @param channels Number of channels for the tensor
+ * @param width Width of the input tensor
+ * @param height Height of the input tensor
+ * @param outWidth Width of the output tensor
+ * @param outHeight Height of the output tensor
+ * @param linear Use bilinear interpolation instead of nearest-neighbor
+ * @param alignCorners Align the centers of the corner pixels instead of using the half-pixel mapping
+ * @param padding Add isotropic padding in the spatial dimension to the output
+ *
+ * @return Pointer to resized 3D tensor, ownership transferred to caller
+ */
+float * LayerTestBase::referenceResize(const float *input, int channels, int width, int height, int outWidth, int outHeight, bool linear, bool alignCorners, int padding) {
+    int stride = outWidth + 2*padding;
+    int cstride = stride * (outHeight + 2*padding);
+    float * data = new float[channels * cstride];
+    memset(data, 0, channels * cstride * sizeof(float));
+    auto source = [&](int dst, int insize, int outsize) -> float {
+        if (alignCorners) return (outsize > 1) ? (float)dst * (float)(insize-1) / (float)(outsize-1) : 0.f;
+        float ratio = (float)insize / (float)outsize;
+        if (linear) return std::max(0.f, ((float)dst + 0.5f) * ratio - 0.5f);
+        return (float)dst * ratio;
+    };
+    for (int c=0; c < channels; c++) {
+        const float * in = input + c * width * height;
+        for (int y=0; y < outHeight; y++) {
+            float sy = source(y, height, outHeight);
+            for (int x=0; x < outWidth; x++) {
+                float sx = source(x, width, outWidth);
+                float val;
+                if (linear) {
+                    int x0 = std::min((int)sx, width-1), y0 = std::min((int)sy, height-1);
+                    int x1 = std::min(x0+1, width-1), y1 = std::min(y0+1, height-1);
+                    float fx = sx - (float)x0, fy = sy - (float)y0;
+                    float top = in[y0*width+x0] * (1.f-fx) + in[y0*width+x1] * fx;
+                    float bottom = in[y1*width+x0] * (1.f-fx) + in[y1*width+x1] * fx;
+                    val = top * (1.f-fy) + bottom * fy;
+                } else {
+                    int xs = (alignCorners) ? (2*x*(width-1) + std::max(1, outWidth-1)) / (2*std::max(1, outWidth-1)) : (x*width) / outWidth;
+                    int ys = (alignCorners) ? (2*y*(height-1) + std::max(1, outHeight-1)) / (2*std::max(1, outHeight-1)) : (y*height) / outHeight;
+                    val = in[std::min(ys, height-1)*width + std::min(xs, width-1)];
+                }
+                data[c*cstride + (y+padding)*stride + x+padding] = val;
+            }
+        }
+    }
+    return data;
+}
+
+
+/**
+ * @brief Create a deep-format texture from (unpadded) tensor data
+ *
+ * @param input Pointer to unpadded input tensor data
+ * @param channels Number of channels for the tensor
+ * @param width Width of the tensor
+ * @param height Height of the tensor
+ * @param padding Isotropic spatial padding of the deep tensor
+ *
+ * @return Texture handle, the texture is added to the list of test textures and deleted on cleanup
+ *
+ * This is useful for layers with multiple input ports that have different shapes, where
+ * generateTextures() cannot be used to create the inputs.
+ */
+GLuint LayerTestBase::deepTexture(const float *input, int channels, int width, int height, int padding) {
+    using namespace fyusion::fyusenet;
+    using namespace fyusion::fyusenet::gpu;
+    deep::DeepTiler tiler(LayerType::CONCAT, width, height, width, height, channels, channels, padding, padding);
+    int iwidth = tiler.getInputTextureWidth();
+    int iheight = tiler.getInputTextureHeight();
+    int tilex = tiler.numInputTiles(deep::DeepTiler::HORIZONTAL);
+    std::unique_ptr<float[]> tmpimg(new float[iwidth * iheight * LayerBase::PIXEL_PACKING]);
+    memset(tmpimg.get(), 0, iwidth * iheight * LayerBase::PIXEL_PACKING * sizeof(float));
+    for (int chan=0; chan < channels; chan++) {
+        int tile = chan / LayerBase::PIXEL_PACKING;
+        int ox = padding + (tile % tilex) * (width + padding);
+        int oy = padding + (tile / tilex) * (height + padding);
+        for (int y=0; y < height; y++) {
+            for (int x=0; x < width; x++) {
+                tmpimg[((oy+y)*iwidth + ox+x) * LayerBase::PIXEL_PACKING + (chan % LayerBase::PIXEL_PACKING)] = input[(chan*height + y)*width + x];
+            }
+        }
+    }
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GPULayerBase::TEXTURE_IFORMAT_4, iwidth, iheight, 0, GL_RGBA, GL_FLOAT, tmpimg.get());
+    testTextures_.push_back(tex);
+    return tex;
+}
+
+
 /**
  * @brief Generate textures from tensor data
  *
@@ -218,7 +319,9 @@ void LayerTestBase::generateTextures(fyusion::fyusenet::gpu::GPULayerBase * laye
     glGetError();
     glGenTextures(totaltex, &testTextures_[ttoffset]);
     ASSERT_EQ(glGetError(), (GLenum)GL_NO_ERROR);    
-    if ((inbufs[0].dataOrder_ == BufferSpec::order::GPU_DEEP) || (outbufs[0].dataOrder_ == BufferSpec::order::GPU_DEEP)) {
+    bool arrayin = (inbufs[0].dataOrder_ == BufferSpec::order::GPU_DEEP_ARRAY);
+    bool arrayout = (outbufs[0].dataOrder_ == BufferSpec::order::GPU_DEEP_ARRAY);
+    if ((inbufs[0].dataOrder_ == BufferSpec::order::GPU_DEEP) || (outbufs[0].dataOrder_ == BufferSpec::order::GPU_DEEP) || arrayin || arrayout) {
         if (dynamic_cast<gpu::deep::DeepLayerBase *>(layer)) {
             tiler_ = dynamic_cast<gpu::deep::DeepLayerBase *>(layer)->getTiler();
             ASSERT_NE(tiler_, nullptr);
@@ -238,6 +341,37 @@ void LayerTestBase::generateTextures(fyusion::fyusenet::gpu::GPULayerBase * laye
             int netheight = layer->getHeight();
             for (int port=0; port < (int)inputs.size(); port++) {
                 const float * input = inputs.at(port);
+                if (arrayin) {
+                    // -------------------------------------------------------
+                    // Handle input for deep-format tensors in texture arrays
+                    // -------------------------------------------------------
+                    int layers = tiler_->numInputTiles();
+                    float *tmpimg = new float[netwidth * netheight * LayerBase::PIXEL_PACKING];
+                    int srcstride = (includesPadding) ? netwidth + 2*padding : netwidth;
+                    int srcstridec = (includesPadding) ? srcstride * (netheight+2*padding) : srcstride * netheight;
+                    const float * src = (includesPadding) ? input + padding*srcstride + padding : input;
+                    glBindTexture(GL_TEXTURE_2D_ARRAY, testTextures_.at(ttoffset + inputtextures));
+                    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GPULayerBase::TEXTURE_IFORMAT_4, netwidth, netheight, layers);
+                    for (int l=0; l < layers; l++) {
+                        memset(tmpimg, 0, netwidth*netheight*LayerBase::PIXEL_PACKING*sizeof(float));
+                        int rem = std::min((int)LayerBase::PIXEL_PACKING, layer->numInputChannels(port) - l*LayerBase::PIXEL_PACKING);
+                        for (int y=0; y < netheight; y++) {
+                            for (int x=0; x < netwidth; x++) {
+                                for (int ichan=0; ichan < rem; ichan++) {
+                                    tmpimg[(y*netwidth+x)*LayerBase::PIXEL_PACKING + ichan] = src[y*srcstride + x + (l*LayerBase::PIXEL_PACKING+ichan) * srcstridec];
+                                }
+                            }
+                        }
+                        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, l, netwidth, netheight, 1, GL_RGBA, GL_FLOAT, tmpimg);
+                    }
+                    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+                    layer->addInputTexture(testTextures_.at(ttoffset + inputtextures), port);
+                    inputtextures++;
+                    delete [] tmpimg;
+                    continue;
+                }
                 // -------------------------------------------
                 // Handle input for deep-format tensor layers
                 // -------------------------------------------
@@ -268,13 +402,13 @@ void LayerTestBase::generateTextures(fyusion::fyusenet::gpu::GPULayerBase * laye
                         chan += LayerBase::PIXEL_PACKING;
                     }
                 }
-                glBindTexture(GL_TEXTURE_2D, testTextures_.at(inputtextures));
+                glBindTexture(GL_TEXTURE_2D, testTextures_.at(ttoffset + inputtextures));
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
                 glTexImage2D(GL_TEXTURE_2D,0,GPULayerBase::TEXTURE_IFORMAT_4,iwidth,iheight,0,GL_RGBA,GL_FLOAT,tmpimg);
-                layer->addInputTexture(testTextures_.at(inputtextures), port);
+                layer->addInputTexture(testTextures_.at(ttoffset + inputtextures), port);
                 inputtextures++;
                 delete [] tmpimg;
             } // input port loop
@@ -303,13 +437,13 @@ void LayerTestBase::generateTextures(fyusion::fyusenet::gpu::GPULayerBase * laye
                         }
                     }
                     remchans -= cmax;
-                    glBindTexture(GL_TEXTURE_2D, testTextures_.at(inputtextures));
+                    glBindTexture(GL_TEXTURE_2D, testTextures_.at(ttoffset + inputtextures));
                     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
                     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
                     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
                     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
                     glTexImage2D(GL_TEXTURE_2D, 0, GPULayerBase::TEXTURE_IFORMAT_4, iwidth, iheight, 0, GL_RGBA, GL_FLOAT, tmpimg);
-                    layer->addInputTexture(testTextures_.at(inputtextures), inputtextures);
+                    layer->addInputTexture(testTextures_.at(ttoffset + inputtextures), inputtextures);
                     inputtextures++;
                 }
                 delete [] tmpimg;
@@ -347,13 +481,13 @@ void LayerTestBase::generateTextures(fyusion::fyusenet::gpu::GPULayerBase * laye
                     chan += LayerBase::PIXEL_PACKING;
                 }
             }
-            glBindTexture(GL_TEXTURE_2D, testTextures_.at(inputtextures));
+            glBindTexture(GL_TEXTURE_2D, testTextures_.at(ttoffset + inputtextures));
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
             glTexImage2D(GL_TEXTURE_2D,0,GPULayerBase::TEXTURE_IFORMAT_4,iwidth,iheight,0,GL_RGBA,GL_FLOAT,tmpres);
-            layer->addResidualTexture(testTextures_.at(inputtextures), 0);
+            layer->addResidualTexture(testTextures_.at(ttoffset + inputtextures), 0);
             residualtextures = 1;
             delete [] tmpres;
         } else {
@@ -378,7 +512,7 @@ void LayerTestBase::generateTextures(fyusion::fyusenet::gpu::GPULayerBase * laye
                     }
                 }
                 remchans -= chanmax;
-                int texidx = inputtextures + slice;
+                int texidx = ttoffset + inputtextures + slice;
                 glBindTexture(GL_TEXTURE_2D, testTextures_.at(texidx));
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
                 glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
@@ -392,26 +526,35 @@ void LayerTestBase::generateTextures(fyusion::fyusenet::gpu::GPULayerBase * laye
         }
     } // residual textures
     // output textures
-    if (outbufs[0].dataOrder_ == BufferSpec::order::GPU_DEEP) {
+    if (arrayout) {
+        ASSERT_NE(tiler_, nullptr);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, testTextures_.at(ttoffset + inputtextures+residualtextures));
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GPULayerBase::TEXTURE_IFORMAT_4, tiler_->getOutputWidth(), tiler_->getOutputHeight(), tiler_->numOutputTiles());
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        layer->addOutputTexture(testTextures_.at(ttoffset + inputtextures+residualtextures), 0);
+    } else if (outbufs[0].dataOrder_ == BufferSpec::order::GPU_DEEP) {
         ASSERT_NE(tiler_, nullptr);
         int owidth = tiler_->getViewportWidth();
         int oheight = tiler_->getViewportHeight();
-        glBindTexture(GL_TEXTURE_2D, testTextures_.at(inputtextures+residualtextures));
+        glBindTexture(GL_TEXTURE_2D, testTextures_.at(ttoffset + inputtextures+residualtextures));
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexImage2D(GL_TEXTURE_2D, 0, GPULayerBase::TEXTURE_IFORMAT_4, owidth, oheight, 0, GL_RGBA, GL_FLOAT, nullptr);
-        layer->addOutputTexture(testTextures_.at(inputtextures+residualtextures), 0);
+        if (outbufs[0].immutable_) glTexStorage2D(GL_TEXTURE_2D, 1, GPULayerBase::TEXTURE_IFORMAT_4, owidth, oheight);
+        else glTexImage2D(GL_TEXTURE_2D, 0, GPULayerBase::TEXTURE_IFORMAT_4, owidth, oheight, 0, GL_RGBA, GL_FLOAT, nullptr);
+        layer->addOutputTexture(testTextures_.at(ttoffset + inputtextures+residualtextures), 0);
     } else {
         for (int slice=0; slice < (int)outbufs.size(); slice++) {
-            glBindTexture(GL_TEXTURE_2D, testTextures_[inputtextures+residualtextures+slice]);
+            glBindTexture(GL_TEXTURE_2D, testTextures_[ttoffset + inputtextures+residualtextures+slice]);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
             glTexImage2D(GL_TEXTURE_2D, 0, GPULayerBase::TEXTURE_IFORMAT_4, layer->getViewport()[0], layer->getViewport()[1], 0, GL_RGBA, GL_FLOAT, nullptr);
-            layer->addOutputTexture(testTextures_.at(inputtextures+residualtextures+slice), slice);
+            layer->addOutputTexture(testTextures_.at(ttoffset + inputtextures+residualtextures+slice), slice);
         }
     }
 }
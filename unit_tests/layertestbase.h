@@ -41,6 +41,8 @@ class LayerTestBase {
     static float * generateRandomData(int channels, int width, int height, float low, float high, int padding=0);
     static float * generateRandomIntegerData(int channels, int width, int height, float low, float high, int padding=0);
     static float * generateBilinearData(int channels, int width, int height, int padding=0);
+    static float * referenceResize(const float *input, int channels, int width, int height, int outWidth, int outHeight, bool linear, bool alignCorners, int padding=0);
+    GLuint deepTexture(const float *input, int channels, int width, int height, int padding=0);
     virtual float * stackConvolution(float bias, const float * channelData, int kernelX, int kernelY, int inputChannels, int outputChannels);
 
 
@@ -14,6 +14,12 @@
 #include <atomic>
 #include <memory>
 #include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
@@ -26,6 +32,19 @@
 #include <fyusenet/gpu/batchnormlayer.h>
 #include <fyusenet/gpu/deep/deepbatchnormlayer.h>
 #include <fyusenet/gpu/deep/deepgemmlayer.h>
+#include <fyusenet/gpu/softmaxlayer.h>
+#include <fyusenet/gpu/deep/deepsoftmaxlayer.h>
+#include <fyusenet/gpu/scalelayerbuilder.h>
+#include <fyusenet/gpu/deep/deepresizelayer.h>
+#include <fyusenet/gpu/deep/deepmatmullayer.h>
+#include <fyusenet/gpu/deep/deeplayernormlayer.h>
+#include <fyusenet/gpu/deep/deepinstancenormlayer.h>
+#include <fyusenet/gpu/instancenormlayer.h>
+#include <fyusenet/gl/pbopool.h>
+#include <fyusenet/gl/programbinarycache.h>
+#include <fyusenet/gl/vertexshader.h>
+#include <fyusenet/gl/fragmentshader.h>
+#include <fyusenet/gl/shaderresource.h>
 #include "layertestbase.h"
 
 //-------------------------------------- Global Variables ------------------------------------------
@@ -140,6 +159,208 @@ class GEMMTest : public MiscLayerTest {
  protected:
 };
 
+
+struct SoftMaxParam {
+    SoftMaxParam(int w, int h, int c, SoftMaxAxis ax, bool lg=false, float rmin=-8.f, float rmax=8.f, bool integral=false) :
+        width(w), height(h), channels(c), axis(ax), log(lg), range{rmin, rmax}, integer(integral) {}
+
+    int width;
+    int height;
+    int channels;
+    SoftMaxAxis axis;
+    bool log;
+    float range[2];
+    bool integer;
+};
+
+
+class SoftMaxTest : public MiscLayerTest, public ::testing::WithParamInterface<SoftMaxParam> {
+ protected:
+
+    float * generateData(const SoftMaxParam& param) const {
+        if (param.integer) return generateRandomIntegerData(param.channels, param.width, param.height, param.range[0], param.range[1]);
+        return generateRandomData(param.channels, param.width, param.height, param.range[0], param.range[1]);
+    }
+
+    /**
+     * Computes reference softmax in double precision, applying the log if requested
+     */
+    float * referenceSoftMax(const float *input, const SoftMaxParam& param) const {
+        int chanstride = param.width * param.height;
+        float * result = new float[param.channels * chanstride];
+        int outer = (param.axis == SoftMaxAxis::CHANNEL) ? chanstride : param.channels;
+        int inner = (param.axis == SoftMaxAxis::CHANNEL) ? param.channels : chanstride;
+        int ostride = (param.axis == SoftMaxAxis::CHANNEL) ? 1 : chanstride;
+        int istride = (param.axis == SoftMaxAxis::CHANNEL) ? chanstride : 1;
+        for (int o=0; o < outer; o++) {
+            double mx = input[o*ostride];
+            for (int i=1; i < inner; i++) mx = std::max(mx, (double)input[o*ostride+i*istride]);
+            double sum = 0.0;
+            for (int i=0; i < inner; i++) sum += exp((double)input[o*ostride+i*istride] - mx);
+            for (int i=0; i < inner; i++) {
+                double v = (double)input[o*ostride+i*istride] - mx;
+                result[o*ostride+i*istride] = (float)((param.log) ? v - log(sum) : exp(v) / sum);
+            }
+        }
+        return result;
+    }
+
+    void compare(const float *ref, const float *gpu, const SoftMaxParam& param) const {
+        for (int i=0; i < param.width * param.height * param.channels; i++) {
+            ASSERT_NEAR(ref[i], gpu[i], 1e-2f + 2e-3f * std::abs(ref[i])) << "at index " << i;
+        }
+    }
+
+    /**
+     * Checks (index, probability) pairs against the reference softmax, ties are resolved by
+     * ascending channel index
+     */
+    void compareTopK(const float *ref, const float *gpu, int width, int height, int channels, int k) const {
+        int chanstride = width * height;
+        for (int p=0; p < chanstride; p++) {
+            std::vector<int> order(channels);
+            for (int c=0; c < channels; c++) order[c] = c;
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return ref[a*chanstride+p] > ref[b*chanstride+p]; });
+            for (int r=0; r < k; r++) {
+                ASSERT_EQ((int)gpu[(2*r)*chanstride+p], order[r]) << "rank " << r << " at position " << p;
+                ASSERT_NEAR(gpu[(2*r+1)*chanstride+p], ref[order[r]*chanstride+p], 1e-4f + 1e-3f * ref[order[r]*chanstride+p]);
+            }
+        }
+    }
+};
+
+
+class SoftMaxTopKTest : public SoftMaxTest {
+};
+
+
+struct ResizeParam {
+    ResizeParam(int w, int h, int c, int ow, int oh, ScalingType t, bool align=false, float sc=0.f) :
+        width(w), height(h), channels(c), outwidth(ow), outheight(oh), type(t), alignCorners(align), scale(sc) {}
+    int width;
+    int height;
+    int channels;
+    int outwidth;
+    int outheight;
+    ScalingType type;
+    bool alignCorners;
+    float scale;            // if non-zero, use scale() instead of size() on the builder
+};
+
+
+class ResizeTest : public MiscLayerTest, public ::testing::WithParamInterface<ResizeParam> {
+};
+
+
+struct MatMulParam {
+    MatMulParam(int wa, int ha, int ca, int wb, int hb, int cb, int b, bool ta, bool tb, float al=1.f) :
+        widthA(wa), heightA(ha), channelsA(ca), widthB(wb), heightB(hb), channelsB(cb), batches(b), transA(ta), transB(tb), alpha(al) {}
+    int widthA;
+    int heightA;
+    int channelsA;
+    int widthB;
+    int heightB;
+    int channelsB;
+    int batches;
+    bool transA;
+    bool transB;
+    float alpha;
+};
+
+
+class MatMulTest : public MiscLayerTest, public ::testing::WithParamInterface<MatMulParam> {
+ protected:
+    // element (r,c) of the matrix in batch b, using the channel-wise storage of the tests
+    static float element(const float *data, int width, int height, int channels, int batches, int b, int r, int c, bool trans) {
+        int chans = channels / batches;
+        int pos = (trans) ? c : r;
+        int chan = (trans) ? r : c;
+        return data[(b * chans + chan) * width * height + pos];
+    }
+
+    float * referenceMatMul(const float *a, const float *b, const MatMulParam& p, int & rows, int & cols) {
+        rows = (p.transA) ? p.channelsA / p.batches : p.widthA * p.heightA;
+        int inner = (p.transA) ? p.widthA * p.heightA : p.channelsA / p.batches;
+        cols = (p.transB) ? p.widthB * p.heightB : p.channelsB / p.batches;
+        float * out = new float[p.batches * rows * cols];
+        for (int bt=0; bt < p.batches; bt++) {
+            for (int r=0; r < rows; r++) {
+                for (int c=0; c < cols; c++) {
+                    double sum = 0.0;
+                    for (int k=0; k < inner; k++) {
+                        sum += element(a, p.widthA, p.heightA, p.channelsA, p.batches, bt, r, k, p.transA) *
+                               element(b, p.widthB, p.heightB, p.channelsB, p.batches, bt, k, c, p.transB);
+                    }
+                    // output channel (bt*cols+c) at spatial position r
+                    out[(bt * cols + c) * rows + r] = (float)(sum * p.alpha);
+                }
+            }
+        }
+        return out;
+    }
+};
+
+
+struct LayerNormParam {
+    LayerNormParam(int w, int h, int c) : width(w), height(h), channels(c) {}
+    int width;
+    int height;
+    int channels;
+};
+
+
+class LayerNormTest : public MiscLayerTest, public ::testing::WithParamInterface<LayerNormParam> {
+ protected:
+    float * referenceLayerNorm(const float *input, const float *scaleBias, const LayerNormParam& p, float eps) {
+        int plane = p.width * p.height;
+        float * out = new float[plane * p.channels];
+        for (int i=0; i < plane; i++) {
+            double mean = 0.0, var = 0.0;
+            for (int c=0; c < p.channels; c++) mean += input[c * plane + i];
+            mean /= (double)p.channels;
+            for (int c=0; c < p.channels; c++) var += (input[c * plane + i] - mean) * (input[c * plane + i] - mean);
+            double rstd = 1.0 / sqrt(var / (double)p.channels + eps);
+            for (int c=0; c < p.channels; c++) {
+                out[c * plane + i] = (float)((input[c * plane + i] - mean) * rstd * scaleBias[c] + scaleBias[p.channels + c]);
+            }
+        }
+        return out;
+    }
+};
+
+
+struct InstanceNormParam {
+    InstanceNormParam(int w, int h, int c, bool sp=false) : width(w), height(h), channels(c), spatial(sp) {}
+    int width;
+    int height;
+    int channels;
+    bool spatial;           // if true, use layer normalization over the whole tensor
+};
+
+
+class InstanceNormTest : public MiscLayerTest, public ::testing::WithParamInterface<InstanceNormParam> {
+ protected:
+    float * referenceInstanceNorm(const float *input, const float *scaleBias, const InstanceNormParam& p, float eps) {
+        int plane = p.width * p.height;
+        int groups = (p.spatial) ? 1 : p.channels;
+        int chans = (p.spatial) ? p.channels : 1;
+        float * out = new float[plane * p.channels];
+        for (int g=0; g < groups; g++) {
+            const float * in = input + g * chans * plane;
+            double mean = 0.0, var = 0.0;
+            for (int i=0; i < chans * plane; i++) mean += in[i];
+            mean /= (double)(chans * plane);
+            for (int i=0; i < chans * plane; i++) var += (in[i] - mean) * (in[i] - mean);
+            double rstd = 1.0 / sqrt(var / (double)(chans * plane) + eps);
+            for (int i=0; i < chans * plane; i++) {
+                int c = g * chans + i / plane;
+                out[g * chans * plane + i] = (float)((in[i] - mean) * rstd * scaleBias[c] + scaleBias[p.channels + c]);
+            }
+        }
+        return out;
+    }
+};
+
 //-----------------------------------------------------------------------------
 // Test Fixtures
 //-----------------------------------------------------------------------------
@@ -183,6 +404,103 @@ TEST_P(ArgMaxTest, ArgMaxTestDeep) {
 
 
 
+TEST_P(SoftMaxTest, SoftMaxTestDeep) {
+    auto param = GetParam();
+    std::unique_ptr<float[]> input(generateData(param));
+    std::unique_ptr<float[]> ref(referenceSoftMax(input.get(), param));
+    gpu::SoftMaxLayerBuilder bld("softmax");
+    bld.axis(param.axis).logSoftMax(param.log).context(context()).shape(param.channels, param.height, param.width, param.channels).deep();
+    gpu::deep::DeepSoftMaxLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[param.channels * param.width * param.height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    compare(ref.get(), result.get(), param);
+}
+
+
+TEST_P(SoftMaxTest, SoftMaxTestShallow) {
+    auto param = GetParam();
+    if (param.channels > gpu::SoftMaxLayer::MAX_SLICES * 4) return;   // too many channels for a shallow tensor
+    std::unique_ptr<float[]> input(generateData(param));
+    std::unique_ptr<float[]> ref(referenceSoftMax(input.get(), param));
+    gpu::SoftMaxLayerBuilder bld("softmax");
+    bld.axis(param.axis).logSoftMax(param.log).context(context()).shape(param.channels, param.height, param.width, param.channels);
+    gpu::SoftMaxLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[param.channels * param.width * param.height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    compare(ref.get(), result.get(), param);
+}
+
+
+TEST_F(SoftMaxTopKTest, SoftMaxTopKDeep) {
+    const int channels = 1000, k = 5;
+    SoftMaxParam param(1, 1, channels, SoftMaxAxis::CHANNEL, false, 0.f, 100.f, true);
+    std::unique_ptr<float[]> input(generateData(param));
+    // duplicate the maximum to check tie-breaking by channel index
+    int mxc = (int)(std::max_element(input.get(), input.get() + channels) - input.get());
+    input[(mxc + 7) % channels] = input[mxc];
+    std::unique_ptr<float[]> ref(referenceSoftMax(input.get(), param));
+    gpu::SoftMaxLayerBuilder bld("softmax");
+    bld.topK(k).context(context()).shape(2*k, 1, 1, channels).deep();
+    gpu::deep::DeepSoftMaxLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[2*k]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    compareTopK(ref.get(), result.get(), 1, 1, channels, k);
+}
+
+
+TEST_F(SoftMaxTopKTest, SoftMaxTopKSpatialDeep) {
+    const int width = 7, height = 5, channels = 37, k = 3;
+    SoftMaxParam param(width, height, channels, SoftMaxAxis::CHANNEL, false, -8.f, 8.f, true);
+    std::unique_ptr<float[]> input(generateData(param));
+    std::unique_ptr<float[]> ref(referenceSoftMax(input.get(), param));
+    gpu::SoftMaxLayerBuilder bld("softmax");
+    bld.topK(k).context(context()).shape(2*k, height, width, channels).deep();
+    gpu::deep::DeepSoftMaxLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[2*k*width*height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    compareTopK(ref.get(), result.get(), width, height, channels, k);
+}
+
+
+TEST_F(SoftMaxTopKTest, SoftMaxTopKShallow) {
+    const int width = 9, height = 4, channels = 14, k = 4;
+    SoftMaxParam param(width, height, channels, SoftMaxAxis::CHANNEL, false, -8.f, 8.f, true);
+    std::unique_ptr<float[]> input(generateData(param));
+    std::unique_ptr<float[]> ref(referenceSoftMax(input.get(), param));
+    gpu::SoftMaxLayerBuilder bld("softmax");
+    bld.topK(k).context(context()).shape(2*k, height, width, channels);
+    gpu::SoftMaxLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[2*k*width*height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    compareTopK(ref.get(), result.get(), width, height, channels, k);
+}
+
+
 TEST_P(BatchNormTest, BNTestShallow) {
     auto param = GetParam();
     std::unique_ptr<float[]> scalebias(generateScaleAndBias(param.channels));
@@ -264,6 +582,240 @@ TEST_F(GEMMTest, DeepGEMM) {
     }
 }
 
+TEST_P(ResizeTest, ResizeTestDeep) {
+    auto param = GetParam();
+    std::unique_ptr<float[]> input(generateRandomIntegerData(param.channels, param.width, param.height, -8.f, 8.f));
+    bool linear = (param.type == ScalingType::LINEAR);
+    std::unique_ptr<float[]> ref(referenceResize(input.get(), param.channels, param.width, param.height, param.outwidth, param.outheight, linear, param.alignCorners));
+    gpu::ScaleLayerBuilder bld("resize");
+    bld.scaleType(param.type).alignCorners(param.alignCorners).context(context()).shape(param.channels, param.height, param.width, param.channels).type(LayerType::SCALE2D).deep().outputPadding(1);
+    if (param.scale > 0.f) bld.scale(param.scale);
+    else bld.size(param.outwidth, param.outheight);
+    ASSERT_TRUE(bld.isResize());
+    ASSERT_EQ(bld.resizedWidth(), param.outwidth);
+    ASSERT_EQ(bld.resizedHeight(), param.outheight);
+    gpu::deep::DeepResizeLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[param.channels * param.outwidth * param.outheight]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    for (int i=0; i < param.channels * param.outwidth * param.outheight; i++) {
+        ASSERT_NEAR(result[i], ref[i], 1e-3f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_P(MatMulTest, MatMulTestDeep) {
+    auto param = GetParam();
+    std::unique_ptr<float[]> a(generateRandomIntegerData(param.channelsA, param.widthA, param.heightA, -2.f, 2.f));
+    std::unique_ptr<float[]> b(generateRandomIntegerData(param.channelsB, param.widthB, param.heightB, -2.f, 2.f));
+    int rows = 0, cols = 0;
+    std::unique_ptr<float[]> ref(referenceMatMul(a.get(), b.get(), param, rows, cols));
+    int outchans = param.batches * cols;
+    gpu::MatMulLayerBuilder bld("matmul");
+    bld.secondInput(param.widthB, param.heightB, param.channelsB).transposeA(param.transA).transposeB(param.transB).batches(param.batches).alpha(param.alpha);
+    bld.context(context()).shape(outchans, param.heightA, param.widthA, param.channelsA).type(LayerType::MATMUL).deep();
+    gpu::deep::DeepMatMulLayer layer(bld, 1);
+    layer.addInputTexture(deepTexture(a.get(), param.channelsA, param.widthA, param.heightA), 0);
+    layer.addInputTexture(deepTexture(b.get(), param.channelsB, param.widthB, param.heightB), 1);
+    generateTextures(&layer, {}, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[rows * outchans]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    for (int i=0; i < rows * outchans; i++) {
+        ASSERT_NEAR(result[i], ref[i], 1e-3f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_P(LayerNormTest, LayerNormTestDeep) {
+    auto param = GetParam();
+    std::unique_ptr<float[]> input(generateRandomData(param.channels, param.width, param.height, -5.f, 5.f));
+    std::unique_ptr<float[]> scalebias(generateRandomData(2 * param.channels, 1, 1, -2.f, 2.f));
+    std::unique_ptr<float[]> ref(referenceLayerNorm(input.get(), scalebias.get(), param, 1e-5f));
+    gpu::LayerNormLayerBuilder bld("lnorm");
+    bld.context(context()).shape(param.channels, param.height, param.width, param.channels).type(LayerType::LAYERNORM).deep();
+    gpu::deep::DeepLayerNormLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.loadScaleAndBias(scalebias.get(), 0);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[param.channels * param.width * param.height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    // NOTE input and output are stored in half precision in the test setup
+    for (int i=0; i < param.channels * param.width * param.height; i++) {
+        ASSERT_NEAR(result[i], ref[i], 2e-2f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_P(InstanceNormTest, InstanceNormTestDeep) {
+    auto param = GetParam();
+    // NOTE add a per-channel offset to make sure that the mean is removed
+    std::unique_ptr<float[]> input(generateRandomData(param.channels, param.width, param.height, -5.f, 5.f));
+    for (int i=0; i < param.channels * param.width * param.height; i++) input[i] += (float)(i / (param.width * param.height));
+    std::unique_ptr<float[]> scalebias(generateRandomData(2 * param.channels, 1, 1, -2.f, 2.f));
+    std::unique_ptr<float[]> ref(referenceInstanceNorm(input.get(), scalebias.get(), param, 1e-5f));
+    gpu::LayerNormLayerBuilder bld("inorm");
+    bld.spatial(param.spatial).context(context()).shape(param.channels, param.height, param.width, param.channels).deep();
+    if (!param.spatial) bld.instance();
+    gpu::deep::DeepInstanceNormLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.loadScaleAndBias(scalebias.get(), 0);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[param.channels * param.width * param.height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    // NOTE input and output are stored in half precision in the test setup
+    for (int i=0; i < param.channels * param.width * param.height; i++) {
+        ASSERT_NEAR(result[i], ref[i], 2e-2f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_P(InstanceNormTest, InstanceNormTestShallow) {
+    auto param = GetParam();
+    std::unique_ptr<float[]> input(generateRandomData(param.channels, param.width, param.height, -5.f, 5.f));
+    for (int i=0; i < param.channels * param.width * param.height; i++) input[i] += (float)(i / (param.width * param.height));
+    std::unique_ptr<float[]> scalebias(generateRandomData(2 * param.channels, 1, 1, -2.f, 2.f));
+    std::unique_ptr<float[]> ref(referenceInstanceNorm(input.get(), scalebias.get(), param, 1e-5f));
+    gpu::LayerNormLayerBuilder bld("inorm");
+    bld.spatial(param.spatial).context(context()).shape(param.channels, param.height, param.width, param.channels);
+    if (!param.spatial) bld.instance();
+    gpu::InstanceNormLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.loadScaleAndBias(scalebias.get(), 0);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[param.channels * param.width * param.height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    for (int i=0; i < param.channels * param.width * param.height; i++) {
+        ASSERT_NEAR(result[i], ref[i], 2e-2f * std::max(1.f, std::abs(ref[i])));
+    }
+}
+
+
+TEST_F(MiscLayerTest, PBOPoolBuckets) {
+    using namespace fyusion::opengl;
+    PBOPool pool(2, context());
+    pool.reserve(16, 16, 4, 4, 1, PBO::READ);
+    int first = -1, second = -1;
+    {
+        ManagedPBO pbo = pool.getAvailablePBO(16, 16, 4, 4);
+        first = pbo.index();
+        ASSERT_GE(pbo->capacity(), 16u*16u*4u*4u);
+    }
+    {
+        // different size class, must not re-purpose the free PBO while below capacity
+        ManagedPBO pbo = pool.getAvailablePBO(8, 8, 4, 4);
+        second = pbo.index();
+        ASSERT_NE(first, second);
+    }
+    ManagedPBO pbo = pool.getAvailablePBO(16, 16, 4, 4);
+    ASSERT_EQ(pbo.index(), first);
+    ManagedPBO other = pool.getAvailablePBO(8, 8, 4, 4);
+    ASSERT_EQ(other.index(), second);
+}
+
+
+TEST_F(MiscLayerTest, PBOPoolWakeup) {
+    using namespace fyusion::opengl;
+    PBOPool pool(1, context());
+    ManagedPBO * held = new ManagedPBO(pool.getAvailablePBO(16, 16, 4, 4));
+    int index = held->index();
+    std::atomic<int> obtained{-1};
+    std::thread waiter([&]() {
+        ManagedPBO pbo = pool.getAvailablePBO(16, 16, 4, 4);
+        obtained.store(pbo.index());
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(obtained.load(), -1);
+    delete held;
+    waiter.join();
+    ASSERT_EQ(obtained.load(), index);
+}
+
+/**
+ * Link the same program twice with the program binary cache enabled and check that the
+ * second instance is loaded from the binary without compiling its shaders
+ */
+TEST_F(MiscLayerTest, ProgramBinaryCache) {
+    using namespace fyusion::opengl;
+    char dir[] = "/tmp/fynbinXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    ProgramBinaryCache::setDirectory(dir);
+    const char * vert = "in vec4 attributes0;\nvoid main(void) {\n  gl_Position = attributes0;\n}\n";
+    const char * frag = "precision highp float;\nuniform vec4 color;\nlayout(location=0) out vec4 fragmentColor0;\n"
+                        "void main(void) {\n  fragmentColor0 = color;\n}\n";
+    auto files = [&]() {
+        std::vector<std::string> names;
+        DIR * d = opendir(dir);
+        while (struct dirent * ent = readdir(d)) {
+            if (ent->d_name[0] != '.') names.push_back(std::string(dir) + "/" + ent->d_name);
+        }
+        closedir(d);
+        return names;
+    };
+    bool supported = (ProgramBinaryCache::getInstance() != nullptr);
+    for (int run = 0; run < 2; run++) {
+        shaderptr vs = VertexShader::fromString(vert, context());
+        shaderptr fs = FragmentShader::fromString(frag, context());
+        programptr prog = ShaderProgram::createInstance(context());
+        prog->addShader(vs);
+        prog->addShader(fs);
+        prog->bindAttributeLocation("attributes0", 0);
+        prog->compile();
+        prog->link();
+        ASSERT_TRUE(prog->isLinked());
+        if (supported) {
+            ASSERT_EQ(files().size(), (size_t)1);
+            if (run == 1) {
+                ASSERT_FALSE(vs->isCompiled());
+            }
+        }
+    }
+    ProgramBinaryCache::setDirectory("");
+    for (const std::string & name : files()) unlink(name.c_str());
+    rmdir(dir);
+}
+
+/**
+ * Register a compressed shader resource (as generated by shaderpp with the --compress option),
+ * check that it is decompressed correctly on access and that malformed data is rejected
+ */
+TEST_F(MiscLayerTest, CompressedShaderResource) {
+    using namespace fyusion::opengl;
+    static const unsigned char packed[61] = {
+        0xa0,0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x0a,0x00,0xfe,0x12,0x29,
+        0x20,0x7b,0x0a,0x20,0x20,0x66,0x72,0x61,0x67,0x6d,0x65,0x6e,0x74,0x43,0x6f,0x6c,
+        0x6f,0x72,0x30,0x20,0x3d,0x20,0x76,0x65,0x63,0x34,0x28,0x30,0x2e,0x30,0x29,0x3b,
+        0x1e,0x00,0x1f,0x2b,0x1f,0x00,0x16,0x50,0x29,0x3b,0x0a,0x7d,0x0a };
+    const char * expected = "void main(void) {\n  fragmentColor0 = vec4(0.0);\n  fragmentColor0 += vec4(0.0);\n"
+                            "  fragmentColor0 += vec4(0.0);\n}\n";
+    ShaderResource res(packed, sizeof(packed), strlen(expected), "test/compressed.frag");
+    const char * code = ShaderRepository::getShader("test/compressed.frag");
+    ASSERT_NE(code, nullptr);
+    ASSERT_STREQ(code, expected);
+    ASSERT_EQ(ShaderRepository::getShader("test/compressed.frag"), code);
+    ShaderResource broken(packed, sizeof(packed) - 8, strlen(expected), "test/broken.frag");
+    ASSERT_EQ(ShaderRepository::getShader("test/broken.frag"), nullptr);
+    // embedded shaders must be accessible regardless of build-time optimization / compression
+    const char * embedded = ShaderRepository::getShader("shaders/deep/deepconv_compute.comp");
+    ASSERT_NE(embedded, nullptr);
+    ASSERT_NE(strstr(embedded, "void main"), nullptr);
+}
+
 // TODO (mw) more test patterns, maybe fuzz-testing with randomization
 
 INSTANTIATE_TEST_CASE_P(ArgMax, ArgMaxTest, testing::Values(
@@ -272,7 +824,47 @@ INSTANTIATE_TEST_CASE_P(ArgMax, ArgMaxTest, testing::Values(
                                                    ArgMaxParam(80, 40, 52),
                                                    ArgMaxParam(200, 200, 4),
                                                    ArgMaxParam(50, 50, 31),
-                                                   ArgMaxParam(40, 40, 128)));
+                                                   ArgMaxParam(40, 40, 128),
+                                                   ArgMaxParam(33, 17, 75)));
+
+INSTANTIATE_TEST_CASE_P(SoftMax, SoftMaxTest, testing::Values(
+                                                   SoftMaxParam(1, 1, 1000, SoftMaxAxis::CHANNEL),
+                                                   SoftMaxParam(1, 1, 1000, SoftMaxAxis::CHANNEL, true),
+                                                   SoftMaxParam(40, 30, 21, SoftMaxAxis::CHANNEL),
+                                                   SoftMaxParam(40, 30, 21, SoftMaxAxis::CHANNEL, true),
+                                                   SoftMaxParam(17, 9, 6, SoftMaxAxis::CHANNEL, false, 60.f, 100.f, true),
+                                                   SoftMaxParam(13, 9, 10, SoftMaxAxis::SPATIAL),
+                                                   SoftMaxParam(13, 9, 10, SoftMaxAxis::SPATIAL, true),
+                                                   SoftMaxParam(300, 2, 3, SoftMaxAxis::SPATIAL, false, 60.f, 100.f, true),
+                                                   SoftMaxParam(8, 8, 70, SoftMaxAxis::SPATIAL)));
+
+INSTANTIATE_TEST_CASE_P(Resize, ResizeTest, testing::Values(
+                                                   ResizeParam(17, 11, 12, 34, 22, ScalingType::LINEAR),
+                                                   ResizeParam(17, 11, 12, 34, 22, ScalingType::NEAREST),
+                                                   ResizeParam(12, 8, 7, 18, 12, ScalingType::LINEAR, false, 1.5f),
+                                                   ResizeParam(12, 8, 7, 30, 13, ScalingType::LINEAR, true),
+                                                   ResizeParam(12, 8, 7, 30, 13, ScalingType::NEAREST, true),
+                                                   ResizeParam(40, 30, 20, 15, 11, ScalingType::LINEAR),
+                                                   ResizeParam(40, 30, 20, 15, 11, ScalingType::NEAREST)));
+
+INSTANTIATE_TEST_CASE_P(MatMul, MatMulTest, testing::Values(
+                                                   MatMulParam(16, 1, 32, 12, 1, 32, 4, false, true),
+                                                   MatMulParam(16, 1, 48, 12, 1, 32, 4, false, false),
+                                                   MatMulParam(5, 3, 8, 5, 3, 12, 1, true, false),
+                                                   MatMulParam(4, 4, 8, 12, 1, 16, 1, true, true),
+                                                   MatMulParam(6, 5, 12, 4, 3, 8, 1, false, false, 0.25f)));
+
+INSTANTIATE_TEST_CASE_P(LayerNorm, LayerNormTest, testing::Values(
+                                                   LayerNormParam(7, 5, 13),
+                                                   LayerNormParam(16, 1, 64),
+                                                   LayerNormParam(9, 9, 100)));
+
+INSTANTIATE_TEST_CASE_P(InstanceNorm, InstanceNormTest, testing::Values(
+                                                   InstanceNormParam(5, 4, 7),
+                                                   InstanceNormParam(33, 17, 12),
+                                                   InstanceNormParam(70, 65, 8),
+                                                   InstanceNormParam(6, 6, 10, true),
+                                                   InstanceNormParam(40, 23, 13, true)));
 
 INSTANTIATE_TEST_CASE_P(BatchNorm, BatchNormTest, testing::Values(
                                                    BNParam(4,4,36),
@@ -9,22 +9,32 @@
 //--------------------------------------- System Headers -------------------------------------------
 
 #include <cstdint>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <atomic>
 #include <memory>
 #include <thread>
+#include <vector>
 
 //-------------------------------------- Project  Headers ------------------------------------------
 
 #include <gtest/gtest.h>
 #include <fyusenet/fyusenet.h>
 #include "gltesthelpers.h"
+#include <fyusenet/gl/shadercompiler.h>
+#include <fyusenet/gl/glstate.h>
 
 //-------------------------------------- Global Variables ------------------------------------------
 
 //-------------------------------------- Local Definitions -----------------------------------------
 
+static const float NET01_FILTER[3*3] = {-1,1,-1,1,0,1,-1,1,-1};   //!< 3x3 filter for all channels of TestNet01
+static constexpr int NET01_SIZE = 32;                             //!< Spatial size of the tensors in TestNet01
+static constexpr int NET01_IN = 4;                                //!< Number of input channels of TestNet01
+static constexpr int NET01_OUT = 8;                               //!< Number of output channels of TestNet01
+
 
 /*##################################################################################################
 #                                   P U B L I C  F U N C T I O N S                                 #
@@ -60,7 +70,7 @@ class NetworkTestBase : public ::testing::Test, public TestContextManager {
  */
 class TestNet01 : public fyusion::fyusenet::NeuralNetwork {
  public:
-    TestNet01(bool async=false) : async_(async) {
+    TestNet01(bool async=false, bool fp16=false) : async_(async), fp16_(fp16) {
     }
 
     ~TestNet01() {
@@ -76,20 +86,30 @@ class TestNet01 : public fyusion::fyusenet::NeuralNetwork {
         }
     }
 
+    fyusion::fyusenet::LayerBase * getLayer(const std::string& name) {
+        return engine_->getLayers()[name];
+    }
+
+    void recording(bool enable) {
+        if (enable) engine_->enableRecording();
+        else engine_->disableRecording();
+    }
+
     fyusion::fyusenet::cpu::CPUBuffer * inputBuffer = nullptr;
     fyusion::fyusenet::cpu::CPUBuffer * outputBuffer = nullptr;
+    float bias = 0.0f;
 
  protected:
 
      virtual void initializeWeights(fyusion::fyusenet::CompiledLayers& layers) override {
-         float filter[3*3] = {-1,1,-1,1,0,1,-1,1,-1};
-         float wb[3*3*4*8+8]={0};         
+         float wb[3*3*4*8+8]={0};
          using namespace fyusion::fyusenet;
          int wbidx=8;
+         for (int o=0; o<8; o++) wb[o] = bias;
          for (int o=0; o<8; o++) {
              for (int y=0; y<3; y++) {
                  for (int x=0; x<3; x++) {
-                     float v = filter[y*3+x];
+                     float v = NET01_FILTER[y*3+x];
                      for (int i=0; i<4; i++) wb[wbidx++] = v;
                      assert(wbidx < (int)sizeof(wb));
                  }
@@ -141,6 +161,7 @@ class TestNet01 : public fyusion::fyusenet::NeuralNetwork {
         std::shared_ptr<LayerFactory> factory = getLayerFactory();
         gpu::UpDownLayerBuilder * up = new gpu::UpDownLayerBuilder(gpu::UpDownLayerBuilder::UPLOAD, "upload");
         up->shape(4, 32, 32, 4).context(context_).number(1);
+        if (fp16_) up->fp16Transfer();
 #ifdef FYUSENET_MULTITHREADING
         if (async_) up->async();
 #endif
@@ -150,6 +171,7 @@ class TestNet01 : public fyusion::fyusenet::NeuralNetwork {
         conv->push(factory);
         gpu::UpDownLayerBuilder * down = new gpu::UpDownLayerBuilder(gpu::UpDownLayerBuilder::DOWNLOAD, "download");
         down->shape(8, 32, 32, 8).context(context_).number(3);
+        if (fp16_) down->fp16Transfer();
 #ifdef FYUSENET_MULTITHREADING
         if (async_) down->async();
 #endif
@@ -163,9 +185,155 @@ class TestNet01 : public fyusion::fyusenet::NeuralNetwork {
     }
 
     bool async_= false;
+    bool fp16_ = false;
+};
+
+
+/**
+ * @brief Simple test network which uploads/preprocesses an 8-bit image and downloads it again
+ */
+class TestNet02 : public fyusion::fyusenet::NeuralNetwork {
+ public:
+    TestNet02() {
+    }
+
+    ~TestNet02() {
+        delete inputBuffer;
+        delete outputBuffer;
+    }
+
+    virtual void setup() override {
+        using namespace fyusion::fyusenet;
+        using namespace fyusion::fyusenet::cpu;
+        NeuralNetwork::setup();
+        if (engine_) {
+            CompiledLayers & layers = engine_->getLayers();
+            auto inspec = layers["upload"]->getRequiredInputBuffers().at(0);
+            ASSERT_EQ(inspec.width_, 8);
+            ASSERT_EQ(inspec.height_, 8);
+            inputBuffer = new CPUBuffer(CPUBufferShape(inspec.height_, inspec.width_, inspec.channels_, 0, CPUBufferShape::UINT8, CPUBufferShape::order::GPU_SHALLOW));
+            uint8_t * in = inputBuffer->map<uint8_t>();
+            ASSERT_NE(nullptr, in);
+            const uint8_t pixel[4] = {50, 100, 150, 200};
+            for (int i=0; i < inspec.width_*inspec.height_; i++) memcpy(in + i*4, pixel, 4);
+            inputBuffer->unmap();
+            (dynamic_cast<cpu::CPULayerInterface *>(layers["upload"]))->setInputBuffer(inputBuffer, 0);
+            auto outspec = layers["download"]->getRequiredOutputBuffers().at(0);
+            outputBuffer = new CPUBuffer(CPUBufferShape(outspec.height_, outspec.width_, outspec.channels_, 0, CPUBufferShape::FLOAT32, CPUBufferShape::order::GPU_SHALLOW));
+            (dynamic_cast<cpu::CPULayerInterface *>(layers["download"]))->addOutputBuffer(outputBuffer, 0);
+        }
+    }
+
+    fyusion::fyusenet::cpu::CPUBuffer * inputBuffer = nullptr;
+    fyusion::fyusenet::cpu::CPUBuffer * outputBuffer = nullptr;
+
+ protected:
+    virtual void initializeWeights(fyusion::fyusenet::CompiledLayers& layers) override {
+    }
 
+    virtual fyusion::fyusenet::CompiledLayers buildLayers() override {
+        using namespace fyusion::fyusenet;
+        std::shared_ptr<LayerFactory> factory = getLayerFactory();
+        gpu::UpDownLayerBuilder * up = new gpu::UpDownLayerBuilder(gpu::UpDownLayerBuilder::UPLOAD, "upload");
+        up->shape(4, 4, 4, 4).dataType(BufferSpec::UBYTE).normalize({10, 20, 30, 40}, {2, 4, 5, 8}).swapRB().sourceSize(8, 8).context(context_).number(1);
+        up->push(factory);
+        gpu::UpDownLayerBuilder * down = new gpu::UpDownLayerBuilder(gpu::UpDownLayerBuilder::DOWNLOAD, "download");
+        down->shape(4, 4, 4, 4).context(context_).number(2);
+        down->push(factory);
+        return factory->compileLayers();
+    }
+
+    virtual void connectLayers(fyusion::fyusenet::CompiledLayers& layers, fyusion::fyusenet::BufferManager * buffers) override {
+        buffers->connectLayers(layers[1], layers[2], 0);
+    }
 };
 
+
+/**
+ * @brief Fill input tensor for TestNet01 with a non-constant pattern
+ *
+ * @param[out] input Pointer to input tensor in shallow GPU order
+ * @param pattern Pattern index, different patterns lead to different data
+ * @param fractional If \c true, the values have fractional parts (not exact in FP16)
+ */
+static void fillNet01Input(float *input, int pattern, bool fractional=false) {
+    for (int i=0; i < NET01_SIZE * NET01_SIZE * NET01_IN; i++) {
+        float v = (float)(((i * (pattern + 3) + 7 * pattern) % 11) - 5);
+        input[i] = (fractional) ? v * 0.37f + 0.011f * (float)(i % 13) : v;
+    }
+}
+
+
+/**
+ * @brief Compute CPU reference of TestNet01
+ *
+ * @param input Pointer to input tensor in shallow GPU order
+ * @param bias Bias that is added to all output channels
+ *
+ * @return Output tensor in channel-wise order
+ *
+ * As the network does not use padding, the border pixels of the GPU result depend on the
+ * texture wrap mode. The reference uses zero-padding there, use compareNet01() to skip them.
+ */
+static std::vector<float> referenceNet01(const float *input, float bias) {
+    const int size = NET01_SIZE;
+    std::vector<float> out(size * size * NET01_OUT);
+    for (int y=0; y < size; y++) {
+        for (int x=0; x < size; x++) {
+            float sum = bias;
+            for (int fy=0; fy < 3; fy++) {
+                for (int fx=0; fx < 3; fx++) {
+                    int sx = x + fx - 1, sy = y + fy - 1;
+                    if ((sx < 0) || (sy < 0) || (sx >= size) || (sy >= size)) continue;
+                    for (int c=0; c < NET01_IN; c++) sum += NET01_FILTER[fy*3+fx] * input[(sy*size + sx)*NET01_IN + c];
+                }
+            }
+            for (int c=0; c < NET01_OUT; c++) out[(c*size + y)*size + x] = sum;
+        }
+    }
+    return out;
+}
+
+
+/**
+ * @brief Convert an output tensor of TestNet01 from shallow GPU order to channel-wise order
+ *
+ * @param shallow Pointer to output tensor in shallow GPU order
+ *
+ * @return Output tensor in channel-wise order
+ */
+static std::vector<float> channelwiseNet01(const float *shallow) {
+    const int size = NET01_SIZE;
+    std::vector<float> out(size * size * NET01_OUT);
+    for (int c=0; c < NET01_OUT; c++) {
+        for (int i=0; i < size * size; i++) out[c*size*size + i] = shallow[((c / 4) * size * size + i) * 4 + (c % 4)];
+    }
+    return out;
+}
+
+
+/**
+ * @brief Compare (channel-wise) output of TestNet01 against the CPU reference
+ *
+ * @param out Pointer to output tensor in channel-wise order
+ * @param ref Reference data as computed by referenceNet01()
+ * @param relTolerance Tolerance relative to the magnitude of the reference
+ * @param absTolerance Absolute tolerance that is added to the relative one
+ *
+ * Only the interior of the tensor is compared, see referenceNet01().
+ */
+static void compareNet01(const float *out, const std::vector<float>& ref, float relTolerance=0.f, float absTolerance=0.f) {
+    const int size = NET01_SIZE;
+    for (int c=0; c < NET01_OUT; c++) {
+        for (int y=1; y < size-1; y++) {
+            for (int x=1; x < size-1; x++) {
+                int idx = (c*size + y)*size + x;
+                ASSERT_NEAR(out[idx], ref[idx], absTolerance + relTolerance * std::abs(ref[idx])) << "at channel " << c << " position " << x << "," << y;
+            }
+        }
+    }
+}
+
 //-----------------------------------------------------------------------------
 // Test Fixtures
 //-----------------------------------------------------------------------------
@@ -185,6 +353,273 @@ TEST_F(NetworkTestBase, SimpleSyncTest01GC) {
     net.cleanup();
 }
 
+TEST_F(NetworkTestBase, StagedSyncTest01GC) {
+    using namespace fyusion::fyusenet;
+    TestNet01 net;
+    net.bias = 0.5f;
+    net.setup();
+    gpu::UploadLayer * up = dynamic_cast<gpu::UploadLayer *>(net.getLayer("upload"));
+    ASSERT_NE(up, nullptr);
+    up->clearInputBuffers(0);
+    std::vector<float> prev;
+    for (int run=0; run < 2; run++) {
+        size_t bytes = 0;
+        float * in = (float *)up->acquireStagingBuffer(&bytes);
+        ASSERT_NE(in, nullptr);
+        ASSERT_EQ(bytes, up->stagingBytes());
+        ASSERT_EQ(bytes, NET01_SIZE * NET01_SIZE * NET01_IN * sizeof(float));
+        std::vector<float> input(bytes / sizeof(float));
+        fillNet01Input(input.data(), run);
+        memcpy(in, input.data(), bytes);
+        up->commitStagingBuffer();
+        NeuralNetwork::execstate st = net.forward();
+        ASSERT_EQ(st.status, NeuralNetwork::state::EXEC_DONE);
+        std::vector<float> ref = referenceNet01(input.data(), net.bias);
+        const float * res = net.outputBuffer->map<float>();
+        ASSERT_NE(res, nullptr);
+        std::vector<float> out = channelwiseNet01(res);
+        net.outputBuffer->unmap();
+        compareNet01(out.data(), ref);
+        // make sure that the second run does not see the first staging buffer
+        if (run > 0) {
+            ASSERT_NE(out, prev);
+        }
+        prev = out;
+    }
+    net.cleanup();
+}
+
+TEST_F(NetworkTestBase, TargetRingSyncTest01GC) {
+    using namespace fyusion::fyusenet;
+    TestNet01 net;
+    net.bias = 0.5f;
+    net.setup();
+    gpu::DownloadLayer * down = dynamic_cast<gpu::DownloadLayer *>(net.getLayer("download"));
+    ASSERT_NE(down, nullptr);
+    size_t bytes = down->targetBytes();
+    ASSERT_EQ(bytes, (size_t)(NET01_SIZE * NET01_SIZE * NET01_OUT) * sizeof(float));
+    std::vector<float> ring[2] = {std::vector<float>(bytes / sizeof(float), 1.0f), std::vector<float>(bytes / sizeof(float), 1.0f)};
+    std::vector<void *> targets = {ring[0].data(), ring[1].data()};
+    std::vector<void *> done;
+    down->setTargetRing(targets, bytes, BufferSpec::order::CHANNELWISE, [&](uint64_t seq, void *buf, AsyncLayer::state state) {
+        if (state == AsyncLayer::DOWNLOAD_DONE) done.push_back(buf);
+    });
+    std::vector<float> ref[2];
+    for (int run=0; run < 2; run++) {
+        float * in = net.inputBuffer->map<float>();
+        ASSERT_NE(in, nullptr);
+        fillNet01Input(in, run);
+        ref[run] = referenceNet01(in, net.bias);
+        net.inputBuffer->unmap();
+        NeuralNetwork::execstate st = net.forward();
+        ASSERT_EQ(st.status, NeuralNetwork::state::EXEC_DONE);
+        ASSERT_EQ(done.size(), (size_t)(run+1));
+        ASSERT_EQ(done.back(), targets[run]);
+    }
+    // each slot holds the (channel-wise) result of its own run
+    ASSERT_NE(ref[0], ref[1]);
+    for (int slot=0; slot < 2; slot++) {
+        compareNet01(ring[slot].data(), ref[slot]);
+    }
+    // the CPUBuffer of the layer must not have been touched
+    const float * res = net.outputBuffer->map<float>();
+    ASSERT_NE(res, nullptr);
+    ASSERT_EQ(res[0], 1.f);
+    net.outputBuffer->unmap();
+    net.cleanup();
+}
+
+TEST_F(NetworkTestBase, ImageUploadSyncTest02GC) {
+    using namespace fyusion::fyusenet;
+    TestNet02 net;
+    net.setup();
+    NeuralNetwork::execstate st = net.forward();
+    ASSERT_EQ(st.status, NeuralNetwork::state::EXEC_DONE);
+    const float * res = net.outputBuffer->map<float>();
+    ASSERT_NE(res, nullptr);
+    // channels swapped to (150, 100, 50, 200), then normalized
+    const float expected[4] = {70.f, 20.f, 4.f, 20.f};
+    for (int i=0; i < (int)(net.outputBuffer->bytes() / sizeof(float)); i++) {
+        ASSERT_NEAR(res[i], expected[i % 4], 0.1f);      // tolerance covers 16-bit textures
+    }
+    net.outputBuffer->unmap();
+    net.cleanup();
+}
+
+#ifdef FYUSENET_MULTITHREADING
+TEST_F(NetworkTestBase, ThreadedCompileSyncTest02GC) {
+    using namespace fyusion::fyusenet;
+    using namespace fyusion::opengl;
+    ShaderCompiler::getInstance(context())->setStrategy(ShaderCompiler::THREADS);
+    TestNet02 net;
+    net.setup();
+    NeuralNetwork::execstate st = net.forward();
+    ASSERT_EQ(st.status, NeuralNetwork::state::EXEC_DONE);
+    const float * res = net.outputBuffer->map<float>();
+    ASSERT_NE(res, nullptr);
+    const float expected[4] = {70.f, 20.f, 4.f, 20.f};
+    for (int i=0; i < (int)(net.outputBuffer->bytes() / sizeof(float)); i++) {
+        ASSERT_NEAR(res[i], expected[i % 4], 0.1f);
+    }
+    net.outputBuffer->unmap();
+    net.cleanup();
+}
+#endif
+
+TEST_F(NetworkTestBase, StateValidationSyncTest02GC) {
+    using namespace fyusion::fyusenet;
+    using namespace fyusion::opengl;
+    TestNet02 net;
+    net.setup();
+    GLState::setValidation(true);
+    NeuralNetwork::execstate st1, st2;
+    try {
+        st1 = net.forward();
+        st2 = net.forward();
+    } catch (GLException& ex) {
+        GLState::setValidation(false);
+        FAIL() << "GL state tracker out of sync";
+    }
+    GLState::setValidation(false);
+    ASSERT_EQ(st1.status, NeuralNetwork::state::EXEC_DONE);
+    ASSERT_EQ(st2.status, NeuralNetwork::state::EXEC_DONE);
+    const float * res = net.outputBuffer->map<float>();
+    ASSERT_NE(res, nullptr);
+    const float expected[4] = {70.f, 20.f, 4.f, 20.f};
+    for (int i=0; i < (int)(net.outputBuffer->bytes() / sizeof(float)); i++) {
+        ASSERT_NEAR(res[i], expected[i % 4], 0.1f);
+    }
+    net.outputBuffer->unmap();
+    net.cleanup();
+}
+
+TEST_F(NetworkTestBase, RecordedSyncTest01GC) {
+    using namespace fyusion::fyusenet;
+    TestNet01 net;
+    net.setup();
+    int numin = (int)(net.inputBuffer->bytes() / sizeof(float));
+    int numout = (int)(net.outputBuffer->bytes() / sizeof(float));
+    auto run = [&](int pattern, std::vector<float>& result) {
+        float * in = net.inputBuffer->map<float>();
+        for (int i=0; i < numin; i++) in[i] = (float)((i * (pattern + 3)) % (5 + pattern));
+        net.inputBuffer->unmap();
+        NeuralNetwork::execstate st = net.forward();
+        ASSERT_EQ(st.status, NeuralNetwork::state::EXEC_DONE);
+        const float * res = net.outputBuffer->map<float>();
+        ASSERT_NE(res, nullptr);
+        result.assign(res, res + numout);
+        net.outputBuffer->unmap();
+    };
+    std::vector<float> refa, refb, out;
+    run(0, refa);
+    run(1, refb);
+    // first run records, subsequent runs replay the recorded command streams
+    net.recording(true);
+    for (int iter=0; iter < 3; iter++) {
+        run(0, out);
+        for (int i=0; i < numout; i++) ASSERT_EQ(out[i], refa[i]);
+        run(1, out);
+        for (int i=0; i < numout; i++) ASSERT_EQ(out[i], refb[i]);
+    }
+    net.recording(false);
+    run(0, out);
+    for (int i=0; i < numout; i++) ASSERT_EQ(out[i], refa[i]);
+    net.cleanup();
+}
+
+TEST_F(NetworkTestBase, HalfTransferSyncTest01GC) {
+    using namespace fyusion::fyusenet;
+    TestNet01 net(false, true);
+    net.bias = 0.25f;
+    net.setup();
+    // FP16 has 11 significant bits: the output is rounded once (relative error), the rounding
+    // errors of the 36 input values (magnitude < 2.5) that contribute to each output accumulate
+    const float reltol = 2.f / 2048.f;
+    const float abstol = 36.f * 2.5f / 2048.f;
+    float * in = net.inputBuffer->map<float>();
+    ASSERT_NE(in, nullptr);
+    fillNet01Input(in, 0, true);
+    std::vector<float> ref = referenceNet01(in, net.bias);
+    net.inputBuffer->unmap();
+    NeuralNetwork::execstate st = net.forward();
+    ASSERT_EQ(st.status, NeuralNetwork::state::EXEC_DONE);
+    const float * res = net.outputBuffer->map<float>();
+    ASSERT_NE(res, nullptr);
+    std::vector<float> out = channelwiseNet01(res);
+    net.outputBuffer->unmap();
+    compareNet01(out.data(), ref, reltol, abstol);
+    gpu::DownloadLayer * down = dynamic_cast<gpu::DownloadLayer *>(net.getLayer("download"));
+    ASSERT_NE(down, nullptr);
+    size_t bytes = down->targetBytes();
+    std::vector<float> ring(bytes / sizeof(float), 1.0f);
+    down->setTargetRing({ring.data()}, bytes);
+    in = net.inputBuffer->map<float>();
+    ASSERT_NE(in, nullptr);
+    fillNet01Input(in, 1, true);
+    ref = referenceNet01(in, net.bias);
+    net.inputBuffer->unmap();
+    st = net.forward();
+    ASSERT_EQ(st.status, NeuralNetwork::state::EXEC_DONE);
+    compareNet01(ring.data(), ref, reltol, abstol);
+    net.cleanup();
+}
+
+TEST_F(NetworkTestBase, MixedPrecisionSyncTest01GC) {
+    using namespace fyusion::fyusenet;
+    // 1000.3 is not representable in FP16 (spacing is 0.5 in that range)
+    const float bias = 1000.3f;
+    auto run = [&](PrecisionType prec, std::vector<float>& result) {
+        TestNet01 net;
+        net.bias = bias;
+        net.setLayerPrecision(2, prec);
+        net.setup();
+        ASSERT_EQ(net.getLayerNumbers(), std::vector<int>({1, 2, 3}));
+        gpu::GPULayerBase * conv = dynamic_cast<gpu::GPULayerBase *>(net.getLayer("conv3x3"));
+        ASSERT_NE(conv, nullptr);
+        ASSERT_EQ(conv->isHighPrecision(), (prec == PrecisionType::FULL));
+        NeuralNetwork::execstate st = net.forward();
+        ASSERT_EQ(st.status, NeuralNetwork::state::EXEC_DONE);
+        const float * res = net.outputBuffer->map<float>();
+        ASSERT_NE(res, nullptr);
+        result.assign(res, res + net.outputBuffer->bytes() / sizeof(float));
+        net.outputBuffer->unmap();
+        net.cleanup();
+    };
+    std::vector<float> full, half;
+    run(PrecisionType::FULL, full);
+    run(PrecisionType::HALF, half);
+    ASSERT_FALSE(full.empty());
+    for (float v : full) ASSERT_NEAR(v, bias, 1e-3f);
+    for (float v : half) {
+        // rounding mode for FP16 conversion is implementation-defined
+        ASSERT_NEAR(v, bias, 0.5f);
+        ASSERT_GT(std::abs(v - bias), 0.1f);
+    }
+}
+
+TEST_F(NetworkTestBase, PrecisionAdvisorTest) {
+    using namespace fyusion::fyusenet;
+    // synthetic network: layers 2 and 5 introduce a large error in half precision, the others a small one
+    auto evaluate = [](const PrecisionAdvisor::assignment& prec) {
+        std::vector<float> out(4, 1.0f);
+        for (auto it = prec.begin(); it != prec.end(); ++it) {
+            if (it->second == PrecisionType::HALF) out[it->first % 4] += (it->first == 2 || it->first == 5) ? 0.1f : 0.001f;
+        }
+        return out;
+    };
+    PrecisionAdvisor advisor({1, 2, 3, 4, 5, 6}, evaluate);
+    PrecisionAdvisor::assignment prec = advisor.suggest(0.01f);
+    ASSERT_EQ(prec.size(), 6u);
+    EXPECT_EQ(prec[2], PrecisionType::FULL);
+    EXPECT_EQ(prec[5], PrecisionType::FULL);
+    for (int l : {1, 3, 4, 6}) EXPECT_EQ(prec[l], PrecisionType::HALF);
+    EXPECT_NEAR(advisor.sensitivities().at(2), 0.1f, 1e-5f);
+    EXPECT_LE(advisor.error(), 0.01f);
+    // a zero budget keeps everything in full precision
+    prec = advisor.suggest(0.0f);
+    for (auto it = prec.begin(); it != prec.end(); ++it) EXPECT_EQ(it->second, PrecisionType::FULL);
+}
+
 #ifdef FYUSENET_MULTITHREADING
 TEST_F(NetworkTestBase, SimpleAsyncTest01GC) {
     using namespace fyusion::fyusenet;
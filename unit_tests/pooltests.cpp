@@ -27,6 +27,7 @@
 #include <fyusenet/gpu/deep/deepavgpoollayer.h>
 #include <fyusenet/gpu/deep/deepmaxpoollayer.h>
 #include <fyusenet/gpu/deep/deepglobalpoollayer.h>
+#include <fyusenet/gpu/deep/deeppointwisechainlayer.h>
 
 
 //-------------------------------------- Global Variables ------------------------------------------
@@ -151,6 +152,52 @@ class ParamMaxPoolTest : public PoolLayerTest, public ::testing::WithParamInterf
 };
 
 
+/**
+ * @brief Fixture for fused average pooling, which is checked against the standalone layer
+ *
+ * The fused pooling must use the same taps as deep::DeepAvgPoolLayer (which centers 3x3 windows),
+ * so the reference is computed by the standalone layer and not by the CPU.
+ */
+class ParamAvgChainTest : public PoolLayerTest, public ::testing::WithParamInterface<PoolParam> {
+ protected:
+    float * referencePool(const float *input, const PoolParam& param) {
+        gpu::PoolLayerBuilder bld(gpu::PoolLayerBuilder::POOL_AVG, "pool");
+        bld.context(context()).shape(param.channels, param.height, param.width, param.channels);
+        bld.poolSize(param.pool).downsample(param.stride).deep();
+        gpu::deep::DeepAvgPoolLayer layer(bld, 1);
+        return runLayer(&layer, input, param);
+    }
+
+    float * runLayer(gpu::GPULayerBase * layer, const float *input, const PoolParam& param) {
+        std::vector<const float *> inputs{input};
+        generateTextures(layer, inputs, nullptr);
+        layer->setup();
+        layer->forward(1);
+        float * result = new float[param.channels * param.width * param.height];
+        layer->copyResult(result);
+        layer->cleanup();
+        return result;
+    }
+};
+
+
+/**
+ * @brief Fixture for fused max pooling, which is checked against the standalone layer
+ *
+ * @see ParamAvgChainTest
+ */
+class ParamMaxChainTest : public ParamAvgChainTest {
+ protected:
+    float * referencePool(const float *input, const PoolParam& param) {
+        gpu::PoolLayerBuilder bld(gpu::PoolLayerBuilder::POOL_MAX, "pool");
+        bld.context(context()).shape(param.channels, param.height, param.width, param.channels);
+        bld.poolSize(param.pool).downsample(param.stride).deep();
+        gpu::deep::DeepMaxPoolLayer layer(bld, 1);
+        return runLayer(&layer, input, param);
+    }
+};
+
+
 class ParamGlobalAvgPoolTest : public PoolLayerTest, public ::testing::WithParamInterface<GlobPoolParam> {
  protected:
     float * referencePool(const float *input, const GlobPoolParam& param) {
@@ -272,6 +319,61 @@ TEST_P(ParamMaxPoolTest, MaxTestDeep) {
 }
 
 
+TEST_P(ParamMaxChainTest, MaxChainTestDeep) {
+    auto param = GetParam();
+    std::unique_ptr<float[]> input(generateRandomData(param.channels, param.width, param.height, -10.f, 10.0f));
+    std::unique_ptr<float[]> ref(referencePool(input.get(), param));
+    gpu::PointwiseChainBuilder bld("chain");
+    bld.context(context()).shape(param.channels, param.height, param.width, param.channels);
+    bld.maxPool(param.pool, param.pool).downsample(param.stride).deep();
+    bld.addSigmoid().addArith(ArithType::MUL, 2.0f).addArith(ArithType::SUB, 1.0f);
+    gpu::deep::DeepPointwiseChainLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[param.channels * param.width * param.height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    int twidth = param.width / param.stride;
+    int theight = param.height / param.stride;
+    const float * resptr = result.get();
+    const float * refptr = ref.get();
+    for (int i=0; i < param.channels * twidth * theight; i++) {
+        float expect = 2.0f / (1.0f + expf(-refptr[i])) - 1.0f;
+        ASSERT_NEAR(resptr[i], expect, 0.01f);
+    }
+}
+
+
+TEST_P(ParamAvgChainTest, AvgChainTestDeep) {
+    auto param = GetParam();
+    std::unique_ptr<float[]> input(generateRandomData(param.channels, param.width, param.height, -100.f, 100.0f));
+    std::unique_ptr<float[]> ref(referencePool(input.get(), param));
+    gpu::PointwiseChainBuilder bld("chain");
+    bld.context(context()).shape(param.channels, param.height, param.width, param.channels);
+    bld.avgPool(param.pool, param.pool).downsample(param.stride).deep();
+    bld.addReLU(0.1f).addArith(ArithType::DIV, 50.0f).addTanh().addClip(-0.5f, 0.75f);
+    gpu::deep::DeepPointwiseChainLayer layer(bld, 1);
+    std::vector<const float *> inputs{input.get()};
+    generateTextures(&layer, inputs, nullptr);
+    layer.setup();
+    layer.forward(1);
+    std::unique_ptr<float[]> result(new float[param.channels * param.width * param.height]);
+    layer.copyResult(result.get());
+    layer.cleanup();
+    int twidth = param.width / param.stride;
+    int theight = param.height / param.stride;
+    const float * resptr = result.get();
+    const float * refptr = ref.get();
+    for (int i=0; i < param.channels * twidth * theight; i++) {
+        float expect = (refptr[i] < 0.f) ? 0.1f * refptr[i] : refptr[i];
+        expect = std::min(0.75f, std::max(-0.5f, tanhf(expect / 50.0f)));
+        ASSERT_NEAR(resptr[i], expect, 0.01f);
+    }
+}
+
+
 TEST_P(ParamGlobalAvgPoolTest, GlobAvgTestDeep) {
     auto param = GetParam();
     std::unique_ptr<float[]> input(generateRandomData(param.channels, param.width, param.height, -100.f, 100.0f));
@@ -333,6 +435,19 @@ INSTANTIATE_TEST_CASE_P(Max, ParamMaxPoolTest, testing::Values(
                                                      PoolParam(2, 2, 50, 50, 23),
                                                      PoolParam(2, 2, 40, 40, 80)));
 
+INSTANTIATE_TEST_CASE_P(AvgChain, ParamAvgChainTest, testing::Values(
+                                                     PoolParam(2, 2, 8, 8, 4),
+                                                     PoolParam(2, 2, 80, 40, 12),
+                                                     PoolParam(2, 2, 40, 40, 80),
+                                                     PoolParam(3, 1, 40, 40, 12),
+                                                     PoolParam(3, 2, 50, 50, 23)));
+
+INSTANTIATE_TEST_CASE_P(MaxChain, ParamMaxChainTest, testing::Values(
+                                                     PoolParam(2, 2, 80, 40, 12),
+                                                     PoolParam(2, 2, 40, 40, 80),
+                                                     PoolParam(3, 1, 40, 40, 12),
+                                                     PoolParam(3, 2, 50, 50, 23)));
+
 INSTANTIATE_TEST_CASE_P(GlobAvg, ParamGlobalAvgPoolTest, testing::Values(
                                                    GlobPoolParam(80, 40, 56),
                                                    GlobPoolParam(100, 80, 12),
@@ -341,7 +456,10 @@ INSTANTIATE_TEST_CASE_P(GlobAvg, ParamGlobalAvgPoolTest, testing::Values(
                                                    GlobPoolParam(50, 50, 23),
                                                    GlobPoolParam(2, 2, 24),
                                                    GlobPoolParam(8, 4, 24),
-                                                   GlobPoolParam(40, 40, 80)));
+                                                   GlobPoolParam(40, 40, 80),
+                                                   GlobPoolParam(56, 56, 64),
+                                                   GlobPoolParam(13, 9, 8),
+                                                   GlobPoolParam(257, 3, 4)));
 
 INSTANTIATE_TEST_CASE_P(GlobMax, ParamGlobalMaxPoolTest, testing::Values(
                                                              GlobPoolParam(80, 40, 56),
@@ -351,7 +469,10 @@ INSTANTIATE_TEST_CASE_P(GlobMax, ParamGlobalMaxPoolTest, testing::Values(
                                                              GlobPoolParam(50, 50, 23),
                                                              GlobPoolParam(2, 2, 24),
                                                              GlobPoolParam(8, 4, 24),
-                                                             GlobPoolParam(40, 40, 80)));
+                                                             GlobPoolParam(40, 40, 80),
+                                                             GlobPoolParam(56, 56, 64),
+                                                             GlobPoolParam(13, 9, 8),
+                                                             GlobPoolParam(257, 3, 4)));
 
 
 // vim: set expandtab ts=4 sw=4: